@@ -25,11 +25,13 @@
 #ifndef LMMS_AUDIO_DEVICE_H
 #define LMMS_AUDIO_DEVICE_H
 
+#include <memory>
 #include <QMutex>
 #include <samplerate.h>
 
 #include "lmms_basics.h"
 
+class QString;
 class QThread;
 
 namespace lmms
@@ -37,6 +39,7 @@ namespace lmms
 
 class AudioEngine;
 class AudioPort;
+class ChannelOutput;
 
 
 class AudioDevice
@@ -64,6 +67,10 @@ public:
 	virtual void unregisterPort( AudioPort * _port );
 	virtual void renamePort( AudioPort * _port );
 
+	//! An output of its own for a mixer channel named @p name, nullptr if the
+	//! driver has none - currently only JACK has them
+	virtual std::unique_ptr<ChannelOutput> createChannelOutput( const QString & /* _name */ );
+
 
 	inline bool supportsCapture() const
 	{
@@ -87,10 +94,23 @@ public:
 		m_inProcess = true;
 	}
 
+	//! False once the audio engine signalled the end of processing
+	bool isProcessing() const
+	{
+		return m_inProcess;
+	}
+
 	virtual void stopProcessing();
 
 	virtual void applyQualitySettings();
 
+	//! Whether the audio engine should render ahead on a thread of its own
+	//! for the device, rather than when the device asks for the next buffer
+	virtual bool needsFifo() const
+	{
+		return true;
+	}
+
 
 
 protected:
@@ -102,6 +122,11 @@ protected:
 	{
 	}
 
+	// called by processNextBuffer() for every buffer it fetched, writes
+	// it right away unless re-implemented
+	virtual void processBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames );
+
 	// called by according driver for fetching new sound-data
 	fpp_t getNextBuffer( surroundSampleFrame * _ab );
 
@@ -34,6 +34,11 @@
 #include <QThread>
 #include <samplerate.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "lmms_basics.h"
@@ -41,6 +46,7 @@
 #include "FifoBuffer.h"
 #include "AudioEngineProfiler.h"
 #include "PlayHandle.h"
+#include "QualityGovernor.h"
 
 
 namespace lmms
@@ -48,12 +54,19 @@ namespace lmms
 
 class AudioDevice;
 class MidiClient;
+class MidiPort;
 class AudioPort;
 class AudioEngineWorkerThread;
+template<class T> class LocklessRingBuffer;
 
 
 const fpp_t MINIMUM_BUFFER_SIZE = 32;
 const fpp_t DEFAULT_BUFFER_SIZE = 256;
+//! Largest buffer size for playback, anything above DEFAULT_BUFFER_SIZE is
+//! buffered in the FIFO
+const fpp_t MAXIMUM_BUFFER_SIZE = 4096;
+//! Largest internal block size when rendering without GUI
+const fpp_t MAXIMUM_RENDER_BUFFER_SIZE = 4096;
 
 const int BYTES_PER_SAMPLE = sizeof( sample_t );
 const int BYTES_PER_INT_SAMPLE = sizeof( int_sample_t );
@@ -244,6 +257,10 @@ public:
 		return m_midiClient;
 	}
 
+	//! The ports whose input events are handed over at the start of each period
+	void addMidiPort(MidiPort * port);
+	void removeMidiPort(MidiPort * port);
+
 
 	// play-handle stuff
 	bool addPlayHandle( PlayHandle* handle );
@@ -264,6 +281,13 @@ public:
 		return m_framesPerPeriod;
 	}
 
+	//! Whether instruments, effects and mixer channels are processed as one
+	//! task graph instead of in separate stages
+	bool usesTaskGraph() const
+	{
+		return m_taskGraph;
+	}
+
 
 	AudioEngineProfiler& profiler()
 	{
@@ -280,6 +304,22 @@ public:
 		return m_profiler.detailLoad(type);
 	}
 
+	//! How full the queue of play handles to add in the next period is
+	LocklessAllocator::Statistics newPlayHandleStatistics() const
+	{
+		return m_newPlayHandles.statistics();
+	}
+
+	QualityGovernor& qualityGovernor()
+	{
+		return m_qualityGovernor;
+	}
+
+	const QualityGovernor& qualityGovernor() const
+	{
+		return m_qualityGovernor;
+	}
+
 	const qualitySettings & currentQualitySettings() const
 	{
 		return m_qualitySettings;
@@ -345,11 +385,50 @@ public:
 		return m_inputBufferFrames[ m_inputBufferRead ];
 	}
 
-	inline const surroundSampleFrame * nextBuffer()
+	//! A period of the captured input for monitoring it, from what came in
+	//! up to the start of the current period
+	const sampleFrame * monitorInput() const
 	{
-		return hasFifoWriter() ? m_fifo->read() : renderNextBuffer();
+		return m_monitorInput.data();
 	}
 
+	//! The next period of the output, valid until the next call
+	const surroundSampleFrame * nextBuffer();
+
+	//! The number of the period being rendered, counting from 1
+	std::uint64_t currentPeriod() const
+	{
+		return m_period;
+	}
+
+	//! The number of the period nextBuffer() returned last, for the device
+	//! to match up what mixer channels wrote to their ChannelOutput
+	std::uint64_t servedPeriod() const
+	{
+		return m_servedPeriod;
+	}
+
+	//! How many periods can be rendered but not played yet at most, whatever
+	//! the buffer size is changed to: those in the FIFO, the one the device
+	//! plays and the one being rendered
+	static constexpr int periodsInFlight()
+	{
+		return MAXIMUM_BUFFER_SIZE / DEFAULT_BUFFER_SIZE + 2;
+	}
+
+	//! The period and the number of periods in the FIFO that buffer
+	//! @p framesPerAudioBuffer frames, the size set in the settings
+	static std::pair<fpp_t, int> splitBufferSize( fpp_t framesPerAudioBuffer );
+
+	//! Buffer @p framesPerAudioBuffer frames from now on. That only takes a
+	//! restart of processing as long as the period stays the same, which all
+	//! buffers are allocated for - returns false if it wouldn't.
+	bool setFramesPerAudioBuffer( fpp_t framesPerAudioBuffer );
+
+	//! The master output, a few periods of it, for views to read with a
+	//! LocklessRingBufferReader when they repaint. Null without a GUI.
+	LocklessRingBuffer<surroundSampleFrame>* outputTap() { return m_outputTap.get(); }
+
 	void changeQuality(const struct qualitySettings & qs);
 
 	inline bool isMetronomeActive() const { return m_metronomeActive; }
@@ -359,6 +438,11 @@ public:
 	void requestChangeInModel();
 	void doneChangeInModel();
 
+	//! Waits until the period being rendered, if any, is done, so what the
+	//! audio threads could have read before is free to go. Rendering goes on
+	//! meanwhile, unlike with requestChangeInModel() - see RcuPointer.
+	void waitForGracePeriod();
+
 	RequestChangesGuard requestChangesGuard()
 	{
 		return RequestChangesGuard{this};
@@ -371,7 +455,6 @@ public:
 signals:
 	void qualitySettingsChanged();
 	void sampleRateChanged();
-	void nextAudioBuffer( const lmms::surroundSampleFrame * buffer );
 
 
 private:
@@ -384,19 +467,23 @@ private:
 
 		void finish();
 
+		//! The number of the period in @p buffer, which came out of the FIFO
+		std::uint64_t periodOf( const surroundSampleFrame * buffer ) const;
+
 
 	private:
 		AudioEngine * m_audioEngine;
 		Fifo * m_fifo;
 		volatile bool m_writing;
+		//! The periods that take turns in the FIFO, allocated once
+		std::vector<surroundSampleFrame> m_buffers;
+		std::vector<std::uint64_t> m_periods;
 
 		void run() override;
-
-		void write( surroundSampleFrame * buffer );
 	} ;
 
 
-	AudioEngine( bool renderOnly );
+	AudioEngine( bool renderOnly, fpp_t renderFramesPerPeriod );
 	~AudioEngine() override;
 
 	void startProcessing(bool needsFifo = true);
@@ -409,19 +496,25 @@ private:
 	void renderStageNoteSetup();
 	void renderStageInstruments();
 	void renderStageEffects();
+	void renderStageGraph();
 	void renderStageMix();
 
+	void removeFinishedPlayHandles();
+
 	const surroundSampleFrame * renderNextBuffer();
 
 	void swapBuffers();
+	void updateMonitorInput();
 
 	void handleMetronome();
 
 	void clearInternal();
 
 	bool m_renderOnly;
+	bool m_taskGraph;
 
 	std::vector<AudioPort *> m_audioPorts;
+	std::vector<MidiPort *> m_midiPorts;
 
 	fpp_t m_framesPerPeriod;
 
@@ -430,9 +523,14 @@ private:
 	f_cnt_t m_inputBufferSize[2];
 	int m_inputBufferRead;
 	int m_inputBufferWrite;
+	//! The input that didn't fit into the monitored periods yet, and the
+	//! period being monitored
+	std::vector<sampleFrame> m_monitorBacklog;
+	std::vector<sampleFrame> m_monitorInput;
 
 	surroundSampleFrame * m_outputBufferRead;
 	surroundSampleFrame * m_outputBufferWrite;
+	std::unique_ptr<LocklessRingBuffer<surroundSampleFrame>> m_outputTap;
 
 	// worker thread stuff
 	std::vector<AudioEngineWorkerThread *> m_workers;
@@ -442,7 +540,6 @@ private:
 	PlayHandleList m_playHandles;
 	// place where new playhandles are added temporarily
 	LocklessList<PlayHandle *> m_newPlayHandles;
-	ConstPlayHandleList m_playHandlesToRemove;
 
 
 	struct qualitySettings m_qualitySettings;
@@ -463,13 +560,21 @@ private:
 	Fifo * m_fifo;
 	fifoWriter * m_fifoWriter;
 
+	std::uint64_t m_period;
+	std::uint64_t m_servedPeriod;
+	//! When rendering the current period began, MIDI input is placed relative to it
+	std::chrono::steady_clock::time_point m_periodStart;
+
 	AudioEngineProfiler m_profiler;
+	QualityGovernor m_qualityGovernor;
 
 	bool m_metronomeActive;
 
 	bool m_clearSignal;
 
 	std::mutex m_changeMutex;
+	//! Odd while a period is rendered
+	std::atomic<std::uint64_t> m_renderEpoch;
 
 	friend class Engine;
 	friend class AudioEngineWorkerThread;
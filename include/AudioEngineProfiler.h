@@ -27,9 +27,14 @@
 
 #include <array>
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <QFile>
+#include <QString>
 
 #include "lmms_basics.h"
+#include "AudioEngineTracer.h"
 #include "MicroTimer.h"
 
 namespace lmms
@@ -39,7 +44,7 @@ class AudioEngineProfiler
 {
 public:
 	AudioEngineProfiler();
-	~AudioEngineProfiler() = default;
+	~AudioEngineProfiler();
 
 	void startPeriod()
 	{
@@ -55,27 +60,61 @@ public:
 
 	void setOutputFile( const QString& outputFile );
 
+	//! Append the periods before and after every missed deadline to
+	//! @p logFile - must be called before processing starts
+	void setXrunLogFile( const QString& logFile );
+
+	//! State of the current period, kept with its timings for the xrun log
+	void setPlayHandleCount( int count )
+	{
+		m_playHandleCount = count;
+	}
+
+	//! Missed deadlines only matter while playing in realtime
+	void setRealtime( bool realtime )
+	{
+		m_realtime = realtime;
+	}
+
 	enum class DetailType {
 		NoteSetup,
 		Instruments,
 		Effects,
 		Mixing,
+		TaskGraph, // instruments, effects and mixer channels when not rendering in stages
 		Count
 	};
 
 	constexpr static auto DetailCount = static_cast<std::size_t>(DetailType::Count);
 
+	static constexpr const char* detailName(const DetailType type)
+	{
+		constexpr const char* names[] = {"NoteSetup", "Instruments", "Effects", "Mixing", "TaskGraph"};
+		static_assert(std::size(names) == DetailCount);
+		return names[static_cast<std::size_t>(type)];
+	}
+
 	int detailLoad(const DetailType type) const
 	{
 		return m_detailLoad[static_cast<std::size_t>(type)].load(std::memory_order_relaxed);
 	}
 
+	//! Time in us spent in a stage since the last reset, meant for
+	//! benchmarks rendering from the thread reading it
+	std::uint64_t detailTotal(const DetailType type) const
+	{
+		return m_detailTotal[static_cast<std::size_t>(type)];
+	}
+
+	void resetDetailTotals() { m_detailTotal.fill(0); }
+
 	class Probe
 	{
 	public:
 		Probe(AudioEngineProfiler& profiler, AudioEngineProfiler::DetailType type)
 			: m_profiler(profiler)
 			, m_type(type)
+			, m_traceScope(detailName(type))
 		{
 			profiler.startDetail(type);
 		}
@@ -87,9 +126,80 @@ public:
 	private:
 		AudioEngineProfiler &m_profiler;
 		const AudioEngineProfiler::DetailType m_type;
+		AudioEngineTracer::Scope m_traceScope;
+	};
+
+	//! Time spent on behalf of a single track, effect or mixer channel. Any
+	//! thread may add to it lock-free, the profiler turns the sum into a
+	//! load once per period.
+	class Account
+	{
+	public:
+		Account(AudioEngineProfiler& profiler, const QString& name);
+		~Account();
+		Account& operator=(const Account&) = delete;
+		Account(const Account&) = delete;
+
+		//! The name used in the output file
+		void setName(const QString& name);
+
+		void add(int time) { m_time.fetch_add(time, std::memory_order_relaxed); }
+
+		int load() const { return m_load.load(std::memory_order_relaxed); }
+
+	private:
+		AudioEngineProfiler& m_profiler;
+		QString m_name;
+		std::array<char, 32> m_shortName; // for the xrun log, which can't use QString
+		std::atomic_int m_time{0};
+		std::atomic<float> m_load{0};
+
+		friend class AudioEngineProfiler;
+	};
+
+	constexpr static std::size_t XrunHistory = 64;	// periods up to and including the logged ones
+	constexpr static std::size_t XrunAftermath = 8;	// periods to wait for after a missed deadline
+	constexpr static std::size_t SlowestJobs = 3;
+
+	struct PeriodRecord
+	{
+		std::int64_t timestamp; // ms since epoch
+		int periodTime;
+		int timeLimit;
+		std::array<int, DetailCount> detailTime;
+		int playHandles;
+
+		// the accounts that took the most time
+		struct Job
+		{
+			std::array<char, 32> name;
+			int time;
+		};
+		std::array<Job, SlowestJobs> slowestJobs;
+	};
+
+	class AccountProbe
+	{
+	public:
+		explicit AccountProbe(Account& account)
+			: m_account(account)
+		{
+		}
+		~AccountProbe() { m_account.add(m_timer.elapsed()); }
+		AccountProbe& operator=(const AccountProbe&) = delete;
+		AccountProbe(const AccountProbe&) = delete;
+		AccountProbe(AccountProbe&&) = delete;
+
+	private:
+		Account& m_account;
+		MicroTimer m_timer;
 	};
 
 private:
+	class XrunLogger;
+
+	void finishAccounts(uint64_t timeLimit, QString* output, PeriodRecord& record);
+
 	void startDetail(const DetailType type) { m_detailTimer[static_cast<std::size_t>(type)].reset(); }
 	void finishDetail(const DetailType type)
 	{
@@ -104,6 +214,20 @@ private:
 	std::array<MicroTimer, DetailCount> m_detailTimer;
 	std::array<int, DetailCount> m_detailTime{0};
 	std::array<std::atomic<float>, DetailCount> m_detailLoad{0};
+	std::array<std::uint64_t, DetailCount> m_detailTotal{0};
+
+	// only locked while adding, removing or renaming accounts and while
+	// finishing a period, which skips the accounts rather than waiting
+	std::mutex m_accountsMutex;
+	std::vector<Account*> m_accounts;
+
+	// the last periods, m_historyPos is the oldest
+	std::array<PeriodRecord, XrunHistory> m_history{};
+	std::size_t m_historyPos = 0;
+	int m_xrunCountdown = -1;
+	int m_playHandleCount = 0;
+	bool m_realtime = true;
+	std::unique_ptr<XrunLogger> m_xrunLogger;
 };
 
 } // namespace lmms
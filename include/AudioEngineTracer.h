@@ -0,0 +1,91 @@
+/*
+ * AudioEngineTracer.h - record a timeline of what the audio engine does
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUDIO_ENGINE_TRACER_H
+#define LMMS_AUDIO_ENGINE_TRACER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <QString>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/*! Records when each render stage, job and remote plugin round trip, and
+ *  each event of the GUI thread, begins and ends, per thread, and writes that to a file in the Chrome trace event
+ *  format which chrome://tracing and Perfetto can show as a timeline.
+ *
+ *  Every thread writes into its own lock-free ring buffer, which a separate
+ *  thread empties into the file. Events are dropped if that thread can't
+ *  keep up. Tracing can be started once per run only.
+ */
+class LMMS_EXPORT AudioEngineTracer
+{
+public:
+	static void start(const QString& outputFile);
+	//! Write all remaining events and close the file. Nothing may be traced
+	//! anymore while this runs.
+	static void stop();
+
+	static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	//! Records an event from construction to destruction. @p name must be a
+	//! string literal, @p index is shown as argument if it isn't negative.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name, int index = -1)
+			: m_name(name)
+			, m_index(index)
+			, m_begin(isEnabled() ? now() : -1)
+		{
+		}
+		~Scope()
+		{
+			if (m_begin >= 0) { record(m_name, m_index, m_begin, now()); }
+		}
+		Scope& operator=(const Scope&) = delete;
+		Scope(const Scope&) = delete;
+		Scope(Scope&&) = delete;
+
+	private:
+		const char* m_name;
+		int m_index;
+		std::int64_t m_begin;
+	};
+
+private:
+	//! Nanoseconds since tracing started
+	static std::int64_t now();
+	static void record(const char* name, int index, std::int64_t begin, std::int64_t end);
+
+	static std::atomic_bool s_enabled;
+};
+
+} // namespace lmms
+
+#endif // LMMS_AUDIO_ENGINE_TRACER_H
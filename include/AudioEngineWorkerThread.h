@@ -25,11 +25,13 @@
 #ifndef LMMS_AUDIO_ENGINE_WORKER_THREAD_H
 #define LMMS_AUDIO_ENGINE_WORKER_THREAD_H
 
+#include <QMutex>
 #include <QThread>
+#include <QWaitCondition>
 
 #include <atomic>
-
-class QWaitCondition;
+#include <memory>
+#include <vector>
 
 namespace lmms
 {
@@ -41,6 +43,15 @@ class AudioEngineWorkerThread : public QThread
 {
 	Q_OBJECT
 public:
+	//! How threads wait for jobs: the audio engine thread waits for the
+	//! workers at the end of each stage, the workers wait for the next stage
+	enum class WaitPolicy
+	{
+		Spin,	// busy-wait, lowest latency but always burns the CPU cores
+		Hybrid,	// busy-wait for a bounded time, then sleep
+		Park	// sleep right away
+	} ;
+
 	// internal representation of the job queue - all functions are thread-safe
 	class JobQueue
 	{
@@ -54,26 +65,74 @@ public:
 		static constexpr size_t JOB_QUEUE_SIZE = 8192;
 
 		JobQueue() :
-			m_items(),
-			m_writeIndex( 0 ),
+			m_queues(),
+			m_fixedQueues(),
+			m_nextQueue( 0 ),
+			m_itemsQueued( 0 ),
 			m_itemsDone( 0 ),
-			m_opMode( OperationMode::Static )
+			m_opMode( OperationMode::Static ),
+			m_waiting( false )
 		{
-			std::fill(m_items, m_items + JOB_QUEUE_SIZE, nullptr);
 		}
 
+		//! Create the queues owned by worker @p worker (called once per worker thread)
+		void addWorker( size_t worker );
+
 		void reset( OperationMode _opMode );
 
-		void addJob( ThreadableJob * _job );
+		//! Returns false if the job does not need to be processed
+		bool addJob( ThreadableJob * _job );
 
-		void run();
+		void run( size_t _worker );
+		//! Process one job if there is any, returns whether there was
+		bool runOne( size_t _worker );
 		void wait();
 
+		bool hasPendingJobs() const
+		{
+			return m_itemsDone < m_itemsQueued;
+		}
+
 	private:
-		std::atomic<ThreadableJob*> m_items[JOB_QUEUE_SIZE];
-		std::atomic_int m_writeIndex;
+		//! Bounded per-worker queue. The owning worker pops from it first,
+		//! idle workers steal from it once their own queue ran dry.
+		class alignas(64) WorkerQueue
+		{
+		public:
+			WorkerQueue() :
+				m_readIndex( 0 ),
+				m_writeIndex( 0 ),
+				m_items()
+			{
+				std::fill(m_items, m_items + JOB_QUEUE_SIZE, nullptr);
+			}
+
+			void reset();
+			bool push( ThreadableJob * _job );
+			ThreadableJob * pop();
+
+		private:
+			std::atomic<size_t> m_readIndex;
+			// keep producers and consumers on separate cache lines
+			alignas(64) std::atomic<size_t> m_writeIndex;
+			std::atomic<ThreadableJob*> m_items[JOB_QUEUE_SIZE];
+		} ;
+
+		ThreadableJob * nextJob( size_t _worker );
+		void finishJob();
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		//! Jobs bound to a worker, only ever popped by that worker
+		std::vector<std::unique_ptr<WorkerQueue>> m_fixedQueues;
+		std::atomic<size_t> m_nextQueue;
+		std::atomic_int m_itemsQueued;
 		std::atomic_int m_itemsDone;
 		OperationMode m_opMode;
+
+		// used by wait() once it stops spinning
+		QMutex m_doneMutex;
+		QWaitCondition m_doneCond;
+		std::atomic_bool m_waiting;
 	} ;
 
 
@@ -88,9 +147,9 @@ public:
 		globalJobQueue.reset( _opMode );
 	}
 
-	static void addJob( ThreadableJob * _job )
+	static bool addJob( ThreadableJob * _job )
 	{
-		globalJobQueue.addJob( _job );
+		return globalJobQueue.addJob( _job );
 	}
 
 	// a convenient helper function allowing to pass a container with pointers
@@ -108,6 +167,50 @@ public:
 
 	static void startAndWaitForJobs();
 
+	//! For jobs that wait for jobs they added themselves: process one of
+	//! the queued jobs on the calling worker, or pause a little if there is
+	//! none. Returns whether a job was processed.
+	static bool processOneJob();
+
+	//! Index of the worker the calling thread is running as, or
+	//! workerCount() if it isn't one of the audio engine's workers
+	static size_t currentWorker();
+
+	static size_t workerCount()
+	{
+		return workerThreads.size();
+	}
+
+	static WaitPolicy waitPolicy()
+	{
+		return s_waitPolicy;
+	}
+
+	static void setWaitPolicy( WaitPolicy policy )
+	{
+		s_waitPolicy = policy;
+	}
+
+	//! Parse the value of the "audioengine/workerwaitpolicy" setting
+	static WaitPolicy waitPolicyFromName( const QString & name );
+
+	//! CPU affinity and realtime priority of the threads processing jobs
+	struct SchedulingOptions
+	{
+		std::vector<int> cores; // CPU cores to run on, empty for any core
+		int realtimePriority = 0; // SCHED_FIFO priority, 0 keeps the default
+	} ;
+
+	//! Workers (including the inline one) pick the options up the next
+	//! time they look for jobs
+	static void setSchedulingOptions( const SchedulingOptions & options );
+
+	//! Keep the calling thread off the cores reserved for the workers
+	static void avoidWorkerCores();
+
+	//! Parse a list of CPU cores in the format used by isolcpus, e.g. "2-5,7"
+	static std::vector<int> coresFromList( const QString & list );
+
 
 private:
 	void run() override;
@@ -115,7 +218,12 @@ private:
 	static JobQueue globalJobQueue;
 	static QWaitCondition * queueReadyWaitCond;
 	static QList<AudioEngineWorkerThread *> workerThreads;
+	static std::atomic<WaitPolicy> s_waitPolicy;
+	//! Counts the stages started - a worker only goes to sleep once it
+	//! looked for jobs in the current one, so it can't miss jobs bound to it
+	static std::atomic_int s_stage;
 
+	size_t m_index;
 	volatile bool m_quit;
 } ;
 
@@ -27,6 +27,8 @@
 #define LMMS_AUDIO_FILE_DEVICE_H
 
 #include <QFile>
+#include <memory>
+#include <vector>
 
 #include "AudioDevice.h"
 #include "OutputSettings.h"
@@ -34,6 +36,8 @@
 namespace lmms
 {
 
+class LoudnessMeter;
+
 class AudioFileDevice : public AudioDevice
 {
 public:
@@ -42,6 +46,7 @@ public:
 			AudioEngine* audioEngine );
 	~AudioFileDevice() override;
 
+	//! The file written to, "-" for the standard output
 	QString outputFile() const
 	{
 		return m_outputFile.fileName();
@@ -49,10 +54,43 @@ public:
 
 	OutputSettings const & getOutputSettings() const { return m_outputSettings; }
 
+	//! A handle of the original standard output, for devices writing to "-".
+	//! Everything else that is printed there goes to the standard error from
+	//! the first call on, so it can't end up in between the samples.
+	static int takeStandardOutput();
+
+	//! Encodes frames that don't come from the audio engine's output, like
+	//! the stem of a track while exporting, nullptr for silence
+	void writeFrames( const surroundSampleFrame * frames, fpp_t count );
+
+	//! Encodes on a thread of its own from now on, so whoever hands the
+	//! frames to the device doesn't wait for the encoder. Starts the
+	//! copies' encoders as well.
+	void startEncoder();
+
+	//! Encodes what is still queued and stops the encoder threads of the
+	//! device and its copies, has to be called before they are deleted
+	void finishEncoder();
+
+	//! Hands everything this device gets to @p copy as well, which encodes
+	//! it in its own format but has to use the same sample rate
+	void addCopy( AudioFileDevice * copy );
+
+	//! Measures the loudness and peaks of everything the device encodes
+	//! from now on, not those of its copies
+	void enableLoudnessReport();
+
+	//! Writes what was measured as JSON next to the output file, see
+	//! LoudnessMeter::reportFile(). Call after finishEncoder().
+	bool writeLoudnessReport() const;
+
 
 protected:
 	int writeData( const void* data, int len );
 
+	void processBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames ) override;
+
 	inline bool outputFileOpened() const
 	{
 		return m_outputFile.isOpen();
@@ -64,8 +102,21 @@ protected:
 	}
 
 private:
+	class Encoder;
+
+	//! Queues the frames for the encoder thread, or encodes them right away
+	//! if there is none
+	void encode( const surroundSampleFrame * frames, fpp_t count );
+	//! Feeds the loudness meter, if there is one, on the encoding thread
+	void measure( const surroundSampleFrame * frames, fpp_t count );
+
 	QFile m_outputFile;
 	OutputSettings m_outputSettings;
+	std::vector<surroundSampleFrame> m_silence;
+
+	std::unique_ptr<Encoder> m_encoder;
+	std::vector<AudioFileDevice *> m_copies;
+	std::unique_ptr<LoudnessMeter> m_loudnessMeter;
 } ;
 
 using AudioFileDeviceInstantiaton
@@ -0,0 +1,72 @@
+/*
+ * AudioFileRaw.h - audio-device which writes headerless PCM samples, to a
+ *                  file, a named pipe or the standard output
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUDIO_FILE_RAW_H
+#define LMMS_AUDIO_FILE_RAW_H
+
+#include <vector>
+
+#include "AudioFileDevice.h"
+
+namespace lmms
+{
+
+/*! Writes interleaved little endian samples without any header, so they can
+ *  be piped into other programs. 16 bit depth writes signed 16 bit integers,
+ *  24 bit signed 24 bit integers and 32 bit floats.
+ */
+class AudioFileRaw : public AudioFileDevice
+{
+public:
+	AudioFileRaw( OutputSettings const & outputSettings,
+			const ch_cnt_t channels,
+			bool & successful,
+			const QString & file,
+			AudioEngine* audioEngine );
+	~AudioFileRaw() override = default;
+
+	static AudioFileDevice * getInst( const QString & outputFilename,
+					  OutputSettings const & outputSettings,
+					  const ch_cnt_t channels,
+					  AudioEngine* audioEngine,
+					  bool & successful )
+	{
+		return new AudioFileRaw( outputSettings, channels, successful,
+					  outputFilename, audioEngine );
+	}
+
+
+private:
+	void writeBuffer( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						float _master_gain ) override;
+
+	std::vector<char> m_bytes;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_AUDIO_FILE_RAW_H
@@ -35,11 +35,14 @@
 #endif
 
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "AudioDevice.h"
 #include "AudioDeviceSetupWidget.h"
 
+class QCheckBox;
 class QLineEdit;
 
 namespace lmms
@@ -83,6 +86,7 @@ public:
 	private:
 		QLineEdit* m_clientName;
 		gui::LcdSpinBox* m_channels;
+		QCheckBox* m_renderInCallback;
 	};
 
 private slots:
@@ -94,10 +98,9 @@ private:
 	void startProcessing() override;
 	void stopProcessing() override;
 	void applyQualitySettings() override;
+	bool needsFifo() const override { return !m_renderInCallback; }
 
-	void registerPort(AudioPort* port) override;
-	void unregisterPort(AudioPort* port) override;
-	void renamePort(AudioPort* port) override;
+	std::unique_ptr<ChannelOutput> createChannelOutput(const QString& name) override;
 
 	int processCallback(jack_nframes_t nframes);
 
@@ -110,6 +113,9 @@ private:
 	std::atomic<bool> m_stopped;
 
 	std::atomic<MidiJack*> m_midiClient;
+	//! Whether the periods are rendered in the process callback, which saves
+	//! the latency of the FIFO but gives JACK's deadline to the whole engine
+	const bool m_renderInCallback;
 	std::vector<jack_port_t*> m_outputPorts;
 	jack_default_audio_sample_t** m_tempOutBufs;
 	surroundSampleFrame* m_outBuf;
@@ -117,15 +123,13 @@ private:
 	f_cnt_t m_framesDoneInCurBuf;
 	f_cnt_t m_framesToDoInCurBuf;
 
-#ifdef AUDIO_PORT_SUPPORT
-	struct StereoPort
-	{
-		jack_port_t* ports[2];
-	};
-
-	using JackPortMap = QMap<AudioPort*, StereoPort>;
-	JackPortMap m_portMap;
-#endif
+	//! A pair of ports for a mixer channel, which the process callback fills
+	//! from the period the channel wrote that belongs to the master it plays
+	class JackChannelOutput;
+	std::vector<JackChannelOutput*> m_channelOutputs;
+	//! Held by the process callback except while it gets the next period,
+	//! and only briefly by anyone else
+	std::mutex m_channelOutputsMutex;
 
 signals:
 	void zombified();
@@ -0,0 +1,114 @@
+/*
+ * AudioPipeWire.h - support for PipeWire, with ports like JACK
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUDIO_PIPEWIRE_H
+#define LMMS_AUDIO_PIPEWIRE_H
+
+#include "lmmsconfig.h"
+
+#ifdef LMMS_HAVE_PIPEWIRE
+
+#include <pipewire/pipewire.h>
+#include <pipewire/filter.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AudioDevice.h"
+#include "AudioDeviceSetupWidget.h"
+
+class QLineEdit;
+
+namespace lmms
+{
+
+/**
+ * Plays through a PipeWire filter node with mono float ports, the way JACK
+ * clients do, so there is neither the Pulse nor the JACK layer in between nor
+ * another conversion. The node asks for the quantum of a period, and plays
+ * the periods in whatever quantum the graph runs at, which may change any
+ * time. The master ports are linked by the session manager, the ports of the
+ * mixer channels are for patchbays.
+ */
+class AudioPipeWire : public AudioDevice
+{
+public:
+	AudioPipeWire(bool& successful, AudioEngine* audioEngine);
+	~AudioPipeWire() override;
+
+	inline static QString name()
+	{
+		return QT_TRANSLATE_NOOP("AudioDeviceSetupWidget", "PipeWire");
+	}
+
+	class setupWidget : public gui::AudioDeviceSetupWidget
+	{
+	public:
+		setupWidget(QWidget* parent);
+
+		void saveSettings() override;
+
+	private:
+		QLineEdit* m_nodeName;
+	};
+
+private:
+	void startProcessing() override;
+	void stopProcessing() override;
+
+	std::unique_ptr<ChannelOutput> createChannelOutput(const QString& name) override;
+
+	//! A mono output port of the node, or nullptr
+	void* addPort(const QString& name, const char* channel);
+	static void processCallback(void* data, spa_io_position* position);
+	void process(spa_io_position* position);
+
+	pw_thread_loop* m_loop;
+	pw_context* m_context;
+	pw_core* m_core;
+	pw_filter* m_filter;
+	spa_hook m_filterListener;
+	pw_filter_events m_filterEvents;
+
+	std::atomic<bool> m_stopped;
+
+	void* m_masterPorts[2];
+	surroundSampleFrame* m_outBuf;
+	f_cnt_t m_framesDoneInCurBuf;
+	f_cnt_t m_framesToDoInCurBuf;
+
+	class PipeWireChannelOutput;
+	std::vector<PipeWireChannelOutput*> m_channelOutputs;
+	//! Held by the process callback except while it gets the next period,
+	//! and only briefly by anyone else
+	std::mutex m_channelOutputsMutex;
+};
+
+} // namespace lmms
+
+#endif // LMMS_HAVE_PIPEWIRE
+
+#endif // LMMS_AUDIO_PIPEWIRE_H
@@ -25,19 +25,24 @@
 #ifndef LMMS_AUDIO_PORT_H
 #define LMMS_AUDIO_PORT_H
 
+#include <atomic>
 #include <memory>
 #include <QString>
 #include <QMutex>
 
+#include "AudioEngineProfiler.h"
+#include "CompensationDelay.h"
 #include "MemoryManager.h"
 #include "PlayHandle.h"
 
 namespace lmms
 {
 
+class AudioFileDevice;
 class EffectChain;
 class FloatModel;
 class BoolModel;
+class TrackFreezer;
 
 class AudioPort : public ThreadableJob
 {
@@ -98,9 +103,34 @@ public:
 
 	void setName( const QString & _new_name );
 
+	//! Load of the play handles and effects of this port
+	int cpuLoad() const
+	{
+		return m_cpuAccount.load();
+	}
+
+	//! Charge time spent on this port's behalf to it and its mixer channel
+	void addCpuTime( int time );
+
 
 	bool processEffects();
 
+	//! Frames the output of this port lags behind, from its source and its effects
+	f_cnt_t latency() const;
+
+	//! The latency of what plays into this port, e.g. Instrument::latency()
+	void setSourceLatency( f_cnt_t frames )
+	{
+		m_sourceLatency = frames;
+	}
+
+	//! Delay the output by @p frames more, so it arrives at the mixer channel
+	//! together with inputs with more latency - see Mixer::prepareMasterMix()
+	void setCompensation( f_cnt_t frames )
+	{
+		m_compensation.setDelay( frames );
+	}
+
 	// ThreadableJob stuff
 	void doProcessing() override;
 	bool requiresProcessing() const override
@@ -111,8 +141,46 @@ public:
 	void addPlayHandle( PlayHandle * handle );
 	void removePlayHandle( PlayHandle * handle );
 
+	// task graph support: the port queues itself once all inputs have been
+	// processed, see AudioEngine::renderStageGraph()
+	void addPendingInput()
+	{
+		++m_pendingInputs;
+	}
+
+	void inputProcessed();
+
+	//! While set, everything this port sends to its mixer channel is
+	//! also handed to the freezer
+	void setFreezer( TrackFreezer * freezer )
+	{
+		m_freezer = freezer;
+	}
+
+	//! While set, everything this port sends to its mixer channel is
+	//! also written to the stem file, see RenderManager::renderTracks()
+	void setStemFile( AudioFileDevice * stemFile )
+	{
+		m_stemFile = stemFile;
+	}
+
+	//! While set, the captured input plays into this port like a play
+	//! handle, through its effects to its mixer channel
+	void setMonitorInput( bool monitor )
+	{
+		m_monitorInput = monitor;
+	}
+
 private:
+	void processPlayHandles();
+
 	volatile bool m_bufferUsage;
+	// set while m_portBuffer is known to contain nothing but silence
+	bool m_bufferSilent;
+	std::atomic_int m_pendingInputs;
+	TrackFreezer * m_freezer;
+	AudioFileDevice * m_stemFile;
+	std::atomic_bool m_monitorInput;
 
 	sampleFrame * m_portBuffer;
 	QMutex m_portBufferLock;
@@ -121,8 +189,11 @@ private:
 	mix_ch_t m_nextMixerChannel;
 
 	QString m_name;
+	AudioEngineProfiler::Account m_cpuAccount;
 
 	std::unique_ptr<EffectChain> m_effects;
+	std::atomic<f_cnt_t> m_sourceLatency;
+	CompensationDelay m_compensation;
 
 	PlayHandleList m_playHandles;
 	QMutex m_playHandleLock;
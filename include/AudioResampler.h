@@ -26,6 +26,7 @@
 #define LMMS_AUDIO_RESAMPLER_H
 
 #include <samplerate.h>
+#include <vector>
 
 #include "lmms_export.h"
 
@@ -34,6 +35,17 @@ namespace lmms {
 class LMMS_EXPORT AudioResampler
 {
 public:
+	//! Interpolation modes that don't use libsamplerate, for when many voices have to be resampled
+	//! at once. Both are far cheaper than the SINC modes and keep only a few frames of state.
+	//! They can be used wherever one of libsamplerate's converter types can.
+	enum BuiltInMode
+	{
+		//! 4-point Hermite spline, about as cheap as SRC_LINEAR but much smoother
+		CubicHermite = SRC_LINEAR + 1,
+		//! 16-tap windowed sinc from a polyphase table
+		ShortSinc
+	};
+
 	struct ProcessResult
 	{
 		int error;
@@ -50,14 +62,26 @@ public:
 	AudioResampler& operator=(AudioResampler&&) = delete;
 
 	auto resample(const float* in, long inputFrames, float* out, long outputFrames, double ratio) -> ProcessResult;
+	//! Forgets the input so far, to start over with another stream without allocating
+	void reset();
 	auto interpolationMode() const -> int { return m_interpolationMode; }
 	auto channels() const -> int { return m_channels; }
 
 private:
+	template<int Taps, class Kernel>
+	auto resampleBuiltIn(const float* in, long inputFrames, float* out, long outputFrames, double ratio,
+		Kernel kernel) -> ProcessResult;
+
 	int m_interpolationMode = -1;
 	int m_channels = 0;
 	int m_error = 0;
 	SRC_STATE* m_state = nullptr;
+
+	// for the built-in modes: the input frames right before the next input, where in
+	// those the next output frame is, and room to put both together
+	std::vector<float> m_history;
+	double m_position = 0;
+	std::vector<float> m_input;
 };
 } // namespace lmms
 
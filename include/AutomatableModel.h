@@ -28,6 +28,7 @@
 #include <QMap>
 #include <QMutex>
 #include <cmath>
+#include <memory>
 
 #include "JournallingObject.h"
 #include "Model.h"
@@ -214,6 +215,14 @@ public:
 	void setInitValue( const float value );
 
 	void setAutomatedValue( const float value );
+
+	/*! \brief Sets sample-exact automation for @p frames frames of the current
+	 *  period from @p offset on, with @p values like the ones setAutomatedValue()
+	 *  takes. valueBuffer() returns them for the rest of this period, with the
+	 *  frames in between filled with the value() of the model at that time.
+	 */
+	void setAutomatedValues( const float* values, f_cnt_t offset, fpp_t frames );
+
 	void setValue( const float value );
 
 	void incValue( int steps )
@@ -313,6 +322,11 @@ public:
 		s_periodCounter = 0;
 	}
 
+	static long periodCounter()
+	{
+		return s_periodCounter;
+	}
+
 	bool useControllerValue()
 	{
 		return m_useControllerValue;
@@ -323,6 +337,10 @@ public slots:
 	void unlinkControllerConnection();
 	void setUseControllerValue(bool b = true);
 
+private slots:
+	//! Tells every model linked with this one that it changed, see setLinkedValues()
+	void notifyLinkedModels();
+
 
 protected:
 	AutomatableModel(
@@ -371,6 +389,14 @@ private:
 
 	void linkModel( AutomatableModel* model );
 	void unlinkModel( AutomatableModel* model );
+	//! Makes the models linked with this one, directly or through others, one group
+	void regroupLinkedModels();
+
+	//! Gives all models of the group the value this one got, then tells each of
+	//! them once that it changed. The models in between don't pass it on.
+	void setLinkedValues( float value, bool automated );
+	//! The part of setAutomatedValues() for this model only
+	void writeAutomatedValues( const float* values, f_cnt_t offset, fpp_t frames );
 
 	//! @brief Scales @value from linear to logarithmic.
 	//! Value should be within [0,1]
@@ -402,6 +428,14 @@ private:
 
 	AutoModelVector m_linkedModels;
 
+	//! The models linked with each other, shared by all of them
+	struct LinkGroup
+	{
+		AutoModelVector models;
+	} ;
+	std::shared_ptr<LinkGroup> m_linkGroup;
+	bool m_linkedValueChanged;
+
 
 	//! NULL if not appended to controller, otherwise connection info
 	ControllerConnection* m_controllerConnection;
@@ -413,6 +447,11 @@ private:
 
 	bool m_hasSampleExactData;
 
+	// the period setAutomatedValues() was called in last, and how much of
+	// m_valueBuffer it wrote
+	long m_automatedPeriod;
+	f_cnt_t m_automatedFrames;
+
 	// prevent several threads from attempting to write the same vb at the same time
 	QMutex m_valueBufferMutex;
 
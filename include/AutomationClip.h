@@ -27,6 +27,8 @@
 #ifndef LMMS_AUTOMATION_CLIP_H
 #define LMMS_AUTOMATION_CLIP_H
 
+#include <vector>
+
 #include <QMap>
 #include <QPointer>
 #if (QT_VERSION >= QT_VERSION_CHECK(5,14,0))
@@ -171,7 +173,19 @@ public:
 	}
 
 	float valueAt( const TimePos & _time ) const;
-	float *valuesAfter( const TimePos & _time ) const;
+	//! The automation between two ticks, like valuesAt() for a single point in time
+	float valueAt( double time ) const;
+
+	/*! \brief Writes the automation at @p frames points in time into @p values,
+	 *  the first one at @p time and the others @p timeStep ticks apart.
+	 *  Returns false without touching @p values if the automation doesn't change
+	 *  over that range, in which case it's valueAt(time) all the time.
+	 */
+	bool valuesAt( double time, float timeStep, float * values, fpp_t frames ) const;
+
+	//! The automation from the node at or after @p _time up to the next node, every
+	//! @p step ticks, so a view needn't compute more values than it has pixels
+	float *valuesAfter( const TimePos & _time, int step = 1 ) const;
 
 	QString name() const;
 
@@ -207,7 +221,41 @@ private:
 	void cleanObjects();
 	void generateTangents();
 	void generateTangents(timeMap::iterator it, int numToGenerate);
-	float valueAt( timeMap::const_iterator v, int offset ) const;
+
+	/*! The curve from one node to the next one (or from the last node on) as a
+	 *  cubic polynomial in the relative position t, which is 0 at the first node
+	 *  and 1 at the second one. This is what valueAt() evaluates, so it doesn't
+	 *  have to look up the nodes or know about progression types for every value.
+	 */
+	struct Segment
+	{
+		int start;
+		int end;
+		float invLength;
+		float inValue; //!< the value exactly at start, the curve starts at c0
+		float c0, c1, c2, c3;
+
+		bool isFlat() const
+		{
+			return c1 == 0 && c2 == 0 && c3 == 0;
+		}
+
+		float valueAt( float t ) const
+		{
+			return ( ( c3 * t + c2 ) * t + c1 ) * t + c0;
+		}
+	} ;
+
+	//! Has to be called whenever the nodes, their tangents, the progression
+	//! type or the tension change
+	void invalidateSegments()
+	{
+		m_segmentsDirty = true;
+	}
+
+	const std::vector<Segment> & segments() const;
+	//! The segment @p time is in, segments().size() if it's before the first node
+	std::size_t segmentAt( double time ) const;
 
 	/**
 	 * @brief
@@ -245,6 +293,11 @@ private:
 	bool m_isRecording;
 	float m_lastRecordedValue;
 
+	// m_timeMap compiled into segments, rebuilt when needed after a change
+	mutable std::vector<Segment> m_segments;
+	mutable bool m_segmentsDirty = true;
+	mutable std::size_t m_lastSegment = 0;
+
 	static int s_quantization;
 
 	static const float DEFAULT_MIN_VALUE;
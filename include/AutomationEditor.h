@@ -124,7 +124,7 @@ protected:
 	float getLevel( int y );
 	int xCoordOfTick( int tick );
 	float yCoordOfLevel( float level );
-	inline void drawLevelTick(QPainter & p, int tick, float value);
+	inline void drawLevelTick(QPainter & p, int tick, float value, int ticks = 1);
 
 	timeMap::iterator getNodeAt(int x, int y, bool outValue = false, int r = 5);
 	/**
@@ -0,0 +1,93 @@
+/*
+ * AutomationIndex.h - find the automation clips that apply at some time
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_AUTOMATION_INDEX_H
+#define LMMS_AUTOMATION_INDEX_H
+
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "TrackContainer.h"
+
+namespace lmms
+{
+
+class PatternTrack;
+
+
+/*! Knows for every automated model which clips of the song automate it,
+ *  ordered by position. A model takes its value from the last of them
+ *  starting before the play position, so sourcesAt() only has to look at
+ *  one clip per model instead of at every clip of every track.
+ *
+ *  The index is rebuilt on the next lookup after invalidate() was called,
+ *  which happens whenever clips are added, removed or moved, or change
+ *  what they automate. Mute states are checked on every lookup.
+ */
+class LMMS_EXPORT AutomationIndex
+{
+public:
+	using Sources = std::vector<std::pair<AutomatableModel*, AutomationSource>>;
+
+	static void invalidate()
+	{
+		++s_revision;
+	}
+
+	//! Replaces @p sources with where the models automated by the clips
+	//! of @p tracks take their value from at @p time
+	void sourcesAt(const TrackList& tracks, TimePos time, Sources& sources);
+
+private:
+	void rebuild(const TrackList& tracks);
+	std::size_t slotOf(AutomatableModel* model);
+
+	static std::atomic_int s_revision;
+	int m_revision = -1;
+	TrackList m_tracks;
+
+	//! All automation and pattern clips, sorted by start position
+	std::vector<Clip*> m_clips;
+
+	//! The automated models, and which of m_clips automate each of them
+	std::vector<AutomatableModel*> m_models;
+	std::vector<std::vector<std::size_t>> m_modelClips;
+	std::unordered_map<AutomatableModel*, std::size_t> m_modelSlots;
+
+	//! The pattern tracks, and which of m_clips are on each of them
+	std::vector<std::pair<PatternTrack*, std::vector<std::size_t>>> m_patternClips;
+
+	// for each model slot, the source found in the last lookup and which
+	// of m_clips it came from, reused by every lookup
+	std::vector<AutomationSource> m_slotSources;
+	std::vector<std::size_t> m_slotClips;
+	std::vector<std::size_t> m_activePatterns;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_AUTOMATION_INDEX_H
@@ -102,10 +102,7 @@ public:
 	 * @brief Sets the tangent of the left side of the node
 	 * @param Float with the tangent for the inValue side
 	 */
-	inline void setInTangent(float tangent)
-	{
-		m_inTangent = tangent;
-	}
+	void setInTangent(float tangent);
 
 	/**
 	 * @brief Gets the tangent of the right side of the node
@@ -120,10 +117,7 @@ public:
 	 * @brief Sets the tangent of the right side of the node
 	 * @param Float with the tangent for the outValue side
 	 */
-	inline void setOutTangent(float tangent)
-	{
-		m_outTangent = tangent;
-	}
+	void setOutTangent(float tangent);
 
 	/**
 	 * @brief Checks if the tangents from the node are locked
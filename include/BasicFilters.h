@@ -35,7 +35,10 @@
 #define __USE_XOPEN
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <type_traits>
 
 #include "lmms_basics.h"
 #include "lmms_constants.h"
@@ -46,6 +49,36 @@ namespace lmms
 {
 
 template<ch_cnt_t CHANNELS=DEFAULT_CHANNELS> class BasicFilters;
+template<ch_cnt_t CHANNELS> class LinkwitzRileyCrossover;
+
+namespace detail
+{
+
+//! The sine and cosine of 2 pi times @p ratio, linearly interpolated from a
+//! table of one period - plenty for filter coefficients, and a lot cheaper
+//! than sinf() and cosf() when the cutoff follows an envelope
+inline std::array<float, 2> filterSinCos( float ratio )
+{
+	constexpr int Size = 4096;
+	static const auto table = []
+	{
+		std::array<std::array<float, 2>, Size + 1> values;
+		for( int i = 0; i <= Size; ++i )
+		{
+			const double omega = D_2PI * i / Size;
+			values[i] = { static_cast<float>( std::sin( omega ) ), static_cast<float>( std::cos( omega ) ) };
+		}
+		return values;
+	}();
+
+	const float pos = ( ratio - std::floor( ratio ) ) * Size;
+	const int i = std::min( static_cast<int>( pos ), Size - 1 );
+	const float fract = pos - i;
+	return { linearInterpolate( table[i][0], table[i + 1][0], fract ),
+		linearInterpolate( table[i][1], table[i + 1][1], fract ) };
+}
+
+} // namespace detail
 
 template<ch_cnt_t CHANNELS>
 class LinkwitzRiley
@@ -130,6 +163,28 @@ public:
 		return y;
 	}
 
+	//! Filters all channels of a block of frames from @p in to @p out, which may be the same
+	inline void process( const std::array<float, CHANNELS> * in, std::array<float, CHANNELS> * out, fpp_t frames )
+	{
+		for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+		{
+			double z1 = m_z1[ch], z2 = m_z2[ch], z3 = m_z3[ch], z4 = m_z4[ch];
+			for( fpp_t f = 0; f < frames; ++f )
+			{
+				const double x = in[f][ch] - z1 * m_b1 - z2 * m_b2 - z3 * m_b3 - z4 * m_b4;
+				out[f][ch] = m_a0 * x + z1 * m_a1 + z2 * m_a2 + z3 * m_a1 + z4 * m_a0;
+				z4 = z3;
+				z3 = z2;
+				z2 = z1;
+				z1 = x;
+			}
+			m_z1[ch] = z1;
+			m_z2[ch] = z2;
+			m_z3[ch] = z3;
+			m_z4[ch] = z4;
+		}
+	}
+
 private:
 	float m_sampleRate;
 	double m_wc4;
@@ -139,9 +194,91 @@ private:
 	
 	using frame = std::array<double, CHANNELS>;
 	frame m_z1, m_z2, m_z3, m_z4;
+
+	friend class LinkwitzRileyCrossover<CHANNELS>;
 };
 using StereoLinkwitzRiley = LinkwitzRiley<2>;
 
+//! Splits a signal into the bands below and above a frequency, with the low- and
+//! highpass LinkwitzRiley of that frequency. They only differ in the numerator,
+//! so the recursive part, and its state, is shared and computed once for both.
+template<ch_cnt_t CHANNELS>
+class LinkwitzRileyCrossover
+{
+	MM_OPERATORS
+public:
+	LinkwitzRileyCrossover( float sampleRate ) :
+		m_lowpass( sampleRate ),
+		m_highpass( sampleRate )
+	{
+	}
+
+	inline void clearHistory()
+	{
+		m_lowpass.clearHistory();
+	}
+
+	inline void setSampleRate( float sampleRate )
+	{
+		m_lowpass.setSampleRate( sampleRate );
+		m_highpass.setSampleRate( sampleRate );
+	}
+
+	inline void setFrequency( float freq )
+	{
+		m_lowpass.setLowpass( freq );
+		m_highpass.setHighpass( freq );
+	}
+
+	inline void update( float in, ch_cnt_t ch, float & low, float & high )
+	{
+		auto & lp = m_lowpass;
+		const auto & hp = m_highpass;
+		const double x = in - lp.m_z1[ch] * lp.m_b1 - lp.m_z2[ch] * lp.m_b2 - lp.m_z3[ch] * lp.m_b3 - lp.m_z4[ch] * lp.m_b4;
+		low = lp.m_a0 * ( x + lp.m_z4[ch] ) + lp.m_a1 * ( lp.m_z1[ch] + lp.m_z3[ch] ) + lp.m_a2 * lp.m_z2[ch];
+		high = hp.m_a0 * ( x + lp.m_z4[ch] ) + hp.m_a1 * ( lp.m_z1[ch] + lp.m_z3[ch] ) + hp.m_a2 * lp.m_z2[ch];
+		lp.m_z4[ch] = lp.m_z3[ch];
+		lp.m_z3[ch] = lp.m_z2[ch];
+		lp.m_z2[ch] = lp.m_z1[ch];
+		lp.m_z1[ch] = x;
+	}
+
+	//! Splits all channels of a block of frames from @p in into @p low and @p high,
+	//! either of which may be @p in
+	inline void split( const std::array<float, CHANNELS> * in, std::array<float, CHANNELS> * low,
+		std::array<float, CHANNELS> * high, fpp_t frames )
+	{
+		auto & lp = m_lowpass;
+		const auto & hp = m_highpass;
+		for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+		{
+			double z1 = lp.m_z1[ch], z2 = lp.m_z2[ch], z3 = lp.m_z3[ch], z4 = lp.m_z4[ch];
+			for( fpp_t f = 0; f < frames; ++f )
+			{
+				const double x = in[f][ch] - z1 * lp.m_b1 - z2 * lp.m_b2 - z3 * lp.m_b3 - z4 * lp.m_b4;
+				const double outer = x + z4;
+				const double inner = z1 + z3;
+				low[f][ch] = lp.m_a0 * outer + lp.m_a1 * inner + lp.m_a2 * z2;
+				high[f][ch] = hp.m_a0 * outer + hp.m_a1 * inner + hp.m_a2 * z2;
+				z4 = z3;
+				z3 = z2;
+				z2 = z1;
+				z1 = x;
+			}
+			lp.m_z1[ch] = z1;
+			lp.m_z2[ch] = z2;
+			lp.m_z3[ch] = z3;
+			lp.m_z4[ch] = z4;
+		}
+	}
+
+private:
+	//! Also holds the state of both
+	LinkwitzRiley<CHANNELS> m_lowpass;
+	LinkwitzRiley<CHANNELS> m_highpass;
+};
+using StereoLinkwitzRileyCrossover = LinkwitzRileyCrossover<2>;
+
 template<ch_cnt_t CHANNELS>
 class BiQuad
 {
@@ -177,6 +314,64 @@ public:
 		m_z2[ch] = m_b2 * in - m_a2 * out;
 		return out;
 	}
+	//! Filters all channels of a block of frames at once
+	inline void process( std::array<float, CHANNELS> * buf, fpp_t frames )
+	{
+		std::array<float, CHANNELS> z1, z2;
+		std::copy( m_z1, m_z1 + CHANNELS, z1.begin() );
+		std::copy( m_z2, m_z2 + CHANNELS, z2.begin() );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+			{
+				const float in = buf[f][ch];
+				const float out = z1[ch] + m_b0 * in;
+				z1[ch] = m_b1 * in + z2[ch] - m_a1 * out;
+				z2[ch] = m_b2 * in - m_a2 * out;
+				buf[f][ch] = out;
+			}
+		}
+		std::copy( z1.begin(), z1.end(), m_z1 );
+		std::copy( z2.begin(), z2.end(), m_z2 );
+	}
+	//! Like process(), but moves the coefficients linearly from @p from
+	//! (a1, a2, b0, b1, b2) to the ones set, over the block
+	inline void processRamped( std::array<float, CHANNELS> * buf, fpp_t frames, const std::array<float, 5> & from )
+	{
+		const float step = 1.0f / frames;
+		const float da1 = ( m_a1 - from[0] ) * step;
+		const float da2 = ( m_a2 - from[1] ) * step;
+		const float db0 = ( m_b0 - from[2] ) * step;
+		const float db1 = ( m_b1 - from[3] ) * step;
+		const float db2 = ( m_b2 - from[4] ) * step;
+		float a1 = from[0], a2 = from[1], b0 = from[2], b1 = from[3], b2 = from[4];
+
+		std::array<float, CHANNELS> z1, z2;
+		std::copy( m_z1, m_z1 + CHANNELS, z1.begin() );
+		std::copy( m_z2, m_z2 + CHANNELS, z2.begin() );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			a1 += da1;
+			a2 += da2;
+			b0 += db0;
+			b1 += db1;
+			b2 += db2;
+			for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+			{
+				const float in = buf[f][ch];
+				const float out = z1[ch] + b0 * in;
+				z1[ch] = b1 * in + z2[ch] - a1 * out;
+				z2[ch] = b2 * in - a2 * out;
+				buf[f][ch] = out;
+			}
+		}
+		std::copy( z1.begin(), z1.end(), m_z1 );
+		std::copy( z2.begin(), z2.end(), m_z2 );
+	}
+	inline std::array<float, 5> coeffs() const
+	{
+		return { m_a1, m_a2, m_b0, m_b1, m_b2 };
+	}
 private:
 	float m_a1, m_a2, m_b0, m_b1, m_b2;
 	float m_z1 [CHANNELS], m_z2 [CHANNELS];
@@ -260,6 +455,10 @@ public:
 		return( 0.01f );
 	}
 
+	//! Callers modulating cutoff or resonance recalculate the coefficients
+	//! once per this many frames, and process() the frames in between
+	static constexpr fpp_t CoeffUpdateFrames = 16;
+
 	inline void setFilterType( const FilterType _idx )
 	{
 		m_doubleFilter = _idx == FilterType::DoubleLowPass || _idx == FilterType::DoubleMoog;
@@ -340,8 +539,271 @@ public:
 
 	inline sample_t update( sample_t _in0, ch_cnt_t _chnl )
 	{
-		sample_t out;
+		const sample_t out = withFilterType( [this, _in0, _chnl]( auto type )
+		{
+			return updateAs<decltype( type )::value>( _in0, _chnl );
+		} );
+
+		if( m_doubleFilter )
+		{
+			return m_subFilter->update( out, _chnl );
+		}
+		return out;
+	}
+
+	//! Filters all channels of a block of frames, looking up the filter
+	//! type only once
+	inline void process( std::array<sample_t, CHANNELS> * _buf, fpp_t _frames )
+	{
+		withFilterType( [this, _buf, _frames]( auto type )
+		{
+			constexpr auto Type = decltype( type )::value;
+			if constexpr( Type == FilterType::LowPass )
+			{
+				m_biQuad.process( _buf, _frames );
+			}
+			else
+			{
+				for( fpp_t f = 0; f < _frames; ++f )
+				{
+					for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+					{
+						_buf[f][ch] = updateAs<Type>( _buf[f][ch], ch );
+					}
+				}
+			}
+		} );
+
+		if( m_doubleFilter )
+		{
+			m_subFilter->process( _buf, _frames );
+		}
+	}
+
+	//! Sets the coefficients for @p _freq and @p _q, and filters a block of
+	//! frames with them. The biquads move to them linearly from the ones
+	//! before, so the steps of following an envelope don't crackle.
+	inline void processRamped( std::array<sample_t, CHANNELS> * _buf, fpp_t _frames, float _freq, float _q )
+	{
+		const bool biQuad = withFilterType( []( auto type ) { return decltype( type )::value == FilterType::LowPass; } );
+		if( !biQuad || !m_rampable || m_rampType != m_type )
+		{
+			calcFilterCoeffs( _freq, _q );
+			process( _buf, _frames );
+			return;
+		}
+
+		const auto from = m_biQuad.coeffs();
+		calcFilterCoeffs( _freq, _q );
+		m_biQuad.processRamped( _buf, _frames, from );
+		if( m_doubleFilter )
+		{
+			m_subFilter->m_biQuad.processRamped( _buf, _frames, from );
+		}
+	}
+
+
+	inline void calcFilterCoeffs( float _freq, float _q )
+	{
+		m_rampable = true;
+		m_rampType = m_type;
+
+		// temp coef vars
+		_q = std::max(_q, minQ());
+
+		if( m_type == FilterType::Lowpass_RC12  ||
+			m_type == FilterType::Bandpass_RC12 ||
+			m_type == FilterType::Highpass_RC12 ||
+			m_type == FilterType::Lowpass_RC24 ||
+			m_type == FilterType::Bandpass_RC24 ||
+			m_type == FilterType::Highpass_RC24 )
+		{
+			_freq = std::clamp(_freq, 50.0f, 20000.0f);
+			const float sr = m_sampleRatio * 0.25f;
+			const float f = 1.0f / ( _freq * F_2PI );
+			
+			m_rca = 1.0f - sr / ( f + sr );
+			m_rcb = 1.0f - m_rca;
+			m_rcc = f / ( f + sr );
+
+			// Stretch Q/resonance, as self-oscillation reliably starts at a q of ~2.5 - ~2.6
+			m_rcq = _q * 0.25f;
+			return;
+		}
+
+		if( m_type == FilterType::Formantfilter ||
+			m_type == FilterType::FastFormant )
+		{
+			_freq = std::clamp(_freq, minFreq(), 20000.0f); // limit freq and q for not getting bad noise out of the filter...
+
+			// formats for a, e, i, o, u, a
+			static const float _f[6][2] = { { 1000, 1400 }, { 500, 2300 },
+							{ 320, 3200 },
+							{ 500, 1000 },
+							{ 320, 800 },
+							{ 1000, 1400 } };
+			static const float freqRatio = 4.0f / 14000.0f;
+
+			// Stretch Q/resonance
+			m_vfq = _q * 0.25f;
+
+			// frequency in lmms ranges from 1Hz to 14000Hz
+			const float vowelf = _freq * freqRatio;
+			const int vowel = static_cast<int>( vowelf );
+			const float fract = vowelf - vowel;
+
+			// interpolate between formant frequencies
+			const float f0 = 1.0f / ( linearInterpolate( _f[vowel+0][0], _f[vowel+1][0], fract ) * F_2PI );
+			const float f1 = 1.0f / ( linearInterpolate( _f[vowel+0][1], _f[vowel+1][1], fract ) * F_2PI );
+
+			// samplerate coeff: depends on oversampling
+			const float sr = m_type == FilterType::FastFormant ? m_sampleRatio : m_sampleRatio * 0.25f;
+
+			m_vfa[0] = 1.0f - sr / ( f0 + sr );
+			m_vfb[0] = 1.0f - m_vfa[0];
+			m_vfc[0] = f0 /	( f0 + sr );
+			m_vfa[1] = 1.0f - sr / ( f1 + sr );
+			m_vfb[1] = 1.0f - m_vfa[1];
+			m_vfc[1] = f1 /	( f1 + sr );
+			return;
+		}
+
+		if( m_type == FilterType::Moog ||
+			m_type == FilterType::DoubleMoog )
+		{
+			// [ 0 - 0.5 ]
+			const float f = std::clamp(_freq, minFreq(), 20000.0f) * m_sampleRatio;
+			// (Empirical tunning)
+			m_p = ( 3.6f - 3.2f * f ) * f;
+			m_k = 2.0f * m_p - 1;
+			m_r = _q * powf( F_E, ( 1 - m_p ) * 1.386249f );
+
+			if( m_doubleFilter )
+			{
+				m_subFilter->m_r = m_r;
+				m_subFilter->m_p = m_p;
+				m_subFilter->m_k = m_k;
+			}
+			return;
+		}
+		
+		if( m_type == FilterType::Tripole )
+		{
+			const float f = std::clamp(_freq, 20.0f, 20000.0f) * m_sampleRatio * 0.25f;
+			
+			m_p = ( 3.6f - 3.2f * f ) * f;
+			m_k = 2.0f * m_p - 1.0f;
+			m_r = _q * 0.1f * powf( F_E, ( 1 - m_p ) * 1.386249f );
+			
+			return;
+		}
+
+		if( m_type == FilterType::Lowpass_SV || 
+			m_type == FilterType::Bandpass_SV ||
+			m_type == FilterType::Highpass_SV ||
+			m_type == FilterType::Notch_SV )
+		{
+			const float f = detail::filterSinCos(std::max(minFreq(), _freq) * m_sampleRatio * 0.5f)[0];
+			m_svf1 = std::min(f, 0.825f);
+			m_svf2 = std::min(f * 2.0f, 0.825f);
+			m_svq = std::max(0.0001f, 2.0f - (_q * 0.1995f));
+			return;
+		}
+
+		// other filters
+		_freq = std::clamp(_freq, minFreq(), 20000.0f);
+		const auto sinCos = detail::filterSinCos( _freq * m_sampleRatio );
+		const float tsin = sinCos[0] * 0.5f;
+		const float tcos = sinCos[1];
+
+		const float alpha = tsin / _q;
+
+		const float a0 = 1.0f / ( 1.0f + alpha );
+
+		const float a1 = -2.0f * tcos * a0;
+		const float a2 = ( 1.0f - alpha ) * a0;
+
+		switch( m_type )
+		{
+			case FilterType::LowPass:
+			{
+				const float b1 = ( 1.0f - tcos ) * a0;
+				const float b0 = b1 * 0.5f;
+				m_biQuad.setCoeffs( a1, a2, b0, b1, b0 );
+				break;
+			}
+			case FilterType::HiPass:
+			{
+				const float b1 = ( -1.0f - tcos ) * a0;
+				const float b0 = b1 * -0.5f;
+				m_biQuad.setCoeffs( a1, a2, b0, b1, b0 );
+				break;
+			}
+			case FilterType::BandPass_CSG:
+			{
+				const float b0 = tsin * a0;
+				m_biQuad.setCoeffs( a1, a2, b0, 0.0f, -b0 );
+				break;
+			}
+			case FilterType::BandPass_CZPG:
+			{
+				const float b0 = alpha * a0;
+				m_biQuad.setCoeffs( a1, a2, b0, 0.0f, -b0 );
+				break;
+			}
+			case FilterType::Notch:
+			{
+				m_biQuad.setCoeffs( a1, a2, a0, a1, a0 );
+				break;
+			}
+			case FilterType::AllPass:
+			{
+				m_biQuad.setCoeffs( a1, a2, a2, a1, 1.0f );
+				break;
+			}
+			default:
+				break;
+		}
+
+		if( m_doubleFilter )
+		{
+			m_subFilter->m_biQuad.setCoeffs( m_biQuad.m_a1, m_biQuad.m_a2, m_biQuad.m_b0, m_biQuad.m_b1, m_biQuad.m_b2 );
+		}
+	}
+
+
+private:
+	// calls f with the filter type as a std::integral_constant, so the
+	// per-sample code gets compiled once for each of them - all biquad
+	// types share the same code
+	template<class F>
+	inline auto withFilterType( F && f )
+	{
 		switch( m_type )
+		{
+			case FilterType::Moog: return f( std::integral_constant<FilterType, FilterType::Moog>{} );
+			case FilterType::Tripole: return f( std::integral_constant<FilterType, FilterType::Tripole>{} );
+			case FilterType::Lowpass_SV: return f( std::integral_constant<FilterType, FilterType::Lowpass_SV>{} );
+			case FilterType::Bandpass_SV: return f( std::integral_constant<FilterType, FilterType::Bandpass_SV>{} );
+			case FilterType::Highpass_SV: return f( std::integral_constant<FilterType, FilterType::Highpass_SV>{} );
+			case FilterType::Notch_SV: return f( std::integral_constant<FilterType, FilterType::Notch_SV>{} );
+			case FilterType::Lowpass_RC12: return f( std::integral_constant<FilterType, FilterType::Lowpass_RC12>{} );
+			case FilterType::Bandpass_RC12: return f( std::integral_constant<FilterType, FilterType::Bandpass_RC12>{} );
+			case FilterType::Highpass_RC12: return f( std::integral_constant<FilterType, FilterType::Highpass_RC12>{} );
+			case FilterType::Lowpass_RC24: return f( std::integral_constant<FilterType, FilterType::Lowpass_RC24>{} );
+			case FilterType::Bandpass_RC24: return f( std::integral_constant<FilterType, FilterType::Bandpass_RC24>{} );
+			case FilterType::Highpass_RC24: return f( std::integral_constant<FilterType, FilterType::Highpass_RC24>{} );
+			case FilterType::Formantfilter: return f( std::integral_constant<FilterType, FilterType::Formantfilter>{} );
+			case FilterType::FastFormant: return f( std::integral_constant<FilterType, FilterType::FastFormant>{} );
+			default: return f( std::integral_constant<FilterType, FilterType::LowPass>{} );
+		}
+	}
+
+	template<FilterType Type>
+	inline sample_t updateAs( sample_t _in0, ch_cnt_t _chnl )
+	{
+		sample_t out;
+		switch( Type )
 		{
 			case FilterType::Moog:
 			{
@@ -423,7 +885,7 @@ public:
 				}
 
 				/* mix filter output into output buffer */
-				return m_type == FilterType::Lowpass_SV 
+				return Type == FilterType::Lowpass_SV 
 					? m_delay4[_chnl]
 					: m_delay3[_chnl];
 			}
@@ -510,7 +972,7 @@ public:
 					m_rchp0[_chnl] = hp;
 					m_rcbp0[_chnl] = bp;
 				}
-				return m_type == FilterType::Highpass_RC12 ? hp : bp;
+				return Type == FilterType::Highpass_RC12 ? hp : bp;
 			}
 
 			case FilterType::Lowpass_RC24:
@@ -577,7 +1039,7 @@ public:
 					m_rcbp0[_chnl] = bp;
 
 					// second stage gets the output of the first stage as input...
-					in = m_type == FilterType::Highpass_RC24
+					in = Type == FilterType::Highpass_RC24
 						? hp + m_rcbp1[_chnl] * m_rcq
 						: bp + m_rcbp1[_chnl] * m_rcq;
 
@@ -593,7 +1055,7 @@ public:
 					m_rchp1[_chnl] = hp;
 					m_rcbp1[_chnl] = bp;
 				}
-				return m_type == FilterType::Highpass_RC24 ? hp : bp;
+				return Type == FilterType::Highpass_RC24 ? hp : bp;
 			}
 
 			case FilterType::Formantfilter:
@@ -603,7 +1065,7 @@ public:
 				sample_t hp, bp, in;
 
 				out = 0;
-				const int os = m_type == FilterType::FastFormant ? 1 : 4; // no oversampling for fast formant
+				const int os = Type == FilterType::FastFormant ? 1 : 4; // no oversampling for fast formant
 				for( int o = 0; o < os; ++o )
 				{
 					// first formant
@@ -690,7 +1152,7 @@ public:
 
 					out += bp;
 				}
-            	return m_type == FilterType::FastFormant ? out * 2.0f : out * 0.5f;
+            	return Type == FilterType::FastFormant ? out * 2.0f : out * 0.5f;
 			}
 
 			default:
@@ -698,183 +1160,12 @@ public:
 				break;
 		}
 
-		if( m_doubleFilter )
-		{
-			return m_subFilter->update( out, _chnl );
-		}
-
 		// Clipper band limited sigmoid
 		return out;
 	}
 
 
-	inline void calcFilterCoeffs( float _freq, float _q )
-	{
-		// temp coef vars
-		_q = std::max(_q, minQ());
-
-		if( m_type == FilterType::Lowpass_RC12  ||
-			m_type == FilterType::Bandpass_RC12 ||
-			m_type == FilterType::Highpass_RC12 ||
-			m_type == FilterType::Lowpass_RC24 ||
-			m_type == FilterType::Bandpass_RC24 ||
-			m_type == FilterType::Highpass_RC24 )
-		{
-			_freq = std::clamp(_freq, 50.0f, 20000.0f);
-			const float sr = m_sampleRatio * 0.25f;
-			const float f = 1.0f / ( _freq * F_2PI );
-			
-			m_rca = 1.0f - sr / ( f + sr );
-			m_rcb = 1.0f - m_rca;
-			m_rcc = f / ( f + sr );
-
-			// Stretch Q/resonance, as self-oscillation reliably starts at a q of ~2.5 - ~2.6
-			m_rcq = _q * 0.25f;
-			return;
-		}
-
-		if( m_type == FilterType::Formantfilter ||
-			m_type == FilterType::FastFormant )
-		{
-			_freq = std::clamp(_freq, minFreq(), 20000.0f); // limit freq and q for not getting bad noise out of the filter...
-
-			// formats for a, e, i, o, u, a
-			static const float _f[6][2] = { { 1000, 1400 }, { 500, 2300 },
-							{ 320, 3200 },
-							{ 500, 1000 },
-							{ 320, 800 },
-							{ 1000, 1400 } };
-			static const float freqRatio = 4.0f / 14000.0f;
-
-			// Stretch Q/resonance
-			m_vfq = _q * 0.25f;
-
-			// frequency in lmms ranges from 1Hz to 14000Hz
-			const float vowelf = _freq * freqRatio;
-			const int vowel = static_cast<int>( vowelf );
-			const float fract = vowelf - vowel;
-
-			// interpolate between formant frequencies
-			const float f0 = 1.0f / ( linearInterpolate( _f[vowel+0][0], _f[vowel+1][0], fract ) * F_2PI );
-			const float f1 = 1.0f / ( linearInterpolate( _f[vowel+0][1], _f[vowel+1][1], fract ) * F_2PI );
-
-			// samplerate coeff: depends on oversampling
-			const float sr = m_type == FilterType::FastFormant ? m_sampleRatio : m_sampleRatio * 0.25f;
-
-			m_vfa[0] = 1.0f - sr / ( f0 + sr );
-			m_vfb[0] = 1.0f - m_vfa[0];
-			m_vfc[0] = f0 /	( f0 + sr );
-			m_vfa[1] = 1.0f - sr / ( f1 + sr );
-			m_vfb[1] = 1.0f - m_vfa[1];
-			m_vfc[1] = f1 /	( f1 + sr );
-			return;
-		}
-
-		if( m_type == FilterType::Moog ||
-			m_type == FilterType::DoubleMoog )
-		{
-			// [ 0 - 0.5 ]
-			const float f = std::clamp(_freq, minFreq(), 20000.0f) * m_sampleRatio;
-			// (Empirical tunning)
-			m_p = ( 3.6f - 3.2f * f ) * f;
-			m_k = 2.0f * m_p - 1;
-			m_r = _q * powf( F_E, ( 1 - m_p ) * 1.386249f );
 
-			if( m_doubleFilter )
-			{
-				m_subFilter->m_r = m_r;
-				m_subFilter->m_p = m_p;
-				m_subFilter->m_k = m_k;
-			}
-			return;
-		}
-		
-		if( m_type == FilterType::Tripole )
-		{
-			const float f = std::clamp(_freq, 20.0f, 20000.0f) * m_sampleRatio * 0.25f;
-			
-			m_p = ( 3.6f - 3.2f * f ) * f;
-			m_k = 2.0f * m_p - 1.0f;
-			m_r = _q * 0.1f * powf( F_E, ( 1 - m_p ) * 1.386249f );
-			
-			return;
-		}
-
-		if( m_type == FilterType::Lowpass_SV || 
-			m_type == FilterType::Bandpass_SV ||
-			m_type == FilterType::Highpass_SV ||
-			m_type == FilterType::Notch_SV )
-		{
-			const float f = sinf(std::max(minFreq(), _freq) * m_sampleRatio * F_PI);
-			m_svf1 = std::min(f, 0.825f);
-			m_svf2 = std::min(f * 2.0f, 0.825f);
-			m_svq = std::max(0.0001f, 2.0f - (_q * 0.1995f));
-			return;
-		}
-
-		// other filters
-		_freq = std::clamp(_freq, minFreq(), 20000.0f);
-		const float omega = F_2PI * _freq * m_sampleRatio;
-		const float tsin = sinf( omega ) * 0.5f;
-		const float tcos = cosf( omega );
-
-		const float alpha = tsin / _q;
-
-		const float a0 = 1.0f / ( 1.0f + alpha );
-
-		const float a1 = -2.0f * tcos * a0;
-		const float a2 = ( 1.0f - alpha ) * a0;
-
-		switch( m_type )
-		{
-			case FilterType::LowPass:
-			{
-				const float b1 = ( 1.0f - tcos ) * a0;
-				const float b0 = b1 * 0.5f;
-				m_biQuad.setCoeffs( a1, a2, b0, b1, b0 );
-				break;
-			}
-			case FilterType::HiPass:
-			{
-				const float b1 = ( -1.0f - tcos ) * a0;
-				const float b0 = b1 * -0.5f;
-				m_biQuad.setCoeffs( a1, a2, b0, b1, b0 );
-				break;
-			}
-			case FilterType::BandPass_CSG:
-			{
-				const float b0 = tsin * a0;
-				m_biQuad.setCoeffs( a1, a2, b0, 0.0f, -b0 );
-				break;
-			}
-			case FilterType::BandPass_CZPG:
-			{
-				const float b0 = alpha * a0;
-				m_biQuad.setCoeffs( a1, a2, b0, 0.0f, -b0 );
-				break;
-			}
-			case FilterType::Notch:
-			{
-				m_biQuad.setCoeffs( a1, a2, a0, a1, a0 );
-				break;
-			}
-			case FilterType::AllPass:
-			{
-				m_biQuad.setCoeffs( a1, a2, a2, a1, 1.0f );
-				break;
-			}
-			default:
-				break;
-		}
-
-		if( m_doubleFilter )
-		{
-			m_subFilter->m_biQuad.setCoeffs( m_biQuad.m_a1, m_biQuad.m_a2, m_biQuad.m_b0, m_biQuad.m_b1, m_biQuad.m_b2 );
-		}
-	}
-
-
-private:
 	// biquad filter
 	BiQuad<CHANNELS> m_biQuad;
 
@@ -909,6 +1200,9 @@ private:
 
 	FilterType m_type;
 	bool m_doubleFilter;
+	// whether there are coefficients to ramp from, and of which type
+	bool m_rampable = false;
+	FilterType m_rampType;
 
 	float m_sampleRate;
 	float m_sampleRatio;
@@ -0,0 +1,119 @@
+/*
+ * BatchRenderer.h - renders many projects with a pool of worker processes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_BATCH_RENDERER_H
+#define LMMS_BATCH_RENDERER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AudioEngine.h"
+#include "OutputSettings.h"
+#include "ProjectRenderer.h"
+
+class QProcess;
+
+namespace lmms {
+
+class RenderManager;
+
+/**
+ * Renders the projects of a list with a few worker processes. Every worker
+ * is started once and renders one project after the other as it is handed
+ * them on its standard input, so starting up, scanning the plugins and
+ * decoding the samples that several projects use (see SampleCache) is paid
+ * per worker, not per project.
+ */
+class BatchRenderer : public QObject
+{
+	Q_OBJECT
+public:
+	//! Prepares to render the projects listed in @p listFile, one per line, with @p jobs
+	//! workers that are started with @p workerArguments, which is the render options
+	BatchRenderer(const QString& listFile, int jobs, const QStringList& workerArguments);
+	~BatchRenderer() override;
+
+	//! Whether there's anything to render
+	auto isReady() const -> bool { return !m_projects.isEmpty(); }
+
+	void start();
+
+	//! What a worker process does: renders every project that arrives on the standard input
+	//! to @p outputDir, or next to the project if it's empty, and reports on the standard output.
+	//! @p configure sets up the RenderManager of each project with the rest of the options.
+	static auto work(const AudioEngine::qualitySettings& qualitySettings, const OutputSettings& outputSettings,
+		ProjectRenderer::ExportFileFormat format, bool loop, const QString& outputDir,
+		const std::function<void(RenderManager&)>& configure) -> int;
+
+signals:
+	//! All projects were rendered, @p successful if none of them failed
+	void finished(bool successful);
+
+private:
+	struct Worker
+	{
+		QProcess* process = nullptr;
+		//! The project being rendered, -1 if none
+		int project = -1;
+		int progress = 0;
+		QElapsedTimer timer;
+		QByteArray output;
+		QByteArray log;
+	};
+
+	struct Result
+	{
+		bool done = false;
+		bool successful = false;
+		qint64 milliseconds = 0;
+	};
+
+	void startWorker(Worker& worker);
+	void handOut(Worker& worker);
+	void readOutput(Worker& worker);
+	void complete(Worker& worker, bool successful);
+	void workerFinished(Worker& worker);
+
+	void printProgress() const;
+	void printReport() const;
+
+	QStringList m_projects;
+	std::vector<Result> m_results;
+	QStringList m_workerArguments;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+
+	int m_next = 0;
+	int m_done = 0;
+	QElapsedTimer m_timer;
+	QTimer m_progressTimer;
+};
+
+} // namespace lmms
+
+#endif // LMMS_BATCH_RENDERER_H
@@ -26,6 +26,8 @@
 #ifndef LMMS_BUFFER_MANAGER_H
 #define LMMS_BUFFER_MANAGER_H
 
+#include <cstddef>
+
 #include "lmms_export.h"
 #include "lmms_basics.h"
 
@@ -33,10 +35,17 @@ namespace lmms
 {
 
 
+/*! Hands out buffers of one period each. They come from a preallocated
+ *  pool of cache-line aligned buffers kept in a lock-free free list, so
+ *  taking and returning them is safe and cheap on the audio threads. When
+ *  the pool runs low, a background thread adds more buffers to it.
+ */
 class LMMS_EXPORT BufferManager
 {
 public:
 	static void init( fpp_t fpp );
+	//! Stops growing the pool. Buffers may still be released afterwards.
+	static void cleanup();
 	static sampleFrame * acquire();
 	// audio-buffer-mgm
 	static void clear( sampleFrame * ab, const f_cnt_t frames,
@@ -46,6 +55,8 @@ public:
 						const f_cnt_t offset = 0 );
 #endif
 	static void release( sampleFrame * buf );
+	//! Bytes allocated for the pool, in use or not
+	static std::size_t poolBytes();
 
 private:
 	static fpp_t s_framesPerPeriod;
@@ -0,0 +1,88 @@
+/*
+ * ChannelOutput.h - an output of a single mixer channel offered by a driver
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CHANNEL_OUTPUT_H
+#define LMMS_CHANNEL_OUTPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+class QString;
+
+namespace lmms
+{
+
+/**
+ * What a mixer channel outputs besides the master, for drivers that have
+ * outputs of their own for channels - see AudioDevice::createChannelOutput().
+ *
+ * The channel writes every period at the end of its job, split into the left
+ * and the right samples drivers like JACK need, and tagged with the number of
+ * the period. There are as many slots as periods can be on their way from the
+ * audio engine to the driver, so the driver finds the period of the channel
+ * that belongs to the master it is playing without any further copy or lock,
+ * and plays silence where the channel wrote nothing.
+ */
+class LMMS_EXPORT ChannelOutput
+{
+public:
+	ChannelOutput( int periods, fpp_t framesPerPeriod );
+	virtual ~ChannelOutput() = default;
+
+	virtual void rename( const QString & name ) = 0;
+
+	//! Store @p frames of @p buf multiplied by @p gain as period @p period,
+	//! called by the mixer channel on the thread that processed it
+	void write( const sampleFrame * buf, fpp_t frames, float gain, std::uint64_t period );
+
+protected:
+	// for drivers that play every side of a channel into a buffer of its own,
+	// along with the master and in chunks of their own
+
+	//! Play @p period from now on, which is silence for 0 or if the channel
+	//! didn't write anything in that period
+	void playPeriod( std::uint64_t period );
+	//! Copy @p frames from @p offset on of the period being played into @p left
+	//! and @p right, either of which may be nullptr
+	void play( sample_t * left, sample_t * right, f_cnt_t offset, f_cnt_t frames ) const;
+
+private:
+	const fpp_t m_framesPerPeriod;
+	std::vector<sample_t> m_samples;
+	//! The period in every slot, 0 for none
+	std::unique_ptr<std::atomic<std::uint64_t>[]> m_periods;
+	const int m_slots;
+
+	//! The left samples of the period being played followed by the right ones
+	const sample_t * m_playing = nullptr;
+};
+
+} // namespace lmms
+
+#endif // LMMS_CHANNEL_OUTPUT_H
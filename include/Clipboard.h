@@ -25,12 +25,21 @@
 #ifndef LMMS_CLIPBOARD_H
 #define LMMS_CLIPBOARD_H
 
+#include <any>
+#include <functional>
+
 #include <QDomElement>
 #include <QMap>
+#include <QMimeData>
 
 #include "lmms_export.h"
 
-class QMimeData;
+namespace lmms
+{
+
+class DataFile;
+
+} // namespace lmms
 
 namespace lmms::Clipboard
 {
@@ -54,6 +63,58 @@ namespace lmms::Clipboard
 	QString decodeKey( const QMimeData * mimeData );
 	QString decodeValue( const QMimeData * mimeData );
 
+	/*! What's copied or dragged within this instance: the value is kept as
+	 *  it is and shared with every paste, and only written as the string of
+	 *  its format when another process, or code that wants the string, asks
+	 *  for it. The key is that of a string pair, empty for MimeType::Default.
+	 */
+	class LMMS_EXPORT LocalMimeData : public QMimeData
+	{
+	public:
+		LocalMimeData( MimeType type, const QString & key, std::any value,
+			std::function<QString()> serialize );
+
+		QStringList formats() const override;
+		bool hasFormat( const QString & mimeType ) const override;
+
+		const QString & key() const
+		{
+			return m_key;
+		}
+
+		const std::any & value() const
+		{
+			return m_value;
+		}
+
+	protected:
+		QVariant retrieveData( const QString & mimeType, QVariant::Type type ) const override;
+
+	private:
+		MimeType m_type;
+		QString m_key;
+		std::any m_value;
+		std::function<QString()> m_serialize;
+		mutable QByteArray m_serialized;
+	} ;
+
+	//! Copies @p value with the string @p serialize makes of it for other processes
+	void LMMS_EXPORT copyLocal( MimeType mT, const QString & key, std::any value,
+		std::function<QString()> serialize );
+
+	//! The value of @p mimeData if it was copied or dragged within this
+	//! instance as a T, nullptr otherwise
+	template<class T>
+	const T * localValue( const QMimeData * mimeData )
+	{
+		const auto local = dynamic_cast<const LocalMimeData *>( mimeData );
+		return local != nullptr ? std::any_cast<T>( &local->value() ) : nullptr;
+	}
+
+	//! The value of a string pair as a DataFile, which isn't parsed again if
+	//! it was copied as one within this instance
+	DataFile LMMS_EXPORT decodeDataFile( const QMimeData * mimeData );
+
 	inline const char * mimeType( MimeType type )
 	{
 		switch( type )
@@ -0,0 +1,67 @@
+/*
+ * CompensationDelay.h - delays audio to line it up with audio that has latency
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_COMPENSATION_DELAY_H
+#define LMMS_COMPENSATION_DELAY_H
+
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+namespace lmms {
+
+/**
+ * Plugin delay compensation for one signal path: delays stereo audio by a
+ * whole number of frames, so it arrives together with audio from other
+ * paths that went through effects with latency (see Effect::latency()).
+ */
+class LMMS_EXPORT CompensationDelay
+{
+public:
+	auto delay() const -> f_cnt_t { return m_delay; }
+
+	//! Changes the delay, which drops what was delayed so far. Only allocates
+	//! when the delay grows beyond what it was before.
+	void setDelay(f_cnt_t frames);
+
+	//! Delays @p frames frames in @p buf, which are audio if @p hasInput. Otherwise
+	//! they count as silence, and are left alone if there's nothing to come out.
+	void process(sampleFrame* buf, fpp_t frames, bool hasInput);
+
+	//! Whether audio that went in hasn't come out completely yet, so the
+	//! output mustn't be skipped even if the input is silent
+	auto hasTail() const -> bool { return m_tail > 0; }
+
+private:
+	std::vector<sampleFrame> m_buffer;
+	f_cnt_t m_delay = 0;
+	f_cnt_t m_position = 0;
+	//! How many frames of audio are still in the buffer
+	f_cnt_t m_tail = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_COMPENSATION_DELAY_H
@@ -26,6 +26,9 @@
 #ifndef LMMS_CONTROLLER_H
 #define LMMS_CONTROLLER_H
 
+#include <QMutex>
+#include <vector>
+
 #include "lmms_export.h"
 #include "Engine.h"
 #include "Model.h"
@@ -72,6 +75,17 @@ public:
 	// The per-controller get-value-in-buffers function
 	virtual ValueBuffer * valueBuffer();
 
+	//! Whether the last buffer holds the same value throughout, so consumers
+	//! can use currentValue() instead of reading it
+	bool isConstant() const
+	{
+		return m_constant;
+	}
+
+	//! Whether anything reads the controller: a connection to a model that
+	//! isn't a controller's own, or to one of a controller that is used itself
+	bool isUsed() const;
+
 	inline bool isSampleExact() const
 	{
 		return m_sampleExact;
@@ -130,7 +144,6 @@ public:
 	static void triggerFrameCounter();
 	static void resetFrameCounter();
 
-	//Accepts a ControllerConnection * as it may be used in the future.
 	void addConnection( ControllerConnection * );
 	void removeConnection( ControllerConnection * );
 	int connectionCount() const;
@@ -152,6 +165,9 @@ protected:
 
 	virtual void updateValueBuffer();
 
+	// updates the buffer and finds out whether it's constant and changed
+	void update();
+
 	// buffer for storing sample-exact values in case there
 	// are more than one model wanting it, so we don't have to create it
 	// again every time
@@ -161,7 +177,17 @@ protected:
 
 	float m_currentValue;
 	bool  m_sampleExact;
-	int m_connectionCount;
+	std::vector<ControllerConnection*> m_connections;
+	mutable QMutex m_connectionsMutex;
+
+	// whether the last buffer holds only one value, and whether that differs
+	// from the last value of the buffer before, so valueChanged() can be left
+	// out when nothing changes
+	bool m_constant;
+	bool m_changed;
+	float m_lastBufferValue;
+	// guards isUsed() against controllers controlling each other
+	mutable bool m_visiting;
 
 	QString m_name;
 	ControllerType m_type;
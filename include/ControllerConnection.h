@@ -80,6 +80,17 @@ public:
 
 	inline void setTargetName( const QString & _name );
 
+	//! The controller whose own model this connection controls, if any
+	Controller * consumer() const
+	{
+		return m_consumer;
+	}
+
+	void setConsumer( Controller * consumer )
+	{
+		m_consumer = consumer;
+	}
+
 	inline QString targetName() const
 	{
 		return m_targetName;
@@ -115,6 +126,7 @@ protected:
 	int m_controllerId;
 	
 	bool m_ownsController;
+	Controller * m_consumer = nullptr;
 
 	static ControllerConnectionVector s_connections;
 
@@ -0,0 +1,83 @@
+/*
+ * CurveTable.h - maps values through a graph without branches
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_CURVE_TABLE_H
+#define LMMS_CURVE_TABLE_H
+
+#include <algorithm>
+#include <array>
+
+namespace lmms
+{
+
+/**
+ * The curve drawn in a graph of Points values over [0, 1], like the ones of
+ * WaveShaper and DynamicsProcessor, as a line segment per point. Mapping a
+ * value through it is a table lookup and a multiply-add, without the
+ * branches on where the value falls, so loops over a buffer stay flat.
+ *
+ * The curve starts at 0 and goes through the points linearly interpolated;
+ * update() has to be called whenever they may have changed.
+ */
+template<int Points>
+class CurveTable
+{
+public:
+	//! What the curve does past the last point
+	enum class Beyond
+	{
+		Proportional,	// continues along the line through 0, e.g. for a wave shaper
+		Constant	// stays at the last value
+	};
+
+	void update( const float * points, Beyond beyond )
+	{
+		m_offset[0] = 0.0f;
+		m_slope[0] = points[0];
+		for( int i = 1; i < Points; ++i )
+		{
+			m_offset[i] = points[i - 1];
+			m_slope[i] = points[i] - points[i - 1];
+		}
+		m_offset[Points] = points[Points - 1];
+		m_slope[Points] = beyond == Beyond::Proportional ? points[Points - 1] / Points : 0.0f;
+	}
+
+	//! The curve at @p x, which has to be >= 0
+	float operator()( float x ) const
+	{
+		const float scaled = x * Points;
+		const int index = static_cast<int>( std::min( scaled, static_cast<float>( Points ) ) );
+		return m_offset[index] + m_slope[index] * ( scaled - index );
+	}
+
+private:
+	//! Segment i goes from x = i / Points on, the last one to infinity
+	std::array<float, Points + 1> m_offset = {};
+	std::array<float, Points + 1> m_slope = {};
+};
+
+} // namespace lmms
+
+#endif // LMMS_CURVE_TABLE_H
@@ -38,6 +38,7 @@ namespace lmms
 {
 
 class ProjectVersion;
+class SampleBuffer;
 
 
 class LMMS_EXPORT DataFile : public QDomDocument
@@ -75,7 +76,9 @@ public:
 	QString nameWithExtension( const QString& fn ) const;
 
 	void write( QTextStream& strm );
-	bool writeFile(const QString& fn, bool withResources = false);
+	//! Writes to @p fn, keeping what was there before as a backup unless @p keepBackup is false
+	//! or backups are disabled, in which case the file is replaced in one go
+	bool writeFile(const QString& fn, bool withResources = false, bool keepBackup = true);
 	bool copyResources(const QString& resourcesDir); //!< Copies resources to the resourcesDir and changes the DataFile to use local paths to them
 	bool hasLocalPlugins(QDomElement parent = QDomElement(), bool firstCall = true) const;
 
@@ -139,16 +142,26 @@ private:
 	// Map with DOM elements that access resources (for making bundles)
 	using ResourcesMap = std::map<QString, std::vector<QString>>;
 	static const ResourcesMap ELEMENTS_WITH_RESOURCES;
+	static const std::map<QString, QString> EMBEDDED_SAMPLE_ATTRIBUTES;
+
+	//! Whether FLAC's 24 bits hold the frames of @p buffer without changing them
+	static bool isLossless24Bit(const SampleBuffer& buffer);
+	//! Writes @p buffer as 24 bit FLAC if @p flac, as float WAV otherwise
+	static bool writeSampleFile(const SampleBuffer& buffer, const QString& fileName, bool flac);
 
 	void upgrade();
 
 	void loadData( const QByteArray & _data, const QString & _sourceFile );
 
+	//! Where the upgraded copy of @p fileName is kept, or "" if there's nowhere to keep it
+	static QString upgradeCacheFile(const QString& fileName);
+
 	QString m_fileName; //!< The origin file name or "" if this DataFile didn't originate from a file
 	QDomElement m_content;
 	QDomElement m_head;
 	Type m_type;
 	unsigned int m_fileVersion;
+	bool m_upgraded = false; //!< Whether upgrade() had to run when loading
 
 } ;
 
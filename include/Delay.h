@@ -26,6 +26,9 @@
 #ifndef LMMS_DELAY_H
 #define LMMS_DELAY_H
 
+#include <algorithm>
+#include <vector>
+
 #include "lmms_basics.h"
 #include "lmms_math.h"
 #include "interpolation.h"
@@ -42,6 +45,7 @@ namespace lmms
 // CombFeedfwd: a feed-forward comb filter - an "inverted" comb filter, can be combined with CombFeedback to create a net allpass if negative gain is used
 // CombFeedbackDualtap: same as CombFeedback but takes two delay values
 // AllpassDelay: an allpass delay - combines feedback and feed-forward - has flat frequency response
+// DelayLine: just the delay line, written one frame at a time and read from anywhere in its history
 
 // all classes are templated with channel count, any arbitrary channel count can be used for each fx
 
@@ -61,6 +65,11 @@ namespace lmms
 
 // update runs the fx for one frame - takes as arguments input and number of channel to run, returns output
 
+// DelayLine is different: it has no gain of its own, write adds a frame and tap reads the one
+// written a given number of frames before - either a whole number of frames, or with a fraction
+// by linear interpolation, for modulated delays. Its size is a power of two, so wrapping around
+// is just a mask.
+
 template<ch_cnt_t CHANNELS>
 class CombFeedback
 {
@@ -70,7 +79,7 @@ public:
 	CombFeedback( int maxDelay ) :
 		m_size( maxDelay ),
 		m_position( 0 ),
-		m_feedBack( 0.0 ),
+		m_gain( 0.0 ),
 		m_delay( 0 ),
 		m_fraction( 0.0 )
 	{
@@ -136,12 +145,13 @@ private:
 template<ch_cnt_t CHANNELS>
 class CombFeedfwd
 {
+public:
 	using frame = std::array<double, CHANNELS>;
 
 	CombFeedfwd( int maxDelay ) :
 		m_size( maxDelay ),
 		m_position( 0 ),
-		m_feedBack( 0.0 ),
+		m_gain( 0.0 ),
 		m_delay( 0 ),
 		m_fraction( 0.0 )
 	{
@@ -207,14 +217,17 @@ private:
 template<ch_cnt_t CHANNELS>
 class CombFeedbackDualtap
 {
+public:
 	using frame = std::array<double, CHANNELS>;
 
 	CombFeedbackDualtap( int maxDelay ) :
 		m_size( maxDelay ),
 		m_position( 0 ),
-		m_feedBack( 0.0 ),
-		m_delay( 0 ),
-		m_fraction( 0.0 )
+		m_gain( 0.0 ),
+		m_delay1( 0 ),
+		m_delay2( 0 ),
+		m_fraction1( 0.0 ),
+		m_fraction2( 0.0 )
 	{
 		m_buffer = MM_ALLOC<frame>( maxDelay );
 		memset( m_buffer, 0, sizeof( frame ) * maxDelay );
@@ -293,7 +306,7 @@ public:
 	AllpassDelay( int maxDelay ) :
 		m_size( maxDelay ),
 		m_position( 0 ),
-		m_feedBack( 0.0 ),
+		m_gain( 0.0 ),
 		m_delay( 0 ),
 		m_fraction( 0.0 )
 	{
@@ -356,11 +369,82 @@ private:
 	double m_fraction;	
 };
 
+template<ch_cnt_t CHANNELS>
+class DelayLine
+{
+public:
+	using frame = std::array<float, CHANNELS>;
+
+	DelayLine( int maxDelay )
+	{
+		setMaxDelay( maxDelay );
+	}
+
+	//! Lets the line hold delays up to @p maxDelay frames, which clears it if it had to grow
+	inline void setMaxDelay( int maxDelay )
+	{
+		m_maxDelay = std::max( maxDelay, 1 );
+		// one more frame to interpolate towards
+		std::size_t size = 1;
+		while( size < static_cast<std::size_t>( m_maxDelay ) + 2 ) { size *= 2; }
+		if( size != m_buffer.size() )
+		{
+			m_buffer.assign( size, frame{} );
+			m_mask = size - 1;
+			m_position = 0;
+		}
+	}
+
+	inline int maxDelay() const
+	{
+		return m_maxDelay;
+	}
+
+	inline void clearHistory()
+	{
+		std::fill( m_buffer.begin(), m_buffer.end(), frame{} );
+	}
+
+	inline void write( const frame & in )
+	{
+		m_buffer[m_position] = in;
+		m_position = ( m_position + 1 ) & m_mask;
+	}
+
+	//! The frame written @p delay frames ago, 1 being the last one
+	inline const frame & tap( int delay ) const
+	{
+		return m_buffer[( m_position - delay ) & m_mask];
+	}
+
+	//! The frame written @p delay frames ago, interpolated between the two closest ones
+	inline frame tap( float delay ) const
+	{
+		const int whole = static_cast<int>( delay );
+		const float fraction = delay - whole;
+		const frame & newer = tap( whole );
+		const frame & older = tap( whole + 1 );
+		frame out;
+		for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+		{
+			out[ch] = linearInterpolate( newer[ch], older[ch], fraction );
+		}
+		return out;
+	}
+
+private:
+	std::vector<frame> m_buffer;
+	std::size_t m_mask = 0;
+	std::size_t m_position = 0;
+	int m_maxDelay = 0;
+};
+
 // convenience typedefs for stereo effects
 using StereoCombFeedback = CombFeedback<2>;
 using StereoCombFeedfwd = CombFeedfwd<2>;
 using StereoCombFeedbackDualtap = CombFeedbackDualtap<2>;
 using StereoAllpassDelay = AllpassDelay<2>;
+using StereoDelayLine = DelayLine<2>;
 
 } // namespace lmms
 
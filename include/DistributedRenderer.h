@@ -0,0 +1,130 @@
+/*
+ * DistributedRenderer.h - renders segments of a song with several processes and joins them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_DISTRIBUTED_RENDERER_H
+#define LMMS_DISTRIBUTED_RENDERER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "OutputSettings.h"
+#include "ProjectRenderer.h"
+#include "lmms_basics.h"
+
+class QProcess;
+class QTemporaryFile;
+
+namespace lmms {
+
+/**
+ * Renders a long song faster by splitting its timeline into a segment per
+ * worker, which renders it in a process of its own - on this machine or, when
+ * the worker is started through something like ssh, on another one that has
+ * the project and its samples at the same path.
+ *
+ * A segment starts rendering some bars early, so the effect tails and the
+ * state of the instruments are there by the time it begins, and goes on for a
+ * beat after it ends. The workers send the audio and where the segment begins
+ * and ends in it, down to the frame. Where two segments meet, the beat they
+ * both rendered is crossfaded, and reported if it differs audibly, which
+ * takes a longer pre-roll.
+ */
+class DistributedRenderer : public QObject
+{
+	Q_OBJECT
+public:
+	//! Prepares to render the song of @p project, which is @p length ticks long, to
+	//! @p output, with @p workers, the commands that start LMMS - this one if empty - and
+	//! @p workerArguments, the render options. Every segment starts rendering @p preroll
+	//! ticks early.
+	DistributedRenderer(const QString& project, tick_t length, tick_t preroll, const QStringList& workers,
+		const QStringList& workerArguments, const OutputSettings& outputSettings,
+		ProjectRenderer::ExportFileFormat format, const QString& output);
+	~DistributedRenderer() override;
+
+	//! Encodes into @p format as well, see RenderManager::addFormat()
+	void addFormat(ProjectRenderer::ExportFileFormat format);
+	void setLoudnessReport(bool report) { m_loudnessReport = report; }
+
+	void start();
+
+	//! The options a worker renders its segment with, which it is given by start()
+	static auto segmentArguments(tick_t begin, tick_t end, tick_t preroll) -> QStringList;
+	//! What a worker does once it rendered its segment: reports where it begins and ends
+	static void reportSegment(f_cnt_t beginFrame, f_cnt_t endFrame);
+	//! What a worker does while rendering
+	static void reportProgress(int progress);
+
+signals:
+	//! All segments were rendered and joined, or one of them failed
+	void finished(bool successful);
+
+private:
+	struct Segment
+	{
+		tick_t begin = 0;
+		tick_t end = 0;
+		QProcess* process = nullptr;
+		//! The raw audio the worker sends, pre-roll and overlap included
+		std::unique_ptr<QTemporaryFile> audio;
+		f_cnt_t beginFrame = -1;
+		f_cnt_t endFrame = -1;
+		int progress = 0;
+		bool done = false;
+		QByteArray errors;
+		QByteArray log;
+	};
+
+	void readAudio(Segment& segment);
+	void readErrors(Segment& segment);
+	void workerFinished(Segment& segment);
+
+	//! Writes the segments one after the other, crossfading where they meet
+	auto join() -> bool;
+
+	void printProgress() const;
+
+	QString m_project;
+	tick_t m_preroll;
+	QStringList m_workers;
+	QStringList m_workerArguments;
+	std::vector<std::unique_ptr<Segment>> m_segments;
+
+	OutputSettings m_outputSettings;
+	ProjectRenderer::ExportFileFormat m_format;
+	QString m_output;
+	std::vector<ProjectRenderer::ExportFileFormat> m_copyFormats;
+	bool m_loudnessReport = false;
+
+	int m_done = 0;
+	bool m_failed = false;
+	QTimer m_progressTimer;
+};
+
+} // namespace lmms
+
+#endif // LMMS_DISTRIBUTED_RENDERER_H
@@ -26,9 +26,14 @@
 #ifndef LMMS_EFFECT_H
 #define LMMS_EFFECT_H
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "Plugin.h"
 #include "Engine.h"
 #include "AudioEngine.h"
+#include "AudioResampler.h"
 #include "AutomatableModel.h"
 #include "TempoSyncKnobModel.h"
 #include "MemoryManager.h"
@@ -38,6 +43,7 @@ namespace lmms
 
 class EffectChain;
 class EffectControls;
+class PlanarBuffer;
 
 namespace gui
 {
@@ -69,6 +75,70 @@ public:
 	virtual bool processAudioBuffer( sampleFrame * _buf,
 						const fpp_t _frames ) = 0;
 
+	//! Effects which work on every channel separately anyway can return
+	//! true here, the effect chain then calls processPlanarBuffer() instead
+	//! and only converts between layouts when the next effect needs another
+	virtual bool processesPlanar() const
+	{
+		return false;
+	}
+
+	virtual bool processPlanarBuffer( PlanarBuffer &, const fpp_t )
+	{
+		return false;
+	}
+
+	//! Effects which process every frame on its own, like simple gains and
+	//! filters, can return true here and implement startFrames(),
+	//! processFrame() and finishFrames(). The effect chain then processes
+	//! consecutive ones frame by frame in a single pass over the buffer.
+	virtual bool processesFrames() const
+	{
+		return false;
+	}
+
+	//! Fetches what processFrame() needs for a buffer of @p frames.
+	//! Returns false if the effect doesn't process the buffer (see
+	//! processAudioBuffer()).
+	virtual bool startFrames( const fpp_t )
+	{
+		return false;
+	}
+
+	//! Processes frame @p f of the buffer in place, including the wet/dry mix
+	virtual void processFrame( sampleFrame &, const fpp_t )
+	{
+	}
+
+	//! Called after the last frame with the sum of the power of the output
+	//! frames. Returns the same as processAudioBuffer() would.
+	virtual bool finishFrames( double outSum, const fpp_t frames )
+	{
+		checkGate( outSum / frames );
+		return isRunning();
+	}
+
+	//! How many frames the effect delays what it processes by, e.g. for a
+	//! lookahead. The mixer delays the other paths of the routing by as much,
+	//! so everything still arrives together.
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
+	//! tailLength() of effects that don't know theirs
+	static constexpr f_cnt_t UnknownTail = -1;
+
+	//! For how many frames the output can stay silent while the effect still
+	//! has something to play, e.g. the time between the echoes of a delay,
+	//! or 0 if the output only depends on the current input. Effects that
+	//! know it go to sleep once their output stayed inaudible for as long,
+	//! the others wait for the "decay" set by the user.
+	virtual f_cnt_t tailLength() const
+	{
+		return UnknownTail;
+	}
+
 	inline ch_cnt_t processorCount() const
 	{
 		return m_processors;
@@ -111,10 +181,19 @@ public:
 		return m_enabledModel.value();
 	}
 
+	//! True from the moment the effect chain found the effect producing infs
+	//! or nans until the effect got switched off. It isn't processed anymore
+	//! meanwhile.
+	inline bool isQuarantined() const
+	{
+		return m_quarantined;
+	}
+
 	inline f_cnt_t timeout() const
 	{
 		const float samples = Engine::audioEngine()->processingSampleRate() * m_autoQuitModel.value() / 1000.0f;
-		return 1 + ( static_cast<int>( samples ) / Engine::audioEngine()->framesPerPeriod() );
+		const f_cnt_t frames = std::max( static_cast<f_cnt_t>( samples ), tailLength() );
+		return 1 + ( frames / Engine::audioEngine()->framesPerPeriod() );
 	}
 
 	inline float wetLevel() const
@@ -168,6 +247,11 @@ public:
 		return m_parent;
 	}
 
+	int cpuLoad() const
+	{
+		return m_cpuAccount.load();
+	}
+
 	virtual EffectControls * controls() = 0;
 
 	static Effect * instantiate( const QString & _plugin_name,
@@ -181,12 +265,46 @@ protected:
 
 		If the setting "Keep effects running even without input" is disabled,
 		after "decay" ms of a signal below "gate", the effect is turned off
-		and won't be processed again until it receives new audio input
+		and won't be processed again until it receives new audio input.
+		Effects which know their tailLength() are turned off once their signal
+		stayed inaudible for that long, even with the gate at 0.
 	*/
 	void checkGate( double _out_sum );
 
+	//! processAudioBuffer() of effects which processesFrames(). @p Self is
+	//! the effect's own final class, which lets processFrame() be inlined.
+	template<typename Self>
+	bool processFramesOf( sampleFrame * buf, const fpp_t frames )
+	{
+		auto & self = static_cast<Self &>( *this );
+		if( !self.startFrames( frames ) )
+		{
+			return false;
+		}
+		double outSum = 0.0;
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			self.Self::processFrame( buf[f], f );
+			outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
+		}
+		return self.finishFrames( outSum, frames );
+	}
+
 	gui::PluginView* instantiateView( QWidget * ) override;
 
+	//! How well an effect that runs at a lower rate wants to be resampled
+	enum class ResamplingTier
+	{
+		Fast,		//!< cubic interpolation, for effects that are band-limited anyway
+		Balanced,	//!< short windowed sinc
+		Best		//!< libsamplerate at the interpolation of the quality settings
+	} ;
+
+	virtual ResamplingTier resamplingTier() const
+	{
+		return ResamplingTier::Balanced;
+	}
+
 	// some effects might not be capable of higher sample-rates so they can
 	// sample it down before processing and back after processing
 	inline void sampleDown( const sampleFrame * _src_buf,
@@ -208,10 +326,25 @@ protected:
 			Engine::audioEngine()->framesPerPeriod() * _src_sr /
 				Engine::audioEngine()->processingSampleRate() );
 	}
-	void reinitSRC();
+
+	//! Creates the resamplers for sampleDown() and sampleBack() at the tier the
+	//! effect asks for, or recreates them - not before the effect needs them,
+	//! and never while it's processing
+	void prepareResampling();
+
+
+signals:
+	void quarantined();
+
+
+private slots:
+	void switchOffQuarantined();
 
 
 private:
+	//! Called by the effect chain on the audio thread
+	void quarantine();
+
 	EffectChain * m_parent;
 	void resample( int _i, const sampleFrame * _src_buf,
 					sample_rate_t _src_sr,
@@ -223,6 +356,7 @@ private:
 	bool m_okay;
 	bool m_noRun;
 	bool m_running;
+	std::atomic_bool m_quarantined{false};
 	f_cnt_t m_bufferCount;
 
 	BoolModel m_enabledModel;
@@ -232,8 +366,10 @@ private:
 	
 	bool m_autoQuitDisabled;
 
-	SRC_DATA m_srcData[2];
-	SRC_STATE * m_srcState[2];
+	AudioEngineProfiler::Account m_cpuAccount;
+
+	//! Down and back, null while the effect runs at the processing rate
+	std::unique_ptr<AudioResampler> m_resamplers[2];
 
 
 	friend class gui::EffectView;
@@ -29,6 +29,11 @@
 #include "Model.h"
 #include "SerializingObject.h"
 #include "AutomatableModel.h"
+#include "PlanarBuffer.h"
+#include "RcuPointer.h"
+
+#include <memory>
+#include <vector>
 
 namespace lmms
 {
@@ -63,17 +68,97 @@ public:
 	void moveDown( Effect * _effect );
 	void moveUp( Effect * _effect );
 	bool processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise );
+	//! Whether processAudioBuffer() would touch the buffer at all - if not,
+	//! a silent buffer stays silent and doesn't need any processing
+	bool isActive( bool hasInputNoise ) const;
 	void startRunning();
 
 	void clear();
 
+	const std::vector<Effect*>& effects() const
+	{
+		return m_effects;
+	}
+
+	/*! By default, only the output of a chain is checked for infs and nans.
+	 *  Once there were some, every effect is checked in the next period, and
+	 *  the ones responsible are quarantined. Sanitizing after every effect
+	 *  instead is slower, but keeps bad data from reaching the next effect.
+	 */
+	static void setSanitizeEveryEffect( bool sanitize )
+	{
+		s_sanitizeEveryEffect = sanitize;
+	}
+
+	/*! In pipelined mode, every effect processes what the one before it
+	 *  output in the last period, so all of them can run at the same time
+	 *  on different workers, instead of one after the other. In exchange,
+	 *  the output lags one period behind for every effect after the first.
+	 *  Meant for long chains where that doesn't matter, like when
+	 *  rendering or on a bus.
+	 */
+	BoolModel * pipelinedModel()
+	{
+		return &m_pipelinedModel;
+	}
+
+	//! Frames the output lags behind the input because of the latency of
+	//! the effects and of pipelining
+	f_cnt_t latency() const;
+
 
 private:
 	using EffectList = std::vector<Effect*>;
+	//! The effects as edited, the audio threads process m_processing
 	EffectList m_effects;
 
 	BoolModel m_enabledModel;
 
+	//! Whether the output was bad last period, so the effect causing it
+	//! has to be found
+	bool m_findBadEffect;
+
+	static bool s_sanitizeEveryEffect;
+
+	//! Where the channels are kept while planar effects follow each other
+	PlanarBuffer m_planarBuffer;
+
+	//! Most effects processFrames() handles in one pass
+	static constexpr std::size_t MaxFusedEffects = 16;
+	//! Processes @p count effects which processesFrames() frame by frame, in
+	//! a single pass over the buffer. Returns whether any keeps running.
+	bool processFrames( Effect * const * effects, std::size_t count, sampleFrame * _buf, const fpp_t _frames );
+
+	class Stage;
+	BoolModel m_pipelinedModel;
+	//! A period of audio on its way through the pipeline, one per stage
+	struct PipelineBuffer
+	{
+		std::vector<sampleFrame> frames;
+		bool hasInput = false;
+	};
+
+	//! What the audio threads process. Adding, removing or moving effects
+	//! publishes a new one instead of locking the audio engine, with a
+	//! pipeline starting out empty.
+	struct Processing
+	{
+		EffectList effects;
+		std::vector<std::unique_ptr<Stage>> stages;
+		std::vector<PipelineBuffer> pipelineBuffers;
+		//! The buffer of the first stage, the one of stage k is k after it
+		std::size_t pipelineHead = 0;
+		//! Whether the pipeline was used last period, it starts out empty otherwise
+		bool pipelineRunning = false;
+	};
+	RcuPointer<Processing> m_processing;
+
+	//! Publishes m_effects for processing, with a stage for every effect.
+	//! Returns once removed effects aren't processed anymore.
+	void publish();
+
+	bool processPipelined( Processing & processing, sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise );
+
 
 	friend class gui::EffectRackView;
 
@@ -89,6 +89,9 @@ protected:
 
 
 private:
+	//! Creates the effect's controls the first time they're shown, most never are
+	void createControlView();
+
 	QPixmap m_bg;
 	LedCheckBox * m_bypass;
 	Knob * m_wetDry;
@@ -52,7 +52,9 @@ class LMMS_EXPORT Engine : public QObject
 {
 	Q_OBJECT
 public:
-	static void init( bool renderOnly );
+	//! @p renderFramesPerPeriod is the internal block size used when
+	//! @p renderOnly is set, 0 selects the default size
+	static void init( bool renderOnly, fpp_t renderFramesPerPeriod = 0 );
 	static void destroy();
 
 	// core
@@ -83,17 +85,12 @@ public:
 
 	static bool ignorePluginBlacklist();
 
+	// the plugins are scanned in the background at start up, these wait
+	// for the scan if it isn't done yet
 #ifdef LMMS_HAVE_LV2
-	static class Lv2Manager * getLv2Manager()
-	{
-		return s_lv2Manager;
-	}
+	static class Lv2Manager * getLv2Manager();
 #endif
-
-	static Ladspa2LMMS * getLADSPAManager()
-	{
-		return s_ladspaManager;
-	}
+	static Ladspa2LMMS * getLADSPAManager();
 
 	static float framesPerTick()
 	{
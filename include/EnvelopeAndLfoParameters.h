@@ -121,6 +121,9 @@ public slots:
 
 protected:
 	void fillLfoLevel( float * _buf, f_cnt_t _frame, const fpp_t _frames );
+	void fillEnvLevel( float * _buf, f_cnt_t _frame,
+				const f_cnt_t _release_begin,
+				const fpp_t _frames );
 
 
 private:
@@ -182,9 +185,18 @@ private:
 	} ;
 	constexpr static auto NumLfoShapes = static_cast<std::size_t>(LfoShape::Count);
 
-	sample_t lfoShapeSample( fpp_t _frame_offset );
+	template<typename ShapeFunction>
+	void fillLfoShapeData( fpp_t _frames, ShapeFunction _shape );
 	void updateLfoShapeData();
 
+	// the levels fillLevel() computed last, for the notes that follow at the
+	// same position in the same period
+	float * m_levels;
+	bool m_levelsCached = false;
+	f_cnt_t m_cachedFrame = 0;
+	f_cnt_t m_cachedReleaseBegin = 0;
+	fpp_t m_cachedFrames = 0;
+
 
 	friend class gui::EnvelopeAndLfoView;
 
@@ -36,7 +36,10 @@
 #if (QT_VERSION >= QT_VERSION_CHECK(5,14,0))
 	#include <QRecursiveMutex>
 #endif
+#include <QThreadPool>
 #include <QTreeWidget>
+#include <atomic>
+#include <memory>
 
 #include "SideBarWidget.h"
 #include "lmmsconfig.h"
@@ -48,6 +51,7 @@ namespace lmms
 
 class InstrumentTrack;
 class PlayHandle;
+class SampleBuffer;
 class TrackContainer;
 
 namespace gui
@@ -157,10 +161,17 @@ protected:
 
 
 private:
+	class PreviewDecoder;
+	class PresetPrefetcher;
+
 	//! Start a preview of a file item
 	void previewFileItem(FileItem* file);
+	//! Start a sample preview from the first seconds of it, returns nullptr if they can't be decoded quickly
+	PlayHandle* previewSampleHead(const QString& fileName);
 	//! If a preview is playing, stop it.
 	void stopPreview();
+	//! Read the preset below @p file in the background, it's likely to be previewed next
+	void prefetchPresetAfter(FileItem* file);
 
 	void handleFile( FileItem * fi, InstrumentTrack * it );
 	void openInNewInstrumentTrack( TrackContainer* tc, FileItem* item );
@@ -178,10 +189,22 @@ private:
 	QMutex m_pphMutex;
 #endif
 
+	//! Tells decoders of samples that aren't previewed anymore to drop them, guarded by m_pphMutex
+	int m_previewGeneration = 0;
+	//! The whole sample of the preview, once it is decoded, guarded by m_pphMutex
+	std::shared_ptr<const SampleBuffer> m_decodedPreview;
+	//! Tells a prefetcher that its preset isn't the next one anymore
+	std::atomic_int m_prefetchGeneration = 0;
+
+	//! Decodes the rest of sample previews, declared last to wait for it before anything else goes away
+	QThreadPool m_previewPool;
+
 	QList<QAction*> getContextActions(FileItem* item, bool songEditor);
 
 
 private slots:
+	//! Continues a sample preview from m_decodedPreview
+	void continuePreview();
 	void activateListItem( QTreeWidgetItem * item, int column );
 	void openInNewInstrumentTrack( lmms::gui::FileItem* item, bool songEditor );
 	bool openInNewSampleTrack( lmms::gui::FileItem* item );
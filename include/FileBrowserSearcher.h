@@ -28,8 +28,13 @@
 #include <QHash>
 #include <QString>
 #include <QStringList>
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <optional>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 
 #ifdef __MINGW32__
 #include <mingw.condition_variable.h>
@@ -44,12 +49,16 @@
 namespace lmms::gui {
 
 //! An active object that handles searching for files that match a certain filter across the file system.
+//! The first search in a directory walks it once to index the names in it, later ones only look them up.
 class FileBrowserSearcher
 {
 public:
 	//! Number of milliseconds to wait for before a match should be processed by the user.
 	static constexpr int MillisecondsPerMatch = 1;
 
+	//! An index older than this is walked again after the search it answered, to pick up changes
+	static constexpr auto IndexLifetime = std::chrono::minutes{5};
+
 	//! The future object for FileBrowserSearcher. It is used to track the current state of search operations, as
 	// well as retrieve matches.
 	class SearchFuture
@@ -121,6 +130,9 @@ public:
 	//! Sends a signal to cancel a running search.
 	auto cancel() -> void { m_cancelRunningSearch = true; }
 
+	//! Lets the next search walk the directories again after answering from what is indexed.
+	auto refresh() -> void { m_indicesOutdated = true; }
+
 	//! Returns the global instance of the searcher object.
 	static auto instance() -> FileBrowserSearcher*
 	{
@@ -129,16 +141,48 @@ public:
 	}
 
 private:
+	//! The files and directories below a searched path, in the order the file browser shows them
+	struct Index
+	{
+		static constexpr auto None = std::uint32_t(-1);
+
+		struct Entry
+		{
+			QString name;
+			bool isDir;
+			//! The directory this is in, or None for the entries of the searched path itself
+			std::uint32_t parent;
+			//! The index after the last entry below this one
+			std::uint32_t end;
+		};
+
+		QString path;
+		std::vector<Entry> entries;
+		//! The sorted indices of the entries with each three case folded characters in their name
+		std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> trigrams;
+		std::chrono::steady_clock::time_point built;
+
+		auto pathOf(std::uint32_t index) const -> QString;
+	};
+
 	//! Event loop for the worker thread.
 	auto run() -> void;
 
-	//! Using Depth-first search (DFS), filters the specified path and adds any matches to the future list.
-	auto process(SearchFuture* searchFuture, const QString& path) -> bool;
+	//! Walks the specified path, returns std::nullopt if the searcher is stopped in between,
+	//! or if it's interruptible and a search comes in.
+	auto buildIndex(const QString& path, bool interruptible) -> std::optional<Index>;
+
+	//! Filters the index of the specified path and adds any matches to the future list.
+	auto process(SearchFuture* searchFuture, const Index& index) -> bool;
 
 	std::queue<std::shared_ptr<SearchFuture>> m_searchQueue;
 	std::atomic<bool> m_cancelRunningSearch = false;
 
-	bool m_workerStopped = false;
+	//! Only used by the worker thread
+	std::map<QString, Index> m_indices;
+	std::atomic<bool> m_indicesOutdated = false;
+
+	std::atomic<bool> m_workerStopped = false;
 	std::mutex m_workerMutex;
 	std::condition_variable m_workerCond;
 	std::thread m_worker{[this] { run(); }};
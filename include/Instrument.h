@@ -32,6 +32,7 @@
 #include "lmms_export.h"
 #include "lmms_basics.h"
 #include "MemoryManager.h"
+#include "PeriodArena.h"
 #include "Plugin.h"
 #include "TimePos.h"
 
@@ -55,6 +56,8 @@ public:
 		IsSingleStreamed = 0x01,	/*! Instrument provides a single audio stream for all notes */
 		IsMidiBased = 0x02,			/*! Instrument is controlled by MIDI events rather than NotePlayHandles */
 		IsNotBendable = 0x04,		/*! Instrument can't react to pitch bend changes */
+		PlaysNotesBatched = 0x08,	/*! Instrument renders all notes of a period at once, see playNotes() */
+		NeedsFixedThread = 0x10,	/*! Instrument and its notes must always be played by the same thread */
 	};
 
 	using Flags = lmms::Flags<Flag>;
@@ -81,6 +84,13 @@ public:
 	{
 	}
 
+	// instruments with Flag::PlaysNotesBatched render all notes of a period
+	// at once here instead of in playNote(), and add them to the one
+	// working buffer of the track - each note has to go through mixNote()
+	// for the track's envelopes, volume and panning
+	virtual void playNotes( NotePlayHandle * const * _notes, std::size_t _count,
+					sampleFrame * _working_buf );
+
 	// needed for deleting plugin-specific-data of a note - plugin has to
 	// cast void-ptr so that the plugin-data is deleted properly
 	// (call of dtor if it's a class etc.)
@@ -107,6 +117,14 @@ public:
 		return Flag::NoFlags;
 	}
 
+	//! How many frames the instrument's output lags behind the notes and
+	//! MIDI events it gets, e.g. because a remote plugin is processing a
+	//! period ahead. The mixer compensates it like an effect's latency.
+	virtual f_cnt_t latency() const
+	{
+		return 0;
+	}
+
 	// sub-classes can re-implement this for receiving all incoming
 	// MIDI-events
 	inline virtual bool handleMidiEvent( const MidiEvent&, const TimePos& = TimePos(), f_cnt_t offset = 0 )
@@ -134,6 +152,16 @@ public:
 		return m_instrumentTrack;
 	}
 
+	// called by the audio engine for every note of an instrument with
+	// Flag::PlaysNotesBatched before the notes of a period start playing,
+	// returns the note which renders the whole batch
+	NotePlayHandle * queueBatchedNote( NotePlayHandle * _n );
+
+	const PeriodAllocator<NotePlayHandle *>::vector & noteBatch() const
+	{
+		return m_noteBatch;
+	}
+
 
 protected:
 	// fade in to prevent clicks
@@ -144,10 +172,17 @@ protected:
 	// desiredReleaseFrames() frames are left
 	void applyRelease( sampleFrame * buf, const NotePlayHandle * _n );
 
+	// applies the track's per-note processing to a note rendered into
+	// _note_buf by playNotes(), and adds it to the working buffer
+	void mixNote( NotePlayHandle * _n, sampleFrame * _note_buf, sampleFrame * _working_buf );
+
 
 private:
 	InstrumentTrack * m_instrumentTrack;
 
+	long m_noteBatchPeriod;
+	PeriodAllocator<NotePlayHandle *>::vector m_noteBatch;
+
 } ;
 
 
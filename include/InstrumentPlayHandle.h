@@ -50,6 +50,8 @@ public:
 
 	bool isFromTrack(const Track* track) const override;
 
+	const void* workerAffinity() const override;
+
 private:
 	Instrument* m_instrument;
 };
@@ -26,6 +26,9 @@
 #ifndef LMMS_INSTRUMENT_TRACK_H
 #define LMMS_INSTRUMENT_TRACK_H
 
+#include <atomic>
+#include <vector>
+
 #include "AudioPort.h"
 #include "InstrumentFunctions.h"
 #include "InstrumentSoundShaping.h"
@@ -45,6 +48,7 @@ namespace lmms
 
 class Instrument;
 class DataFile;
+class TrackFreezer;
 
 namespace gui
 {
@@ -89,6 +93,10 @@ public:
 	// filter and so on
 	void playNote( NotePlayHandle * _n, sampleFrame * _working_buffer );
 
+	// the same for all notes of an instrument rendering them at once, which
+	// end up mixed in one buffer
+	void playNotes( NotePlayHandle * const * notes, std::size_t count, sampleFrame * workingBuffer );
+
 	QString instrumentName() const;
 	const Instrument *instrument() const
 	{
@@ -124,6 +132,7 @@ public:
 	// play everything in given frame-range - creates note-play-handles
 	bool play( const TimePos & _start, const fpp_t _frames,
 						const f_cnt_t _frame_base, int _clip_num = -1 ) override;
+	int prefetch( const TimePos & start, const TimePos & end ) override;
 	// create new view for me
 	gui::TrackView* createView( gui::TrackContainerView* tcv ) override;
 
@@ -136,6 +145,11 @@ public:
 							QDomElement & _parent ) override;
 	void loadTrackSpecificSettings( const QDomElement & _this ) override;
 
+	TrackFreezer * freezer() override
+	{
+		return m_freezer.get();
+	}
+
 	using Track::setJournalling;
 
 
@@ -229,6 +243,32 @@ public:
 		return &m_useMasterPitchModel;
 	}
 
+	//! Which note to release when one more starts than the track may play at once
+	enum class VoiceStealing
+	{
+		Oldest,		//!< the one playing the longest
+		Quietest,	//!< the one with the lowest volume
+		SameKey		//!< one of the same key, else the oldest
+	};
+
+	//! The most notes the track plays at once, 0 if there's no limit. Chords
+	//! and arpeggios count every note.
+	int polyphony() const
+	{
+		return m_polyphonyEnabledModel.value() ? m_polyphonyModel.value() : 0;
+	}
+
+	VoiceStealing voiceStealing() const
+	{
+		return static_cast<VoiceStealing>( m_voiceStealingModel.value() );
+	}
+
+	//! Notes of the track playing now, apart from those that were stolen
+	int voices() const
+	{
+		return m_voices.load( std::memory_order_relaxed );
+	}
+
 	void setPreviewMode( const bool );
 
 	bool isPreviewMode() const
@@ -267,6 +307,12 @@ protected slots:
 private:
 	void processCCEvent(int controller);
 
+	//! Makes an instance of @p pluginName the instrument of this track. In preview
+	//! mode, the one it had is kept warm for the next preset of its kind, and a warm
+	//! one is taken rather than instantiating a plugin if there is one.
+	Instrument* replaceInstrument(const QString& pluginName,
+		const Plugin::Descriptor::SubPluginFeatures::Key* key, bool keyFromDnd = false);
+
 	MidiPort m_midiPort;
 
 	NotePlayHandle* m_notes[NumKeys];
@@ -281,6 +327,18 @@ private:
 
 	bool m_previewMode;
 
+	//! How many instruments preview mode keeps besides the one playing
+	static constexpr std::size_t MaxWarmInstruments = 4;
+	struct WarmInstrument
+	{
+		Instrument* instrument;
+		//! Whether it had an InstrumentPlayHandle, which it gets back when used again
+		bool playsItself;
+	};
+	//! The most recently used last
+	std::vector<WarmInstrument> m_warmInstruments;
+	bool m_instrumentPlaysItself;
+
 	IntModel m_baseNoteModel;	//!< The "A4" or "440 Hz" key (default 69)
 	IntModel m_firstKeyModel;	//!< First key the instrument reacts to
 	IntModel m_lastKeyModel;	//!< Last key the instrument reacts to
@@ -294,12 +352,19 @@ private:
 	FloatModel m_panningModel;
 
 	AudioPort m_audioPort;
+	std::unique_ptr<TrackFreezer> m_freezer;
 
 	FloatModel m_pitchModel;
 	IntModel m_pitchRangeModel;
 	IntModel m_mixerChannelModel;
 	BoolModel m_useMasterPitchModel;
 
+	BoolModel m_polyphonyEnabledModel;
+	IntModel m_polyphonyModel;
+	ComboBoxModel m_voiceStealingModel;
+	// counted by the note play handles, see NotePlayHandleManager::acquire()
+	std::atomic_int m_voices;
+
 	Instrument * m_instrument;
 	InstrumentSoundShaping m_soundShaping;
 	InstrumentFunctionArpeggio m_arpeggio;
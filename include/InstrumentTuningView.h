@@ -41,6 +41,7 @@ namespace gui
 
 class ComboBox;
 class GroupBox;
+class LcdSpinBox;
 class LedCheckBox;
 
 
@@ -60,6 +61,10 @@ public:
 
 	LedCheckBox *rangeImportCheckbox() {return m_rangeImportCheckbox;}
 
+	GroupBox *polyphonyGroupBox() {return m_polyphonyGroupBox;}
+	LcdSpinBox *polyphonySpinBox() {return m_polyphonySpinBox;}
+	ComboBox *voiceStealingCombo() {return m_voiceStealingCombo;}
+
 private:
 	GroupBox *m_pitchGroupBox;
 	GroupBox *m_microtunerGroupBox;
@@ -70,6 +75,10 @@ private:
 	ComboBox *m_keymapCombo;
 
 	LedCheckBox *m_rangeImportCheckbox;
+
+	GroupBox *m_polyphonyGroupBox;
+	LcdSpinBox *m_polyphonySpinBox;
+	ComboBox *m_voiceStealingCombo;
 };
 
 
@@ -29,6 +29,8 @@
 
 #include <ladspa.h>
 
+#include <QFileInfo>
+#include <QJsonObject>
 #include <QMap>
 #include <QPair>
 #include <QString>
@@ -50,10 +52,14 @@ using l_sortable_plugin_t = QList<sortable_plugin_t>;
 using l_ladspa_key_t = QList<ladspa_key_t>;
 
 /* LadspaManager provides a database of LADSPA plug-ins.  Upon instantiation,
-it loads all of the plug-ins found in the LADSPA_PATH environmental variable
+it finds all of the plug-ins in the LADSPA_PATH environmental variable
 and stores their access descriptors according in a dictionary keyed on
 the filename the plug-in was loaded from and the label of the plug-in.
 
+What it learns about each library is kept in a cache, so only new or
+changed libraries are loaded at start up. The others are loaded when one
+of their plug-ins is used for more than its name, type and properties.
+
 The can be retrieved by using ladspa_key_t.  For example, to get the
 "Phase Modulated Voice" plug-in from the cmt library, you would perform the
 calls using:
@@ -74,11 +80,15 @@ enum class LadspaPluginType
 
 struct LadspaManagerDescription
 {
+	//! nullptr until the library was loaded
 	LADSPA_Descriptor_Function descriptorFunction;
 	uint32_t index;
 	LadspaPluginType type;
 	uint16_t inputChannels;
 	uint16_t outputChannels;
+	QString libraryPath;
+	QString name;
+	LADSPA_Properties properties;
 };
 
 class LMMS_EXPORT LadspaManager
@@ -330,8 +340,10 @@ public:
 						LADSPA_Handle _instance );
 
 private:
-	void  addPlugins( LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file );
+	//! Returns what's cached about the library @p _file, or loads it to find
+	//! out if it changed since or isn't cached, and adds its plug-ins
+	void  addPlugins( const QFileInfo & _file, const QJsonObject & _cache,
+						QJsonObject & _newCache );
 	uint16_t  getPluginInputs( const LADSPA_Descriptor * _descriptor );
 	uint16_t  getPluginOutputs( const LADSPA_Descriptor * _descriptor );
 
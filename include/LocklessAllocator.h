@@ -27,31 +27,85 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 
 
 namespace lmms
 {
 
 
+/*! Hands out elements of one size to any number of threads at once without
+ *  locking. The free elements are spread over a few magazines, and every
+ *  thread takes from and gives back to its own first, so threads don't
+ *  contend for the same atomics unless one of them runs dry.
+ *
+ *  When less than a quarter of the initial capacity is left, the thread
+ *  that notices adds another chunk of that size, up to MaxChunks of them.
+ *  The others go on using what's left meanwhile and never wait for it.
+ */
 class LocklessAllocator
 {
 public:
+	struct Statistics
+	{
+		std::size_t capacity;
+		std::size_t inUse;
+		std::size_t peakInUse;
+		//! How often a chunk was added
+		int growths;
+		//! How often alloc() found no room at all
+		int failures;
+	};
+
+	static constexpr std::size_t MaxChunks = 16;
+	static constexpr std::size_t MagazineCount = 8;
+
 	LocklessAllocator( size_t nmemb, size_t size );
 	virtual ~LocklessAllocator();
 	void * alloc();
 	void free( void * ptr );
 
+	Statistics statistics() const;
+
 
 private:
-	char * m_pool;
-	size_t m_capacity;
+	struct Chunk
+	{
+		char * pool;
+		//! The next free element + 1 for each free element, 0 at the
+		//! bottom of a magazine, InUse for handed out ones
+		std::atomic<std::uint32_t> * next;
+	} ;
+
+	struct alignas(64) Magazine
+	{
+		//! A tag changing on every update in the upper half (against ABA),
+		//! the top element + 1 in the lower one, 0 if empty
+		std::atomic<std::uint64_t> head{0};
+	} ;
+
+	static constexpr std::uint32_t Empty = 0xffffffff;
+	static constexpr std::uint32_t InUse = 0xfffffffe;
+
+	std::atomic<std::uint32_t> & next( std::uint32_t index ) const;
+	void push( Magazine & magazine, std::uint32_t index );
+	std::uint32_t pop( Magazine & magazine );
+	//! Returns false if another thread is adding a chunk or there can't be more
+	bool grow();
+
+	size_t m_chunkCapacity;
 	size_t m_elementSize;
 
-	std::atomic_int * m_freeState;
-	size_t m_freeStateSets;
+	std::atomic<Chunk *> m_chunks[MaxChunks];
+	std::atomic<std::size_t> m_chunkCount{0};
+	std::atomic_bool m_growing{false};
+
+	Magazine m_magazines[MagazineCount];
 
-	std::atomic_int m_available;
-	std::atomic_int m_startIndex;
+	std::atomic<std::size_t> m_inUse{0};
+	std::atomic<std::size_t> m_peakInUse{0};
+	std::atomic_int m_growths{0};
+	std::atomic_int m_failures{0};
 
 } ;
 
@@ -79,6 +133,8 @@ public:
 		LocklessAllocator::free( ptr );
 	}
 
+	using LocklessAllocator::statistics;
+
 } ;
 
 
@@ -0,0 +1,108 @@
+/*
+ * LocklessIndexStack.h - a lock-free stack of free slot numbers
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LOCKLESS_INDEX_STACK_H
+#define LMMS_LOCKLESS_INDEX_STACK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace lmms
+{
+
+
+/*! Keeps the indices of the free slots of a pool, which any number of
+ *  threads may take and give back at the same time without locking.
+ *  Each index may be on the stack only once.
+ */
+class LocklessIndexStack
+{
+public:
+	static constexpr std::uint32_t Empty = 0xffffffff;
+
+	explicit LocklessIndexStack(std::uint32_t capacity) :
+		m_next(new std::atomic<std::uint32_t>[capacity])
+	{
+	}
+
+	void push(std::uint32_t index)
+	{
+		std::uint64_t head = m_head.load(std::memory_order_relaxed);
+		std::uint64_t newHead;
+		do
+		{
+			m_next[index].store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+			newHead = nextTag(head) | (index + 1);
+		}
+		while (!m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+
+		m_size.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	//! Returns Empty if there are no free slots
+	std::uint32_t pop()
+	{
+		std::uint64_t head = m_head.load(std::memory_order_acquire);
+		std::uint32_t index;
+		std::uint64_t newHead;
+		do
+		{
+			index = static_cast<std::uint32_t>(head);
+			if (index == 0) { return Empty; }
+
+			// if another thread took this index in the meantime, the
+			// tag changed and the exchange fails
+			newHead = nextTag(head) | m_next[index - 1].load(std::memory_order_relaxed);
+		}
+		while (!m_head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire));
+
+		m_size.fetch_sub(1, std::memory_order_relaxed);
+		return index - 1;
+	}
+
+	int size() const
+	{
+		return m_size.load(std::memory_order_relaxed);
+	}
+
+private:
+	//! The upper half of the head is a tag which changes on every update, so
+	//! a stale head can never be swapped in (ABA)
+	static std::uint64_t nextTag(std::uint64_t head)
+	{
+		return ((head >> 32) + 1) << 32;
+	}
+
+	//! The next free index + 1 for every index on the stack, 0 at the bottom
+	std::unique_ptr<std::atomic<std::uint32_t>[]> m_next;
+	//! The index + 1 on top of the stack in the lower half, 0 if empty
+	std::atomic<std::uint64_t> m_head{0};
+	std::atomic_int m_size{0};
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_LOCKLESS_INDEX_STACK_H
@@ -53,9 +53,14 @@ public:
 		delete m_allocator;
 	}
 
-	void push( T value )
+	//! Returns false if there's no room left
+	bool push( T value )
 	{
 		Element * e = m_allocator->alloc();
+		if( e == nullptr )
+		{
+			return false;
+		}
 		e->value = value;
 		e->next = m_first.load(std::memory_order_relaxed);
 
@@ -65,6 +70,7 @@ public:
 		{
 			// Empty loop (compare_exchange_weak updates e->next)
 		}
+		return true;
 	}
 
 	Element * popList()
@@ -87,6 +93,11 @@ public:
 		m_allocator->free( e );
 	}
 
+	LocklessAllocator::Statistics statistics() const
+	{
+		return m_allocator->statistics();
+	}
+
 
 private:
 	std::atomic<Element*> m_first;
@@ -27,6 +27,7 @@
 
 #include <QMutex>
 #include <QWaitCondition>
+#include <climits>
 
 #include "lmms_basics.h"
 #include "../src/3rdparty/ringbuffer/include/ringbuffer/ringbuffer.h"
@@ -76,11 +77,12 @@ public:
 		m_notifier(&rb.m_notifier) {};
 
 	bool empty() const {return !this->read_space();}
-	void waitForData()
+	//! Waits until data are written, or @p timeout milliseconds passed
+	void waitForData(unsigned long timeout = ULONG_MAX)
 	{
 		QMutex useless_lock;
 		useless_lock.lock();
-		m_notifier->wait(&useless_lock);
+		m_notifier->wait(&useless_lock, timeout);
 		useless_lock.unlock();
 	}
 private:
@@ -0,0 +1,129 @@
+/*
+ * LoudnessMeter.h - EBU R128 loudness, true peak and clipping of audio
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_LOUDNESS_METER_H
+#define LMMS_LOUDNESS_METER_H
+
+#include <QString>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "TruePeakMeter.h"
+
+namespace lmms {
+
+/**
+ * Measures stereo audio as it goes by like ITU-R BS.1770-4 and EBU R128 do:
+ * the K-weighted, gated integrated loudness, the loudness range and the
+ * maxima of the momentary (400 ms) and short-term (3 s) loudness. It also
+ * finds the true peak from 4x oversampling, the sample peak and how many
+ * samples clipped, so an export needs no second pass to check them.
+ */
+class LMMS_EXPORT LoudnessMeter
+{
+public:
+	struct Report
+	{
+		double seconds = 0;
+		//! In LUFS, -infinity for silence, like the other loudness values
+		double integrated = 0;
+		//! In LU
+		double range = 0;
+		double maxMomentary = 0;
+		double maxShortTerm = 0;
+		//! In dBTP
+		double truePeak = 0;
+		//! In dBFS
+		double samplePeak = 0;
+		//! Samples that are beyond full scale
+		f_cnt_t clippedSamples = 0;
+		//! When the first of them was, in seconds, -1 if none clipped
+		double firstClip = -1;
+	};
+
+	explicit LoudnessMeter(sample_rate_t sampleRate);
+
+	//! Measures @p count frames after those measured before, scaled by @p gain
+	void process(const sampleFrame* frames, std::size_t count, float gain = 1.0f);
+
+	auto report() const -> Report;
+
+	//! Writes the report as JSON to @p file, about the audio written to @p audioFile
+	auto writeReport(const QString& file, const QString& audioFile) const -> bool;
+
+	//! Where the report for @p audioFile goes: next to it, "song.wav" gets "song.loudness.json"
+	static auto reportFile(const QString& audioFile) -> QString;
+
+private:
+	//! A biquad in transposed direct form II
+	struct Biquad
+	{
+		double b0, b1, b2, a1, a2;
+		std::array<double, 2> z1 = {};
+		std::array<double, 2> z2 = {};
+
+		auto process(double x, int channel) -> double
+		{
+			const auto y = b0 * x + z1[channel];
+			z1[channel] = b1 * x - a1 * y + z2[channel];
+			z2[channel] = b2 * x - a2 * y;
+			return y;
+		}
+	};
+
+	void finishSubBlock();
+
+	sample_rate_t m_sampleRate;
+	f_cnt_t m_frames = 0;
+
+	// K-weighting: the head's shelf, then a high pass
+	Biquad m_shelf;
+	Biquad m_highPass;
+
+	//! Loudness is measured in blocks of four of these 100 ms sub-blocks
+	std::size_t m_subBlockFrames;
+	std::size_t m_subBlockFill = 0;
+	double m_subBlockSum = 0;
+	//! The mean squares of the last 30 sub-blocks (3 s), a ring
+	std::array<double, 30> m_subBlocks = {};
+	std::size_t m_subBlockCount = 0;
+
+	//! The mean squares of every momentary and short-term block, 10 per second
+	std::vector<double> m_momentary;
+	std::vector<double> m_shortTerm;
+
+	TruePeakMeter m_truePeakMeter;
+
+	float m_truePeak = 0;
+	float m_samplePeak = 0;
+	f_cnt_t m_clippedSamples = 0;
+	f_cnt_t m_firstClip = -1;
+};
+
+} // namespace lmms
+
+#endif // LMMS_LOUDNESS_METER_H
@@ -42,6 +42,7 @@ namespace lmms
 
 
 class Lv2Proc;
+class PlanarBuffer;
 class PluginIssue;
 
 /**
@@ -124,6 +125,14 @@ protected:
 	void copyBuffersFromLmms(const sampleFrame *buf, fpp_t frames);
 	//! Copy our ports into buffers passed by LMMS
 	void copyBuffersToLmms(sampleFrame *buf, fpp_t frames) const;
+	//! Same as above, without interleaving the channels
+	void copyBuffersFromLmms(const PlanarBuffer &buf, fpp_t frames);
+	void copyBuffersToLmms(PlanarBuffer &buf, fpp_t frames) const;
+	//! Let our ports read from @p in and write to @p out instead of copying,
+	//! returns false if they can't (see Lv2Proc::connectBuffersToCore)
+	bool connectBuffersToLmms(PlanarBuffer &in, PlanarBuffer &out);
+	//! Whether @p in and @p out above may be the same buffer
+	bool canProcessInPlace() const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -31,22 +31,22 @@
 
 #include <lilv/lilv.h>
 #include <memory>
-#include <optional>
 
 #include "LinkedModelGroups.h"
 #include "LmmsSemaphore.h"
+#include "LocklessList.h"
 #include "Lv2Basics.h"
 #include "Lv2Features.h"
 #include "Lv2Options.h"
 #include "Lv2Worker.h"
 #include "Plugin.h"
-#include "../src/3rdparty/ringbuffer/include/ringbuffer/ringbuffer.h"
 #include "TimePos.h"
 
 
 namespace lmms
 {
 
+class PlanarBuffer;
 class PluginIssue;
 
 // forward declare port structs/enums
@@ -66,7 +66,6 @@ namespace Lv2Ports
 //! For Mono effects, 1 Lv2ControlBase references 2 Lv2Proc.
 class Lv2Proc : public LinkedModelGroup
 {
-	friend class Lv2ProcSuspender;
 public:
 	static Plugin::Type check(const LilvPlugin* plugin,
 		std::vector<PluginIssue> &issues);
@@ -76,6 +75,8 @@ public:
 	*/
 	Lv2Proc(const LilvPlugin* plugin, Model *parent);
 	~Lv2Proc() override;
+	//! Create a new instance while the old one keeps running, and swap
+	//! them in between two periods
 	void reload();
 	void onSampleRateChanged();
 	//! Must be checked after ctor or reload
@@ -150,6 +151,22 @@ public:
 	 */
 	void copyBuffersToCore(sampleFrame *buf, unsigned firstChan, unsigned num,
 								fpp_t frames) const;
+	//! Same as above, but with the channels in separate arrays already
+	void copyBuffersFromCore(const PlanarBuffer &buf,
+								unsigned firstChan, unsigned num, fpp_t frames);
+	void copyBuffersToCore(PlanarBuffer &buf, unsigned firstChan, unsigned num,
+								fpp_t frames) const;
+	/**
+	 * Instead of copying, connect the audio ports straight to the channels
+	 * of @p in and @p out, which may be the same buffer if
+	 * canProcessInPlace(). The copy functions connect our own buffers again.
+	 * @return false if our ports don't map onto the @p num channels one to
+	 *   one, the copy functions must be used then
+	 */
+	bool connectBuffersToCore(PlanarBuffer &in, PlanarBuffer &out,
+								unsigned firstChan, unsigned num);
+	//! Whether the plugin may write its output over its input
+	bool canProcessInPlace() const { return !m_inPlaceBroken; }
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -183,25 +200,26 @@ private:
 	Lv2Options m_options;
 
 	// worker
-	std::optional<Lv2Worker> m_worker;
+	std::unique_ptr<Lv2Worker> m_worker;
 	Semaphore m_workLock; // this must be shared by different workers
 
 	// full list of ports
 	std::vector<std::unique_ptr<Lv2Ports::PortBase>> m_ports;
 	// quick reference to specific, unique ports
 	StereoPortRef m_inPorts, m_outPorts;
+	//! Whether the audio ports are connected to buffers of the core
+	bool m_audioPortsMoved = false;
+	bool m_inPlaceBroken = false;
 	Lv2Ports::AtomSeq *m_midiIn = nullptr, *m_midiOut = nullptr;
 
 	// MIDI
 	// many things here may be moved into the `Instrument` class
 	constexpr const static std::size_t m_maxMidiInputEvents = 1024;
-	//! spinlock for the MIDI ringbuffer (for MIDI events going to the plugin)
-	std::atomic_flag m_ringLock = ATOMIC_FLAG_INIT;
-
-	//! MIDI ringbuffer (for MIDI events going to the plugin)
-	ringbuffer_t<struct MidiInputEvent> m_midiInputBuf;
-	//! MIDI ringbuffer reader
-	ringbuffer_reader_t<struct MidiInputEvent> m_midiInputReader;
+	//! MIDI events going to the plugin, pushed by any thread without
+	//! locking, newest first
+	LocklessList<struct MidiInputEvent> m_midiInputEvents;
+	//! where the audio thread puts them in order once per period
+	std::vector<struct MidiInputEvent> m_midiInputBatch;
 
 	// other
 	static int32_t defaultEvbufSize() { return 1 << 15; /* ardour uses this*/ }
@@ -211,8 +229,14 @@ private:
 	//!   ControlPorts in `m_ports`
 	std::map<std::string, AutomatableModel *> m_connectedModels;
 
-	void initMOptions(); //!< initialize m_options
-	void initPluginSpecificFeatures();
+	//! Create an instance with its ports connected and activate it, or return
+	//! nullptr. What it's created with is put into the other arguments, which
+	//! must live as long as the instance.
+	LilvInstance* instantiate(Lv2Features& features, Lv2Options& options,
+		std::unique_ptr<Lv2Worker>& worker);
+	void initMOptions(Lv2Options& options); //!< initialize options
+	void initPluginSpecificFeatures(Lv2Features& features, Lv2Options& options,
+		std::unique_ptr<Lv2Worker>& worker);
 
 	//! load a file in the plugin, but don't do anything in LMMS
 	void loadFileInternal(const QString &file);
@@ -222,6 +246,9 @@ private:
 	void createPort(std::size_t portNum);
 	//! connect m_ports[portNum] with Lv2
 	void connectPort(std::size_t num);
+	void connectPort(std::size_t num, LilvInstance* instance);
+	//! connect the audio ports with our own buffers again
+	void connectOwnAudioBuffers();
 
 	void dumpPort(std::size_t num);
 
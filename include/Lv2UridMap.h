@@ -30,9 +30,11 @@
 #ifdef LMMS_HAVE_LV2
 
 #include <lv2/lv2plug.in/ns/ext/urid/urid.h>
-#include <mutex> // TODO: use semaphore, even though this is not realtime critical
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 
@@ -42,15 +44,36 @@ namespace lmms
 
 /**
  * Complete implementation of the Lv2 Urid Map extension
+ *
+ * The map is global and plugins may call it from their run function, so
+ * URIs that are mapped already are looked up without locking, in an
+ * append-only hash table. Only mapping a new URI takes a mutex.
  */
 class UridMap
 {
-	std::unordered_map<std::string, LV2_URID> m_map;
-	std::vector<const char*> m_unMap;
-
-	//! mutex for both m_map and m_unMap
-	//! the URID map is global, which is why a mutex is required here
-	std::mutex m_MapMutex;
+	struct Entry
+	{
+		std::string uri;
+		LV2_URID urid;
+	};
+
+	//! There is no room for more URIs, UridMap::map() returns 0 then
+	static constexpr std::size_t MaxUrids = 8192;
+	//! Power of two, and twice as many, so the probe sequences stay short
+	static constexpr std::size_t Slots = 2 * MaxUrids;
+
+	//! Finds @p uri without locking, nullptr if it isn't mapped yet
+	const Entry* find(const char* uri, std::size_t hash) const;
+
+	//! The entries by the hash of their URI, with linear probing
+	std::unique_ptr<std::atomic<const Entry*>[]> m_slots;
+	//! The URI of every URID - 1
+	std::unique_ptr<std::atomic<const char*>[]> m_unMap;
+
+	//! Owns the entries, which never move
+	std::vector<std::unique_ptr<const Entry>> m_entries;
+	//! Only for adding entries
+	std::mutex m_insertMutex;
 
 	LV2_URID_Map m_mapFeature;
 	LV2_URID_Unmap m_unmapFeature;
@@ -31,7 +31,7 @@
 
 #include <lilv/lilv.h>
 #include <lv2/lv2plug.in/ns/ext/worker/worker.h>
-#include <thread>
+#include <atomic>
 #include <vector>
 
 #include "LocklessRingBuffer.h"
@@ -42,6 +42,10 @@ namespace lmms
 
 /**
 	Worker container
+
+	If threaded, the work is done by a small pool of threads which all
+	workers share. Each worker is only handled by one of them at a time, so
+	its requests are still worked on one after the other.
 */
 class Lv2Worker
 {
@@ -65,8 +69,11 @@ public:
 	LV2_Worker_Status respond(uint32_t size, const void* data);
 
 private:
+	class Pool;
+
 	// functions
-	void workerFunc();
+	//! Work on the oldest request, called by the pool
+	void processRequest();
 	std::size_t bufferSize() const;  //!< size of internal buffers
 
 	// parameters
@@ -76,12 +83,12 @@ private:
 	LV2_Worker_Schedule m_scheduleFeature;
 
 	// threading/synchronization
-	std::thread m_thread;
-	std::vector<char> m_response;  //!< buffer where single requests from m_requests are unpacked
+	std::vector<char> m_request;  //!< buffer where single requests from m_requests are unpacked
+	std::vector<char> m_response;  //!< buffer where single responses from m_responses are unpacked
 	LocklessRingBuffer<char> m_requests, m_responses;  //!< ringbuffer to queue multiple requests
 	LocklessRingBufferReader<char> m_requestsReader, m_responsesReader;
-	std::atomic<bool> m_exit = false;  //!< Whether the worker function should keep looping
-	Semaphore m_sem;
+	std::atomic<int> m_pendingRequests = 0;  //!< Requests the pool didn't take yet
+	bool m_busy = false;  //!< Whether a thread of the pool works for us, guarded by the pool
 	Semaphore* m_workLock;
 };
 
@@ -27,6 +27,8 @@
 
 #include "lmmsconfig.h"
 
+#include <memory>
+
 #include <QApplication>
 
 #ifdef LMMS_BUILD_WIN32
@@ -38,6 +40,7 @@
 namespace lmms::gui
 {
 
+class StallDetector;
 
 #if defined(LMMS_BUILD_WIN32)
 class MainApplication : public QApplication, public QAbstractNativeEventFilter
@@ -47,7 +50,11 @@ class MainApplication : public QApplication
 {
 public:
 	MainApplication(int& argc, char** argv);
+	~MainApplication() override;
 	bool event(QEvent* event) override;
+	bool notify(QObject* receiver, QEvent* event) override;
+	//! Log when the GUI thread doesn't get to its events for @p thresholdMs
+	void detectStalls(int thresholdMs);
 #ifdef LMMS_BUILD_WIN32
 	bool winEventFilter(MSG* msg, long* result);
 	bool nativeEventFilter(const QByteArray& eventType, void* message,
@@ -59,6 +66,7 @@ public:
 	}
 private:
 	QString m_queuedFile;
+	std::unique_ptr<StallDetector> m_stallDetector;
 };
 
 
@@ -27,6 +27,7 @@
 
 #include <QBasicTimer>
 #include <QTimer>
+#include <QThreadPool>
 #include <QList>
 #include <QMainWindow>
 
@@ -157,6 +158,7 @@ public slots:
 	void saveProjectAsDefaultTemplate();
 	void showSettingsDialog();
 	void aboutLMMS();
+	void showMemoryReport();
 	void help();
 	void toggleAutomationEditorWin();
 	void togglePatternEditorWin(bool forceShow = false);
@@ -228,6 +230,8 @@ private:
 	QBasicTimer m_updateTimer;
 	QTimer m_autoSaveTimer;
 	int m_autoSaveInterval;
+	//! Writes the autosaves, one at a time
+	QThreadPool m_autoSavePool;
 
 	friend class GuiApplication;
 
@@ -40,6 +40,18 @@ public:
 
 	static void alignedFree( void* );
 
+	//! Whether prepareLargeBuffer() asks for huge pages and locks the memory
+	//! in RAM, both off by default
+	static void setLargeBufferOptions( bool hugePages, bool locked );
+
+	//! Keeps the @p size bytes at @p buffer, like the frames of a sample, in
+	//! huge pages and from being swapped out as set. Both are hints the system
+	//! may not follow, which is warned about once. The memory mustn't move or
+	//! be freed before releaseLargeBuffer() was called for it.
+	static void prepareLargeBuffer( void* buffer, size_t size );
+
+	static void releaseLargeBuffer( void* buffer, size_t size );
+
 private:
 };
 
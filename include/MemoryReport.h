@@ -0,0 +1,95 @@
+/*
+ * MemoryReport.h - tell where the memory of a project goes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_MEMORY_REPORT_H
+#define LMMS_MEMORY_REPORT_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <QString>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+class EffectChain;
+class Sample;
+class SampleBuffer;
+
+
+/*! Lists the large blocks of memory a project holds: samples, plugin
+ *  state, frozen tracks and the tables and pools of the engine. This
+ *  only counts what the parts report about themselves, so it is a lower
+ *  bound of what the process uses.
+ */
+class LMMS_EXPORT MemoryReport
+{
+public:
+	struct Entry
+	{
+		//! The track, mixer channel or "Engine" holding the memory
+		QString owner;
+		QString what;
+		std::size_t bytes;
+	};
+
+	//! Walks the song with all its tracks and plugins and the engine. Must
+	//! be called with the audio engine locked or from the GUI thread.
+	static MemoryReport collect();
+
+	//! Sets the owner of the entries added from now on
+	void setOwner( const QString & owner );
+
+	void add( const QString & what, std::size_t bytes );
+	//! Samples can be shared, a buffer is only counted for the first owner
+	void addSample( const Sample & sample, const QString & what );
+	void addSampleBuffer( const std::shared_ptr<const SampleBuffer> & buffer, const QString & what );
+	void addEffects( const EffectChain & effects );
+
+	const std::vector<Entry> & entries() const
+	{
+		return m_entries;
+	}
+
+	std::size_t totalBytes() const;
+
+	//! Totals per owner, then every entry, largest first
+	QString toText() const;
+
+	static QString formatBytes( std::size_t bytes );
+
+private:
+	QString m_owner;
+	std::vector<Entry> m_entries;
+	std::unordered_map<const SampleBuffer *, std::size_t> m_sampleBuffers;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_MEMORY_REPORT_H
@@ -25,9 +25,13 @@
 #ifndef LMMS_MICROTUNER_H
 #define LMMS_MICROTUNER_H
 
+#include <array>
+#include <memory>
+
 #include "AutomatableModel.h"
 #include "ComboBoxModel.h"
 #include "JournallingObject.h"
+#include "Note.h"
 
 namespace lmms
 {
@@ -63,13 +67,31 @@ public:
 protected slots:
 	void updateScaleList(int index);
 	void updateKeymapList(int index);
+	void updateTuning();
 
 private:
+	//! What keyToFreq() needs of the selected scale and keymap, precomputed
+	//! for every key, so notes can look their frequency up whenever it changes
+	struct Tuning
+	{
+		float baseFreq = 0;
+		int baseKey = 0;
+		bool keyRangeImport = false;
+		//! Of every key to the note of the base frequency, 0 if not mapped
+		std::array<double, NumKeys> keyRatios = {};
+		//! Of every possible user base note to the notes of the base
+		//! frequency, 0 if not mapped
+		std::array<double, NumKeys> baseRatios = {};
+	};
+
 	BoolModel m_enabledModel;               //!< Enable microtuner (otherwise using 12-TET @440 Hz)
 	ComboBoxModel m_scaleModel;
 	ComboBoxModel m_keymapModel;
 	BoolModel m_keyRangeImportModel;
 
+	//! Replaced as a whole, since notes read it on the audio threads
+	std::shared_ptr<const Tuning> m_tuning;
+
 };
 
 } // namespace lmms
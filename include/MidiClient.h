@@ -26,6 +26,7 @@
 #define LMMS_MIDI_CLIENT_H
 
 #include <QStringList>
+#include <chrono>
 #include <vector>
 
 
@@ -135,8 +136,10 @@ public:
 
 
 protected:
-	// generic raw-MIDI-parser which generates appropriate MIDI-events
-	void parseData( const unsigned char c );
+	// generic raw-MIDI-parser which generates appropriate MIDI-events,
+	// @p arrival is when the byte was received
+	void parseData( const unsigned char c,
+		std::chrono::steady_clock::time_point arrival = std::chrono::steady_clock::now() );
 
 	// to be implemented by actual client-implementation
 	virtual void sendByte( const unsigned char c ) = 0;
@@ -144,7 +147,7 @@ protected:
 
 private:
 	// this does MIDI-event-process
-	void processParsedEvent();
+	void processParsedEvent( std::chrono::steady_clock::time_point arrival );
 	void processOutEvent( const MidiEvent& event, const TimePos& time, const MidiPort* port ) override;
 
 	// small helper function returning length of a certain event - this
@@ -62,6 +62,9 @@ public:
 
 	// note management
 	Note * addNote( const Note & _new_note, const bool _quant_pos = true );
+	//! Adds all of @p notes at once, e.g. when importing, instead of
+	//! keeping the clip sorted and updated after every one
+	void addNotes( const std::vector<Note> & notes );
 
 	void removeNote( Note * _note_to_del );
 
@@ -75,6 +78,11 @@ public:
 		return m_notes;
 	}
 
+	int steps() const
+	{
+		return m_steps;
+	}
+
 	Note * addStepNote( int step );
 	void setStep( int step, bool enabled );
 
@@ -26,6 +26,8 @@
 #define LMMS_GUI_MIDI_CLIP_VIEW_H
 
 #include <QStaticText>
+#include <memory>
+
 #include "ClipView.h"
 #include "embed.h"
 
@@ -44,7 +46,7 @@ class MidiClipView : public ClipView
 
 public:
 	MidiClipView( MidiClip* clip, TrackView* parent );
-	~MidiClipView() override = default;
+	~MidiClipView() override;
 
 	Q_PROPERTY(QColor noteFillColor READ getNoteFillColor WRITE setNoteFillColor)
 	Q_PROPERTY(QColor noteBorderColor READ getNoteBorderColor WRITE setNoteBorderColor)
@@ -87,6 +89,10 @@ protected:
 
 
 private:
+	//! The notes of a melody clip, drawn into an image on a background thread
+	struct NoteLayer;
+	class NoteLayerTask;
+
 	QPixmap m_stepBtnOn0 = embed::getIconPixmap("step_btn_on_0");
 	QPixmap m_stepBtnOn200 = embed::getIconPixmap("step_btn_on_200");
 	QPixmap m_stepBtnOff = embed::getIconPixmap("step_btn_off");
@@ -102,6 +108,8 @@ private:
 
 	QStaticText m_staticTextName;
 
+	std::shared_ptr<NoteLayer> m_noteLayer;
+
 	bool m_legacySEPattern;
 } ;
 
@@ -26,19 +26,23 @@
 #ifndef LMMS_MIDI_PORT_H
 #define LMMS_MIDI_PORT_H
 
+#include <chrono>
+#include <vector>
+
 #include <QString>
 #include <QList>
 #include <QMap>
 
 #include "Midi.h"
+#include "MidiEvent.h"
 #include "TimePos.h"
 #include "AutomatableModel.h"
+#include "LocklessRingBuffer.h"
 
 namespace lmms
 {
 
 class MidiClient;
-class MidiEvent;
 class MidiEventProcessor;
 
 namespace gui
@@ -68,6 +72,7 @@ class MidiPort : public Model, public SerializingObject
 	mapPropertyFromModel(bool,isWritable,setWritable,m_writableModel);
 public:
 	using Map = QMap<QString, bool>;
+	using Clock = std::chrono::steady_clock;
 
 	enum class Mode
 	{
@@ -111,9 +116,21 @@ public:
 		return outputChannel() ? outputChannel() - 1 : 0;
 	}
 
-	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos() );
+	//! Called by the MIDI client for what it received at @p arrival. The event
+	//! reaches the processor on the audio thread, at the start of the next period,
+	//! so the client never takes the locks of the audio engine.
+	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos(),
+				Clock::time_point arrival = Clock::now() );
 	void processOutEvent( const MidiEvent& event, const TimePos& time = TimePos() );
 
+	//! Called by the audio engine when it begins rendering a period at
+	//! @p periodStart. The events received before are played one period after
+	//! they arrived, at the frame that is, so the latency of live playing stays
+	//! constant instead of depending on where in a period an event came in.
+	//! Of the values a continuous controller, the pitch bend or the channel
+	//! pressure of a channel went through, only the last one is passed on.
+	void dispatchInEvents( Clock::time_point periodStart, sample_rate_t sampleRate, fpp_t frames );
+
 
 	void saveSettings( QDomDocument& doc, QDomElement& thisElement ) override;
 	void loadSettings( const QDomElement& thisElement ) override;
@@ -173,6 +190,20 @@ private:
 	Map m_readablePorts;
 	Map m_writablePorts;
 
+	struct InEvent
+	{
+		MidiEvent event;
+		TimePos time;
+		Clock::time_point arrival;
+		//! Whether a later event of the same period makes it pointless
+		bool superseded;
+	};
+	//! From the thread of the MIDI client to the audio thread
+	LocklessRingBuffer<InEvent> m_inEvents;
+	LocklessRingBufferReader<InEvent> m_inEventReader;
+	//! The events of the period being dispatched
+	std::vector<InEvent> m_dispatchedEvents;
+
 
 	friend class gui::ControllerConnectionDialog;
 	friend class gui::InstrumentMidiIOView;
@@ -34,14 +34,24 @@ class ValueBuffer;
 namespace MixHelpers
 {
 
+/*! \brief Name of the instruction set the mix loops got vectorised for,
+ *  "scalar" if they aren't */
+const char* instructionSet();
+
 bool isSilent( const sampleFrame* src, int frames );
 
+/*! \brief Whether src has an inf or nan, checked without a branch per sample */
+bool hasNonFinite( const sampleFrame* src, int frames );
+
 bool useNaNHandler();
 
 void setNaNHandler( bool use );
 
 bool sanitize( sampleFrame * src, int frames );
 
+/*! \brief Same as above, for one channel of a PlanarBuffer */
+bool sanitize( sample_t * src, int frames );
+
 /*! \brief Add samples from src to dst */
 void add( sampleFrame* dst, const sampleFrame* src, int frames );
 
@@ -58,14 +68,31 @@ void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coef
 /*! \brief Add samples from src multiplied by coeffSrc and coeffSrcBuf to dst */
 void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
 
-/*! \brief Same as addMultiplied, but sanitize output (strip out infs/nans) */
-void addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames );
+/*! \brief Same as addMultiplied, but sanitize output (strip out infs/nans).
+ *  Returns whether src had any, clean buffers are mixed as fast as
+ *  addMultiplied does. The same goes for the other sanitized versions. */
+bool addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames );
 
 /*! \brief Add samples from src multiplied by coeffSrc and coeffSrcBuf to dst - sanitized version */
-void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames );
+bool addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames );
 
 /*! \brief Add samples from src multiplied by coeffSrc and coeffSrcBuf to dst - sanitized version */
-void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
+bool addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
+
+/*! \brief The largest absolute value and the sum of the squares of each
+ *  channel, for meters */
+struct Measurement
+{
+	float peaks[2] = { 0.0f, 0.0f };
+	float squares[2] = { 0.0f, 0.0f };
+};
+
+/*! \brief Same as addSanitizedMultiplied, and measure src unmultiplied on the
+ *  way, infs and nans count as 0 - saves meters a pass over the buffer */
+bool addSanitizedMultipliedMeasured( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames, Measurement& measurement );
+
+/*! \brief Measure src like addSanitizedMultipliedMeasured does, without mixing it */
+void measure( const sampleFrame* src, int frames, Measurement& measurement );
 
 /*! \brief Add samples from src multiplied by coeffSrcLeft/coeffSrcRight to dst */
 void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames );
@@ -76,6 +103,25 @@ void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float c
 /*! \brief Multiply dst by coeffDst and add samples from srcLeft/srcRight multiplied by coeffSrc */
 void multiplyAndAddMultipliedJoined( sampleFrame* dst, const sample_t* srcLeft, const sample_t* srcRight, float coeffDst, float coeffSrc, int frames );
 
+/*! \brief Volume and panning in percent, like the models of a track have.
+ *  Each is constant unless there is a buffer with one value per frame. */
+struct StereoGain
+{
+	const ValueBuffer* volumeBuffer = nullptr;
+	float volume = 100.0f;
+	const ValueBuffer* panningBuffer = nullptr;
+	float panning = 0.0f;
+};
+
+/*! \brief Copy samples from src to dst and apply gain */
+void copyWithGain( sampleFrame* dst, const sampleFrame* src, const StereoGain& gain, int frames );
+
+/*! \brief Add samples from src to dst and apply gain to the sum */
+void addWithGain( sampleFrame* dst, const sampleFrame* src, const StereoGain& gain, int frames );
+
+/*! \brief Split src multiplied by coeffSrc into the single channels left and right */
+void deinterleaveMultiplied( const sampleFrame* src, sample_t* left, sample_t* right, float coeffSrc, int frames );
+
 } // namespace MixHelpers
 
 
@@ -26,18 +26,27 @@
 #define LMMS_MIXER_H
 
 #include "Model.h"
+#include "AudioEngineProfiler.h"
+#include "CompensationDelay.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
+#include "MixHelpers.h"
 #include "ThreadableJob.h"
+#include "TruePeakMeter.h"
 
+#include <array>
 #include <atomic>
+#include <memory>
 #include <optional>
+#include <vector>
 #include <QColor>
 
 namespace lmms
 {
 
 
+class AudioPort;
+class ChannelOutput;
 class MixerRoute;
 using MixerRouteVector = std::vector<MixerRoute*>;
 
@@ -53,16 +62,19 @@ class MixerChannel : public ThreadableJob
 		bool m_hasInput;
 		// set to true if any effect in the channel is enabled and running
 		bool m_stillRunning;
+		// set to true if the effects wrote to the buffer in this period
+		bool m_fxChainActive;
 
-		float m_peakLeft;
-		float m_peakRight;
 		sampleFrame * m_buffer;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
 		BoolModel m_soloModel;
 		FloatModel m_volumeModel;
+		//! Whether the channel has an output of its own on the audio device,
+		//! with what it sends on after the fader
+		BoolModel m_outputModel;
 		QString m_name;
-		QMutex m_lock;
+		QMutex m_lock; // guards m_buffer for senders without a partial sum
 		int m_channelIndex; // what channel index are we
 		bool m_queued; // are we queued up for rendering yet?
 		bool m_muted; // are we muted? updated per period so we don't have to call m_muteModel.value() twice
@@ -73,6 +85,10 @@ class MixerChannel : public ThreadableJob
 		// pointers to other channels that send to this one
 		MixerRouteVector m_receives;
 
+		// number of audio ports sending to this channel, only counted
+		// while rendering the task graph
+		int m_portInputs;
+
 		bool requiresProcessing() const override { return true; }
 		void unmuteForSolo();
 
@@ -82,11 +98,98 @@ class MixerChannel : public ThreadableJob
 		std::atomic_int m_dependenciesMet;
 		void incrementDeps();
 		void processed();
+
+		//! Add the output of an audio port to this channel's input
+		void addInput( const sampleFrame * buf );
+		//! Add the output of an audio port that was meant for a bypassed
+		//! channel, mixed like the route from that channel would have
+		void addInput( const sampleFrame * buf, float gain );
+
+		// while exporting, a channel without effects, receives and with only
+		// one send passes its inputs right on to the channel it sends to,
+		// multiplied by its volume and the send amount, and has no buffer or
+		// job of its own - set by Mixer::prepareMasterMix()
+		MixerChannel * m_bypassTarget;
+		float m_bypassGain;
+		//! Forget about partial sums that never got mixed into the channel
+		void discardPartialInputs();
+
+		//! What the meters show, after the fader
+		struct Levels
+		{
+			float peakLeft = 0.0f;
+			float peakRight = 0.0f;
+			float rmsLeft = 0.0f;
+			float rmsRight = 0.0f;
+			//! Of both channels, only measured on the master
+			float truePeak = 0.0f;
+		};
+
+		//! The levels of the periods mixed since the last call, nothing if
+		//! there weren't any. Only reads what the audio thread published, so
+		//! the GUI can call it any time without holding the audio thread up.
+		auto takeLevels() -> std::optional<Levels>;
+		//! Publish what was measured in the period that was just mixed,
+		//! multiplied by @p gain - called by the audio thread only
+		void publishLevels( float gain, float truePeak = 0.0f );
+
+		// what was measured of m_buffer in this period, before the fader
+		MixHelpers::Measurement m_measurement;
+		// whether m_measurement is written by the first channel this one
+		// sends to, while it mixes m_buffer in anyway
+		bool m_measuredBySend;
+
+		//! Load of this channel, its effects and the audio ports sending
+		//! to it directly
+		int cpuLoad() const { return m_cpuAccount.load(); }
+		void addCpuTime(int time) { m_cpuAccount.add(time); }
+		void updateCpuAccountName();
+
+		//! Whether infs or nans came out of this channel or the tracks
+		//! sending to it directly since the last call, which were muted
+		bool takeNonFinite() { return m_nonFinite.exchange( false, std::memory_order_relaxed ); }
+
+		//! Get an output from the audio device or give it back, as
+		//! m_outputModel says, and name it after the channel
+		void updateOutput();
+		void updateOutputName();
 		
 	private:
 		void doProcessing() override;
+		void mixPartialInputs();
+		QString outputName() const;
+
+		// every worker thread accumulates the audio ports it renders into
+		// its own buffer, so senders don't have to synchronise with each
+		// other - these get added up once the channel itself is processed
+		struct alignas(64) PartialInput
+		{
+			sampleFrame * buffer;
+			bool hasInput;
+		};
+		std::vector<PartialInput> m_partialInputs;
+
+		// the levels since the GUI took them last, only the audio thread
+		// touches these
+		Levels m_pendingLevels;
+		double m_pendingSquares[2];
+		f_cnt_t m_pendingFrames;
+
+		// m_pendingLevels as published: m_levelsSequence is odd while the values
+		// get written, and m_levelsTaken is the sequence the GUI read last
+		std::atomic<unsigned> m_levelsSequence;
+		std::atomic<unsigned> m_levelsTaken;
+		std::array<std::atomic<float>, 5> m_publishedLevels;
+
+		AudioEngineProfiler::Account m_cpuAccount;
+
+		std::atomic_bool m_nonFinite = false;
+
+		std::unique_ptr<ChannelOutput> m_output;
 
 		std::optional<QColor> m_color;
+
+		friend class Mixer;
 };
 
 class MixerRoute : public QObject
@@ -123,10 +226,32 @@ public:
 
 	void updateName();
 
+	//! Frames what is sent gets delayed by, so it arrives together with what
+	//! the receiver gets on paths with more latency - set by Mixer::prepareMasterMix()
+	f_cnt_t compensation() const
+	{
+		return m_compensation.delay();
+	}
+
+	void setCompensation( f_cnt_t frames );
+
+	//! Whether something sent earlier is still to come out of the delay
+	bool hasCompensationTail() const
+	{
+		return m_compensation.hasTail();
+	}
+
+	//! @p buf delayed by compensation(), in a buffer of the route's own.
+	//! @p hasInput is false if the sender had nothing to send.
+	const sampleFrame * compensate( const sampleFrame * buf, fpp_t frames, bool hasInput );
+
 	private:
 		MixerChannel * m_from;
 		MixerChannel * m_to;
 		FloatModel m_amount;
+
+		CompensationDelay m_compensation;
+		std::vector<sampleFrame> m_compensationBuffer;
 };
 
 
@@ -139,9 +264,20 @@ public:
 
 	void mixToChannel( const sampleFrame * _buf, mix_ch_t _ch );
 
-	void prepareMasterMix();
+	//! Clear the master and set up the channels for the next period, which
+	//! includes the delays that compensate for the latency of the effects on
+	//! the way from @p ports to the master
+	void prepareMasterMix( const std::vector<AudioPort*> & ports );
 	void masterMix( sampleFrame * _buf );
 
+	// task graph support, see AudioEngine::renderStageGraph(): channels are
+	// queued as soon as all ports and channels sending to them are processed
+	void prepareTaskGraph( const std::vector<AudioPort*> & ports );
+	void scheduleChannels();
+	void inputProcessed( mix_ch_t _ch );
+	//! Apply master volume and reset all channels after all channels were processed
+	void finishMasterMix( sampleFrame * _buf );
+
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 	void loadSettings( const QDomElement & _this ) override;
 
@@ -184,6 +320,12 @@ public:
 	// delete all the mixer channels except master and remove all effects
 	void clear();
 
+	// give the channels with an output of their own one from the current audio
+	// device, or take them back before the device is replaced - only while
+	// the audio engine doesn't process
+	void createChannelOutputs();
+	void releaseChannelOutputs();
+
 	// re-arrange channels
 	void moveChannelLeft(int index);
 	void moveChannelRight(int index);
@@ -217,6 +359,25 @@ private:
 	void allocateChannelsTo(int num);
 
 	int m_lastSoloed;
+
+	bool m_taskGraph;
+
+	// the channels grouped in levels, a channel's level is one more than the
+	// highest level of the channels sending to it, so every level only
+	// depends on the ones before - rebuilt after channels or routes changed
+	std::vector<std::vector<MixerChannel*>> m_levels;
+	// the channels that could be bypassed, as far as the routing goes
+	std::vector<MixerChannel*> m_passThrough;
+	bool m_levelsChanged;
+	void updateLevels();
+
+	// line the paths from the ports through the channels up with the one
+	// with the most latency, using the order of m_levels
+	void updateCompensation( const std::vector<AudioPort*> & ports );
+	std::vector<f_cnt_t> m_inputLatencies;
+	std::vector<f_cnt_t> m_outputLatencies;
+
+	TruePeakMeter m_masterTruePeak;
 } ;
 
 
@@ -112,6 +112,7 @@ namespace lmms::gui
         SendButtonIndicator* m_sendButton;
         Knob* m_sendKnob;
         LcdWidget* m_channelNumberLcd;
+        QLabel* m_cpuLoadLabel;
         QLineEdit* m_renameLineEdit;
         QGraphicsView* m_renameLineEditView;
         QLabel* m_sendArrow;
@@ -27,6 +27,7 @@
 
 #include <QString>
 #include <QObject>
+#include <atomic>
 
 #include "lmms_export.h"
 
@@ -40,7 +41,7 @@ public:
 	Model(Model* parent, QString displayName = QString(),
 		  bool defaultConstructed = false);
 
-	~Model() override = default;
+	~Model() override;
 
 	bool isDefaultConstructed() const;
 
@@ -52,11 +53,24 @@ public:
 
 	virtual QString fullDisplayName() const;
 
+	//! Emits displayChanged() for the models whose data changed on another thread
+	//! since the last call. The GUI calls this once per frame.
+	static void emitDisplayChanges();
+
 
 private:
+	void markDisplayChanged();
+	void removeFromDisplayChanges();
+
 	QString m_displayName;
 	bool m_defaultConstructed;
 
+	// the models that changed on another thread, linked through
+	// m_nextDisplayChange, so marking one neither locks nor allocates
+	static std::atomic<Model*> s_displayChanges;
+	std::atomic<bool> m_displayChangePending = false;
+	Model* m_nextDisplayChange = nullptr;
+
 
 signals:
 	// emitted if actual data of the model (e.g. values) have changed
@@ -68,6 +82,11 @@ signals:
 	// emitted if properties of the model (e.g. ranges) have changed
 	void propertiesChanged();
 
+	// what views should redraw on: emitted with dataChanged() on the model's
+	// thread, but once per GUI frame for changes on other threads, like
+	// automation played on the audio thread
+	void displayChanged();
+
 } ;
 
 
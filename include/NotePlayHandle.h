@@ -26,24 +26,27 @@
 #ifndef LMMS_NOTE_PLAY_HANDLE_H
 #define LMMS_NOTE_PLAY_HANDLE_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "BasicFilters.h"
 #include "Note.h"
 #include "PlayHandle.h"
 #include "Track.h"
 #include "MemoryManager.h"
-
-class QReadWriteLock;
+#include "PeriodArena.h"
 
 namespace lmms
 {
 
+class AutomationClip;
 class InstrumentTrack;
 class NotePlayHandle;
 
 using NotePlayHandleList = QList<NotePlayHandle*>;
-using ConstNotePlayHandleList = QList<const NotePlayHandle*>;
+using ConstNotePlayHandleList = PeriodAllocator<const NotePlayHandle*>::vector;
 
 class LMMS_EXPORT NotePlayHandle : public PlayHandle, public Note
 {
@@ -108,12 +111,25 @@ public:
 		return m_unpitchedFrequency;
 	}
 
+	/*! The frequency for every frame of this period, from noteOffset() on, while
+		the detuning automation of the note moves in it - nullptr while it doesn't
+		and frequency() is right for the whole period. It's frequency() where the
+		note starts in the period. */
+	const float* frequencyBuffer() const
+	{
+		return m_frequencyBuffer;
+	}
+
 	//! Get the current per-note detuning for this note
-	float currentDetuning() const { return m_baseDetuning->value(); }
+	float currentDetuning() const { return m_detuning; }
 
 	/*! Renders one chunk using the attached instrument into the buffer */
 	void play( sampleFrame* buffer ) override;
 
+	/*! Hands the note to its instrument before this period's notes start playing,
+	    if the instrument renders all of them at once */
+	void queueForBatch();
+
 	/*! Returns whether playback of note is finished and thus handle can be deleted */
 	bool isFinished() const override
 	{
@@ -129,6 +145,8 @@ public:
 	/*! Returns whether the play handle plays on a certain track */
 	bool isFromTrack( const Track* _track ) const override;
 
+	const void* workerAffinity() const override;
+
 	/*! Releases the note (and plays release frames) */
 	void noteOff( const f_cnt_t offset = 0 );
 
@@ -204,7 +222,7 @@ public:
 	/*! Returns whether note has children */
 	bool isMasterNote() const
 	{
-		return m_subNotes.size() > 0 || m_hadChildren;
+		return !m_subNotes.isEmpty() || m_hadChildren;
 	}
 
 	void setMasterNote()
@@ -222,6 +240,39 @@ public:
 	/*! Mutes playback of note */
 	void mute();
 
+	/*! Releases the note with a short fade out instead of the envelopes' release
+	    to make room for another one, from the next period on - can be called
+	    from any thread. Returns false if the note was stolen already. */
+	bool steal();
+
+	/*! Returns whether the note was stolen and doesn't count as playing anymore */
+	bool isStolen() const
+	{
+		return m_stolen.load( std::memory_order_relaxed );
+	}
+
+	/*! Fades the note out over the frames of this period in @p buf if it was stolen */
+	void applyStealFade( sampleFrame* buf, const fpp_t frames ) const;
+
+	/*! The gain of the volume envelope at the end of this period, 1 if there's none */
+	float envelopeGain() const
+	{
+		return m_envelopeGain;
+	}
+
+	void setEnvelopeGain( float gain )
+	{
+		m_envelopeGain = gain;
+	}
+
+	/*! Ends a released note early once it rendered nothing above InaudibleLevel
+	    for 50 ms, so long releases don't keep inaudible notes alive. @p peak is
+	    the peak of this period's @p frames after all gains. */
+	void checkAudibility( float peak, const fpp_t frames );
+
+	//! -90 dBFS
+	static constexpr float InaudibleLevel = 3.1622776e-5f;
+
 	/*! Returns index of NotePlayHandle in vector of note-play-handles
 	    belonging to this instrument track - used by arpeggiator.
 	    Ignores child note-play-handles, returns -1 when called on one */
@@ -247,8 +298,9 @@ public:
 		m_patternTrack = t;
 	}
 
-	/*! Process note detuning automation */
-	void processTimePos(const TimePos& time, float pitchValue, bool isRecording);
+	/*! Process note detuning automation at the tick @p time, which is at the
+		frame @p offset of this period */
+	void processTimePos(const TimePos& time, f_cnt_t offset, float pitchValue, bool isRecording);
 
 	/*! Updates total length (m_frames) depending on a new tempo */
 	void resize( const bpm_t newTempo );
@@ -277,23 +329,75 @@ private:
 	public:
 		BaseDetuning( DetuningHelper* detuning );
 
-		void setValue( float val )
-		{
-			m_value = val;
-		}
+		const AutomationClip* clip() const;
 
-		float value() const
-		{
-			return m_value;
-		}
+		//! Where the playback is in the automation: at @p time at the frame
+		//! @p offset of this period
+		void follow( double time, f_cnt_t offset );
+
+		//! Where the playback is in the automation when this period starts,
+		//! nothing if it doesn't follow it (anymore)
+		std::optional<double> timeAtPeriodStart() const;
 
 
 	private:
-		float m_value;
+		DetuningHelper* m_detuning;
+		double m_time;
+		f_cnt_t m_offset;
+		std::uint64_t m_period;
+
+	} ;
+
+	//! The sub-notes of a note, linked through the handles themselves, so
+	//! chords and arpeggios start notes without allocating
+	class SubNotes
+	{
+	public:
+		class Iterator
+		{
+		public:
+			explicit Iterator( NotePlayHandle * note ) : m_note( note ) {}
+
+			NotePlayHandle * operator*() const { return m_note; }
+			Iterator & operator++()
+			{
+				m_note = m_note->m_nextSibling;
+				return *this;
+			}
+			bool operator!=( const Iterator & other ) const { return m_note != other.m_note; }
+
+		private:
+			NotePlayHandle * m_note;
+		} ;
+
+		Iterator begin() const { return Iterator( m_first ); }
+		Iterator end() const { return Iterator( nullptr ); }
+		bool isEmpty() const { return m_first == nullptr; }
+
+		void push_back( NotePlayHandle * note );
+		//! Does nothing if @p note isn't one of these
+		void removeOne( NotePlayHandle * note );
+		//! The notes stay, they are just no sub-notes anymore
+		void clear();
 
+	private:
+		NotePlayHandle * m_first = nullptr;
+		NotePlayHandle * m_last = nullptr;
 	} ;
 
 	void updateFrequency();
+	//! updateFrequency() for this note, without the sub-notes
+	void updateOwnFrequency();
+	//! Evaluates the detuning automation for this period
+	void updateDetuning();
+
+	// play() without the instrument rendering the note: startPeriod()
+	// returns whether the note plays in this period, and if so leaves it
+	// locked until finishPeriod()
+	bool startPeriod();
+	void finishPeriod();
+	f_cnt_t framesThisPeriod() const;
+	void playBatch( sampleFrame* buffer );
 
 	InstrumentTrack* m_instrumentTrack;		// needed for calling
 											// InstrumentTrack::playNote
@@ -307,7 +411,10 @@ private:
 											// played after release
 	f_cnt_t m_releaseFramesDone;			// number of frames done after
 											// release of note
-	NotePlayHandleList m_subNotes;			// used for chords and arpeggios
+	SubNotes m_subNotes;					// used for chords and arpeggios
+	SubNotes * m_siblings;					// the ones of the parent this one is in
+	NotePlayHandle * m_previousSibling;
+	NotePlayHandle * m_nextSibling;
 	volatile bool m_released;				// indicates whether note is released
 	bool m_releaseStarted;
 	bool m_hasMidiNote;
@@ -326,24 +433,56 @@ private:
 	float m_frequency;
 	float m_unpitchedFrequency;
 
-	BaseDetuning* m_baseDetuning;
+	BaseDetuning* m_baseDetuning;			// the one of the note without parent
+	BaseDetuning m_ownBaseDetuning;			// of this note, if it has none
+	float m_detuning;						// where this note is in it
+	const float* m_frequencyBuffer;			// while it moves within the period
 	TimePos m_songGlobalParentOffset;
 
 	int m_midiChannel;
 	Origin m_origin;
 
 	bool m_frequencyNeedsUpdate;				// used to update pitch
+	NotePlayHandle * m_batchLead;			// note rendering the batch this
+											// one is in, if any
+
+	std::atomic_bool m_stolen;
+	bool m_stealFading;						// whether the fade out started
+	f_cnt_t m_stealFadeStart;				// m_releaseFramesDone when it did
+	f_cnt_t m_stealFadeFrames;
+
+	float m_envelopeGain;
+	f_cnt_t m_inaudibleFrames;				// how long the release was inaudible for
 } ;
 
 
 const int INITIAL_NPH_CACHE = 256;
 const int NPH_CACHE_INCREMENT = 16;
 
+/*! Keeps a pool of note play handles, so notes can start and end on the
+ *  audio threads without allocating. Free handles are kept in a lock-free
+ *  stack, and a background thread adds handles whenever fewer than half of
+ *  the high-water mark are left, until it is reached again.
+ */
 class NotePlayHandleManager
 {
 	MM_OPERATORS
 public:
+	struct Statistics
+	{
+		int size;
+		int available;
+		int peakInUse;
+		//! How often the pool ran dry and had to grow on an audio thread
+		int audioThreadGrowths;
+		//! How many notes were released early because of the polyphony limits
+		int stolen;
+	};
+
 	static void init();
+	//! Before taking a handle, steals notes of @p instrumentTrack if it plays
+	//! as many as it may, and the oldest of any track if all of them together
+	//! reach the voice limit
 	static NotePlayHandle * acquire( InstrumentTrack* instrumentTrack,
 					const f_cnt_t offset,
 					const f_cnt_t frames,
@@ -353,13 +492,15 @@ public:
 					NotePlayHandle::Origin origin = NotePlayHandle::Origin::MidiClip );
 	static void release( NotePlayHandle * nph );
 	static void extend( int i );
+	//! How many free handles to keep in the pool, INITIAL_NPH_CACHE by default
+	static void setHighWaterMark( int handles );
+	//! Has the pool grow in the background until @p handles are free, for
+	//! notes that are about to start - safe to call on the audio threads
+	static void expect( int handles );
+	static Statistics statistics();
+	//! The most notes of all tracks playing at once, 0 for no limit
+	static void setVoiceLimit( int voices );
 	static void free();
-
-private:
-	static NotePlayHandle ** s_available;
-	static QReadWriteLock s_mutex;
-	static std::atomic_int s_availableIndex;
-	static int s_size;
 };
 
 
@@ -26,6 +26,8 @@
 #ifndef LMMS_OSCILLATOR_H
 #define LMMS_OSCILLATOR_H
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <fftw3.h>
 #include <memory>
@@ -46,6 +48,26 @@ namespace lmms
 class IntModel;
 
 
+//! The band limited tables of a user defined wave, see Oscillator::userWaveTable()
+class UserWaveTable
+{
+public:
+	//! The tables, nullptr until they are generated. Safe to call from the audio thread.
+	auto tables() const -> const OscillatorConstants::waveform_t*
+	{
+		return m_ready.load(std::memory_order_acquire) ? &m_tables : nullptr;
+	}
+
+private:
+	friend class Oscillator;
+
+	OscillatorConstants::waveform_t m_tables;
+	std::atomic<bool> m_ready = false;
+	//! The wave the tables are made from
+	std::shared_ptr<const SampleBuffer> m_wave;
+};
+
+
 class LMMS_EXPORT Oscillator
 {
 public:
@@ -90,27 +112,55 @@ public:
 		delete m_subOsc;
 	}
 
+	//! Maps the band limited tables from the cache on disk, or starts
+	//! generating them in the background if there's no valid cache yet
 	static void waveTableInit();
 	static void destroyFFTPlans();
-	static std::unique_ptr<OscillatorConstants::waveform_t> generateAntiAliasUserWaveTable(const SampleBuffer* sampleBuffer);
+	//! Bytes taken by the band limited tables of the built-in waveforms
+	static std::size_t waveTableMemoryUsage()
+	{
+		return sizeof( s_generatedWaveTables );
+	}
+	//! The band limited tables of @p wave, shared with everything else that uses the same frames.
+	//! If there are none yet they are generated in the background, the oscillators play the wave
+	//! as it is until then.
+	static auto userWaveTable(std::shared_ptr<const SampleBuffer> wave) -> std::shared_ptr<const UserWaveTable>;
 
 	inline void setUseWaveTable(bool n)
 	{
 		m_useWaveTable = n;
 	}
 
+	//! Band-limit the discontinuities of the basic shapes with polyBLEP
+	//! residuals instead of reading band-limited tables. Takes precedence
+	//! over the wave tables for all shapes except the user defined one.
+	inline void setUsePolyBlep(bool n)
+	{
+		m_usePolyBlep = n;
+	}
+
 	void setUserWave(std::shared_ptr<const SampleBuffer> _wave)
 	{
 		m_userWave = _wave;
 	}
 
-	void setUserAntiAliasWaveTable(std::shared_ptr<const OscillatorConstants::waveform_t> waveform)
+	void setUserAntiAliasWaveTable(std::shared_ptr<const UserWaveTable> waveTable)
 	{
-		m_userAntiAliasWaveTable = waveform;
+		m_userAntiAliasWaveTable = waveTable;
 	}
 
 	void update(sampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl, bool modulator = false);
 
+	//! Updates the oscillators of several voices at once, with the voices
+	//! running side by side through SIMD lanes. They must have been set up
+	//! alike, from the same models and variables, except for the frequency.
+	//! Voice i renders frames[i] frames into buffers[i].
+	//! Returns false without rendering anything if a shape or modulation
+	//! in use can't be rendered this way, the voices need to be updated one
+	//! by one then.
+	static bool updateVoices(Oscillator* const* voices, sampleFrame* const* buffers, const fpp_t* frames,
+		std::size_t count, const ch_cnt_t chnl);
+
 	// now follow the wave-shape-routines...
 	static inline sample_t sinSample( const float _sample )
 	{
@@ -161,6 +211,78 @@ public:
 		return -1.0f + 8.0f * ph * ph;
 	}
 
+	//! Residual that turns a naive step of +2 at phase 0 into a band-limited
+	//! one, @p phase is relative to the step and @p inc the phase increment
+	//! per sample
+	static inline float polyBlep(float phase, const float inc)
+	{
+		if (phase < inc)
+		{
+			phase /= inc;
+			return phase + phase - phase * phase - 1.0f;
+		}
+		if (phase > 1.0f - inc)
+		{
+			phase = (phase - 1.0f) / inc;
+			return phase * phase + phase + phase + 1.0f;
+		}
+		return 0.0f;
+	}
+
+	//! Integrated polyBlep(), the residual for a change of slope of one per
+	//! sample at phase 0
+	static inline float polyBlamp(float phase, const float inc)
+	{
+		if (phase < inc)
+		{
+			phase = 1.0f - phase / inc;
+			return phase * phase * phase * (1.0f / 6.0f);
+		}
+		if (phase > 1.0f - inc)
+		{
+			phase = 1.0f + (phase - 1.0f) / inc;
+			return phase * phase * phase * (1.0f / 6.0f);
+		}
+		return 0.0f;
+	}
+
+	static inline sample_t triangleBlepSample(const float sample, const float inc)
+	{
+		// the slope changes by -8 at a quarter and by +8 at three quarters
+		const float ph = absFraction(sample);
+		return triangleSample(ph) + 8.0f * inc * (polyBlamp(absFraction(ph + 0.25f), inc)
+			- polyBlamp(absFraction(ph + 0.75f), inc));
+	}
+
+	static inline sample_t sawBlepSample(const float sample, const float inc)
+	{
+		const float ph = absFraction(sample);
+		return sawSample(ph) - polyBlep(ph, inc);
+	}
+
+	static inline sample_t squareBlepSample(const float sample, const float inc)
+	{
+		const float ph = absFraction(sample);
+		return squareSample(ph) + polyBlep(ph, inc) - polyBlep(absFraction(ph + 0.5f), inc);
+	}
+
+	static inline sample_t moogSawBlepSample(const float sample, const float inc)
+	{
+		// steps down by one at half the period, where the slope changes from
+		// 4 to -2, and back at the start of the period
+		const float ph = absFraction(sample);
+		const float half = absFraction(ph + 0.5f);
+		return moogSawSample(ph) - 0.5f * polyBlep(half, inc)
+			+ 6.0f * inc * (polyBlamp(ph, inc) - polyBlamp(half, inc));
+	}
+
+	static inline sample_t expBlepSample(const float sample, const float inc)
+	{
+		// only the slope at half the period is discontinuous
+		const float ph = absFraction(sample);
+		return expSample(ph) - 16.0f * inc * polyBlamp(absFraction(ph + 0.5f), inc);
+	}
+
 	static inline sample_t noiseSample( const float )
 	{
 		// Precise implementation
@@ -263,14 +385,19 @@ private:
 	float m_phaseOffset;
 	float m_phase;
 	std::shared_ptr<const SampleBuffer> m_userWave = SampleBuffer::emptyBuffer();
-	std::shared_ptr<const OscillatorConstants::waveform_t> m_userAntiAliasWaveTable;
+	std::shared_ptr<const UserWaveTable> m_userAntiAliasWaveTable;
 	bool m_useWaveTable;
+	bool m_usePolyBlep;
 	// There are many update*() variants; the modulator flag is stored as a member variable to avoid
 	// adding more explicit parameters to all of them. Can be converted to a parameter if needed.
 	bool m_isModulator;
 
 	/* Multiband WaveTable */
-	static sample_t s_waveTables[NumWaveShapeTables][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH];
+	using WaveTables = sample_t[NumWaveShapeTables][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH];
+	// either s_generatedWaveTables or the tables mapped from the cache
+	static const sample_t ( *s_waveTables )[OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH];
+	static WaveTables s_generatedWaveTables;
+	static std::array<std::atomic_bool, NumWaveShapeTables> s_waveTableReady;
 	static fftwf_plan s_fftPlan;
 	static fftwf_plan s_ifftPlan;
 	static fftwf_complex * s_specBuf;
@@ -280,9 +407,23 @@ private:
 	static void generateTriangleWaveTable(int bands, sample_t* table, int firstBand = 1);
 	static void generateSquareWaveTable(int bands, sample_t* table, int firstBand = 1);
 	static void generateFromFFT(int bands, sample_t* table);
-	static void generateWaveTables();
+	static void generateWaveTable(std::size_t table);
+	class UserWaveTableTask;
+	static void generateUserWaveTable(UserWaveTable& waveTable);
+	static bool loadWaveTableCache();
+	static void saveWaveTableCache();
 	static void createFFTPlans();
 
+	//! Tables are generated on first use, unless the background thread
+	//! started by waveTableInit() got there first
+	static void requireWaveTable(std::size_t table)
+	{
+		if (!s_waveTableReady[table].load(std::memory_order_acquire))
+		{
+			generateWaveTable(table);
+		}
+	}
+
 	/* End Multiband wavetable */
 
 
@@ -299,33 +440,61 @@ private:
 	void updateFM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
 
+	//! How the samples of the wave shape are made, which stays the same for a whole update()
+	enum class Sampling
+	{
+		Direct, //!< straight from the wave function
+		WaveTable, //!< band-limited, which leaves nothing of a sine above the highest frequency
+		PolyBlep
+	};
+	auto sampling(WaveShape shape) const -> Sampling;
+	template<typename F>
+	void dispatch(F&& update);
+	template<WaveShape W, typename F>
+	void dispatch(F&& update);
+
 	float syncInit( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
 	inline bool syncOk( float _osc_coeff );
 
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updatePM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updateAM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updateMix( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updateSync( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	void updateFM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
 
-	template<WaveShape W>
+	template<WaveShape W, Sampling S>
 	inline sample_t getSample( const float _sample );
 
-	inline void recalcPhase();
+	bool canUpdateWith(const Oscillator& other) const;
+	bool canUpdateInLanes(bool modulator) const;
+	static void updateLanes(Oscillator* const* lanes, std::size_t count, float* signal,
+		const fpp_t* frames, fpp_t maxFrames, bool modulator);
+
+	// should be called every time phase-offset is changed...
+	inline void recalcPhase()
+	{
+		if( !typeInfo<float>::isEqual( m_phaseOffset, m_ext_phaseOffset ) )
+		{
+			m_phase -= m_phaseOffset;
+			m_phaseOffset = m_ext_phaseOffset;
+			m_phase += m_phaseOffset;
+		}
+		m_phase = absFraction( m_phase );
+	}
 
 } ;
 
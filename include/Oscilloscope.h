@@ -27,9 +27,15 @@
 
 #include <QWidget>
 #include <QPixmap>
+#include <memory>
 
 #include "lmms_basics.h"
 
+namespace lmms
+{
+template<class T> class LocklessRingBufferReader;
+}
+
 namespace lmms::gui
 {
 
@@ -58,10 +64,9 @@ protected:
 	void mousePressEvent( QMouseEvent * _me ) override;
 
 
-protected slots:
-	void updateAudioBuffer( const lmms::surroundSampleFrame * buffer );
-
 private:
+	//! Takes the newest period of the master output from the audio engine
+	void readAudioBuffer();
 	QColor const & determineLineColor(float level) const;
 
 private:
@@ -69,6 +74,7 @@ private:
 	QPointF * m_points;
 
 	sampleFrame * m_buffer;
+	std::unique_ptr<LocklessRingBufferReader<surroundSampleFrame>> m_reader;
 	bool m_active;
 
 	QColor m_normalColor;
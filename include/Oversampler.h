@@ -0,0 +1,189 @@
+/*
+ * Oversampler.h - runs a part of an effect at a multiple of the sample rate
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_OVERSAMPLER_H
+#define LMMS_OVERSAMPLER_H
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "hiir/Downsampler2xFpu.h"
+#include "hiir/PolyphaseIir2Designer.h"
+#include "hiir/Upsampler2xFpu.h"
+
+#include "lmms_basics.h"
+
+namespace lmms
+{
+
+/**
+ * Up- and downsamples stereo audio by 2, 4 or 8 with cascaded polyphase IIR
+ * half-band filters, for the nonlinear parts of an effect that would alias
+ * at the processing sample rate - unlike the oversampling of the quality
+ * settings, which makes everything render at the higher rate.
+ *
+ * Header only, a plugin using it links to the hiir target.
+ */
+class Oversampler
+{
+public:
+	static constexpr int MaxStages = 3;
+
+	//! For periods of up to @p maxFrames, all of the memory is allocated here
+	explicit Oversampler(fpp_t maxFrames) :
+		m_maxFrames(maxFrames)
+	{
+		for (int s = 0; s < MaxStages; ++s)
+		{
+			m_buffers[s].resize(static_cast<std::size_t>(maxFrames) << (s + 1));
+		}
+		m_base.resize(maxFrames);
+	}
+
+	//! Oversample by 2 to the power of @p stages, from 0 for not at all. Forgets
+	//! what the filters were holding if that changes.
+	void setStages(int stages)
+	{
+		stages = std::clamp(stages, 0, MaxStages);
+		if (stages == m_stages) { return; }
+		m_stages = stages;
+		reset();
+	}
+
+	int stages() const { return m_stages; }
+	int factor() const { return 1 << m_stages; }
+
+	//! A copy of @p frames frames of @p in, at factor() times the rate. It may be
+	//! processed in place before downsample() converts it back.
+	sampleFrame* upsample(const sampleFrame* in, fpp_t frames)
+	{
+		frames = std::min(frames, m_maxFrames);
+		if (m_stages == 0)
+		{
+			std::copy_n(in, frames, m_base.data());
+			return m_base.data();
+		}
+
+		m_stage1.up(in, m_buffers[0].data(), frames);
+		if (m_stages > 1) { m_stage2.up(m_buffers[0].data(), m_buffers[1].data(), 2 * frames); }
+		if (m_stages > 2) { m_stage3.up(m_buffers[1].data(), m_buffers[2].data(), 4 * frames); }
+		return m_buffers[m_stages - 1].data();
+	}
+
+	//! Writes the @p frames frames that the last upsample() became back at the
+	//! processing rate to @p out
+	void downsample(sampleFrame* out, fpp_t frames)
+	{
+		frames = std::min(frames, m_maxFrames);
+		if (m_stages == 0)
+		{
+			std::copy_n(m_base.data(), frames, out);
+			return;
+		}
+
+		if (m_stages > 2) { m_stage3.down(m_buffers[2].data(), m_buffers[1].data(), 4 * frames); }
+		if (m_stages > 1) { m_stage2.down(m_buffers[1].data(), m_buffers[0].data(), 2 * frames); }
+		m_stage1.down(m_buffers[0].data(), out, frames);
+	}
+
+	void reset()
+	{
+		m_stage1.clear();
+		m_stage2.clear();
+		m_stage3.clear();
+	}
+
+private:
+	//! Doubles or halves the rate, @p Coefs is the order of its filters
+	template<int Coefs>
+	class Stage
+	{
+	public:
+		//! @p transition is the width of the transition band, relative to the higher rate
+		explicit Stage(double transition)
+		{
+			double coefs[Coefs];
+			hiir::PolyphaseIir2Designer::compute_coefs_spec_order_tbw(coefs, Coefs, transition);
+			for (int c = 0; c < 2; ++c)
+			{
+				m_up[c].set_coefs(coefs);
+				m_down[c].set_coefs(coefs);
+			}
+		}
+
+		//! From @p frames frames of @p in to twice as many in @p out
+		void up(const sampleFrame* in, sampleFrame* out, f_cnt_t frames)
+		{
+			for (f_cnt_t f = 0; f < frames; ++f)
+			{
+				for (int c = 0; c < 2; ++c)
+				{
+					m_up[c].process_sample(out[2 * f][c], out[2 * f + 1][c], in[f][c]);
+				}
+			}
+		}
+
+		//! From twice @p frames frames of @p in to @p frames in @p out
+		void down(const sampleFrame* in, sampleFrame* out, f_cnt_t frames)
+		{
+			for (f_cnt_t f = 0; f < frames; ++f)
+			{
+				for (int c = 0; c < 2; ++c)
+				{
+					const float pair[2] = {in[2 * f][c], in[2 * f + 1][c]};
+					out[f][c] = m_down[c].process_sample(pair);
+				}
+			}
+		}
+
+		void clear()
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				m_up[c].clear_buffers();
+				m_down[c].clear_buffers();
+			}
+		}
+
+	private:
+		std::array<hiir::Upsampler2xFpu<Coefs>, 2> m_up;
+		std::array<hiir::Downsampler2xFpu<Coefs>, 2> m_down;
+	};
+
+	// the first stage has to be steep to keep the audible band, the higher
+	// ones only have to reject what is above the original Nyquist frequency
+	Stage<12> m_stage1{0.02};
+	Stage<6> m_stage2{0.24};
+	Stage<4> m_stage3{0.37};
+
+	const fpp_t m_maxFrames;
+	int m_stages = 0;
+	std::array<std::vector<sampleFrame>, MaxStages> m_buffers;
+	std::vector<sampleFrame> m_base;
+};
+
+} // namespace lmms
+
+#endif // LMMS_OVERSAMPLER_H
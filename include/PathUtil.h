@@ -68,6 +68,10 @@ namespace lmms::PathUtil
 	//! Defaults to an absolute path if all bases fail.
 	QString LMMS_EXPORT toShortestRelative(const QString & input, bool allowLocal = false);
 
+	//! Where files go that speed things up but can be regenerated any time.
+	//! The LMMS_CACHE_DIR environment variable overrides the default.
+	QString LMMS_EXPORT cacheDir();
+
 } // namespace lmms::PathUtil
 
 #endif // LMMS_PATHUTIL_H
@@ -25,12 +25,16 @@
 #ifndef LMMS_PATTERN_STORE_H
 #define LMMS_PATTERN_STORE_H
 
+#include <QPointer>
+
 #include "TrackContainer.h"
 #include "ComboBoxModel.h"
 
 namespace lmms
 {
 
+class PatternTrack;
+
 namespace gui
 {
 	class PatternEditorWindow;
@@ -92,7 +96,7 @@ public:
 	void fixIncorrectPositions();
 	void createClipsForPattern(int pattern);
 
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum) const override;
+	AutomationSourceMap automationSourcesAt(TimePos time, int clipNum) const override;
 
 public slots:
 	void play();
@@ -103,6 +107,8 @@ public slots:
 
 private:
 	ComboBoxModel m_patternComboBoxModel;
+	//! The track of the pattern whose label is shown as the current one
+	QPointer<PatternTrack> m_currentPatternTrack;
 
 
 	// Where the pattern selection combo box is
@@ -26,6 +26,7 @@
 #define LMMS_PATTERN_TRACK_H
 
 #include <QMap>
+#include <vector>
 
 #include "Track.h"
 
@@ -62,6 +63,10 @@ public:
 	void loadTrackSpecificSettings( const QDomElement & _this ) override;
 
 	static PatternTrack* findPatternTrack(int pattern_num);
+	static int numOfPatternTracks()
+	{
+		return static_cast<int>(s_patternTracks.size());
+	}
 	static void swapPatternTracks(Track* track1, Track* track2);
 
 	int patternIndex()
@@ -94,6 +99,8 @@ private:
 
 	using infoMap = QMap<PatternTrack*, int>;
 	static infoMap s_infoMap;
+	//! The same the other way round, the track of each pattern
+	static std::vector<PatternTrack*> s_patternTracks;
 
 	friend class gui::PatternTrackView;
 } ;
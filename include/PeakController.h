@@ -78,8 +78,14 @@ private:
 	static int m_loadCount;
 	static bool m_buggedFile;
 	
+	//! The envelope is followed every this many frames and interpolated in between
+	static constexpr f_cnt_t ControlRateFrames = 16;
+
 	float m_attackCoeff;
 	float m_decayCoeff;
+	//! How far the envelope gets within ControlRateFrames
+	float m_attackBlockCoeff;
+	float m_decayBlockCoeff;
 	bool m_coeffNeedsUpdate;
 } ;
 
@@ -0,0 +1,91 @@
+/*
+ * PeriodArena.h - memory for temporaries which only live for one period
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_PERIOD_ARENA_H
+#define LMMS_PERIOD_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+
+/*! A bump allocator for the temporary containers built while rendering a
+ *  period, like the lists of clips and note play handles to process. Each
+ *  audio engine thread has its own arena, which is emptied when the next
+ *  period starts, so allocating from it never takes a lock or calls the
+ *  system allocator, and freeing does nothing at all.
+ *
+ *  Memory from the arena must not be kept beyond the period it was taken
+ *  in. Threads which haven't been attached, and arenas which are full, get
+ *  memory from the heap instead.
+ */
+class LMMS_EXPORT PeriodArena
+{
+public:
+	//! Called by the audio engine when it starts rendering a period, which
+	//! also attaches the calling thread
+	static void reset();
+	//! Lets the calling audio engine thread allocate from its own arena
+	static void attachThread();
+
+	static void* allocate(std::size_t size, std::size_t alignment);
+	static void deallocate(void* ptr);
+};
+
+
+template<typename T>
+struct PeriodAllocator
+{
+	using value_type = T;
+
+	PeriodAllocator() = default;
+	template<class U>
+	PeriodAllocator(const PeriodAllocator<U>&) {}
+
+	T* allocate(std::size_t n)
+	{
+		return static_cast<T*>(PeriodArena::allocate(sizeof(T) * n, alignof(T)));
+	}
+
+	void deallocate(T* p, std::size_t)
+	{
+		PeriodArena::deallocate(p);
+	}
+
+	template<class U>
+	bool operator==(const PeriodAllocator<U>&) const { return true; }
+	template<class U>
+	bool operator!=(const PeriodAllocator<U>&) const { return false; }
+
+	using vector = std::vector<T, PeriodAllocator<T>>;
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_PERIOD_ARENA_H
@@ -226,6 +226,7 @@ protected slots:
 	void updatePosition(const lmms::TimePos & t );
 	void updatePositionAccompany(const lmms::TimePos & t );
 	void updatePositionStepRecording(const lmms::TimePos & t );
+	void updateKeys();
 
 	void zoomingChanged();
 	void zoomingYChanged();
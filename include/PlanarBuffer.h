@@ -0,0 +1,85 @@
+/*
+ * PlanarBuffer.h - audio with every channel in a separate aligned array
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_PLANAR_BUFFER_H
+#define LMMS_PLANAR_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+
+/*! A stereo buffer holding all left samples, then all right samples,
+ *  instead of interleaving them like sampleFrame does. Every channel
+ *  starts on a cache line, so loops over one channel vectorise easily,
+ *  and it can be handed to plugin APIs with one port per channel.
+ */
+class LMMS_EXPORT PlanarBuffer
+{
+public:
+	static constexpr std::size_t Alignment = 64;
+
+	explicit PlanarBuffer( fpp_t frames );
+
+	fpp_t frames() const
+	{
+		return m_frames;
+	}
+
+	sample_t * channel( ch_cnt_t channel )
+	{
+		return m_data.get() + channel * m_stride;
+	}
+
+	const sample_t * channel( ch_cnt_t channel ) const
+	{
+		return m_data.get() + channel * m_stride;
+	}
+
+	void clear( fpp_t frames );
+
+	//! Adapters for the interleaved buffers used everywhere else
+	void deinterleave( const sampleFrame * src, fpp_t frames );
+	void interleave( sampleFrame * dst, fpp_t frames ) const;
+
+private:
+	struct AlignedDeleter
+	{
+		void operator()( sample_t * data ) const;
+	};
+
+	fpp_t m_frames;
+	std::size_t m_stride;
+	std::unique_ptr<sample_t[], AlignedDeleter> m_data;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_PLANAR_BUFFER_H
@@ -147,6 +147,25 @@ public:
 	
 	sampleFrame * buffer();
 
+	// set while another play handle renders this one's output along with
+	// its own, then this one's buffer is neither cleared nor mixed
+	void setRenderedElsewhere( bool b )
+	{
+		m_renderedElsewhere = b;
+	}
+
+	// set when the play handle should be removed at the start of the next
+	// period, because it can't be deleted right away
+	bool isRemovalRequested() const
+	{
+		return m_removalRequested;
+	}
+
+	void requestRemoval()
+	{
+		m_removalRequested = true;
+	}
+
 private:
 	Type m_type;
 	f_cnt_t m_offset;
@@ -155,6 +174,8 @@ private:
 	sampleFrame* m_playHandleBuffer;
 	bool m_bufferReleased;
 	bool m_usesBuffer;
+	bool m_renderedElsewhere;
+	bool m_removalRequested;
 	AudioPort * m_audioPort;
 } ;
 
@@ -39,6 +39,7 @@ namespace lmms
 {
 
 class AutomatableModel;
+class MemoryReport;
 class PixmapLoader;
 
 namespace gui
@@ -278,6 +279,12 @@ public:
 	//! reference the class header.  Should return null if not key not found.
 	virtual AutomatableModel* childModel( const QString & modelName );
 
+	//! Plugins holding large amounts of memory, like samples or tables,
+	//! add them to the report here
+	virtual void reportMemoryUsage( MemoryReport & ) const
+	{
+	}
+
 	//! Overload if the argument passed to the plugin is a subPluginKey
 	//! If you can not pass the key and are aware that it's stored in
 	//! Engine::pickDndPluginKey(), use this function, too
@@ -62,13 +62,19 @@ public:
 
 	static void setupSearchPaths();
 
+	/// Makes the factory load only the plugins that are asked for by name
+	/// instead of every plugin it can find, until something needs the whole
+	/// list. Rendering a project doesn't, so it only loads what the project
+	/// uses. Call this before the first instance().
+	static void setDiscoverOnDemand(bool onDemand);
+
 	/// Returns the singleton instance of PluginFactory. You won't need to call
 	/// this directly, use pluginFactory instead.
 	static PluginFactory* instance();
 
 	/// Returns a list of all found plugins' descriptors.
-	Plugin::DescriptorList descriptors() const;
-	Plugin::DescriptorList descriptors(Plugin::Type type) const;
+	Plugin::DescriptorList descriptors();
+	Plugin::DescriptorList descriptors(Plugin::Type type);
 
 	struct PluginInfoAndKey
 	{
@@ -78,14 +84,14 @@ public:
 	};
 
 	/// Returns a list of all found plugins' PluginFactory::PluginInfo objects.
-	const PluginInfoList& pluginInfos() const;
+	const PluginInfoList& pluginInfos();
 	/// Returns a plugin that support the given file extension
 	PluginInfoAndKey pluginSupportingExtension(const QString& ext);
 
 	/// Returns the PluginInfo object of the plugin with the given name.
 	/// If the plugin is not found, an empty PluginInfo is returned (use
 	/// PluginInfo::isNull() to check this).
-	PluginInfo pluginInfo(const char* name) const;
+	PluginInfo pluginInfo(const char* name);
 
 	/// When loading a library fails during discovery, the error string is saved.
 	/// It can be retrieved by calling this function.
@@ -95,6 +101,12 @@ public slots:
 	void discoverPlugins();
 
 private:
+	//! Loads the plugin library @p file, returns an empty PluginInfo if it isn't one
+	PluginInfo loadPlugin(const QFileInfo& file);
+	//! Loads the library of the plugin @p name only, as named by BUILD_PLUGIN
+	PluginInfo loadPluginOnDemand(const char* name);
+	void discoverAllPlugins();
+
 	DescriptorMap m_descriptors;
 	PluginInfoList m_pluginInfos;
 
@@ -103,6 +115,10 @@ private:
 
 	QHash<QString, QString> m_errors;
 
+	//! Whether discoverPlugins() ran, it doesn't in on demand mode until needed
+	bool m_discovered = false;
+
+	static bool s_discoverOnDemand;
 	static std::unique_ptr<PluginFactory> s_instance;
 };
 
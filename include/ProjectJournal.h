@@ -25,8 +25,10 @@
 #ifndef LMMS_PROJECT_JOURNAL_H
 #define LMMS_PROJECT_JOURNAL_H
 
+#include <QByteArray>
 #include <QHash>
 #include <QStack>
+#include <vector>
 
 #include "lmms_basics.h"
 #include "DataFile.h"
@@ -89,32 +91,46 @@ public:
 
 	void clearJournal();
 	void stopAllJournalling();
-	JournallingObject * journallingObject( const jo_id_t _id )
+	JournallingObject * journallingObject( const jo_id_t _id ) const
 	{
-		if( m_joIDs.contains( _id ) )
+		const auto& table = m_denseIDs[denseHalf( _id )];
+		const auto index = denseIndex( _id );
+		if( index < table.size() )
 		{
-			return m_joIDs[_id];
+			return table[index];
 		}
-		return nullptr;
+		return index < DenseIDs ? nullptr : m_sparseIDs.value( _id, nullptr );
 	}
 
 
 private:
 	using JoIdMap = QHash<jo_id_t, JournallingObject*>;
 
+	//! The state of an object before a change. It's kept compressed rather than as a DOM, which
+	//! takes many times the memory, for a big clip that undo may never go back to.
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::Type::JournalData ) ) :
-			joID( initID ),
-			data( initData )
-		{
-		}
-		jo_id_t joID;
-		DataFile data;
+		jo_id_t joID = 0;
+		QByteArray data;
 	} ;
 	using CheckPointStack = QStack<CheckPoint>;
 
-	JoIdMap m_joIDs;
+	static CheckPoint saveCheckPoint( JournallingObject * jo );
+	static void restoreCheckPoint( JournallingObject * jo, const CheckPoint & checkPoint );
+
+	//! Loaded IDs have the top bit cleared, new ones have it set, and both
+	//! are mostly small numbers, so each half starts with a table of its own
+	static constexpr jo_id_t NewIDBit = 1 << 23;
+	static constexpr jo_id_t DenseIDs = 1 << 18;
+	static std::size_t denseHalf( jo_id_t id ) { return ( id & NewIDBit ) ? 1 : 0; }
+	static jo_id_t denseIndex( jo_id_t id ) { return id & ~NewIDBit; }
+
+	//! The objects by ID, nullptr if an ID is unused. Only the IDs beyond the
+	//! ends of the halves of the dense table are in m_sparseIDs.
+	std::vector<JournallingObject*> m_denseIDs[2];
+	JoIdMap m_sparseIDs;
+	//! Where the search for a free new ID starts
+	jo_id_t m_nextID;
 
 	CheckPointStack m_undoCheckPoints;
 	CheckPointStack m_redoCheckPoints;
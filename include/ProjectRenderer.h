@@ -25,6 +25,9 @@
 #ifndef LMMS_PROJECT_RENDERER_H
 #define LMMS_PROJECT_RENDERER_H
 
+#include <memory>
+#include <vector>
+
 #include "AudioFileDevice.h"
 #include "lmmsconfig.h"
 #include "AudioEngine.h"
@@ -46,6 +49,7 @@ public:
 		Flac,
 		Ogg,
 		MP3,
+		Raw,
 		Count
 	} ;
 	constexpr static auto NumFileFormats = static_cast<std::size_t>(ExportFileFormat::Count);
@@ -72,12 +76,30 @@ public:
 		return m_fileDev != nullptr;
 	}
 
+	//! Don't render faster than the song plays, for outputs streamed to
+	//! something that consumes them in realtime
+	void setRealtime( bool realtime )
+	{
+		m_realtime = realtime;
+	}
+
+	//! Write a loudness and peak report next to the output file, see
+	//! AudioFileDevice::writeLoudnessReport()
+	void setLoudnessReport( bool report )
+	{
+		m_loudnessReport = report;
+	}
+
+	//! Encodes the same render to @p _out_file in another format as well,
+	//! call before startProcessing()
+	bool addOutput( ExportFileFormat _file_format, const QString & _out_file );
+
 	static ExportFileFormat getFileFormatFromExtension(
 							const QString & _ext );
 
 	static QString getFileExtensionFromFormat( ExportFileFormat fmt );
 
-	static const std::array<FileEncodeDevice, 5> fileEncodeDevices;
+	static const std::array<FileEncodeDevice, 6> fileEncodeDevices;
 
 public slots:
 	void startProcessing();
@@ -95,10 +117,20 @@ private:
 
 	AudioFileDevice * m_fileDev;
 	AudioEngine::qualitySettings m_qualitySettings;
+	OutputSettings m_outputSettings;
+	//! The outputs added with addOutput(), m_fileDev hands them its frames
+	std::vector<std::unique_ptr<AudioFileDevice>> m_copies;
 
 	volatile int m_progress;
 	volatile bool m_abort;
 
+	// render the next periods in the audio engine's FIFO thread while this
+	// thread encodes and writes the previous ones
+	bool m_renderAhead;
+
+	bool m_realtime;
+	bool m_loudnessReport;
+
 } ;
 
 
@@ -0,0 +1,122 @@
+/*
+ * QualityGovernor.h - trades quality for time when the CPU can't keep up
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef LMMS_QUALITY_GOVERNOR_H
+#define LMMS_QUALITY_GOVERNOR_H
+
+#include <algorithm>
+#include <atomic>
+
+#include <QObject>
+#include <QTimer>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+/**
+ * Lowers the quality of what costs the most, one step at a time, while the
+ * CPU load stays near 100%, so that a live set loses fidelity instead of
+ * dropping out. It goes back up a step once the load stayed well below that
+ * for a while, the step lowered last first. Every change is logged.
+ *
+ * It's opted into with the "qualitygovernor" setting and leaves exports
+ * alone. The audio threads only read which steps are lowered, the changes
+ * are made from the thread the engine lives in.
+ */
+class LMMS_EXPORT QualityGovernor : public QObject
+{
+	Q_OBJECT
+public:
+	//! In the order they're lowered
+	enum class Step
+	{
+		AnalyserUpdates,	//!< analysers don't overlap their windows
+		SampleInterpolation,	//!< new sample notes interpolate cubically instead of with a sinc
+		EffectOversampling,	//!< effects oversample twice at most
+		RemotePipelining,	//!< remote plugins run alongside LMMS, a period late
+		VoiceLimit,		//!< half as many notes play at once
+		Count
+	} ;
+
+	explicit QualityGovernor( QObject * parent = nullptr );
+	~QualityGovernor() override;
+
+	void setEnabled( bool enabled );
+
+	bool isEnabled() const
+	{
+		return m_timer.isActive();
+	}
+
+	//! How many steps are lowered
+	int level() const
+	{
+		return m_level.load( std::memory_order_relaxed );
+	}
+
+	bool isLowered( Step step ) const
+	{
+		return level() > static_cast<int>( step );
+	}
+
+	//! The interpolation a sample note that asks for @p mode is to be played with
+	int sampleInterpolation( int mode ) const;
+
+	//! The oversampling stages an effect that asks for @p stages may use
+	int oversamplingStages( int stages ) const
+	{
+		return isLowered( Step::EffectOversampling ) ? std::min( stages, 1 ) : stages;
+	}
+
+	//! The window overlaps an analyser that asks for @p overlaps may use
+	int analyserOverlaps( int overlaps ) const
+	{
+		return isLowered( Step::AnalyserUpdates ) ? 1 : overlaps;
+	}
+
+	bool pipelineRemotePlugins() const
+	{
+		return isLowered( Step::RemotePipelining );
+	}
+
+private:
+	void poll();
+	void lower( int cpuLoad );
+	void raise( int cpuLoad );
+	//! Restores every step
+	void reset();
+	void apply( Step step, bool lowered );
+
+	QTimer m_timer;
+	std::atomic_int m_level{0};
+	int m_highPolls = 0;
+	int m_lowPolls = 0;
+} ;
+
+} // namespace lmms
+
+#endif // LMMS_QUALITY_GOVERNOR_H
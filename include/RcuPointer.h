@@ -0,0 +1,96 @@
+/*
+ * RcuPointer.h - state the audio threads read without locking while it's replaced
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_RCU_POINTER_H
+#define LMMS_RCU_POINTER_H
+
+#include <atomic>
+#include <memory>
+
+#include "lmms_export.h"
+
+namespace lmms
+{
+
+class LMMS_EXPORT RcuPointerBase
+{
+protected:
+	//! Waits until no audio thread can still use what was published before,
+	//! see AudioEngine::waitForGracePeriod()
+	static void synchronize();
+} ;
+
+
+/*! Read-copy-update for what the audio threads render from: instead of
+ *  changing it in place under AudioEngine::requestChangeInModel(), which keeps
+ *  the whole period from rendering, a changed copy is prepared and published
+ *  with a pointer swap. The audio threads pick it up in the next period, the
+ *  old one is freed once the period that may still use it is over.
+ *
+ *  There's a single writer, usually the GUI thread, which also may read it
+ *  any time. The audio threads must get() it once per period and not keep it.
+ */
+template<typename T>
+class RcuPointer : private RcuPointerBase
+{
+public:
+	RcuPointer( std::unique_ptr<T> initial = std::make_unique<T>() ) :
+		m_current( initial.release() )
+	{
+	}
+
+	//! Nothing may render from it anymore
+	~RcuPointer()
+	{
+		delete m_current.load();
+	}
+
+	RcuPointer( const RcuPointer & ) = delete;
+	RcuPointer & operator=( const RcuPointer & ) = delete;
+
+	T * get() const
+	{
+		return m_current.load( std::memory_order_acquire );
+	}
+
+	T * operator->() const
+	{
+		return get();
+	}
+
+	//! Makes @p next what is read from now on, returns once the one before
+	//! is freed - which takes until the end of the period being rendered
+	void publish( std::unique_ptr<T> next )
+	{
+		const auto old = std::unique_ptr<T>{ m_current.exchange( next.release() ) };
+		synchronize();
+	}
+
+private:
+	std::atomic<T *> m_current;
+} ;
+
+} // namespace lmms
+
+#endif // LMMS_RCU_POINTER_H
@@ -0,0 +1,80 @@
+/*
+ * RealtimeChecker.h - reports what the audio threads shouldn't do
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_REALTIME_CHECKER_H
+#define LMMS_REALTIME_CHECKER_H
+
+#include "lmms_export.h"
+#include "lmmsconfig.h"
+
+namespace lmms
+{
+
+/*! In builds configured with WANT_DEBUG_REALTIME, finds what can block the
+ *  audio threads while they render a period: heap allocations through
+ *  operator new and the MemoryManager, locking a pthread mutex (which
+ *  std::mutex does, and QMutex when it has to wait, as a futex call) and the
+ *  common blocking system calls.
+ *
+ *  The first time such a call comes from a call site, it is logged with a
+ *  backtrace. report() lists how often each call site was hit in the end.
+ *  Everything else compiles to nothing.
+ */
+class LMMS_EXPORT RealtimeChecker
+{
+public:
+#ifdef LMMS_DEBUG_REALTIME
+	//! Marks the calling thread as rendering audio from construction to destruction
+	class LMMS_EXPORT Scope
+	{
+	public:
+		Scope();
+		~Scope();
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	//! Records a call of @p what, which must be a string literal, if the
+	//! calling thread is rendering audio
+	static void check(const char* what);
+
+	//! Writes every call site found so far and how often it was hit to stderr
+	static void report();
+#else
+	class Scope
+	{
+	public:
+		Scope() {}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	static void check(const char*) {}
+	static void report() {}
+#endif
+};
+
+} // namespace lmms
+
+#endif // LMMS_REALTIME_CHECKER_H
@@ -25,6 +25,8 @@
 #ifndef LMMS_REMOTE_PLUGIN_H
 #define LMMS_REMOTE_PLUGIN_H
 
+#include <memory>
+
 #include "RemotePluginBase.h"
 #include "SharedMemory.h"
 
@@ -77,12 +79,22 @@ public:
 #ifdef DEBUG_REMOTE_PLUGIN
 		return true;
 #else
+		if( m_host )
+		{
+			return m_host->isRunning();
+		}
 		return m_process.state() != QProcess::NotRunning;
 #endif // DEBUG_REMOTE_PLUGIN
 	}
 
 	bool init( const QString &pluginExecutable, bool waitForInitDoneMsg, QStringList extraArgs = {} );
 
+#ifndef SYNC_WITH_SHM_FIFO
+	//! Like init(), but instead of starting a process of its own asks the one
+	//! of @p host, which has to host several clients, to connect another one
+	bool attach( const std::shared_ptr<RemotePlugin> & host, bool waitForInitDoneMsg );
+#endif
+
 	inline void waitForHostInfoGotten()
 	{
 		m_failed = waitForMessage( IdHostInfoGotten ).id
@@ -96,8 +108,30 @@ public:
 
 	bool processMessage( const message & _m ) override;
 
+	//! Processes a period. In the pipelined mode the client processes it
+	//! while the host goes on, and @p _out_buf gets the period before.
 	bool process( const sampleFrame * _in_buf, sampleFrame * _out_buf );
 
+	//! Frames process() delays the output by: a period in the pipelined mode,
+	//! which is opted into with the "pipelinedremoteplugins" setting and needs
+	//! the client to signal through shared memory
+	f_cnt_t latency() const;
+
+	//! Makes process() give up on the client after @p periods, one by default:
+	//! it outputs silence then, and the periods after too, until the client
+	//! is done with the one it overran. Needs the client to signal through
+	//! shared memory, otherwise process() waits for as long as it takes.
+	void setDeadline( float periods )
+	{
+		m_deadline = periods;
+	}
+
+	//! Periods the client overran its deadline in so far
+	int overruns() const
+	{
+		return m_overruns;
+	}
+
 	void processMidiEvent( const MidiEvent&, const f_cnt_t _offset );
 
 	void updateSampleRate( sample_rate_t _sr )
@@ -150,14 +184,36 @@ protected:
 		m_splitChannels = _on;
 	}
 
+	//! Called with the lock held right before the client is handed a period
+	//! it is waited for with, which it hasn't started on, and the one before
+	//! is done - what is written to shared memory now goes with the period
+	virtual void prepareProcessing()
+	{
+	}
+
 
 	bool m_failed;
 private:
+	void startCommunication( bool waitForInitDoneMsg );
 	void resizeSharedProcessingMemory();
+	void writeInput( const sampleFrame * _in_buf, const fpp_t frames );
+	void readOutput( sampleFrame * _out_buf, const fpp_t frames );
+	bool isProcessingInSync() const;
+	//! Set so, or made so by the quality governor under load
+	bool isPipelined() const;
+#ifdef LMMS_BUILD_LINUX
+	void createProcessingSync();
+	//! Whether the client finished the last request before the deadline
+	bool waitForProcessingSync();
+	bool isProcessingSyncDone() const;
+	void fetchMessagesSentWhileProcessing();
+#endif
 
 
 	QProcess m_process;
 	ProcessWatcher m_watcher;
+	// the plugin whose process we're a client of, if we didn't start our own
+	std::shared_ptr<RemotePlugin> m_host;
 
 	QString m_exec;
 	QStringList m_args;
@@ -171,6 +227,17 @@ private:
 
 	SharedMemory<float[]> m_audioBuffer;
 	std::size_t m_audioBufferSize;
+#ifdef LMMS_BUILD_LINUX
+	SharedMemory<RemoteProcessingSync> m_processingSync;
+	int32_t m_processingRequests = 0;
+	// whether the client is still busy with a request it overran
+	bool m_overrun = false;
+#endif
+	float m_deadline = 1.0f;
+	int m_overruns = 0;
+	bool m_pipelined = false;
+	// whether the client is processing a period we didn't collect yet
+	bool m_pendingRequest = false;
 
 	int m_inputCount;
 	int m_outputCount;
@@ -87,6 +87,13 @@
 #include "SharedMemory.h"
 #endif
 
+#ifdef LMMS_BUILD_LINUX
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace lmms
 {
 
@@ -219,17 +226,14 @@ public:
 
 	inline std::string readString()
 	{
+		// strings may hold binary data, like parameter dumps
 		const int len = readInt();
+		auto s = std::string( len, '\0' );
 		if( len )
 		{
-			char * sc = new char[len + 1];
-			read( sc, len );
-			sc[len] = 0;
-			std::string s( sc );
-			delete[] sc;
-			return s;
+			read( &s[0], len );
 		}
-		return std::string();
+		return s;
 	}
 
 
@@ -345,6 +349,56 @@ private:
 
 
 
+#ifdef LMMS_BUILD_LINUX
+/**
+ * Shared memory through which the remote process tells the host it processed
+ * a period, so the host needn't wait for an IdProcessingDone message: the host
+ * counts its requests in here before sending IdStartProcessing, spins for a
+ * moment and then sleeps on a futex, and the client sets done to the request
+ * and wakes the host if it sleeps. The requests still go through the socket
+ * so they stay in order with the MIDI events and everything else.
+ */
+struct RemoteProcessingSync
+{
+	int32_t clientReady; // the client attached and signals through this
+	int32_t requested; // the last request the host made through this
+	int32_t done; // the last request the client finished
+	int32_t hostWaiting; // whether the host sleeps on done
+	int32_t clientMessages; // messages the client sent before it finished
+
+	// neither std::atomic nor std::atomic_ref (C++20) can be used here, as
+	// everything in shared memory must be trivial
+	static int32_t load( const int32_t & value )
+	{
+		return __atomic_load_n( &value, __ATOMIC_SEQ_CST );
+	}
+
+	static void store( int32_t & value, int32_t newValue )
+	{
+		__atomic_store_n( &value, newValue, __ATOMIC_SEQ_CST );
+	}
+
+	static int32_t exchange( int32_t & value, int32_t newValue )
+	{
+		return __atomic_exchange_n( &value, newValue, __ATOMIC_SEQ_CST );
+	}
+
+	//! Sleeps while @p value is @p expected, for @p microseconds (less than a second) at most
+	static void wait( int32_t & value, int32_t expected, long microseconds )
+	{
+		timespec timeout = { 0, microseconds * 1000L };
+		syscall( SYS_futex, &value, FUTEX_WAIT, expected, &timeout, nullptr, 0 );
+	}
+
+	static void wake( int32_t & value )
+	{
+		syscall( SYS_futex, &value, FUTEX_WAKE, 1, nullptr, nullptr, 0 );
+	}
+} ;
+#endif // LMMS_BUILD_LINUX
+
+
+
 enum RemoteMessageIDs
 {
 	IdUndefined,
@@ -374,6 +428,9 @@ enum RemoteMessageIDs
 	IdLoadPresetFile,
 	IdDebugMessage,
 	IdIdle,
+	IdChangeProcessingSyncKey,
+	// a process hosting several clients connects another one to the socket
+	IdAttachClient,
 	IdUserBase = 64
 } ;
 
@@ -488,6 +545,24 @@ public:
 	message waitForMessage( const message & _m,
 						bool _busy_waiting = false );
 
+	//! How many messages were sent and received since the counts were
+	//! reset, so one side can tell whether it has everything the other sent
+	int32_t sentMessages() const
+	{
+		return m_sentMessages;
+	}
+
+	int32_t receivedMessages() const
+	{
+		return m_receivedMessages;
+	}
+
+	void resetMessageCounts()
+	{
+		m_sentMessages = 0;
+		m_receivedMessages = 0;
+	}
+
 	inline message fetchAndProcessNextMessage()
 	{
 		message m = receiveMessage();
@@ -510,17 +585,14 @@ public:
 
 	inline std::string readString()
 	{
+		// strings may hold binary data, like parameter dumps
 		const int len = readInt();
+		auto s = std::string( len, '\0' );
 		if( len )
 		{
-			char * sc = new char[len + 1];
-			read( sc, len );
-			sc[len] = 0;
-			std::string s( sc );
-			delete[] sc;
-			return s;
+			read( &s[0], len );
 		}
-		return std::string();
+		return s;
 	}
 
 
@@ -598,6 +670,9 @@ protected:
 
 
 private:
+	std::atomic<int32_t> m_sentMessages = 0;
+	std::atomic<int32_t> m_receivedMessages = 0;
+
 #ifndef BUILD_REMOTE_PLUGIN_CLIENT
 	static int & waitDepthCounter()
 	{
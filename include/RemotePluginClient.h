@@ -123,9 +123,14 @@ public:
 private:
 	void setShmKey(const std::string& key);
 	void doProcessing();
+	bool finishProcessingInSync();
 
 	SharedMemory<float[]> m_audioBuffer;
 	SharedMemory<const VstSyncData> m_vstSyncData;
+#ifdef LMMS_BUILD_LINUX
+	SharedMemory<RemoteProcessingSync> m_processingSync;
+	int32_t m_lastRequest = 0;
+#endif
 
 	int m_inputCount;
 	int m_outputCount;
@@ -293,14 +298,33 @@ bool RemotePluginClient::processMessage( const message & _m )
 
 		case IdStartProcessing:
 			doProcessing();
-			reply_message.id = IdProcessingDone;
-			reply = true;
+			if( !finishProcessingInSync() )
+			{
+				reply_message.id = IdProcessingDone;
+				reply = true;
+			}
 			break;
 
 		case IdChangeSharedMemoryKey:
 			setShmKey(_m.getString(0));
 			break;
 
+#ifdef LMMS_BUILD_LINUX
+		case IdChangeProcessingSyncKey:
+			try
+			{
+				m_processingSync.attach(_m.getString(0));
+				m_lastRequest = RemoteProcessingSync::load( m_processingSync->requested );
+				RemoteProcessingSync::store( m_processingSync->clientReady, 1 );
+			}
+			catch (const std::runtime_error& error)
+			{
+				// the host keeps waiting for IdProcessingDone then
+				debugMessage(std::string{"Failed to attach processing sync: "} + error.what() + '\n');
+			}
+			break;
+#endif
+
 		case IdInitDone:
 			break;
 
@@ -353,6 +377,38 @@ void RemotePluginClient::doProcessing()
 }
 
 
+
+
+// tells the host about the period through the shared memory if it asked us
+// through it, returns false if it waits for IdProcessingDone instead
+bool RemotePluginClient::finishProcessingInSync()
+{
+#ifdef LMMS_BUILD_LINUX
+	if (!m_processingSync)
+	{
+		return false;
+	}
+	auto& sync = *m_processingSync;
+	const int32_t request = RemoteProcessingSync::load( sync.requested );
+	if( request == m_lastRequest )
+	{
+		return false;
+	}
+	m_lastRequest = request;
+
+	RemoteProcessingSync::store( sync.clientMessages, sentMessages() );
+	RemoteProcessingSync::store( sync.done, request );
+	if( RemoteProcessingSync::exchange( sync.hostWaiting, 0 ) != 0 )
+	{
+		RemoteProcessingSync::wake( sync.done );
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+
 } // namespace lmms
 
 #endif // LMMS_REMOTE_PLUGIN_CLIENT_H
@@ -0,0 +1,107 @@
+/*
+ * RenderCache.h - keeps synthesised sounds that only depend on their parameters
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_RENDER_CACHE_H
+#define LMMS_RENDER_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include <QString>
+
+#include "lmms_export.h"
+
+namespace lmms {
+class SampleBuffer;
+
+/**
+ * Keeps what the deterministic generators rendered, like DrumSynth files and
+ * the one-shots of Kicker and sfxr, so the same sound doesn't have to be
+ * synthesised again for every note or preview. Unlike the SampleCache, the
+ * buffers stay cached while nothing uses them, the least recently used ones
+ * are dropped once they take up more than MaxBytes.
+ *
+ * Safe to use from the audio threads, the lock is only held for the lookup.
+ */
+class LMMS_EXPORT RenderCache
+{
+public:
+	static constexpr std::size_t MaxBytes = std::size_t{64} << 20;
+
+	//! A 64 bit hash of everything a sound depends on, including the sample
+	//! rate if it does. Different sounds with the same hash are too unlikely to
+	//! be worth comparing all parameters.
+	class Key
+	{
+	public:
+		//! @p kind tells apart the generators, e.g. the name of a plugin
+		explicit Key(const char* kind)
+		{
+			while (*kind) { addByte(static_cast<std::uint8_t>(*kind++)); }
+		}
+
+		template<typename T>
+		auto operator<<(const T& value) -> Key&
+		{
+			static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "only hash plain values");
+			const auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+			for (std::size_t i = 0; i < sizeof(T); ++i) { addByte(bytes[i]); }
+			return *this;
+		}
+
+		auto operator<<(const QString& text) -> Key&
+		{
+			for (const auto c : text) { *this << c.unicode(); }
+			return *this << text.size();
+		}
+
+		auto hash() const -> std::uint64_t { return m_hash; }
+
+	private:
+		// FNV-1a
+		void addByte(std::uint8_t byte)
+		{
+			m_hash = (m_hash ^ byte) * 0x100000001b3;
+		}
+
+		std::uint64_t m_hash = 0xcbf29ce484222325;
+	};
+
+	//! The sound rendered for @p key before, or nullptr
+	static auto get(const Key& key) -> std::shared_ptr<const SampleBuffer>;
+
+	//! Keeps @p buffer as what was rendered for @p key
+	static void put(const Key& key, std::shared_ptr<const SampleBuffer> buffer);
+
+	//! How much memory the cached sounds take up
+	static auto bytes() -> std::size_t;
+
+	static void clear();
+};
+
+} // namespace lmms
+
+#endif // LMMS_RENDER_CACHE_H
@@ -27,6 +27,7 @@
 #define LMMS_RENDER_MANAGER_H
 
 #include <memory>
+#include <vector>
 
 #include "ProjectRenderer.h"
 #include "OutputSettings.h"
@@ -35,6 +36,7 @@
 namespace lmms
 {
 
+class AudioPort;
 
 class RenderManager : public QObject
 {
@@ -51,22 +53,42 @@ public:
 	/// Export all unmuted tracks into a single file
 	void renderProject();
 
-	/// Export all unmuted tracks into individual file
+	/// Export all unmuted tracks into individual files in one pass, along
+	/// with the master output
 	void renderTracks();
 
 	void abortProcessing();
 
+	/// Encode the song into @p fmt as well, in the same render pass. The file
+	/// is named like the output file, but with the extension of @p fmt.
+	void addFormat(ProjectRenderer::ExportFileFormat fmt);
+
+	/// Render no faster than the song plays, see ProjectRenderer::setRealtime()
+	void setRealtime(bool realtime) { m_realtime = realtime; }
+
+	/// Write a loudness and peak report next to every file, stems included.
+	/// Call before rendering.
+	void setLoudnessReport(bool report) { m_loudnessReport = report; }
+
 signals:
 	void progressChanged( int );
 	void finished();
 
 private slots:
-	void renderNextTrack();
+	void renderFinished();
 	void updateConsoleProgress();
 
 private:
+	//! A track's audio port while it is written to its own file
+	struct Stem
+	{
+		AudioPort* port;
+		std::unique_ptr<AudioFileDevice> file;
+	};
+
 	QString pathForTrack( const Track *track, int num );
-	void restoreMutedState();
+	//! Stops writing to the stem files, and deletes them if the export was aborted
+	void finishStems(bool remove);
 
 	void render( QString outputPath );
 
@@ -76,10 +98,13 @@ private:
 	ProjectRenderer::ExportFileFormat m_format;
 	QString m_outputPath;
 
+	std::vector<ProjectRenderer::ExportFileFormat> m_copyFormats;
+	bool m_realtime = false;
+	bool m_loudnessReport = false;
+
 	std::unique_ptr<ProjectRenderer> m_activeRenderer;
 
-	std::vector<Track*> m_tracksToRender;
-	std::vector<Track*> m_unmuted;
+	std::vector<Stem> m_stems;
 } ;
 
 
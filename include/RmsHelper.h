@@ -87,6 +87,24 @@ public:
 		return sqrtf( m_sum * m_sizef );
 	}
 
+	//! update() for each of the @p count samples of @p in, writes the RMS
+	//! after each one to @p out
+	inline void update( const float * in, float * out, int count )
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			m_sum -= m_buffer[ m_pos ];
+			m_sum += m_buffer[ m_pos ] = in[i] * in[i];
+			if( ++m_pos == m_size ) { m_pos = 0; }
+			out[i] = m_sum * m_sizef;
+		}
+		// in a loop of its own, which the compiler can vectorise
+		for( int i = 0; i < count; ++i )
+		{
+			out[i] = sqrtf( out[i] );
+		}
+	}
+
 private:
 	float * m_buffer;
 	float m_sum;
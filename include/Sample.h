@@ -31,6 +31,7 @@
 #include "AudioResampler.h"
 #include "Note.h"
 #include "SampleBuffer.h"
+#include "SampleStream.h"
 #include "lmms_export.h"
 
 class QPainter;
@@ -44,7 +45,8 @@ public:
 	// the array positions correspond to the converter_type parameter values in libsamplerate
 	// if there appears problems with playback on some interpolation mode, then the value for that mode
 	// may need to be higher - conversely, to optimize, some may work with lower values
-	static constexpr auto s_interpolationMargins = std::array<int, 5>{64, 64, 64, 4, 4};
+	// the last two are for AudioResampler's built-in modes
+	static constexpr auto s_interpolationMargins = std::array<int, 7>{64, 64, 64, 4, 4, 4, 16};
 
 	enum class Loop
 	{
@@ -68,6 +70,15 @@ public:
 		auto backwards() const -> bool { return m_backwards; }
 
 		void setFrameIndex(f_cnt_t frameIndex) { m_frameIndex = frameIndex; }
+		//! Back to how it was constructed, keeping the resampler's memory
+		void reset()
+		{
+			m_resampler.reset();
+			m_frameIndex = 0;
+			m_backwards = false;
+			m_resampledFrameIndex = -1;
+			m_resampledFrom = -1;
+		}
 		void setVaryingPitch(bool varyingPitch) { m_varyingPitch = varyingPitch; }
 		void setBackwards(bool backwards) { m_backwards = backwards; }
 
@@ -76,6 +87,9 @@ public:
 		f_cnt_t m_frameIndex = 0;
 		bool m_varyingPitch = false;
 		bool m_backwards = false;
+		// where playback of a resampled buffer stopped, and what m_frameIndex was set to then
+		f_cnt_t m_resampledFrameIndex = -1;
+		f_cnt_t m_resampledFrom = -1;
 		friend class Sample;
 	};
 
@@ -86,6 +100,7 @@ public:
 	Sample(Sample&& other);
 	explicit Sample(const QString& audioFile);
 	explicit Sample(std::shared_ptr<const SampleBuffer> buffer);
+	explicit Sample(std::shared_ptr<SampleStream> stream);
 
 	auto operator=(const Sample&) -> Sample&;
 	auto operator=(Sample&&) -> Sample&;
@@ -94,9 +109,18 @@ public:
 		Loop loopMode = Loop::Off) -> bool;
 
 	auto sampleDuration() const -> std::chrono::milliseconds;
-	auto sampleFile() const -> const QString& { return m_buffer->audioFile(); }
+	auto sampleFile() const -> const QString& { return m_stream ? m_stream->audioFile() : m_buffer->audioFile(); }
 	auto sampleRate() const -> int { return m_buffer->sampleRate(); }
-	auto sampleSize() const -> size_t { return m_buffer->size(); }
+	auto sampleSize() const -> size_t { return m_stream ? m_stream->size() : m_buffer->size(); }
+
+	//! Whether the sample is played from disk, then data() and buffer() only hold its first seconds
+	auto isStreamed() const -> bool { return m_stream != nullptr; }
+
+	//! The frames to draw the sample from, fewer than sampleSize() if it's streamed
+	auto waveform() const -> const SampleBuffer& { return m_stream ? m_stream->overview() : *m_buffer; }
+
+	//! Lets a streamed sample get ready to play from @p frame on
+	void prefetch(f_cnt_t frame);
 
 	auto toBase64() const -> QString { return m_buffer->toBase64(); }
 
@@ -120,6 +144,7 @@ public:
 	void setReversed(bool reversed) { m_reversed.store(reversed, std::memory_order_relaxed); }
 
 private:
+	auto playResampled(sampleFrame* dst, PlaybackState* state, int numFrames, const SampleBuffer& resampled) -> bool;
 	void playSampleRange(PlaybackState* state, sampleFrame* dst, size_t numFrames) const;
 	void amplifySampleRange(sampleFrame* src, int numFrames) const;
 	void copyBufferForward(sampleFrame* dst, int initialPosition, int advanceAmount) const;
@@ -127,6 +152,7 @@ private:
 
 private:
 	std::shared_ptr<const SampleBuffer> m_buffer = SampleBuffer::emptyBuffer();
+	std::shared_ptr<SampleStream> m_stream;
 	std::atomic<int> m_startFrame = 0;
 	std::atomic<int> m_endFrame = 0;
 	std::atomic<int> m_loopStartFrame = 0;
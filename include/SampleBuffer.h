@@ -27,7 +27,9 @@
 
 #include <QByteArray>
 #include <QString>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <samplerate.h>
 #include <vector>
@@ -38,6 +40,8 @@
 #include "lmms_export.h"
 
 namespace lmms {
+class SamplePeaks;
+
 class LMMS_EXPORT SampleBuffer
 {
 public:
@@ -54,11 +58,17 @@ public:
 	SampleBuffer() = default;
 	explicit SampleBuffer(const QString& audioFile);
 	SampleBuffer(const QString& base64, int sampleRate);
-	SampleBuffer(std::vector<sampleFrame> data, int sampleRate);
+	SampleBuffer(std::vector<sampleFrame> data, int sampleRate, const QString& audioFile = QString{});
 	SampleBuffer(
 		const sampleFrame* data, int numFrames, int sampleRate = Engine::audioEngine()->processingSampleRate());
+	SampleBuffer(SampleBuffer&& other) noexcept;
+	~SampleBuffer();
+
+	auto operator=(SampleBuffer&& other) noexcept -> SampleBuffer&;
 
 	friend void swap(SampleBuffer& first, SampleBuffer& second) noexcept;
+	//! The frames as Base64 for embedding them in a project. They are only encoded for the first
+	//! save or undo checkpoint, so don't change them after calling it.
 	auto toBase64() const -> QString;
 
 	auto audioFile() const -> const QString& { return m_audioFile; }
@@ -86,12 +96,46 @@ public:
 	auto size() const -> size_type { return m_data.size(); }
 	auto empty() const -> bool { return m_data.empty(); }
 
+	//! The same frames at @p sampleRate if resampleTo() made them already, so they can
+	//! be played without converting them on the fly. Safe to call from the audio thread.
+	auto resampled(sample_rate_t sampleRate) const -> const SampleBuffer*
+	{
+		const auto resampled = m_resampled->current.load(std::memory_order_acquire);
+		return resampled && resampled->sampleRate() == sampleRate ? resampled : nullptr;
+	}
+
+	//! Converts the frames to @p sampleRate for resampled(), which takes a while
+	void resampleTo(sample_rate_t sampleRate) const;
+
+	//! A summary of the frames to draw them from. It is made in the background after the first
+	//! call, which returns nullptr until then, as do short buffers. Only for the GUI thread.
+	auto peaks() const -> const SamplePeaks*;
+
 	static auto emptyBuffer() -> std::shared_ptr<const SampleBuffer>;
 
 private:
+	struct PeakState;
+	class PeakTask;
+
+	struct Resampled
+	{
+		std::atomic<const SampleBuffer*> current = nullptr;
+		//! Every version made, the audio thread may still play one that isn't current anymore
+		std::vector<std::unique_ptr<const SampleBuffer>> versions;
+		std::mutex mutex;
+	};
+
 	std::vector<sampleFrame> m_data;
 	QString m_audioFile;
 	sample_rate_t m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	std::unique_ptr<Resampled> m_resampled = std::make_unique<Resampled>();
+	struct Base64
+	{
+		QByteArray text;
+		std::mutex mutex;
+	};
+	std::unique_ptr<Base64> m_base64 = std::make_unique<Base64>();
+	mutable std::shared_ptr<PeakState> m_peaks;
 };
 
 } // namespace lmms
@@ -0,0 +1,140 @@
+/*
+ * SampleCache.h - shares the sample buffers decoded from the same file
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SAMPLE_CACHE_H
+#define LMMS_SAMPLE_CACHE_H
+
+#include <QRunnable>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lmms_export.h"
+
+namespace lmms {
+class SampleBuffer;
+
+/**
+ * Hands out the same decoded buffer to everything that loads the same file,
+ * as long as the file didn't change in between. The cache only holds weak
+ * references, so a buffer is freed as soon as nothing uses it anymore.
+ *
+ * Compressed files are also kept decoded in PathUtil::cacheDir(), so loading
+ * them again, even in a later session, only has to read the frames back.
+ */
+class LMMS_EXPORT SampleCache
+{
+public:
+	//! Returns the decoded @p audioFile, throws like SampleBuffer's constructor if it can't be loaded
+	static auto get(const QString& audioFile) -> std::shared_ptr<const SampleBuffer>;
+
+	//! The number of files that are decoded and in use right now
+	static auto size() -> std::size_t;
+
+	//! The frames of the Base64 @p data of a project's element if a Preload is decoding that very
+	//! attribute, waiting for it if needed. Returns nullptr if none is, or the data is broken.
+	static auto getEmbedded(const QString& data, int sampleRate) -> std::shared_ptr<const SampleBuffer>;
+
+	/**
+	 * Decodes files on a thread pool before anything asks for them, like the
+	 * samples of a project that is being loaded. get() returns what was decoded
+	 * already, or waits for a file that is being decoded. The buffers stay
+	 * cached until the Preload is destroyed, which waits for the decoding that
+	 * has started and cancels the rest.
+	 *
+	 * Samples embedded in the project are decoded the same way for getEmbedded().
+	 */
+	class LMMS_EXPORT Preload
+	{
+	public:
+		struct Embedded
+		{
+			//! The attribute with the frames, as the element will return it
+			QString data;
+			int sampleRate;
+		};
+
+		explicit Preload(const QStringList& audioFiles, const std::vector<Embedded>& embedded = {});
+		~Preload();
+
+		Preload(const Preload&) = delete;
+		auto operator=(const Preload&) -> Preload& = delete;
+
+	private:
+		class Task : public QRunnable
+		{
+		public:
+			Task(Preload* preload, const QString& audioFile)
+				: m_preload(preload)
+				, m_audioFile(audioFile)
+			{
+			}
+
+			void run() override;
+
+		private:
+			Preload* m_preload;
+			QString m_audioFile;
+		};
+
+		struct EmbeddedEntry
+		{
+			Embedded embedded;
+			std::shared_ptr<const SampleBuffer> buffer;
+			bool decoding = false;
+			bool decoded = false;
+		};
+
+		class EmbeddedTask : public QRunnable
+		{
+		public:
+			EmbeddedTask(EmbeddedEntry* entry)
+				: m_entry(entry)
+			{
+			}
+
+			void run() override;
+
+		private:
+			EmbeddedEntry* m_entry;
+		};
+
+		//! Decodes @p entry unless someone else does, must be called with s_embeddedMutex locked
+		static void decode(EmbeddedEntry& entry, std::unique_lock<std::mutex>& lock);
+
+		QThreadPool m_pool;
+		std::mutex m_mutex;
+		std::vector<std::shared_ptr<const SampleBuffer>> m_buffers;
+		std::vector<EmbeddedEntry> m_embedded;
+
+		friend class SampleCache;
+	};
+};
+
+} // namespace lmms
+
+#endif // LMMS_SAMPLE_CACHE_H
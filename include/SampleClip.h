@@ -25,6 +25,8 @@
 #ifndef LMMS_SAMPLE_CLIP_H
 #define LMMS_SAMPLE_CLIP_H
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include "Clip.h"
 #include "Sample.h"
@@ -33,6 +35,7 @@ namespace lmms
 {
 
 class SampleBuffer;
+class SamplePlayHandle;
 
 namespace gui
 {
@@ -79,6 +82,23 @@ public:
 	void setIsPlaying(bool isPlaying);
 	void setSampleBuffer(std::shared_ptr<const SampleBuffer> sb);
 
+	//! A state to play the sample with from its start. It's one of a few kept
+	//! for this clip if there's one left, so seeking and looping rarely have
+	//! to set up a resampler.
+	Sample::PlaybackState* acquirePlaybackState();
+	//! Takes back what acquirePlaybackState() gave, safe on the audio threads
+	void releasePlaybackState(Sample::PlaybackState* state);
+
+	//! Keeps @p handle, made for this clip and not playing yet, for when the
+	//! clip starts playing next, deletes the one kept before
+	void armPlayHandle(SamplePlayHandle* handle);
+	//! The handle armed with armPlayHandle(), if any, which the caller owns now
+	SamplePlayHandle* takeArmedPlayHandle();
+	bool hasArmedPlayHandle() const
+	{
+		return m_armedPlayHandle.load(std::memory_order_relaxed) != nullptr;
+	}
+
 public slots:
 	void setSampleFile(const QString& sf);
 	void updateLength();
@@ -92,6 +112,12 @@ private:
 	BoolModel m_recordModel;
 	bool m_isPlaying;
 
+	// a state for a handle still playing from before a jump or a loop
+	// restart, and one for the handle that plays from the new position
+	static constexpr std::size_t PooledPlaybackStates = 2;
+	std::array<std::atomic<Sample::PlaybackState*>, PooledPlaybackStates> m_playbackStates = {};
+	std::atomic<SamplePlayHandle*> m_armedPlayHandle = nullptr;
+
 	friend class gui::SampleClipView;
 
 
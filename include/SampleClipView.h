@@ -64,6 +64,8 @@ protected:
 private:
 	SampleClip * m_clip;
 	QPixmap m_paintPixmap;
+	//! The part of the view the waveform in m_paintPixmap was drawn for
+	QRect m_paintedRect;
 	bool splitClip( const TimePos pos ) override;
 } ;
 
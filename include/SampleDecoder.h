@@ -50,6 +50,9 @@ public:
 	};
 
 	static auto decode(const QString& audioFile) -> std::optional<Result>;
+	//! Decodes at most the first @p seconds of @p audioFile, quickly enough to wait for it. Only files
+	//! libsndfile can seek in are decoded like this, others need decode().
+	static auto decodeHead(const QString& audioFile, int seconds) -> std::optional<Result>;
 	static auto supportedAudioTypes() -> const std::vector<AudioType>&;
 };
 } // namespace lmms
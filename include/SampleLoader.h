@@ -29,6 +29,7 @@
 #include <memory>
 
 #include "SampleBuffer.h"
+#include "SampleStream.h"
 #include "lmms_export.h"
 
 namespace lmms::gui {
@@ -38,6 +39,8 @@ public:
 	static QString openAudioFile(const QString& previousFile = "");
 	static QString openWaveformFile(const QString& previousFile = "");
 	static std::shared_ptr<const SampleBuffer> createBufferFromFile(const QString& filePath);
+	//! Returns nullptr if the file is better decoded with createBufferFromFile()
+	static std::shared_ptr<SampleStream> createStreamFromFile(const QString& filePath);
 	static std::shared_ptr<const SampleBuffer> createBufferFromBase64(
 		const QString& base64, int sampleRate = Engine::audioEngine()->processingSampleRate());
 private:
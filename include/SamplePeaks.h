@@ -0,0 +1,75 @@
+/*
+ * SamplePeaks.h - summary of sample frames for drawing them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SAMPLE_PEAKS_H
+#define LMMS_SAMPLE_PEAKS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+namespace lmms {
+
+/**
+ * The minimum, maximum and energy of the average of both channels, for bins
+ * of BinFrames frames and for every power of two of that, so a waveform can
+ * be drawn from a few bins per pixel at any zoom level.
+ */
+class LMMS_EXPORT SamplePeaks
+{
+public:
+	struct Peak
+	{
+		float min = 1.0f;
+		float max = -1.0f;
+		//! The sum of the squared values
+		float squares = 0.0f;
+	};
+
+	static constexpr std::size_t BinFrames = 64;
+
+	//! Adds @p count frames after those added before
+	void append(const sampleFrame* frames, std::size_t count);
+
+	//! Summarizes what's left of the frames and makes the higher levels, call after the last append()
+	void finish();
+
+	auto levelCount() const -> int { return static_cast<int>(m_levels.size()); }
+	auto level(int level) const -> const std::vector<Peak>& { return m_levels[level]; }
+	auto binFrames(int level) const -> std::size_t { return BinFrames << level; }
+
+	//! The level with the largest bins of at most @p frames frames, or -1 if even the smallest are larger
+	auto levelFor(std::size_t frames) const -> int;
+
+private:
+	std::vector<std::vector<Peak>> m_levels = std::vector<std::vector<Peak>>(1);
+	Peak m_bin;
+	std::size_t m_binFrames = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SAMPLE_PEAKS_H
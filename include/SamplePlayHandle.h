@@ -26,6 +26,9 @@
 #ifndef LMMS_SAMPLE_PLAY_HANDLE_H
 #define LMMS_SAMPLE_PLAY_HANDLE_H
 
+#include <atomic>
+#include <memory>
+
 #include "Sample.h"
 #include "SampleBuffer.h"
 #include "AutomatableModel.h"
@@ -75,18 +78,36 @@ public:
 		m_patternTrack = pt;
 	}
 
+	void setTrack(Track* track)
+	{
+		m_track = track;
+	}
+
 	void setVolumeModel( FloatModel * _model )
 	{
 		m_volumeModel = _model;
 	}
 
+	//! Continues playback from @p sample, which has to start with the frames of the
+	//! one played so far, like the whole file does for its first seconds. Takes
+	//! ownership, only for handles that own their sample and at most once.
+	void replaceSample(Sample* sample)
+	{
+		delete m_nextSample.exchange(sample);
+	}
+
 
 private:
 	Sample* m_sample;
+	std::atomic<Sample*> m_nextSample = nullptr;
+	Sample* m_replacedSample = nullptr;
 	bool m_doneMayReturnTrue;
 
 	f_cnt_t m_frame;
-	Sample::PlaybackState m_state;
+	//! Borrowed from the clip it plays, if any, its own otherwise
+	SampleClip* m_clip = nullptr;
+	std::unique_ptr<Sample::PlaybackState> m_ownState;
+	Sample::PlaybackState* m_state;
 
 	const bool m_ownAudioPort;
 
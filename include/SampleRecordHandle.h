@@ -25,8 +25,6 @@
 #ifndef LMMS_SAMPLE_RECORD_HANDLE_H
 #define LMMS_SAMPLE_RECORD_HANDLE_H
 
-#include <QList>
-#include <QPair>
 #include <memory>
 
 #include "PlayHandle.h"
@@ -37,7 +35,6 @@ namespace lmms
 
 
 class PatternTrack;
-class SampleBuffer;
 class SampleClip;
 class Track;
 
@@ -54,15 +51,13 @@ public:
 	bool isFromTrack( const Track * _track ) const override;
 
 	f_cnt_t framesRecorded() const;
-	std::shared_ptr<const SampleBuffer> createSampleBuffer();
 
 
 private:
-	virtual void writeBuffer( const sampleFrame * _ab,
-						const f_cnt_t _frames );
+	class Writer;
 
-	using bufferList = QList<QPair<sampleFrame*, f_cnt_t>>;
-	bufferList m_buffers;
+	//! Takes the recorded frames off the audio thread, to a file in the recordings directory
+	std::unique_ptr<Writer> m_writer;
 	f_cnt_t m_framesRecorded;
 	TimePos m_minLength;
 
@@ -0,0 +1,127 @@
+/*
+ * SampleStream.h - plays long audio files from disk instead of from memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_SAMPLE_STREAM_H
+#define LMMS_SAMPLE_STREAM_H
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+#include "SampleBuffer.h"
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+class QThread;
+
+namespace lmms {
+
+/**
+ * An audio file that is too long to be decoded into memory as a whole. Only
+ * its first seconds (the head) stay in memory, so playback can always start
+ * right away, and a reader thread keeps the blocks following the play
+ * position in a small cache.
+ *
+ * Every stream has one reader, so each player of the file should have its
+ * own stream. Copies share the head and the waveform overview.
+ */
+class LMMS_EXPORT SampleStream
+{
+public:
+	//! Files need to be at least this long to be streamed
+	static constexpr auto MinimumSeconds = 5 * 60;
+	static constexpr auto HeadSeconds = 10;
+
+	static constexpr auto BlockFrames = f_cnt_t{1} << 14;
+	static constexpr auto CachedBlocks = 64;
+
+	//! The number of frames summarized by two frames of overview()
+	static constexpr auto OverviewFrames = 256;
+
+	//! Whether @p audioFile is long enough to be streamed and in a format that can be
+	static auto canStream(const QString& audioFile) -> bool;
+
+	//! Opens @p audioFile and reads it once to prepare the head and overview,
+	//! throws like SampleBuffer's constructor if it can't be read
+	explicit SampleStream(const QString& audioFile);
+	SampleStream(const SampleStream& other);
+	~SampleStream();
+
+	auto operator=(const SampleStream&) -> SampleStream& = delete;
+
+	auto audioFile() const -> const QString& { return m_source->audioFile; }
+	auto sampleRate() const -> sample_rate_t { return m_source->head->sampleRate(); }
+	auto size() const -> f_cnt_t { return m_source->size; }
+
+	//! The frames at the start of the file, which never have to be read from disk
+	auto head() const -> std::shared_ptr<const SampleBuffer> { return m_source->head; }
+
+	//! The minimum and maximum of every OverviewFrames of the file, good enough to draw it
+	auto overview() const -> const SampleBuffer& { return m_source->overview; }
+
+	//! Lets the reader fill the cache from @p frame on, towards the start of the
+	//! file if @p backwards, for playback about to start there
+	void prefetch(f_cnt_t frame, bool backwards = false);
+
+	//! Copies @p frames frames from @p frame on to @p dst and moves the cache along. Frames that
+	//! weren't read from disk in time are silent, unless the song is exported, then this waits.
+	void read(sampleFrame* dst, f_cnt_t frame, f_cnt_t frames, bool backwards = false);
+
+private:
+	class Reader;
+
+	struct Source
+	{
+		QString audioFile;
+		f_cnt_t size = 0;
+		std::shared_ptr<const SampleBuffer> head;
+		SampleBuffer overview;
+	};
+
+	struct Block
+	{
+		//! Which block of the file this is, or -1 while it's being read
+		std::atomic<f_cnt_t> index = -1;
+		sampleFrame frames[BlockFrames];
+	};
+
+	auto readCached(sampleFrame* dst, f_cnt_t frame, f_cnt_t frames) const -> bool;
+	void run();
+
+	std::shared_ptr<const Source> m_source;
+	std::unique_ptr<Block[]> m_blocks;
+
+	std::atomic<f_cnt_t> m_position = 0;
+	std::atomic<bool> m_backwards = false;
+	std::atomic<bool> m_quit = false;
+	QMutex m_mutex;
+	QWaitCondition m_positionChanged;
+	std::unique_ptr<QThread> m_reader;
+};
+
+} // namespace lmms
+
+#endif // LMMS_SAMPLE_STREAM_H
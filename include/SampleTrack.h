@@ -25,6 +25,8 @@
 #ifndef LMMS_SAMPLE_TRACK_H
 #define LMMS_SAMPLE_TRACK_H
 
+#include <memory>
+
 #include "AudioPort.h"
 #include "Track.h"
 
@@ -32,6 +34,8 @@
 namespace lmms
 {
 
+class TrackFreezer;
+
 namespace gui
 {
 
@@ -50,6 +54,7 @@ public:
 
 	bool play( const TimePos & _start, const fpp_t _frames,
 						const f_cnt_t _frame_base, int _clip_num = -1 ) override;
+	int prefetch( const TimePos & start, const TimePos & end ) override;
 	gui::TrackView * createView( gui::TrackContainerView* tcv ) override;
 	Clip* createClip(const TimePos & pos) override;
 
@@ -58,6 +63,11 @@ public:
 							QDomElement & _parent ) override;
 	void loadTrackSpecificSettings( const QDomElement & _this ) override;
 
+	TrackFreezer * freezer() override
+	{
+		return m_freezer.get();
+	}
+
 	inline IntModel * mixerChannelModel()
 	{
 		return &m_mixerChannelModel;
@@ -68,6 +78,12 @@ public:
 		return &m_audioPort;
 	}
 
+	//! Whether the captured input plays through the effects of this track
+	BoolModel * monitorModel()
+	{
+		return &m_monitorModel;
+	}
+
 	QString nodeName() const override
 	{
 		return "sampletrack";
@@ -93,10 +109,15 @@ public slots:
 	void updateMixerChannel();
 
 private:
+	//! Arms the play handles of the clips the song loop starts in, when @p start is the last tick of it
+	void armLoopStart(const TimePos& start);
+
 	FloatModel m_volumeModel;
 	FloatModel m_panningModel;
 	IntModel m_mixerChannelModel;
+	BoolModel m_monitorModel;
 	AudioPort m_audioPort;
+	std::unique_ptr<TrackFreezer> m_freezer;
 	bool m_isPlaying;
 
 
@@ -50,10 +50,8 @@ public:
 	SampleTrackView( SampleTrack* Track, TrackContainerView* tcv );
 	~SampleTrackView() override;
 
-	SampleTrackWindow * getSampleTrackWindow()
-	{
-		return m_window;
-	}
+	//! The window is only made the first time it's shown
+	SampleTrackWindow * getSampleTrackWindow();
 
 	SampleTrack * model()
 	{
@@ -90,7 +88,7 @@ private slots:
 
 
 private:
-	SampleTrackWindow * m_window;
+	SampleTrackWindow * m_window = nullptr;
 	MixerChannelLcdSpinBox* m_mixerChannelNumber;
 	Knob * m_volumeKnob;
 	Knob * m_panningKnob;
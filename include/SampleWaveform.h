@@ -40,6 +40,8 @@ public:
 		size_t size;
 		float amplification;
 		bool reversed;
+		//! The buffer holding the frames, lets them be drawn from its peaks() when zoomed out
+		const SampleBuffer* source = nullptr;
 	};
 
 	static void visualize(Parameters parameters, QPainter& painter, const QRect& rect);
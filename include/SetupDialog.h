@@ -40,6 +40,7 @@ class QComboBox;
 class QLabel;
 class QLineEdit;
 class QSlider;
+class QSpinBox;
 
 
 namespace lmms::gui
@@ -99,6 +100,8 @@ private slots:
 	void vstEmbedMethodChanged();
 	void toggleVSTAlwaysOnTop(bool en);
 	void toggleDisableAutoQuit(bool enabled);
+	void togglePipelinedRemotePlugins(bool enabled);
+	void toggleSharedVstProcess(bool enabled);
 
 	// Audio settings widget.
 	void audioInterfaceChanged(const QString & driver);
@@ -106,6 +109,16 @@ private slots:
 	void updateBufferSizeWarning(int value);
 	void setBufferSize(int value);
 	void resetBufferSize();
+	void workerWaitPolicyChanged();
+	void toggleTaskGraph(bool enabled);
+	void setWorkerThreads(int value);
+	void setWorkerCores(const QString & cores);
+	void setWorkerRtPriority(int value);
+	void toggleXrunLog(bool enabled);
+	void setMaxVoices(int value);
+	void toggleQualityGovernor(bool enabled);
+	void toggleHugePages(bool enabled);
+	void toggleLockMemory(bool enabled);
 
 	// MIDI settings widget.
 	void midiInterfaceChanged(const QString & driver);
@@ -169,6 +182,8 @@ private:
 	QCheckBox * m_vstAlwaysOnTopCheckBox;
 	bool m_vstAlwaysOnTop;
 	bool m_disableAutoQuit;
+	bool m_pipelinedRemotePlugins;
+	bool m_sharedVstProcess;
 
 	using AswMap = QMap<QString, AudioDeviceSetupWidget*>;
 	using MswMap = QMap<QString, MidiSetupWidget*>;
@@ -184,6 +199,17 @@ private:
 	QSlider * m_bufferSizeSlider;
 	QLabel * m_bufferSizeLbl;
 	QLabel * m_bufferSizeWarnLbl;
+	QString m_workerWaitPolicy;
+	QComboBox * m_workerWaitPolicyComboBox;
+	bool m_taskGraph;
+	int m_workerThreads;
+	QString m_workerCores;
+	int m_workerRtPriority;
+	bool m_xrunLog;
+	int m_maxVoices;
+	bool m_qualityGovernor;
+	bool m_hugePages;
+	bool m_lockMemory;
 
 	// MIDI settings widgets.
 	QComboBox * m_midiInterfaces;
@@ -46,6 +46,10 @@ public:
 	SharedMemoryData(std::string&& key, std::size_t size, bool readOnly);
 	~SharedMemoryData();
 
+	//! Whether the memory created from now on is backed by huge pages and
+	//! locked in RAM, where the system allows it
+	static void setOptions(bool hugePages, bool locked) noexcept;
+
 	SharedMemoryData(SharedMemoryData&& other) noexcept;
 	SharedMemoryData& operator=(SharedMemoryData&& other) noexcept
 	{
@@ -26,12 +26,15 @@
 #define LMMS_SONG_H
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include <QHash>
 #include <QString>
 
 #include "AudioEngine.h"
+#include "AutomationIndex.h"
 #include "Controller.h"
 #include "lmms_constants.h"
 #include "MeterModel.h"
@@ -43,6 +46,7 @@ namespace lmms
 {
 
 class AutomationTrack;
+class DataFile;
 class Keymap;
 class MidiClip;
 class Scale;
@@ -251,6 +255,23 @@ public:
 		m_renderBetweenMarkers = renderBetweenMarkers;
 	}
 
+	//! Export only the ticks [@p begin, @p end) instead of the whole song,
+	//! starting @p preroll ticks earlier so effect tails and the state of the
+	//! instruments are there by @p begin, and going on for @p overlap ticks to
+	//! check the join with the next segment - see DistributedRenderer
+	void setExportSegment( tick_t begin, tick_t end, tick_t preroll, tick_t overlap );
+
+	//! Where the segment began and ended in the frames exported, -1 if it
+	//! didn't get there yet
+	f_cnt_t exportSegmentBeginFrame() const
+	{
+		return m_exportSegmentBeginFrame;
+	}
+	f_cnt_t exportSegmentEndFrame() const
+	{
+		return m_exportSegmentEndFrame;
+	}
+
 	inline PlayMode playMode() const
 	{
 		return m_playMode;
@@ -287,13 +308,16 @@ public:
 
 	bpm_t getTempo();
 
+	//! Called by the audio engine before the notes of a period are played:
+	//! stretches the ones playing to the tempo set since the last period
+	void resizeNotesToTempo();
+
 	AutomationTrack * globalAutomationTrack()
 	{
 		return m_globalAutomationTrack;
 	}
 
-	//TODO: Add Q_DECL_OVERRIDE when Qt4 is dropped
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const override;
+	AutomationSourceMap automationSourcesAt(TimePos time, int clipNum = -1) const override;
 
 	// file management
 	void createNewProject();
@@ -302,6 +326,8 @@ public:
 	bool guiSaveProject();
 	bool guiSaveProjectAs(const QString & filename);
 	bool saveProjectFile(const QString & filename, bool withResources = false);
+	//! Saves the project into @p dataFile, which can then be written by any thread
+	void saveProjectData(DataFile& dataFile);
 
 	const QString & projectFileName() const
 	{
@@ -359,7 +385,8 @@ public:
 		return m_tempoModel;
 	}
 
-	void exportProjectMidi(QString const & exportFileName) const;
+	//! Writes the notes of the song to a MIDI file, returns whether it worked
+	bool exportProjectMidi(QString const & exportFileName) const;
 
 	inline void setLoadOnLaunch(bool value) { m_loadOnLaunch = value; }
 	SaveOptions &getSaveOptions() {
@@ -447,7 +474,12 @@ private:
 	void saveKeymapStates(QDomDocument &doc, QDomElement &element);
 	void restoreKeymapStates(const QDomElement &element);
 
-	void processAutomations(const TrackList& tracks, TimePos timeStart, fpp_t frames);
+	void processAutomations(const TrackList& tracks, TimePos timeStart, float frameOffsetInTick,
+		f_cnt_t frameOffsetInPeriod, fpp_t frames);
+
+	//! Has @p tracks prepare for what starts in the next seconds of the song,
+	//! see Track::prefetch(), so a section doesn't begin with a stall
+	void prefetchAhead(const TrackList& tracks);
 
 	void setModified(bool value);
 
@@ -456,6 +488,8 @@ private:
 	AutomationTrack * m_globalAutomationTrack;
 
 	IntModel m_tempoModel;
+	//! Set by setTempo() for resizeNotesToTempo(), 0 if there's no new one
+	std::atomic<bpm_t> m_pendingTempo{0};
 	MeterModel m_timeSigModel;
 	int m_oldTicksPerBar;
 	IntModel m_masterVolumeModel;
@@ -508,10 +542,27 @@ private:
 	TimePos m_exportSongEnd;
 	TimePos m_exportEffectiveLength;
 
+	bool m_exportSegment;
+	tick_t m_exportSegmentBegin;
+	tick_t m_exportSegmentEnd;
+	tick_t m_exportSegmentPreroll;
+	tick_t m_exportSegmentOverlap;
+	//! Frames rendered since the export started
+	f_cnt_t m_exportFrames;
+	f_cnt_t m_exportSegmentBeginFrame;
+	f_cnt_t m_exportSegmentEndFrame;
+
+	//! Where prefetchAhead() last looked ahead from, -1 to look again
+	tick_t m_prefetchedAt;
+
 	std::shared_ptr<Scale> m_scales[MaxScaleCount];
 	std::shared_ptr<Keymap> m_keymaps[MaxKeymapCount];
 
-	AutomatedValueMap m_oldAutomatedValues;
+	// reused by processAutomations() on every tick
+	AutomationIndex m_automationIndex;
+	AutomationIndex::Sources m_automationSources;
+	std::vector<AutomatableModel*> m_automatedModels;
+	std::vector<AutomatableModel*> m_oldAutomatedModels;
 
 	friend class Engine;
 	friend class gui::SongEditor;
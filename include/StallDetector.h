@@ -0,0 +1,91 @@
+/*
+ * StallDetector.h - reports when the user interface stops responding
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_GUI_STALL_DETECTOR_H
+#define LMMS_GUI_STALL_DETECTOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include "lmmsconfig.h"
+
+#ifdef LMMS_HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+class QEvent;
+
+namespace lmms::gui
+{
+
+/*! Watches the event loop of the GUI thread from a thread of its own. If no
+ *  event was begun or finished for longer than the threshold while the GUI
+ *  thread wasn't waiting for events, it logs the event it is stuck in - its
+ *  type and the class of the receiver - and, where backtrace() is available,
+ *  the stack of the GUI thread at that moment.
+ *
+ *  MainApplication::notify() tells it about every event of the GUI thread.
+ */
+class StallDetector : public QThread
+{
+public:
+	//! Must be created on the GUI thread
+	explicit StallDetector(int thresholdMs);
+	~StallDetector() override;
+
+	void beginEvent(const QObject* receiver, const QEvent* event);
+	void endEvent();
+
+private:
+	void run() override;
+
+	void progress();
+	void report(std::int64_t stalledMs);
+
+	const int m_thresholdMs;
+	QElapsedTimer m_clock;
+	std::atomic_bool m_quit{false};
+
+	//! When the GUI thread last did something, -1 while it waits for events
+	std::atomic<std::int64_t> m_busySince{-1};
+	//! The innermost event it is in
+	std::atomic_int m_eventType{0};
+	std::atomic<const char*> m_receiverClass{nullptr};
+
+	//! The events the GUI thread is in, outermost first, only used by it
+	std::vector<std::pair<int, const char*>> m_events;
+
+#ifdef LMMS_HAVE_PTHREAD_H
+	pthread_t m_guiThread;
+#endif
+};
+
+} // namespace lmms::gui
+
+#endif // LMMS_GUI_STALL_DETECTOR_H
@@ -26,6 +26,9 @@
 #ifndef LMMS_GUI_STRING_PAIR_DRAG_H
 #define LMMS_GUI_STRING_PAIR_DRAG_H
 
+#include <any>
+#include <functional>
+
 #include <QDrag>
 #include <QDragEnterEvent>
 #include <QDropEvent>
@@ -44,12 +47,19 @@ class LMMS_EXPORT StringPairDrag : public QDrag
 public:
 	StringPairDrag( const QString & _key, const QString & _value,
 					const QPixmap & _icon, QWidget * _w );
+	//! Drags @p value as it is, which is only written as a string with
+	//! @p serialize when it's dropped on another process
+	StringPairDrag( const QString & key, std::any value, std::function<QString()> serialize,
+					const QPixmap & icon, QWidget * w );
 	~StringPairDrag() override;
 
 	static bool processDragEnterEvent( QDragEnterEvent * _dee,
 						const QString & _allowed_keys );
 	static QString decodeKey( QDropEvent * _de );
 	static QString decodeValue( QDropEvent * _de );
+
+private:
+	void start( QMimeData * mimeData, const QPixmap & icon, QWidget * w );
 } ;
 
 
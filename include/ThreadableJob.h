@@ -81,6 +81,14 @@ public:
 
 	virtual bool requiresProcessing() const = 0;
 
+	//! Jobs returning the same key, e.g. because they share thread-local
+	//! state, are always processed by the same worker thread and never
+	//! stolen by idle ones. The others (nullptr) are balanced freely.
+	virtual const void* workerAffinity() const
+	{
+		return nullptr;
+	}
+
 
 protected:
 	virtual void doProcessing() = 0;
@@ -25,6 +25,8 @@
 #ifndef LMMS_TRACK_H
 #define LMMS_TRACK_H
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 #include <QColor>
@@ -32,6 +34,7 @@
 #include "AutomatableModel.h"
 #include "JournallingObject.h"
 #include "lmms_basics.h"
+#include "PeriodArena.h"
 #include <optional>
 
 
@@ -40,6 +43,7 @@ namespace lmms
 
 class TimePos;
 class TrackContainer;
+class TrackFreezer;
 class Clip;
 
 
@@ -72,6 +76,8 @@ class LMMS_EXPORT Track : public Model, public JournallingObject
 	mapPropertyFromModel(bool,isSolo,setSolo,m_soloModel);
 public:
 	using clipVector = std::vector<Clip*>;
+	//! For the clips played in a period, see PeriodArena
+	using periodClipVector = PeriodAllocator<Clip*>::vector;
 
 	enum class Type
 	{
@@ -103,6 +109,15 @@ public:
 	virtual bool play( const TimePos & start, const fpp_t frames,
 						const f_cnt_t frameBase, int clipNum = -1 ) = 0;
 
+	//! Prepares for the clips starting in [@p start, @p end), a few seconds
+	//! before play() gets to them, see Song::prefetchAhead(). Runs on the
+	//! audio thread, so it mustn't block. Returns how many notes start in
+	//! there, which the note pool is then made to have room for.
+	virtual int prefetch( const TimePos & start, const TimePos & end )
+	{
+		return 0;
+	}
+
 
 
 	virtual gui::TrackView * createView( gui::TrackContainerView * view ) = 0;
@@ -112,6 +127,12 @@ public:
 						QDomElement & parent ) = 0;
 	virtual void loadTrackSpecificSettings( const QDomElement & element ) = 0;
 
+	//! Tracks that can be frozen return their freezer here
+	virtual TrackFreezer * freezer()
+	{
+		return nullptr;
+	}
+
 
 	void saveSettings( QDomDocument & doc, QDomElement & element ) override;
 	void loadSettings( const QDomElement & element ) override;
@@ -135,8 +156,15 @@ public:
 	{
 		return m_clips;
 	}
-	void getClipsInRange( clipVector & clipV, const TimePos & start,
+	//! Adds the clips overlapping [@p start, @p end] to @p clipV, sorted by position.
+	//! They are looked up in an index of the clips, so it doesn't matter how many there are.
+	void getClipsInRange( periodClipVector & clipV, const TimePos & start,
 							const TimePos & end );
+	//! Has the index rebuilt, called when a clip is added, removed, moved or resized
+	void invalidateClipIndex()
+	{
+		++m_clipRevision;
+	}
 	void swapPositionOfClips( int clipNum1, int clipNum2 );
 
 	void createClipsForPattern(int pattern);
@@ -200,6 +228,11 @@ public:
 	
 	BoolModel* getMutedModel();
 
+	BoolModel* getSoloModel()
+	{
+		return &m_soloModel;
+	}
+
 public slots:
 	virtual void setName( const QString & newName )
 	{
@@ -231,6 +264,19 @@ private:
 
 	clipVector m_clips;
 
+	//! m_clips sorted by start, each with the latest end of it and of all before it, so
+	//! the clips that can overlap a range are the ones in between two binary searches
+	struct ClipRange
+	{
+		tick_t start;
+		tick_t latestEnd;
+		Clip* clip;
+	};
+	std::vector<ClipRange> m_clipIndex;
+	std::atomic_int m_clipRevision = 0;
+	int m_clipIndexRevision = -1;
+	std::mutex m_clipIndexMutex;
+
 	QMutex m_processingLock;
 	
 	std::optional<QColor> m_color;
@@ -36,6 +36,7 @@ namespace lmms
 
 class AutomationClip;
 class InstrumentTrack;
+class PatternClip;
 
 namespace gui
 {
@@ -45,6 +46,17 @@ class TrackContainerView;
 }
 
 
+//! Where an automated model takes its value from at some point in time
+struct AutomationSource
+{
+	const AutomationClip* clip;
+	TimePos time; //!< relative to the start of the clip
+	bool moving; //!< false if the time is held at the end of a clip or pattern
+};
+
+using AutomationSourceMap = QMap<AutomatableModel*, AutomationSource>;
+
+
 class LMMS_EXPORT TrackContainer : public Model, public JournallingObject
 {
 	Q_OBJECT
@@ -95,13 +107,19 @@ public:
 		return m_TrackContainerType;
 	}
 
-	virtual AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	virtual AutomationSourceMap automationSourcesAt(TimePos time, int clipNum = -1) const;
+
+	//! Where the models automated by @p clip take their value from at @p time
+	static AutomationSource automationSource(const AutomationClip* clip, TimePos time);
+	//! The same for the automation in the pattern @p clip plays
+	static AutomationSourceMap patternAutomationSources(const PatternClip* clip, TimePos time);
 
 signals:
 	void trackAdded( lmms::Track * _track );
 
 protected:
-	static AutomatedValueMap automatedValuesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
+	static AutomationSourceMap automationSourcesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
 
 	mutable QReadWriteLock m_tracksMutex;
 
@@ -0,0 +1,128 @@
+/*
+ * TrackFreezer.h - render a track into a cache and play that back instead
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_TRACK_FREEZER_H
+#define LMMS_TRACK_FREEZER_H
+
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "lmms_basics.h"
+#include "Sample.h"
+
+namespace lmms
+{
+
+class AudioPort;
+class RenderManager;
+class TimePos;
+class Track;
+
+
+/*! Freezing renders a track through its instrument and effects into a
+ *  cached stereo buffer once. While frozen, the track plays that buffer
+ *  back through a plain audio port sending to the same mixer channel,
+ *  and its clips, instrument and effects don't need to be processed.
+ *
+ *  The cache is dropped as soon as anything it depends on changes.
+ */
+class LMMS_EXPORT TrackFreezer : public QObject
+{
+	Q_OBJECT
+public:
+	TrackFreezer( Track * track, AudioPort * trackPort );
+	~TrackFreezer() override;
+
+	bool isFrozen() const
+	{
+		return m_frozen;
+	}
+
+	bool isFreezing() const
+	{
+		return m_renderManager != nullptr;
+	}
+
+	//! The rendered track, empty if it isn't frozen
+	const Sample & cache() const
+	{
+		return m_sample;
+	}
+
+	//! The port the cache is played through, nullptr if it isn't frozen
+	AudioPort * audioPort() const
+	{
+		return m_frozen ? m_audioPort.get() : nullptr;
+	}
+
+	//! Start playing the cache from the given song position if it isn't
+	//! already playing, returns false if there's nothing left to play
+	bool play( const TimePos & start, f_cnt_t offset );
+
+	//! Called by the track's audio port while freezing, appends what the
+	//! port sent to its mixer channel in this period
+	void capture( const sampleFrame * buf, fpp_t frames );
+
+public slots:
+	void freeze();
+	void unfreeze();
+	void abortFreezing();
+
+signals:
+	void frozenChanged();
+	void progressChanged( int progress );
+
+private slots:
+	void renderFinished();
+	void stopPlaying();
+
+private:
+	void watchForChanges();
+	void restoreMutedTracks();
+
+	Track * m_track;
+	AudioPort * m_trackPort;
+
+	bool m_frozen;
+	bool m_playing;
+	Sample m_sample;
+	std::unique_ptr<AudioPort> m_audioPort;
+
+	// state while rendering
+	std::unique_ptr<RenderManager> m_renderManager;
+	QString m_renderFile;
+	sample_rate_t m_renderSampleRate;
+	std::vector<sampleFrame> m_captured;
+	std::vector<Track *> m_mutedTracks;
+
+	std::vector<QMetaObject::Connection> m_watches;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_TRACK_FREEZER_H
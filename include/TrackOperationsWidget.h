@@ -61,6 +61,7 @@ private slots:
 	void recordingOn();
 	void recordingOff();
 	void clearTrack();
+	void toggleFreeze();
 
 private:
 	TrackView * m_trackView;
@@ -0,0 +1,68 @@
+/*
+ * TruePeakMeter.h - the peaks of stereo audio in between its samples
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_TRUE_PEAK_METER_H
+#define LMMS_TRUE_PEAK_METER_H
+
+#include <array>
+#include <cstddef>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+namespace lmms {
+
+/**
+ * Finds the true peak of stereo audio like ITU-R BS.1770-4 does, from 4x
+ * oversampling with a polyphase filter, so peaks that are only reached in
+ * between two samples - and clip after the conversion to analog - show.
+ */
+class LMMS_EXPORT TruePeakMeter
+{
+public:
+	TruePeakMeter();
+
+	//! The largest absolute value of the newest @p sample of @p channel and of the
+	//! three interpolated between it and the one before. Call for both channels,
+	//! then nextFrame().
+	auto process(int channel, float sample) -> float;
+	void nextFrame() { m_pos = m_pos == 0 ? Taps - 1 : m_pos - 1; }
+
+	//! The true peak of @p count frames after those measured before, scaled by @p gain
+	auto process(const sampleFrame* frames, std::size_t count, float gain = 1.0f) -> float;
+
+	//! Taps of each of the four phases of the oversampling filter
+	static constexpr std::size_t Taps = 12;
+
+private:
+	// the filter with the history of each channel twice, so the last Taps
+	// samples are always contiguous from m_pos on
+	std::array<std::array<float, Taps>, 4> m_filter;
+	std::array<std::array<float, 2 * Taps>, 2> m_history = {};
+	std::size_t m_pos = 0;
+};
+
+} // namespace lmms
+
+#endif // LMMS_TRUE_PEAK_METER_H
@@ -0,0 +1,124 @@
+/*
+ * VoicePool.h - keeps the per-note data of an instrument for the next notes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_VOICE_POOL_H
+#define LMMS_VOICE_POOL_H
+
+#include <cstdint>
+#include <memory>
+
+#include "LocklessIndexStack.h"
+
+namespace lmms
+{
+
+
+/*! Keeps up to a fixed number of the voices an instrument builds for its
+ *  notes, so that it doesn't have to build them again for the next notes
+ *  when that is expensive. An instrument acquires a voice in playNote() and
+ *  releases it in deleteNotePluginData() instead of deleting it, and resets
+ *  whatever it acquired for the new note itself.
+ *
+ *  Notes are played on any of the worker threads, so voices can be acquired
+ *  and released from all of them at once without locking.
+ */
+template<typename T>
+class VoicePool
+{
+public:
+	explicit VoicePool(std::uint32_t capacity) :
+		m_voices(new T*[capacity]),
+		m_idle(capacity),
+		m_empty(capacity)
+	{
+		for (std::uint32_t slot = 0; slot < capacity; ++slot) { m_empty.push(slot); }
+	}
+
+	VoicePool(const VoicePool&) = delete;
+	VoicePool& operator=(const VoicePool&) = delete;
+
+	~VoicePool()
+	{
+		clear();
+	}
+
+	//! A voice that was released before, or nullptr if none is left
+	T* acquire()
+	{
+		const auto slot = m_idle.pop();
+		if (slot == LocklessIndexStack::Empty) { return nullptr; }
+
+		T* voice = m_voices[slot];
+		m_empty.push(slot);
+		return voice;
+	}
+
+	//! Takes over @p voice, which is deleted if the pool is full already
+	void release(T* voice)
+	{
+		if (!voice) { return; }
+
+		const auto slot = m_empty.pop();
+		if (slot == LocklessIndexStack::Empty)
+		{
+			delete voice;
+			return;
+		}
+
+		m_voices[slot] = voice;
+		m_idle.push(slot);
+	}
+
+	//! Builds voices with @p create until @p count of them are waiting, so the
+	//! first notes don't have to. Meant to be called outside of the audio threads.
+	template<typename Create>
+	void reserve(int count, Create create)
+	{
+		while (m_idle.size() < count && m_empty.size() > 0) { release(create()); }
+	}
+
+	//! Deletes all of the voices that are waiting, e.g. because they became
+	//! useless when the sample rate changed
+	void clear()
+	{
+		while (T* voice = acquire()) { delete voice; }
+	}
+
+	int idle() const
+	{
+		return m_idle.size();
+	}
+
+private:
+	std::unique_ptr<T*[]> m_voices;
+	//! The slots holding a voice
+	LocklessIndexStack m_idle;
+	//! The slots not holding any
+	LocklessIndexStack m_empty;
+};
+
+
+} // namespace lmms
+
+#endif // LMMS_VOICE_POOL_H
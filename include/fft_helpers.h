@@ -106,6 +106,27 @@ int LMMS_EXPORT compressbands(const float * _absspec_buffer, float * _compressed
 			int _num_old, int _num_new, int _bottom, int _top);
 
 
+/**	FFTW plans shared by everything in LMMS that transforms the same size in
+ *	the same direction: one per size, direction and alignment of the arrays,
+ *	created with FFTW_MEASURE the first time it's asked for and kept until
+ *	exit. What FFTW learns while planning is kept in the cache directory and
+ *	loaded with the first plan, so the usual sizes are planned at once.
+ *
+ *	Planning takes long and is something only one thread can do at a time, so
+ *	it mustn't happen while rendering. Executing a plan is quick and can be
+ *	done from any number of threads, but only with the new-array functions
+ *	fftwf_execute_dft_r2c() and fftwf_execute_dft_c2r() on arrays aligned like
+ *	the ones the plan was asked for with, which aren't touched by planning.
+ *
+ *	@return nullptr if FFTW can't plan it
+ */
+fftwf_plan LMMS_EXPORT realToComplexPlan(unsigned int size, float *in, fftwf_complex *out);
+fftwf_plan LMMS_EXPORT complexToRealPlan(unsigned int size, fftwf_complex *in, float *out);
+
+//! Destroys the shared plans, nothing may use them anymore
+void LMMS_EXPORT destroySharedFFTPlans();
+
+
 } // namespace lmms
 
 #endif // LMMS_FFT_HELPERS_H
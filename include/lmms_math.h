@@ -30,6 +30,7 @@
 #include "lmmsconfig.h"
 #include <QtGlobal>
 
+#include <algorithm>
 #include <cmath>
 
 namespace lmms
@@ -311,6 +312,27 @@ static inline float fastSqrt( float n )
 	return u.f;
 }
 
+//! 2 to the power of @p x, within about 1e-7 relative to powf(2.f, x), for
+//! turning pitches into frequency ratios quickly. Results beyond the range
+//! of normal floats are clamped to it.
+static inline float fastExp2f( float x )
+{
+	const float whole = std::floor( x + 0.5f );
+	const float f = x - whole;	// in [-0.5, 0.5]
+
+	// Taylor series of 2^f, which is close enough this near to 0
+	const float fraction = 1.0f + f * ( 0.69314718f + f * ( 0.24022651f + f * ( 0.05550411f
+		+ f * ( 0.00961813f + f * ( 0.00133336f + f * 0.00015404f ) ) ) ) );
+
+	union
+	{
+		int32_t i;
+		float f;
+	} u;
+	u.i = ( static_cast<int32_t>( std::clamp( whole, -126.0f, 127.0f ) ) + 127 ) << 23;
+	return fraction * u.f;
+}
+
 //! returns value furthest from zero
 template<class T>
 static inline T absMax( T a, T b )
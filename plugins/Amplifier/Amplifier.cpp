@@ -59,40 +59,42 @@ AmplifierEffect::AmplifierEffect(Model* parent, const Descriptor::SubPluginFeatu
 
 bool AmplifierEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 {
-	if (!isEnabled() || !isRunning()) { return false ; }
+	return processFramesOf<AmplifierEffect>(buf, frames);
+}
 
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
 
-	const ValueBuffer* volumeBuf = m_ampControls.m_volumeModel.valueBuffer();
-	const ValueBuffer* panBuf = m_ampControls.m_panModel.valueBuffer();
-	const ValueBuffer* leftBuf = m_ampControls.m_leftModel.valueBuffer();
-	const ValueBuffer* rightBuf = m_ampControls.m_rightModel.valueBuffer();
+bool AmplifierEffect::startFrames(const fpp_t)
+{
+	if (!isEnabled() || !isRunning()) { return false ; }
 
-	for (fpp_t f = 0; f < frames; ++f)
-	{
-		const float volume = (volumeBuf ? volumeBuf->value(f) : m_ampControls.m_volumeModel.value()) * 0.01f;
-		const float pan = (panBuf ? panBuf->value(f) : m_ampControls.m_panModel.value()) * 0.01f;
-		const float left = (leftBuf ? leftBuf->value(f) : m_ampControls.m_leftModel.value()) * 0.01f;
-		const float right = (rightBuf ? rightBuf->value(f) : m_ampControls.m_rightModel.value()) * 0.01f;
+	m_dry = dryLevel();
+	m_wet = wetLevel();
+
+	m_volumeBuf = m_ampControls.m_volumeModel.valueBuffer();
+	m_panBuf = m_ampControls.m_panModel.valueBuffer();
+	m_leftBuf = m_ampControls.m_leftModel.valueBuffer();
+	m_rightBuf = m_ampControls.m_rightModel.valueBuffer();
+	return true;
+}
 
-		const float panLeft = std::min(1.0f, 1.0f - pan);
-		const float panRight = std::min(1.0f, 1.0f + pan);
 
-		auto s = std::array{buf[f][0], buf[f][1]};
+void AmplifierEffect::processFrame(sampleFrame& frame, const fpp_t f)
+{
+	const float volume = (m_volumeBuf ? m_volumeBuf->value(f) : m_ampControls.m_volumeModel.value()) * 0.01f;
+	const float pan = (m_panBuf ? m_panBuf->value(f) : m_ampControls.m_panModel.value()) * 0.01f;
+	const float left = (m_leftBuf ? m_leftBuf->value(f) : m_ampControls.m_leftModel.value()) * 0.01f;
+	const float right = (m_rightBuf ? m_rightBuf->value(f) : m_ampControls.m_rightModel.value()) * 0.01f;
 
-		s[0] *= volume * left * panLeft;
-		s[1] *= volume * right * panRight;
+	const float panLeft = std::min(1.0f, 1.0f - pan);
+	const float panRight = std::min(1.0f, 1.0f + pan);
 
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-	}
+	auto s = std::array{frame[0], frame[1]};
 
-	checkGate(outSum / frames);
+	s[0] *= volume * left * panLeft;
+	s[1] *= volume * right * panRight;
 
-	return isRunning();
+	frame[0] = m_dry * frame[0] + m_wet * s[0];
+	frame[1] = m_dry * frame[1] + m_wet * s[1];
 }
 
 
@@ -32,21 +32,38 @@
 namespace lmms
 {
 
-class AmplifierEffect : public Effect
+class AmplifierEffect final : public Effect
 {
 public:
 	AmplifierEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~AmplifierEffect() override = default;
 	bool processAudioBuffer(sampleFrame* buf, const fpp_t frames) override;
 
+	bool processesFrames() const override { return true; }
+	bool startFrames(const fpp_t frames) override;
+	void processFrame(sampleFrame& frame, const fpp_t f) override;
+
 	EffectControls* controls() override
 	{
 		return &m_ampControls;
 	}
 
+	f_cnt_t tailLength() const override
+	{
+		return 0;
+	}
+
 private:
 	AmplifierControls m_ampControls;
 
+	// what processFrame() needs, fetched by startFrames()
+	float m_dry = 0.0f;
+	float m_wet = 0.0f;
+	const ValueBuffer* m_volumeBuf = nullptr;
+	const ValueBuffer* m_panBuf = nullptr;
+	const ValueBuffer* m_leftBuf = nullptr;
+	const ValueBuffer* m_rightBuf = nullptr;
+
 	friend class AmplifierControls;
 };
 
@@ -38,6 +38,7 @@
 #include "Engine.h"
 #include "gui_templates.h"
 #include "InstrumentTrack.h"
+#include "MemoryReport.h"
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
 #include "PixmapButton.h"
@@ -112,6 +113,8 @@ AudioFileProcessor::AudioFileProcessor( InstrumentTrack * _instrument_track ) :
 	m_interpolationModel.addItem( tr( "None" ) );
 	m_interpolationModel.addItem( tr( "Linear" ) );
 	m_interpolationModel.addItem( tr( "Sinc" ) );
+	m_interpolationModel.addItem( tr( "Cubic (light)" ) );
+	m_interpolationModel.addItem( tr( "Sinc (light)" ) );
 	m_interpolationModel.setValue( 1 );
 
 	pointChanged();
@@ -158,7 +161,14 @@ void AudioFileProcessor::playNote( NotePlayHandle * _n,
 			case 2:
 				srcmode = SRC_SINC_MEDIUM_QUALITY;
 				break;
+			case 3:
+				srcmode = AudioResampler::CubicHermite;
+				break;
+			case 4:
+				srcmode = AudioResampler::ShortSinc;
+				break;
 		}
+		srcmode = Engine::audioEngine()->qualityGovernor().sampleInterpolation(srcmode);
 		_n->m_pluginData = new Sample::PlaybackState(_n->hasDetuningInfo(), srcmode);
 		static_cast<Sample::PlaybackState*>(_n->m_pluginData)->setFrameIndex(m_nextPlayStartPoint);
 		static_cast<Sample::PlaybackState*>(_n->m_pluginData)->setBackwards(m_nextPlayBackwards);
@@ -292,6 +302,14 @@ QString AudioFileProcessor::nodeName() const
 
 
 
+void AudioFileProcessor::reportMemoryUsage( MemoryReport & report ) const
+{
+	report.addSample( m_sample, tr( "Sample" ) );
+}
+
+
+
+
 auto AudioFileProcessor::beatLen(NotePlayHandle* note) const -> int
 {
 	// If we can play indefinitely, use the default beat note duration
@@ -1014,7 +1032,8 @@ void AudioFileProcessorWaveView::updateGraph()
 
 	const auto rect = QRect{0, 0, m_graph.width(), m_graph.height()};
 	const auto waveform = SampleWaveform::Parameters{
-		m_sample->data() + m_from, static_cast<size_t>(m_to - m_from), m_sample->amplification(), m_sample->reversed()};
+		m_sample->data() + m_from, static_cast<size_t>(m_to - m_from), m_sample->amplification(), m_sample->reversed(),
+		m_sample->buffer().get()};
 	SampleWaveform::visualize(waveform, p, rect);
 }
 
@@ -68,6 +68,8 @@ public:
 
 	QString nodeName() const override;
 
+	void reportMemoryUsage( MemoryReport & report ) const override;
+
 	auto beatLen(NotePlayHandle* note) const -> int override;
 
 	f_cnt_t desiredReleaseFrames() const override
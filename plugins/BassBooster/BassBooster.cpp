@@ -70,6 +70,14 @@ BassBoosterEffect::BassBoosterEffect( Model* parent, const Descriptor::SubPlugin
 
 
 bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+{
+	return processFramesOf<BassBoosterEffect>( buf, frames );
+}
+
+
+
+
+bool BassBoosterEffect::startFrames( const fpp_t )
 {
 	if( !isEnabled() || !isRunning () )
 	{
@@ -84,35 +92,29 @@ bool BassBoosterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	if( m_bbControls.m_gainModel.isValueChanged() ) { changeGain(); }
 	if( m_bbControls.m_ratioModel.isValueChanged() ) { changeRatio(); }
 
-	const float const_gain = m_bbControls.m_gainModel.value();
-	const ValueBuffer *gainBuffer = m_bbControls.m_gainModel.valueBuffer();
+	m_gain = m_bbControls.m_gainModel.value();
+	m_gainBuffer = m_bbControls.m_gainModel.valueBuffer();
 
-	double outSum = 0.0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+	m_dry = dryLevel();
+	m_wet = wetLevel();
+	return true;
+}
 
-	for( fpp_t f = 0; f < frames; ++f )
-	{
-		float gain = const_gain;
-		if (gainBuffer) {
-			//process period using sample exact data
-			gain = gainBuffer->value( f );
-		}
-		//float gain = gainBuffer ? gainBuffer[f] : gain;
-		m_bbFX.leftFX().setGain( gain );
-		m_bbFX.rightFX().setGain( gain);
-
-		auto s = std::array{buf[f][0], buf[f][1]};
-		m_bbFX.nextSample( s[0], s[1] );
-
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-	}
 
-	checkGate( outSum / frames );
 
-	return isRunning();
+
+void BassBoosterEffect::processFrame( sampleFrame& frame, const fpp_t f )
+{
+	//process period using sample exact data
+	const float gain = m_gainBuffer ? m_gainBuffer->value( f ) : m_gain;
+	m_bbFX.leftFX().setGain( gain );
+	m_bbFX.rightFX().setGain( gain);
+
+	auto s = std::array{frame[0], frame[1]};
+	m_bbFX.nextSample( s[0], s[1] );
+
+	frame[0] = m_dry * frame[0] + m_wet * s[0];
+	frame[1] = m_dry * frame[1] + m_wet * s[1];
 }
 
 
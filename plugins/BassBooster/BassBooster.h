@@ -33,13 +33,17 @@
 namespace lmms
 {
 
-class BassBoosterEffect : public Effect
+class BassBoosterEffect final : public Effect
 {
 public:
 	BassBoosterEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
 	~BassBoosterEffect() override = default;
 	bool processAudioBuffer( sampleFrame* buf, const fpp_t frames ) override;
 
+	bool processesFrames() const override { return true; }
+	bool startFrames( const fpp_t frames ) override;
+	void processFrame( sampleFrame& frame, const fpp_t f ) override;
+
 	EffectControls* controls() override
 	{
 		return &m_bbControls;
@@ -58,6 +62,12 @@ private:
 
 	BassBoosterControls m_bbControls;
 
+	// what processFrame() needs, fetched by startFrames()
+	float m_dry = 0.0f;
+	float m_wet = 0.0f;
+	float m_gain = 0.0f;
+	const ValueBuffer* m_gainBuffer = nullptr;
+
 	friend class BassBoosterControls;
 
 } ;
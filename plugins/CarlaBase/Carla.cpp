@@ -155,6 +155,8 @@ CarlaInstrument::CarlaInstrument(InstrumentTrack* const instrumentTrack, const D
       fHandle(nullptr),
       fDescriptor(isPatchbay ? carla_get_native_patchbay_plugin() : carla_get_native_rack_plugin()),
       fMidiEventCount(0),
+      fSilence(Engine::audioEngine()->framesPerPeriod()),
+      fOutput(Engine::audioEngine()->framesPerPeriod() * DEFAULT_CHANNELS),
       m_paramModels()
 {
     fHost.handle      = this;
@@ -504,10 +506,9 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
 {
     const uint bufsize = Engine::audioEngine()->framesPerPeriod();
 
-    std::memset(workingBuffer, 0, sizeof(sample_t)*bufsize*DEFAULT_CHANNELS);
-
     if (fHandle == nullptr)
     {
+        std::memset(workingBuffer, 0, sizeof(sample_t)*bufsize*DEFAULT_CHANNELS);
         return;
     }
 
@@ -525,17 +526,9 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
     fTimeInfo.bbt.ticksPerBeat   = ticksPerBeat;
     fTimeInfo.bbt.beatsPerMinute = s->getTempo();
 
-#ifndef _MSC_VER
-    float buf1[bufsize];
-    float buf2[bufsize];
-#else
-    float *buf1 = static_cast<float *>(_alloca(bufsize * sizeof(float)));
-    float *buf2 = static_cast<float *>(_alloca(bufsize * sizeof(float)));
-#endif
-
-    float* rBuf[] = { buf1, buf2 };
-    std::memset(buf1, 0, sizeof(float)*bufsize);
-    std::memset(buf2, 0, sizeof(float)*bufsize);
+    Q_ASSERT(bufsize <= fSilence.size());
+    float* inBuf[] = { fSilence.data(), fSilence.data() };
+    float* outBuf[] = { fOutput.data(), fOutput.data() + bufsize };
 
     {
         const QMutexLocker ml(&fMutex);
@@ -543,17 +536,17 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
 // https://github.com/falkTX/Carla/blob/8bceb9ed173a10b29038f8abb4383710c0e497c1/source/includes/CarlaNative.h
 //     FIXME for v3.0, use const for the input buffer
 #if CARLA_VERSION_HEX >= CARLA_VERSION_HEX_3
-        fDescriptor->process(fHandle, (const float**)rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
+        fDescriptor->process(fHandle, (const float**)inBuf, outBuf, bufsize, fMidiEvents, fMidiEventCount);
 #else
-        fDescriptor->process(fHandle, rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
+        fDescriptor->process(fHandle, inBuf, outBuf, bufsize, fMidiEvents, fMidiEventCount);
 #endif
         fMidiEventCount = 0;
     }
 
     for (uint i=0; i < bufsize; ++i)
     {
-        workingBuffer[i][0] = buf1[i];
-        workingBuffer[i][1] = buf2[i];
+        workingBuffer[i][0] = outBuf[0][i];
+        workingBuffer[i][1] = outBuf[1][i];
     }
 }
 
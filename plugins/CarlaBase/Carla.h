@@ -34,6 +34,8 @@
 #include <QDomElement>
 #include <QMutex>
 
+#include <vector>
+
 // carla/source/includes
 #include "carlabase_export.h"
 #include "CarlaDefines.h"
@@ -219,6 +221,11 @@ private:
     NativeMidiEvent fMidiEvents[kMaxMidiEvents];
     NativeTimeInfo  fTimeInfo;
 
+    // what Carla processes, allocated once: the inputs always stay silent and
+    // the outputs are overwritten, so nothing needs clearing per period
+    std::vector<float> fSilence;
+    std::vector<float> fOutput;
+
     // this is only needed because note-offs are being sent during play
     QMutex fMutex;
 
@@ -187,6 +187,7 @@ void CompressorEffect::calcThreshold()
 {
 	m_thresholdVal = m_compressorControls.m_thresholdModel.value();
 	m_thresholdAmpVal = dbfsToAmp(m_thresholdVal);
+	calcKneeAmps();
 	m_redrawKnee = true;
 	m_redrawThreshold = true;
 }
@@ -194,9 +195,17 @@ void CompressorEffect::calcThreshold()
 void CompressorEffect::calcKnee()
 {
 	m_kneeVal = m_compressorControls.m_kneeModel.value() * 0.5f;
+	calcKneeAmps();
 	m_redrawKnee = true;
 }
 
+void CompressorEffect::calcKneeAmps()
+{
+	// so the sidechain can be compared to the knee without converting it to dBFS
+	m_kneeStartAmpVal = dbfsToAmp(m_thresholdVal - m_kneeVal);
+	m_kneeEndAmpVal = dbfsToAmp(m_thresholdVal + m_kneeVal);
+}
+
 void CompressorEffect::calcInGain()
 {
 	m_inGainVal = dbfsToAmp(m_compressorControls.m_inGainModel.value());
@@ -233,6 +242,14 @@ void CompressorEffect::calcMix()
 
 
 
+f_cnt_t CompressorEffect::latency() const
+{
+	// the lookahead delays the whole signal, dry or not
+	return m_compressorControls.m_lookaheadModel.value() ? m_lookBufLength : 0;
+}
+
+
+
 bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 {
 	if (!isEnabled() || !isRunning())
@@ -279,6 +296,19 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 	const bool feedback = m_compressorControls.m_feedbackModel.value();
 	const bool lookahead = m_compressorControls.m_lookaheadModel.value();
 
+	// Everything that only depends on the controls is worked out once per period
+	const bool useFeedback = feedback && !lookahead;
+	const float inBalanceGain[2] = {inBalance > 0 ? 1 - inBalance : 1, inBalance < 0 ? 1 + inBalance : 1};
+	const float outGain[2] = {
+		m_inGainVal * m_outGainVal * (outBalance > 0 ? 1 - outBalance : 1),
+		m_inGainVal * m_outGainVal * (outBalance < 0 ? 1 + outBalance : 1)
+	};
+	const float stereoBalanceGain[2] = {stereoBalance > 0 ? 1 - stereoBalance : 1, stereoBalance < 0 ? 1 + stereoBalance : 1};
+	const float ratioExponent = (limiter ? 0 : m_ratioVal) - 1;
+	// msToCoeff() of the attack and release scaled by the crest factor, as a product
+	const float autoAttPrecalc = m_coeffPrecalc / (2.f * m_compressorControls.m_attackModel.value());
+	const float autoRelPrecalc = m_coeffPrecalc / (2.f * m_compressorControls.m_releaseModel.value());
+
 	for(fpp_t f = 0; f < frames; ++f)
 	{
 		auto drySignal = std::array{buf[f][0], buf[f][1]};
@@ -298,15 +328,15 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 			s[1] = temp - s[1];
 		}
 
-		s[0] *= inBalance > 0 ? 1 - inBalance : 1;
-		s[1] *= inBalance < 0 ? 1 + inBalance : 1;
+		s[0] *= inBalanceGain[0];
+		s[1] *= inBalanceGain[1];
 
 		m_gainResult[0] = 0;
 		m_gainResult[1] = 0;
 
 		for (int i = 0; i < 2; i++)
 		{
-			float inputValue = (feedback && !lookahead) ? m_prevOut[i] : s[i];
+			float inputValue = useFeedback ? m_prevOut[i] : s[i];
 
 			// Calculate the crest factor of the audio by diving the peak by the RMS
 			m_crestPeakVal[i] = qMax(qMax(COMP_NOISE_FLOOR, inputValue * inputValue), m_crestTimeConst * m_crestPeakVal[i] + (1 - m_crestTimeConst) * (inputValue * inputValue));
@@ -330,7 +360,7 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 
 				// Calculate attack value depending on crest factor
 				const float att = m_autoAttVal
-					? msToCoeff(2.f * m_compressorControls.m_attackModel.value() / (crestFactorValTemp))
+					? std::exp(autoAttPrecalc * crestFactorValTemp)
 					: m_attCoeff;
 
 				m_yL[i] = m_yL[i] * att + (1 - att) * t;
@@ -341,7 +371,7 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 				float crestFactorValTemp = ((m_crestFactorVal[i] - 2.f) * m_autoRelVal) + 2.f;
 
 				const float rel = m_autoRelVal
-					? msToCoeff(2.f * m_compressorControls.m_releaseModel.value() / (crestFactorValTemp))
+					? std::exp(autoRelPrecalc * crestFactorValTemp)
 					: m_relCoeff;
 
 				if (m_holdTimer[i])// Don't change peak if hold is being applied
@@ -371,27 +401,27 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 			// For the visualizer
 			m_displayPeak[i] = qMax(scVal, m_displayPeak[i]);
 
-			const float currentPeakDbfs = ampToDbfs(scVal);
-
 			// Now find the gain change that should be applied,
 			// depending on the measured input value.
-			if (currentPeakDbfs - m_thresholdVal < -m_kneeVal)// Below knee
+			// Only the knee needs the value in dBFS, below it the gain is 1, and above
+			// it the dBFS curve comes down to a power of the value over the threshold.
+			if (scVal < m_kneeStartAmpVal)// Below knee
 			{
-				m_gainResult[i] = currentPeakDbfs;
+				m_gainResult[i] = 1;
 			}
-			else if (currentPeakDbfs - m_thresholdVal < m_kneeVal)// Within knee
+			else if (scVal < m_kneeEndAmpVal)// Within knee
 			{
+				const float currentPeakDbfs = ampToDbfs(scVal);
 				const float temp = currentPeakDbfs - m_thresholdVal + m_kneeVal;
-				m_gainResult[i] = currentPeakDbfs + ((limiter ? 0 : m_ratioVal) - 1) * temp * temp / (4 * m_kneeVal);
+				m_gainResult[i] = dbfsToAmp(currentPeakDbfs + ratioExponent * temp * temp / (4 * m_kneeVal)) / scVal;
 			}
 			else// Above knee
 			{
 				m_gainResult[i] = limiter
-					? m_thresholdVal
-					: m_thresholdVal + (currentPeakDbfs - m_thresholdVal) * m_ratioVal;
+					? m_thresholdAmpVal / scVal
+					: std::pow(scVal / m_thresholdAmpVal, ratioExponent);
 			}
 
-			m_gainResult[i] = dbfsToAmp(m_gainResult[i]) / scVal;
 			m_gainResult[i] = qMax(m_rangeVal, m_gainResult[i]);
 		}
 
@@ -448,8 +478,8 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 		// Bias compression to the left or right (or mid or side)
 		if (stereoBalance != 0)
 		{
-			m_gainResult[0] = 1 - ((1 - m_gainResult[0]) * (stereoBalance > 0 ? 1 - stereoBalance : 1));
-			m_gainResult[1] = 1 - ((1 - m_gainResult[1]) * (stereoBalance < 0 ? 1 + stereoBalance : 1));
+			m_gainResult[0] = 1 - ((1 - m_gainResult[0]) * stereoBalanceGain[0]);
+			m_gainResult[1] = 1 - ((1 - m_gainResult[1]) * stereoBalanceGain[1]);
 		}
 
 		// For visualizer
@@ -479,11 +509,8 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 			s[1] = temp - s[1];
 		}
 
-		s[0] *= inBalance > 0 ? 1 - inBalance : 1;
-		s[1] *= inBalance < 0 ? 1 + inBalance : 1;
-
-		s[0] *= m_gainResult[0] * m_inGainVal * m_outGainVal * (outBalance > 0 ? 1 - outBalance : 1);
-		s[1] *= m_gainResult[1] * m_inGainVal * m_outGainVal * (outBalance < 0 ? 1 + outBalance : 1);
+		s[0] *= inBalanceGain[0] * m_gainResult[0] * outGain[0];
+		s[1] *= inBalanceGain[1] * m_gainResult[1] * outGain[1];
 
 		if (midside)// Convert mid/side back to left/right
 		{
@@ -44,6 +44,7 @@ public:
 	CompressorEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~CompressorEffect() override = default;
 	bool processAudioBuffer(sampleFrame* buf, const fpp_t frames) override;
+	f_cnt_t latency() const override;
 
 	EffectControls* controls() override
 	{
@@ -74,6 +75,7 @@ private:
 	CompressorControls m_compressorControls;
 
 	float msToCoeff(float ms);
+	void calcKneeAmps();
 
 	inline void calcTiltFilter(sample_t inputSample, sample_t &outputSample, int filtNum);
 	inline int realmod(int k, int n);
@@ -135,8 +137,10 @@ private:
 	float m_displayPeak[2];
 	float m_displayGain[2];
 
-	float m_kneeVal;
-	float m_thresholdVal;
+	float m_kneeVal = 0;
+	float m_kneeStartAmpVal;
+	float m_kneeEndAmpVal;
+	float m_thresholdVal = 0;
 	float m_ratioVal;
 
 	bool m_redrawKnee = true;
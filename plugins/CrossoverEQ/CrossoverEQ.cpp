@@ -56,12 +56,9 @@ CrossoverEQEffect::CrossoverEQEffect( Model* parent, const Descriptor::SubPlugin
 	Effect( &crossovereq_plugin_descriptor, parent, key ),
 	m_controls( this ),
 	m_sampleRate( Engine::audioEngine()->processingSampleRate() ),
-	m_lp1( m_sampleRate ),
-	m_lp2( m_sampleRate ),
-	m_lp3( m_sampleRate ),
-	m_hp2( m_sampleRate ),
-	m_hp3( m_sampleRate ),
-	m_hp4( m_sampleRate ),
+	m_xover12( m_sampleRate ),
+	m_xover23( m_sampleRate ),
+	m_xover34( m_sampleRate ),
 	m_needsUpdate( true )
 {
 	m_tmp1 = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() );
@@ -79,12 +76,9 @@ CrossoverEQEffect::~CrossoverEQEffect()
 void CrossoverEQEffect::sampleRateChanged()
 {
 	m_sampleRate = Engine::audioEngine()->processingSampleRate();
-	m_lp1.setSampleRate( m_sampleRate );
-	m_lp2.setSampleRate( m_sampleRate );
-	m_lp3.setSampleRate( m_sampleRate );
-	m_hp2.setSampleRate( m_sampleRate );
-	m_hp3.setSampleRate( m_sampleRate );
-	m_hp4.setSampleRate( m_sampleRate );
+	m_xover12.setSampleRate( m_sampleRate );
+	m_xover23.setSampleRate( m_sampleRate );
+	m_xover34.setSampleRate( m_sampleRate );
 	m_needsUpdate = true;
 }
 
@@ -99,18 +93,15 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	// filters update
 	if( m_needsUpdate || m_controls.m_xover12.isValueChanged() )
 	{
-		m_lp1.setLowpass( m_controls.m_xover12.value() );
-		m_hp2.setHighpass( m_controls.m_xover12.value() );
+		m_xover12.setFrequency( m_controls.m_xover12.value() );
 	}
 	if( m_needsUpdate || m_controls.m_xover23.isValueChanged() )
 	{
-		m_lp2.setLowpass( m_controls.m_xover23.value() );
-		m_hp3.setHighpass( m_controls.m_xover23.value() );
+		m_xover23.setFrequency( m_controls.m_xover23.value() );
 	}
 	if( m_needsUpdate || m_controls.m_xover34.isValueChanged() )
 	{
-		m_lp3.setLowpass( m_controls.m_xover34.value() );
-		m_hp4.setHighpass( m_controls.m_xover34.value() );
+		m_xover34.setFrequency( m_controls.m_xover34.value() );
 	}
 	
 	// gain values update
@@ -131,72 +122,38 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 		m_gain4 = dbfsToAmp( m_controls.m_gain4.value() );
 	}
 	
-	// mute values update
-	const bool mute1 = m_controls.m_mute1.value();
-	const bool mute2 = m_controls.m_mute2.value();
-	const bool mute3 = m_controls.m_mute3.value();
-	const bool mute4 = m_controls.m_mute4.value();
+	// mute values update, a muted band is mixed in with no gain
+	const float gain1 = m_controls.m_mute1.value() ? m_gain1 : 0.0f;
+	const float gain2 = m_controls.m_mute2.value() ? m_gain2 : 0.0f;
+	const float gain3 = m_controls.m_mute3.value() ? m_gain3 : 0.0f;
+	const float gain4 = m_controls.m_mute4.value() ? m_gain4 : 0.0f;
 	
 	m_needsUpdate = false;
 	
-	memset( m_work, 0, sizeof( sampleFrame ) * frames );
-	
-	// run temp bands
+	// split into the four bands, the crossovers run even for muted bands so
+	// their state is up to date once they're unmuted
+	m_xover23.split( buf, m_tmp1, m_tmp2, frames );
+
+	// bands 1 and 2
+	m_xover12.split( m_tmp1, m_tmp1, m_work, frames );
 	for( int f = 0; f < frames; ++f )
 	{
-		m_tmp1[f][0] = m_lp2.update( buf[f][0], 0 );
-		m_tmp1[f][1] = m_lp2.update( buf[f][1], 1 );
-		m_tmp2[f][0] = m_hp3.update( buf[f][0], 0 );
-		m_tmp2[f][1] = m_hp3.update( buf[f][1], 1 );
+		m_work[f][0] = m_tmp1[f][0] * gain1 + m_work[f][0] * gain2;
+		m_work[f][1] = m_tmp1[f][1] * gain1 + m_work[f][1] * gain2;
 	}
 
-	// run band 1
-	if( mute1 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp1.update( m_tmp1[f][0], 0 ) * m_gain1;
-			m_work[f][1] += m_lp1.update( m_tmp1[f][1], 1 ) * m_gain1;
-		}
-	}
-	
-	// run band 2
-	if( mute2 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp2.update( m_tmp1[f][0], 0 ) * m_gain2;
-			m_work[f][1] += m_hp2.update( m_tmp1[f][1], 1 ) * m_gain2;
-		}
-	}
-	
-	// run band 3
-	if( mute3 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp3.update( m_tmp2[f][0], 0 ) * m_gain3;
-			m_work[f][1] += m_lp3.update( m_tmp2[f][1], 1 ) * m_gain3;
-		}
-	}
-	
-	// run band 4
-	if( mute4 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp4.update( m_tmp2[f][0], 0 ) * m_gain4;
-			m_work[f][1] += m_hp4.update( m_tmp2[f][1], 1 ) * m_gain4;
-		}
-	}
+	// bands 3 and 4
+	m_xover34.split( m_tmp2, m_tmp2, m_tmp1, frames );
 	
 	const float d = dryLevel();
 	const float w = wetLevel();
 	double outSum = 0.0;
 	for( int f = 0; f < frames; ++f )
 	{
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
+		const float wet0 = m_work[f][0] + m_tmp2[f][0] * gain3 + m_tmp1[f][0] * gain4;
+		const float wet1 = m_work[f][1] + m_tmp2[f][1] * gain3 + m_tmp1[f][1] * gain4;
+		buf[f][0] = d * buf[f][0] + w * wet0;
+		buf[f][1] = d * buf[f][1] + w * wet1;
 		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
 	}
 	
@@ -207,12 +164,9 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 
 void CrossoverEQEffect::clearFilterHistories()
 {
-	m_lp1.clearHistory();
-	m_lp2.clearHistory();
-	m_lp3.clearHistory();
-	m_hp2.clearHistory();
-	m_hp3.clearHistory();
-	m_hp4.clearHistory();
+	m_xover12.clearHistory();
+	m_xover23.clearHistory();
+	m_xover34.clearHistory();
 }
 
 
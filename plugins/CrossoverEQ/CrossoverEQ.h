@@ -61,13 +61,9 @@ private:
 	float m_gain3;
 	float m_gain4;
 	
-	StereoLinkwitzRiley m_lp1;
-	StereoLinkwitzRiley m_lp2;
-	StereoLinkwitzRiley m_lp3;
-	
-	StereoLinkwitzRiley m_hp2;
-	StereoLinkwitzRiley m_hp3;
-	StereoLinkwitzRiley m_hp4;
+	StereoLinkwitzRileyCrossover m_xover12;
+	StereoLinkwitzRileyCrossover m_xover23;
+	StereoLinkwitzRileyCrossover m_xover34;
 	
 	sampleFrame * m_tmp1;
 	sampleFrame * m_tmp2;
@@ -44,6 +44,13 @@ public:
 	{
 		return &m_delayControls;
 	}
+	f_cnt_t tailLength() const override
+	{
+		// the longest the delay gets with the LFO, as the echoes repeat
+		// until they are inaudible
+		return static_cast<f_cnt_t>( ( m_delayControls.m_delayTimeModel.value()
+			+ m_delayControls.m_lfoAmountModel.value() ) * Engine::audioEngine()->processingSampleRate() );
+	}
 	void changeSampleRate();
 
 private:
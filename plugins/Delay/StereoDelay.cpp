@@ -23,70 +23,29 @@
  */
 
 #include "StereoDelay.h"
-#include "lmms_basics.h"
+
+#include <algorithm>
 
 namespace lmms
 {
 
 
-StereoDelay::StereoDelay( int maxTime, int sampleRate )
+StereoDelay::StereoDelay( int maxTime, int sampleRate ) :
+	m_delay( maxTime * sampleRate )
 {
-	m_buffer = 0;
 	m_maxTime = maxTime;
-	m_maxLength = maxTime * sampleRate;
-	m_length = m_maxLength;
-
-	m_writeIndex = 0;
+	m_length = m_delay.maxDelay();
 	m_feedback = 0.0f;
-	setSampleRate( sampleRate );
 }
 
 
 
 
-StereoDelay::~StereoDelay()
-{
-	if( m_buffer )
-	{
-		delete[] m_buffer;
-	}
-}
-
-
-
-
-void StereoDelay::tick( sampleFrame& frame )
-{
-	m_writeIndex = ( m_writeIndex + 1 ) % ( int )m_maxLength;
-	int readIndex = m_writeIndex - m_length;
-	if (readIndex < 0 ) { readIndex += m_maxLength; }
-	float lOut = m_buffer[ readIndex ][ 0 ];
-	float rOut = m_buffer[ readIndex ] [1 ];
-	m_buffer[ m_writeIndex ][ 0 ] = frame[ 0 ] + ( lOut * m_feedback );
-	m_buffer[ m_writeIndex ][ 1 ] = frame[ 1 ] + ( rOut * m_feedback );
-	frame[ 0 ] = lOut;
-	frame[ 1 ] = rOut;
-}
-
-
-
-
-
-
 void StereoDelay::setSampleRate( int sampleRate )
 {
-	if( m_buffer )
-	{
-		delete[] m_buffer;
-	}
-
-	int bufferSize = ( int )( sampleRate * m_maxTime );
-	m_buffer = new sampleFrame[bufferSize];
-	for( int i = 0 ; i < bufferSize ; i++)
-	{
-		m_buffer[i][0] = 0.0;
-		m_buffer[i][1] = 0.0;
-	}
+	m_delay.setMaxDelay( static_cast<int>( sampleRate * m_maxTime ) );
+	m_delay.clearHistory();
+	m_length = std::min( m_length, static_cast<float>( m_delay.maxDelay() ) );
 }
 
 
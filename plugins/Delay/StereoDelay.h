@@ -25,7 +25,7 @@
 #ifndef STEREODELAY_H
 #define STEREODELAY_H
 
-#include "lmms_basics.h"
+#include "Delay.h"
 
 
 namespace lmms
@@ -35,12 +35,12 @@ class StereoDelay
 {
 public:
 	StereoDelay( int maxLength, int sampleRate );
-	~StereoDelay();
 	inline void setLength( float length )
 	{
-		if( length <= m_maxLength && length >= 0 )
+		// the newest frame that can be read is the one written last
+		if( length <= m_delay.maxDelay() )
 		{
-			m_length = length;
+			m_length = std::max( length, 1.0f );
 		}
 	}
 
@@ -49,14 +49,19 @@ public:
 		m_feedback = feedback;
 	}
 
-	void tick( sampleFrame& frame );
+	inline void tick( sampleFrame& frame )
+	{
+		const auto out = m_delay.tap( m_length );
+		m_delay.write( { frame[0] + out[0] * m_feedback, frame[1] + out[1] * m_feedback } );
+		frame[0] = out[0];
+		frame[1] = out[1];
+	}
+
 	void setSampleRate( int sampleRate );
 
 private:
-	sampleFrame* m_buffer;
-	int m_maxLength;
+	StereoDelayLine m_delay;
 	float m_length;
-	int m_writeIndex;
 	float m_feedback;
 	float m_maxTime;
 };
@@ -25,6 +25,9 @@
 
 #include "DualFilter.h"
 
+#include <algorithm>
+#include <array>
+
 #include "embed.h"
 #include "BasicFilters.h"
 #include "plugin_export.h"
@@ -137,17 +140,14 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 
 
 
-	// buffer processing loop
-	for( fpp_t f = 0; f < frames; ++f )
+	// buffer processing loop, in blocks - the coefficients are recalculated
+	// at the start of a block when cut or res changed
+	constexpr fpp_t BlockFrames = BasicFilters<2>::CoeffUpdateFrames;
+	std::array<sampleFrame, BlockFrames> s1;	// filter 1
+	std::array<sampleFrame, BlockFrames> s2;	// filter 2
+	for( fpp_t start = 0; start < frames; start += BlockFrames )
 	{
-		// get mix amounts for wet signals of both filters
-		const float mix2 = ( ( *mixPtr + 1.0f ) * 0.5f );
-		const float mix1 = 1.0f - mix2;
-		const float gain1 = *gain1Ptr * 0.01f;
-		const float gain2 = *gain2Ptr * 0.01f;
-		auto s = std::array{0.0f, 0.0f};	// mix
-		auto s1 = std::array{buf[f][0], buf[f][1]};	// filter 1
-		auto s2 = std::array{buf[f][0], buf[f][1]};	// filter 2
+		const fpp_t block = std::min<fpp_t>( frames - start, BlockFrames );
 
 		// update filter 1
 		if( enabled1 )
@@ -162,16 +162,8 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 				m_currentCut1 = *cut1Ptr;
 				m_currentRes1 = *res1Ptr;
 			}
-			s1[0] = m_filter1->update( s1[0], 0 );
-			s1[1] = m_filter1->update( s1[1], 1 );
-
-			// apply gain
-			s1[0] *= gain1;
-			s1[1] *= gain1;
-
-			// apply mix
-			s[0] += ( s1[0] * mix1 );
-			s[1] += ( s1[1] * mix1 );
+			std::copy_n( buf + start, block, s1.data() );
+			m_filter1->process( s1.data(), block );
 		}
 
 		// update filter 2
@@ -186,31 +178,50 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 				m_currentCut2 = *cut2Ptr;
 				m_currentRes2 = *res2Ptr;
 			}
-			s2[0] = m_filter2->update( s2[0], 0 );
-			s2[1] = m_filter2->update( s2[1], 1 );
+			std::copy_n( buf + start, block, s2.data() );
+			m_filter2->process( s2.data(), block );
+		}
+
+		for( fpp_t i = 0; i < block; ++i )
+		{
+			const fpp_t f = start + i;
+
+			// get mix amounts for wet signals of both filters
+			const float mix2 = ( ( *mixPtr + 1.0f ) * 0.5f );
+			const float mix1 = 1.0f - mix2;
+			const float gain1 = *gain1Ptr * 0.01f;
+			const float gain2 = *gain2Ptr * 0.01f;
+			auto s = std::array{0.0f, 0.0f};	// mix
+
+			if( enabled1 )
+			{
+				// apply gain and mix
+				s[0] += ( s1[i][0] * gain1 * mix1 );
+				s[1] += ( s1[i][1] * gain1 * mix1 );
+			}
+
+			if( enabled2 )
+			{
+				// apply gain and mix
+				s[0] += ( s2[i][0] * gain2 * mix2 );
+				s[1] += ( s2[i][1] * gain2 * mix2 );
+			}
 
-			//apply gain
-			s2[0] *= gain2;
-			s2[1] *= gain2;
+			// do another mix with dry signal
+			buf[f][0] = d * buf[f][0] + w * s[0];
+			buf[f][1] = d * buf[f][1] + w * s[1];
+			outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
 
-			// apply mix
-			s[0] += ( s2[0] * mix2 );
-			s[1] += ( s2[1] * mix2 );
+			//increment pointers
+			gain1Ptr += gain1Inc;
+			gain2Ptr += gain2Inc;
+			mixPtr += mixInc;
 		}
 
-		// do another mix with dry signal
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-
-		//increment pointers
-		cut1Ptr += cut1Inc;
-		res1Ptr += res1Inc;
-		gain1Ptr += gain1Inc;
-		cut2Ptr += cut2Inc;
-		res2Ptr += res2Inc;
-		gain2Ptr += gain2Inc;
-		mixPtr += mixInc;
+		cut1Ptr += cut1Inc * block;
+		res1Ptr += res1Inc * block;
+		cut2Ptr += cut2Inc * block;
+		res2Ptr += res2Inc * block;
 	}
 
 	checkGate( outSum / frames );
@@ -26,7 +26,6 @@
 
 #include "DynamicsProcessor.h"
 #include "lmms_math.h"
-#include "interpolation.h"
 #include "RmsHelper.h"
 
 #include "embed.h"
@@ -103,10 +102,7 @@ bool DynProcEffect::processAudioBuffer( sampleFrame * _buf,
 	//qDebug( "%f %f", m_currentPeak[0], m_currentPeak[1] );
 
 // variables for effect
-	int i = 0;
-
 	auto sm_peak = std::array{0.0f, 0.0f};
-	float gain;
 
 	double out_sum = 0.0;
 	const float d = dryLevel();
@@ -116,7 +112,7 @@ bool DynProcEffect::processAudioBuffer( sampleFrame * _buf,
 	const float inputGain = m_dpControls.m_inputModel.value();
 	const float outputGain = m_dpControls.m_outputModel.value();
 
-	const float * samples = m_dpControls.m_wavegraphModel.samples();
+	m_curve.update( m_dpControls.m_wavegraphModel.samples(), CurveTable<200>::Beyond::Constant );
 
 // debug code
 //	qDebug( "peaks %f %f", m_currentPeak[0], m_currentPeak[1] );
@@ -141,89 +137,87 @@ bool DynProcEffect::processAudioBuffer( sampleFrame * _buf,
 		}
 	}
 
-	for( fpp_t f = 0; f < _frames; ++f )
+	// the input gain and the RMS are computed for a block of frames at a
+	// time, the peaks have to follow them frame by frame
+	constexpr fpp_t BlockSize = 64;
+	auto in = std::array<std::array<float, BlockSize>, 2>{};
+	auto rms = std::array<std::array<float, BlockSize>, 2>{};
+
+	for( fpp_t block = 0; block < _frames; block += BlockSize )
 	{
-		auto s = std::array{_buf[f][0], _buf[f][1]};
+		const fpp_t frames = std::min<fpp_t>( BlockSize, _frames - block );
 
 // apply input gain
-		s[0] *= inputGain;
-		s[1] *= inputGain;
-
-// update peak values
-		for ( i=0; i <= 1; i++ )
+		for( fpp_t f = 0; f < frames; ++f )
 		{
-			const double t = m_rms[i]->update( s[i] );
-			if( t > m_currentPeak[i] )
-			{
-				m_currentPeak[i] = qMin( m_currentPeak[i] * m_attCoeff, t );
-			}
-			else
-			if( t < m_currentPeak[i] )
-			{
-				m_currentPeak[i] = qMax( m_currentPeak[i] * m_relCoeff, t );
-			}
-
-			m_currentPeak[i] = qBound( DYN_NOISE_FLOOR, m_currentPeak[i], 10.0f );
+			in[0][f] = _buf[block + f][0] * inputGain;
+			in[1][f] = _buf[block + f][1] * inputGain;
 		}
+		m_rms[0]->update( in[0].data(), rms[0].data(), frames );
+		m_rms[1]->update( in[1].data(), rms[1].data(), frames );
 
-// account for stereo mode
-		switch( static_cast<DynProcControls::StereoMode>(stereoMode) )
+		for( fpp_t f = 0; f < frames; ++f )
 		{
-			case DynProcControls::StereoMode::Maximum:
-			{
-				sm_peak[0] = sm_peak[1] = qMax( m_currentPeak[0], m_currentPeak[1] );
-				break;
-			}
-			case DynProcControls::StereoMode::Average:
-			{
-				sm_peak[0] = sm_peak[1] = ( m_currentPeak[0] + m_currentPeak[1] ) * 0.5;
-				break;
-			}
-			case DynProcControls::StereoMode::Unlinked:
-			{
-				sm_peak[0] = m_currentPeak[0];
-				sm_peak[1] = m_currentPeak[1];
-				break;
-			}
-		}
+			auto s = std::array{in[0][f], in[1][f]};
 
-// start effect
+// update peak values
+			for( int i = 0; i <= 1; i++ )
+			{
+				const double t = rms[i][f];
+				if( t > m_currentPeak[i] )
+				{
+					m_currentPeak[i] = qMin( m_currentPeak[i] * m_attCoeff, t );
+				}
+				else
+				if( t < m_currentPeak[i] )
+				{
+					m_currentPeak[i] = qMax( m_currentPeak[i] * m_relCoeff, t );
+				}
 
-		for ( i=0; i <= 1; i++ )
-		{
-			const int lookup = static_cast<int>( sm_peak[i] * 200.0f );
-			const float frac = fraction( sm_peak[i] * 200.0f );
+				m_currentPeak[i] = qBound( DYN_NOISE_FLOOR, m_currentPeak[i], 10.0f );
+			}
 
-			if( sm_peak[i] > DYN_NOISE_FLOOR )
+// account for stereo mode
+			switch( static_cast<DynProcControls::StereoMode>(stereoMode) )
 			{
-				if ( lookup < 1 )
+				case DynProcControls::StereoMode::Maximum:
 				{
-					gain = frac * samples[0];
+					sm_peak[0] = sm_peak[1] = qMax( m_currentPeak[0], m_currentPeak[1] );
+					break;
 				}
-				else
-				if ( lookup < 200 )
+				case DynProcControls::StereoMode::Average:
 				{
-					gain = linearInterpolate( samples[ lookup - 1 ],
-							samples[ lookup ], frac );
+					sm_peak[0] = sm_peak[1] = ( m_currentPeak[0] + m_currentPeak[1] ) * 0.5;
+					break;
 				}
-				else
+				case DynProcControls::StereoMode::Unlinked:
 				{
-					gain = samples[199];
-				};
+					sm_peak[0] = m_currentPeak[0];
+					sm_peak[1] = m_currentPeak[1];
+					break;
+				}
+			}
 
-				s[i] *= gain;
-				s[i] /= sm_peak[i];
+// start effect
+
+			for( int i = 0; i <= 1; i++ )
+			{
+				if( sm_peak[i] > DYN_NOISE_FLOOR )
+				{
+					s[i] *= m_curve( sm_peak[i] ) / sm_peak[i];
+				}
 			}
-		}
 
 // apply output gain
-		s[0] *= outputGain;
-		s[1] *= outputGain;
+			s[0] *= outputGain;
+			s[1] *= outputGain;
 
 // mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0] * _buf[f][0] + _buf[f][1] * _buf[f][1];
+			sampleFrame & frame = _buf[block + f];
+			frame[0] = d * frame[0] + w * s[0];
+			frame[1] = d * frame[1] + w * s[1];
+			out_sum += frame[0] * frame[0] + frame[1] * frame[1];
+		}
 	}
 
 	checkGate( out_sum / _frames );
@@ -27,6 +27,7 @@
 #ifndef DYNPROC_H
 #define DYNPROC_H
 
+#include "CurveTable.h"
 #include "Effect.h"
 #include "DynamicsProcessorControls.h"
 
@@ -66,6 +67,9 @@ private:
 	
 	RmsHelper * m_rms [2];
 
+	//! The gain graph, updated every period
+	CurveTable<200> m_curve;
+
 	friend class DynProcControls;
 
 } ;
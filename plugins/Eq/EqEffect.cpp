@@ -26,6 +26,7 @@
 
 #include "Engine.h"
 #include "lmms_math.h"
+#include "PeriodArena.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -71,7 +72,6 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	//wet/dry controls
 	const float dry = dryLevel();
 	const float wet = wetLevel();
-	auto dryS = std::array<sample_t, 2>{};
 	// setup sample exact controls
 	float hpRes = m_eqControls.m_hpResModel.value();
 	float lowShelfRes = m_eqControls.m_lowShelfResModel.value();
@@ -172,95 +172,75 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	m_eqControls.m_inPeakL = m_eqControls.m_inPeakL < m_inPeak[0] ? m_inPeak[0] : m_eqControls.m_inPeakL;
 	m_eqControls.m_inPeakR = m_eqControls.m_inPeakR < m_inPeak[1] ? m_inPeak[1] : m_eqControls.m_inPeakR;
 
-	float periodProgress = 0.0f; // percentage of period processed
-	for( fpp_t f = 0; f < frames; ++f)
+	//wet dry buffer
+	auto dryS = PeriodAllocator<sampleFrame>::vector( buf, buf + frames );
+
+	if( hpActive )
 	{
-		periodProgress = (float)f / (float)(frames-1);
-		//wet dry buffer
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
-		if( hpActive )
-		{
-			buf[f][0] = m_hp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_hp12.update( buf[f][1], 1, periodProgress );
-
-			if( hp24Active || hp48Active )
-			{
-				buf[f][0] = m_hp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp24.update( buf[f][1], 1, periodProgress );
-			}
-
-			if( hp48Active )
-			{
-				buf[f][0] = m_hp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp480.update( buf[f][1], 1, periodProgress );
-
-				buf[f][0] = m_hp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp481.update( buf[f][1], 1, periodProgress );
-			}
-		}
+		m_hp12.process( buf, frames );
 
-		if( lowShelfActive )
+		if( hp24Active || hp48Active )
 		{
-			buf[f][0] = m_lowShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lowShelf.update( buf[f][1], 1, periodProgress );
+			m_hp24.process( buf, frames );
 		}
 
-		if( para1Active )
+		if( hp48Active )
 		{
-			buf[f][0] = m_para1.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para1.update( buf[f][1], 1, periodProgress );
+			m_hp480.process( buf, frames );
+			m_hp481.process( buf, frames );
 		}
+	}
 
-		if( para2Active )
-		{
-			buf[f][0] = m_para2.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para2.update( buf[f][1], 1, periodProgress );
-		}
+	if( lowShelfActive )
+	{
+		m_lowShelf.process( buf, frames );
+	}
 
-		if( para3Active )
-		{
-			buf[f][0] = m_para3.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para3.update( buf[f][1], 1, periodProgress );
-		}
+	if( para1Active )
+	{
+		m_para1.process( buf, frames );
+	}
 
-		if( para4Active )
-		{
-			buf[f][0] = m_para4.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para4.update( buf[f][1], 1, periodProgress );
-		}
+	if( para2Active )
+	{
+		m_para2.process( buf, frames );
+	}
 
-		if( highShelfActive )
-		{
-			buf[f][0] = m_highShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_highShelf.update( buf[f][1], 1, periodProgress );
-		}
+	if( para3Active )
+	{
+		m_para3.process( buf, frames );
+	}
 
-		if( lpActive ){
-			buf[f][0] = m_lp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lp12.update( buf[f][1], 1, periodProgress );
+	if( para4Active )
+	{
+		m_para4.process( buf, frames );
+	}
 
-			if( lp24Active || lp48Active )
-			{
-				buf[f][0] = m_lp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp24.update( buf[f][1], 1, periodProgress );
-			}
+	if( highShelfActive )
+	{
+		m_highShelf.process( buf, frames );
+	}
 
-			if( lp48Active )
-			{
-				buf[f][0] = m_lp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp480.update( buf[f][1], 1, periodProgress );
+	if( lpActive ){
+		m_lp12.process( buf, frames );
 
-				buf[f][0] = m_lp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp481.update( buf[f][1], 1, periodProgress );
-			}
+		if( lp24Active || lp48Active )
+		{
+			m_lp24.process( buf, frames );
 		}
 
-		//apply wet / dry levels
-		buf[f][1] = ( dry * dryS[1] ) + ( wet * buf[f][1] );
-		buf[f][0] = ( dry * dryS[0] ) + ( wet * buf[f][0] );
-
+		if( lp48Active )
+		{
+			m_lp480.process( buf, frames );
+			m_lp481.process( buf, frames );
+		}
+	}
 
+	//apply wet / dry levels
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		buf[f][1] = ( dry * dryS[f][1] ) + ( wet * buf[f][1] );
+		buf[f][0] = ( dry * dryS[f][0] ) + ( wet * buf[f][0] );
 	}
 
 	sampleFrame outPeak = { 0, 0 };
@@ -273,7 +253,11 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	if(m_eqControls.m_analyseOutModel.value( true ) && outSum > 0 && m_eqControls.isViewVisible() )
 	{
 		m_eqControls.m_outFftBands.analyze( buf, frames );
-		setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
+		// the bands are computed on the analyser's own thread
+		if( m_eqControls.m_outFftBands.takeNewBands() )
+		{
+			setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
+		}
 	}
 	else
 	{
@@ -142,6 +142,33 @@ public:
 	}
 
 
+
+
+	///
+	/// \brief process
+	/// filters a whole period in place, both channels at once,
+	///  crossfading like update() does
+	/// \param buf
+	/// \param frames
+	///
+	inline void process( sampleFrame* buf, fpp_t frames )
+	{
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			const float frameProgress = (float)f / (float)(frames-1);
+			sampleFrame initialF = buf[f];
+			sampleFrame targetF = buf[f];
+			m_biQuadFrameInitial.process( &initialF, 1 );
+			m_biQuadFrameTarget.process( &targetF, 1 );
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				buf[f][ch] = (1.0f-frameProgress) * initialF[ch] + frameProgress * targetF[ch];
+			}
+		}
+		m_biQuadFrameInitial = m_biQuadFrameTarget;
+	}
+
+
 protected:
 	///
 	/// \brief calcCoefficents
@@ -443,11 +470,7 @@ public:
 
 	virtual void processBuffer( sampleFrame* buf, const fpp_t frames )
 	{
-		for ( fpp_t f = 0 ; f < frames ; ++f)
-		{
-			buf[f][0] = update( buf[f][0] , 0);
-			buf[f][1] = update( buf[f][1] , 1);
-		}
+		process( buf, buf, frames );
 	}
 protected:
 
@@ -41,11 +41,17 @@ EqAnalyser::EqAnalyser() :
 	m_framesFilledUp ( 0 ),
 	m_energy ( 0 ),
 	m_sampleRate ( 1 ),
-	m_active ( true )
+	m_active ( true ),
+	m_inProgress ( false ),
+	m_newBands ( false ),
+	m_clearRequested ( false ),
+	m_cleared ( false ),
+	// some periods of the largest size, in case the analysis falls behind
+	m_inputBuffer ( 4 * 4096 ),
+	m_terminate ( false )
 {
-	m_inProgress=false;
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
-	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+	m_fftPlan = realToComplexPlan( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf );
 
 	//initialize Blackman-Harris window, constants taken from
 	//https://en.wikipedia.org/wiki/Window_function#A_list_of_window_functions
@@ -60,7 +66,10 @@ EqAnalyser::EqAnalyser() :
 								+ a2 * cos(4 * F_PI * i / ((float)FFT_BUFFER_SIZE - 1.0))
 								- a3 * cos(6 * F_PI * i / ((float)FFT_BUFFER_SIZE - 1.0)));
 	}
-	clear();
+	memset( m_buffer, 0, sizeof( m_buffer ) );
+	memset( m_bands, 0, sizeof( m_bands ) );
+
+	m_thread = std::thread( &EqAnalyser::run, this );
 }
 
 
@@ -68,7 +77,10 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
-	fftwf_destroy_plan( m_fftPlan );
+	m_terminate = true;
+	m_inputBuffer.wakeAll();
+	m_thread.join();
+
 	fftwf_free( m_specBuf );
 }
 
@@ -80,51 +92,88 @@ void EqAnalyser::analyze( sampleFrame *buf, const fpp_t frames )
 	//only analyse if the view is visible
 	if ( m_active )
 	{
-		m_inProgress=true;
-		const int FFT_BUFFER_SIZE = 2048;
-		fpp_t f = 0;
-		if( frames > FFT_BUFFER_SIZE )
+		m_cleared = false;
+		m_inputBuffer.write( buf, frames, true );
+	}
+}
+
+
+
+
+void EqAnalyser::run()
+{
+	const int FFT_BUFFER_SIZE = 2048;
+	LocklessRingBufferReader<sampleFrame> reader( m_inputBuffer );
+	while( !m_terminate )
+	{
+		// with a timeout, so a wake-up that comes just before the wait can't be missed for good
+		if( reader.empty() ) { reader.waitForData( 100 ); }
+
+		if( m_clearRequested.exchange( false ) )
 		{
 			m_framesFilledUp = 0;
-			f = frames - FFT_BUFFER_SIZE;
-		}
-		// meger channels
-		for( ; f < frames; ++f )
-		{
-			m_buffer[m_framesFilledUp] =
-					( buf[f][0] + buf[f][1] ) * 0.5;
-			++m_framesFilledUp;
+			memset( m_buffer, 0, sizeof( m_buffer ) );
+			m_inProgress = true;
+			memset( m_bands, 0, sizeof( m_bands ) );
+			m_inProgress = false;
 		}
 
-		if( m_framesFilledUp < FFT_BUFFER_SIZE )
+		auto frames = reader.read_max( m_inputBuffer.capacity() );
+		const std::size_t count = frames.size();
+		for( std::size_t f = 0; f < count && m_active; )
 		{
-			m_inProgress = false;
-			return;
+			// meger channels
+			for( ; f < count && m_framesFilledUp < FFT_BUFFER_SIZE; ++f )
+			{
+				m_buffer[m_framesFilledUp] =
+						( frames[f][0] + frames[f][1] ) * 0.5;
+				++m_framesFilledUp;
+			}
+
+			if( m_framesFilledUp == FFT_BUFFER_SIZE ) { computeBands(); }
 		}
+	}
+}
 
-		m_sampleRate = Engine::audioEngine()->processingSampleRate();
-		const int LOWEST_FREQ = 0;
-		const int HIGHEST_FREQ = m_sampleRate / 2;
 
-		//apply FFT window
-		for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
-		{
-			m_buffer[i] = m_buffer[i] * m_fftWindow[i];
-		}
 
-		fftwf_execute( m_fftPlan );
-		absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
 
-		compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
-					   MAX_BANDS,
-					   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
-					   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
-		m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+void EqAnalyser::computeBands()
+{
+	const int FFT_BUFFER_SIZE = 2048;
+	m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	const int LOWEST_FREQ = 0;
+	const int HIGHEST_FREQ = m_sampleRate / 2;
 
-		m_framesFilledUp = 0;
-		m_inProgress = false;
-		m_active = false;
+	//apply FFT window
+	for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
+	{
+		m_buffer[i] = m_buffer[i] * m_fftWindow[i];
 	}
+
+	fftwf_execute_dft_r2c( m_fftPlan, m_buffer, m_specBuf );
+	absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+
+	m_inProgress = true;
+	compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
+				   MAX_BANDS,
+				   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
+				   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
+	m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+	m_inProgress = false;
+	m_newBands = true;
+
+	// the view asks for the next analysis once it has drawn this one
+	m_framesFilledUp = 0;
+	m_active = false;
+}
+
+
+
+
+bool EqAnalyser::takeNewBands()
+{
+	return m_newBands.exchange( false );
 }
 
 
@@ -172,10 +221,12 @@ bool EqAnalyser::getInProgress()
 
 void EqAnalyser::clear()
 {
-	m_framesFilledUp = 0;
+	// the analysis thread drops what it has gathered, only once per pause
+	if( m_cleared ) { return; }
+	m_cleared = true;
 	m_energy = 0;
-	memset( m_buffer, 0, sizeof( m_buffer ) );
-	memset( m_bands, 0, sizeof( m_bands ) );
+	m_clearRequested = true;
+	m_inputBuffer.wakeAll();
 }
 
 
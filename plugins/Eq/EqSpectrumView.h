@@ -25,15 +25,20 @@
 
 #include <QPainterPath>
 #include <QWidget>
+#include <atomic>
+#include <thread>
 
 #include "fft_helpers.h"
 #include "lmms_basics.h"
+#include "LocklessRingBuffer.h"
 
 namespace lmms
 {
 
 
 const int MAX_BANDS = 2048;
+//! Computes the spectrum of what is passed to analyze() on a thread of its own, so
+//! the audio threads only copy the frames into a ring buffer
 class EqAnalyser
 {
 public:
@@ -46,6 +51,9 @@ public:
 
 	void analyze( sampleFrame *buf, const fpp_t frames );
 
+	//! Whether the bands changed since this was last called
+	bool takeNewBands();
+
 	float getEnergy() const;
 	int getSampleRate() const;
 	bool getActive() const;
@@ -53,16 +61,26 @@ public:
 	void setActive(bool active);
 
 private:
+	void run();
+	void computeBands();
+
 	fftwf_plan m_fftPlan;
 	fftwf_complex * m_specBuf;
 	float m_absSpecBuf[FFT_BUFFER_SIZE+1];
 	float m_buffer[FFT_BUFFER_SIZE*2];
 	int m_framesFilledUp;
-	float m_energy;
-	int m_sampleRate;
-	bool m_active;
-	bool m_inProgress;
+	std::atomic<float> m_energy;
+	std::atomic<int> m_sampleRate;
+	std::atomic<bool> m_active;
+	std::atomic<bool> m_inProgress;
+	std::atomic<bool> m_newBands;
+	std::atomic<bool> m_clearRequested;
+	bool m_cleared;
 	float m_fftWindow[FFT_BUFFER_SIZE];
+
+	LocklessRingBuffer<sampleFrame> m_inputBuffer;
+	std::atomic<bool> m_terminate;
+	std::thread m_thread;
 };
 
 
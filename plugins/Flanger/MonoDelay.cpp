@@ -23,45 +23,19 @@
  */
 
 #include "MonoDelay.h"
-#include "string.h"
+
+#include <algorithm>
 
 namespace lmms
 {
 
 
-MonoDelay::MonoDelay( int maxTime , int sampleRate )
+MonoDelay::MonoDelay( int maxTime , int sampleRate ) :
+	m_delay( maxTime * sampleRate )
 {
-	m_buffer = 0;
 	m_maxTime = maxTime;
-	m_maxLength = maxTime * sampleRate;
-	m_length = m_maxLength;
-
-	m_writeIndex = 0;
+	m_length = m_delay.maxDelay();
 	m_feedback = 0.0f;
-	setSampleRate( sampleRate );
-}
-
-
-
-
-MonoDelay::~MonoDelay()
-{
-	if( m_buffer )
-	{
-		delete m_buffer;
-	}
-}
-
-
-
-void MonoDelay::tick( sample_t* sample )
-{
-	m_writeIndex = ( m_writeIndex + 1 ) % ( int )m_maxLength;
-	int readIndex = m_writeIndex - m_length;
-	if (readIndex < 0 ) { readIndex += m_maxLength; }
-	float out = m_buffer[ readIndex ];
-	m_buffer[ m_writeIndex ] = *sample + ( out * m_feedback );
-	*sample = out;
 }
 
 
@@ -69,14 +43,9 @@ void MonoDelay::tick( sample_t* sample )
 
 void MonoDelay::setSampleRate( int sampleRate )
 {
-	if( m_buffer )
-	{
-		delete m_buffer;
-	}
-
-
-	m_buffer = new sample_t[( int )( sampleRate * m_maxTime ) ];
-	memset( m_buffer, 0, sizeof(float) * ( int )( sampleRate * m_maxTime ) );
+	m_delay.setMaxDelay( static_cast<int>( sampleRate * m_maxTime ) );
+	m_delay.clearHistory();
+	m_length = std::min( m_length, static_cast<float>( m_delay.maxDelay() ) );
 }
 
 
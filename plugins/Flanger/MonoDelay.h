@@ -25,7 +25,7 @@
 #ifndef MONODELAY_H
 #define MONODELAY_H
 
-#include "lmms_basics.h"
+#include "Delay.h"
 
 namespace lmms
 {
@@ -35,12 +35,12 @@ class MonoDelay
 {
 public:
 	MonoDelay( int maxTime , int sampleRate );
-	~MonoDelay();
 	inline void setLength( float length )
 	{
-		if( length <= m_maxLength && length >= 0 )
+		// the newest frame that can be read is the one written last
+		if( length <= m_delay.maxDelay() )
 		{
-			m_length = length;
+			m_length = std::max( length, 1.0f );
 		}
 	}
 
@@ -49,14 +49,18 @@ public:
 		m_feedback = feedback;
 	}
 
-	void tick( sample_t* sample );
+	inline void tick( sample_t* sample )
+	{
+		const float out = m_delay.tap( m_length )[0];
+		m_delay.write( { *sample + out * m_feedback } );
+		*sample = out;
+	}
+
 	void setSampleRate( int sampleRate );
 
 private:
-	sample_t* m_buffer;
-	int m_maxLength;
+	DelayLine<1> m_delay;
 	float m_length;
-	int m_writeIndex;
 	float m_feedback;
 	float m_maxTime;
 };
@@ -30,13 +30,16 @@
 
 #include "GigPlayer.h"
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 #include <QDebug>
 #include <QLayout>
 #include <QLabel>
 #include <QDomDocument>
 
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "ConfigManager.h"
 #include "endian_handling.h"
 #include "Engine.h"
@@ -78,6 +81,11 @@ Plugin::Descriptor PLUGIN_EXPORT gigplayer_plugin_descriptor =
 }
 
 
+// Frames of every sample of an instrument loaded when selecting it, ahead
+// of which the rest is streamed
+static constexpr unsigned long PreloadFrames = 32768;
+
+
 
 
 GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
@@ -100,6 +108,8 @@ GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
 	connect( &m_bankNum, SIGNAL( dataChanged() ), this, SLOT( updatePatch() ) );
 	connect( &m_patchNum, SIGNAL( dataChanged() ), this, SLOT( updatePatch() ) );
 	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ), this, SLOT( updateSampleRate() ) );
+
+	m_streamThread = std::thread( &GigInstrument::streamSamples, this );
 }
 
 
@@ -110,7 +120,15 @@ GigInstrument::~GigInstrument()
 	Engine::audioEngine()->removePlayHandlesOfTypes( instrumentTrack(),
 				PlayHandle::Type::NotePlayHandle
 				| PlayHandle::Type::InstrumentPlayHandle );
-	freeInstance();
+
+	{
+		const std::lock_guard<std::mutex> lock( m_streamMutex );
+		m_streamQuit = true;
+	}
+	m_streamWake.notify_one();
+	m_streamThread.join();
+
+	setInstance( nullptr );
 }
 
 
@@ -182,21 +200,30 @@ QString GigInstrument::nodeName() const
 
 
 
-void GigInstrument::freeInstance()
+void GigInstrument::setInstance( GigInstance * instance )
 {
-	QMutexLocker synthLock( &m_synthMutex );
-	QMutexLocker notesLock( &m_notesMutex );
+	GigInstance * oldInstance = nullptr;
 
-	if( m_instance != nullptr )
 	{
-		delete m_instance;
-		m_instance = nullptr;
+		QMutexLocker synthLock( &m_synthMutex );
+		QMutexLocker notesLock( &m_notesMutex );
 
 		// If we're changing instruments, we got to make sure that we
 		// remove all pointers to the old samples and don't try accessing
 		// that instrument again
 		m_instrument = nullptr;
 		m_notes.clear();
+
+		oldInstance = m_instance;
+		m_instance = instance;
+	}
+
+	if( oldInstance != nullptr )
+	{
+		// the streaming thread may still read for the notes, but once it
+		// let go of the file it only finds they're gone
+		const std::lock_guard<std::mutex> fileLock( m_fileMutex );
+		delete oldInstance;
 	}
 }
 
@@ -207,23 +234,22 @@ void GigInstrument::openFile( const QString & _gigFile, bool updateTrackName )
 {
 	emit fileLoading();
 
-	// Remove the current instrument if one is selected
-	freeInstance();
+	// Loading takes a while, and play() only waits for the new instance to
+	// replace the current one
+	GigInstance * instance = nullptr;
 
+	try
 	{
-		QMutexLocker locker( &m_synthMutex );
-
-		try
-		{
-			m_instance = new GigInstance( PathUtil::toAbsolute( _gigFile ) );
-			m_filename = PathUtil::toShortestRelative( _gigFile );
-		}
-		catch( ... )
-		{
-			m_instance = nullptr;
-			m_filename = "";
-		}
+		instance = new GigInstance( PathUtil::toAbsolute( _gigFile ) );
+		m_filename = PathUtil::toShortestRelative( _gigFile );
 	}
+	catch( ... )
+	{
+		instance = nullptr;
+		m_filename = "";
+	}
+
+	setInstance( instance );
 
 	emit fileChanged();
 
@@ -250,8 +276,8 @@ void GigInstrument::updatePatch()
 
 QString GigInstrument::getCurrentPatchName()
 {
-	QMutexLocker locker( &m_synthMutex );
-
+	// Like changing the instance, going through the instruments is only done
+	// on this side, so there's no need to keep play() waiting
 	if( m_instance == nullptr )
 	{
 		return "";
@@ -328,8 +354,17 @@ void GigInstrument::play( sampleFrame * _working_buffer )
 	// Initialize to zeros
 	std::memset( &_working_buffer[0][0], 0, DEFAULT_CHANNELS * frames * sizeof( float ) );
 
-	m_synthMutex.lock();
-	m_notesMutex.lock();
+	// The GUI only holds these for a moment, e.g. to hand over another
+	// instrument, which is worth a period of silence rather than waiting
+	if( !m_synthMutex.tryLock() )
+	{
+		return;
+	}
+	if( !m_notesMutex.tryLock() )
+	{
+		m_synthMutex.unlock();
+		return;
+	}
 
 	if( m_instance == nullptr || m_instrument == nullptr )
 	{
@@ -380,7 +415,7 @@ void GigInstrument::play( sampleFrame * _working_buffer )
 			// notes, or if a release sample, then if we've reached
 			// the end of the sample
 			if( sample->sample == nullptr || sample->adsr.done() ||
-				( it->isRelease == true &&
+				( it->isRelease == true && !sample->loop.enabled &&
 				  sample->pos >= sample->sample->SamplesTotal - 1 ) )
 			{
 				sample = it->samples.erase( sample );
@@ -405,6 +440,7 @@ void GigInstrument::play( sampleFrame * _working_buffer )
 	}
 
 	// Fill buffer with portions of the note samples
+	bool streaming = false;
 	for (auto& note : m_notes)
 	{
 		// Only process the notes if we're in a playing state
@@ -482,12 +518,19 @@ void GigInstrument::play( sampleFrame * _working_buffer )
 			// Update note position with how many samples we actually used
 			sample.pos += used;
 			sample.adsr.inc(used);
+			streaming = streaming || sample.stream != nullptr;
 		}
 	}
 
 	m_notesMutex.unlock();
 	m_synthMutex.unlock();
 
+	// to read ahead what we just used up
+	if( streaming )
+	{
+		wakeStreamThread();
+	}
+
 	// Set gain properly based on volume control
 	for( f_cnt_t i = 0; i < frames; ++i )
 	{
@@ -506,74 +549,39 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 		return;
 	}
 
-	// Determine if we need to loop part of this sample
-	bool loop = false;
-	gig::loop_type_t loopType = gig::loop_type_normal;
-	f_cnt_t loopStart = 0;
-	f_cnt_t loopLength = 0;
-
-	if( sample.region->pSampleLoops != nullptr )
-	{
-		for( uint32_t i = 0; i < sample.region->SampleLoops; ++i )
-		{
-			loop = true;
-			loopType = static_cast<gig::loop_type_t>( sample.region->pSampleLoops[i].LoopType );
-			loopStart = sample.region->pSampleLoops[i].LoopStart;
-			loopLength = sample.region->pSampleLoops[i].LoopLength;
-
-			// Currently only support at max one loop
-			break;
-		}
-	}
-
-	unsigned long allocationsize = samples * sample.sample->FrameSize;
+	const unsigned long frameSize = sample.sample->FrameSize;
+	unsigned long allocationsize = samples * frameSize;
 	int8_t buffer[allocationsize];
 
-	// Load the sample in different ways depending on if we're looping or not
-	if( loop == true && ( sample.pos >= loopStart || sample.pos + samples > loopStart ) )
+	// The preloaded frames come from the cache of the sample, around the
+	// loop too if it's short enough
+	const gig::buffer_t cache = sample.sample->GetCache();
+	const f_cnt_t cached = cache.Size / frameSize;
+	const f_cnt_t streamStart = sample.stream != nullptr
+		? sample.stream->start() : std::numeric_limits<f_cnt_t>::max();
+
+	f_cnt_t loaded = 0;
+	for( ; loaded < samples && sample.pos + loaded < streamStart; ++loaded )
 	{
-		// Calculate the new position based on the type of loop
-		if( loopType == gig::loop_type_bidirectional )
+		const f_cnt_t frame = sample.loop.frameAt( sample.pos + loaded );
+		if( frame < cached )
 		{
-			sample.pos = getPingPongIndex( sample.pos, loopStart, loopStart + loopLength );
+			std::memcpy( &buffer[loaded * frameSize],
+				static_cast<int8_t*>( cache.pStart ) + frame * frameSize, frameSize );
 		}
 		else
 		{
-			sample.pos = getLoopedIndex( sample.pos, loopStart, loopStart + loopLength );
-			// TODO: also implement loop_type_backward support
+			std::memset( &buffer[loaded * frameSize], 0, frameSize );
 		}
-
-		sample.sample->SetPos( sample.pos );
-
-		// Load the samples (based on gig::Sample::ReadAndLoop) even around the end
-		// of a loop boundary wrapping to the beginning of the loop region
-		long samplestoread = samples;
-		long samplestoloopend = 0;
-		long readsamples = 0;
-		long totalreadsamples = 0;
-		long loopEnd = loopStart + loopLength;
-
-		do
-		{
-			samplestoloopend = loopEnd - sample.sample->GetPos();
-			readsamples = sample.sample->Read( &buffer[totalreadsamples * sample.sample->FrameSize],
-					std::min( samplestoread, samplestoloopend ) );
-			samplestoread -= readsamples;
-			totalreadsamples += readsamples;
-
-			if( readsamples >= samplestoloopend )
-			{
-				sample.sample->SetPos( loopStart );
-			}
-		}
-		while( samplestoread > 0 && readsamples > 0 );
 	}
-	else
-	{
-		sample.sample->SetPos( sample.pos );
 
-		unsigned long size = sample.sample->Read( &buffer, samples ) * sample.sample->FrameSize;
-		std::memset( (int8_t*) &buffer + size, 0, allocationsize - size );
+	// The rest was read by the streaming thread, and if it didn't get so far
+	// yet we'd rather output silence than wait for the disk
+	if( loaded < samples )
+	{
+		sample.stream->release( sample.pos );
+		loaded += sample.stream->read( sample.pos + loaded, &buffer[loaded * frameSize], samples - loaded );
+		std::memset( &buffer[loaded * frameSize], 0, ( samples - loaded ) * frameSize );
 	}
 
 	// Convert from 16 or 24 bit into 32-bit float
@@ -634,39 +642,6 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 
 
 
-// These two loop index functions taken from SampleBuffer.cpp
-f_cnt_t GigInstrument::getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const
-{
-	if( index < endf )
-	{
-		return index;
-	}
-
-	return startf + ( index - startf )
-				% ( endf - startf );
-}
-
-
-
-
-f_cnt_t GigInstrument::getPingPongIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const
-{
-	if( index < endf )
-	{
-		return index;
-	}
-
-	const f_cnt_t looplen = endf - startf;
-	const f_cnt_t looppos = ( index - endf ) % ( looplen * 2 );
-
-	return ( looppos < looplen )
-		? endf - looppos
-		: startf + ( looppos - looplen );
-}
-
-
-
-
 // A key has been released
 void GigInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
@@ -762,6 +737,12 @@ void GigInstrument::addSamples( GigNote & gignote, bool wantReleaseSample )
 
 				gignote.samples.push_back( GigSample( pSample, pDimRegion,
 							attenuation, m_interpolation, gignote.frequency ) );
+
+				if( gignote.samples.back().stream != nullptr )
+				{
+					const std::lock_guard<std::mutex> lock( m_streamMutex );
+					m_newStreams.push_back( gignote.samples.back().stream );
+				}
 			}
 		}
 
@@ -859,8 +840,8 @@ void GigInstrument::getInstrument()
 	int iBankSelected = m_bankNum.value();
 	int iProgSelected = m_patchNum.value();
 
-	QMutexLocker locker( &m_synthMutex );
-
+	// Only we change the instance, so finding the instrument and preloading
+	// its samples doesn't need play() to wait
 	if( m_instance != nullptr )
 	{
 		gig::Instrument * pInstrument = m_instance->gig.GetFirstInstrument();
@@ -878,6 +859,13 @@ void GigInstrument::getInstrument()
 			pInstrument = m_instance->gig.GetNextInstrument();
 		}
 
+		// The current one is preloaded, and play() goes through its regions
+		if( pInstrument != nullptr && pInstrument != m_instrument )
+		{
+			preloadSamples( pInstrument );
+		}
+
+		QMutexLocker locker( &m_synthMutex );
 		m_instrument = pInstrument;
 	}
 }
@@ -885,6 +873,108 @@ void GigInstrument::getInstrument()
 
 
 
+// Note: this may take a while for large instruments, but otherwise their
+// notes would wait for the disk right away
+void GigInstrument::preloadSamples( gig::Instrument * pInstrument )
+{
+	const std::lock_guard<std::mutex> fileLock( m_fileMutex );
+
+	for( gig::Region * pRegion = pInstrument->GetFirstRegion(); pRegion != nullptr;
+			pRegion = pInstrument->GetNextRegion() )
+	{
+		for( uint32_t i = 0; i < pRegion->DimensionRegions; ++i )
+		{
+			gig::Sample * pSample = pRegion->pDimensionRegions[i]->pSample;
+
+			// Samples may be shared by regions and instruments
+			if( pSample == nullptr || pSample->GetCache().Size != 0 )
+			{
+				continue;
+			}
+
+			try
+			{
+				pSample->LoadSampleData( PreloadFrames );
+			}
+			catch( ... )
+			{
+				// Then it's streamed from the start
+				qWarning() << "Failed to preload GIG sample" << QString::fromStdString( pSample->pInfo->Name );
+			}
+		}
+	}
+}
+
+
+
+
+// Reads ahead what the notes play of their samples, whenever play() used up
+// some of it
+void GigInstrument::streamSamples()
+{
+	AudioEngineWorkerThread::avoidWorkerCores();
+
+	std::vector<std::weak_ptr<GigSampleStream>> streams;
+
+	while( true )
+	{
+		{
+			std::unique_lock<std::mutex> lock( m_streamMutex );
+			m_streamWake.wait( lock, [this] { return m_streamRequested || m_streamQuit; } );
+
+			if( m_streamQuit )
+			{
+				return;
+			}
+
+			m_streamRequested = false;
+			streams.insert( streams.end(), m_newStreams.begin(), m_newStreams.end() );
+			m_newStreams.clear();
+		}
+
+		auto it = streams.begin();
+		while( it != streams.end() )
+		{
+			// Once we have the file, the notes are either still there or
+			// they're gone, maybe with the instance they belonged to
+			const std::lock_guard<std::mutex> fileLock( m_fileMutex );
+			const std::shared_ptr<GigSampleStream> stream = it->lock();
+
+			bool done = stream == nullptr;
+			if( !done )
+			{
+				try
+				{
+					while( stream->fill() ) {}
+				}
+				catch( ... )
+				{
+					// The note plays silence from here on
+					qWarning( "Failed to stream GIG sample" );
+					done = true;
+				}
+			}
+
+			it = done ? streams.erase( it ) : it + 1;
+		}
+	}
+}
+
+
+
+
+void GigInstrument::wakeStreamThread()
+{
+	{
+		const std::lock_guard<std::mutex> lock( m_streamMutex );
+		m_streamRequested = true;
+	}
+	m_streamWake.notify_one();
+}
+
+
+
+
 // Since the sample rate changes when we start an export, clear all the
 // currently-playing notes when we get this signal. Then, the export won't
 // include leftover notes that were playing in the program.
@@ -1082,6 +1172,166 @@ void GigInstrumentView::showPatchDialog()
 } // namespace gui
 
 
+f_cnt_t GigLoop::frameAt( f_cnt_t pos ) const
+{
+	if( !enabled || pos < end )
+	{
+		return pos;
+	}
+
+	const f_cnt_t length = end - start;
+
+	if( !pingPong )
+	{
+		return start + ( pos - start ) % length;
+	}
+
+	// Backward from the end of the loop to its start, then forward again
+	const f_cnt_t looppos = ( pos - end ) % ( length * 2 );
+
+	return ( looppos < length )
+		? end - 1 - looppos
+		: start + ( looppos - length );
+}
+
+
+
+
+GigSampleStream::GigSampleStream( gig::Sample * pSample, const GigLoop & loop, f_cnt_t start ) :
+	m_sample( pSample ),
+	m_loop( loop ),
+	m_start( start ),
+	m_ring( Size * pSample->FrameSize ),
+	m_chunk( ChunkSize * pSample->FrameSize ),
+	m_written( start ),
+	m_released( start )
+{
+}
+
+
+
+
+f_cnt_t GigSampleStream::read( f_cnt_t pos, int8_t * buffer, f_cnt_t frames ) const
+{
+	const f_cnt_t written = m_written.load( std::memory_order_acquire );
+	const f_cnt_t available = std::clamp<f_cnt_t>( written - pos, 0, frames );
+	const unsigned long frameSize = m_sample->FrameSize;
+
+	// The ring may wrap around in between
+	const f_cnt_t slot = pos % Size;
+	const f_cnt_t first = std::min( available, Size - slot );
+	std::memcpy( buffer, &m_ring[slot * frameSize], first * frameSize );
+	std::memcpy( buffer + first * frameSize, m_ring.data(), ( available - first ) * frameSize );
+
+	return available;
+}
+
+
+
+
+void GigSampleStream::release( f_cnt_t pos )
+{
+	if( pos > m_released.load( std::memory_order_relaxed ) )
+	{
+		m_released.store( pos, std::memory_order_release );
+	}
+}
+
+
+
+
+bool GigSampleStream::fill()
+{
+	const f_cnt_t released = m_released.load( std::memory_order_acquire );
+	// If we fell behind, what was already played doesn't need reading
+	const f_cnt_t written = std::max( m_written.load( std::memory_order_relaxed ), released );
+
+	if( written + ChunkSize > released + Size ||
+		( !m_loop.enabled && written >= static_cast<f_cnt_t>( m_sample->SamplesTotal ) ) )
+	{
+		return false;
+	}
+
+	// The frames in the order they're played: runs of them going forward,
+	// or backward through a ping-pong loop
+	const unsigned long frameSize = m_sample->FrameSize;
+	f_cnt_t done = 0;
+	while( done < ChunkSize )
+	{
+		const f_cnt_t frame = m_loop.frameAt( written + done );
+		int8_t * out = &m_chunk[done * frameSize];
+
+		f_cnt_t forward = 1;
+		while( done + forward < ChunkSize && m_loop.frameAt( written + done + forward ) == frame + forward )
+		{
+			++forward;
+		}
+
+		f_cnt_t backward = 1;
+		while( forward == 1 && done + backward < ChunkSize &&
+			m_loop.frameAt( written + done + backward ) == frame - backward )
+		{
+			++backward;
+		}
+
+		if( backward > 1 )
+		{
+			copyFrames( frame - backward + 1, backward, out );
+			for( f_cnt_t i = 0; i < backward / 2; ++i )
+			{
+				std::swap_ranges( out + i * frameSize, out + ( i + 1 ) * frameSize,
+					out + ( backward - 1 - i ) * frameSize );
+			}
+			done += backward;
+		}
+		else
+		{
+			copyFrames( frame, forward, out );
+			done += forward;
+		}
+	}
+
+	// Into the ring, which may wrap around in between
+	const f_cnt_t slot = written % Size;
+	const f_cnt_t first = std::min( ChunkSize, Size - slot );
+	std::memcpy( &m_ring[slot * frameSize], m_chunk.data(), first * frameSize );
+	std::memcpy( m_ring.data(), &m_chunk[first * frameSize], ( ChunkSize - first ) * frameSize );
+
+	m_written.store( written + ChunkSize, std::memory_order_release );
+	return true;
+}
+
+
+
+
+// Copies frames going forward from frame on: what's preloaded from the cache,
+// what isn't from the file, and silence after the end of the sample
+void GigSampleStream::copyFrames( f_cnt_t frame, f_cnt_t frames, int8_t * buffer )
+{
+	const unsigned long frameSize = m_sample->FrameSize;
+	const f_cnt_t total = m_sample->SamplesTotal;
+	const gig::buffer_t cache = m_sample->GetCache();
+
+	const f_cnt_t fromCache = std::clamp<f_cnt_t>( static_cast<f_cnt_t>( cache.Size / frameSize ) - frame, 0, frames );
+	if( fromCache > 0 )
+	{
+		std::memcpy( buffer, static_cast<int8_t*>( cache.pStart ) + frame * frameSize, fromCache * frameSize );
+	}
+
+	f_cnt_t fromFile = 0;
+	if( fromCache < frames && frame + fromCache < total )
+	{
+		m_sample->SetPos( frame + fromCache );
+		fromFile = m_sample->Read( buffer + fromCache * frameSize,
+			std::min( frames - fromCache, total - frame - fromCache ) );
+	}
+
+	std::memset( buffer + ( fromCache + fromFile ) * frameSize, 0, ( frames - fromCache - fromFile ) * frameSize );
+}
+
+
+
+
 // Store information related to playing a sample from the GIG file
 GigSample::GigSample( gig::Sample * pSample, gig::DimensionRegion * pDimRegion,
 		float attenuation, int interpolation, float desiredFreq )
@@ -1111,6 +1361,25 @@ GigSample::GigSample( gig::Sample * pSample, gig::DimensionRegion * pDimRegion,
 		// resampling the note so that a 1.5 second release ends up being 1.5
 		// seconds after resampling
 		adsr = ADSR( region, sample->SamplesPerSecond / freqFactor );
+
+		// Currently only support at max one loop
+		if( region->pSampleLoops != nullptr && region->SampleLoops > 0 &&
+			region->pSampleLoops[0].LoopLength > 0 )
+		{
+			loop.enabled = true;
+			loop.pingPong = region->pSampleLoops[0].LoopType == gig::loop_type_bidirectional;
+			loop.start = region->pSampleLoops[0].LoopStart;
+			loop.end = loop.start + region->pSampleLoops[0].LoopLength;
+			// TODO: also implement loop_type_backward support
+		}
+
+		// What's preloaded is played from memory, including a loop that
+		// ends in there, the rest is streamed
+		const f_cnt_t cached = sample->GetCache().Size / sample->FrameSize;
+		if( cached < static_cast<f_cnt_t>( sample->SamplesTotal ) && !( loop.enabled && loop.end <= cached ) )
+		{
+			stream = std::make_shared<GigSampleStream>( sample, loop, cached );
+		}
 	}
 }
 
@@ -1130,7 +1399,7 @@ GigSample::~GigSample()
 
 GigSample::GigSample( const GigSample& g )
 	: sample( g.sample ), region( g.region ), attenuation( g.attenuation ),
-	  adsr( g.adsr ), pos( g.pos ), interpolation( g.interpolation ),
+	  adsr( g.adsr ), loop( g.loop ), pos( g.pos ), stream( g.stream ), interpolation( g.interpolation ),
 	  srcState( nullptr ), sampleFreq( g.sampleFreq ), freqFactor( g.freqFactor )
 {
 	// On the copy, we want to create the object
@@ -1146,7 +1415,9 @@ GigSample& GigSample::operator=( const GigSample& g )
 	region= g.region;
 	attenuation = g.attenuation;
 	adsr = g.adsr;
+	loop = g.loop;
 	pos = g.pos;
+	stream = g.stream;
 	interpolation = g.interpolation;
 	srcState = nullptr;
 	sampleFreq = g.sampleFreq;
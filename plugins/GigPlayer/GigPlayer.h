@@ -30,7 +30,13 @@
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <samplerate.h>
+#include <thread>
+#include <vector>
 
 #include "Instrument.h"
 #include "PixmapButton.h"
@@ -143,6 +149,67 @@ public:
 
 
 
+// The loop of a sample, if it has one. Only one loop per sample is supported.
+struct GigLoop
+{
+	bool enabled = false;
+	bool pingPong = false;
+	f_cnt_t start = 0;
+	f_cnt_t end = 0;
+
+	// The frame of the sample played at a position, counted from the start
+	// of the note
+	f_cnt_t frameAt( f_cnt_t pos ) const;
+} ;
+
+
+
+
+// The part of a sample that isn't preloaded, read by the streaming thread of
+// GigInstrument ahead of the note playing it, so play() never waits for the
+// disk. Holds the frames in the order they're played, with the loop applied.
+class GigSampleStream
+{
+public:
+	GigSampleStream( gig::Sample * pSample, const GigLoop & loop, f_cnt_t start );
+
+	// The first position that's streamed, the ones before are preloaded
+	f_cnt_t start() const
+	{
+		return m_start;
+	}
+
+	// Copies the frames from pos on the streaming thread got to, up to
+	// frames of them, and returns how many (audio thread)
+	f_cnt_t read( f_cnt_t pos, int8_t * buffer, f_cnt_t frames ) const;
+
+	// The frames before pos won't be read any more (audio thread)
+	void release( f_cnt_t pos );
+
+	// Reads the next frames if there's room for them, returns whether there
+	// was (streaming thread, with the file locked)
+	bool fill();
+
+	// Frames read ahead at most, and frames read at once
+	static constexpr f_cnt_t Size = 32768;
+	static constexpr f_cnt_t ChunkSize = 4096;
+
+private:
+	void copyFrames( f_cnt_t frame, f_cnt_t frames, int8_t * buffer );
+
+	gig::Sample * m_sample;
+	GigLoop m_loop;
+	f_cnt_t m_start;
+
+	std::vector<int8_t> m_ring;
+	std::vector<int8_t> m_chunk;
+	std::atomic<f_cnt_t> m_written;
+	std::atomic<f_cnt_t> m_released;
+} ;
+
+
+
+
 // The sample from the GIG file with our current position in both the sample
 // and the envelope
 class GigSample
@@ -165,10 +232,15 @@ public:
 	gig::DimensionRegion * region;
 	float attenuation;
 	ADSR adsr;
+	GigLoop loop;
 
-	// The position in sample
+	// The position in sample, counted from the start of the note, so it keeps
+	// going up when looping (see GigLoop::frameAt())
 	f_cnt_t pos;
 
+	// What isn't preloaded of the sample, if there's anything
+	std::shared_ptr<GigSampleStream> stream;
+
 	// Whether to change the pitch of the samples, e.g. if there's only one
 	// sample per octave and you want that sample pitch shifted for the rest of
 	// the notes in the octave, this will be true
@@ -302,6 +374,18 @@ private:
 	QMutex m_synthMutex;
 	QMutex m_notesMutex;
 
+	// libgig keeps the position in the file, so only one thread at a time
+	// may read it
+	std::mutex m_fileMutex;
+
+	// The thread streaming the samples of the notes, woken up by play()
+	std::thread m_streamThread;
+	std::mutex m_streamMutex;
+	std::condition_variable m_streamWake;
+	bool m_streamRequested = false;
+	bool m_streamQuit = false;
+	std::vector<std::weak_ptr<GigSampleStream>> m_newStreams;
+
 	// Used for resampling
 	int m_interpolation;
 
@@ -313,8 +397,8 @@ private:
 	float m_currentKeyDimension;
 
 private:
-	// Delete the current GIG instance if one is open
-	void freeInstance();
+	// Replace the current GIG instance, if one is open, and delete it
+	void setInstance( GigInstance * instance );
 
 	// Open the instrument in the currently-open GIG file
 	void getInstrument();
@@ -323,10 +407,15 @@ private:
 	// parameters such as velocity
 	Dimension getDimensions( gig::Region * pRegion, int velocity, bool release );
 
-	// Load sample data from the Gig file, looping the sample where needed
+	// Load sample data from memory, the preloaded or the streamed frames,
+	// looping the sample where needed
 	void loadSample( GigSample& sample, sampleFrame* sampleData, f_cnt_t samples );
-	f_cnt_t getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
-	f_cnt_t getPingPongIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
+
+	// Load the first frames of every sample of the instrument into memory,
+	// the rest is streamed while playing
+	void preloadSamples( gig::Instrument * pInstrument );
+	void streamSamples();
+	void wakeStreamThread();
 
 	// Add the desired samples to the note, either normal samples or release
 	// samples
@@ -26,6 +26,11 @@
 #include "Kicker.h"
 
 #include <QDomElement>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
 
 #include "AudioEngine.h"
 #include "Engine.h"
@@ -34,6 +39,8 @@
 #include "LedCheckBox.h"
 #include "NotePlayHandle.h"
 #include "KickerOsc.h"
+#include "RenderCache.h"
+#include "SampleBuffer.h"
 #include "TempoSyncKnob.h"
 
 #include "embed.h"
@@ -155,36 +162,112 @@ QString KickerInstrument::nodeName() const
 using DistFX = DspEffectLibrary::Distortion;
 using SweepOsc = KickerOsc<DspEffectLibrary::MonoToStereoAdaptor<DistFX>>;
 
+namespace
+{
+
+//! A kick played back from the RenderCache, or rendered by its own oscillator
+struct KickerNote
+{
+	RenderCache::Key key{"Kicker"};
+	f_cnt_t length = 0;
+	sample_rate_t sampleRate = 0;
+	std::shared_ptr<const SampleBuffer> cached;
+	std::unique_ptr<SweepOsc> osc;
+	//! What the oscillator rendered so far, while it's recorded for the cache
+	std::vector<sampleFrame> recorded;
+	bool recording = false;
+	f_cnt_t played = 0;
+
+	void record( const sampleFrame* frames, f_cnt_t count )
+	{
+		count = std::min<f_cnt_t>( count, length - static_cast<f_cnt_t>( recorded.size() ) );
+		recorded.insert( recorded.end(), frames, frames + count );
+		if( static_cast<f_cnt_t>( recorded.size() ) >= length )
+		{
+			RenderCache::put( key, std::make_shared<const SampleBuffer>( std::move( recorded ), sampleRate ) );
+			recording = false;
+		}
+	}
+};
+
+} // namespace
+
+
+
+
 void KickerInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
-	const float decfr = m_decayModel.value() * Engine::audioEngine()->processingSampleRate() / 1000.0f;
+	const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+	const float decfr = m_decayModel.value() * sampleRate / 1000.0f;
 	const f_cnt_t tfp = _n->totalFramesPlayed();
 
 	if (!_n->m_pluginData)
 	{
-		_n->m_pluginData = new SweepOsc(
-					DistFX( m_distModel.value(),
-							m_gainModel.value() ),
-					m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value(),
-					m_endNoteModel.value() ? _n->frequency() : m_endFreqModel.value(),
-					m_noiseModel.value() * m_noiseModel.value(),
-					m_clickModel.value() * 0.25f,
-					m_slopeModel.value(),
-					m_envModel.value(),
-					m_distModel.value(),
-					m_distEndModel.value(),
-					decfr );
+		const float startFreq = m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value();
+		const float endFreq = m_endNoteModel.value() ? _n->frequency() : m_endFreqModel.value();
+
+		// it's silent after decaying, so that's all there is to cache
+		auto note = new KickerNote;
+		note->length = static_cast<f_cnt_t>( std::ceil( decfr ) );
+		note->sampleRate = sampleRate;
+		note->key << startFreq << endFreq << m_distModel.value() << m_distEndModel.value()
+			<< m_gainModel.value() << m_clickModel.value() << m_slopeModel.value() << m_envModel.value()
+			<< note->length << sampleRate;
+
+		// noise is different for every kick
+		const bool deterministic = m_noiseModel.value() == 0.0f;
+		if( deterministic )
+		{
+			note->cached = RenderCache::get( note->key );
+		}
+		if( !note->cached )
+		{
+			note->osc = std::make_unique<SweepOsc>(
+						DistFX( m_distModel.value(),
+								m_gainModel.value() ),
+						startFreq,
+						endFreq,
+						m_noiseModel.value() * m_noiseModel.value(),
+						m_clickModel.value() * 0.25f,
+						m_slopeModel.value(),
+						m_envModel.value(),
+						m_distModel.value(),
+						m_distEndModel.value(),
+						decfr );
+			note->recording = deterministic;
+			if( note->recording )
+			{
+				note->recorded.reserve( note->length );
+			}
+		}
+		_n->m_pluginData = note;
 	}
 	else if( tfp > decfr && !_n->isReleased() )
 	{
 		_n->noteOff();
 	}
 
-	auto so = static_cast<SweepOsc*>(_n->m_pluginData);
-	so->update( _working_buffer + offset, frames, Engine::audioEngine()->processingSampleRate() );
+	auto note = static_cast<KickerNote*>(_n->m_pluginData);
+	if( note->cached )
+	{
+		const auto available = static_cast<f_cnt_t>( note->cached->size() );
+		const auto count = note->played < available
+			? std::min<f_cnt_t>( available - note->played, frames ) : 0;
+		std::copy_n( note->cached->data() + note->played, count, _working_buffer + offset );
+		std::fill_n( _working_buffer + offset + count, frames - count, sampleFrame{} );
+	}
+	else
+	{
+		note->osc->update( _working_buffer + offset, frames, sampleRate );
+		if( note->recording )
+		{
+			note->record( _working_buffer + offset, frames );
+		}
+	}
+	note->played += frames;
 
 	if( _n->isReleased() )
 	{
@@ -204,7 +287,17 @@ void KickerInstrument::playNote( NotePlayHandle * _n,
 
 void KickerInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<SweepOsc *>( _n->m_pluginData );
+	auto note = static_cast<KickerNote*>( _n->m_pluginData );
+
+	// a note that was shorter than the kick still gets all of it cached
+	std::array<sampleFrame, DEFAULT_BUFFER_SIZE> rest;
+	while( note->recording )
+	{
+		note->osc->update( rest.data(), DEFAULT_BUFFER_SIZE, note->sampleRate );
+		note->record( rest.data(), DEFAULT_BUFFER_SIZE );
+	}
+
+	delete note;
 }
 
 
@@ -26,6 +26,8 @@
 #ifndef KICKER_OSC_H
 #define KICKER_OSC_H
 
+#include <algorithm>
+
 #include "DspEffectLibrary.h"
 #include "Oscillator.h"
 
@@ -64,31 +66,60 @@ public:
 
 	void update( sampleFrame* buf, const fpp_t frames, const float sampleRate )
 	{
-		for( fpp_t frame = 0; frame < frames; ++frame )
+		// the envelopes are smooth enough that working them out at the ends of
+		// a few frames and interpolating in between can't be heard, and saves
+		// two fastPow() per frame
+		for( fpp_t start = 0; start < frames; start += EnvelopeFrames )
 		{
-			const double gain = ( 1 - fastPow( ( m_counter < m_length ) ? m_counter / m_length : 1, m_env ) );
-			const sample_t s = ( Oscillator::sinSample( m_phase ) * ( 1 - m_noise ) ) + ( Oscillator::noiseSample( 0 ) * gain * gain * m_noise );
-			buf[frame][0] = s * gain;
-			buf[frame][1] = s * gain;
-			
-			// update distortion envelope if necessary
-			if( m_hasDistEnv && m_counter < m_length )
+			const fpp_t count = std::min<fpp_t>( EnvelopeFrames, frames - start );
+
+			const double startGain = gainAt( m_counter );
+			const double gainStep = ( gainAt( m_counter + count ) - startGain ) / count;
+			// m_freq is always that of the frame before
+			const double endFreq = freqAt( m_counter + count - 1 );
+			const double freqStep = ( endFreq - m_freq ) / count;
+
+			for( fpp_t frame = start; frame < start + count; ++frame )
 			{
-				float thres = linearInterpolate( m_distStart, m_distEnd, m_counter / m_length );
-				m_FX.leftFX().setThreshold( thres );
-				m_FX.rightFX().setThreshold( thres );
+				const double gain = startGain + gainStep * ( frame - start );
+				const sample_t s = ( Oscillator::sinSample( m_phase ) * ( 1 - m_noise ) ) + ( Oscillator::noiseSample( 0 ) * gain * gain * m_noise );
+				buf[frame][0] = s * gain;
+				buf[frame][1] = s * gain;
+
+				// update distortion envelope if necessary
+				if( m_hasDistEnv && m_counter < m_length )
+				{
+					float thres = linearInterpolate( m_distStart, m_distEnd, m_counter / m_length );
+					m_FX.leftFX().setThreshold( thres );
+					m_FX.rightFX().setThreshold( thres );
+				}
+
+				m_FX.nextSample( buf[frame][0], buf[frame][1] );
+				m_phase += m_freq / sampleRate;
+
+				m_freq += freqStep;
+				++m_counter;
 			}
-			
-			m_FX.nextSample( buf[frame][0], buf[frame][1] );
-			m_phase += m_freq / sampleRate;
-
-			const double change = ( m_counter < m_length ) ? ( ( m_startFreq - m_endFreq ) * ( 1 - fastPow( m_counter / m_length, m_slope ) ) ) : 0;
-			m_freq = m_endFreq + change;
-			++m_counter;
+			m_freq = endFreq;
 		}
 	}
 
 
+private:
+	//! How many frames the envelopes are interpolated over
+	static constexpr fpp_t EnvelopeFrames = 16;
+
+	double gainAt( const unsigned long counter ) const
+	{
+		return 1 - fastPow( ( counter < m_length ) ? counter / m_length : 1, m_env );
+	}
+
+	double freqAt( const unsigned long counter ) const
+	{
+		const double change = ( counter < m_length ) ? ( ( m_startFreq - m_endFreq ) * ( 1 - fastPow( counter / m_length, m_slope ) ) ) : 0;
+		return m_endFreq + change;
+	}
+
 private:
 	float m_phase;
 	const float m_startFreq;
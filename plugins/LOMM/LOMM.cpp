@@ -51,10 +51,8 @@ LOMMEffect::LOMMEffect(Model* parent, const Descriptor::SubPluginFeatures::Key*
 	Effect(&lomm_plugin_descriptor, parent, key),
 	m_lommControls(this),
 	m_sampleRate(Engine::audioEngine()->processingSampleRate()),
-	m_lp1(m_sampleRate),
-	m_lp2(m_sampleRate),
-	m_hp1(m_sampleRate),
-	m_hp2(m_sampleRate),
+	m_crossover1(m_sampleRate),
+	m_crossover2(m_sampleRate),
 	m_ap(m_sampleRate),
 	m_needsUpdate(true),
 	m_coeffPrecalc(-0.05),
@@ -77,10 +75,8 @@ LOMMEffect::LOMMEffect(Model* parent, const Descriptor::SubPluginFeatures::Key*
 void LOMMEffect::changeSampleRate()
 {
 	m_sampleRate = Engine::audioEngine()->processingSampleRate();
-	m_lp1.setSampleRate(m_sampleRate);
-	m_lp2.setSampleRate(m_sampleRate);
-	m_hp1.setSampleRate(m_sampleRate);
-	m_hp2.setSampleRate(m_sampleRate);
+	m_crossover1.setSampleRate(m_sampleRate);
+	m_crossover2.setSampleRate(m_sampleRate);
 	m_ap.setSampleRate(m_sampleRate);
 	
 	m_coeffPrecalc = -2.2f / (m_sampleRate * 0.001f);
@@ -100,6 +96,12 @@ void LOMMEffect::changeSampleRate()
 }
 
 
+f_cnt_t LOMMEffect::latency() const
+{
+	return m_lommControls.m_lookaheadEnableModel.value() ? m_lookBufLength : 0;
+}
+
+
 bool LOMMEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 {
 	if (!isEnabled() || !isRunning())
@@ -109,14 +111,12 @@ bool LOMMEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 	
 	if (m_needsUpdate || m_lommControls.m_split1Model.isValueChanged())
 	{
-		m_lp1.setLowpass(m_lommControls.m_split1Model.value());
-		m_hp1.setHighpass(m_lommControls.m_split1Model.value());
+		m_crossover1.setFrequency(m_lommControls.m_split1Model.value());
 		m_ap.calcFilterCoeffs(m_lommControls.m_split1Model.value(), 0.70710678118);
 	}
 	if (m_needsUpdate || m_lommControls.m_split2Model.isValueChanged())
 	{
-		m_lp2.setLowpass(m_lommControls.m_split2Model.value());
-		m_hp2.setHighpass(m_lommControls.m_split2Model.value());
+		m_crossover2.setFrequency(m_lommControls.m_split2Model.value());
 	}
 	m_needsUpdate = false;
 
@@ -219,10 +219,8 @@ bool LOMMEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 			float crestFactorValTemp = ((m_crestFactorVal[i] - LOMM_AUTO_TIME_ADJUST) * autoTime) + LOMM_AUTO_TIME_ADJUST;
 		
 			// Crossover filters
-			bands[2][i] = m_lp2.update(s[i], i);
-			bands[1][i] = m_hp2.update(s[i], i);
-			bands[0][i] = m_hp1.update(bands[1][i], i);
-			bands[1][i] = m_lp1.update(bands[1][i], i);
+			m_crossover2.update(s[i], i, bands[2][i], bands[1][i]);
+			m_crossover1.update(bands[1][i], i, bands[1][i], bands[0][i]);
 			bands[2][i] = m_ap.update(bands[2][i], i);
 			
 			if (!split1Enabled)
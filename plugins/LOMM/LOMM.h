@@ -46,6 +46,7 @@ public:
 	LOMMEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key);
 	~LOMMEffect() override = default;
 	bool processAudioBuffer(sampleFrame* buf, const fpp_t frames) override;
+	f_cnt_t latency() const override;
 
 	EffectControls* controls() override
 	{
@@ -65,11 +66,8 @@ private:
 	
 	float m_sampleRate;
 	
-	StereoLinkwitzRiley m_lp1;
-	StereoLinkwitzRiley m_lp2;
-	
-	StereoLinkwitzRiley m_hp1;
-	StereoLinkwitzRiley m_hp2;
+	StereoLinkwitzRileyCrossover m_crossover1;
+	StereoLinkwitzRileyCrossover m_crossover2;
 	
 	BasicFilters<2> m_ap;
 	
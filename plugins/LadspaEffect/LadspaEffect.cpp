@@ -26,17 +26,21 @@
 
 #include <QVarLengthArray>
 #include <QMessageBox>
+#include <algorithm>
 
 #include "LadspaEffect.h"
 #include "DataFile.h"
 #include "AudioDevice.h"
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "Ladspa2LMMS.h"
 #include "LadspaBase.h"
 #include "LadspaControl.h"
 #include "LadspaSubPluginFeatures.h"
 #include "AutomationClip.h"
 #include "MemoryManager.h"
+#include "PlanarBuffer.h"
+#include "ThreadableJob.h"
 #include "ValueBuffer.h"
 #include "Song.h"
 
@@ -69,12 +73,45 @@ Plugin::Descriptor PLUGIN_EXPORT ladspaeffect_plugin_descriptor =
 }
 
 
+//! Runs one of the processors, so the channels of plugins that only
+//! process one of them can be processed on several workers at once
+class LadspaEffect::ProcessorJob : public ThreadableJob
+{
+public:
+	ProcessorJob( const LADSPA_Descriptor * _descriptor,
+						LADSPA_Handle _handle ) :
+		m_descriptor( _descriptor ),
+		m_handle( _handle )
+	{
+	}
+
+	bool requiresProcessing() const override
+	{
+		return true;
+	}
+
+	fpp_t m_frames = 0;
+
+private:
+	void doProcessing() override
+	{
+		( m_descriptor->run )( m_handle, m_frames );
+	}
+
+	const LADSPA_Descriptor * m_descriptor;
+	LADSPA_Handle m_handle;
+} ;
+
+
+
+
 LadspaEffect::LadspaEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &ladspaeffect_plugin_descriptor, _parent, _key ),
 	m_controls( nullptr ),
 	m_maxSampleRate( 0 ),
-	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) )
+	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) ),
+	m_channelPortsMoved( false )
 {
 	Ladspa2LMMS * manager = Engine::getLADSPAManager();
 	if( manager->getDescription( m_key ) == nullptr )
@@ -153,10 +190,40 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 				Engine::audioEngine()->processingSampleRate();
 	}
 
+	if( m_channelPortsMoved )
+	{
+		connectChannelPorts( nullptr, false );
+	}
+
 	// Copy the LMMS audio buffer to the LADSPA input buffer and initialize
 	// the control ports.
 	ch_cnt_t channel = 0;
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	{
+		for( int port = 0; port < m_portCount; ++port )
+		{
+			port_desc_t * pp = m_ports.at( proc ).at( port );
+			if( pp->rate == BufferRate::ChannelIn )
+			{
+				for( fpp_t frame = 0; frame < frames; ++frame )
+				{
+					pp->buffer[frame] = _buf[frame][channel];
+				}
+				++channel;
+			}
+		}
+	}
+	updateControlPorts( frames );
+
+	// Process the buffers.
+	runProcessors( frames );
+
+	// Copy the LADSPA output buffers to the LMMS buffer.
+	double out_sum = 0.0;
+	channel = 0;
+	const float d = dryLevel();
+	const float w = wetLevel();
+	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
 		for( int port = 0; port < m_portCount; ++port )
 		{
@@ -164,20 +231,136 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 			switch( pp->rate )
 			{
 				case BufferRate::ChannelIn:
+				case BufferRate::AudioRateInput:
+				case BufferRate::ControlRateInput:
+					break;
+				case BufferRate::ChannelOut:
 					for( fpp_t frame = 0;
 						frame < frames; ++frame )
 					{
-						pp->buffer[frame] =
-							_buf[frame][channel];
+						_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
+						out_sum += _buf[frame][channel] * _buf[frame][channel];
 					}
 					++channel;
 					break;
+				case BufferRate::AudioRateOutput:
+				case BufferRate::ControlRateOutput:
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	if( o_buf != nullptr )
+	{
+		sampleBack( _buf, o_buf, m_maxSampleRate );
+	}
+
+	checkGate( out_sum / frames );
+
+
+	bool is_running = isRunning();
+	m_pluginMutex.unlock();
+	return( is_running );
+}
+
+
+
+
+bool LadspaEffect::processesPlanar() const
+{
+	return m_maxSampleRate >= Engine::audioEngine()->processingSampleRate();
+}
+
+
+
+
+bool LadspaEffect::processPlanarBuffer( PlanarBuffer & _buf,
+							const fpp_t _frames )
+{
+	if( !processesPlanar() )
+	{
+		// the sample rate changed since the effect chain asked
+		QVarLengthArray<sampleFrame> frames( _frames );
+		_buf.interleave( frames.data(), _frames );
+		const bool running = processAudioBuffer( frames.data(), _frames );
+		_buf.deinterleave( frames.data(), _frames );
+		return running;
+	}
+
+	m_pluginMutex.lock();
+	if( !isOkay() || dontRun() || !isRunning() || !isEnabled() )
+	{
+		m_pluginMutex.unlock();
+		return( false );
+	}
+
+	// the channels are processed where they are, and if there's nothing
+	// to mix the dry signal with, written back there right away
+	const float d = dryLevel();
+	const float w = wetLevel();
+	const bool inPlace = !m_inPlaceBroken && d == 0.0f && w == 1.0f;
+	connectChannelPorts( &_buf, inPlace );
+	updateControlPorts( _frames );
+
+	runProcessors( _frames );
+
+	double out_sum = 0.0;
+	ch_cnt_t channel = 0;
+	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	{
+		for( int port = 0; port < m_portCount; ++port )
+		{
+			port_desc_t * pp = m_ports.at( proc ).at( port );
+			if( pp->rate != BufferRate::ChannelOut )
+			{
+				continue;
+			}
+			if( channel < DEFAULT_CHANNELS )
+			{
+				sample_t * out = _buf.channel( channel );
+				if( !inPlace )
+				{
+					for( fpp_t frame = 0; frame < _frames; ++frame )
+					{
+						out[frame] = d * out[frame] + w * pp->buffer[frame];
+					}
+				}
+				for( fpp_t frame = 0; frame < _frames; ++frame )
+				{
+					out_sum += out[frame] * out[frame];
+				}
+			}
+			++channel;
+		}
+	}
+
+	checkGate( out_sum / _frames );
+
+	bool is_running = isRunning();
+	m_pluginMutex.unlock();
+	return( is_running );
+}
+
+
+
+
+void LadspaEffect::updateControlPorts( fpp_t _frames )
+{
+	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+	{
+		for( int port = 0; port < m_portCount; ++port )
+		{
+			port_desc_t * pp = m_ports.at( proc ).at( port );
+			switch( pp->rate )
+			{
 				case BufferRate::AudioRateInput:
 				{
 					ValueBuffer * vb = pp->control->valueBuffer();
 					if( vb )
 					{
-						memcpy( pp->buffer, vb->values(), frames * sizeof(float) );
+						memcpy( pp->buffer, vb->values(), _frames * sizeof(float) );
 					}
 					else
 					{
@@ -187,7 +370,7 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 						// treated as though they were control rate by setting the
 						// port buffer to all the same value.
 						for( fpp_t frame = 0;
-							frame < frames; ++frame )
+							frame < _frames; ++frame )
 						{
 							pp->buffer[frame] =
 								pp->value;
@@ -205,68 +388,94 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 					pp->buffer[0] =
 						pp->value;
 					break;
-				case BufferRate::ChannelOut:
-				case BufferRate::AudioRateOutput:
-				case BufferRate::ControlRateOutput:
-					break;
 				default:
 					break;
 			}
 		}
 	}
+}
 
 
-	// Process the buffers.
-	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
-	{
-		(m_descriptor->run)( m_handles[proc], frames );
-	}
 
-	// Copy the LADSPA output buffers to the LMMS buffer.
-	double out_sum = 0.0;
-	channel = 0;
-	const float d = dryLevel();
-	const float w = wetLevel();
+
+void LadspaEffect::connectChannelPorts( PlanarBuffer * _buf, bool _inPlace )
+{
+	// connecting ports is real-time safe, and allowed between two runs
+	ch_cnt_t inChannel = 0;
+	ch_cnt_t outChannel = 0;
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
 		for( int port = 0; port < m_portCount; ++port )
 		{
 			port_desc_t * pp = m_ports.at( proc ).at( port );
-			switch( pp->rate )
+			LADSPA_Data * data = pp->buffer;
+			if( pp->rate == BufferRate::ChannelIn )
 			{
-				case BufferRate::ChannelIn:
-				case BufferRate::AudioRateInput:
-				case BufferRate::ControlRateInput:
-					break;
-				case BufferRate::ChannelOut:
-					for( fpp_t frame = 0;
-						frame < frames; ++frame )
-					{
-						_buf[frame][channel] = d * _buf[frame][channel] + w * pp->buffer[frame];
-						out_sum += _buf[frame][channel] * _buf[frame][channel];
-					}
-					++channel;
-					break;
-				case BufferRate::AudioRateOutput:
-				case BufferRate::ControlRateOutput:
-					break;
-				default:
-					break;
+				if( _buf && inChannel < DEFAULT_CHANNELS )
+				{
+					data = _buf->channel( inChannel );
+				}
+				++inChannel;
+			}
+			else if( pp->rate == BufferRate::ChannelOut )
+			{
+				if( _buf && _inPlace && outChannel < DEFAULT_CHANNELS )
+				{
+					data = _buf->channel( outChannel );
+				}
+				++outChannel;
+			}
+			else
+			{
+				continue;
 			}
+			( m_descriptor->connect_port )( m_handles[proc], port, data );
 		}
 	}
+	m_channelPortsMoved = _buf != nullptr;
+}
 
-	if( o_buf != nullptr )
+
+
+
+void LadspaEffect::runProcessors( fpp_t _frames )
+{
+	// outside of the workers there's nobody to help
+	const bool parallel = processorCount() > 1 &&
+		AudioEngineWorkerThread::currentWorker() <
+					AudioEngineWorkerThread::workerCount();
+	if( !parallel )
 	{
-		sampleBack( _buf, o_buf, m_maxSampleRate );
+		for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
+		{
+			( m_descriptor->run )( m_handles[proc], _frames );
+		}
+		return;
 	}
 
-	checkGate( out_sum / frames );
-
+	// the first processor is run right here, after handing out the others
+	for( int proc = processorCount() - 1; proc >= 0; --proc )
+	{
+		ProcessorJob & job = *m_processorJobs[proc];
+		job.reset();
+		job.m_frames = _frames;
+		if( proc == 0 || !AudioEngineWorkerThread::addJob( &job ) )
+		{
+			job.queue();
+			job.process();
+		}
+	}
 
-	bool is_running = isRunning();
-	m_pluginMutex.unlock();
-	return( is_running );
+	const auto pending = [this]
+	{
+		return std::any_of( m_processorJobs.begin(), m_processorJobs.end(),
+			[]( const std::unique_ptr<ProcessorJob> & job )
+				{ return job->state() != ThreadableJob::ProcessingState::Done; } );
+	};
+	while( pending() )
+	{
+		AudioEngineWorkerThread::processOneJob();
+	}
 }
 
 
@@ -287,6 +496,10 @@ void LadspaEffect::setControl( int _control, LADSPA_Data _value )
 void LadspaEffect::pluginInstantiation()
 {
 	m_maxSampleRate = maxSamplerate( displayName() );
+	if( m_maxSampleRate < Engine::audioEngine()->processingSampleRate() )
+	{
+		prepareResampling();
+	}
 
 	Ladspa2LMMS * manager = Engine::getLADSPAManager();
 
@@ -505,6 +718,8 @@ void LadspaEffect::pluginInstantiation()
 			return;
 		}
 		m_handles.append( effect );
+		m_processorJobs.push_back(
+			std::make_unique<ProcessorJob>( m_descriptor, effect ) );
 	}
 
 	// Connect the ports.
@@ -565,6 +780,8 @@ void LadspaEffect::pluginDestruction()
 	}
 	m_ports.clear();
 	m_handles.clear();
+	m_processorJobs.clear();
+	m_channelPortsMoved = false;
 	m_portControls.clear();
 }
 
@@ -28,6 +28,9 @@
 
 #include <QMutex>
 
+#include <memory>
+#include <vector>
+
 #include "Effect.h"
 #include "ladspa.h"
 #include "LadspaControls.h"
@@ -49,7 +52,12 @@ public:
 
 	bool processAudioBuffer( sampleFrame * _buf,
 							const fpp_t _frames ) override;
-	
+	//! The ports take one channel each, so the channels can be connected
+	//! to them as they are, unless the plugin has to be resampled
+	bool processesPlanar() const override;
+	bool processPlanarBuffer( PlanarBuffer & _buf,
+							const fpp_t _frames ) override;
+
 	void setControl( int _control, LADSPA_Data _data );
 
 	EffectControls * controls() override
@@ -68,11 +76,22 @@ private slots:
 
 
 private:
+	class ProcessorJob;
+
 	void pluginInstantiation();
 	void pluginDestruction();
 
 	static sample_rate_t maxSamplerate( const QString & _name );
 
+	//! Pass the values of the controls to the control ports
+	void updateControlPorts( fpp_t _frames );
+	//! Connect the channel ports to @p _buf, or back to their own buffers
+	//! if it's null. The outputs are connected to it as well if @p _inPlace.
+	void connectChannelPorts( PlanarBuffer * _buf, bool _inPlace );
+	//! Run every processor, the ones after the first as jobs of their own
+	//! when called from a worker
+	void runProcessors( fpp_t _frames );
+
 
 	QMutex m_pluginMutex;
 	LadspaControls * m_controls;
@@ -84,6 +103,9 @@ private:
 
 	const LADSPA_Descriptor * m_descriptor;
 	QVector<LADSPA_Handle> m_handles;
+	std::vector<std::unique_ptr<ProcessorJob>> m_processorJobs;
+	//! Whether the channel ports are connected to a planar buffer
+	bool m_channelPortsMoved;
 
 	QVector<multi_proc_t> m_ports;
 	multi_proc_t m_portControls;
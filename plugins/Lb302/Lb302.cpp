@@ -461,8 +461,6 @@ inline float GET_INC(float freq) {
 int Lb302Synth::process(sampleFrame *outbuf, const int size)
 {
 	const float sampleRatio = 44100.f / Engine::audioEngine()->processingSampleRate();
-	float w;
-	float samp;
 
 	// Hold on to the current VCF, and use it throughout this period
 	Lb302Filter *filter = vcf.loadAcquire();
@@ -488,6 +486,51 @@ int Lb302Synth::process(sampleFrame *outbuf, const int size)
 	// TODO: NORMAL RELEASE
 	// vca_mode = 1;
 
+	// the knob can't change in the middle of a period, so pick the shape once
+	// and loop without deciding it again for every frame
+	switch(int(rint(wave_shape.value()))) {
+		case 0: vco_shape = VcoShape::Sawtooth; break;
+		case 1: vco_shape = VcoShape::Triangle; break;
+		case 2: vco_shape = VcoShape::Square; break;
+		case 3: vco_shape = VcoShape::RoundSquare; break;
+		case 4: vco_shape = VcoShape::Moog; break;
+		case 5: vco_shape = VcoShape::Sine; break;
+		case 6: vco_shape = VcoShape::Exponential; break;
+		case 7: vco_shape = VcoShape::WhiteNoise; break;
+		case 8: vco_shape = VcoShape::BLSawtooth; break;
+		case 9: vco_shape = VcoShape::BLSquare; break;
+		case 10: vco_shape = VcoShape::BLTriangle; break;
+		case 11: vco_shape = VcoShape::BLMoog; break;
+		default:  vco_shape = VcoShape::Sawtooth; break;
+	}
+
+	switch (vco_shape) {
+		case VcoShape::Sawtooth: processFrames<VcoShape::Sawtooth>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::Triangle: processFrames<VcoShape::Triangle>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::Square: processFrames<VcoShape::Square>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::RoundSquare: processFrames<VcoShape::RoundSquare>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::Moog: processFrames<VcoShape::Moog>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::Sine: processFrames<VcoShape::Sine>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::Exponential: processFrames<VcoShape::Exponential>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::WhiteNoise: processFrames<VcoShape::WhiteNoise>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::BLSawtooth: processFrames<VcoShape::BLSawtooth>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::BLSquare: processFrames<VcoShape::BLSquare>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::BLTriangle: processFrames<VcoShape::BLTriangle>(outbuf, size, filter, sampleRatio); break;
+		case VcoShape::BLMoog: processFrames<VcoShape::BLMoog>(outbuf, size, filter, sampleRatio); break;
+	}
+	return 1;
+}
+
+
+template<Lb302Synth::VcoShape Shape>
+void Lb302Synth::processFrames(sampleFrame* outbuf, const int size, Lb302Filter* filter, const float sampleRatio)
+{
+	// read once, neither of them changes during a period
+	const float slideDecay = 0.1f - slide_dec_knob.value() * 0.0999f;
+	const double attackFrames = 0.5 * Engine::audioEngine()->processingSampleRate();
+
+	float samp;
+
 	for( int i=0; i<size; i++ ) 
 	{
 		// start decay if we're past release
@@ -505,7 +548,7 @@ int Lb302Synth::process(sampleFrame *outbuf, const int size)
 			if (vco_slide) {
 					vco_inc = vco_slidebase - vco_slide;
 					// Calculate coeff from dec_knob on knob change.
-					vco_slide -= vco_slide * ( 0.1f - slide_dec_knob.value() * 0.0999f ) * sampleRatio; // TODO: Adjust for ENVINC
+					vco_slide -= vco_slide * slideDecay * sampleRatio; // TODO: Adjust for ENVINC
 
 			}
 		}
@@ -522,87 +565,58 @@ int Lb302Synth::process(sampleFrame *outbuf, const int size)
 		if(vco_c > 0.5)
 			vco_c -= 1.0;
 
-		switch(int(rint(wave_shape.value()))) {
-			case 0: vco_shape = VcoShape::Sawtooth; break;
-			case 1: vco_shape = VcoShape::Triangle; break;
-			case 2: vco_shape = VcoShape::Square; break;
-			case 3: vco_shape = VcoShape::RoundSquare; break;
-			case 4: vco_shape = VcoShape::Moog; break;
-			case 5: vco_shape = VcoShape::Sine; break;
-			case 6: vco_shape = VcoShape::Exponential; break;
-			case 7: vco_shape = VcoShape::WhiteNoise; break;
-			case 8: vco_shape = VcoShape::BLSawtooth; break;
-			case 9: vco_shape = VcoShape::BLSquare; break;
-			case 10: vco_shape = VcoShape::BLTriangle; break;
-			case 11: vco_shape = VcoShape::BLMoog; break;
-			default:  vco_shape = VcoShape::Sawtooth; break;
-		}
-
 		// add vco_shape_param the changes the shape of each curve.
 		// merge sawtooths with triangle and square with round square?
-		switch (vco_shape) {
-			case VcoShape::Sawtooth: // p0: curviness of line
-				vco_k = vco_c;  // Is this sawtooth backwards?
-				break;
-
-			case VcoShape::Triangle:  // p0: duty rev.saw<->triangle<->saw p1: curviness
-				vco_k = (vco_c*2.0)+0.5;
-				if (vco_k>0.5)
-					vco_k = 1.0- vco_k;
-				break;
-
-			case VcoShape::Square: // p0: slope of top
-				vco_k = (vco_c<0)?0.5:-0.5;
-				break;
-
-			case VcoShape::RoundSquare: // p0: width of round
-				vco_k = (vco_c<0)?(sqrtf(1-(vco_c*vco_c*4))-0.5):-0.5;
-				break;
-
-			case VcoShape::Moog: // Maybe the fall should be exponential/sinsoidal instead of quadric.
-				// [-0.5, 0]: Rise, [0,0.25]: Slope down, [0.25,0.5]: Low
-				vco_k = (vco_c*2.0)+0.5;
-				if (vco_k>1.0) {
-					vco_k = -0.5 ;
-				}
-				else if (vco_k>0.5) {
-					w = 2.0*(vco_k-0.5)-1.0;
-					vco_k = 0.5 - sqrtf(1.0-(w*w));
-				}
-				vco_k *= 2.0;  // MOOG wave gets filtered away
-				break;
-
-			case VcoShape::Sine:
-				// [-0.5, 0.5]  : [-pi, pi]
-				vco_k = 0.5f * Oscillator::sinSample( vco_c );
-				break;
-
-			case VcoShape::Exponential:
-				vco_k = 0.5 * Oscillator::expSample( vco_c );
-				break;
-
-			case VcoShape::WhiteNoise:
-				vco_k = 0.5 * Oscillator::noiseSample( vco_c );
-				break;
-
-			// The next cases all use the BandLimitedWave class which uses the oscillator increment `vco_inc` to compute samples.
-			// If that oscillator increment is 0 we return a 0 sample because calling BandLimitedWave::pdToLen(0) leads to a
-			// division by 0 which in turn leads to floating point exceptions.
-			case VcoShape::BLSawtooth:
-				vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLSaw) * 0.5f;
-				break;
-
-			case VcoShape::BLSquare:
-				vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLSquare) * 0.5f;
-				break;
-
-			case VcoShape::BLTriangle:
-				vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLTriangle) * 0.5f;
-				break;
-
-			case VcoShape::BLMoog:
-				vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLMoog);
-				break;
+		if constexpr (Shape == VcoShape::Sawtooth) { // p0: curviness of line
+			vco_k = vco_c;  // Is this sawtooth backwards?
+		}
+		else if constexpr (Shape == VcoShape::Triangle) {  // p0: duty rev.saw<->triangle<->saw p1: curviness
+			vco_k = (vco_c*2.0)+0.5;
+			if (vco_k>0.5)
+				vco_k = 1.0- vco_k;
+		}
+		else if constexpr (Shape == VcoShape::Square) { // p0: slope of top
+			vco_k = (vco_c<0)?0.5:-0.5;
+		}
+		else if constexpr (Shape == VcoShape::RoundSquare) { // p0: width of round
+			vco_k = (vco_c<0)?(sqrtf(1-(vco_c*vco_c*4))-0.5):-0.5;
+		}
+		else if constexpr (Shape == VcoShape::Moog) { // Maybe the fall should be exponential/sinsoidal instead of quadric.
+			// [-0.5, 0]: Rise, [0,0.25]: Slope down, [0.25,0.5]: Low
+			vco_k = (vco_c*2.0)+0.5;
+			if (vco_k>1.0) {
+				vco_k = -0.5 ;
+			}
+			else if (vco_k>0.5) {
+				const float w = 2.0*(vco_k-0.5)-1.0;
+				vco_k = 0.5 - sqrtf(1.0-(w*w));
+			}
+			vco_k *= 2.0;  // MOOG wave gets filtered away
+		}
+		else if constexpr (Shape == VcoShape::Sine) {
+			// [-0.5, 0.5]  : [-pi, pi]
+			vco_k = 0.5f * Oscillator::sinSample( vco_c );
+		}
+		else if constexpr (Shape == VcoShape::Exponential) {
+			vco_k = 0.5 * Oscillator::expSample( vco_c );
+		}
+		else if constexpr (Shape == VcoShape::WhiteNoise) {
+			vco_k = 0.5 * Oscillator::noiseSample( vco_c );
+		}
+		// The next cases all use the BandLimitedWave class which uses the oscillator increment `vco_inc` to compute samples.
+		// If that oscillator increment is 0 we return a 0 sample because calling BandLimitedWave::pdToLen(0) leads to a
+		// division by 0 which in turn leads to floating point exceptions.
+		else if constexpr (Shape == VcoShape::BLSawtooth) {
+			vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLSaw) * 0.5f;
+		}
+		else if constexpr (Shape == VcoShape::BLSquare) {
+			vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLSquare) * 0.5f;
+		}
+		else if constexpr (Shape == VcoShape::BLTriangle) {
+			vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLTriangle) * 0.5f;
+		}
+		else if constexpr (Shape == VcoShape::BLMoog) {
+			vco_k = vco_inc == 0. ? 0. : BandLimitedWave::oscillate(vco_c + 0.5f, BandLimitedWave::pdToLen(vco_inc), BandLimitedWave::Waveform::BLMoog);
 		}
 
 		//vca_a = 0.5;
@@ -638,7 +652,7 @@ int Lb302Synth::process(sampleFrame *outbuf, const int size)
 		// Handle Envelope
 		if(vca_mode==VcaMode::Attack) {
 			vca_a+=(vca_a0-vca_a)*vca_attack;
-			if(sample_cnt>=0.5*Engine::audioEngine()->processingSampleRate())
+			if(sample_cnt>=attackFrames)
 				vca_mode = VcaMode::Idle;
 		}
 		else if(vca_mode == VcaMode::Decay) {
@@ -652,7 +666,6 @@ int Lb302Synth::process(sampleFrame *outbuf, const int size)
 		}
 
 	}
-	return 1;
 }
 
 
@@ -258,6 +258,9 @@ private:
 	void recalcFilter();
 
 	int process(sampleFrame *outbuf, const int size);
+	//! The frames of a period of process() for the wave shape it picked
+	template<VcoShape Shape>
+	void processFrames(sampleFrame* outbuf, const int size, Lb302Filter* filter, const float sampleRatio);
 
 	friend class gui::Lb302SynthView;
 
@@ -60,7 +60,8 @@ Plugin::Descriptor PLUGIN_EXPORT lv2effect_plugin_descriptor =
 Lv2Effect::Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key *key) :
 	Effect(&lv2effect_plugin_descriptor, parent, key),
 	m_controls(this, key->attributes["uri"]),
-	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod())
+	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod()),
+	m_tmpOutputPlanar(Engine::audioEngine()->framesPerPeriod())
 {
 }
 
@@ -102,6 +103,50 @@ bool Lv2Effect::processAudioBuffer(sampleFrame *buf, const fpp_t frames)
 
 
 
+bool Lv2Effect::processPlanarBuffer(PlanarBuffer& buf, const fpp_t frames)
+{
+	if (!isEnabled() || !isRunning()) { return false; }
+	Q_ASSERT(frames <= m_tmpOutputPlanar.frames());
+
+	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
+	const float d = corrupt ? 1 : dryLevel();
+	const float w = corrupt ? 0 : wetLevel();
+
+	// the ports are connected to the channels, and if there's no dry signal
+	// to mix in, the plugin writes its output right over them
+	const bool inPlace = d == 0.f && w == 1.f && m_controls.canProcessInPlace();
+	const bool connected = m_controls.connectBuffersToLmms(buf, inPlace ? buf : m_tmpOutputPlanar);
+	if (!connected) { m_controls.copyBuffersFromLmms(buf, frames); }
+	m_controls.copyModelsFromLmms();
+	m_controls.run(frames);
+	m_controls.copyModelsToLmms();
+	if (!connected) { m_controls.copyBuffersToLmms(m_tmpOutputPlanar, frames); }
+
+	double outSum = .0;
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+	{
+		sample_t* out = buf.channel(ch);
+		if (!connected || !inPlace)
+		{
+			const sample_t* wet = m_tmpOutputPlanar.channel(ch);
+			for (fpp_t f = 0; f < frames; ++f)
+			{
+				out[f] = d * out[f] + w * wet[f];
+			}
+		}
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			outSum += static_cast<double>(out[f]) * out[f];
+		}
+	}
+	checkGate(outSum / frames);
+
+	return isRunning();
+}
+
+
+
+
 extern "C"
 {
 
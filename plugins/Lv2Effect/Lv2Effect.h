@@ -26,6 +26,7 @@
 #define LV2_EFFECT_H
 
 #include "Effect.h"
+#include "PlanarBuffer.h"
 #include "Lv2FxControls.h"
 
 namespace lmms
@@ -45,6 +46,9 @@ public:
 	bool isValid() const { return m_controls.isValid(); }
 
 	bool processAudioBuffer( sampleFrame* buf, const fpp_t frames ) override;
+	//! Lv2 ports hold one channel each
+	bool processesPlanar() const override { return true; }
+	bool processPlanarBuffer( PlanarBuffer& buf, const fpp_t frames ) override;
 	EffectControls* controls() override { return &m_controls; }
 
 	Lv2FxControls* lv2Controls() { return &m_controls; }
@@ -53,6 +57,7 @@ public:
 private:
 	Lv2FxControls m_controls;
 	std::vector<sampleFrame> m_tmpOutputSmps;
+	PlanarBuffer m_tmpOutputPlanar;
 };
 
 
@@ -168,7 +168,7 @@ bool Lv2Instrument::handleMidiEvent(
 	const MidiEvent &event, const TimePos &time, f_cnt_t offset)
 {
 	// this function can be called from GUI threads while the plugin is running
-	// handleMidiInputEvent will use a thread-safe ringbuffer
+	// handleMidiInputEvent will use a lock-free list
 	handleMidiInputEvent(event, time, offset);
 	return true;
 }
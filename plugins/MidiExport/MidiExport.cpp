@@ -27,12 +27,15 @@
 
 #include "MidiExport.h"
 
+#include <QFile>
+#include <algorithm>
+#include <array>
+#include <functional>
+
 #include "Engine.h"
 #include "TrackContainer.h"
-#include "DataFile.h"
 #include "InstrumentTrack.h"
-#include "LocaleHelper.h"
-#include "PatternTrack.h"
+#include "MidiClip.h"
 
 #include "plugin_export.h"
 
@@ -61,6 +64,142 @@ Plugin::Descriptor PLUGIN_EXPORT midiexport_plugin_descriptor =
 }
 
 
+MidiTrackWriter::MidiTrackWriter(QIODevice& out, uint8_t channel) :
+	m_out(out),
+	m_channel(channel),
+	m_start(out.pos())
+{
+	// chunk ID, the chunk size is written by finish()
+	const char header[] = {'M', 'T', 'r', 'k', 0, 0, 0, 0};
+	m_failed = m_out.write(header, sizeof(header)) != static_cast<qint64>(sizeof(header));
+	m_buffer.reserve(BufferSize);
+}
+
+
+
+
+void MidiTrackWriter::addName(const std::string& name)
+{
+	MidiFile::Event event;
+	event.channel = m_channel;
+	event.type = MidiFile::Event::TRACK_NAME;
+	event.time = m_lastTime;
+	event.trackName = name;
+	write(event);
+}
+
+
+
+
+void MidiTrackWriter::addTempo(uint32_t tempo)
+{
+	MidiFile::Event event;
+	event.channel = m_channel;
+	event.type = MidiFile::Event::TEMPO;
+	event.time = m_lastTime;
+	event.tempo = tempo;
+	write(event);
+}
+
+
+
+
+void MidiTrackWriter::addNote(uint8_t pitch, uint8_t volume, double time, double duration)
+{
+	const auto on = static_cast<uint32_t>(time * MidiFile::TICKSPERBEAT);
+	const auto off = static_cast<uint32_t>(std::max(time, time + duration) * MidiFile::TICKSPERBEAT);
+
+	// notes ending when this one starts end first
+	endNotes(on);
+
+	MidiFile::Event event;
+	event.channel = m_channel;
+	event.type = MidiFile::Event::NOTE_ON;
+	event.time = on;
+	event.pitch = pitch;
+	event.volume = volume;
+	write(event);
+
+	m_playing.push_back(NoteOff{off, pitch, volume});
+	std::push_heap(m_playing.begin(), m_playing.end(), std::greater<>{});
+}
+
+
+
+
+bool MidiTrackWriter::finish()
+{
+	endNotes(UINT32_MAX);
+
+	// MIDI close event
+	for (const uint8_t byte : {0x00, 0xFF, 0x2F, 0x00}) { m_buffer.push_back(byte); }
+	m_size += 4;
+	flush();
+
+	const qint64 end = m_out.pos();
+	uint8_t size[4];
+	MidiFile::writeBigEndian4(m_size, size);
+	m_failed = m_failed || !m_out.seek(m_start + 4)
+		|| m_out.write(reinterpret_cast<const char*>(size), sizeof(size)) != static_cast<qint64>(sizeof(size))
+		|| !m_out.seek(end);
+	return !m_failed;
+}
+
+
+
+
+void MidiTrackWriter::endNotes(uint32_t time)
+{
+	while (!m_playing.empty() && m_playing.front().time <= time)
+	{
+		std::pop_heap(m_playing.begin(), m_playing.end(), std::greater<>{});
+		const auto& note = m_playing.back();
+
+		MidiFile::Event event;
+		event.channel = m_channel;
+		event.type = MidiFile::Event::NOTE_OFF;
+		event.time = note.time;
+		event.pitch = note.pitch;
+		event.volume = note.volume;
+		write(event);
+
+		m_playing.pop_back();
+	}
+}
+
+
+
+
+void MidiTrackWriter::write(MidiFile::Event& event)
+{
+	// the events are written with the time since the one before
+	const uint32_t time = std::max(event.time, m_lastTime);
+	event.time = time - m_lastTime;
+	m_lastTime = time;
+
+	// a variable length time, the longest event and the name if any
+	const auto used = m_buffer.size();
+	m_buffer.resize(used + 16 + event.trackName.size());
+	const auto size = event.writeToBuffer(m_buffer.data() + used);
+	m_buffer.resize(used + size);
+	m_size += size;
+
+	if (m_buffer.size() >= BufferSize) { flush(); }
+}
+
+
+
+
+void MidiTrackWriter::flush()
+{
+	const auto size = static_cast<qint64>(m_buffer.size());
+	m_failed = m_failed || m_out.write(reinterpret_cast<const char*>(m_buffer.data()), size) != size;
+	m_buffer.clear();
+}
+
+
+
+
 MidiExport::MidiExport() : ExportFilter( &midiexport_plugin_descriptor)
 {
 }
@@ -73,268 +212,173 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 			int tempo, int masterPitch, const QString &filename)
 {
 	QFile f(filename);
-	f.open(QIODevice::WriteOnly);
-	QDataStream midiout(&f);
-
-	InstrumentTrack* instTrack;
-	PatternTrack* patternTrack;
-	QDomElement element;
-
+	if (!f.open(QIODevice::WriteOnly)) { return false; }
 
 	int nTracks = 0;
-	auto buffer = std::array<uint8_t, BUFFER_SIZE>{};
-	uint32_t size;
-
 	for (const Track* track : tracks) if (track->type() == Track::Type::Instrument) nTracks++;
 	for (const Track* track : patternStoreTracks) if (track->type() == Track::Type::Instrument) nTracks++;
 
 	// midi header
 	MidiFile::MIDIHeader header(nTracks);
-	size = header.writeToBuffer(buffer.data());
-	midiout.writeRawData((char *)buffer.data(), size);
+	auto buffer = std::array<uint8_t, 14>{};
+	const auto size = header.writeToBuffer(buffer.data());
+	bool successful = f.write(reinterpret_cast<const char*>(buffer.data()), size) == size;
+
+	const auto trackBase = [masterPitch](InstrumentTrack* track)
+	{
+		auto base = MidiTrackBase{};
+		base.pitch = 69 - track->baseNoteModel()->value();
+		if (track->useMasterPitchModel()->value())
+		{
+			base.pitch += masterPitch;
+		}
+		base.volume = track->volumeModel()->value() / 100.0;
+		return base;
+	};
 
 	std::vector<std::vector<std::pair<int,int>>> plists;
 
 	// midi tracks
 	for (Track* track : tracks)
 	{
-		DataFile dataFile(DataFile::Type::SongProject);
-		MTrack mtrack;
-
 		if (track->type() == Track::Type::Instrument)
 		{
-
-			mtrack.addName(track->name().toStdString(), 0);
+			auto instTrack = static_cast<InstrumentTrack*>(track);
+			MidiTrackWriter mtrack(f);
+			mtrack.addName(track->name().toStdString());
 			//mtrack.addProgramChange(0, 0);
-			mtrack.addTempo(tempo, 0);
-
-			instTrack = dynamic_cast<InstrumentTrack *>(track);
-			element = instTrack->saveState(dataFile, dataFile.content());
-
-			int base_pitch = 0;
-			double base_volume = 1.0;
-			int base_time = 0;
-
-			MidiNoteVector midiClip;
+			mtrack.addTempo(tempo);
 
-			for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+			// the notes of every clip, merged while they're written
+			const auto base = trackBase(instTrack);
+			std::vector<MidiNoteCursor> cursors;
+			for (int i = 0; i < track->numOfClips(); ++i)
 			{
-
-				if (n.nodeName() == "instrumenttrack")
-				{
-					QDomElement it = n.toElement();
-					base_pitch = (69 - it.attribute("basenote", "69").toInt());
-					if (it.attribute("usemasterpitch", "1").toInt())
-					{
-						base_pitch += masterPitch;
-					}
-					base_volume = LocaleHelper::toDouble(it.attribute("volume", "100"))/100.0;
-				}
-
-				if (n.nodeName() == "midiclip")
-				{
-					base_time = n.toElement().attribute("pos", "0").toInt();
-					writeMidiClip(midiClip, n, base_pitch, base_volume, base_time);
-				}
-
+				const auto clip = static_cast<MidiClip*>(track->getClip(i));
+				cursors.emplace_back(clip->notes(), base, static_cast<int>(clip->startPosition()));
 			}
-			processPatternNotes(midiClip, INT_MAX);
-			writeMidiClipToTrack(mtrack, midiClip);
-			size = mtrack.writeToBuffer(buffer.data());
-			midiout.writeRawData((char *)buffer.data(), size);
+			std::vector<MidiNoteStream> streams;
+			streams.emplace_back(std::move(cursors));
+			writeNotes(mtrack, streams);
+			successful = mtrack.finish() && successful;
 		}
 
 		if (track->type() == Track::Type::Pattern)
 		{
-			patternTrack = dynamic_cast<PatternTrack*>(track);
-			element = patternTrack->saveState(dataFile, dataFile.content());
-
 			std::vector<std::pair<int,int>> plist;
-			for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+			for (int i = 0; i < track->numOfClips(); ++i)
 			{
-
-				if (n.nodeName() == "patternclip")
-				{
-					QDomElement it = n.toElement();
-					int pos = it.attribute("pos", "0").toInt();
-					int len = it.attribute("len", "0").toInt();
-					plist.emplace_back(pos, pos+len);
-				}
+				const Clip* clip = track->getClip(i);
+				const int pos = clip->startPosition();
+				plist.emplace_back(pos, pos + static_cast<int>(clip->length()));
 			}
 			std::sort(plist.begin(), plist.end());
 			plists.push_back(plist);
-
 		}
 	} // for each track
 
 	// for each instrument in the pattern editor
 	for (Track* track : patternStoreTracks)
 	{
-		DataFile dataFile(DataFile::Type::SongProject);
-		MTrack mtrack;
-
-		// begin at the first pattern track (first pattern)
-		auto itr = plists.begin();
-
-		std::vector<std::pair<int,int>> st;
-
 		if (track->type() != Track::Type::Instrument) continue;
 
-		mtrack.addName(track->name().toStdString(), 0);
+		auto instTrack = static_cast<InstrumentTrack*>(track);
+		MidiTrackWriter mtrack(f);
+		mtrack.addName(track->name().toStdString());
 		//mtrack.addProgramChange(0, 0);
-		mtrack.addTempo(tempo, 0);
-
-		instTrack = dynamic_cast<InstrumentTrack *>(track);
-		element = instTrack->saveState(dataFile, dataFile.content());
+		mtrack.addTempo(tempo);
 
-		int base_pitch = 0;
-		double base_volume = 1.0;
+		const auto base = trackBase(instTrack);
+		std::vector<MidiNoteStream> streams;
 
-		// for each pattern in the pattern editor
-		for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+		// for each pattern in the pattern editor, which is where the
+		// pattern track at the same index in the song editor plays it
+		const int patterns = std::min(track->numOfClips(), static_cast<int>(plists.size()));
+		for (int p = 0; p < patterns; ++p)
 		{
-			if (n.nodeName() == "instrumenttrack")
-			{
-				QDomElement it = n.toElement();
-				base_pitch = (69 - it.attribute("basenote", "69").toInt());
-				if (it.attribute("usemasterpitch", "1").toInt())
-				{
-					base_pitch += masterPitch;
-				}
-				base_volume = LocaleHelper::toDouble(it.attribute("volume", "100")) / 100.0;
-			}
-
-			if (n.nodeName() == "midiclip")
+			const auto clip = static_cast<MidiClip*>(track->getClip(p));
+			const std::vector<std::pair<int,int>>& plist = plists[p];
+			std::vector<std::pair<int,int>> st;
+			std::vector<MidiNoteCursor::Segment> segments;
+			const auto addSegment = [&segments](int base, int start, int end)
 			{
-				std::vector<std::pair<int,int>> &plist = *itr;
-
-				MidiNoteVector nv, midiClip;
-				writeMidiClip(midiClip, n, base_pitch, base_volume, 0);
+				if (start < end) { segments.push_back({base, start, end}); }
+			};
 
+			// FIXME better variable names and comments
+			int pos = 0;
+			int len = clip->steps() * 12;
 
-				// FIXME better variable names and comments
-				int pos = 0;
-				int len = n.toElement().attribute("steps", "1").toInt() * 12;
+			// for each pattern clip of the current pattern track (in song editor)
+			for (const auto& position : plist)
+			{
+				const auto& [start, end] = position;
+				while (!st.empty() && st.back().second <= start)
+				{
+					addSegment(st.back().first, pos, st.back().second);
+					pos = st.back().second;
+					st.pop_back();
+				}
 
-				// for each pattern clip of the current pattern track (in song editor)
-				for (const auto& position : plist)
+				if (!st.empty() && st.back().second <= end)
 				{
-					const auto& [start, end] = position;
-					while (!st.empty() && st.back().second <= start)
+					addSegment(st.back().first, pos, start);
+					pos = start;
+					while (!st.empty() && st.back().second <= end)
 					{
-						writePatternClip(midiClip, nv, len, st.back().first, pos, st.back().second);
-						pos = st.back().second;
 						st.pop_back();
 					}
-
-					if (!st.empty() && st.back().second <= end)
-					{
-						writePatternClip(midiClip, nv, len, st.back().first, pos, start);
-						pos = start;
-						while (!st.empty() && st.back().second <= end)
-						{
-							st.pop_back();
-						}
-					}
-
-					st.push_back(position);
-					pos = start;
-				}
-
-				while (!st.empty())
-				{
-					writePatternClip(midiClip, nv, len, st.back().first, pos, st.back().second);
-					pos = st.back().second;
-					st.pop_back();
 				}
 
-				processPatternNotes(nv, pos);
-				writeMidiClipToTrack(mtrack, nv);
+				st.push_back(position);
+				pos = start;
+			}
 
-				// next pattern track
-				++itr;
+			while (!st.empty())
+			{
+				addSegment(st.back().first, pos, st.back().second);
+				pos = st.back().second;
+				st.pop_back();
 			}
+
+			// step notes of a pattern only last up to the next note of the same pattern
+			std::vector<MidiNoteCursor> cursors;
+			cursors.emplace_back(clip->notes(), base, len, std::move(segments));
+			streams.emplace_back(std::move(cursors), pos);
 		}
-		size = mtrack.writeToBuffer(buffer.data());
-		midiout.writeRawData((char *)buffer.data(), size);
+		writeNotes(mtrack, streams);
+		successful = mtrack.finish() && successful;
 	}
 
-	return true;
+	return successful;
 
 }
 
 
 
-void MidiExport::writeMidiClip(MidiNoteVector &midiClip, const QDomNode& n,
-				int base_pitch, double base_volume, int base_time)
+void MidiExport::writeNotes(MidiTrackWriter& mtrack, std::vector<MidiNoteStream>& streams)
 {
-	// TODO interpret steps="12" muted="0" type="1" name="Piano1"  len="2592"
-	for (QDomNode nn = n.firstChild(); !nn.isNull(); nn = nn.nextSibling())
+	const auto later = [&streams](std::size_t a, std::size_t b) { return streams[a].time() > streams[b].time(); };
+	std::vector<std::size_t> heap;
+	for (std::size_t i = 0; i < streams.size(); ++i)
 	{
-		QDomElement note = nn.toElement();
-		if (note.attribute("len", "0") == "0") continue;
-		// TODO interpret pan="0" mixch="0" pitchrange="1"
-		MidiNote mnote;
-		mnote.pitch = qMax(0, qMin(127, note.attribute("key", "0").toInt() + base_pitch));
-		 // Map from LMMS volume to MIDI velocity
-		mnote.volume = qMin(qRound(base_volume * LocaleHelper::toDouble(note.attribute("vol", "100")) * (127.0 / 200.0)), 127);
-		mnote.time = base_time + note.attribute("pos", "0").toInt();
-		mnote.duration = note.attribute("len", "0").toInt();
-		mnote.type = static_cast<Note::Type>(note.attribute("type", "0").toInt());
-		midiClip.push_back(mnote);
+		if (!streams[i].atEnd()) { heap.push_back(i); }
 	}
-}
+	std::make_heap(heap.begin(), heap.end(), later);
 
-
-
-void MidiExport::writeMidiClipToTrack(MTrack &mtrack, MidiNoteVector &nv)
-{
-	for (const auto& note : nv)
+	while (!heap.empty())
 	{
+		std::pop_heap(heap.begin(), heap.end(), later);
+		auto& stream = streams[heap.back()];
+		const auto note = stream.take();
 		mtrack.addNote(note.pitch, note.volume, note.time / 48.0, note.duration / 48.0);
-	}
-}
-
-
-
-void MidiExport::writePatternClip(MidiNoteVector& src, MidiNoteVector& dst,
-				int len, int base, int start, int end)
-{
-	if (start >= end) { return; }
-	start -= base;
-	end -= base;
-	std::sort(src.begin(), src.end());
-	for (const auto& srcNote : src)
-	{
-		for (int time = srcNote.time + ceil((start - srcNote.time) / len) * len; time < end; time += len)
-		{
-			MidiNote note;
-			note.duration = srcNote.duration;
-			note.pitch = srcNote.pitch;
-			note.time = base + time;
-			note.volume = srcNote.volume;
-			note.type = srcNote.type;
-			dst.push_back(note);
-		}
-	}
-}
-
-
-
-void MidiExport::processPatternNotes(MidiNoteVector& nv, int cutPos)
-{
-	std::sort(nv.begin(), nv.end());
-	int cur = INT_MAX, next = INT_MAX;
-	for (auto it = nv.rbegin(); it != nv.rend(); ++it)
-	{
-		if (it->time < cur)
+		if (stream.atEnd())
 		{
-			next = cur;
-			cur = it->time;
+			heap.pop_back();
 		}
-		if (it->type == Note::Type::Step)
+		else
 		{
-			it->duration = qMin(qMin(DefaultBeatLength, next - cur), cutPos - it->time);
+			std::push_heap(heap.begin(), heap.end(), later);
 		}
 	}
 }
@@ -27,36 +27,67 @@
 #define _MIDI_EXPORT_H
 
 #include <QString>
+#include <string>
+#include <vector>
 
 #include "ExportFilter.h"
 #include "MidiFile.hpp"
-#include "Note.h"
+#include "MidiNoteStream.h"
 
-class QDomNode;
+class QIODevice;
 
 namespace lmms
 {
 
 
-const int BUFFER_SIZE = 50*1024;
-using MTrack = MidiFile::MIDITrack<BUFFER_SIZE>;
-
-struct MidiNote
+/**
+ * Writes a track chunk of a MIDI file while its notes come, in the order they
+ * start, instead of collecting and sorting all of its events first. Only the
+ * notes still playing are kept, to end them when it's time. The length of
+ * the chunk is filled in once it's finished.
+ */
+class MidiTrackWriter
 {
-	int time;
-	uint8_t pitch;
-	int duration;
-	uint8_t volume;
-	Note::Type type;
+public:
+	explicit MidiTrackWriter(QIODevice& out, uint8_t channel = 0);
+
+	void addName(const std::string& name);
+	void addTempo(uint32_t tempo);
+	//! Adds a note at @p time, which may not be before the last one, both in beats
+	void addNote(uint8_t pitch, uint8_t volume, double time, double duration);
 
-	inline bool operator<(const MidiNote &b) const
+	//! Ends the notes still playing and the track
+	bool finish();
+
+private:
+	struct NoteOff
 	{
-		return this->time < b.time;
-	}
+		uint32_t time;
+		uint8_t pitch;
+		uint8_t volume;
+
+		bool operator>(const NoteOff& other) const { return time > other.time; }
+	} ;
+
+	//! Writes the notes ending before @p time
+	void endNotes(uint32_t time);
+	void write(MidiFile::Event& event);
+	void flush();
+
+	//! What's written at once
+	static constexpr std::size_t BufferSize = 4096;
+
+	QIODevice& m_out;
+	uint8_t m_channel;
+	qint64 m_start;
+	uint32_t m_size = 0;
+	uint32_t m_lastTime = 0;
+	//! The notes playing, a min-heap by when they end
+	std::vector<NoteOff> m_playing;
+	std::vector<uint8_t> m_buffer;
+	bool m_failed = false;
 } ;
 
-using MidiNoteVector = std::vector<MidiNote>;
-using MidiNoteIterator = std::vector<MidiNote>::iterator;
 
 class MidiExport: public ExportFilter
 {
@@ -65,16 +96,6 @@ public:
 	MidiExport();
 	~MidiExport() override = default;
 
-	// Default Beat Length in ticks for step notes
-	// TODO: The beat length actually varies per note, however the method that
-	// calculates it (InstrumentTrack::beatLen) requires a NotePlayHandle to do
-	// so. While we don't figure out a way to hold the beat length of each note
-	// on its member variables, we will use a default value as a beat length that
-	// will be used as an upper limit of the midi note length. This doesn't worsen
-	// the current logic used for MidiExport because right now the beat length is
-	// not even considered during the generation of the MIDI.
-	static constexpr int DefaultBeatLength = 1500;
-
 	gui::PluginView* instantiateView(QWidget *) override
 	{
 		return nullptr;
@@ -85,12 +106,8 @@ public:
 				int tempo, int masterPitch, const QString &filename) override;
 	
 private:
-	void writeMidiClip(MidiNoteVector &midiClip, const QDomNode& n,
-				int base_pitch, double base_volume, int base_time);
-	void writeMidiClipToTrack(MTrack &mtrack, MidiNoteVector &nv);
-	void writePatternClip(MidiNoteVector &src, MidiNoteVector &dst,
-				int len, int base, int start, int end);
-	void processPatternNotes(MidiNoteVector &nv, int cutPos);
+	//! Writes the notes of @p streams to @p mtrack, merged in the order they start
+	void writeNotes(MidiTrackWriter& mtrack, std::vector<MidiNoteStream>& streams);
 
 	void error();
 
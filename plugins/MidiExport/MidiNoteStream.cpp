@@ -0,0 +1,260 @@
+/*
+ * MidiNoteStream.cpp - the notes of a track in the order they start, for exporting them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MidiNoteStream.h"
+
+#include <algorithm>
+#include <functional>
+
+#include <QtGlobal>
+
+namespace lmms
+{
+
+
+namespace
+{
+
+auto toMidiNote(const Note& note, MidiTrackBase base, int time) -> MidiNote
+{
+	// TODO interpret pan="0" mixch="0" pitchrange="1"
+	MidiNote mnote;
+	mnote.pitch = qBound(0, note.key() + base.pitch, 127);
+	// Map from LMMS volume to MIDI velocity
+	mnote.volume = qMin(qRound(base.volume * note.getVolume() * (127.0 / 200.0)), 127);
+	mnote.time = time;
+	mnote.duration = note.length();
+	mnote.type = note.type();
+	return mnote;
+}
+
+} // namespace
+
+
+
+
+MidiNoteCursor::MidiNoteCursor(const NoteVector& notes, MidiTrackBase base, int time) :
+	m_notes(&notes),
+	m_base(base),
+	m_repeats(false),
+	m_time(time)
+{
+	skip();
+}
+
+
+
+
+MidiNoteCursor::MidiNoteCursor(const NoteVector& notes, MidiTrackBase base, int length,
+		std::vector<Segment> segments) :
+	m_notes(&notes),
+	m_base(base),
+	m_repeats(true),
+	m_length(length),
+	m_segments(length > 0 ? std::move(segments) : std::vector<Segment>{})
+{
+	nextSegment();
+}
+
+
+
+
+bool MidiNoteCursor::atEnd() const
+{
+	return m_repeats ? m_next.empty() : m_index >= m_notes->size();
+}
+
+
+
+
+int MidiNoteCursor::time() const
+{
+	return m_repeats ? m_next.front().first : m_time + (*m_notes)[m_index]->pos();
+}
+
+
+
+
+MidiNote MidiNoteCursor::take()
+{
+	if (!m_repeats)
+	{
+		const auto note = toMidiNote(*(*m_notes)[m_index], m_base, time());
+		++m_index;
+		skip();
+		return note;
+	}
+
+	std::pop_heap(m_next.begin(), m_next.end(), std::greater<>{});
+	auto& [time, index] = m_next.back();
+	const auto note = toMidiNote(*(*m_notes)[index], m_base, time);
+
+	// the same note in the next repetition
+	time += m_length;
+	if (time < m_segments[m_segment].end)
+	{
+		std::push_heap(m_next.begin(), m_next.end(), std::greater<>{});
+	}
+	else
+	{
+		m_next.pop_back();
+		if (m_next.empty())
+		{
+			++m_segment;
+			nextSegment();
+		}
+	}
+	return note;
+}
+
+
+
+
+void MidiNoteCursor::skip()
+{
+	// notes without a length aren't played
+	while (m_index < m_notes->size() && (*m_notes)[m_index]->length() == 0)
+	{
+		++m_index;
+	}
+}
+
+
+
+
+void MidiNoteCursor::nextSegment()
+{
+	m_next.clear();
+	for (; m_segment < m_segments.size(); ++m_segment)
+	{
+		const auto& [base, start, end] = m_segments[m_segment];
+		for (std::size_t i = 0; i < m_notes->size(); ++i)
+		{
+			const Note* note = (*m_notes)[i];
+			if (note->length() == 0) { continue; }
+
+			// the first repetition of the note in the segment
+			int time = note->pos();
+			if (time < start - base)
+			{
+				time += (start - base - time + m_length - 1) / m_length * m_length;
+			}
+			if (base + time < end) { m_next.emplace_back(base + time, i); }
+		}
+		if (!m_next.empty())
+		{
+			std::make_heap(m_next.begin(), m_next.end(), std::greater<>{});
+			return;
+		}
+	}
+}
+
+
+
+
+MidiNoteStream::MidiNoteStream(std::vector<MidiNoteCursor> cursors, int cutPos) :
+	m_cursors(std::move(cursors)),
+	m_cutPos(cutPos)
+{
+	for (std::size_t i = 0; i < m_cursors.size(); ++i)
+	{
+		if (!m_cursors[i].atEnd()) { m_heap.push_back(i); }
+	}
+	std::make_heap(m_heap.begin(), m_heap.end(), [this](auto a, auto b) { return later(a, b); });
+	fill();
+}
+
+
+
+
+bool MidiNoteStream::atEnd() const
+{
+	return m_pendingIndex >= m_pending.size();
+}
+
+
+
+
+int MidiNoteStream::time() const
+{
+	return m_pending[m_pendingIndex].time;
+}
+
+
+
+
+MidiNote MidiNoteStream::take()
+{
+	const auto note = m_pending[m_pendingIndex++];
+	if (atEnd()) { fill(); }
+	return note;
+}
+
+
+
+
+bool MidiNoteStream::later(std::size_t a, std::size_t b) const
+{
+	return m_cursors[a].time() > m_cursors[b].time();
+}
+
+
+
+
+void MidiNoteStream::fill()
+{
+	m_pending.clear();
+	m_pendingIndex = 0;
+	if (m_heap.empty()) { return; }
+
+	const auto order = [this](auto a, auto b) { return later(a, b); };
+	const int time = m_cursors[m_heap.front()].time();
+	while (!m_heap.empty() && m_cursors[m_heap.front()].time() == time)
+	{
+		std::pop_heap(m_heap.begin(), m_heap.end(), order);
+		auto& cursor = m_cursors[m_heap.back()];
+		m_pending.push_back(cursor.take());
+		if (cursor.atEnd())
+		{
+			m_heap.pop_back();
+		}
+		else
+		{
+			std::push_heap(m_heap.begin(), m_heap.end(), order);
+		}
+	}
+
+	// step notes last until the next note starts
+	const int next = m_heap.empty() ? INT_MAX : m_cursors[m_heap.front()].time();
+	for (auto& note : m_pending)
+	{
+		if (note.type == Note::Type::Step)
+		{
+			note.duration = std::min({DefaultBeatLength, next - time, m_cutPos - time});
+		}
+	}
+}
+
+
+} // namespace lmms
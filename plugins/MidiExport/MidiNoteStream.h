@@ -0,0 +1,153 @@
+/*
+ * MidiNoteStream.h - the notes of a track in the order they start, for exporting them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_MIDI_NOTE_STREAM_H
+#define LMMS_MIDI_NOTE_STREAM_H
+
+#include <climits>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Note.h"
+
+namespace lmms
+{
+
+
+struct MidiNote
+{
+	int time;
+	uint8_t pitch;
+	int duration;
+	uint8_t volume;
+	Note::Type type;
+} ;
+
+
+//! What the notes of a track are exported relative to
+struct MidiTrackBase
+{
+	//! Added to the keys
+	int pitch = 0;
+	//! The track volume, 1 for 100%
+	double volume = 1.0;
+} ;
+
+
+/**
+ * Walks through the notes of a clip in the order they start, without copying
+ * them. Those of a pattern repeat every pattern length within each of the
+ * segments it's played in, which only takes to know the next time of each of
+ * its notes instead of all the times it plays.
+ */
+class MidiNoteCursor
+{
+public:
+	//! Where a pattern plays: from @p start to @p end, repeated from @p base on
+	struct Segment
+	{
+		int base;
+		int start;
+		int end;
+	} ;
+
+	//! The notes of a melody clip at @p time
+	MidiNoteCursor(const NoteVector& notes, MidiTrackBase base, int time);
+	//! The notes of a pattern @p length ticks long, in @p segments one after the other
+	MidiNoteCursor(const NoteVector& notes, MidiTrackBase base, int length, std::vector<Segment> segments);
+
+	bool atEnd() const;
+	//! When the next note starts
+	int time() const;
+	//! The next note
+	MidiNote take();
+
+private:
+	//! Skips the notes that aren't exported
+	void skip();
+	//! Starts the next segment with notes in it
+	void nextSegment();
+
+	const NoteVector* m_notes;
+	MidiTrackBase m_base;
+	bool m_repeats;
+
+	// melody clips
+	int m_time = 0;
+	std::size_t m_index = 0;
+
+	// patterns
+	int m_length = 0;
+	std::vector<Segment> m_segments;
+	std::size_t m_segment = 0;
+	//! The next time of each note within the segment, a min-heap
+	std::vector<std::pair<int, std::size_t>> m_next;
+} ;
+
+
+/**
+ * Merges the notes of clips in the order they start and gives step notes the
+ * length they're exported with, which is up to the next note.
+ */
+class MidiNoteStream
+{
+public:
+	// Default Beat Length in ticks for step notes
+	// TODO: The beat length actually varies per note, however the method that
+	// calculates it (InstrumentTrack::beatLen) requires a NotePlayHandle to do
+	// so. While we don't figure out a way to hold the beat length of each note
+	// on its member variables, we will use a default value as a beat length that
+	// will be used as an upper limit of the midi note length. This doesn't worsen
+	// the current logic used for MidiExport because right now the beat length is
+	// not even considered during the generation of the MIDI.
+	static constexpr int DefaultBeatLength = 1500;
+
+	//! Step notes end at @p cutPos at the latest
+	explicit MidiNoteStream(std::vector<MidiNoteCursor> cursors, int cutPos = INT_MAX);
+
+	bool atEnd() const;
+	int time() const;
+	MidiNote take();
+
+private:
+	//! Takes the notes starting next from the cursors
+	void fill();
+	//! Whether cursor @p a is at a later note than @p b, which orders the heap
+	bool later(std::size_t a, std::size_t b) const;
+
+	std::vector<MidiNoteCursor> m_cursors;
+	//! The cursors that aren't at the end, a min-heap by time
+	std::vector<std::size_t> m_heap;
+	int m_cutPos;
+
+	//! The notes starting at the same time, which are taken next
+	std::vector<MidiNote> m_pending;
+	std::size_t m_pendingIndex = 0;
+} ;
+
+
+} // namespace lmms
+
+#endif // LMMS_MIDI_NOTE_STREAM_H
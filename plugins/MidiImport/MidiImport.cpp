@@ -29,8 +29,13 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 
+#include <QThread>
+
+#include <atomic>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "MidiImport.h"
 #include "TrackContainer.h"
@@ -221,6 +226,16 @@ public:
 	bool isSF2;
 	bool hasNotes;
 	QString trackName;
+	//! What the notes are made from, collected while reading and only put
+	//! into clips at the end
+	struct NoteEvent
+	{
+		tick_t pos;
+		tick_t length;
+		int key;
+		volume_t volume;
+	};
+	std::vector<NoteEvent> notes;
 
 	smfMidiChannel * create( TrackContainer* tc, QString tn )
 	{
@@ -260,13 +275,9 @@ public:
 	}
 
 
-	void addNote( Note & n )
+	void addNote(const NoteEvent& n)
 	{
-		if (!p)
-		{
-			p = dynamic_cast<MidiClip*>(it->createClip(0));
-		}
-		p->addNote(n, false);
+		notes.push_back(n);
 		hasNotes = true;
 	}
 
@@ -274,21 +285,28 @@ public:
 	{
 		MidiClip * newMidiClip = nullptr;
 		TimePos lastEnd(0);
+		// the notes of newMidiClip, added all at once when it's complete
+		std::vector<Note> clipNotes;
 
-		p->rearrangeAllNotes();
-		for (auto n : p->notes())
+		std::stable_sort(notes.begin(), notes.end(),
+			[](const NoteEvent& a, const NoteEvent& b) { return a.pos < b.pos; });
+		for (const auto& n : notes)
 		{
-			if (!newMidiClip || n->pos() > lastEnd + DefaultTicksPerBar)
+			const auto pos = TimePos(n.pos);
+			if (!newMidiClip || pos > lastEnd + DefaultTicksPerBar)
 			{
-				TimePos pPos = TimePos(n->pos().getBar(), 0);
+				if (newMidiClip) { newMidiClip->addNotes(clipNotes); }
+				clipNotes.clear();
+
+				TimePos pPos = TimePos(pos.getBar(), 0);
 				newMidiClip = dynamic_cast<MidiClip*>(it->createClip(pPos));
 			}
-			lastEnd = n->pos() + n->length();
+			lastEnd = pos + n.length;
 
-			Note newNote(*n);
-			newNote.setPos(n->pos(newMidiClip->startPosition()));
-			newMidiClip->addNote(newNote, false);
+			clipNotes.emplace_back(n.length, pos - newMidiClip->startPosition(), n.key, n.volume);
 		}
+		if (newMidiClip) { newMidiClip->addNotes(clipNotes); }
+		notes = std::vector<NoteEvent>{};
 
 		delete p;
 		p = nullptr;
@@ -309,9 +327,22 @@ bool MidiImport::readSMF( TrackContainer* tc )
 
 	pd.setValue( 0 );
 
+	// parsing big files takes a while, keep the dialog responsive meanwhile
 	std::istringstream stream(readAllData().toStdString());
-	auto seq = new Alg_seq(stream, true);
-	seq->convert_to_beats();
+	Alg_seq* seq = nullptr;
+	std::atomic_bool parsed = false;
+	auto parser = std::thread([&]
+	{
+		seq = new Alg_seq(stream, true);
+		seq->convert_to_beats();
+		parsed = true;
+	});
+	while (!parsed)
+	{
+		qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+		QThread::msleep(10);
+	}
+	parser.join();
 
 	pd.setMaximum( seq->tracks()  + preTrackSteps );
 	pd.setValue( 1 );
@@ -450,11 +481,12 @@ bool MidiImport::readSMF( TrackContainer* tc )
 				smfMidiChannel * ch = chs[evt->chan].create( tc, trackName );
 				auto noteEvt = dynamic_cast<Alg_note_ptr>(evt);
 				int ticks = noteEvt->get_duration() * ticksPerBeat;
-				Note n( (ticks < 1 ? 1 : ticks ),
-						noteEvt->get_start_time() * ticksPerBeat,
-						noteEvt->get_identifier(),
-						noteEvt->get_loud() * (200.f / 127.f)); // Map from MIDI velocity to LMMS volume
-				ch->addNote( n );
+				ch->addNote({
+					static_cast<tick_t>(noteEvt->get_start_time() * ticksPerBeat),
+					(ticks < 1 ? 1 : ticks),
+					static_cast<int>(noteEvt->get_identifier()),
+					static_cast<volume_t>(noteEvt->get_loud() * (200.f / 127.f)) // Map from MIDI velocity to LMMS volume
+				});
 
 			}
 
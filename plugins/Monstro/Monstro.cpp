@@ -111,6 +111,21 @@ MonstroSynth::MonstroSynth( MonstroInstrument * _i, NotePlayHandle * _nph ) :
 }
 
 
+void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
+{
+	// the loop is made for every kind of o2-o3 modulation, so it doesn't
+	// have to look at it for every frame
+	switch( m_parent->m_o23Mod.value() )
+	{
+		case MOD_MIX: renderOutput<MOD_MIX>( _frames, _buf ); break;
+		case MOD_AM: renderOutput<MOD_AM>( _frames, _buf ); break;
+		case MOD_FM: renderOutput<MOD_FM>( _frames, _buf ); break;
+		case MOD_PM: renderOutput<MOD_PM>( _frames, _buf ); break;
+	}
+}
+
+
+template<int OMOD>
 void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 {
 	float modtmp; // temp variable for freq modulation
@@ -294,10 +309,6 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 	const bool o3s_mod = o3s_e1 != 0.0f || o3s_e2 != 0.0f || o3s_l1 != 0.0f || o3s_l2 != 0.0f;
 
 
-	//o2-o3 modulation
-
-	const int omod = m_parent->m_o23Mod.value();
-
 	// sync information
 
 	const bool o1ssr = m_parent->m_osc1SSR.value();
@@ -515,7 +526,7 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		}
 		
 		sample_t O2R = 0.;
-		if (len_r != 0.)
+		if (pd_r != 0.)
 		{
 			len_r = BandLimitedWave::pdToLen(pd_r);
 			if (m_counter2r > 0)
@@ -568,7 +579,7 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		}
 
 		// o2 modulation?
-		if( omod == MOD_PM )
+		if constexpr( OMOD == MOD_PM )
 		{
 			leftph += O2L * 0.5f;
 			rightph += O2R * 0.5f;
@@ -638,7 +649,7 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 			modulatevol( O3R, o3v )
 		}
 		// o2 modulation?
-		if( omod == MOD_AM )
+		if constexpr( OMOD == MOD_AM )
 		{
 			O3L = qBound( -MODCLIP, O3L * qMax( 0.0f, 1.0f + O2L ), MODCLIP );
 			O3R = qBound( -MODCLIP, O3R * qMax( 0.0f, 1.0f + O2R ), MODCLIP );
@@ -654,7 +665,7 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		len_l = 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o3l_f );
 		len_r = 1.0f / ( static_cast<float>( m_parent->m_samplerate ) / o3r_f );
 		// handle FM as PM
-		if( omod == MOD_FM )
+		if constexpr( OMOD == MOD_FM )
 		{
 			len_l += O2L * m_parent->m_fmCorrection;
 			len_r += O2R * m_parent->m_fmCorrection;
@@ -663,8 +674,8 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		o3r_p += len_r;
 
 		// integrator - very simple filter
-		sample_t L = O1L + O3L + ( omod == MOD_MIX ? O2L : 0.0f );
-		sample_t R = O1R + O3R + ( omod == MOD_MIX ? O2R : 0.0f );
+		sample_t L = O1L + O3L + ( OMOD == MOD_MIX ? O2L : 0.0f );
+		sample_t R = O1R + O3R + ( OMOD == MOD_MIX ? O2R : 0.0f );
 
 		_buf[f][0] = linearInterpolate( L, m_l_last, m_parent->m_integrator );
 		_buf[f][1] = linearInterpolate( R, m_r_last, m_parent->m_integrator );
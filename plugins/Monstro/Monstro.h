@@ -181,6 +181,9 @@ public:
 	void renderOutput( fpp_t _frames, sampleFrame * _buf );
 
 private:
+	//! renderOutput() for the o2-o3 modulation @p OMOD
+	template<int OMOD>
+	void renderOutput( fpp_t _frames, sampleFrame * _buf );
 
 	MonstroInstrument * m_parent;
 	NotePlayHandle * m_nph;
@@ -47,6 +47,13 @@ public:
 		return &m_controls;
 	}
 
+	f_cnt_t tailLength() const override
+	{
+		// the last tap, stepLength is in ms
+		return static_cast<f_cnt_t>( m_controls.m_steps.value() * m_controls.m_stepLength.value()
+			* m_sampleRate / 1000.0f );
+	}
+
 private:
 	void updateFilters( int begin, int end );
 	void runFilter( sampleFrame * dst, sampleFrame * src, StereoOnePole & filter, const fpp_t frames );
@@ -23,6 +23,7 @@
  */
 
 #include <QDomElement>
+#include <array>
 
 #include "Nes.h"
 
@@ -126,6 +127,31 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 	
 	int ch4EnvLen = wavelength( floorf( 240.0 / ( m_parent->m_ch4EnvLen.value() + 1 ) ) );
 	bool ch4EnvLoop = m_parent->m_ch4EnvLooped.value();
+
+	// the models don't change within a period
+	const bool ch1EnvEnabled = m_parent->m_ch1EnvEnabled.value();
+	const bool ch1SweepEnabled = m_parent->m_ch1SweepEnabled.value();
+	const float ch1Volume = m_parent->m_ch1Volume.value();
+	const bool ch2EnvEnabled = m_parent->m_ch2EnvEnabled.value();
+	const bool ch2SweepEnabled = m_parent->m_ch2SweepEnabled.value();
+	const float ch2Volume = m_parent->m_ch2Volume.value();
+	const float ch3Volume = m_parent->m_ch3Volume.value();
+	const bool ch4EnvEnabled = m_parent->m_ch4EnvEnabled.value();
+	const float ch4Volume = m_parent->m_ch4Volume.value();
+	const bool ch4NoiseMode = m_parent->m_ch4NoiseMode.value();
+	const float masterVol = m_parent->m_masterVol.value();
+
+	// the DC offset only depends on the levels of two channels, which are
+	// 0 to 15 each, so it doesn't need a powf() for every frame
+	static const auto dcOffsets = []
+	{
+		std::array<float, 31> offsets;
+		for( std::size_t level = 0; level < offsets.size(); ++level )
+		{
+			offsets[level] = 1.0f - powf( static_cast<float>( level ) / 30.0f, NES_DIST );
+		}
+		return offsets;
+	}();
 	
 	// processing variables for operators
 	int ch1;
@@ -201,9 +227,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pulse wave
 		if( m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN && ch1Enabled )
 		{
-			ch1Level = m_parent->m_ch1EnvEnabled.value()
-				? static_cast<int>( ( m_parent->m_ch1Volume.value() * m_ch1EnvValue ) / 15.0 )
-				: static_cast<int>( m_parent->m_ch1Volume.value() );
+			ch1Level = ch1EnvEnabled
+				? static_cast<int>( ( ch1Volume * m_ch1EnvValue ) / 15.0 )
+				: static_cast<int>( ch1Volume );
 			ch1 = m_ch1Counter > m_wlen1 * ch1DutyCycle 
 				? 0
 				: ch1Level;
@@ -215,7 +241,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch1SweepCounter >= ch1SweepRate )
 		{
 			m_ch1SweepCounter = 0;
-			if( m_parent->m_ch1SweepEnabled.value() && m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN )
+			if( ch1SweepEnabled && m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN )
 			{
 				// check if the sweep goes up or down
 				if( ch1Sweep > 0 )
@@ -255,9 +281,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pulse wave
 		if( m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN && ch2Enabled )
 		{
-			ch2Level = m_parent->m_ch2EnvEnabled.value()
-				? static_cast<int>( ( m_parent->m_ch2Volume.value() * m_ch2EnvValue ) / 15.0 )
-				: static_cast<int>( m_parent->m_ch2Volume.value() );
+			ch2Level = ch2EnvEnabled
+				? static_cast<int>( ( ch2Volume * m_ch2EnvValue ) / 15.0 )
+				: static_cast<int>( ch2Volume );
 			ch2 = m_ch2Counter > m_wlen2 * ch2DutyCycle 
 				? 0
 				: ch2Level;
@@ -269,7 +295,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch2SweepCounter >= ch2SweepRate )
 		{
 			m_ch2SweepCounter = 0;
-			if( m_parent->m_ch2SweepEnabled.value() && m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN )
+			if( ch2SweepEnabled && m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN )
 			{				
 				// check if the sweep goes up or down
 				if( ch2Sweep > 0 )
@@ -313,7 +339,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render triangle wave
 		if( m_wlen3 <= m_maxWlen && ch3Enabled )
 		{
-			ch3Level = static_cast<int>( m_parent->m_ch3Volume.value() );
+			ch3Level = static_cast<int>( ch3Volume );
 			ch3 = m_wlen3 ? TRIANGLE_WAVETABLE[ ( m_ch3Counter * 32 ) / m_wlen3 ] : 0;
 			ch3 = ( ch3 * ch3Level ) / 15;
 		}
@@ -331,9 +357,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pseudo noise 
 		if( ch4Enabled )
 		{
-			ch4Level = m_parent->m_ch4EnvEnabled.value()
-				? ( static_cast<int>( m_parent->m_ch4Volume.value() ) * m_ch4EnvValue ) / 15
-				: static_cast<int>( m_parent->m_ch4Volume.value() );
+			ch4Level = ch4EnvEnabled
+				? ( static_cast<int>( ch4Volume ) * m_ch4EnvValue ) / 15
+				: static_cast<int>( ch4Volume );
 			ch4 = LFSR()
 				? ch4Level
 				: 0;
@@ -345,7 +371,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch4Counter >= m_wlen4 )
 		{
 			m_ch4Counter = 0;
-			updateLFSR( m_parent->m_ch4NoiseMode.value() );
+			updateLFSR( ch4NoiseMode );
 		}
 		m_ch4EnvCounter++;
 		if( m_ch4EnvCounter >= ch4EnvLen )
@@ -401,7 +427,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		m_12Last = pin1;
 
 		// compensate DC offset
-		pin1 += 1.0f - signedPow( static_cast<float>( ch1Level + ch2Level ) / 30.0f, NES_DIST );
+		pin1 += dcOffsets[ch1Level + ch2Level];
 		
 		pin1 *= NES_MIXING_12;
 
@@ -419,11 +445,11 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		m_34Last = pin2;
 		
 		// compensate DC offset
-		pin2 += 1.0f - signedPow( static_cast<float>( ch3Level + ch4Level ) / 30.0f, NES_DIST );
+		pin2 += dcOffsets[ch3Level + ch4Level];
 		
 		pin2 *= NES_MIXING_34;
 		
-		const float mixdown = ( pin1 + pin2 ) * NES_MIXING_ALL * m_parent->m_masterVol.value();
+		const float mixdown = ( pin1 + pin2 ) * NES_MIXING_ALL * masterVol;
 
 		buf[f][0] = mixdown;
 		buf[f][1] = mixdown;
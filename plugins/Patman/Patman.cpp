@@ -25,9 +25,13 @@
 
 #include "Patman.h"
 
+#include <QDateTime>
 #include <QDragEnterEvent>
+#include <QFileInfo>
+#include <QHash>
 #include <QPainter>
 #include <QDomElement>
+#include <mutex>
 
 #include "ConfigManager.h"
 #include "endian_handling.h"
@@ -35,6 +39,7 @@
 #include "FileDialog.h"
 #include "gui_templates.h"
 #include "InstrumentTrack.h"
+#include "MemoryReport.h"
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
 #include "PixmapButton.h"
@@ -77,6 +82,23 @@ PLUGIN_EXPORT Plugin * lmms_plugin_main( Model *m, void * )
 }
 
 
+namespace
+{
+
+//! A bank of tracks playing the same patch decodes it only once
+struct CachedPatch
+{
+	QDateTime modified;
+	qint64 size;
+	std::weak_ptr<const QVector<std::shared_ptr<Sample>>> samples;
+};
+
+std::mutex s_patchCacheMutex;
+QHash<QString, CachedPatch> s_patchCache;
+
+} // namespace
+
+
 
 
 PatmanInstrument::PatmanInstrument( InstrumentTrack * _instrument_track ) :
@@ -133,6 +155,17 @@ QString PatmanInstrument::nodeName() const
 
 
 
+void PatmanInstrument::reportMemoryUsage( MemoryReport & report ) const
+{
+	for( const auto & sample : *m_patchSamples )
+	{
+		report.addSample( *sample, tr( "Patch sample" ) );
+	}
+}
+
+
+
+
 void PatmanInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
@@ -215,6 +248,46 @@ PatmanInstrument::LoadError PatmanInstrument::loadPatch(
 {
 	unloadCurrentPatch();
 
+	const auto fileInfo = QFileInfo( _filename );
+	const auto key = fileInfo.canonicalFilePath();
+	const auto modified = fileInfo.lastModified();
+	const auto size = fileInfo.size();
+	if( !key.isEmpty() )
+	{
+		const auto lock = std::lock_guard{ s_patchCacheMutex };
+		const auto it = s_patchCache.constFind( key );
+		if( it != s_patchCache.constEnd() && it->modified == modified && it->size == size )
+		{
+			if( auto samples = it->samples.lock() )
+			{
+				m_patchSamples = std::move( samples );
+				return LoadError::OK;
+			}
+		}
+	}
+
+	auto samples = std::make_shared<PatchSamples>();
+	const LoadError error = decodePatch( _filename, *samples );
+	m_patchSamples = std::move( samples );
+
+	if( error == LoadError::OK && !key.isEmpty() )
+	{
+		const auto lock = std::lock_guard{ s_patchCacheMutex };
+		for( auto it = s_patchCache.begin(); it != s_patchCache.end(); )
+		{
+			it = it->samples.expired() ? s_patchCache.erase( it ) : std::next( it );
+		}
+		s_patchCache[key] = CachedPatch{ modified, size, m_patchSamples };
+	}
+	return error;
+}
+
+
+
+
+PatmanInstrument::LoadError PatmanInstrument::decodePatch(
+				const QString & _filename, PatchSamples & samples )
+{
 	FILE * fd = fopen( _filename.toUtf8().constData() , "rb" );
 	if( !fd )
 	{
@@ -364,7 +437,7 @@ PatmanInstrument::LoadError PatmanInstrument::loadPatch(
 			psample->setLoopEndFrame( loop_end );
 		}
 
-		m_patchSamples.push_back(psample);
+		samples.push_back(psample);
 
 		delete[] wave_samples;
 		delete[] data;
@@ -378,10 +451,7 @@ PatmanInstrument::LoadError PatmanInstrument::loadPatch(
 
 void PatmanInstrument::unloadCurrentPatch()
 {
-	while( !m_patchSamples.empty() )
-	{
-		m_patchSamples.pop_back();
-	}
+	m_patchSamples = std::make_shared<const PatchSamples>();
 }
 
 
@@ -394,7 +464,7 @@ void PatmanInstrument::selectSample( NotePlayHandle * _n )
 	float min_dist = HUGE_VALF;
 	std::shared_ptr<Sample> sample = nullptr;
 
-	for (const auto& patchSample : m_patchSamples)
+	for (const auto& patchSample : *m_patchSamples)
 	{
 		float patch_freq = patchSample->frequency();
 		float dist = freq >= patch_freq ? freq / patch_freq :
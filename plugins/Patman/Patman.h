@@ -72,6 +72,8 @@ public:
 
 	QString nodeName() const override;
 
+	void reportMemoryUsage( MemoryReport & report ) const override;
+
 	f_cnt_t desiredReleaseFrames() const override
 	{
 		return( 128 );
@@ -93,8 +95,11 @@ private:
 		std::shared_ptr<Sample> sample;
 	};
 
+	using PatchSamples = QVector<std::shared_ptr<Sample>>;
+
 	QString m_patchFile;
-	QVector<std::shared_ptr<Sample>> m_patchSamples;
+	//! Shared with every other instance that loaded the same file, never changed once loaded
+	std::shared_ptr<const PatchSamples> m_patchSamples = std::make_shared<const PatchSamples>();
 	BoolModel m_loopedModel;
 	BoolModel m_tunedModel;
 
@@ -110,6 +115,7 @@ private:
 	} ;
 
 	LoadError loadPatch( const QString & _filename );
+	static LoadError decodePatch( const QString & _filename, PatchSamples & samples );
 	void unloadCurrentPatch();
 
 	void selectSample( NotePlayHandle * _n );
@@ -26,7 +26,7 @@
 #include "embed.h"
 #include "plugin_export.h"
 
-#define DB2LIN(X) pow(10, X / 20.0f);
+#define DB2LIN(X) pow(10, (X) / 20.0f)
 
 namespace lmms
 {
@@ -52,7 +52,11 @@ Plugin::Descriptor PLUGIN_EXPORT reverbsc_plugin_descriptor =
 
 ReverbSCEffect::ReverbSCEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key ) :
 	Effect( &reverbsc_plugin_descriptor, parent, key ),
-	m_reverbSCControls( this )
+	m_reverbSCControls( this ),
+	m_inL( Engine::audioEngine()->framesPerPeriod() ),
+	m_inR( Engine::audioEngine()->framesPerPeriod() ),
+	m_outL( Engine::audioEngine()->framesPerPeriod() ),
+	m_outR( Engine::audioEngine()->framesPerPeriod() )
 {
 	sp_create(&sp);
 	sp->sr = Engine::audioEngine()->processingSampleRate();
@@ -86,7 +90,6 @@ bool ReverbSCEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	const float d = dryLevel();
 	const float w = wetLevel();
 
-	SPFLOAT tmpL, tmpR;
 	SPFLOAT dcblkL, dcblkR;
 
 	ValueBuffer * inGainBuf = m_reverbSCControls.m_inputGainModel.valueBuffer();
@@ -94,29 +97,46 @@ bool ReverbSCEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	ValueBuffer * colorBuf = m_reverbSCControls.m_colorModel.valueBuffer();
 	ValueBuffer * outGainBuf = m_reverbSCControls.m_outputGainModel.valueBuffer();
 
+	// the gains are only converted once if they aren't automated
+	const auto inGainValue = (SPFLOAT)DB2LIN(m_reverbSCControls.m_inputGainModel.value());
+	const auto outGainValue = (SPFLOAT)DB2LIN(m_reverbSCControls.m_outputGainModel.value());
+
 	for( fpp_t f = 0; f < frames; ++f )
 	{
-		auto s = std::array{buf[f][0], buf[f][1]};
-
-		const auto inGain
-			= (SPFLOAT)DB2LIN((inGainBuf ? inGainBuf->values()[f] : m_reverbSCControls.m_inputGainModel.value()));
-		const auto outGain
-			= (SPFLOAT)DB2LIN((outGainBuf ? outGainBuf->values()[f] : m_reverbSCControls.m_outputGainModel.value()));
-
-		s[0] *= inGain;
-		s[1] *= inGain;
-		revsc->feedback = (SPFLOAT)(sizeBuf ?
-			sizeBuf->values()[f]
-			: m_reverbSCControls.m_sizeModel.value());
+		const auto inGain = inGainBuf ? (SPFLOAT)DB2LIN(inGainBuf->values()[f]) : inGainValue;
+		m_inL[f] = buf[f][0] * inGain;
+		m_inR[f] = buf[f][1] * inGain;
+	}
 
-		revsc->lpfreq = (SPFLOAT)(colorBuf ?
-			colorBuf->values()[f]
-			: m_reverbSCControls.m_colorModel.value());
+	if( sizeBuf || colorBuf )
+	{
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			revsc->feedback = (SPFLOAT)(sizeBuf ?
+				sizeBuf->values()[f]
+				: m_reverbSCControls.m_sizeModel.value());
+
+			revsc->lpfreq = (SPFLOAT)(colorBuf ?
+				colorBuf->values()[f]
+				: m_reverbSCControls.m_colorModel.value());
+
+			sp_revsc_compute(sp, revsc, &m_inL[f], &m_inR[f], &m_outL[f], &m_outR[f]);
+		}
+	}
+	else
+	{
+		// neither changes during the period, so the reverb can go through all of it at once
+		revsc->feedback = (SPFLOAT)m_reverbSCControls.m_sizeModel.value();
+		revsc->lpfreq = (SPFLOAT)m_reverbSCControls.m_colorModel.value();
+		sp_revsc_compute_block(sp, revsc, m_inL.data(), m_inR.data(), m_outL.data(), m_outR.data(), frames);
+	}
 
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		const auto outGain = outGainBuf ? (SPFLOAT)DB2LIN(outGainBuf->values()[f]) : outGainValue;
 
-		sp_revsc_compute(sp, revsc, &s[0], &s[1], &tmpL, &tmpR);
-		sp_dcblock_compute(sp, dcblk[0], &tmpL, &dcblkL);
-		sp_dcblock_compute(sp, dcblk[1], &tmpR, &dcblkR);
+		sp_dcblock_compute(sp, dcblk[0], &m_outL[f], &dcblkL);
+		sp_dcblock_compute(sp, dcblk[1], &m_outR[f], &dcblkR);
 		buf[f][0] = d * buf[f][0] + w * dcblkL * outGain;
 		buf[f][1] = d * buf[f][1] + w * dcblkR * outGain;
 
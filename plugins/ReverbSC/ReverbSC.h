@@ -26,6 +26,8 @@
 #ifndef REVERBSC_H
 #define REVERBSC_H
 
+#include <vector>
+
 #include "Effect.h"
 #include "ReverbSCControls.h"
 
@@ -52,10 +54,21 @@ public:
 		return &m_reverbSCControls;
 	}
 
+	f_cnt_t tailLength() const override
+	{
+		// the longest delay line of the reverb, it decays continuously after that
+		return Engine::audioEngine()->processingSampleRate() / 10;
+	}
+
 	void changeSampleRate();
 
 private:
 	ReverbSCControls m_reverbSCControls;
+	//! The input with its gain and the reverb, by channel
+	std::vector<SPFLOAT> m_inL;
+	std::vector<SPFLOAT> m_inR;
+	std::vector<SPFLOAT> m_outL;
+	std::vector<SPFLOAT> m_outR;
 	sp_data *sp;
 	sp_revsc *revsc;
 	sp_dcblock *dcblk[2];
@@ -161,14 +161,25 @@ static int init_delay_line(sp_revsc *p, sp_revsc_dl *lp, int n)
 
 
 int sp_revsc_compute(sp_data *sp, sp_revsc *p, SPFLOAT *in1, SPFLOAT *in2, SPFLOAT *out1, SPFLOAT *out2)
+{
+    return sp_revsc_compute_block(sp, p, in1, in2, out1, out2, 1);
+}
+
+/* Same as sp_revsc_compute, for a block of samples with the same feedback */
+/* and tone, so they are only looked at once                               */
+
+int sp_revsc_compute_block(sp_data *sp, sp_revsc *p, const SPFLOAT *in1, const SPFLOAT *in2,
+                           SPFLOAT *out1, SPFLOAT *out2, int frames)
 {
     SPFLOAT ainL, ainR, aoutL, aoutR;
     SPFLOAT vm1, v0, v1, v2, am1, a0, a1, a2, frac;
     sp_revsc_dl *lp;
     int readPos;
     uint32_t n;
+    int i;
     int bufferSize; /* Local copy */
     SPFLOAT dampFact = p->dampFact;
+    SPFLOAT feedback = p->feedback;
 
     if (p->initDone <= 0) return SP_NOT_OK;
 
@@ -180,97 +191,100 @@ int sp_revsc_compute(sp_data *sp, sp_revsc *p, SPFLOAT *in1, SPFLOAT *in2, SPFLO
         dampFact = p->dampFact = dampFact - sqrt(dampFact * dampFact - 1.0);
     }
 
-    /* calculate "resultant junction pressure" and mix to input signals */
+    for (i = 0; i < frames; i++) {
 
-    ainL = aoutL = aoutR = 0.0;
-    for (n = 0; n < 8; n++) {
-        ainL += p->delayLines[n].filterState;
-    }
-    ainL *= jpScale;
-    ainR = ainL + *in2;
-    ainL = ainL + *in1;
+        /* calculate "resultant junction pressure" and mix to input signals */
 
-    /* loop through all delay lines */
+        ainL = aoutL = aoutR = 0.0;
+        for (n = 0; n < 8; n++) {
+            ainL += p->delayLines[n].filterState;
+        }
+        ainL *= jpScale;
+        ainR = ainL + in2[i];
+        ainL = ainL + in1[i];
 
-    for (n = 0; n < 8; n++) {
-        lp = &p->delayLines[n];
-        bufferSize = lp->bufferSize;
+        /* loop through all delay lines */
 
-        /* send input signal and feedback to delay line */
+        for (n = 0; n < 8; n++) {
+            lp = &p->delayLines[n];
+            bufferSize = lp->bufferSize;
 
-        lp->buf[lp->writePos] = (SPFLOAT) ((n & 1 ? ainR : ainL)
-                                 - lp->filterState);
-        if (++lp->writePos >= bufferSize) {
-            lp->writePos -= bufferSize;
-        }
+            /* send input signal and feedback to delay line */
 
-        /* read from delay line with cubic interpolation */
+            lp->buf[lp->writePos] = (SPFLOAT) ((n & 1 ? ainR : ainL)
+                                     - lp->filterState);
+            if (++lp->writePos >= bufferSize) {
+                lp->writePos -= bufferSize;
+            }
 
-        if (lp->readPosFrac >= DELAYPOS_SCALE) {
-            lp->readPos += (lp->readPosFrac >> DELAYPOS_SHIFT);
-            lp->readPosFrac &= DELAYPOS_MASK;
-        }
-        if (lp->readPos >= bufferSize)
-        lp->readPos -= bufferSize;
-        readPos = lp->readPos;
-        frac = (SPFLOAT) lp->readPosFrac * (1.0 / (SPFLOAT) DELAYPOS_SCALE);
+            /* read from delay line with cubic interpolation */
 
-        /* calculate interpolation coefficients */
+            if (lp->readPosFrac >= DELAYPOS_SCALE) {
+                lp->readPos += (lp->readPosFrac >> DELAYPOS_SHIFT);
+                lp->readPosFrac &= DELAYPOS_MASK;
+            }
+            if (lp->readPos >= bufferSize)
+            lp->readPos -= bufferSize;
+            readPos = lp->readPos;
+            frac = (SPFLOAT) lp->readPosFrac * (1.0 / (SPFLOAT) DELAYPOS_SCALE);
 
-        a2 = frac * frac; a2 -= 1.0; a2 *= (1.0 / 6.0);
-        a1 = frac; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
-        a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac;
+            /* calculate interpolation coefficients */
 
-        /* read four samples for interpolation */
+            a2 = frac * frac; a2 -= 1.0; a2 *= (1.0 / 6.0);
+            a1 = frac; a1 += 1.0; a1 *= 0.5; am1 = a1 - 1.0;
+            a0 = 3.0 * a2; a1 -= a0; am1 -= a2; a0 -= frac;
 
-        if (readPos > 0 && readPos < (bufferSize - 2)) {
-            vm1 = (SPFLOAT) (lp->buf[readPos - 1]);
-            v0  = (SPFLOAT) (lp->buf[readPos]);
-            v1  = (SPFLOAT) (lp->buf[readPos + 1]);
-            v2  = (SPFLOAT) (lp->buf[readPos + 2]);
-        }
-        else {
-
-        /* at buffer wrap-around, need to check index */
-
-        if (--readPos < 0) readPos += bufferSize;
-            vm1 = (SPFLOAT) lp->buf[readPos];
-        if (++readPos >= bufferSize) readPos -= bufferSize;
-            v0 = (SPFLOAT) lp->buf[readPos];
-        if (++readPos >= bufferSize) readPos -= bufferSize;
-            v1 = (SPFLOAT) lp->buf[readPos];
-        if (++readPos >= bufferSize) readPos -= bufferSize;
-            v2 = (SPFLOAT) lp->buf[readPos];
-        }
-        v0 = (am1 * vm1 + a0 * v0 + a1 * v1 + a2 * v2) * frac + v0;
+            /* read four samples for interpolation */
 
-        /* update buffer read position */
+            if (readPos > 0 && readPos < (bufferSize - 2)) {
+                vm1 = (SPFLOAT) (lp->buf[readPos - 1]);
+                v0  = (SPFLOAT) (lp->buf[readPos]);
+                v1  = (SPFLOAT) (lp->buf[readPos + 1]);
+                v2  = (SPFLOAT) (lp->buf[readPos + 2]);
+            }
+            else {
 
-        lp->readPosFrac += lp->readPosFrac_inc;
+            /* at buffer wrap-around, need to check index */
 
-        /* apply feedback gain and lowpass filter */
+            if (--readPos < 0) readPos += bufferSize;
+                vm1 = (SPFLOAT) lp->buf[readPos];
+            if (++readPos >= bufferSize) readPos -= bufferSize;
+                v0 = (SPFLOAT) lp->buf[readPos];
+            if (++readPos >= bufferSize) readPos -= bufferSize;
+                v1 = (SPFLOAT) lp->buf[readPos];
+            if (++readPos >= bufferSize) readPos -= bufferSize;
+                v2 = (SPFLOAT) lp->buf[readPos];
+            }
+            v0 = (am1 * vm1 + a0 * v0 + a1 * v1 + a2 * v2) * frac + v0;
 
-        v0 *= (SPFLOAT) p->feedback;
-        v0 = (lp->filterState - v0) * dampFact + v0;
-        lp->filterState = v0;
+            /* update buffer read position */
 
-        /* mix to output */
+            lp->readPosFrac += lp->readPosFrac_inc;
 
-        if (n & 1) {
-            aoutR += v0;
-        }else{
-            aoutL += v0;
-        }
+            /* apply feedback gain and lowpass filter */
+
+            v0 *= feedback;
+            v0 = (lp->filterState - v0) * dampFact + v0;
+            lp->filterState = v0;
 
-        /* start next random line segment if current one has reached endpoint */
+            /* mix to output */
 
-        if (--(lp->randLine_cnt) <= 0) {
-            next_random_lineseg(p, lp, n);
+            if (n & 1) {
+                aoutR += v0;
+            }else{
+                aoutL += v0;
+            }
+
+            /* start next random line segment if current one has reached endpoint */
+
+            if (--(lp->randLine_cnt) <= 0) {
+                next_random_lineseg(p, lp, n);
+            }
         }
-    }
-    /* someday, use aoutR for multimono out */
+        /* someday, use aoutR for multimono out */
 
-    *out1  = aoutL * outputGain;
-    *out2 = aoutR * outputGain;
+        out1[i] = aoutL * outputGain;
+        out2[i] = aoutR * outputGain;
+    }
     return SP_OK;
 }
@@ -25,6 +25,7 @@
 
 #include "Sf2Player.h"
 
+#include <cstring>
 #include <fluidsynth.h>
 #include <QDebug>
 #include <QDomElement>
@@ -38,6 +39,7 @@
 #include "InstrumentTrack.h"
 #include "InstrumentPlayHandle.h"
 #include "Knob.h"
+#include "MixHelpers.h"
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
 #include "PixmapButton.h"
@@ -104,6 +106,33 @@ private:
 	float m_coarseTune;
 };
 
+/**
+ * A font shared by all instances playing its file. It's loaded by a synth of
+ * its own, which doesn't play, so loading doesn't keep any instance waiting,
+ * and added to the synth of every instance. Its loader unloads it - and with
+ * it its samples - once the last instance let go of it.
+ */
+class Sf2Font
+{
+public:
+	Sf2Font(fluid_synth_t* loader, fluid_sfont_t* font, const QString& file) :
+		loader(loader),
+		fluidFont(font),
+		file(file)
+	{
+	}
+
+	fluid_synth_t* loader;
+	fluid_sfont_t* fluidFont;
+	QString file;
+	int refCount = 1;
+};
+
+QMutex Sf2Instrument::s_fontsMutex;
+QMap<QString, Sf2Font*> Sf2Instrument::s_fonts;
+
+
+
 struct Sf2PluginData
 {
 	int midiNote;
@@ -367,15 +396,27 @@ QString Sf2Instrument::nodeName() const
 
 void Sf2Instrument::freeFont()
 {
-	m_synthMutex.lock();
+	s_fontsMutex.lock();
 
+	m_synthMutex.lock();
+	Sf2Font* font = m_font;
 	if (m_font != nullptr)
 	{
-		fluid_synth_sfunload(m_synth, m_fontId, true);
+		// our voices mustn't play it any more
+		fluid_synth_all_sounds_off(m_synth, -1);
+		fluid_synth_remove_sfont(m_synth, m_font->fluidFont);
 		m_font = nullptr;
 	}
-
 	m_synthMutex.unlock();
+
+	if (font != nullptr && --font->refCount == 0)
+	{
+		s_fonts.remove(font->file);
+		delete_fluid_synth(font->loader);
+		delete font;
+	}
+
+	s_fontsMutex.unlock();
 }
 
 
@@ -391,27 +432,40 @@ void Sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 	// free the soundfont if one is selected
 	freeFont();
 
-	m_synthMutex.lock();
-
-	bool loaded = false;
-	if (fluid_is_soundfont(sf2Ascii))
+	const auto absolutePath = QString::fromLocal8Bit(sf2Ascii);
+	s_fontsMutex.lock();
+	Sf2Font* font = s_fonts.value(absolutePath);
+	if (font != nullptr)
 	{
-		m_fontId = fluid_synth_sfload(m_synth, sf2Ascii, true);
-
-		if (fluid_synth_sfcount(m_synth) > 0)
+		++font->refCount;
+	}
+	else if (fluid_is_soundfont(sf2Ascii))
+	{
+		fluid_synth_t* loader = new_fluid_synth(m_settings);
+		if (fluid_synth_sfload(loader, sf2Ascii, true) >= 0 && fluid_synth_sfcount(loader) > 0)
 		{
-			// Grab this sf from the top of the stack and add to list
-			m_font = fluid_synth_get_sfont(m_synth, 0);
-			loaded = true;
+			font = new Sf2Font(loader, fluid_synth_get_sfont(loader, 0), absolutePath);
+			s_fonts.insert(absolutePath, font);
+		}
+		else
+		{
+			delete_fluid_synth(loader);
 		}
 	}
 
-	if (!loaded)
+	if (font != nullptr)
 	{
-		collectErrorForUI(Sf2Instrument::tr("A soundfont %1 could not be loaded.").arg(QFileInfo(_sf2File).baseName()));
+		m_synthMutex.lock();
+		m_font = font;
+		m_fontId = fluid_synth_add_sfont(m_synth, m_font->fluidFont);
+		m_synthMutex.unlock();
 	}
+	s_fontsMutex.unlock();
 
-	m_synthMutex.unlock();
+	if (font == nullptr)
+	{
+		collectErrorForUI(Sf2Instrument::tr("A soundfont %1 could not be loaded.").arg(QFileInfo(_sf2File).baseName()));
+	}
 
 	if( m_fontId >= 0 )
 	{
@@ -441,7 +495,9 @@ void Sf2Instrument::updatePatch()
 {
 	if( m_bankNum.value() >= 0 && m_patchNum.value() >= 0 )
 	{
-		fluid_synth_program_select( m_synth, m_channel, m_fontId,
+		// every synth sharing the font renumbers it when adding it
+		const int fontId = m_font != nullptr ? fluid_sfont_get_id( m_font->fluidFont ) : m_fontId;
+		fluid_synth_program_select( m_synth, m_channel, fontId,
 				m_bankNum.value(), m_patchNum.value() );
 	}
 }
@@ -582,12 +638,12 @@ void Sf2Instrument::reloadSynth()
 	{
 		// Now, delete the old one and replace
 		m_synthMutex.lock();
-		fluid_synth_remove_sfont( m_synth, m_font );
+		fluid_synth_remove_sfont( m_synth, m_font->fluidFont );
 		delete_fluid_synth( m_synth );
 
 		// New synth
 		m_synth = new_fluid_synth( m_settings );
-		m_fontId = fluid_synth_add_sfont( m_synth, m_font );
+		m_fontId = fluid_synth_add_sfont( m_synth, m_font->fluidFont );
 		m_synthMutex.unlock();
 
 		// synth program change (set bank and patch)
@@ -708,10 +764,9 @@ void Sf2Instrument::playNote( NotePlayHandle * _n, sampleFrame * )
 }
 
 
+// with m_synthMutex locked, like noteOff() and renderFrames()
 void Sf2Instrument::noteOn( Sf2PluginData * n )
 {
-	m_synthMutex.lock();
-
 	// get list of current voice IDs so we can easily spot the new
 	// voice after the fluid_synth_noteon() call
 	const int poly = fluid_synth_get_polyphony( m_synth );
@@ -758,8 +813,6 @@ void Sf2Instrument::noteOn( Sf2PluginData * n )
 	}
 #endif
 
-	m_synthMutex.unlock();
-
 	m_notesRunningMutex.lock();
 	++m_notesRunning[ n->midiNote ];
 	m_notesRunningMutex.unlock();
@@ -775,9 +828,7 @@ void Sf2Instrument::noteOff( Sf2PluginData * n )
 
 	if( notes <= 0 )
 	{
-		m_synthMutex.lock();
 		fluid_synth_noteoff( m_synth, m_channel, n->midiNote );
-		m_synthMutex.unlock();
 	}
 }
 
@@ -786,30 +837,50 @@ void Sf2Instrument::play( sampleFrame * _working_buffer )
 {
 	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
 
+	// the GUI only holds the synth for a moment, to hand over a font or a
+	// new synth, which is worth a period of silence rather than waiting -
+	// the notes are played in the next one then
+	if( !m_synthMutex.tryLock() )
+	{
+		std::memset( _working_buffer, 0, frames * sizeof( sampleFrame ) );
+		return;
+	}
+
 	// set midi pitch for this period
 	const int currentMidiPitch = instrumentTrack()->midiPitch();
 	if( m_lastMidiPitch != currentMidiPitch )
 	{
 		m_lastMidiPitch = currentMidiPitch;
-		m_synthMutex.lock();
 		fluid_synth_pitch_bend( m_synth, m_channel, m_lastMidiPitch );
-		m_synthMutex.unlock();
 	}
 
 	const int currentMidiPitchRange = instrumentTrack()->midiPitchRange();
 	if( m_lastMidiPitchRange != currentMidiPitchRange )
 	{
 		m_lastMidiPitchRange = currentMidiPitchRange;
-		m_synthMutex.lock();
 		fluid_synth_pitch_wheel_sens( m_synth, m_channel, m_lastMidiPitchRange );
-		m_synthMutex.unlock();
 	}
 	// if we have no new noteons/noteoffs, just render a period and call it a day
 	if( m_playingNotes.isEmpty() )
 	{
+		if( m_idle )
+		{
+			m_synthMutex.unlock();
+			std::memset( _working_buffer, 0, frames * sizeof( sampleFrame ) );
+			return;
+		}
 		renderFrames( frames, _working_buffer );
+
+		// once the last voice is gone, and with it everything but the tails
+		// of reverb and chorus, nothing sounds until the next note, so most
+		// tracks of an arrangement don't render most of the time
+		m_idle = !m_reverbOn.value() && !m_chorusOn.value()
+			&& fluid_synth_get_active_voice_count( m_synth ) == 0
+			&& MixHelpers::isSilent( _working_buffer, frames );
+		m_synthMutex.unlock();
 		return;
 	}
+	m_idle = false;
 
 	// processing loop
 	// go through noteplayhandles in processing order
@@ -865,12 +936,13 @@ void Sf2Instrument::play( sampleFrame * _working_buffer )
 	{
 		renderFrames( frames - currentFrame, _working_buffer + currentFrame );
 	}
+
+	m_synthMutex.unlock();
 }
 
 
 void Sf2Instrument::renderFrames( f_cnt_t frames, sampleFrame * buf )
 {
-	m_synthMutex.lock();
 	fluid_synth_get_gain(m_synth); // This flushes voice updates as a side effect
 	if( m_internalSampleRate < Engine::audioEngine()->processingSampleRate() &&
 							m_srcState != nullptr )
@@ -907,7 +979,6 @@ void Sf2Instrument::renderFrames( f_cnt_t frames, sampleFrame * buf )
 	{
 		fluid_synth_write_float( m_synth, frames, buf, 0, 2, buf, 1, 2 );
 	}
-	m_synthMutex.unlock();
 }
 
 
@@ -919,7 +990,9 @@ void Sf2Instrument::deleteNotePluginData( NotePlayHandle * _n )
 	if( ! pluginData->noteOffSent ) // if we for some reason haven't noteoffed the note before it gets deleted,
 									// do it here
 	{
+		m_synthMutex.lock();
 		noteOff( pluginData );
+		m_synthMutex.unlock();
 		m_playingNotesMutex.lock();
 		if( m_playingNotes.indexOf( _n ) >= 0 )
 		{
@@ -28,6 +28,7 @@
 #define SF2_PLAYER_H
 
 #include <fluidsynth/types.h>
+#include <QMap>
 #include <QMutex>
 #include <samplerate.h>
 
@@ -119,7 +120,7 @@ private:
 	fluid_settings_t* m_settings;
 	fluid_synth_t* m_synth;
 
-	fluid_sfont_t* m_font;
+	Sf2Font* m_font;
 
 	int m_fontId;
 	QString m_filename;
@@ -131,11 +132,18 @@ private:
 	QMutex m_synthMutex;
 	QMutex m_loadMutex;
 
+	// the fonts loaded by any instance, by absolute path, so every file is
+	// only loaded once however many instances play it
+	static QMutex s_fontsMutex;
+	static QMap<QString, Sf2Font*> s_fonts;
+
 	std::array<int, 128> m_notesRunning = {};
 	sample_rate_t m_internalSampleRate;
 	int m_lastMidiPitch;
 	int m_lastMidiPitchRange;
 	int m_channel;
+	// whether the synth has nothing to render until the next note
+	bool m_idle = false;
 
 	gui::LcdSpinBoxModel m_bankNum;
 	gui::LcdSpinBoxModel m_patchNum;
@@ -38,6 +38,11 @@ float frnd(float range)
 #include <cmath>
 
 #include <QDomElement>
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <memory>
+#include <vector>
 
 #include "Sfxr.h"
 #include "AudioEngine.h"
@@ -47,6 +52,8 @@ float frnd(float range)
 #include "NotePlayHandle.h"
 #include "PixmapButton.h"
 #include "MidiEvent.h"
+#include "RenderCache.h"
+#include "SampleBuffer.h"
 
 #include "embed.h"
 
@@ -442,6 +449,72 @@ QString SfxrInstrument::nodeName() const
 
 
 
+namespace
+{
+
+//! Sounds up to this long at sfxr's own rate of 44100 Hz are cached
+constexpr int MaxCachedFrames = 10 * 44100;
+
+//! A sound played back from the RenderCache, or rendered by its own synth.
+//! Either way it's at sfxr's own rate, the note's pitch only changes how
+//! quickly it is played.
+struct SfxrNote
+{
+	MM_OPERATORS
+
+	RenderCache::Key key{"sfxr"};
+	std::shared_ptr<const SampleBuffer> cached;
+	std::unique_ptr<SfxrSynth> synth;
+	//! What the synth rendered so far, while it's recorded for the cache
+	std::vector<sampleFrame> recorded;
+	bool recording = false;
+	std::size_t played = 0;
+
+	bool isPlaying() const
+	{
+		return cached ? played < cached->size() : synth->isPlaying();
+	}
+
+	void update( sampleFrame * buffer, const int32_t frameNum )
+	{
+		if( cached )
+		{
+			const auto count = std::min<std::size_t>( frameNum, cached->size() - std::min( played, cached->size() ) );
+			std::copy_n( cached->data() + played, count, buffer );
+			std::fill_n( buffer + count, frameNum - count, sampleFrame{} );
+		}
+		else
+		{
+			synth->update( buffer, frameNum );
+			if( recording )
+			{
+				record( buffer, frameNum );
+			}
+		}
+		played += frameNum;
+	}
+
+	void record( const sampleFrame * buffer, const int32_t frameNum )
+	{
+		recorded.insert( recorded.end(), buffer, buffer + frameNum );
+		if( !synth->isPlaying() )
+		{
+			RenderCache::put( key, std::make_shared<const SampleBuffer>( std::move( recorded ), 44100 ) );
+			recording = false;
+		}
+		else if( recorded.size() > MaxCachedFrames )
+		{
+			recorded = {};
+			recording = false;
+		}
+	}
+};
+
+} // namespace
+
+
+
+
 void SfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 {
 	float currentSampleRate = Engine::audioEngine()->processingSampleRate();
@@ -450,9 +523,31 @@ void SfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
 	const f_cnt_t offset = _n->noteOffset();
 	if (!_n->m_pluginData)
 	{
-		_n->m_pluginData = new SfxrSynth( this );
+		auto note = new SfxrNote;
+		for( const FloatModel* model : std::initializer_list<const FloatModel*>{ &m_attModel, &m_holdModel, &m_susModel, &m_decModel,
+			&m_startFreqModel, &m_minFreqModel, &m_slideModel, &m_dSlideModel, &m_vibDepthModel, &m_vibSpeedModel,
+			&m_changeAmtModel, &m_changeSpeedModel, &m_sqrDutyModel, &m_sqrSweepModel, &m_repeatSpeedModel,
+			&m_phaserOffsetModel, &m_phaserSweepModel, &m_lpFilCutModel, &m_lpFilCutSweepModel, &m_lpFilResoModel,
+			&m_hpFilCutModel, &m_hpFilCutSweepModel } )
+		{
+			note->key << model->value();
+		}
+		note->key << m_waveFormModel.value();
+
+		// noise is different for every note
+		const bool deterministic = m_waveFormModel.value() != static_cast<int>( SfxrWave::Noise );
+		if( deterministic )
+		{
+			note->cached = RenderCache::get( note->key );
+		}
+		if( !note->cached )
+		{
+			note->synth = std::make_unique<SfxrSynth>( this );
+			note->recording = deterministic;
+		}
+		_n->m_pluginData = note;
 	}
-	else if( static_cast<SfxrSynth*>(_n->m_pluginData)->isPlaying() == false )
+	else if( static_cast<SfxrNote*>(_n->m_pluginData)->isPlaying() == false )
 	{
 		memset(_working_buffer + offset, 0, sizeof(sampleFrame) * frameNum);
 		_n->noteOff();
@@ -468,7 +563,7 @@ void SfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
 //	qDebug( "pFN %d", pitchedFrameNum );
 
 	auto pitchedBuffer = new sampleFrame[pitchedFrameNum];
-	static_cast<SfxrSynth*>(_n->m_pluginData)->update( pitchedBuffer, pitchedFrameNum );
+	static_cast<SfxrNote*>(_n->m_pluginData)->update( pitchedBuffer, pitchedFrameNum );
 	for( fpp_t i=0; i<frameNum; i++ )
 	{
 		for( ch_cnt_t j=0; j<DEFAULT_CHANNELS; j++ )
@@ -487,7 +582,16 @@ void SfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
 
 void SfxrInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<SfxrSynth *>( _n->m_pluginData );
+	auto note = static_cast<SfxrNote *>( _n->m_pluginData );
+
+	// a note that ended early still gets all of its sound cached
+	std::array<sampleFrame, DEFAULT_BUFFER_SIZE> rest;
+	while( note->recording )
+	{
+		note->update( rest.data(), DEFAULT_BUFFER_SIZE );
+	}
+
+	delete note;
 }
 
 
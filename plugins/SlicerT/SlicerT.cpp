@@ -30,10 +30,12 @@
 
 #include "Engine.h"
 #include "InstrumentTrack.h"
+#include "MemoryReport.h"
 #include "PathUtil.h"
 #include "SampleLoader.h"
 #include "Song.h"
 #include "embed.h"
+#include "fft_helpers.h"
 #include "lmms_constants.h"
 #include "plugin_export.h"
 
@@ -73,6 +75,16 @@ SlicerT::SlicerT(InstrumentTrack* instrumentTrack)
 	m_sliceSnap.addItem("1/16");
 	m_sliceSnap.addItem("1/32");
 	m_sliceSnap.setValue(0);
+
+	m_fftIn.resize(WindowSize, 0);
+	m_fftOut = static_cast<fftwf_complex*>(fftwf_malloc((WindowSize / 2 + 1) * sizeof(fftwf_complex)));
+	m_fftPlan = realToComplexPlan(WindowSize, m_fftIn.data(), m_fftOut);
+}
+
+SlicerT::~SlicerT()
+{
+	cancelAnalysis();
+	fftwf_free(m_fftOut);
 }
 
 void SlicerT::playNote(NotePlayHandle* handle, sampleFrame* workingBuffer)
@@ -156,63 +168,91 @@ void SlicerT::deleteNotePluginData(NotePlayHandle* handle)
 	delete static_cast<PlaybackState*>(handle->m_pluginData);
 }
 
-// uses the spectral flux to determine the change in magnitude
-// resources:
-// http://www.iro.umontreal.ca/~pift6080/H09/documents/papers/bello_onset_tutorial.pdf
 void SlicerT::findSlices()
 {
 	if (m_originalSample.sampleSize() <= 1) { return; }
-	m_slicePoints = {};
 
-	const int windowSize = 512;
-	const float minBeatLength = 0.05f; // in seconds, ~ 1/4 length at 220 bpm
+	const auto buffer = m_originalSample.buffer();
+	if (m_analysis.buffer == buffer)
+	{
+		sliceAnalysis(m_analysis);
+		return;
+	}
 
-	int sampleRate = m_originalSample.sampleRate();
-	int minDist = sampleRate * minBeatLength;
+	// finishAnalysis() slices the sample once it's analysed
+	cancelAnalysis();
+	m_cancelAnalysis = false;
+	m_analysisThread = std::thread([this, buffer] {
+		auto analysis = Analysis{buffer, {}, {}};
+		if (!analyze(analysis)) { return; }
+
+		const auto lock = std::lock_guard{m_pendingAnalysisMutex};
+		m_pendingAnalysis = std::move(analysis);
+		QMetaObject::invokeMethod(this, "finishAnalysis", Qt::QueuedConnection);
+	});
+}
+
+void SlicerT::finishAnalysis()
+{
+	{
+		const auto lock = std::lock_guard{m_pendingAnalysisMutex};
+		m_analysis = std::move(m_pendingAnalysis);
+		m_pendingAnalysis = Analysis{};
+	}
+	if (m_analysis.buffer == m_originalSample.buffer()) { sliceAnalysis(m_analysis); }
+}
+
+void SlicerT::cancelAnalysis()
+{
+	m_cancelAnalysis = true;
+	if (m_analysisThread.joinable()) { m_analysisThread.join(); }
+}
+
+// uses the spectral flux to determine the change in magnitude
+// resources:
+// http://www.iro.umontreal.ca/~pift6080/H09/documents/papers/bello_onset_tutorial.pdf
+auto SlicerT::analyze(Analysis& analysis) -> bool
+{
+	const auto& buffer = *analysis.buffer;
+	const auto size = static_cast<int>(buffer.size());
 
 	float maxMag = -1;
-	std::vector<float> singleChannel(m_originalSample.sampleSize(), 0);
-	for (int i = 0; i < m_originalSample.sampleSize(); i++)
+	std::vector<float> singleChannel(size, 0);
+	for (int i = 0; i < size; i++)
 	{
-		singleChannel[i] = (m_originalSample.data()[i][0] + m_originalSample.data()[i][1]) / 2;
+		singleChannel[i] = (buffer.data()[i][0] + buffer.data()[i][1]) / 2;
 		maxMag = std::max(maxMag, singleChannel[i]);
 	}
 
 	// normalize and find 0 crossings
-	std::vector<int> zeroCrossings;
 	float lastValue = 1;
-	for (int i = 0; i < singleChannel.size(); i++)
+	for (int i = 0; i < size; i++)
 	{
-		singleChannel[i] /= maxMag;
+		if (maxMag > 0) { singleChannel[i] /= maxMag; }
 		if (sign(lastValue) != sign(singleChannel[i]))
 		{
-			zeroCrossings.push_back(i);
+			analysis.zeroCrossings.push_back(i);
 			lastValue = singleChannel[i];
 		}
 	}
 
-	std::vector<float> prevMags(windowSize / 2, 0);
-	std::vector<float> fftIn(windowSize, 0);
-	std::array<fftwf_complex, windowSize> fftOut;
-
-	fftwf_plan fftPlan = fftwf_plan_dft_r2c_1d(windowSize, fftIn.data(), fftOut.data(), FFTW_MEASURE);
-
-	int lastPoint = -minDist - 1; // to always store 0 first
+	std::vector<float> prevMags(WindowSize / 2, 0);
 	float spectralFlux = 0;
-	float prevFlux = 1E-10; // small value, no divison by zero
 	float real, imag, magnitude, diff;
 
-	for (int i = 0; i < singleChannel.size() - windowSize; i += windowSize)
+	for (int i = 0; i + WindowSize < size; i += WindowSize)
 	{
+		if (m_cancelAnalysis) { return false; }
+
 		// fft
-		std::copy_n(singleChannel.data() + i, windowSize, fftIn.data());
-		fftwf_execute(fftPlan);
+		std::copy_n(singleChannel.data() + i, WindowSize, m_fftIn.data());
+		fftwf_execute_dft_r2c(m_fftPlan, m_fftIn.data(), m_fftOut);
 
 		// calculate spectral flux in regard to last window
-		for (int j = 0; j < windowSize / 2; j++) // only use niquistic frequencies
+		for (int j = 0; j < WindowSize / 2; j++) // only use niquistic frequencies
 		{
-			real = fftOut[j][0];
-			imag = fftOut[j][1];
+			real = m_fftOut[j][0];
+			imag = m_fftOut[j][1];
 			magnitude = std::sqrt(real * real + imag * imag);
 
 			// using L2-norm (euclidean distance)
@@ -222,6 +262,28 @@ void SlicerT::findSlices()
 			prevMags[j] = magnitude;
 		}
 
+		analysis.spectralFlux.push_back(spectralFlux);
+		spectralFlux = 1E-10; // again for no divison by zero
+	}
+	return true;
+}
+
+void SlicerT::sliceAnalysis(const Analysis& analysis)
+{
+	m_slicePoints = {};
+
+	const float minBeatLength = 0.05f; // in seconds, ~ 1/4 length at 220 bpm
+
+	int sampleRate = m_originalSample.sampleRate();
+	int minDist = sampleRate * minBeatLength;
+
+	int lastPoint = -minDist - 1; // to always store 0 first
+	float prevFlux = 1E-10; // small value, no divison by zero
+
+	for (std::size_t window = 0; window < analysis.spectralFlux.size(); window++)
+	{
+		const int i = window * WindowSize;
+		const float spectralFlux = analysis.spectralFlux[window];
 		if (spectralFlux / prevFlux > 1.0f + m_noteThreshold.value() && i - lastPoint > minDist)
 		{
 			m_slicePoints.push_back(i);
@@ -230,15 +292,17 @@ void SlicerT::findSlices()
 		}
 
 		prevFlux = spectralFlux;
-		spectralFlux = 1E-10; // again for no divison by zero
 	}
 
 	m_slicePoints.push_back(m_originalSample.sampleSize());
 
+	const auto& zeroCrossings = analysis.zeroCrossings;
 	for (float& sliceValue : m_slicePoints)
 	{
-		int closestZeroCrossing = *std::lower_bound(zeroCrossings.begin(), zeroCrossings.end(), sliceValue);
-		if (std::abs(sliceValue - closestZeroCrossing) < windowSize) { sliceValue = closestZeroCrossing; }
+		const auto closest = std::lower_bound(zeroCrossings.begin(), zeroCrossings.end(), sliceValue);
+		if (closest == zeroCrossings.end()) { continue; }
+		int closestZeroCrossing = *closest;
+		if (std::abs(sliceValue - closestZeroCrossing) < WindowSize) { sliceValue = closestZeroCrossing; }
 	}
 
 	float beatsPerMin = m_originalBPM.value() / 60.0f;
@@ -294,6 +358,7 @@ void SlicerT::findBPM()
 std::vector<Note> SlicerT::getMidi()
 {
 	std::vector<Note> outputNotes;
+	if (m_slicePoints.size() < 2) { return outputNotes; } // not sliced yet
 
 	float speedRatio = static_cast<float>(m_originalBPM.value()) / Engine::getSong()->getTempo();
 	float outFrames = m_originalSample.sampleSize() * speedRatio;
@@ -399,6 +464,11 @@ QString SlicerT::nodeName() const
 	return slicert_plugin_descriptor.name;
 }
 
+void SlicerT::reportMemoryUsage(MemoryReport& report) const
+{
+	report.addSample(m_originalSample, tr("Sample"));
+}
+
 gui::PluginView* SlicerT::instantiateView(QWidget* parent)
 {
 	return new gui::SlicerTView(this, parent);
@@ -26,8 +26,13 @@
 #define LMMS_SLICERT_H
 
 #include <algorithm>
+#include <atomic>
 #include <fftw3.h>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "AutomatableModel.h"
 #include "Instrument.h"
@@ -74,6 +79,7 @@ signals:
 
 public:
 	SlicerT(InstrumentTrack* instrumentTrack);
+	~SlicerT() override;
 
 	void playNote(NotePlayHandle* handle, sampleFrame* workingBuffer) override;
 	void deleteNotePluginData(NotePlayHandle* handle) override;
@@ -85,11 +91,29 @@ public:
 	void findBPM();
 
 	QString nodeName() const override;
+	void reportMemoryUsage(MemoryReport& report) const override;
 	gui::PluginView* instantiateView(QWidget* parent) override;
 
 	std::vector<Note> getMidi();
 
+private slots:
+	void finishAnalysis();
+
 private:
+	//! The spectral flux of each window of a sample, and where it crosses zero
+	struct Analysis
+	{
+		std::shared_ptr<const SampleBuffer> buffer;
+		std::vector<float> spectralFlux;
+		std::vector<int> zeroCrossings;
+	};
+
+	//! Finds the slices from the analysis of the sample they're for
+	void sliceAnalysis(const Analysis& analysis);
+	//! Runs on m_analysisThread, returns false if cancelled
+	auto analyze(Analysis& analysis) -> bool;
+	void cancelAnalysis();
+
 	FloatModel m_noteThreshold;
 	FloatModel m_fadeOutFrames;
 	IntModel m_originalBPM;
@@ -100,6 +124,20 @@ private:
 
 	std::vector<float> m_slicePoints;
 
+	// the analysis is done once per sample off the GUI thread, and the
+	// slices are found from it again whenever they're reset
+	Analysis m_analysis;
+	Analysis m_pendingAnalysis;
+	std::mutex m_pendingAnalysisMutex;
+	std::thread m_analysisThread;
+	std::atomic<bool> m_cancelAnalysis = false;
+
+	// planned once, only ever executed by m_analysisThread
+	static constexpr int WindowSize = 512;
+	std::vector<float> m_fftIn;
+	fftwf_complex* m_fftOut;
+	fftwf_plan m_fftPlan;
+
 	InstrumentTrack* m_parentTrack;
 
 	friend class gui::SlicerTView;
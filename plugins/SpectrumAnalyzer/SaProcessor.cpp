@@ -36,6 +36,8 @@
 #endif
 #include <QMutexLocker>
 
+#include "AudioEngine.h"
+#include "Engine.h"
 #include "fft_helpers.h"
 #include "lmms_constants.h"
 #include "LocklessRingBuffer.h"
@@ -69,8 +71,8 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 	m_filteredBufferR.resize(m_fftBlockSize, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = realToComplexPlan(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = realToComplexPlan(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR);
 
 	m_absSpectrumL.resize(binCount(), 0);
 	m_absSpectrumR.resize(binCount(), 0);
@@ -85,8 +87,6 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 
 SaProcessor::~SaProcessor()
 {
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -177,14 +177,14 @@ void SaProcessor::analyze(LocklessRingBuffer<sampleFrame> &ring_buffer)
 
 				// Run FFT on left channel, convert the result to absolute magnitude
 				// spectrum and normalize it.
-				fftwf_execute(m_fftPlanL);
+				fftwf_execute_dft_r2c(m_fftPlanL, m_filteredBufferL.data(), m_spectrumL);
 				absspec(m_spectrumL, m_absSpectrumL.data(), binCount());
 				normalize(m_absSpectrumL, m_normSpectrumL, m_inBlockSize);
 
 				// repeat analysis for right channel if stereo processing is enabled
 				if (stereo)
 				{
-					fftwf_execute(m_fftPlanR);
+					fftwf_execute_dft_r2c(m_fftPlanR, m_filteredBufferR.data(), m_spectrumR);
 					absspec(m_spectrumR, m_absSpectrumR.data(), binCount());
 					normalize(m_absSpectrumR, m_normSpectrumR, m_inBlockSize);
 				}
@@ -201,11 +201,11 @@ void SaProcessor::analyze(LocklessRingBuffer<sampleFrame> &ring_buffer)
 
 				if (m_waterfallActive && m_waterfallNotEmpty)
 				{
-					// move waterfall history one line down and clear the top line
-					auto pixel = (QRgb*)m_history_work.data();
-					std::copy(pixel,
-							  pixel + waterfallWidth() * m_waterfallHeight - waterfallWidth(),
-							  pixel + waterfallWidth());
+					// The history is circular: instead of moving all of it one line
+					// down, the line above the current top is overwritten and
+					// becomes the new top.
+					m_historyWorkTop = m_historyWorkTop == 0 ? m_waterfallHeight - 1 : m_historyWorkTop - 1;
+					auto pixel = (QRgb*)m_history_work.data() + waterfallWidth() * m_historyWorkTop;
 					memset(pixel, 0, waterfallWidth() * sizeof (QRgb));
 
 					// add newest result on top
@@ -279,15 +279,16 @@ void SaProcessor::analyze(LocklessRingBuffer<sampleFrame> &ring_buffer)
 
 					// Copy work buffer to result buffer. Done only if requested, so
 					// that time isn't wasted on updating faster than display FPS.
-					// (The copy is about as expensive as the movement.)
 					if (m_flipRequest)
 					{
 						m_history = m_history_work;
+						m_historyTop = m_historyWorkTop;
 						m_flipRequest = false;
 					}
 				}
 				// clean up before checking for more data from input buffer
-				const unsigned int overlaps = m_controls->m_windowOverlapModel.value();
+				const unsigned int overlaps = Engine::audioEngine()->qualityGovernor().analyserOverlaps(
+					m_controls->m_windowOverlapModel.value());
 				if (overlaps == 1)	// Discard buffer, each sample used only once
 				{
 					m_framesFilledUp = 0;
@@ -397,9 +398,7 @@ void SaProcessor::reallocateBuffers()
 	QMutexLocker reloc_lock(&m_reallocationAccess);
 	QMutexLocker data_lock(&m_dataAccess);
 
-	// destroy old FFT plan and free the result buffer
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
+	// free the result buffer, the plans are shared
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -412,8 +411,8 @@ void SaProcessor::reallocateBuffers()
 	m_filteredBufferR.resize(new_fft_size, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = realToComplexPlan(new_fft_size, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = realToComplexPlan(new_fft_size, m_filteredBufferR.data(), m_spectrumR);
 
 	if (m_fftPlanL == nullptr || m_fftPlanR == nullptr)
 	{
@@ -475,6 +474,8 @@ void SaProcessor::clear()
 	std::fill(m_normSpectrumR.begin(), m_normSpectrumR.end(), 0);
 	std::fill(m_history_work.begin(), m_history_work.end(), 0);
 	std::fill(m_history.begin(), m_history.end(), 0);
+	m_historyWorkTop = 0;
+	m_historyTop = 0;
 }
 
 // Clear only history work buffer. Used to flush old data when waterfall
@@ -61,6 +61,7 @@ public:
 	void setSpectrumActive(bool active);
 	void setWaterfallActive(bool active);
 	void flipRequest() {m_flipRequest = true;}	// request refresh of history buffer
+	bool flipPending() const {return m_flipRequest;}	// refresh requested, but not done yet
 
 	// configuration is taken from models in SaControls; some changes require
 	// an exlicit update request (reallocation and window rebuild)
@@ -72,6 +73,7 @@ public:
 	const float *getSpectrumL() const {return m_normSpectrumL.data();}
 	const float *getSpectrumR() const {return m_normSpectrumR.data();}
 	const uchar *getHistory() const {return m_history.data();}
+	unsigned int historyTop() const {return m_historyTop;}	// line of the history holding the newest result
 
 	// information about results and unit conversion helpers
 	unsigned int inBlockSize() const {return m_inBlockSize;}
@@ -141,9 +143,12 @@ private:
 	std::vector<float> m_normSpectrumR;     //!< frequency domain samples (normalized) (right)
 
 	// spectrum history for waterfall: new normSpectrum lines are added on top
+	// of a circular buffer, the line at the top index is the newest one
 	std::vector<uchar> m_history_work;		//!< local history buffer for render
 	std::vector<uchar> m_history;			//!< public buffer for reading
-	bool m_flipRequest;						//!< update public buffer only when requested
+	unsigned int m_historyWorkTop = 0;		//!< top line of the local history buffer
+	std::atomic<unsigned int> m_historyTop{0};	//!< top line of the public buffer
+	std::atomic<bool> m_flipRequest{false};	//!< update public buffer only when requested
 	std::atomic<unsigned int> m_waterfallHeight;	//!< number of stored lines in history buffer
 											// Note: high values may make it harder to see transients.
 	const unsigned int m_waterfallMaxWidth = 3840;
@@ -143,23 +143,35 @@ void SaWaterfallView::paintEvent(QPaintEvent *event)
 	if (m_processor->waterfallNotEmpty())
 	{
 		QMutexLocker lock(&m_processor->m_reallocationAccess);
+		const int lines = m_processor->waterfallHeight();
+		const int top = m_processor->historyTop();
 		QImage temp = QImage(m_processor->getHistory(),			// raw pixel data to display
 							 m_processor->waterfallWidth(),		// width = number of frequency bins
-							 m_processor->waterfallHeight(),	// height = number of history lines
+							 lines,								// height = number of history lines
 							 QImage::Format_RGB32);
 		lock.unlock();
-		temp.setDevicePixelRatio(devicePixelRatio());			// display at native resolution
-		painter.drawImage(m_displayLeft, m_displayTop,
-						  temp.scaled(m_displayWidth * devicePixelRatio(),
-									  m_displayHeight * devicePixelRatio(),
-									  Qt::IgnoreAspectRatio,
-									  Qt::SmoothTransformation));
-		m_processor->flipRequest();
+
+		// The history is circular, with the newest line at the top index:
+		// draw the lines from there to the end first and the older ones
+		// wrapped around to the start below them. Scaling while drawing
+		// saves making a scaled copy of the whole image every frame.
+		painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+		const float pixelsPerLine = (float)m_displayHeight / lines;
+		const float split = m_displayTop + (lines - top) * pixelsPerLine;
+		painter.drawImage(QRectF(m_displayLeft, m_displayTop, m_displayWidth, split - m_displayTop),
+						  temp, QRectF(0, top, temp.width(), lines - top));
+		if (top > 0)
+		{
+			painter.drawImage(QRectF(m_displayLeft, split, m_displayWidth, m_displayBottom - split),
+							  temp, QRectF(0, 0, temp.width(), top));
+		}
 	}
 	else
 	{
 		painter.fillRect(m_displayLeft, m_displayTop, m_displayWidth, m_displayHeight, QColor(0,0,0));
 	}
+	// ask for the next lines, whether or not there were any so far
+	m_processor->flipRequest();
 
 	// draw cursor (if it is within bounds)
 	drawCursor(painter);
@@ -244,10 +256,14 @@ std::vector<std::pair<float, std::string>> SaWaterfallView::makeTimeTics()
 
 // Periodically trigger repaint and check if the widget is visible.
 // If it is not, stop drawing and inform the processor.
+// Nothing changes until the processor had new lines to show since the last
+// repaint, so it is skipped until then (e.g. while paused or silent).
 void SaWaterfallView::periodicUpdate()
 {
 	m_processor->setWaterfallActive(isVisible());
-	if (isVisible()) {update();}
+	if (!isVisible()) {return;}
+	const bool ticsChanged = secondsPerLine() != m_oldSecondsPerLine || m_processor->waterfallHeight() != m_oldHeight;
+	if (ticsChanged || !m_processor->flipPending()) {update();}
 }
 
 
@@ -331,12 +347,14 @@ void SaWaterfallView::mouseMoveEvent(QMouseEvent *event)
 {
 	m_cursor = QPointF(	event->localPos().x() - (event->windowPos().x() - (long)event->windowPos().x()),
 						event->localPos().y() - (event->windowPos().y() - (long)event->windowPos().y()));
+	update();
 }
 
 void SaWaterfallView::mousePressEvent(QMouseEvent *event)
 {
 	m_cursor = QPointF(	event->localPos().x() - (event->windowPos().x() - (long)event->windowPos().x()),
 						event->localPos().y() - (event->windowPos().y() - (long)event->windowPos().y()));
+	update();
 }
 
 
@@ -85,57 +85,64 @@ StereoEnhancerEffect::~StereoEnhancerEffect()
 bool StereoEnhancerEffect::processAudioBuffer( sampleFrame * _buf,
 							const fpp_t _frames )
 {
+	return processFramesOf<StereoEnhancerEffect>( _buf, _frames );
+}
 
-	// This appears to be used for determining whether or not to continue processing
-	// audio with this effect
-	double out_sum = 0.0;
 
-	float width;
-	int frameIndex = 0;
 
 
+bool StereoEnhancerEffect::startFrames( const fpp_t )
+{
 	if( !isEnabled() || !isRunning() )
 	{
 		return( false );
 	}
 
-	const float d = dryLevel();
-	const float w = wetLevel();
+	m_dry = dryLevel();
+	m_wet = wetLevel();
+	return( true );
+}
 
-	for( fpp_t f = 0; f < _frames; ++f )
-	{
 
-		// copy samples into the delay buffer
-		m_delayBuffer[m_currFrame][0] = _buf[f][0];
-		m_delayBuffer[m_currFrame][1] = _buf[f][1];
 
-		// Get the width knob value from the Stereo Enhancer effect
-		width = m_seFX.wideCoeff();
 
-		// Calculate the correct sample frame for processing
-		frameIndex = m_currFrame - width;
+void StereoEnhancerEffect::processFrame( sampleFrame & _frame, const fpp_t )
+{
+	// copy samples into the delay buffer
+	m_delayBuffer[m_currFrame][0] = _frame[0];
+	m_delayBuffer[m_currFrame][1] = _frame[1];
 
-		if( frameIndex < 0 )
-		{
-			// e.g. difference = -10, frameIndex = DBS - 10
-			frameIndex += DEFAULT_BUFFER_SIZE;
-		}
+	// Get the width knob value from the Stereo Enhancer effect
+	const float width = m_seFX.wideCoeff();
 
-		//sample_t s[2] = { _buf[f][0], _buf[f][1] };	//Vanilla
-		auto s = std::array{_buf[f][0], m_delayBuffer[frameIndex][1]};	//Chocolate
+	// Calculate the correct sample frame for processing
+	int frameIndex = m_currFrame - width;
 
-		m_seFX.nextSample( s[0], s[1] );
+	if( frameIndex < 0 )
+	{
+		// e.g. difference = -10, frameIndex = DBS - 10
+		frameIndex += DEFAULT_BUFFER_SIZE;
+	}
 
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
+	//sample_t s[2] = { _frame[0], _frame[1] };	//Vanilla
+	auto s = std::array{_frame[0], m_delayBuffer[frameIndex][1]};	//Chocolate
 
-		// Update currFrame
-		m_currFrame += 1;
-		m_currFrame %= DEFAULT_BUFFER_SIZE;
-	}
+	m_seFX.nextSample( s[0], s[1] );
 
-	checkGate( out_sum / _frames );
+	_frame[0] = m_dry * _frame[0] + m_wet * s[0];
+	_frame[1] = m_dry * _frame[1] + m_wet * s[1];
+
+	// Update currFrame
+	m_currFrame += 1;
+	m_currFrame %= DEFAULT_BUFFER_SIZE;
+}
+
+
+
+
+bool StereoEnhancerEffect::finishFrames( double _outSum, const fpp_t _frames )
+{
+	checkGate( _outSum / _frames );
 	if( !isRunning() )
 	{
 		clearMyBuffer();
@@ -34,7 +34,7 @@ namespace lmms
 {
 
 
-class StereoEnhancerEffect : public Effect
+class StereoEnhancerEffect final : public Effect
 {
 public:
 	StereoEnhancerEffect( Model * parent,
@@ -43,6 +43,11 @@ public:
 	bool processAudioBuffer( sampleFrame * _buf,
 		                                          const fpp_t _frames ) override;
 
+	bool processesFrames() const override { return true; }
+	bool startFrames( const fpp_t _frames ) override;
+	void processFrame( sampleFrame & _frame, const fpp_t _f ) override;
+	bool finishFrames( double _outSum, const fpp_t _frames ) override;
+
 	EffectControls * controls() override
 	{
 		return( &m_bbControls );
@@ -59,6 +64,10 @@ private:
 	
 	StereoEnhancerControls m_bbControls;
 
+	// what processFrame() needs, fetched by startFrames()
+	float m_dry = 0.0f;
+	float m_wet = 0.0f;
+
 	friend class StereoEnhancerControls;
 } ;
 
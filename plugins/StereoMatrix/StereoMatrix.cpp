@@ -67,7 +67,14 @@ StereoMatrixEffect::StereoMatrixEffect(
 bool StereoMatrixEffect::processAudioBuffer( sampleFrame * _buf,
 							const fpp_t _frames )
 {
-	
+	return processFramesOf<StereoMatrixEffect>( _buf, _frames );
+}
+
+
+
+
+bool StereoMatrixEffect::startFrames( const fpp_t )
+{
 	// This appears to be used for determining whether or not to continue processing
 	// audio with this effect	
 	if( !isEnabled() || !isRunning() )
@@ -75,33 +82,29 @@ bool StereoMatrixEffect::processAudioBuffer( sampleFrame * _buf,
 		return( false );
 	}
 
-	double out_sum = 0.0;
+	m_dry = dryLevel();
+	m_wet = wetLevel();
+	return( true );
+}
 
-	for( fpp_t f = 0; f < _frames; ++f )
-	{	
-		const float d = dryLevel();
-		const float w = wetLevel();
-		
-		sample_t l = _buf[f][0];
-		sample_t r = _buf[f][1];
 
-		// Init with dry-mix
-		_buf[f][0] = l * d;
-		_buf[f][1] = r * d;
 
-		// Add it wet
-		_buf[f][0] += ( m_smControls.m_llModel.value( f ) * l  +
-					m_smControls.m_rlModel.value( f ) * r ) * w;
 
-		_buf[f][1] += ( m_smControls.m_lrModel.value( f ) * l  +
-					m_smControls.m_rrModel.value( f ) * r ) * w;
-		out_sum += _buf[f][0]*_buf[f][0] + _buf[f][1]*_buf[f][1];
+void StereoMatrixEffect::processFrame( sampleFrame & _frame, const fpp_t _f )
+{
+	sample_t l = _frame[0];
+	sample_t r = _frame[1];
 
-	}
+	// Init with dry-mix
+	_frame[0] = l * m_dry;
+	_frame[1] = r * m_dry;
 
-	checkGate( out_sum / _frames );
+	// Add it wet
+	_frame[0] += ( m_smControls.m_llModel.value( _f ) * l  +
+				m_smControls.m_rlModel.value( _f ) * r ) * m_wet;
 
-	return( isRunning() );
+	_frame[1] += ( m_smControls.m_lrModel.value( _f ) * l  +
+				m_smControls.m_rrModel.value( _f ) * r ) * m_wet;
 }
 
 
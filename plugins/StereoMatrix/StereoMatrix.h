@@ -33,7 +33,7 @@ namespace lmms
 {
 
 
-class StereoMatrixEffect : public Effect
+class StereoMatrixEffect final : public Effect
 {
 public:
 	StereoMatrixEffect( Model * parent, 
@@ -42,15 +42,28 @@ public:
 	bool processAudioBuffer( sampleFrame * _buf,
 		                                          const fpp_t _frames ) override;
 
+	bool processesFrames() const override { return true; }
+	bool startFrames( const fpp_t _frames ) override;
+	void processFrame( sampleFrame & _frame, const fpp_t _f ) override;
+
 	EffectControls* controls() override
 	{
 		return( &m_smControls );
 	}
 
+	f_cnt_t tailLength() const override
+	{
+		return 0;
+	}
+
 
 private:
 	StereoMatrixControls m_smControls;
 
+	// what processFrame() needs, fetched by startFrames()
+	float m_dry = 0.0f;
+	float m_wet = 0.0f;
+
 	friend class StereoMatrixControls;
 } ;
 
@@ -29,6 +29,7 @@
 #include <QDir>
 #include <QDomElement>
 #include <QMessageBox>
+#include <QMutex>
 
 #include <stk/BandedWG.h>
 #include <stk/ModalBar.h>
@@ -68,6 +69,20 @@ Plugin::Descriptor PLUGIN_EXPORT malletsstk_plugin_descriptor =
 }
 
 
+namespace
+{
+
+// STK is not thread-safe
+QMutex s_stkMutex;
+
+//! How many synths are kept for each model at most
+constexpr std::uint32_t MaxVoices = 64;
+//! How many are built ahead for the selected preset
+constexpr int ReservedVoices = 8;
+
+} // namespace
+
+
 MalletsInstrument::MalletsInstrument( InstrumentTrack * _instrument_track ):
 	Instrument( _instrument_track, &malletsstk_plugin_descriptor ),
 	m_hardnessModel(64.0f, 0.0f, 128.0f, 0.1f, this, tr( "Hardness" )),
@@ -91,7 +106,10 @@ MalletsInstrument::MalletsInstrument( InstrumentTrack * _instrument_track ):
 	m_versionModel( MALLETS_PRESET_VERSION, 0, MALLETS_PRESET_VERSION, this, "" ),
 	m_isOldVersionModel( false, this, "" ),
 	m_filesMissing( !QDir( ConfigManager::inst()->stkDir() ).exists() ||
-		!QFileInfo( ConfigManager::inst()->stkDir() + "/sinewave.raw" ).exists() )
+		!QFileInfo( ConfigManager::inst()->stkDir() + "/sinewave.raw" ).exists() ),
+	m_voices{ { VoicePool<MalletsSynth>( MaxVoices ),
+		VoicePool<MalletsSynth>( MaxVoices ),
+		VoicePool<MalletsSynth>( MaxVoices ) } }
 {
 	// ModalBar
 	m_presetsModel.addItem( tr( "Marimba" ) );
@@ -126,6 +144,15 @@ MalletsInstrument::MalletsInstrument( InstrumentTrack * _instrument_track ):
 	m_scalers.append( 16.0 );
 	m_presetsModel.addItem( tr( "Tibetan bowl" ) );
 	m_scalers.append( 7.0 );
+
+	connect( &m_presetsModel, SIGNAL( dataChanged() ),
+			this, SLOT( reserveVoices() ) );
+	// the synths built for the old rate are deleted when they're acquired
+	connect( Engine::audioEngine(), &AudioEngine::sampleRateChanged, this, [this] {
+		for( auto& voices : m_voices ) { voices.clear(); }
+		reserveVoices();
+	} );
+	reserveVoices();
 }
 
 
@@ -329,12 +356,24 @@ void MalletsInstrument::playNote( NotePlayHandle * _n,
 			speed = std::clamp(speed, 0.0f, 128.0f);
 		}
 
-		// critical section as STK is not thread-safe
-		static QMutex m;
-		m.lock();
+		const auto model = MalletsInstrument::model( p );
+		const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+		auto ps = m_voices[static_cast<int>( model )].acquire();
+
+		s_stkMutex.lock();
+		if( ps != nullptr && ps->sampleRate() != sampleRate )
+		{
+			delete ps;
+			ps = nullptr;
+		}
+		if( ps == nullptr )
+		{
+			ps = new MalletsSynth( model, sampleRate );
+		}
+
 		if( p < 9 )
 		{
-			_n->m_pluginData = new MalletsSynth( freq,
+			ps->startModalBar( freq,
 						vel,
 						m_stickModel.value(),
 						hardness,
@@ -342,25 +381,22 @@ void MalletsInstrument::playNote( NotePlayHandle * _n,
 						m_vibratoGainModel.value(),
 						m_vibratoFreqModel.value(),
 						p,
-						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
 		else if( p == 9 )
 		{
-			_n->m_pluginData = new MalletsSynth( freq,
+			ps->startTubeBell( freq,
 						vel,
-						p,
 						m_lfoDepthModel.value(),
 						modulator,
 						crossfade,
 						m_lfoSpeedModel.value(),
 						m_adsrModel.value(),
-						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
 		else
 		{
-			_n->m_pluginData = new MalletsSynth( freq,
+			ps->startBandedWG( freq,
 						vel,
 						pressure,
 						m_motionModel.value(),
@@ -368,11 +404,11 @@ void MalletsInstrument::playNote( NotePlayHandle * _n,
 						p - 10,
 						m_strikeModel.value() * 128.0,
 						speed,
-						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						(uint8_t) m_spreadModel.value() );
 		}
-		m.unlock();
-		static_cast<MalletsSynth *>(_n->m_pluginData)->setPresetIndex(p);
+		s_stkMutex.unlock();
+		ps->setPresetIndex(p);
+		_n->m_pluginData = ps;
 	}
 
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
@@ -414,7 +450,41 @@ void MalletsInstrument::playNote( NotePlayHandle * _n,
 
 void MalletsInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<MalletsSynth *>( _n->m_pluginData );
+	auto ps = static_cast<MalletsSynth *>( _n->m_pluginData );
+	if( ps != nullptr )
+	{
+		// keep it for one of the next notes, building an STK instrument
+		// loads its rawwaves from disk
+		m_voices[static_cast<int>( ps->model() )].release( ps );
+	}
+}
+
+
+
+
+MalletsSynth::Model MalletsInstrument::model( int _preset )
+{
+	return _preset < 9 ? MalletsSynth::Model::ModalBar
+		: _preset == 9 ? MalletsSynth::Model::TubeBell
+		: MalletsSynth::Model::BandedWG;
+}
+
+
+
+
+void MalletsInstrument::reserveVoices()
+{
+	if( m_filesMissing )
+	{
+		return;
+	}
+
+	const auto model = MalletsInstrument::model( m_presetsModel.value() );
+	const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+	QMutexLocker lock( &s_stkMutex );
+	m_voices[static_cast<int>( model )].reserve( ReservedVoices, [model, sampleRate] {
+		return new MalletsSynth( model, sampleRate );
+	} );
 }
 
 
@@ -653,18 +723,11 @@ void MalletsInstrumentView::changePreset()
 } // namespace gui
 
 
-// ModalBar
-MalletsSynth::MalletsSynth( const StkFloat _pitch,
-				const StkFloat _velocity,
-				const StkFloat _control1,
-				const StkFloat _control2,
-				const StkFloat _control4,
-				const StkFloat _control8,
-				const StkFloat _control11,
-				const int _control16,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+MalletsSynth::MalletsSynth( const Model _model, const sample_rate_t _sample_rate ) :
+	m_model( _model ),
+	m_sampleRate( _sample_rate ),
+	m_presetIndex(0),
+	m_voice( nullptr )
 {
 	try
 	{
@@ -675,8 +738,43 @@ MalletsSynth::MalletsSynth( const StkFloat _pitch,
 		Stk::showWarnings( false );
 #endif
 
-		m_voice = new ModalBar();
-	
+		switch( _model )
+		{
+			case Model::ModalBar: m_voice = new ModalBar(); break;
+			case Model::TubeBell: m_voice = new TubeBell(); break;
+			case Model::BandedWG: m_voice = new BandedWG(); break;
+		}
+	}
+	catch( ... )
+	{
+		m_voice = nullptr;
+	}
+
+	m_delay = new StkFloat[256];
+	resetDelay( 0 );
+}
+
+
+
+
+void MalletsSynth::startModalBar( const StkFloat _pitch,
+				const StkFloat _velocity,
+				const StkFloat _control1,
+				const StkFloat _control2,
+				const StkFloat _control4,
+				const StkFloat _control8,
+				const StkFloat _control11,
+				const int _control16,
+				const uint8_t _delay )
+{
+	resetDelay( _delay );
+	if( m_voice == nullptr )
+	{
+		return;
+	}
+
+	try
+	{
 		m_voice->controlChange( 16, _control16 );
 		m_voice->controlChange( 1, _control1 );
 		m_voice->controlChange( 2, _control2 );
@@ -684,77 +782,55 @@ MalletsSynth::MalletsSynth( const StkFloat _pitch,
 		m_voice->controlChange( 8, _control8 );
 		m_voice->controlChange( 11, _control11 );
 		m_voice->controlChange( 128, 128.0f );
-		
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
 	catch( ... )
 	{
+		delete m_voice;
 		m_voice = nullptr;
 	}
-	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
 }
 
 
 
 
-// TubeBell
-MalletsSynth::MalletsSynth( const StkFloat _pitch,
+void MalletsSynth::startTubeBell( const StkFloat _pitch,
 				const StkFloat _velocity,
-				const int _preset,
 				const StkFloat _control1,
 				const StkFloat _control2,
 				const StkFloat _control4,
 				const StkFloat _control11,
 				const StkFloat _control128,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+				const uint8_t _delay )
 {
-	try
+	resetDelay( _delay );
+	if( m_voice == nullptr )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLocal8Bit().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
+		return;
+	}
 
-		m_voice = new TubeBell();
-	
+	try
+	{
 		m_voice->controlChange( 1, _control1 );
 		m_voice->controlChange( 2, _control2 );
 		m_voice->controlChange( 4, _control4 );
 		m_voice->controlChange( 11, _control11 );
 		m_voice->controlChange( 128, _control128 );
-	
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
 	catch( ... )
 	{
+		delete m_voice;
 		m_voice = nullptr;
 	}
-	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
 }
 
 
 
 
-// BandedWG
-MalletsSynth::MalletsSynth( const StkFloat _pitch,
+void MalletsSynth::startBandedWG( const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control2,
 				const StkFloat _control4,
@@ -762,21 +838,16 @@ MalletsSynth::MalletsSynth( const StkFloat _pitch,
 				const int _control16,
 				const StkFloat _control64,
 				const StkFloat _control128,
-				const uint8_t _delay,
-				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+				const uint8_t _delay )
 {
-	try
+	resetDelay( _delay );
+	if( m_voice == nullptr )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLocal8Bit().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
+		return;
+	}
 
-		m_voice = new BandedWG();
-	
+	try
+	{
 		m_voice->controlChange( 1, 128.0 );
 		m_voice->controlChange( 2, _control2 );
 		m_voice->controlChange( 4, _control4 );
@@ -784,15 +855,21 @@ MalletsSynth::MalletsSynth( const StkFloat _pitch,
 		m_voice->controlChange( 16, _control16 );
 		m_voice->controlChange( 64, _control64 );
 		m_voice->controlChange( 128, _control128 );
-	
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
 	catch( ... )
 	{
+		delete m_voice;
 		m_voice = nullptr;
 	}
-	
-	m_delay = new StkFloat[256];
+}
+
+
+
+
+void MalletsSynth::resetDelay( const uint8_t _delay )
+{
 	m_delayRead = 0;
 	m_delayWrite = _delay;
 	for( int i = 0; i < 256; i++ )
@@ -27,6 +27,8 @@
 #ifndef _MALLET_H
 #define _MALLET_H
 
+#include <array>
+
 #include <stk/Instrmnt.h>
 
 #include "ComboBox.h"
@@ -35,6 +37,7 @@
 #include "Knob.h"
 #include "NotePlayHandle.h"
 #include "LedCheckBox.h"
+#include "VoicePool.h"
 
 // As of Stk 4.4 all classes and types have been moved to the namespace "stk".
 // However in older versions this namespace does not exist, therefore declare it
@@ -59,8 +62,28 @@ class MalletsInstrumentView;
 class MalletsSynth
 {
 public:
+	enum class Model
+	{
+		ModalBar,
+		TubeBell,
+		BandedWG
+	};
+
+	//! Loads what the STK instrument needs, which isn't thread-safe
+	MalletsSynth( const Model _model, const sample_rate_t _sample_rate );
+
+	inline ~MalletsSynth()
+	{
+		if (m_voice) {m_voice->noteOff(0.0);}
+		delete[] m_delay;
+		delete m_voice;
+	}
+
+	// The following start a new note, on a new synth or on one a note has
+	// been played on before, and aren't thread-safe either
+
 	// ModalBar
-	MalletsSynth( const StkFloat _pitch,
+	void startModalBar( const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control1,
 			const StkFloat _control2,
@@ -68,23 +91,20 @@ public:
 			const StkFloat _control8,
 			const StkFloat _control11,
 			const int _control16,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
+			const uint8_t _delay );
 
 	// TubeBell
-	MalletsSynth( const StkFloat _pitch,
+	void startTubeBell( const StkFloat _pitch,
 			const StkFloat _velocity,
-			const int _preset,
 			const StkFloat _control1,
 			const StkFloat _control2,
 			const StkFloat _control4,
 			const StkFloat _control11,
 			const StkFloat _control128,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
+			const uint8_t _delay );
 
 	// BandedWG
-	MalletsSynth( const StkFloat _pitch,
+	void startBandedWG( const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control2,
 			const StkFloat _control4,
@@ -92,14 +112,16 @@ public:
 			const int _control16,
 			const StkFloat _control64,
 			const StkFloat _control128,
-			const uint8_t _delay,
-			const sample_rate_t _sample_rate );
+			const uint8_t _delay );
 
-	inline ~MalletsSynth()
+	inline Model model() const
 	{
-		if (m_voice) {m_voice->noteOff(0.0);}
-		delete[] m_delay;
-		delete m_voice;
+		return m_model;
+	}
+
+	inline sample_rate_t sampleRate() const
+	{
+		return m_sampleRate;
 	}
 
 	inline sample_t nextSampleLeft()
@@ -170,6 +192,10 @@ public:
 
 
 protected:
+	void resetDelay( const uint8_t _delay );
+
+	const Model m_model;
+	const sample_rate_t m_sampleRate;
 	int m_presetIndex;
 	Instrmnt * m_voice;
 
@@ -188,6 +214,8 @@ public:
 	MalletsInstrument( InstrumentTrack * _instrument_track );
 	~MalletsInstrument() override = default;
 
+	static MalletsSynth::Model model( int _preset );
+
 	void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer ) override;
 	void deleteNotePluginData( NotePlayHandle * _n ) override;
@@ -231,6 +259,12 @@ private:
 
 	bool m_filesMissing;
 
+	//! The synths of the notes that ended, for each model
+	std::array<VoicePool<MalletsSynth>, 3> m_voices;
+
+private slots:
+	void reserveVoices();
+
 
 	friend class gui::MalletsInstrumentView;
 
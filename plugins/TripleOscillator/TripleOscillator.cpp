@@ -23,6 +23,8 @@
  */
 
 
+#include <algorithm>
+
 #include <QDomElement>
 #include <QFileInfo>
 
@@ -33,6 +35,7 @@
 #include "Engine.h"
 #include "InstrumentTrack.h"
 #include "Knob.h"
+#include "MemoryReport.h"
 #include "NotePlayHandle.h"
 #include "Oscillator.h"
 #include "PathUtil.h"
@@ -46,6 +49,14 @@
 namespace lmms
 {
 
+namespace
+{
+
+//! How many frames the oscillators of a gliding note render at one frequency
+constexpr fpp_t GlideFrames = 16;
+
+} // namespace
+
 
 extern "C"
 {
@@ -93,6 +104,7 @@ OscillatorObject::OscillatorObject( Model * _parent, int _idx ) :
 				Oscillator::NumModulationAlgos-1, this,
 				tr( "Modulation type %1" ).arg( _idx+1 ) ),
 	m_useWaveTableModel(true),
+	m_usePolyBlepModel(false),
 
 	m_sampleBuffer( new SampleBuffer ),
 	m_volumeLeft( 0.0f ),
@@ -101,7 +113,8 @@ OscillatorObject::OscillatorObject( Model * _parent, int _idx ) :
 	m_detuningRight( 0.0f ),
 	m_phaseOffsetLeft( 0.0f ),
 	m_phaseOffsetRight( 0.0f ),
-	m_useWaveTable( true )
+	m_useWaveTable( true ),
+	m_usePolyBlep( false )
 {
 	// Connect knobs with Oscillators' inputs
 	connect( &m_volumeModel, SIGNAL( dataChanged() ),
@@ -129,6 +142,8 @@ OscillatorObject::OscillatorObject( Model * _parent, int _idx ) :
 			this, SLOT( updatePhaseOffsetLeft() ), Qt::DirectConnection );
 	connect ( &m_useWaveTableModel, SIGNAL(dataChanged()),
 			this, SLOT( updateUseWaveTable()));
+	connect ( &m_usePolyBlepModel, SIGNAL(dataChanged()),
+			this, SLOT( updateUsePolyBlep()));
 
 	updatePhaseOffsetLeft();
 	updatePhaseOffsetRight();
@@ -141,7 +156,7 @@ void OscillatorObject::oscUserDefWaveDblClick()
 	if( af != "" )
 	{
 		m_sampleBuffer = gui::SampleLoader::createBufferFromFile(af);
-		m_userAntiAliasWaveTable = Oscillator::generateAntiAliasUserWaveTable(m_sampleBuffer.get());
+		m_userAntiAliasWaveTable = Oscillator::userWaveTable(m_sampleBuffer);
 		// TODO:
 		//m_usrWaveBtn->setToolTip(m_sampleBuffer->audioFile());
 	}
@@ -212,6 +227,11 @@ void OscillatorObject::updateUseWaveTable()
 	m_useWaveTable = m_useWaveTableModel.value();
 }
 
+void OscillatorObject::updateUsePolyBlep()
+{
+	m_usePolyBlep = m_usePolyBlepModel.value();
+}
+
 
 
 
@@ -254,6 +274,8 @@ void TripleOscillator::saveSettings( QDomDocument & _doc, QDomElement & _this )
 					"modalgo" + QString::number( i+1 ) );
 		m_osc[i]->m_useWaveTableModel.saveSettings( _doc, _this,
 					"useWaveTable" + QString::number (i+1 ) );
+		m_osc[i]->m_usePolyBlepModel.saveSettings( _doc, _this,
+					"usePolyBlep" + QString::number (i+1 ) );
 		_this.setAttribute( "userwavefile" + is,
 					m_osc[i]->m_sampleBuffer->audioFile() );
 	}
@@ -282,13 +304,15 @@ void TripleOscillator::loadSettings( const QDomElement & _this )
 					"modalgo" + QString::number( i+1 ) );
 		m_osc[i]->m_useWaveTableModel.loadSettings( _this,
 							"useWaveTable" + QString::number (i+1 ) );
+		m_osc[i]->m_usePolyBlepModel.loadSettings( _this,
+							"usePolyBlep" + QString::number (i+1 ) );
 
 		if (auto userWaveFile = _this.attribute("userwavefile" + is); !userWaveFile.isEmpty())
 		{
 			if (QFileInfo(PathUtil::toAbsolute(userWaveFile)).exists())
 			{
 				m_osc[i]->m_sampleBuffer = gui::SampleLoader::createBufferFromFile(userWaveFile);
-				m_osc[i]->m_userAntiAliasWaveTable = Oscillator::generateAntiAliasUserWaveTable(m_osc[i]->m_sampleBuffer.get());
+				m_osc[i]->m_userAntiAliasWaveTable = Oscillator::userWaveTable(m_osc[i]->m_sampleBuffer);
 			}
 			else { Engine::getSong()->collectError(QString("%1: %2").arg(tr("Sample not found"), userWaveFile)); }
 		}
@@ -306,82 +330,196 @@ QString TripleOscillator::nodeName() const
 
 
 
+void TripleOscillator::reportMemoryUsage( MemoryReport & report ) const
+{
+	for( int i = 0; i < NUM_OF_OSCILLATORS; ++i )
+	{
+		report.addSampleBuffer( m_osc[i]->m_sampleBuffer, tr( "Oscillator %1 user wave" ).arg( i + 1 ) );
+		if( m_osc[i]->m_userAntiAliasWaveTable )
+		{
+			report.add( tr( "Oscillator %1 user wave table" ).arg( i + 1 ),
+						sizeof( OscillatorConstants::waveform_t ) );
+		}
+	}
+}
+
+
+
+
 void TripleOscillator::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
-	if (!_n->m_pluginData)
+	if( !_n->m_pluginData )
 	{
-		auto oscs_l = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
-		auto oscs_r = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
+		createOscillators( _n );
+	}
+
+	updateOscillators( _n, _working_buffer + _n->noteOffset(), _n->framesLeftForCurrentPeriod() );
+
+	applyFadeIn(_working_buffer, _n);
+	applyRelease( _working_buffer, _n );
+}
+
 
-		for( int i = NUM_OF_OSCILLATORS - 1; i >= 0; --i )
+
+
+void TripleOscillator::playNotes( NotePlayHandle * const * _notes, std::size_t _count,
+					sampleFrame * _working_buffer )
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+
+	// every note gets a period of its own, with the note starting at its offset
+	auto noteFrames = PeriodAllocator<sampleFrame>::vector( _count * fpp );
+	auto buffers = PeriodAllocator<sampleFrame *>::vector( _count );
+	auto frames = PeriodAllocator<fpp_t>::vector( _count );
+	auto oscs_l = PeriodAllocator<Oscillator *>::vector();
+	auto oscs_r = PeriodAllocator<Oscillator *>::vector();
+	oscs_l.reserve( _count );
+	oscs_r.reserve( _count );
+	std::size_t voices = 0;
+	for( std::size_t i = 0; i < _count; ++i )
+	{
+		NotePlayHandle * n = _notes[i];
+		if( !n->m_pluginData )
 		{
+			createOscillators( n );
+		}
+		sampleFrame * buffer = noteFrames.data() + i * fpp + n->noteOffset();
+		if( n->frequencyBuffer() )
+		{
+			// a gliding note changes its frequency within the period,
+			// which the lanes can't follow
+			updateOscillators( n, buffer, n->framesLeftForCurrentPeriod() );
+			continue;
+		}
+		auto data = static_cast<oscPtr *>( n->m_pluginData );
+		data->frequency = n->frequency();
+		buffers[voices] = buffer;
+		frames[voices] = n->framesLeftForCurrentPeriod();
+		oscs_l.push_back( data->oscLeft );
+		oscs_r.push_back( data->oscRight );
+		++voices;
+	}
 
-			// the last oscs needs no sub-oscs...
-			if( i == NUM_OF_OSCILLATORS - 1 )
-			{
-				oscs_l[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningLeft,
-						m_osc[i]->m_phaseOffsetLeft,
-						m_osc[i]->m_volumeLeft );
-				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningRight,
-						m_osc[i]->m_phaseOffsetRight,
-						m_osc[i]->m_volumeRight );
-				oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-			}
-			else
+	// all voices share the same setup, if some part of it can't be
+	// rendered in lanes, nothing can
+	for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS && voices > 0; ++chnl )
+	{
+		const auto & oscs = chnl == 0 ? oscs_l : oscs_r;
+		if( !Oscillator::updateVoices( oscs.data(), buffers.data(), frames.data(), voices, chnl ) )
+		{
+			for( std::size_t i = 0; i < voices; ++i )
 			{
-				oscs_l[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningLeft,
-						m_osc[i]->m_phaseOffsetLeft,
-						m_osc[i]->m_volumeLeft,
-						oscs_l[i + 1] );
-				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
-						&m_osc[i]->m_waveShapeModel,
-						&m_osc[i]->m_modulationAlgoModel,
-						_n->frequency(),
-						m_osc[i]->m_detuningRight,
-						m_osc[i]->m_phaseOffsetRight,
-						m_osc[i]->m_volumeRight,
-						oscs_r[i + 1] );
-				oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+				oscs[i]->update( buffers[i], frames[i], chnl );
 			}
-
-			oscs_l[i]->setUserWave( m_osc[i]->m_sampleBuffer );
-			oscs_r[i]->setUserWave( m_osc[i]->m_sampleBuffer );
-			oscs_l[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
-			oscs_r[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
 		}
+	}
 
-		_n->m_pluginData = new oscPtr;
-		static_cast<oscPtr *>( _n->m_pluginData )->oscLeft = oscs_l[0];
-		static_cast< oscPtr *>( _n->m_pluginData )->oscRight =
-								oscs_r[0];
+	for( std::size_t i = 0; i < _count; ++i )
+	{
+		sampleFrame * noteBuffer = noteFrames.data() + i * fpp;
+		applyFadeIn( noteBuffer, _notes[i] );
+		applyRelease( noteBuffer, _notes[i] );
+		mixNote( _notes[i], noteBuffer, _working_buffer );
 	}
+}
 
-	Oscillator * osc_l = static_cast<oscPtr *>( _n->m_pluginData )->oscLeft;
-	Oscillator * osc_r = static_cast<oscPtr *>( _n->m_pluginData )->oscRight;
 
-	const fpp_t frames = _n->framesLeftForCurrentPeriod();
-	const f_cnt_t offset = _n->noteOffset();
 
-	osc_l->update( _working_buffer + offset, frames, 0 );
-	osc_r->update( _working_buffer + offset, frames, 1 );
 
-	applyFadeIn(_working_buffer, _n);
-	applyRelease( _working_buffer, _n );
+void TripleOscillator::updateOscillators( NotePlayHandle * _n, sampleFrame * buffer, fpp_t frames )
+{
+	auto data = static_cast<oscPtr *>( _n->m_pluginData );
+	const float * frequencies = _n->frequencyBuffer();
+	if( frequencies == nullptr )
+	{
+		data->frequency = _n->frequency();
+		data->oscLeft->update( buffer, frames, 0 );
+		data->oscRight->update( buffer, frames, 1 );
+		return;
+	}
+
+	// the oscillators follow the frequency of the block, which is short
+	// enough for the steps to be inaudible
+	frequencies += _n->noteOffset();
+	for( fpp_t frame = 0; frame < frames; frame += GlideFrames )
+	{
+		const fpp_t block = std::min<fpp_t>( GlideFrames, frames - frame );
+		data->frequency = frequencies[frame + block / 2];
+		data->oscLeft->update( buffer + frame, block, 0 );
+		data->oscRight->update( buffer + frame, block, 1 );
+	}
+}
+
+
+
+
+void TripleOscillator::createOscillators( NotePlayHandle * _n )
+{
+	auto data = new oscPtr;
+	data->frequency = _n->frequency();
+
+	auto oscs_l = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
+	auto oscs_r = std::array<Oscillator*, NUM_OF_OSCILLATORS>{};
+
+	for( int i = NUM_OF_OSCILLATORS - 1; i >= 0; --i )
+	{
+
+		// the last oscs needs no sub-oscs...
+		if( i == NUM_OF_OSCILLATORS - 1 )
+		{
+			oscs_l[i] = new Oscillator(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					data->frequency,
+					m_osc[i]->m_detuningLeft,
+					m_osc[i]->m_phaseOffsetLeft,
+					m_osc[i]->m_volumeLeft );
+			oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+			oscs_l[i]->setUsePolyBlep(m_osc[i]->m_usePolyBlep);
+			oscs_r[i] = new Oscillator(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					data->frequency,
+					m_osc[i]->m_detuningRight,
+					m_osc[i]->m_phaseOffsetRight,
+					m_osc[i]->m_volumeRight );
+			oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+			oscs_r[i]->setUsePolyBlep(m_osc[i]->m_usePolyBlep);
+		}
+		else
+		{
+			oscs_l[i] = new Oscillator(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					data->frequency,
+					m_osc[i]->m_detuningLeft,
+					m_osc[i]->m_phaseOffsetLeft,
+					m_osc[i]->m_volumeLeft,
+					oscs_l[i + 1] );
+			oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+			oscs_l[i]->setUsePolyBlep(m_osc[i]->m_usePolyBlep);
+			oscs_r[i] = new Oscillator(
+					&m_osc[i]->m_waveShapeModel,
+					&m_osc[i]->m_modulationAlgoModel,
+					data->frequency,
+					m_osc[i]->m_detuningRight,
+					m_osc[i]->m_phaseOffsetRight,
+					m_osc[i]->m_volumeRight,
+					oscs_r[i + 1] );
+			oscs_r[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
+			oscs_r[i]->setUsePolyBlep(m_osc[i]->m_usePolyBlep);
+		}
+
+		oscs_l[i]->setUserWave( m_osc[i]->m_sampleBuffer );
+		oscs_r[i]->setUserWave( m_osc[i]->m_sampleBuffer );
+		oscs_l[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
+		oscs_r[i]->setUserAntiAliasWaveTable(m_osc[i]->m_userAntiAliasWaveTable);
+	}
+
+	data->oscLeft = oscs_l[0];
+	data->oscRight = oscs_r[0];
+	_n->m_pluginData = data;
 }
 
 
@@ -682,6 +820,16 @@ TripleOscillatorView::TripleOscillatorView( Instrument * _instrument,
 		uwt->setCheckable(true);
 		uwt->setToolTip(tr("Use alias-free wavetable oscillators."));
 
+		auto upb = new PixmapButton(this, nullptr);
+		upb->move( 95, btn_y );
+		upb->setActiveGraphic( PLUGIN_NAME::getIconPixmap(
+							"polyblep_active" ) );
+		upb->setInactiveGraphic( PLUGIN_NAME::getIconPixmap(
+							"polyblep_inactive" ) );
+		upb->setCheckable(true);
+		upb->setToolTip(tr("Use band-limited steps instead of wavetables. "
+					"Needs less memory, but keeps a little more aliasing."));
+
 		auto wsbg = new automatableButtonGroup(this);
 
 		wsbg->addButton( sin_wave_btn );
@@ -695,7 +843,7 @@ TripleOscillatorView::TripleOscillatorView( Instrument * _instrument,
 
 
 		m_oscKnobs[i] = OscillatorKnobs( vk, pk, ck, flk, frk, pok,
-							spdk, uwb, wsbg, uwt );
+							spdk, uwb, wsbg, uwt, upb );
 	}
 }
 
@@ -728,6 +876,8 @@ void TripleOscillatorView::modelChanged()
 					&t->m_osc[i]->m_waveShapeModel );
 		m_oscKnobs[i].m_multiBandWaveTableButton->setModel(
 					&t->m_osc[i]->m_useWaveTableModel );
+		m_oscKnobs[i].m_polyBlepButton->setModel(
+					&t->m_osc[i]->m_usePolyBlepModel );
 
 		connect( m_oscKnobs[i].m_userWaveButton,
 						SIGNAL( doubleClicked() ),
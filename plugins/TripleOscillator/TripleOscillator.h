@@ -41,6 +41,7 @@ namespace lmms
 class NotePlayHandle;
 class SampleBuffer;
 class Oscillator;
+class UserWaveTable;
 
 
 namespace gui
@@ -72,8 +73,9 @@ private:
 	IntModel m_waveShapeModel;
 	IntModel m_modulationAlgoModel;
 	BoolModel m_useWaveTableModel;
+	BoolModel m_usePolyBlepModel;
 	std::shared_ptr<const SampleBuffer> m_sampleBuffer = SampleBuffer::emptyBuffer();
-	std::shared_ptr<const OscillatorConstants::waveform_t> m_userAntiAliasWaveTable;
+	std::shared_ptr<const UserWaveTable> m_userAntiAliasWaveTable;
 
 	float m_volumeLeft;
 	float m_volumeRight;
@@ -85,6 +87,7 @@ private:
 	float m_phaseOffsetLeft;
 	float m_phaseOffsetRight;
 	bool m_useWaveTable;
+	bool m_usePolyBlep;
 
 	friend class TripleOscillator;
 	friend class gui::TripleOscillatorView;
@@ -99,6 +102,7 @@ private slots:
 	void updatePhaseOffsetLeft();
 	void updatePhaseOffsetRight();
 	void updateUseWaveTable();
+	void updateUsePolyBlep();
 
 } ;
 
@@ -114,6 +118,8 @@ public:
 
 	void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer ) override;
+	void playNotes( NotePlayHandle * const * _notes, std::size_t _count,
+				sampleFrame * _working_buffer ) override;
 	void deleteNotePluginData( NotePlayHandle * _n ) override;
 
 
@@ -122,6 +128,13 @@ public:
 
 	QString nodeName() const override;
 
+	Flags flags() const override
+	{
+		return Flag::PlaysNotesBatched;
+	}
+
+	void reportMemoryUsage( MemoryReport & report ) const override;
+
 	f_cnt_t desiredReleaseFrames() const override
 	{
 		return( 128 );
@@ -135,6 +148,11 @@ protected slots:
 
 
 private:
+	void createOscillators( NotePlayHandle * _n );
+	//! Renders @p frames frames of the note into @p buffer, which is where it
+	//! starts in this period, following the detuning automation if it moves
+	void updateOscillators( NotePlayHandle * _n, sampleFrame * buffer, fpp_t frames );
+
 	OscillatorObject * m_osc[NUM_OF_OSCILLATORS];
 
 	struct oscPtr
@@ -142,6 +160,9 @@ private:
 		MM_OPERATORS
 		Oscillator * oscLeft;
 		Oscillator * oscRight;
+		//! What the oscillators play, the frequency of the note or, while
+		//! it glides, the one of the block being rendered
+		float frequency;
 	} ;
 
 
@@ -180,7 +201,8 @@ private:
 					Knob * spd,
 					PixmapButton * uwb,
 					automatableButtonGroup * wsbg,
-					PixmapButton * wt) :
+					PixmapButton * wt,
+					PixmapButton * pb) :
 			m_volKnob( v ),
 			m_panKnob( p ),
 			m_coarseKnob( c ),
@@ -190,7 +212,8 @@ private:
 			m_stereoPhaseDetuningKnob( spd ),
 			m_userWaveButton( uwb ),
 			m_waveShapeBtnGrp( wsbg ),
-			m_multiBandWaveTableButton( wt )
+			m_multiBandWaveTableButton( wt ),
+			m_polyBlepButton( pb )
 		{
 		}
 		OscillatorKnobs() = default;
@@ -204,6 +227,7 @@ private:
 		PixmapButton * m_userWaveButton;
 		automatableButtonGroup * m_waveShapeBtnGrp;
 		PixmapButton * m_multiBandWaveTableButton;
+		PixmapButton * m_polyBlepButton;
 
 	} ;
 
@@ -127,15 +127,19 @@ void VectorView::paintEvent(QPaintEvent *event)
 		// Note that for simplicity and performance reasons, this implementation only dims all stored
 		// values by a given factor. A true simulation would also do the inverse of desaturation that
 		// occurs in high-intensity traces in HQ mode.
+		uchar lit = 0;
 		for (std::size_t i = 0; i < useableBuffer; i++)
 		{
 			m_displayBuffer.data()[i] *= persistPerFrame;
+			lit |= m_displayBuffer.data()[i];
 		}
+		m_displayLit = lit != 0;
 	}
 
 	// Get new samples from the lockless input FIFO buffer
 	auto inBuffer = m_bufferReader.read_max(m_inputBuffer->capacity());
 	std::size_t frameCount = inBuffer.size();
+	if (frameCount > 0) {m_displayLit = true;}
 
 	// Draw new points on top
 	float left, right;
@@ -244,15 +248,13 @@ void VectorView::paintEvent(QPaintEvent *event)
 	// Draw background
 	painter.fillRect(displayLeft, displayTop, displayWidth, displayHeight, QColor(0,0,0));
 
-	// Draw the final image
+	// Draw the final image, scaled while drawing instead of making a scaled copy first
 	QImage temp = QImage(m_displayBuffer.data(),
 						 activeSize,
 						 activeSize,
 						 QImage::Format_RGB32);
-	temp.setDevicePixelRatio(devicePixelRatio());
-	painter.drawImage(displayLeft, displayTop,
-					  temp.scaledToWidth(displayWidth * devicePixelRatio(),
-					  Qt::SmoothTransformation));
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+	painter.drawImage(QRectF(displayLeft, displayTop, displayWidth, displayWidth), temp);
 
 	// Draw the grid and labels
 	painter.setPen(QPen(m_controls->m_colorGrid, 1.5, Qt::SolidLine, Qt::RoundCap, Qt::BevelJoin));
@@ -295,11 +297,23 @@ void VectorView::paintEvent(QPaintEvent *event)
 }
 
 
-// Periodically trigger repaint and check if the widget is visible
+// Periodically trigger repaint and check if the widget is visible.
+// Once the trace faded out and no new samples arrive, every repaint would
+// look the same, so they are skipped until something changes.
 void VectorView::periodicUpdate()
 {
 	m_visible = isVisible();
-	if (m_visible) {update();}
+	if (!m_visible) {return;}
+
+	const unsigned int currentTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>
+	(
+		std::chrono::high_resolution_clock::now().time_since_epoch()
+	).count();
+	// the zoom info needs one more repaint to disappear
+	const bool zoomShown = currentTimestamp - m_zoomTimestamp < 1100;
+	const bool hqChanged = m_controls->m_highQualityModel.value() != m_oldHQ;
+
+	if (m_displayLit || zoomShown || hqChanged || !m_bufferReader.empty()) {update();}
 }
 
 
@@ -328,7 +342,7 @@ void VectorView::wheelEvent(QWheelEvent *event)
 	(
 		std::chrono::high_resolution_clock::now().time_since_epoch()
 	).count();
-
+	update();
 }
 
 
@@ -66,6 +66,7 @@ private:
 	const unsigned short m_displaySize;
 
 	bool m_visible;
+	bool m_displayLit = true;	//!< whether the display buffer has any pixel that isn't black
 
 	float m_zoom;
 
@@ -401,11 +401,13 @@ void VestigeInstrument::play( sampleFrame * _buf )
 
 	if( m_plugin == nullptr )
 	{
+		m_latency = 0;
 		m_pluginMutex.unlock();
 		return;
 	}
 
 	m_plugin->process( nullptr, _buf );
+	m_latency = m_plugin->latency();
 
 	m_pluginMutex.unlock();
 }
@@ -72,11 +72,16 @@ public:
 
 	virtual Flags flags() const
 	{
-		return Flag::IsSingleStreamed | Flag::IsMidiBased;
+		return Flag::IsSingleStreamed | Flag::IsMidiBased | Flag::NeedsFixedThread;
 	}
 
 	virtual bool handleMidiEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset = 0 );
 
+	virtual f_cnt_t latency() const
+	{
+		return m_latency;
+	}
+
 	virtual gui::PluginView* instantiateView( QWidget * _parent );
 
 protected slots:
@@ -90,6 +95,8 @@ private:
 
 	VstPlugin * m_plugin;
 	QMutex m_pluginMutex;
+	// of m_plugin as of the last period it played
+	f_cnt_t m_latency = 0;
 
 	QString m_pluginDLL;
 	QMdiSubWindow * m_subWindow;
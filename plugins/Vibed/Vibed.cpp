@@ -88,7 +88,19 @@ public:
 
 	bool exists(int id) const { return m_exists[id]; }
 
-	sample_t getStringSample(int id) { return m_strings[id].nextSample(); }
+	//! Adds the next @p frames samples of string @p id to @p buffer with the
+	//! given gains. A string that fell silent is stopped.
+	void addStringSamples(int id, sampleFrame* buffer, fpp_t frames, float leftGain, float rightGain)
+	{
+		auto& string = m_strings[id];
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			const sample_t sample = string.nextSample();
+			buffer[f][0] += leftGain * sample;
+			buffer[f][1] += rightGain * sample;
+		}
+		if (string.isSilent()) { m_exists[id] = false; }
+	}
 
 private:
 	const float m_pitch;
@@ -239,16 +251,16 @@ void Vibed::playNote(NotePlayHandle* n, sampleFrame* workingBuffer)
 	{
 		workingBuffer[i][0] = 0.0f;
 		workingBuffer[i][1] = 0.0f;
-		for (int str = 0; str < s_stringCount; ++str)
+	}
+
+	for (int str = 0; str < s_stringCount; ++str)
+	{
+		if (ps->exists(str))
 		{
-			if (ps->exists(str))
-			{
-				// pan: 0 -> left, 1 -> right
-				const float pan = (m_panModels[str]->value() + 1) / 2.0f;
-				const sample_t sample = ps->getStringSample(str) * m_volumeModels[str]->value() / 100.0f;
-				workingBuffer[i][0] += (1.0f - pan) * sample;
-				workingBuffer[i][1] += pan * sample;
-			}
+			// pan: 0 -> left, 1 -> right
+			const float pan = (m_panModels[str]->value() + 1) / 2.0f;
+			const float volume = m_volumeModels[str]->value() / 100.0f;
+			ps->addStringSamples(str, workingBuffer + offset, frames, (1.0f - pan) * volume, pan * volume);
 		}
 	}
 }
@@ -39,9 +39,8 @@ VibratingString::VibratingString(float pitch, float pick, float pickup, const fl
 	m_oversample{2 * oversample / static_cast<int>(sampleRate / Engine::audioEngine()->baseSampleRate())},
 	m_randomize{randomize},
 	m_stringLoss{1.0f - stringLoss},
-	m_choice{static_cast<int>(m_oversample * static_cast<float>(std::rand()) / RAND_MAX)},
-	m_state{0.1f},
-	m_outsamp{std::make_unique<sample_t[]>(m_oversample)}
+	m_choice{std::min(static_cast<int>(m_oversample * static_cast<float>(std::rand()) / RAND_MAX), m_oversample - 1)},
+	m_state{0.1f}
 {
 	int stringLength = static_cast<int>(m_oversample * sampleRate / pitch) + 1;
 	stringLength += static_cast<int>(stringLength * -detune);
@@ -66,6 +65,8 @@ VibratingString::VibratingString(float pitch, float pick, float pickup, const fl
 	VibratingString::setDelayLine(m_fromBridge.get(), pickInt, m_impulse.get(), len, 0.5f, state);
 
 	m_pickupLoc = static_cast<int>(pickup * stringLength);
+	// in output samples, with some to spare
+	m_roundTrip = 4 * stringLength / std::max(m_oversample, 1);
 }
 
 std::unique_ptr<VibratingString::DelayLine> VibratingString::initDelayLine(int len)
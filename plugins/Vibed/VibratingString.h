@@ -25,6 +25,7 @@
 #ifndef LMMS_VIBRATING_STRING_H
 #define LMMS_VIBRATING_STRING_H
 
+#include <cmath>
 #include <memory>
 #include <cstdlib>
 
@@ -51,11 +52,15 @@ public:
 	{
 		sample_t ym0;
 		sample_t ypM;
+		sample_t out = 0.0f;
 		for (int i = 0; i < m_oversample; ++i)
 		{
-			// Output at pickup position
-			m_outsamp[i] = fromBridgeAccess(m_fromBridge.get(), m_pickupLoc);
-			m_outsamp[i] += toBridgeAccess(m_toBridge.get(), m_pickupLoc);
+			// Output at pickup position, only needed for the oversampled step that is used
+			if (i == m_choice)
+			{
+				out = fromBridgeAccess(m_fromBridge.get(), m_pickupLoc);
+				out += toBridgeAccess(m_toBridge.get(), m_pickupLoc);
+			}
 
 			// Sample traveling into "bridge"
 			ym0 = toBridgeAccess(m_toBridge.get(), 1);
@@ -70,9 +75,14 @@ public:
 			toBridgeUpdate(m_toBridge.get(), -ypM);
 		}
 
-		return m_outsamp[m_choice];
+		m_silentSamples = std::abs(out) < SilenceThreshold ? m_silentSamples + 1 : 0;
+		return out;
 	}
 
+	//! Whether the string has been inaudible at its pickup for longer than
+	//! a wave takes to travel it back and forth, so it won't be heard again
+	bool isSilent() const { return m_silentSamples > m_roundTrip; }
+
 private:
 	struct DelayLine
 	{
@@ -93,7 +103,10 @@ private:
 	int m_choice;
 	float m_state;
 
-	std::unique_ptr<sample_t[]> m_outsamp;
+	//! About -100 dBFS
+	static constexpr sample_t SilenceThreshold = 1.0e-5f;
+	int m_silentSamples = 0;
+	int m_roundTrip = 0;
 
 	std::unique_ptr<DelayLine> initDelayLine(int len);
 	void resample(const float* src, f_cnt_t srcFrames, f_cnt_t dstFrames);
@@ -94,6 +94,8 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <vector>
 #include <queue>
 #include <string>
@@ -133,19 +135,32 @@ static bool EMBED = false;
 static bool EMBED_X11 = false;
 static bool EMBED_WIN32 = false;
 static bool HEADLESS = false;
+// whether the process hosts every plugin the host asks for over the
+// connection of a RemoteVstHost, rather than just one
+static bool SHARED = false;
 
 namespace lmms
 {
 class RemoteVstPlugin;
 }
 
+// the plugin being created, and otherwise the one created last - which
+// is simply the plugin in a process that hosts a single one
 lmms::RemoteVstPlugin * __plugin = nullptr;
 
+// the loaded plugins, and those to be deleted by the GUI event loop,
+// only used by the GUI thread
+std::vector<lmms::RemoteVstPlugin *> __plugins;
+std::vector<lmms::RemoteVstPlugin *> __closedPlugins;
+// whether the host is done with the plugins of a shared process
+std::atomic<bool> __hostQuit( false );
+
 #ifndef NATIVE_LINUX_VST
 HWND __MessageHwnd = nullptr;
-DWORD __processingThreadId = 0;
 #else
-pthread_t __processingThreadId = 0;
+// the sockets of the plugins the GUI thread is to create
+std::queue<std::string> __pendingClients;
+pthread_mutex_t __pendingClientsMutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 namespace lmms
@@ -370,6 +385,26 @@ public:
 	void sendX11Idle();
 #endif
 
+	//! Starts the thread processing the plugin's audio, once it's loaded
+	bool startProcessing();
+#ifdef NATIVE_LINUX_VST
+	void joinProcessingThread()
+	{
+		pthread_join( m_processingThread, nullptr );
+	}
+#endif
+
+#ifndef SYNC_WITH_SHM_FIFO
+	//! Has the GUI thread create a plugin connecting to @p socketPath, in a
+	//! shared process
+	static void requestPlugin( const std::string & socketPath );
+	static void attachPlugin( const std::string & socketPath );
+#endif
+	//! Has the GUI thread quit a shared process once its plugins are closed
+	static void requestQuit();
+	static void closePlugin( RemoteVstPlugin * plugin );
+	static void deleteClosedPlugins();
+
 #ifndef NATIVE_LINUX_VST
 	static DWORD WINAPI processingThread( LPVOID _param );
 #else
@@ -381,7 +416,7 @@ public:
 #ifndef NATIVE_LINUX_VST
 	static DWORD WINAPI guiEventLoop();
 #else
-	void guiEventLoop();
+	static void guiEventLoop();
 #endif
 	
 #ifndef NATIVE_LINUX_VST
@@ -395,7 +430,16 @@ private:
 		None,
 		ProcessPluginMessage,
 		GiveIdle,
-		ClosePlugin
+		ClosePlugin,
+		AttachPlugin,
+		CloseHost
+	} ;
+
+	// what the processing thread passes a message for the GUI thread in
+	struct PluginMessage
+	{
+		RemoteVstPlugin * plugin;
+		message m;
 	} ;
 
 	struct SuspendPlugin {
@@ -461,7 +505,10 @@ private:
 
 	bool m_processing;
 
-#ifdef NATIVE_LINUX_VST
+#ifndef NATIVE_LINUX_VST
+	DWORD m_processingThreadId = 0;
+#else
+	pthread_t m_processingThread = 0;
 	pthread_mutex_t message_mutex = PTHREAD_MUTEX_INITIALIZER;
 	bool m_shouldQuit = false;
 #endif
@@ -478,6 +525,19 @@ private:
 	using VstMidiEventList = std::vector<VstMidiEvent>;
 	VstMidiEventList m_midiEvents;
 
+	// the parameter changes of automation, which come with the periods
+	SharedMemory<const VstParameterChanges> m_parameterChanges;
+	uint32_t m_parameterChangesSerial = 0;
+
+	// since MIDI-events are not received immediately, we have to have them
+	// stored somewhere even after the dispatcher-call
+	static constexpr int MidiEventBufferCount = 1024;
+	char m_eventsBuffer[sizeof( VstEvents ) + sizeof( VstMidiEvent * ) * MidiEventBufferCount];
+	VstMidiEvent m_eventBuffer[MidiEventBufferCount];
+
+	// what audioMasterGetTime returns
+	VstTimeInfo m_timeInfo;
+
 	bpm_t m_bpm;
 	double m_currentSamplePos;
 	int m_currentProgram;
@@ -495,6 +555,59 @@ private:
 
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+/**
+ * The connection a shared process gets the host's requests for plugins over,
+ * each of which connects to the host on its own then.
+ */
+class RemoteVstHost : public RemotePluginClient
+{
+public:
+	RemoteVstHost( const char * socketPath ) :
+		RemotePluginClient( socketPath )
+	{
+	}
+
+	void process( const sampleFrame *, sampleFrame * ) override
+	{
+	}
+
+	bool processMessage( const message & _m ) override
+	{
+		if( _m.id == IdAttachClient )
+		{
+			RemoteVstPlugin::requestPlugin( _m.getString() );
+			return true;
+		}
+		return RemotePluginClient::processMessage( _m );
+	}
+
+#ifndef NATIVE_LINUX_VST
+	static DWORD WINAPI thread( LPVOID _param )
+#else
+	static void * thread( void * _param )
+#endif
+	{
+		auto _this = static_cast<RemoteVstHost *>( _param );
+
+		message m;
+		while( ( m = _this->receiveMessage() ).id != IdQuit && !_this->isInvalid() )
+		{
+			_this->processMessage( m );
+		}
+		RemoteVstPlugin::requestQuit();
+
+#ifndef NATIVE_LINUX_VST
+		return 0;
+#else
+		return nullptr;
+#endif
+	}
+} ;
+#endif // SYNC_WITH_SHM_FIFO
+
+
+
 
 #ifdef SYNC_WITH_SHM_FIFO
 RemoteVstPlugin::RemoteVstPlugin( const std::string& _shm_in, const std::string& _shm_out ) :
@@ -682,6 +795,19 @@ bool RemoteVstPlugin::processMessage( const message & _m )
 			//sendMessage( IdVstSetParameter );
 			break;
 
+		case IdVstParameterChangesKey:
+			try
+			{
+				m_parameterChanges.attach( _m.getString( 0 ) );
+				m_parameterChangesSerial = m_parameterChanges->serial;
+			}
+			catch( const std::runtime_error & error )
+			{
+				// the host sends every change in a message of its own then
+				debugMessage( std::string{ "Failed to attach parameter changes: " } + error.what() + '\n' );
+			}
+			break;
+
 		case IdVstParameterDisplays:
 			getParameterDisplays();
 			break;
@@ -1010,6 +1136,10 @@ bool RemoteVstPlugin::load( const std::string & _plugin_file )
 		return false;
 	}
 
+	// resvd2 is reserved for the host, and tells hostCallback() whose
+	// effect calls it
+	m_plugin->ptr2 = this;
+
 
 	char id[5];
 	sprintf( id, "%c%c%c%c", ((char *)&m_plugin->uniqueID)[3],
@@ -1029,17 +1159,26 @@ bool RemoteVstPlugin::load( const std::string & _plugin_file )
 
 void RemoteVstPlugin::process( const sampleFrame * _in, sampleFrame * _out )
 {
+	// the host wrote these before handing us the period, VST 2.4 has no
+	// way of changing a parameter in the middle of it
+	if( m_parameterChanges && m_parameterChanges->serial != m_parameterChangesSerial )
+	{
+		const VstParameterChanges & changes = *m_parameterChanges;
+		m_parameterChangesSerial = changes.serial;
+		const int32_t count = std::min( changes.count, VstParameterChanges::Capacity );
+		for( int32_t i = 0; i < count; ++i )
+		{
+			const auto & change = changes.changes[i];
+			if( change.index >= 0 && change.index < m_plugin->numParams )
+			{
+				m_plugin->setParameter( m_plugin, change.index, change.value );
+			}
+		}
+	}
+
 	// first we gonna post all MIDI-events we enqueued so far
 	if( m_midiEvents.size() )
 	{
-		// since MIDI-events are not received immediately, we
-		// have to have them stored somewhere even after
-		// dispatcher-call, so we create static copies of the
-		// data and post them
-#define MIDI_EVENT_BUFFER_COUNT		1024
-		static char eventsBuffer[sizeof( VstEvents ) + sizeof( VstMidiEvent * ) * MIDI_EVENT_BUFFER_COUNT];
-		static VstMidiEvent vme[MIDI_EVENT_BUFFER_COUNT];
-
 		// first sort events chronologically, since some plugins
 		// (e.g. Sinnah) can hang if they're out of order
 		std::stable_sort( m_midiEvents.begin(), m_midiEvents.end(),
@@ -1048,15 +1187,15 @@ void RemoteVstPlugin::process( const sampleFrame * _in, sampleFrame * _out )
 					return a.deltaFrames < b.deltaFrames;
 				} );
 
-		auto events = (VstEvents*)eventsBuffer;
+		auto events = (VstEvents*)m_eventsBuffer;
 		events->reserved = 0;
 		events->numEvents = m_midiEvents.size();
 
 		int idx = 0;
 		for( VstMidiEventList::iterator it = m_midiEvents.begin(); it != m_midiEvents.end(); ++it, ++idx )
 		{
-			memcpy( &vme[idx], &*it, sizeof( VstMidiEvent ) );
-			events->events[idx] = (VstEvent *) &vme[idx];
+			memcpy( &m_eventBuffer[idx], &*it, sizeof( VstMidiEvent ) );
+			events->events[idx] = (VstEvent *) &m_eventBuffer[idx];
 		}
 
 		m_midiEvents.clear();
@@ -1252,9 +1391,7 @@ void RemoteVstPlugin::sendCurrentProgramName()
 
 void RemoteVstPlugin::getParameterDump()
 {
-	message m( IdVstParameterDump );
-	m.addInt( m_plugin->numParams );
-
+	std::string dump;
 	for( int i = 0; i < m_plugin->numParams; ++i )
 	{
 		char paramName[256];
@@ -1262,12 +1399,10 @@ void RemoteVstPlugin::getParameterDump()
 		pluginDispatch( effGetParamName, i, 0, paramName );
 		paramName[sizeof(paramName)-1] = 0;
 
-		m.addInt( i );
-		m.addString( paramName );
-		m.addFloat( m_plugin->getParameter( m_plugin, i ) );
+		appendParameterDumpItem( dump, { i, paramName, m_plugin->getParameter( m_plugin, i ) } );
 	}
 
-	sendMessage( m );
+	sendMessage( message( IdVstParameterDump ).addString( dump ) );
 }
 
 
@@ -1275,18 +1410,13 @@ void RemoteVstPlugin::getParameterDump()
 
 void RemoteVstPlugin::setParameterDump( const message & _m )
 {
-	const int n = _m.getInt( 0 );
-	const int params = ( n > m_plugin->numParams ) ?
-					m_plugin->numParams : n;
-	int p = 0;
-	for( int i = 0; i < params; ++i )
-	{
-		VstParameterDumpItem item;
-		item.index = _m.getInt( ++p );
-		item.shortLabel = _m.getString( ++p );
-		item.value = _m.getFloat( ++p );
-		m_plugin->setParameter( m_plugin, item.index, item.value );
-	}
+	forEachParameterDumpItem( _m.getString( 0 ), [this]( const VstParameterDumpItem & item )
+	{
+		if( item.index >= 0 && item.index < m_plugin->numParams )
+		{
+			m_plugin->setParameter( m_plugin, item.index, item.value );
+		}
+	} );
 }
 
 
@@ -1666,9 +1796,9 @@ int RemoteVstPlugin::updateInOutCount()
 	}
 	
 #ifndef NATIVE_LINUX_VST
-	if( GetCurrentThreadId() == __processingThreadId )
+	if( GetCurrentThreadId() == m_processingThreadId )
 #else
-	if( pthread_equal(pthread_self(), __processingThreadId) )
+	if( pthread_equal(pthread_self(), m_processingThread) )
 #endif
 	{
 		debugMessage( "Plugin requested I/O change from processing "
@@ -1711,7 +1841,7 @@ int RemoteVstPlugin::updateInOutCount()
 
 //#define DEBUG_CALLBACKS
 #ifdef DEBUG_CALLBACKS
-#define SHOW_CALLBACK __plugin->debugMessage
+#define SHOW_CALLBACK plugin->debugMessage
 #else
 #define SHOW_CALLBACK(...)
 #endif
@@ -1728,7 +1858,15 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 					int32_t _index, intptr_t _value,
 						void * _ptr, float _opt )
 {
-	static VstTimeInfo _timeInfo;
+	// in a shared process, the effect knows its plugin - unless it's the
+	// one being loaded, which early callbacks come from
+	RemoteVstPlugin * plugin = SHARED && _effect && _effect->ptr2
+		? static_cast<RemoteVstPlugin *>( _effect->ptr2 ) : __plugin;
+	if( plugin == nullptr )
+	{
+		return 0;
+	}
+	VstTimeInfo & _timeInfo = plugin->m_timeInfo;
 #ifdef DEBUG_CALLBACKS
 	char buf[64];
 	sprintf( buf, "host-callback, opcode = %d\n", (int) _opcode );
@@ -1736,9 +1874,9 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 #endif
 
 	// workaround for early callbacks by some plugins
-	if( __plugin && __plugin->m_plugin == nullptr )
+	if( plugin->m_plugin == nullptr )
 	{
-		__plugin->m_plugin = _effect;
+		plugin->m_plugin = _effect;
 	}
 
 	switch( _opcode )
@@ -1765,7 +1903,7 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 #ifndef NATIVE_LINUX_VST
 			PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::GiveIdle), 0 );
 #else
-			__plugin->sendX11Idle();
+			plugin->sendX11Idle();
 #endif
 			return 0;
 
@@ -1786,11 +1924,11 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 			// fields are required (see valid masks above), as some
 			// items may require extensive conversions
 
-			const auto syncData = __plugin->getVstSyncData();
+			const auto syncData = plugin->getVstSyncData();
 			assert(syncData != nullptr);
 
 			memset( &_timeInfo, 0, sizeof( _timeInfo ) );
-			_timeInfo.samplePos = __plugin->m_currentSamplePos;
+			_timeInfo.samplePos = plugin->m_currentSamplePos;
 			_timeInfo.sampleRate = syncData->m_sampleRate;
 			_timeInfo.flags = 0;
 			_timeInfo.tempo = syncData->m_bpm;
@@ -1807,19 +1945,19 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 				_timeInfo.flags |= kVstTransportCycleActive;
 			}
 
-			if (syncData->ppqPos != __plugin->m_in->m_Timestamp)
+			if (syncData->ppqPos != plugin->m_in->m_Timestamp)
 			{
 				_timeInfo.ppqPos = syncData->ppqPos;
-				__plugin->m_in->lastppqPos = syncData->ppqPos;
-				__plugin->m_in->m_Timestamp = syncData->ppqPos;
+				plugin->m_in->lastppqPos = syncData->ppqPos;
+				plugin->m_in->m_Timestamp = syncData->ppqPos;
 			}
 			else if (syncData->isPlaying)
 			{
-				__plugin->m_in->lastppqPos +=
+				plugin->m_in->lastppqPos +=
 					syncData->m_bpm / 60.0
 					* syncData->m_bufferSize
 					/ syncData->m_sampleRate;
-				_timeInfo.ppqPos = __plugin->m_in->lastppqPos;
+				_timeInfo.ppqPos = plugin->m_in->lastppqPos;
 			}
 //			_timeInfo.ppqPos = syncData->ppqPos;
 			_timeInfo.flags |= kVstPpqPosValid;
@@ -1835,12 +1973,12 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 			_timeInfo.flags |= kVstBarsValid;
 
 			if ((_timeInfo.flags & (kVstTransportPlaying | kVstTransportCycleActive))
-				!= (__plugin->m_in->m_lastFlags & (kVstTransportPlaying | kVstTransportCycleActive))
+				!= (plugin->m_in->m_lastFlags & (kVstTransportPlaying | kVstTransportCycleActive))
 				|| syncData->m_playbackJumped)
 			{
 				_timeInfo.flags |= kVstTransportChanged;
 			}
-			__plugin->m_in->m_lastFlags = _timeInfo.flags;
+			plugin->m_in->m_lastFlags = _timeInfo.flags;
 
 			return (intptr_t) &_timeInfo;
 		}
@@ -1853,7 +1991,7 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 		case audioMasterIOChanged:
 			SHOW_CALLBACK( "amc: audioMasterIOChanged\n" );
 			// numInputs, numOutputs, and/or latency has changed
-			return __plugin->updateInOutCount();
+			return plugin->updateInOutCount();
 
 #ifdef OLD_VST_SDK
 		case audioMasterWantMidi:
@@ -1869,7 +2007,7 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 
 		case audioMasterTempoAt:
 			SHOW_CALLBACK( "amc: audioMasterTempoAt\n" );
-			return __plugin->m_bpm * 10000;
+			return plugin->m_bpm * 10000;
 
 		case audioMasterGetNumAutomatableParameters:
 			SHOW_CALLBACK( "amc: audioMasterGetNumAutomatable"
@@ -1942,14 +2080,14 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 		case audioMasterSizeWindow:
 		{
 			SHOW_CALLBACK( "amc: audioMasterSizeWindow\n" );
-			if( __plugin->m_window == 0 )
+			if( plugin->m_window == 0 )
 			{
 				return 0;
 			}
-			__plugin->m_windowWidth = _index;
-			__plugin->m_windowHeight = _value;
+			plugin->m_windowWidth = _index;
+			plugin->m_windowHeight = _value;
 #ifndef NATIVE_LINUX_VST
-			HWND window = __plugin->m_window;
+			HWND window = plugin->m_window;
 			DWORD dwStyle = GetWindowLongPtr( window, GWL_STYLE );
 			RECT windowSize = { 0, 0, (int) _index, (int) _value };
 			AdjustWindowRect( &windowSize, dwStyle, false );
@@ -1959,32 +2097,32 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 					SWP_NOACTIVATE | SWP_NOMOVE |
 					SWP_NOOWNERZORDER | SWP_NOZORDER );
 #else
-			XResizeWindow(__plugin->m_display, __plugin->m_window, (int) _index, (int) _value);
-			XFlush(__plugin->m_display);
+			XResizeWindow(plugin->m_display, plugin->m_window, (int) _index, (int) _value);
+			XFlush(plugin->m_display);
 #endif
-			__plugin->sendMessage(
+			plugin->sendMessage(
 				message( IdVstPluginEditorGeometry ).
-					addInt( __plugin->m_windowWidth ).
-					addInt( __plugin->m_windowHeight ) );
+					addInt( plugin->m_windowWidth ).
+					addInt( plugin->m_windowHeight ) );
 			return 1;
 		}
 
 		case audioMasterGetSampleRate:
 			SHOW_CALLBACK( "amc: audioMasterGetSampleRate\n" );
-			return __plugin->sampleRate();
+			return plugin->sampleRate();
 
 		case audioMasterGetBlockSize:
 			SHOW_CALLBACK( "amc: audioMasterGetBlockSize\n" );
 
-			return __plugin->bufferSize();
+			return plugin->bufferSize();
 
 		case audioMasterGetInputLatency:
 			SHOW_CALLBACK( "amc: audioMasterGetInputLatency\n" );
-			return __plugin->bufferSize();
+			return plugin->bufferSize();
 
 		case audioMasterGetOutputLatency:
 			SHOW_CALLBACK( "amc: audioMasterGetOutputLatency\n" );
-			return __plugin->bufferSize();
+			return plugin->bufferSize();
 
 		case audioMasterGetCurrentProcessLevel:
 			SHOW_CALLBACK( "amc: audioMasterGetCurrentProcess"
@@ -2079,7 +2217,7 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 #ifndef NATIVE_LINUX_VST
 			PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::GiveIdle), 0 );
 #else
-			__plugin->sendX11Idle();
+			plugin->sendX11Idle();
 #endif
 			return 0;
 
@@ -2205,14 +2343,14 @@ DWORD WINAPI RemoteVstPlugin::processingThread( LPVOID _param )
 void * RemoteVstPlugin::processingThread(void * _param)
 #endif
 {
+	RemoteVstPlugin * _this = static_cast<RemoteVstPlugin *>( _param );
+
 #ifndef NATIVE_LINUX_VST
-	__processingThreadId = GetCurrentThreadId();
+	_this->m_processingThreadId = GetCurrentThreadId();
 #else
-	__processingThreadId = pthread_self();
+	_this->m_processingThread = pthread_self();
 #endif
 
-	RemoteVstPlugin * _this = static_cast<RemoteVstPlugin *>( _param );
-
 	RemotePluginClient::message m;
 	while( ( m = _this->receiveMessage() ).id != IdQuit )
 	{
@@ -2220,7 +2358,9 @@ void * RemoteVstPlugin::processingThread(void * _param)
 		if( m.id == IdStartProcessing
 			|| m.id == IdMidiEvent
 			|| m.id == IdVstSetParameter
-			|| m.id == IdVstSetTempo)
+			|| m.id == IdVstSetTempo
+			|| m.id == IdVstParameterChangesKey
+			|| m.id == IdChangeProcessingSyncKey)
 		{
 			_this->processMessage( m );
 		}
@@ -2235,7 +2375,7 @@ void * RemoteVstPlugin::processingThread(void * _param)
 			PostMessage( __MessageHwnd,
 					WM_USER,
 					static_cast<WPARAM>(GuiThreadMessage::ProcessPluginMessage),
-					(LPARAM) new message( m ) );
+					(LPARAM) new PluginMessage{ _this, m } );
 #else
 		_this->queueMessage( m );
 #endif
@@ -2244,7 +2384,7 @@ void * RemoteVstPlugin::processingThread(void * _param)
 
 	// notify GUI thread about shutdown
 #ifndef NATIVE_LINUX_VST
-	PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::ClosePlugin), 0 );
+	PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::ClosePlugin), (LPARAM) _this );
 
 	return 0;
 #else
@@ -2258,14 +2398,105 @@ void * RemoteVstPlugin::processingThread(void * _param)
 }
 
 
+
+
+bool RemoteVstPlugin::startProcessing()
+{
+#ifndef NATIVE_LINUX_VST
+	if( CreateThread( nullptr, 0, processingThread, this, 0, nullptr ) == nullptr )
+#else
+	if( pthread_create( &m_processingThread, nullptr, &processingThread, this ) != 0 )
+#endif
+	{
+		debugMessage( "could not create processingThread\n" );
+		return false;
+	}
+	return true;
+}
+
+
+
+
+#ifndef SYNC_WITH_SHM_FIFO
+void RemoteVstPlugin::requestPlugin( const std::string & socketPath )
+{
+#ifndef NATIVE_LINUX_VST
+	PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::AttachPlugin),
+					(LPARAM) new std::string( socketPath ) );
+#else
+	pthread_mutex_lock( &__pendingClientsMutex );
+	__pendingClients.push( socketPath );
+	pthread_mutex_unlock( &__pendingClientsMutex );
+#endif
+}
+
+
+
+
+void RemoteVstPlugin::attachPlugin( const std::string & socketPath )
+{
+	// the constructor processes messages until the plugin is loaded, just
+	// like in a process that hosts a single plugin
+	auto plugin = new RemoteVstPlugin( socketPath.c_str() );
+	if( !plugin->isInitialized() || !plugin->startProcessing() )
+	{
+		delete plugin;
+		__plugin = __plugins.empty() ? nullptr : __plugins.back();
+		return;
+	}
+	__plugins.push_back( plugin );
+}
+#endif
+
+
+
+
+void RemoteVstPlugin::requestQuit()
+{
+#ifndef NATIVE_LINUX_VST
+	PostMessage( __MessageHwnd, WM_USER, static_cast<WPARAM>(GuiThreadMessage::CloseHost), 0 );
+#else
+	__hostQuit = true;
+#endif
+}
+
+
+
+
+void RemoteVstPlugin::closePlugin( RemoteVstPlugin * plugin )
+{
+	// deleted by the GUI event loop, since the plugin may be busy further
+	// up the stack, e.g. in a modal dialog
+	__plugins.erase( std::remove( __plugins.begin(), __plugins.end(), plugin ), __plugins.end() );
+	__closedPlugins.push_back( plugin );
+	if( __plugin == plugin )
+	{
+		__plugin = __plugins.empty() ? nullptr : __plugins.back();
+	}
+}
+
+
+
+
+void RemoteVstPlugin::deleteClosedPlugins()
+{
+	for( const auto plugin : __closedPlugins )
+	{
+		delete plugin;
+	}
+	__closedPlugins.clear();
+}
+
+
+
+
 bool RemoteVstPlugin::setupMessageWindow()
 {
 #ifndef NATIVE_LINUX_VST
 	HMODULE hInst = GetModuleHandle( nullptr );
 	if( hInst == nullptr )
 	{
-		__plugin->debugMessage( "setupMessageWindow(): can't get "
-							"module handle\n" );
+		std::cerr << "setupMessageWindow(): can't get module handle" << std::endl;
 		return false;
 	}
 
@@ -2289,6 +2520,7 @@ DWORD WINAPI RemoteVstPlugin::guiEventLoop()
 	{
 		TranslateMessage( &msg );
 		DispatchMessage( &msg );
+		deleteClosedPlugins();
 	}
 
 	return 0;
@@ -2303,33 +2535,68 @@ void RemoteVstPlugin::guiEventLoop()
 	XEvent e;
 	while(true)
 	{
-		//if (XQLength(m_display) > 0)
-		if (m_display && XPending(m_display) > 0)
+#ifndef SYNC_WITH_SHM_FIFO
+		pthread_mutex_lock( &__pendingClientsMutex );
+		auto pendingClients = std::queue<std::string>{};
+		std::swap( pendingClients, __pendingClients );
+		pthread_mutex_unlock( &__pendingClientsMutex );
+		for( ; !pendingClients.empty(); pendingClients.pop() )
 		{
-			XNextEvent(m_display, &e);
-		
-			if (e.type == ClientMessage && e.xclient.data.l[0] == m_wmDeleteMessage)
-			{
-				hideEditor();
-			}
+			attachPlugin( pendingClients.front() );
 		}
+#endif
 
-		// needed by ZynAddSubFX UI
-		if (__plugin->isInitialized())
+		// by index, as plugins may be closed meanwhile
+		for( std::size_t i = 0; i < __plugins.size(); ++i )
 		{
-			__plugin->idle();
-		}
-		
-		if(__plugin->isInitialized() && !__plugin->isProcessing() )
-		{
-			__plugin->processUIThreadMessages();
+			RemoteVstPlugin * plugin = __plugins[i];
+
+			//if (XQLength(m_display) > 0)
+			if (plugin->m_display && XPending(plugin->m_display) > 0)
+			{
+				XNextEvent(plugin->m_display, &e);
+
+				if (e.type == ClientMessage && e.xclient.data.l[0] == plugin->m_wmDeleteMessage)
+				{
+					plugin->hideEditor();
+				}
+			}
+
+			// needed by ZynAddSubFX UI
+			if (plugin->isInitialized())
+			{
+				plugin->idle();
+			}
+
+			if(plugin->isInitialized() && !plugin->isProcessing() )
+			{
+				plugin->processUIThreadMessages();
+			}
 		}
 		
 		nanosleep(&tim, &tim2);
 		
-		if (m_shouldQuit) 
+		for( std::size_t i = 0; i < __plugins.size(); )
+		{
+			RemoteVstPlugin * plugin = __plugins[i];
+			if( !plugin->m_shouldQuit )
+			{
+				++i;
+				continue;
+			}
+
+			plugin->hideEditor();
+			if( !SHARED )
+			{
+				return;
+			}
+			plugin->joinProcessingThread();
+			closePlugin( plugin );
+		}
+		deleteClosedPlugins();
+
+		if( __hostQuit && __plugins.empty() )
 		{
-			__plugin->hideEditor();
 			break;
 		}
 	}
@@ -2341,10 +2608,14 @@ void RemoteVstPlugin::guiEventLoop()
 LRESULT CALLBACK RemoteVstPlugin::wndProc( HWND hwnd, UINT uMsg,
 						WPARAM wParam, LPARAM lParam )
 {
-	if( uMsg == WM_TIMER && __plugin->isInitialized() )
+	if( uMsg == WM_TIMER && !__plugins.empty() )
 	{
-		// give plugin some idle-time for GUI-update
-		__plugin->idle();
+		// give plugins some idle-time for GUI-update, by index as
+		// they may be closed meanwhile
+		for( std::size_t i = 0; i < __plugins.size(); ++i )
+		{
+			__plugins[i]->idle();
+		}
 		return 0;
 	}
 	else if( uMsg == WM_USER )
@@ -2353,22 +2624,53 @@ LRESULT CALLBACK RemoteVstPlugin::wndProc( HWND hwnd, UINT uMsg,
 		{
 			case GuiThreadMessage::ProcessPluginMessage:
 			{
-				message * m = (message *) lParam;
-				__plugin->queueMessage( *m );
-				delete m;
-				if( !__plugin->isProcessing() )
+				auto pluginMessage = (PluginMessage *) lParam;
+				RemoteVstPlugin * plugin = pluginMessage->plugin;
+				plugin->queueMessage( pluginMessage->m );
+				delete pluginMessage;
+				if( !plugin->isProcessing() )
 				{
-					__plugin->processUIThreadMessages();
+					plugin->processUIThreadMessages();
 				}
 				return 0;
 			}
 
 			case GuiThreadMessage::GiveIdle:
-				__plugin->idle();
+				for( std::size_t i = 0; i < __plugins.size(); ++i )
+				{
+					__plugins[i]->idle();
+				}
 				return 0;
 
 			case GuiThreadMessage::ClosePlugin:
-				PostQuitMessage(0);
+				if( !SHARED )
+				{
+					PostQuitMessage(0);
+					return 0;
+				}
+				closePlugin( (RemoteVstPlugin *) lParam );
+				if( __hostQuit && __plugins.empty() )
+				{
+					PostQuitMessage(0);
+				}
+				return 0;
+
+#ifndef SYNC_WITH_SHM_FIFO
+			case GuiThreadMessage::AttachPlugin:
+			{
+				auto socketPath = (std::string *) lParam;
+				attachPlugin( *socketPath );
+				delete socketPath;
+				return 0;
+			}
+#endif
+
+			case GuiThreadMessage::CloseHost:
+				__hostQuit = true;
+				if( __plugins.empty() )
+				{
+					PostQuitMessage(0);
+				}
 				return 0;
 
 			default:
@@ -2377,7 +2679,13 @@ LRESULT CALLBACK RemoteVstPlugin::wndProc( HWND hwnd, UINT uMsg,
 	}
 	else if( uMsg == WM_SYSCOMMAND && (wParam & 0xfff0) == SC_CLOSE )
 	{
-		__plugin->hideEditor();
+		for( const auto plugin : __plugins )
+		{
+			if( plugin->m_window == hwnd )
+			{
+				plugin->hideEditor();
+			}
+		}
 		return 0;
 	}
 
@@ -2493,6 +2801,10 @@ int main( int _argc, char * * _argv )
 			std::cerr << "Unknown embed method " << embedMethod << ". Starting detached instead." << std::endl;
 			EMBED = EMBED_X11 = EMBED_WIN32 = HEADLESS = false;
 		}
+
+#ifndef SYNC_WITH_SHM_FIFO
+		SHARED = _argc > embedMethodIndex + 1 && std::string( _argv[embedMethodIndex + 1] ) == "shared";
+#endif
 	}
 
 #ifdef NATIVE_LINUX_VST
@@ -2502,6 +2814,43 @@ int main( int _argc, char * * _argv )
 	}
 #endif
 	
+#ifndef SYNC_WITH_SHM_FIFO
+	if( SHARED )
+	{
+#ifdef SIGPIPE
+		// the host may have closed the connection of a plugin that still
+		// writes to it, which mustn't end the other plugins
+		signal( SIGPIPE, SIG_IGN );
+#endif
+		if( RemoteVstPlugin::setupMessageWindow() == false )
+		{
+			return -1;
+		}
+
+		// the plugins are created by the GUI thread as the host asks for them
+		auto host = lmms::RemoteVstHost( _argv[1] );
+#ifndef NATIVE_LINUX_VST
+		if( CreateThread( nullptr, 0, lmms::RemoteVstHost::thread, &host, 0, nullptr ) == nullptr )
+#else
+		pthread_t hostThread;
+		if( pthread_create( &hostThread, nullptr, &lmms::RemoteVstHost::thread, &host ) != 0 )
+#endif
+		{
+			return -1;
+		}
+
+		RemoteVstPlugin::guiEventLoop();
+#ifdef NATIVE_LINUX_VST
+		pthread_join( hostThread, nullptr );
+#endif
+		RemoteVstPlugin::deleteClosedPlugins();
+#ifndef NATIVE_LINUX_VST
+		OleUninitialize();
+#endif
+		return 0;
+	}
+#endif
+
 	// constructor automatically will process messages until it receives
 	// a IdVstLoadPlugin message and processes it
 #ifdef SYNC_WITH_SHM_FIFO
@@ -2516,23 +2865,15 @@ int main( int _argc, char * * _argv )
 		{
 			return -1;
 		}
-#ifndef NATIVE_LINUX_VST
-		if( CreateThread( nullptr, 0, RemoteVstPlugin::processingThread,
-						__plugin, 0, nullptr ) == nullptr )
-#else
-		int err = 0;
-		err = pthread_create(&__processingThreadId, nullptr, &RemoteVstPlugin::processingThread, __plugin);
-		if (err != 0)
-#endif
+		if( !__plugin->startProcessing() )
 		{
-			__plugin->debugMessage( "could not create "
-							"processingThread\n" );
 			return -1;
 		}
+		__plugins.push_back( __plugin );
 
-		__plugin->guiEventLoop();
+		RemoteVstPlugin::guiEventLoop();
 #ifdef NATIVE_LINUX_VST
-		pthread_join(__processingThreadId, nullptr);
+		__plugin->joinProcessingThread();
 #endif
 	}
 
@@ -32,7 +32,12 @@
 #include <QDomElement>
 #include <QFileInfo>
 #include <QLocale>
+#include <QMutex>
 #include <QTemporaryFile>
+#include <QThread>
+#include <QUuid>
+#include <algorithm>
+#include <map>
 
 #ifdef LMMS_BUILD_LINUX
 #	include <QX11Info>
@@ -121,6 +126,38 @@ enum class ExecutableType
 	Unknown, Win32, Win64, Linux64,
 };
 
+
+#ifndef SYNC_WITH_SHM_FIFO
+namespace
+{
+
+//! The process hosting all plugins of @p executable with @p embedMethod, which
+//! is started for the first of them and quits after the last
+std::shared_ptr<RemotePlugin> sharedHost( const QString & executable, const QString & embedMethod )
+{
+	static std::map<QString, std::weak_ptr<RemotePlugin>> hosts;
+	static QMutex hostsMutex;
+
+	QMutexLocker locker( &hostsMutex );
+	auto & entry = hosts[executable + '\n' + embedMethod];
+	auto host = entry.lock();
+	if( !host || host->failed() || !host->isRunning() )
+	{
+		host = std::make_shared<RemotePlugin>();
+		host->init( executable, false, {embedMethod, "shared"} );
+		host->waitForHostInfoGotten();
+		if( host->failed() )
+		{
+			return nullptr;
+		}
+		entry = host;
+	}
+	return host;
+}
+
+} // namespace
+#endif
+
 VstPlugin::VstPlugin( const QString & _plugin ) :
 	m_plugin( PathUtil::toAbsolute(_plugin) ),
 	m_pluginWindowID( 0 ),
@@ -181,6 +218,10 @@ VstPlugin::VstPlugin( const QString & _plugin ) :
 	}
 
 	setTempo( Engine::getSong()->getTempo() );
+	if( !failed() )
+	{
+		createParameterChanges();
+	}
 
 	connect( Engine::getSong(), SIGNAL( tempoChanged( lmms::bpm_t ) ),
 			this, SLOT( setTempo( lmms::bpm_t ) ), Qt::DirectConnection );
@@ -206,7 +247,20 @@ VstPlugin::~VstPlugin()
 
 void VstPlugin::tryLoad( const QString &remoteVstPluginExecutable )
 {
-	init( remoteVstPluginExecutable, false, {m_embedMethod} );
+#ifndef SYNC_WITH_SHM_FIFO
+	// one process for the plugins saves the memory and scheduling of many,
+	// but takes all of them down if one crashes
+	const auto host = ConfigManager::inst()->value( "audioengine", "sharedvstprocess" ).toInt()
+		? sharedHost( remoteVstPluginExecutable, m_embedMethod ) : nullptr;
+	if( host )
+	{
+		attach( host, false );
+	}
+	else
+#endif
+	{
+		init( remoteVstPluginExecutable, false, {m_embedMethod} );
+	}
 
 	waitForHostInfoGotten();
 	if( failed() )
@@ -361,6 +415,7 @@ int VstPlugin::currentProgram()
 const QMap<QString, QString> & VstPlugin::parameterDump()
 {
 	lock();
+	flushParameterChanges();
 	sendMessage( IdVstGetParameterDump );
 	waitForMessage( IdVstParameterDump, true );
 	unlock();
@@ -373,20 +428,19 @@ const QMap<QString, QString> & VstPlugin::parameterDump()
 
 void VstPlugin::setParameterDump( const QMap<QString, QString> & _pdump )
 {
-	message m( IdVstSetParameterDump );
-	m.addInt( _pdump.size() );
+	std::string dump;
 	for (const auto& str : _pdump)
 	{
 		const VstParameterDumpItem item =
 		{
 			str.section(':', 0, 0).toInt(), "", LocaleHelper::toFloat(str.section(':', 2, -1))
 		};
-		m.addInt( item.index );
-		m.addString( item.shortLabel );
-		m.addFloat( item.value );
+		appendParameterDumpItem( dump, item );
 	}
 	lock();
-	sendMessage( m );
+	// the dump replaces whatever automation changed before
+	clearPendingParameterChanges();
+	sendMessage( message( IdVstSetParameterDump ).addString( dump ) );
 	unlock();
 }
 
@@ -473,19 +527,13 @@ bool VstPlugin::processMessage( const message & _m )
 		case IdVstParameterDump:
 		{
 			m_parameterDump.clear();
-			const int num_params = _m.getInt();
-			int p = 0;
-			for( int i = 0; i < num_params; ++i )
+			forEachParameterDumpItem( _m.getString( 0 ), [this]( const VstParameterDumpItem & item )
 			{
-				VstParameterDumpItem item;
-				item.index = _m.getInt( ++p );
-				item.shortLabel = _m.getString( ++p );
-				item.value = _m.getFloat( ++p );
-	m_parameterDump["param" + QString::number( item.index )] =
-				QString::number( item.index ) + ":" +
-/*uncomented*/				/*QString( item.shortLabel )*/ QString::fromStdString(item.shortLabel) + ":" +
+				m_parameterDump["param" + QString::number( item.index )] =
+					QString::number( item.index ) + ":" +
+					QString::fromStdString( item.shortLabel ) + ":" +
 					QString::number( item.value );
-			}
+			} );
 			break;
 		}
 		default:
@@ -614,17 +662,104 @@ void VstPlugin::savePreset()
 
 void VstPlugin::setParam( int i, float f )
 {
+	if( i < 0 )
+	{
+		return;
+	}
+
 	lock();
-	sendMessage( message( IdVstSetParameter ).addInt( i ).addFloat( f ) );
-	//waitForMessage( IdVstSetParameter, true );
+	if( i >= static_cast<int>( m_pendingParameterSlots.size() ) )
+	{
+		m_pendingParameterSlots.resize( i + 1, -1 );
+	}
+	const int slot = m_pendingParameterSlots[i];
+	if( slot >= 0 )
+	{
+		// a pending change mustn't overwrite this one later
+		m_pendingParameterChanges[slot].value = f;
+	}
+
+	// what the user turns on the GUI thread is sent right away
+	const bool queue = m_parameterChanges && QThread::currentThread() != thread();
+	if( queue && slot < 0 && m_pendingParameterChanges.size() < VstParameterChanges::Capacity )
+	{
+		m_pendingParameterSlots[i] = static_cast<int>( m_pendingParameterChanges.size() );
+		m_pendingParameterChanges.push_back( { i, f } );
+	}
+	else if( !queue || slot < 0 )
+	{
+		sendMessage( message( IdVstSetParameter ).addInt( i ).addFloat( f ) );
+	}
 	unlock();
 }
 
 
 
+void VstPlugin::prepareProcessing()
+{
+	if( m_pendingParameterChanges.empty() )
+	{
+		return;
+	}
+
+	VstParameterChanges & changes = *m_parameterChanges;
+	std::copy( m_pendingParameterChanges.begin(), m_pendingParameterChanges.end(), changes.changes );
+	changes.count = static_cast<int32_t>( m_pendingParameterChanges.size() );
+	++changes.serial;
+	clearPendingParameterChanges();
+}
+
+
+
+void VstPlugin::createParameterChanges()
+{
+	try
+	{
+		m_parameterChanges.create( QUuid::createUuid().toString().toStdString() );
+	}
+	catch( const std::runtime_error & error )
+	{
+		qWarning() << "Failed to allocate shared parameter changes:" << error.what();
+		m_parameterChanges.detach();
+		return;
+	}
+	*m_parameterChanges = VstParameterChanges{};
+	m_pendingParameterChanges.reserve( VstParameterChanges::Capacity );
+
+	lock();
+	sendMessage( message( IdVstParameterChangesKey ).addString( m_parameterChanges.key() ) );
+	unlock();
+}
+
+
+
+void VstPlugin::flushParameterChanges()
+{
+	for( const auto & change : m_pendingParameterChanges )
+	{
+		sendMessage( message( IdVstSetParameter ).addInt( change.index ).addFloat( change.value ) );
+	}
+	clearPendingParameterChanges();
+}
+
+
+
+void VstPlugin::clearPendingParameterChanges()
+{
+	for( const auto & change : m_pendingParameterChanges )
+	{
+		m_pendingParameterSlots[change.index] = -1;
+	}
+	m_pendingParameterChanges.clear();
+}
+
+
+
 void VstPlugin::idleUpdate()
 {
 	lock();
+	// a plugin that isn't processing, like a sleeping effect, still gets them
+	flushParameterChanges();
 	sendMessage( message( IdVstIdleUpdate ) );
 	unlock();
 }
@@ -30,9 +30,11 @@
 #include <QSize>
 #include <QString>
 #include <QTimer>
+#include <vector>
 
 #include "JournallingObject.h"
 #include "RemotePlugin.h"
+#include "communication.h"
 
 #include "vstbase_export.h"
 
@@ -142,10 +144,18 @@ public slots:
 
 	void handleClientEmbed();
 
+protected:
+	void prepareProcessing() override;
+
 private:
 	void loadChunk( const QByteArray & _chunk );
 	QByteArray saveChunk();
 
+	void createParameterChanges();
+	//! Sends the changes that didn't go with a period yet in messages
+	void flushParameterChanges();
+	void clearPendingParameterChanges();
+
 	void toggleEditorVisibility(int visible = -1);
 
 	QString m_plugin;
@@ -167,6 +177,14 @@ private:
 
 	QMap<QString, QString> m_parameterDump;
 
+	//! Automation changes parameters on the audio threads, often every period.
+	//! The latest value of each goes with the next period, rather than in a
+	//! message per change.
+	SharedMemory<VstParameterChanges> m_parameterChanges;
+	std::vector<VstParameterChanges::Change> m_pendingParameterChanges;
+	//! Where the change of each parameter is in the pending ones, -1 if none
+	std::vector<int> m_pendingParameterSlots;
+
 	int m_currentProgram;
 
 	QTimer m_idleTimer;
@@ -27,6 +27,10 @@
 #ifndef _COMMUNICATION_H
 #define _COMMUNICATION_H
 
+#include <cstdint>
+#include <cstring>
+#include <string>
+
 namespace lmms
 {
 
@@ -39,6 +43,68 @@ struct VstParameterDumpItem
 } ;
 
 
+// Parameter dumps are sent as a single string of the items one after the
+// other, the index, value and label length in binary followed by the label,
+// instead of three message arguments per parameter that are all converted
+// to and from text
+
+inline void appendParameterDumpItem( std::string & dump, const VstParameterDumpItem & item )
+{
+	const int32_t labelLength = static_cast<int32_t>( item.shortLabel.size() );
+	dump.append( reinterpret_cast<const char *>( &item.index ), sizeof( item.index ) );
+	dump.append( reinterpret_cast<const char *>( &item.value ), sizeof( item.value ) );
+	dump.append( reinterpret_cast<const char *>( &labelLength ), sizeof( labelLength ) );
+	dump.append( item.shortLabel );
+}
+
+
+template<typename F>
+void forEachParameterDumpItem( const std::string & dump, F && function )
+{
+	constexpr auto HeaderSize = sizeof( int32_t ) + sizeof( float ) + sizeof( int32_t );
+
+	std::size_t pos = 0;
+	while( pos + HeaderSize <= dump.size() )
+	{
+		VstParameterDumpItem item;
+		int32_t labelLength;
+		std::memcpy( &item.index, dump.data() + pos, sizeof( item.index ) );
+		std::memcpy( &item.value, dump.data() + pos + sizeof( item.index ), sizeof( item.value ) );
+		std::memcpy( &labelLength, dump.data() + pos + sizeof( item.index ) + sizeof( item.value ),
+				sizeof( labelLength ) );
+		pos += HeaderSize;
+		if( labelLength < 0 || pos + labelLength > dump.size() )
+		{
+			return;
+		}
+		item.shortLabel = dump.substr( pos, labelLength );
+		pos += labelLength;
+		function( item );
+	}
+}
+
+
+//! The parameter changes handed to RemoteVstPlugin along with a period, in
+//! shared memory. The host writes them only while the plugin isn't processing,
+//! right before handing it the next period, see VstPlugin::setParam().
+struct VstParameterChanges
+{
+	static constexpr int32_t Capacity = 1024;
+
+	struct Change
+	{
+		int32_t index;
+		float value;
+	};
+
+	//! Incremented whenever the host wrote new changes, the plugin applies
+	//! each of them once
+	uint32_t serial;
+	int32_t count;
+	Change changes[Capacity];
+} ;
+
+
 
 enum class VstHostLanguage
 {
@@ -71,6 +137,7 @@ enum VstRemoteMessageIDs
 	IdVstIdleUpdate,
 	IdVstParameterDisplays,
 	IdVstParameterLabels,
+	IdVstParameterChangesKey,
 
 	// remoteVstPlugin -> vstPlugin
 	IdVstFailedLoadingPlugin,
@@ -62,6 +62,7 @@ VstEffect::VstEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &vsteffect_plugin_descriptor, _parent, _key ),
 	m_pluginMutex(),
+	m_latency( 0 ),
 	m_key( *_key ),
 	m_vstControls( this )
 {
@@ -95,8 +96,17 @@ bool VstEffect::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames )
 		if (m_pluginMutex.tryLock(Engine::getSong()->isExporting() ? -1 : 0))
 		{
 			m_plugin->process( buf, buf );
+			m_latency = m_plugin->latency();
 			m_pluginMutex.unlock();
 		}
+		if( m_dryDelay.delay() != m_latency )
+		{
+			m_dryDelay.setDelay( m_latency );
+		}
+		if( m_dryDelay.delay() > 0 )
+		{
+			m_dryDelay.process( _buf, _frames, true );
+		}
 
 		double out_sum = 0.0;
 		const float w = wetLevel();
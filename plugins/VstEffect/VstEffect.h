@@ -25,9 +25,11 @@
 #ifndef _VST_EFFECT_H
 #define _VST_EFFECT_H
 
+#include <atomic>
 #include <QMutex>
 #include <QSharedPointer>
 
+#include "CompensationDelay.h"
 #include "Effect.h"
 #include "VstEffectControls.h"
 
@@ -53,6 +55,11 @@ public:
 		return &m_vstControls;
 	}
 
+	f_cnt_t latency() const override
+	{
+		return m_latency;
+	}
+
 
 private:
 	void openPlugin( const QString & _plugin );
@@ -60,6 +67,10 @@ private:
 
 	QSharedPointer<VstPlugin> m_plugin;
 	QMutex m_pluginMutex;
+	// of m_plugin as of the last period it processed, by which the dry
+	// signal has to be delayed as well
+	std::atomic<f_cnt_t> m_latency;
+	CompensationDelay m_dryDelay;
 	EffectKey m_key;
 
 	VstEffectControls m_vstControls;
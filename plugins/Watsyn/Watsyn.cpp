@@ -111,6 +111,46 @@ void WatsynObject::renderOutput( fpp_t _frames )
 	if( m_bbuf == nullptr )
 		m_bbuf = new sampleFrame[m_fpp];
 
+	// pick the loop made for the modulation of both series, so it doesn't
+	// have to look at them for every frame
+	switch( m_amod )
+	{
+		case MOD_MIX: renderOutput<MOD_MIX>( _frames ); break;
+		case MOD_AM: renderOutput<MOD_AM>( _frames ); break;
+		case MOD_RM: renderOutput<MOD_RM>( _frames ); break;
+		case MOD_PM: renderOutput<MOD_PM>( _frames ); break;
+	}
+}
+
+
+
+template<int AMOD>
+void WatsynObject::renderOutput( fpp_t _frames )
+{
+	switch( m_bmod )
+	{
+		case MOD_MIX: renderOutput<AMOD, MOD_MIX>( _frames ); break;
+		case MOD_AM: renderOutput<AMOD, MOD_AM>( _frames ); break;
+		case MOD_RM: renderOutput<AMOD, MOD_RM>( _frames ); break;
+		case MOD_PM: renderOutput<AMOD, MOD_PM>( _frames ); break;
+	}
+}
+
+
+
+template<int AMOD, int BMOD>
+void WatsynObject::renderOutput( fpp_t _frames )
+{
+	// the frequency and the crosstalk only change between periods
+	float lphaseInc [NUM_OSCS];
+	float rphaseInc [NUM_OSCS];
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		lphaseInc[i] = static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_lfreq[i] ) );
+		rphaseInc[i] = static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_rfreq[i] ) );
+	}
+	const float xt = m_parent->m_xtalk.value();
+
 	for( fpp_t frame = 0; frame < _frames; frame++ )
 	{
 		// put phases of 1-series oscs into variables because phase modulation might happen
@@ -130,7 +170,7 @@ void WatsynObject::renderOutput( fpp_t _frames )
 							fraction( m_rphase[A2_OSC] ) ) * m_parent->m_rvol[A2_OSC];
 
 		// if phase mod, add to phases
-		if( m_amod == MOD_PM )
+		if constexpr( AMOD == MOD_PM )
 		{
 			A1_lphase = fmodf( A1_lphase + A2_L * PMOD_AMT, WAVELEN );
 			if( A1_lphase < 0 ) A1_lphase += WAVELEN;
@@ -156,7 +196,6 @@ void WatsynObject::renderOutput( fpp_t _frames )
 							fraction( m_rphase[B2_OSC] ) ) * m_parent->m_rvol[B2_OSC];
 
 		// if crosstalk active, add a1
-		const float xt = m_parent->m_xtalk.value();
 		if( xt > 0.0 )
 		{
 			B2_L += ( A1_L * xt ) * 0.01f;
@@ -164,7 +203,7 @@ void WatsynObject::renderOutput( fpp_t _frames )
 		}
 
 		// if phase mod, add to phases
-		if( m_bmod == MOD_PM )
+		if constexpr( BMOD == MOD_PM )
 		{
 			B1_lphase = fmodf( B1_lphase + B2_L * PMOD_AMT, WAVELEN );
 			if( B1_lphase < 0 ) B1_lphase += WAVELEN;
@@ -181,39 +220,39 @@ void WatsynObject::renderOutput( fpp_t _frames )
 
 
 		// A-series modulation)
-		switch( m_amod )
+		if constexpr( AMOD == MOD_MIX )
+		{
+			A1_L = ( A1_L + A2_L ) / 2.0;
+			A1_R = ( A1_R + A2_R ) / 2.0;
+		}
+		else if constexpr( AMOD == MOD_AM )
 		{
-			case MOD_MIX:
-				A1_L = ( A1_L + A2_L ) / 2.0;
-				A1_R = ( A1_R + A2_R ) / 2.0;
-				break;
-			case MOD_AM:
-				A1_L *= qMax( 0.0f, A2_L + 1.0f );
-				A1_R *= qMax( 0.0f, A2_R + 1.0f );
-				break;
-			case MOD_RM:
-				A1_L *= A2_L;
-				A1_R *= A2_R;
-				break;
+			A1_L *= qMax( 0.0f, A2_L + 1.0f );
+			A1_R *= qMax( 0.0f, A2_R + 1.0f );
+		}
+		else if constexpr( AMOD == MOD_RM )
+		{
+			A1_L *= A2_L;
+			A1_R *= A2_R;
 		}
 		m_abuf[frame][0] = A1_L;
 		m_abuf[frame][1] = A1_R;
 
 		// B-series modulation (other than phase mod)
-		switch( m_bmod )
+		if constexpr( BMOD == MOD_MIX )
+		{
+			B1_L = ( B1_L + B2_L ) / 2.0;
+			B1_R = ( B1_R + B2_R ) / 2.0;
+		}
+		else if constexpr( BMOD == MOD_AM )
+		{
+			B1_L *= qMax( 0.0f, B2_L + 1.0f );
+			B1_R *= qMax( 0.0f, B2_R + 1.0f );
+		}
+		else if constexpr( BMOD == MOD_RM )
 		{
-			case MOD_MIX:
-				B1_L = ( B1_L + B2_L ) / 2.0;
-				B1_R = ( B1_R + B2_R ) / 2.0;
-				break;
-			case MOD_AM:
-				B1_L *= qMax( 0.0f, B2_L + 1.0f );
-				B1_R *= qMax( 0.0f, B2_R + 1.0f );
-				break;
-			case MOD_RM:
-				B1_L *= B2_L;
-				B1_R *= B2_R;
-				break;
+			B1_L *= B2_L;
+			B1_R *= B2_R;
 		}
 		m_bbuf[frame][0] = B1_L;
 		m_bbuf[frame][1] = B1_R;
@@ -221,9 +260,9 @@ void WatsynObject::renderOutput( fpp_t _frames )
 		// update phases
 		for( int i = 0; i < NUM_OSCS; i++ )
 		{
-			m_lphase[i] += ( static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_lfreq[i] ) ) );
+			m_lphase[i] += lphaseInc[i];
 			m_lphase[i] = fmodf( m_lphase[i], WAVELEN );
-			m_rphase[i] += ( static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_rfreq[i] ) ) );
+			m_rphase[i] += rphaseInc[i];
 			m_rphase[i] = fmodf( m_rphase[i], WAVELEN );
 		}
 	}
@@ -112,6 +112,11 @@ public:
 	}
 
 private:
+	template<int AMOD>
+	void renderOutput( fpp_t _frames );
+	template<int AMOD, int BMOD>
+	void renderOutput( fpp_t _frames );
+
 	int m_amod;
 	int m_bmod;
 
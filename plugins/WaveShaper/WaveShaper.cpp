@@ -25,9 +25,10 @@
 
 
 #include "WaveShaper.h"
+#include "AudioEngine.h"
+#include "Engine.h"
 #include "lmms_math.h"
 #include "embed.h"
-#include "interpolation.h"
 
 #include "plugin_export.h"
 
@@ -59,7 +60,9 @@ Plugin::Descriptor PLUGIN_EXPORT waveshaper_plugin_descriptor =
 WaveShaperEffect::WaveShaperEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &waveshaper_plugin_descriptor, _parent, _key ),
-	m_wsControls( this )
+	m_wsControls( this ),
+	m_oversampler( Engine::audioEngine()->framesPerPeriod() ),
+	m_wet( Engine::audioEngine()->framesPerPeriod() )
 {
 }
 
@@ -75,14 +78,12 @@ bool WaveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 	}
 
 // variables for effect
-	int i = 0;
-
 	double out_sum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
 	float input = m_wsControls.m_inputModel.value();
 	float output = m_wsControls.m_outputModel.value();
-	const float * samples = m_wsControls.m_wavegraphModel.samples();
+	m_curve.update( m_wsControls.m_wavegraphModel.samples(), CurveTable<200>::Beyond::Proportional );
 	const bool clip = m_wsControls.m_clipModel.value();
 
 	ValueBuffer *inputBuffer = m_wsControls.m_inputModel.valueBuffer();
@@ -94,9 +95,14 @@ bool WaveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 	const float *inputPtr = inputBuffer ? &( inputBuffer->values()[ 0 ] ) : &input;
 	const float *outputPtr = outputBufer ? &( outputBufer->values()[ 0 ] ) : &output;
 
-	for( fpp_t f = 0; f < _frames; ++f )
+	m_oversampler.setStages( Engine::audioEngine()->qualityGovernor().oversamplingStages(
+		m_wsControls.m_oversamplingModel.value() ) );
+	const int factor = m_oversampler.factor();
+	sampleFrame * shaped = m_oversampler.upsample( _buf, _frames );
+
+	for( f_cnt_t f = 0; f < _frames * factor; ++f )
 	{
-		auto s = std::array{_buf[f][0], _buf[f][1]};
+		auto& s = shaped[f];
 
 // apply input gain
 		s[0] *= *inputPtr;
@@ -111,39 +117,30 @@ bool WaveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 
 // start effect
 
-		for( i=0; i <= 1; ++i )
-		{
-			const int lookup = static_cast<int>( qAbs( s[i] ) * 200.0f );
-			const float frac = fraction( qAbs( s[i] ) * 200.0f );
-			const float posneg = s[i] < 0 ? -1.0f : 1.0f;
-
-			if( lookup < 1 )
-			{
-				s[i] = frac * samples[0] * posneg;
-			}
-			else if( lookup < 200 )
-			{
-				s[i] = linearInterpolate( samples[ lookup - 1 ],
-						samples[ lookup ], frac )
-						* posneg;
-			}
-			else
-			{
-				s[i] *= samples[199];
-			}
-		}
+		// the graph is mirrored for negative samples
+		s[0] = std::copysign( m_curve( std::abs( s[0] ) ), s[0] );
+		s[1] = std::copysign( m_curve( std::abs( s[1] ) ), s[1] );
 
 // apply output gain
 		s[0] *= *outputPtr;
 		s[1] *= *outputPtr;
 
+// the gains change once per frame at the processing rate
+		if( ( f + 1 ) % factor == 0 )
+		{
+			outputPtr += outputInc;
+			inputPtr += inputInc;
+		}
+	}
+
+	m_oversampler.downsample( m_wet.data(), _frames );
+
 // mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
+	for( fpp_t f = 0; f < _frames; ++f )
+	{
+		_buf[f][0] = d * _buf[f][0] + w * m_wet[f][0];
+		_buf[f][1] = d * _buf[f][1] + w * m_wet[f][1];
 		out_sum += _buf[f][0] * _buf[f][0] + _buf[f][1] * _buf[f][1];
-
-		outputPtr += outputInc;
-		inputPtr += inputInc;
 	}
 
 	checkGate( out_sum / _frames );
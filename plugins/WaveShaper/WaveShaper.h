@@ -27,7 +27,11 @@
 #ifndef _WAVESHAPER_H
 #define _WAVESHAPER_H
 
+#include <vector>
+
+#include "CurveTable.h"
 #include "Effect.h"
+#include "Oversampler.h"
 #include "WaveShaperControls.h"
 
 namespace lmms
@@ -52,6 +56,11 @@ public:
 private:
 
 	WaveShaperControls m_wsControls;
+	Oversampler m_oversampler;
+	//! The shaped signal, back at the processing rate
+	std::vector<sampleFrame> m_wet;
+	//! The wave graph, updated every period
+	CurveTable<200> m_curve;
 
 	friend class WaveShaperControls;
 
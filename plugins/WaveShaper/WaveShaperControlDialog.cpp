@@ -27,7 +27,9 @@
 
 #include "WaveShaperControlDialog.h"
 #include "WaveShaperControls.h"
+#include "ComboBox.h"
 #include "embed.h"
+#include "gui_templates.h"
 #include "Graph.h"
 #include "Knob.h"
 #include "PixmapButton.h"
@@ -108,6 +110,12 @@ WaveShaperControlDialog::WaveShaperControlDialog(
 	clipInputToggle -> setModel( &_controls -> m_clipModel );
 	clipInputToggle->setToolTip(tr("Clip input signal to 0 dB"));
 
+	auto oversamplingComboBox = new ComboBox(this);
+	oversamplingComboBox->setGeometry(178, 224, 40, ComboBox::DEFAULT_HEIGHT);
+	oversamplingComboBox->setFont(pointSize<8>(oversamplingComboBox->font()));
+	oversamplingComboBox->setModel(&_controls->m_oversamplingModel);
+	oversamplingComboBox->setToolTip(tr("Oversample the shaping, so less of what it adds above half the sample rate folds back"));
+
 	connect( resetButton, SIGNAL (clicked () ),
 			_controls, SLOT ( resetClicked() ) );
 	connect( smoothButton, SIGNAL (clicked () ),
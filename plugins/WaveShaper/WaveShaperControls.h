@@ -26,6 +26,7 @@
 #ifndef WAVESHAPER_CONTROLS_H
 #define WAVESHAPER_CONTROLS_H
 
+#include "ComboBoxModel.h"
 #include "EffectControls.h"
 #include "WaveShaperControlDialog.h"
 #include "Graph.h"
@@ -79,6 +80,8 @@ private:
 	FloatModel m_outputModel;
 	graphModel m_wavegraphModel;
 	BoolModel  m_clipModel;
+	//! 2 to the power of it is the factor the shaping is oversampled by
+	ComboBoxModel m_oversamplingModel;
 
 	friend class gui::WaveShaperControlDialog;
 	friend class WaveShaperEffect;
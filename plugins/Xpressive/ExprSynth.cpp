@@ -28,6 +28,8 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <deque>
+#include <initializer_list>
 #include <random>
 
 
@@ -519,13 +521,36 @@ struct harmonic_semitone
 };
 static freefunc1<float,harmonic_semitone,true> harmonic_semitone_func;
 
+size_t find_occurances(const std::string& haystack, const char* const needle)
+{
+	size_t last_pos = 0;
+	size_t count = 0;
+	const size_t len = strlen(needle);
+	if (len > 0)
+	{
+		while (last_pos + len <= haystack.length())
+		{
+			last_pos = haystack.find(needle, last_pos);
+			if (last_pos == std::string::npos)
+				break;
+			++count;
+			last_pos += len;
+		}
+	}
+	return count;
+}
+
 
 ExprFront::ExprFront(const char * expr, int last_func_samples)
 {
 	m_valid = false;
+	m_timeVarying = true;
+	m_usesFrequency = true;
+	m_usesLast = true;
 	try
 	{
-		m_data = new ExprFrontData(last_func_samples);
+		// the history of "last" is only needed if the expression reads it
+		m_data = new ExprFrontData(find_occurances(expr, "last") > 0 ? last_func_samples : 1);
 
 		m_data->m_expression_string = expr;
 		m_data->m_symbol_table.add_pi();
@@ -577,8 +602,27 @@ bool ExprFront::compile()
 		sstore.disable_all_assignment_ops();
 		sstore.disable_all_control_structures();
 		parser_t parser(sstore);
+		parser.dec().collect_variables() = true;
+		parser.dec().collect_functions() = true;
 
 		m_valid=parser.compile(m_data->m_expression_string, m_data->m_expression);
+
+		// what the value depends on, so the synth can skip what's not needed
+		std::deque<parser_t::dependent_entity_collector::symbol_t> symbols;
+		parser.dec().symbols(symbols);
+		auto uses = [&symbols](std::initializer_list<const char*> names) {
+			for (const auto& symbol : symbols)
+			{
+				for (const auto name : names)
+				{
+					if (exprtk::details::imatch(symbol.first, name)) { return true; }
+				}
+			}
+			return false;
+		};
+		m_timeVarying = uses({"t", "trel", "rel", "integrate", "last", "rand"});
+		m_usesFrequency = uses({"f"});
+		m_usesLast = uses({"last"});
 	}
 	catch(...)
 	{
@@ -592,7 +636,7 @@ float ExprFront::evaluate()
 	{
 		if (!m_valid) return 0;
 		float res = m_data->m_expression.value();
-		m_data->m_last_func.setLastSample(res);
+		if (m_usesLast) { m_data->m_last_func.setLastSample(res); }
 		return res;
 	}
 	catch(...)
@@ -651,25 +695,6 @@ bool ExprFront::add_cyclic_vector(const char* name, const float* data, size_t le
 	}
 	return false;
 }
-size_t find_occurances(const std::string& haystack, const char* const needle)
-{
-	size_t last_pos = 0;
-	size_t count = 0;
-	const size_t len = strlen(needle);
-	if (len > 0)
-	{
-		while (last_pos + len <= haystack.length())
-		{
-			last_pos = haystack.find(needle, last_pos);
-			if (last_pos == std::string::npos)
-				break;
-			++count;
-			last_pos += len;
-		}
-	}
-	return count;
-}
-
 void ExprFront::setIntegrate(const unsigned int* const frameCounter, const unsigned int sample_rate)
 {
 	if (m_data->m_integ_func == nullptr)
@@ -760,26 +785,34 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 
 		expression_t *o1_rawExpr = &(m_exprO1->getData()->m_expression);
 		expression_t *o2_rawExpr = &(m_exprO2->getData()->m_expression);
-		LastSampleFunction<float> * last_func1 = &m_exprO1->getData()->m_last_func;
-		LastSampleFunction<float> * last_func2 = &m_exprO2->getData()->m_last_func;
+		LastSampleFunction<float> * last_func1 = m_exprO1->usesLast() ? &m_exprO1->getData()->m_last_func : nullptr;
+		LastSampleFunction<float> * last_func2 = m_exprO2->usesLast() ? &m_exprO2->getData()->m_last_func : nullptr;
+		// an output that stays the same for the whole period is evaluated once
+		bool o1_constant = !m_exprO1->isTimeVarying() && (freq_inc == 0 || !m_exprO1->usesFrequency());
+		bool o2_constant = !m_exprO2->isTimeVarying() && (freq_inc == 0 || !m_exprO2->usesFrequency());
 		if (is_released && m_note_rel_sample == 0)
 		{
 			m_note_rel_sample = m_note_sample;
 		}
 		if (o1_valid && o2_valid)
 		{
+			const float l1 = -pn1 + 0.5f, r1 = pn1 + 0.5f;
+			const float l2 = -pn2 + 0.5f, r2 = pn2 + 0.5f;
+			if (o1_constant) { o1 = o1_rawExpr->value(); }
+			if (o2_constant) { o2 = o2_rawExpr->value(); }
 			for (fpp_t frame = 0; frame < frames ; ++frame)
 			{
 				if (is_released && m_released < 1)
 				{
 					m_released = fmin(m_released+m_rel_inc, 1);
 				}
-				o1 = o1_rawExpr->value();
-				o2 = o2_rawExpr->value();
-				last_func1->setLastSample(o1);//put result in the circular buffer for the "last" function.
-				last_func2->setLastSample(o2);
-				buf[frame][0] = (-pn1 + 0.5) * o1 + (-pn2 + 0.5) * o2;
-				buf[frame][1] = ( pn1 + 0.5) * o1 + ( pn2 + 0.5) * o2;
+				if (!o1_constant) { o1 = o1_rawExpr->value(); }
+				if (!o2_constant) { o2 = o2_rawExpr->value(); }
+				//put result in the circular buffer for the "last" function.
+				if (last_func1) { last_func1->setLastSample(o1); }
+				if (last_func2) { last_func2->setLastSample(o2); }
+				buf[frame][0] = l1 * o1 + l2 * o2;
+				buf[frame][1] = r1 * o1 + r2 * o2;
 				m_note_sample++;
 				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
 				if (is_released)
@@ -797,17 +830,20 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 				o1_rawExpr = o2_rawExpr;
 				last_func1 = last_func2;
 				pn1 = pn2;
+				o1_constant = o2_constant;
 			}
+			const float l1 = -pn1 + 0.5f, r1 = pn1 + 0.5f;
+			if (o1_constant) { o1 = o1_rawExpr->value(); }
 			for (fpp_t frame = 0; frame < frames ; ++frame)
 			{
 				if (is_released && m_released < 1)
 				{
 					m_released = fmin(m_released+m_rel_inc, 1);
 				}
-				o1 = o1_rawExpr->value();
-				last_func1->setLastSample(o1);
-				buf[frame][0] = (-pn1 + 0.5) * o1;
-				buf[frame][1] = ( pn1 + 0.5) * o1;
+				if (!o1_constant) { o1 = o1_rawExpr->value(); }
+				if (last_func1) { last_func1->setLastSample(o1); }
+				buf[frame][0] = l1 * o1;
+				buf[frame][1] = r1 * o1;
 				m_note_sample++;
 				m_note_sample_sec = m_note_sample / (float)m_sample_rate;
 				if (is_released)
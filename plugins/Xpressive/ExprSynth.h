@@ -56,6 +56,11 @@ public:
 	~ExprFront();
 	bool compile();
 	inline bool isValid() { return m_valid; }
+	//! Whether the value may change from one sample to the next with the frequency
+	//! and the controls held, known after compile()
+	inline bool isTimeVarying() { return m_timeVarying; }
+	inline bool usesFrequency() { return m_usesFrequency; }
+	inline bool usesLast() { return m_usesLast; }
 	float evaluate();
 	bool add_variable(const char* name, float & ref);
 	bool add_constant(const char* name, float  ref);
@@ -65,6 +70,9 @@ public:
 private:
 	ExprFrontData *m_data;
 	bool m_valid;
+	bool m_timeVarying;
+	bool m_usesFrequency;
+	bool m_usesLast;
 	
 	static const int max_float_integer_mask=(1<<(std::numeric_limits<float>::digits))-1;
 
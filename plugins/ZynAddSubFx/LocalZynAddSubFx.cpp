@@ -24,7 +24,10 @@
 
 #include "LocalZynAddSubFx.h"
 
+#include <algorithm>
 #include <ctime>
+#include <mutex>
+#include <vector>
 
 #include "lmmsconfig.h"
 
@@ -41,6 +44,7 @@
 #include "zynaddsubfx/src/Misc/Master.h"
 #include "zynaddsubfx/src/Misc/Part.h"
 #include "zynaddsubfx/src/Misc/Util.h"
+#include "zynaddsubfx/src/Misc/XMLwrapper.h"
 
 // Global variable in zynaddsubfx/src/globals.h
 SYNTH_T* synth = nullptr;
@@ -50,7 +54,72 @@ namespace lmms
 {
 
 
+namespace
+{
+
+//! Loads the instrument of @p part from what a whole Master or a single part saved
+void loadInstrument( Part & part, const char * file )
+{
+	XMLwrapper xml;
+	if( xml.loadXMLfile( file ) < 0 )
+	{
+		return;
+	}
+	// a whole Master has it in its first part
+	if( xml.enterbranch( "MASTER" ) && !xml.enterbranch( "PART", 0 ) )
+	{
+		return;
+	}
+	if( !xml.enterbranch( "INSTRUMENT" ) )
+	{
+		return;
+	}
+	part.defaultsinstrument();
+	part.getfromXMLinstrument( &xml );
+}
+
+} // namespace
+
+
+
+
+struct LocalZynAddSubFx::SharedMaster
+{
+	SharedMaster() :
+		master( new Master() ),
+		samplerate( synth->samplerate ),
+		buffersize( synth->buffersize ),
+		outputl( synth->buffersize ),
+		outputr( synth->buffersize )
+	{
+		master->swaplr = false;
+	}
+
+	~SharedMaster()
+	{
+		delete master;
+	}
+
+	NulEngine ioEngine;
+	Master * master;
+	//! Held by the instances for everything they do with master
+	std::mutex mutex;
+	std::array<bool, NUM_MIDI_PARTS> partsInUse = {};
+	//! Counts the periods rendered, the first instance to play in a period renders it
+	unsigned renderedPeriod = 0;
+	// what master was made for, a new one is needed for anything else
+	unsigned int samplerate;
+	int buffersize;
+	// the mixed output, which no instance plays
+	std::vector<float> outputl;
+	std::vector<float> outputr;
+};
+
+
+
+
 int LocalZynAddSubFx::s_instanceCount = 0;
+std::weak_ptr<LocalZynAddSubFx::SharedMaster> LocalZynAddSubFx::s_sharedMaster;
 
 
 LocalZynAddSubFx::LocalZynAddSubFx() :
@@ -87,8 +156,18 @@ LocalZynAddSubFx::LocalZynAddSubFx() :
 
 LocalZynAddSubFx::~LocalZynAddSubFx()
 {
-	delete m_master;
-	delete m_ioEngine;
+	if( m_shared )
+	{
+		const auto lock = std::lock_guard{m_shared->mutex};
+		m_master->partonoff( m_part, 0 );
+		m_shared->partsInUse[m_part] = false;
+	}
+	else
+	{
+		delete m_master;
+		delete m_ioEngine;
+	}
+	m_shared.reset();
 
 	if( --s_instanceCount == 0 )
 	{
@@ -109,6 +188,46 @@ void LocalZynAddSubFx::initConfig()
 
 
 
+void LocalZynAddSubFx::shareMaster()
+{
+	if( m_shared )
+	{
+		return;
+	}
+
+	auto shared = s_sharedMaster.lock();
+	if( !shared || shared->samplerate != synth->samplerate || shared->buffersize != synth->buffersize
+		|| std::find( shared->partsInUse.begin(), shared->partsInUse.end(), false ) == shared->partsInUse.end() )
+	{
+		// whoever plays the old one keeps it until they're done
+		shared = std::make_shared<SharedMaster>();
+		s_sharedMaster = shared;
+	}
+
+	{
+		const auto lock = std::lock_guard{shared->mutex};
+		m_part = static_cast<int>( std::find( shared->partsInUse.begin(), shared->partsInUse.end(), false )
+			- shared->partsInUse.begin() );
+		shared->partsInUse[m_part] = true;
+		m_playedPeriod = shared->renderedPeriod;
+
+		Part * part = shared->master->part[m_part];
+		part->defaultsinstrument();
+		part->Prcvchn = m_part;
+		shared->master->partonoff( m_part, 1 );
+	}
+
+	delete m_master;
+	delete m_ioEngine;
+	m_ioEngine = nullptr;
+	m_master = shared->master;
+	m_shared = std::move( shared );
+	m_runningNotes = {};
+}
+
+
+
+
 void LocalZynAddSubFx::setSampleRate( int sampleRate )
 {
 	synth->samplerate = sampleRate;
@@ -130,7 +249,15 @@ void LocalZynAddSubFx::setBufferSize( int bufferSize )
 void LocalZynAddSubFx::saveXML( const std::string & _filename )
 {
 	char * name = strdup( _filename.c_str() );
-	m_master->saveXML( name );
+	if( m_shared )
+	{
+		const auto lock = std::lock_guard{m_shared->mutex};
+		m_master->part[m_part]->saveXML( name );
+	}
+	else
+	{
+		m_master->saveXML( name );
+	}
 	free( name );
 }
 
@@ -141,13 +268,26 @@ void LocalZynAddSubFx::loadXML( const std::string & _filename )
 {
 	char * f = strdup( _filename.c_str() );
 
+	if( m_shared )
 	{
-		const auto lock = std::lock_guard{m_master->mutex};
-		m_master->defaults();
-		m_master->loadXML( f );
+		const auto lock = std::lock_guard{m_shared->mutex};
+		loadInstrument( *m_master->part[m_part], f );
+		m_master->part[m_part]->applyparameters();
 	}
+	else
+	{
+		{
+			const auto lock = std::lock_guard{m_master->mutex};
+			m_master->defaults();
+			if( m_master->loadXML( f ) < 0 )
+			{
+				// saved by a shared instance
+				loadInstrument( *m_master->part[0], f );
+			}
+		}
 
-	m_master->applyparameters();
+		m_master->applyparameters();
+	}
 
 #ifdef LMMS_BUILD_WIN32
 	_wunlink(toWString(_filename).c_str());
@@ -165,13 +305,23 @@ void LocalZynAddSubFx::loadPreset( const std::string & _filename, int _part )
 {
 	char * f = strdup( _filename.c_str() );
 
+	if( m_shared )
 	{
-		const auto lock = std::lock_guard{m_master->mutex};
-		m_master->part[_part]->defaultsinstrument();
-		m_master->part[_part]->loadXMLinstrument( f );
+		const auto lock = std::lock_guard{m_shared->mutex};
+		m_master->part[m_part]->defaultsinstrument();
+		m_master->part[m_part]->loadXMLinstrument( f );
+		m_master->part[m_part]->applyparameters();
 	}
+	else
+	{
+		{
+			const auto lock = std::lock_guard{m_master->mutex};
+			m_master->part[_part]->defaultsinstrument();
+			m_master->part[_part]->loadXMLinstrument( f );
+		}
 
-	m_master->applyparameters();
+		m_master->applyparameters();
+	}
 
 	free( f );
 }
@@ -214,6 +364,13 @@ void LocalZynAddSubFx::setLmmsWorkingDir( const std::string & _dir )
 
 void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 {
+	if( m_shared )
+	{
+		const auto lock = std::lock_guard{m_shared->mutex};
+		m_master->part[m_part]->ctl.setpitchwheelbendrange( semitones * 100 );
+		return;
+	}
+
 	for (const auto& part : m_master->part)
 	{
 		part->ctl.setpitchwheelbendrange(semitones * 100);
@@ -224,6 +381,14 @@ void LocalZynAddSubFx::setPitchWheelBendRange( int semitones )
 
 void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 {
+	auto lock = std::unique_lock<std::mutex>{};
+	if( m_shared )
+	{
+		lock = std::unique_lock{m_shared->mutex};
+	}
+	// a shared Master's parts listen to the channel of their number
+	const int channel = m_shared ? m_part : event.channel();
+
 	switch( event.type() )
 	{
 		case MidiNoteOn:
@@ -235,10 +400,10 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 				}
 				if( m_runningNotes[event.key()] > 0 )
 				{
-					m_master->noteOff( event.channel(), event.key() );
+					m_master->noteOff( channel, event.key() );
 				}
 				++m_runningNotes[event.key()];
-				m_master->noteOn( event.channel(), event.key(), event.velocity() );
+				m_master->noteOn( channel, event.key(), event.velocity() );
 				break;
 			}
 		case MidiNoteOff:
@@ -248,14 +413,14 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 			}
 			if( --m_runningNotes[event.key()] <= 0 )
 			{
-				m_master->noteOff( event.channel(), event.key() );
+				m_master->noteOff( channel, event.key() );
 			}
 			break;
 		case MidiPitchBend:
-			m_master->setController( event.channel(), C_pitchwheel, event.pitchBend()-8192 );
+			m_master->setController( channel, C_pitchwheel, event.pitchBend()-8192 );
 			break;
 		case MidiControlChange:
-			m_master->setController( event.channel(), event.controllerNumber(), event.controllerValue() );
+			m_master->setController( channel, event.controllerNumber(), event.controllerValue() );
 			break;
 		default:
 			break;
@@ -267,6 +432,27 @@ void LocalZynAddSubFx::processMidiEvent( const MidiEvent& event )
 
 void LocalZynAddSubFx::processAudio( sampleFrame * _out )
 {
+	if( m_shared )
+	{
+		const auto lock = std::lock_guard{m_shared->mutex};
+		if( m_playedPeriod == m_shared->renderedPeriod )
+		{
+			m_master->GetAudioOutSamples( m_shared->buffersize, m_shared->samplerate,
+				m_shared->outputl.data(), m_shared->outputr.data() );
+			++m_shared->renderedPeriod;
+		}
+		m_playedPeriod = m_shared->renderedPeriod;
+
+		// left there by the Master, after insertion effects, volume and panning
+		const Part * part = m_master->part[m_part];
+		for( int f = 0; f < m_shared->buffersize; ++f )
+		{
+			_out[f][0] = part->partoutl[f];
+			_out[f][1] = part->partoutr[f];
+		}
+		return;
+	}
+
 #ifdef _MSC_VER
 	const auto outputl = static_cast<float*>(_alloca(synth->buffersize * sizeof(float)));
 	const auto outputr = static_cast<float*>(_alloca(synth->buffersize * sizeof(float)));
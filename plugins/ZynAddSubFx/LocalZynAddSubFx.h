@@ -25,6 +25,8 @@
 #ifndef LOCAL_ZYNADDSUBFX_H
 #define LOCAL_ZYNADDSUBFX_H
 
+#include <memory>
+
 #include "Note.h"
 
 class Master;
@@ -44,6 +46,15 @@ public:
 
 	void initConfig();
 
+	//! Plays one part of a Master that all instances that call this have in common, instead of
+	//! a whole Master of its own, so tracks that don't need the effects and mixing of their own
+	//! engine don't pay for it. Saves and loads the instrument of that part from then on.
+	void shareMaster();
+	bool isShared() const
+	{
+		return m_shared != nullptr;
+	}
+
 	void setSampleRate( int _sampleRate );
 	void setBufferSize( int _bufferSize );
 
@@ -76,6 +87,15 @@ protected:
 	Master * m_master;
 	NulEngine* m_ioEngine;
 
+	struct SharedMaster;
+	//! The one new shared instances join, as long as it has parts left
+	static std::weak_ptr<SharedMaster> s_sharedMaster;
+	std::shared_ptr<SharedMaster> m_shared;
+	//! The part of m_shared this instance plays, which gets the MIDI channel of the same number
+	int m_part = 0;
+	//! The period of m_shared this instance played last
+	unsigned m_playedPeriod = 0;
+
 } ;
 
 
@@ -115,7 +115,8 @@ ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 	m_fmGainModel( 127, 0, 127, 1, this, tr( "FM gain" ) ),
 	m_resCenterFreqModel( 64, 0, 127, 1, this, tr( "Resonance center frequency" ) ),
 	m_resBandwidthModel( 64, 0, 127, 1, this, tr( "Resonance bandwidth" ) ),
-	m_forwardMidiCcModel( true, this, tr( "Forward MIDI control change events" ) )
+	m_forwardMidiCcModel( true, this, tr( "Forward MIDI control change events" ) ),
+	m_sharedEngineModel( false, this, tr( "Share engine with other tracks" ) )
 {
 	initPlugin();
 
@@ -133,6 +134,8 @@ ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 			this, SLOT( updateResCenterFreq() ), Qt::DirectConnection );
 	connect( &m_resBandwidthModel, SIGNAL( dataChanged() ),
 			this, SLOT( updateResBandwidth() ), Qt::DirectConnection );
+	connect( &m_sharedEngineModel, SIGNAL( dataChanged() ),
+			this, SLOT( updateSharedEngine() ) );
 
 	// now we need a play-handle which cares for calling play()
 	auto iph = new InstrumentPlayHandle(this, _instrumentTrack);
@@ -188,6 +191,7 @@ void ZynAddSubFxInstrument::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "modifiedcontrollers", modifiedControllers );
 
 	m_forwardMidiCcModel.saveSettings( _doc, _this, "forwardmidicc" );
+	m_sharedEngineModel.saveSettings( _doc, _this, "sharedengine" );
 
 	QTemporaryFile tf;
 	if( tf.open() )
@@ -235,6 +239,7 @@ void ZynAddSubFxInstrument::loadSettings( const QDomElement & _this )
 	m_resCenterFreqModel.loadSettings( _this, "rescenterfreq" );
 	m_resBandwidthModel.loadSettings( _this, "resbandwidth" );
 	m_forwardMidiCcModel.loadSettings( _this, "forwardmidicc" );
+	m_sharedEngineModel.loadSettings( _this, "sharedengine" );
 
 	QDomDocument doc;
 	QDomElement data = _this.firstChildElement( "ZynAddSubFX-data" );
@@ -335,10 +340,12 @@ void ZynAddSubFxInstrument::play( sampleFrame * _buf )
 	if( m_remotePlugin )
 	{
 		m_remotePlugin->process( nullptr, _buf );
+		m_latency = m_remotePlugin->latency();
 	}
 	else
 	{
 		m_plugin->processAudio( _buf );
+		m_latency = 0;
 	}
 	m_pluginMutex.unlock();
 }
@@ -391,6 +398,21 @@ void ZynAddSubFxInstrument::reloadPlugin()
 
 
 
+void ZynAddSubFxInstrument::updateSharedEngine()
+{
+	// the GUI always runs an engine of its own
+	m_pluginMutex.lock();
+	const bool changed = m_plugin && m_plugin->isShared() != m_sharedEngineModel.value();
+	m_pluginMutex.unlock();
+
+	if( changed )
+	{
+		reloadPlugin();
+	}
+}
+
+
+
 void ZynAddSubFxInstrument::updatePitchRange()
 {
 	m_pluginMutex.lock();
@@ -466,6 +488,10 @@ void ZynAddSubFxInstrument::initPlugin()
 		m_plugin = new LocalZynAddSubFx;
 		m_plugin->setSampleRate( Engine::audioEngine()->processingSampleRate() );
 		m_plugin->setBufferSize( Engine::audioEngine()->framesPerPeriod() );
+		if( m_sharedEngineModel.value() )
+		{
+			m_plugin->shareMaster();
+		}
 	}
 
 	m_pluginMutex.unlock();
@@ -536,6 +562,9 @@ ZynAddSubFxView::ZynAddSubFxView( Instrument * _instrument, QWidget * _parent )
 	m_resBandwidth->setLabel( tr( "RES BW" ) );
 
 	m_forwardMidiCC = new LedCheckBox( tr( "Forward MIDI control changes" ), this );
+	m_sharedEngine = new LedCheckBox( tr( "Share engine with other tracks" ), this );
+	m_sharedEngine->setToolTip( tr( "Play one part of an engine that other tracks share, "
+		"without effects of its own, unless the GUI is shown" ) );
 
 	m_toggleUIButton = new QPushButton( tr( "Show GUI" ), this );
 	m_toggleUIButton->setCheckable( true );
@@ -555,8 +584,9 @@ ZynAddSubFxView::ZynAddSubFxView( Instrument * _instrument, QWidget * _parent )
 	l->addWidget( m_resCenterFreq, 3, 1 );
 	l->addWidget( m_resBandwidth, 3, 2 );
 	l->addWidget( m_forwardMidiCC, 4, 0, 1, 4 );
+	l->addWidget( m_sharedEngine, 5, 0, 1, 4 );
 
-	l->setRowStretch( 5, 10 );
+	l->setRowStretch( 6, 10 );
 	l->setColumnStretch( 4, 10 );
 
 	setAcceptDrops( true );
@@ -622,6 +652,7 @@ void ZynAddSubFxView::modelChanged()
 	m_resBandwidth->setModel( &m->m_resBandwidthModel );
 
 	m_forwardMidiCC->setModel( &m->m_forwardMidiCcModel );
+	m_sharedEngine->setModel( &m->m_sharedEngineModel );
 
 	m_toggleUIButton->setChecked( m->m_hasGUI );
 }
@@ -88,7 +88,12 @@ public:
 
 	Flags flags() const override
 	{
-		return Flag::IsSingleStreamed | Flag::IsMidiBased;
+		return Flag::IsSingleStreamed | Flag::IsMidiBased | Flag::NeedsFixedThread;
+	}
+
+	f_cnt_t latency() const override
+	{
+		return m_latency;
 	}
 
 	gui::PluginView* instantiateView( QWidget * _parent ) override;
@@ -96,6 +101,7 @@ public:
 
 private slots:
 	void reloadPlugin();
+	void updateSharedEngine();
 
 	void updatePitchRange();
 
@@ -116,6 +122,8 @@ private:
 	QMutex m_pluginMutex;
 	LocalZynAddSubFx * m_plugin;
 	ZynAddSubFxRemotePlugin * m_remotePlugin;
+	// of m_remotePlugin as of the last period it played
+	f_cnt_t m_latency = 0;
 
 	FloatModel m_portamentoModel;
 	FloatModel m_filterFreqModel;
@@ -125,6 +133,8 @@ private:
 	FloatModel m_resCenterFreqModel;
 	FloatModel m_resBandwidthModel;
 	BoolModel m_forwardMidiCcModel;
+	//! Whether the embedded engine plays one part of a Master shared with other tracks
+	BoolModel m_sharedEngineModel;
 
 	QMap<int, bool> m_modifiedControllers;
 
@@ -165,6 +175,7 @@ private:
 	Knob * m_resCenterFreq;
 	Knob * m_resBandwidth;
 	LedCheckBox * m_forwardMidiCC;
+	LedCheckBox * m_sharedEngine;
 
 
 private slots:
@@ -97,6 +97,7 @@ int RemotePluginBase::sendMessage( const message & _m )
 	}
 	pthread_mutex_unlock( &m_sendMutex );
 #endif
+	++m_sentMessages;
 
 	return j;
 }
@@ -128,6 +129,7 @@ RemotePluginBase::message RemotePluginBase::receiveMessage()
 	}
 	pthread_mutex_unlock( &m_receiveMutex );
 #endif
+	++m_receivedMessages;
 	return m;
 }
 
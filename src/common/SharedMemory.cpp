@@ -23,6 +23,8 @@
 
 #include "SharedMemory.h"
 
+#include <atomic>
+
 #include "lmmsconfig.h"
 
 #ifdef LMMS_HAVE_UNISTD_H
@@ -47,6 +49,13 @@
 
 namespace lmms::detail {
 
+namespace {
+
+std::atomic_bool s_hugePages = false;
+std::atomic_bool s_locked = false;
+
+} // namespace
+
 #if _POSIX_SHARED_MEMORY_OBJECTS > 0
 
 
@@ -122,6 +131,16 @@ public:
 		{
 			throw std::system_error{errno, std::generic_category(), "SharedMemoryImpl: mmap() failed"};
 		}
+
+		// Both are only hints, the memory works the same without them. MAP_HUGETLB
+		// doesn't apply to shm_open() objects, they get huge pages through the advice
+		// when the system's shmem_enabled allows it. The lock ends with munmap().
+#ifdef MADV_HUGEPAGE
+		if (s_hugePages) { madvise(m_mapping, m_size, MADV_HUGEPAGE); }
+#endif
+#if defined(_POSIX_MEMLOCK_RANGE) && _POSIX_MEMLOCK_RANGE > 0
+		if (s_locked) { mlock(m_mapping, m_size); }
+#endif
 	}
 
 	SharedMemoryImpl(const SharedMemoryImpl&) = delete;
@@ -193,6 +212,12 @@ SharedMemoryData::SharedMemoryData(std::string&& key, std::size_t size, bool rea
 
 SharedMemoryData::~SharedMemoryData() = default;
 
+void SharedMemoryData::setOptions(bool hugePages, bool locked) noexcept
+{
+	s_hugePages = hugePages;
+	s_locked = locked;
+}
+
 SharedMemoryData::SharedMemoryData(SharedMemoryData&& other) noexcept :
 	m_key{std::move(other.m_key)},
 	m_impl{std::move(other.m_impl)},
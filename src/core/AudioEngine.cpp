@@ -37,6 +37,7 @@
 #include "ConfigManager.h"
 #include "SamplePlayHandle.h"
 #include "MemoryHelper.h"
+#include "LocklessRingBuffer.h"
 
 // platform-specific audio-interface-classes
 #include "AudioAlsa.h"
@@ -46,6 +47,7 @@
 #include "AudioPortAudio.h"
 #include "AudioSoundIo.h"
 #include "AudioPulseAudio.h"
+#include "AudioPipeWire.h"
 #include "AudioSdl.h"
 #include "AudioDummy.h"
 
@@ -58,22 +60,65 @@
 #include "MidiWinMM.h"
 #include "MidiApple.h"
 #include "MidiDummy.h"
+#include "MidiPort.h"
 
 #include "BufferManager.h"
+#include "PeriodArena.h"
+#include "RcuPointer.h"
+#include "RealtimeChecker.h"
+#include "SharedMemory.h"
+
+#include <algorithm>
+#include <thread>
+#include <tuple>
+
+#include <QCoreApplication>
+#include <QDir>
 
 namespace lmms
 {
 
 using LocklessListElement = LocklessList<PlayHandle*>::Element;
 
+static void deletePlayHandle( PlayHandle * ph )
+{
+	ph->audioPort()->removePlayHandle( ph );
+	if( ph->type() == PlayHandle::Type::NotePlayHandle )
+	{
+		NotePlayHandleManager::release( (NotePlayHandle*) ph );
+	}
+	else delete ph;
+}
+
+// deletes all play handles matching the predicate and compacts the list in
+// a single pass, keeping the order of the remaining play handles
+template<typename Predicate>
+static void removePlayHandlesIf( PlayHandleList & playHandles, Predicate pred )
+{
+	auto kept = playHandles.begin();
+	for( auto it = playHandles.begin(); it != playHandles.end(); ++it )
+	{
+		if( pred( *it ) )
+		{
+			deletePlayHandle( *it );
+		}
+		else
+		{
+			*kept++ = *it;
+		}
+	}
+	playHandles.erase( kept, playHandles.end() );
+}
+
 static thread_local bool s_renderingThread;
 static thread_local bool s_runningChange;
 
 
 
 
-AudioEngine::AudioEngine( bool renderOnly ) :
+AudioEngine::AudioEngine( bool renderOnly, fpp_t renderFramesPerPeriod ) :
 	m_renderOnly( renderOnly ),
+	m_taskGraph( ConfigManager::inst()->value( "audioengine", "taskgraph", "1" ).toInt() ),
 	m_framesPerPeriod( DEFAULT_BUFFER_SIZE ),
 	m_inputBufferRead( 0 ),
 	m_inputBufferWrite( 1 ),
@@ -87,9 +132,12 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	m_audioDev( nullptr ),
 	m_oldAudioDev( nullptr ),
 	m_audioDevStartFailed( false ),
+	m_period( 0 ),
+	m_servedPeriod( 0 ),
 	m_profiler(),
 	m_metronomeActive(false),
-	m_clearSignal(false)
+	m_clearSignal(false),
+	m_renderEpoch(0)
 {
 	for( int i = 0; i < 2; ++i )
 	{
@@ -102,9 +150,16 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	// determine FIFO size and number of frames per period
 	int fifoSize = 1;
 
+	// when only rendering, nobody is listening, so the internal block size
+	// can be much larger than the chunks used for realtime playback
+	if( renderOnly )
+	{
+		m_framesPerPeriod = std::clamp( renderFramesPerPeriod,
+						MINIMUM_BUFFER_SIZE, MAXIMUM_RENDER_BUFFER_SIZE );
+	}
 	// if not only rendering (that is, using the GUI), load the buffer
 	// size from user configuration
-	if( renderOnly == false )
+	else
 	{
 		m_framesPerPeriod = 
 			( fpp_t ) ConfigManager::inst()->value( "audioengine", "framesperaudiobuffer" ).toInt();
@@ -120,14 +175,7 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 
 			m_framesPerPeriod = DEFAULT_BUFFER_SIZE;
 		}
-		// lmms works with chunks of size DEFAULT_BUFFER_SIZE (256) and only the final mix will use the actual
-		// buffer size. Plugins don't see a larger buffer size than 256. If m_framesPerPeriod is larger than
-		// DEFAULT_BUFFER_SIZE, it's set to DEFAULT_BUFFER_SIZE and the rest is handled by an increased fifoSize.
-		else if( m_framesPerPeriod > DEFAULT_BUFFER_SIZE )
-		{
-			fifoSize = m_framesPerPeriod / DEFAULT_BUFFER_SIZE;
-			m_framesPerPeriod = DEFAULT_BUFFER_SIZE;
-		}
+		std::tie( m_framesPerPeriod, fifoSize ) = splitBufferSize( m_framesPerPeriod );
 	}
 
 	// allocte the FIFO from the determined size
@@ -136,6 +184,19 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	// now that framesPerPeriod is fixed initialize global BufferManager
 	BufferManager::init( m_framesPerPeriod );
 
+	const int noteHandles = ConfigManager::inst()->value( "audioengine", "notehandles" ).toInt();
+	if( noteHandles > 0 )
+	{
+		NotePlayHandleManager::setHighWaterMark( noteHandles );
+	}
+	NotePlayHandleManager::setVoiceLimit( ConfigManager::inst()->value( "audioengine", "maxvoices" ).toInt() );
+	m_qualityGovernor.setEnabled( ConfigManager::inst()->value( "audioengine", "qualitygovernor" ).toInt() );
+
+	const bool hugePages = ConfigManager::inst()->value( "audioengine", "hugepages" ).toInt();
+	const bool lockMemory = ConfigManager::inst()->value( "audioengine", "lockmemory" ).toInt();
+	MemoryHelper::setLargeBufferOptions( hugePages, lockMemory );
+	detail::SharedMemoryData::setOptions( hugePages, lockMemory );
+
 	int outputBufferSize = m_framesPerPeriod * sizeof(surroundSampleFrame);
 	m_outputBufferRead = static_cast<surroundSampleFrame *>(MemoryHelper::alignedMalloc(outputBufferSize));
 	m_outputBufferWrite = static_cast<surroundSampleFrame *>(MemoryHelper::alignedMalloc(outputBufferSize));
@@ -143,6 +204,32 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	BufferManager::clear(m_outputBufferRead, m_framesPerPeriod);
 	BufferManager::clear(m_outputBufferWrite, m_framesPerPeriod);
 
+	m_monitorInput.resize(m_framesPerPeriod);
+	m_monitorBacklog.reserve(2 * MAXIMUM_BUFFER_SIZE);
+
+	if (!m_renderOnly)
+	{
+		m_outputTap = std::make_unique<LocklessRingBuffer<surroundSampleFrame>>(8 * m_framesPerPeriod);
+	}
+
+	AudioEngineWorkerThread::setWaitPolicy(AudioEngineWorkerThread::waitPolicyFromName(
+		ConfigManager::inst()->value("audioengine", "workerwaitpolicy")));
+
+	// the number of threads processing audio jobs includes the thread
+	// running the last worker inline - by default use one per core we're
+	// allowed to run on
+	const int workerThreads = ConfigManager::inst()->value("audioengine", "workerthreads").toInt();
+	const auto cores = AudioEngineWorkerThread::coresFromList(
+		ConfigManager::inst()->value("audioengine", "workercores"));
+	if( workerThreads > 0 )
+	{
+		m_numWorkers = workerThreads - 1;
+	}
+	else if( !cores.empty() )
+	{
+		m_numWorkers = static_cast<int>(cores.size()) - 1;
+	}
+
 	for( int i = 0; i < m_numWorkers+1; ++i )
 	{
 		auto wt = new AudioEngineWorkerThread(this);
@@ -152,6 +239,12 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 		}
 		m_workers.push_back( wt );
 	}
+
+	// keep a post-mortem of glitches during live playback
+	if( !renderOnly && ConfigManager::inst()->value( "audioengine", "xrunlog" ).toInt() )
+	{
+		m_profiler.setXrunLogFile( QDir( ConfigManager::inst()->workingDir() ).filePath( "xruns.log" ) );
+	}
 }
 
 
@@ -171,10 +264,6 @@ AudioEngine::~AudioEngine()
 		m_workers[w]->wait( 500 );
 	}
 
-	while( m_fifo->available() )
-	{
-		delete[] m_fifo->read();
-	}
 	delete m_fifo;
 
 	delete m_midiClient;
@@ -187,6 +276,8 @@ AudioEngine::~AudioEngine()
 	{
 		delete[] input;
 	}
+
+	BufferManager::cleanup();
 }
 
 
@@ -213,7 +304,21 @@ void AudioEngine::initDevices()
 
 void AudioEngine::startProcessing(bool needsFifo)
 {
-	if (needsFifo)
+	AudioEngineWorkerThread::SchedulingOptions scheduling;
+	scheduling.cores = AudioEngineWorkerThread::coresFromList(
+		ConfigManager::inst()->value("audioengine", "workercores"));
+	scheduling.realtimePriority =
+		ConfigManager::inst()->value("audioengine", "workerrtpriority").toInt();
+	AudioEngineWorkerThread::setSchedulingOptions(scheduling);
+
+	// keep the GUI (and every thread it starts from now on) away from the
+	// cores reserved for audio processing
+	if( QThread::currentThread() == QCoreApplication::instance()->thread() )
+	{
+		AudioEngineWorkerThread::avoidWorkerCores();
+	}
+
+	if (needsFifo && m_audioDev->needsFifo())
 	{
 		m_fifoWriter = new fifoWriter( this, m_fifo );
 		m_fifoWriter->start( QThread::HighPriority );
@@ -334,36 +439,28 @@ void AudioEngine::renderStageNoteSetup()
 		clearInternal();
 	}
 
-	// remove all play-handles that have to be deleted and delete
-	// them if they still exist...
-	// maybe this algorithm could be optimized...
-	ConstPlayHandleList::Iterator it_rem = m_playHandlesToRemove.begin();
-	while( it_rem != m_playHandlesToRemove.end() )
+	// remove all play-handles that have to be deleted
+	removePlayHandlesIf( m_playHandles, []( const PlayHandle * ph )
 	{
-		PlayHandleList::Iterator it = std::find( m_playHandles.begin(), m_playHandles.end(), *it_rem );
-
-		if( it != m_playHandles.end() )
-		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::Type::NotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			m_playHandles.erase( it );
-		}
-
-		it_rem = m_playHandlesToRemove.erase( it_rem );
-	}
+		return ph->isRemovalRequested();
+	} );
 
 	swapBuffers();
+	updateMonitorInput();
 
 	// prepare master mix (clear internal buffers etc.)
 	Mixer * mixer = Engine::mixer();
-	mixer->prepareMasterMix();
+	mixer->prepareMasterMix(m_audioPorts);
 
 	handleMetronome();
 
+	// what was played live in the last period, before anything reads
+	// the controllers it moved
+	for (MidiPort * port : m_midiPorts)
+	{
+		port->dispatchInEvents(m_periodStart, processingSampleRate(), m_framesPerPeriod);
+	}
+
 	// create play-handles for new notes, samples etc.
 	Engine::getSong()->processNextBuffer();
 
@@ -375,6 +472,19 @@ void AudioEngine::renderStageNoteSetup()
 		m_newPlayHandles.free( e );
 		e = next;
 	}
+
+	// stretch what plays to a tempo set since the last period
+	Engine::getSong()->resizeNotesToTempo();
+
+	// instruments rendering all of their notes at once need to know them
+	// before the first one plays
+	for (PlayHandle * ph : m_playHandles)
+	{
+		if (ph->type() == PlayHandle::Type::NotePlayHandle)
+		{
+			static_cast<NotePlayHandle *>(ph)->queueForBatch();
+		}
+	}
 }
 
 
@@ -397,31 +507,63 @@ void AudioEngine::renderStageEffects()
 	AudioEngineWorkerThread::fillJobQueue(m_audioPorts);
 	AudioEngineWorkerThread::startAndWaitForJobs();
 
-	// removed all play handles which are done
-	for( PlayHandleList::Iterator it = m_playHandles.begin();
-						it != m_playHandles.end(); )
+	removeFinishedPlayHandles();
+}
+
+
+
+void AudioEngine::renderStageGraph()
+{
+	AudioEngineProfiler::Probe profilerProbe(m_profiler, AudioEngineProfiler::DetailType::TaskGraph);
+
+	// STAGES 1-3 without barriers: an audio port is queued as soon as its play
+	// handles are done, a mixer channel as soon as all ports and channels
+	// sending to it are done
+	AudioEngineWorkerThread::resetJobQueue(AudioEngineWorkerThread::JobQueue::OperationMode::Dynamic);
+
+	Mixer * mixer = Engine::mixer();
+	mixer->prepareTaskGraph(m_audioPorts);
+
+	// every port holds back one extra input until all play handles are
+	// queued, otherwise it could start before we know about all of them
+	for (AudioPort * port : m_audioPorts)
 	{
-		if( ( *it )->affinityMatters() &&
-			( *it )->affinity() != QThread::currentThread() )
-		{
-			++it;
-			continue;
-		}
-		if( ( *it )->isFinished() )
+		port->addPendingInput();
+	}
+	for (PlayHandle * ph : m_playHandles)
+	{
+		AudioPort * port = ph->audioPort();
+		if (port)
 		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::Type::NotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
+			port->addPendingInput();
 		}
-		else
+		if (!AudioEngineWorkerThread::addJob(ph) && port)
 		{
-			++it;
+			port->inputProcessed();
 		}
 	}
+	for (AudioPort * port : m_audioPorts)
+	{
+		port->inputProcessed();
+	}
+
+	mixer->scheduleChannels();
+
+	AudioEngineWorkerThread::startAndWaitForJobs();
+
+	removeFinishedPlayHandles();
+}
+
+
+
+void AudioEngine::removeFinishedPlayHandles()
+{
+	// removed all play handles which are done
+	removePlayHandlesIf( m_playHandles, []( const PlayHandle * ph )
+	{
+		return ( !ph->affinityMatters() || ph->affinity() == QThread::currentThread() )
+			&& ph->isFinished();
+	} );
 }
 
 
@@ -431,9 +573,18 @@ void AudioEngine::renderStageMix()
 	AudioEngineProfiler::Probe profilerProbe(m_profiler, AudioEngineProfiler::DetailType::Mixing);
 
 	Mixer *mixer = Engine::mixer();
-	mixer->masterMix(m_outputBufferWrite);
+	if (m_taskGraph)
+	{
+		// all channels have already been processed by renderStageGraph()
+		mixer->finishMasterMix(m_outputBufferWrite);
+	}
+	else
+	{
+		mixer->masterMix(m_outputBufferWrite);
+	}
 
-	emit nextAudioBuffer(m_outputBufferRead);
+	// nobody waits for this, if the views don't keep up the rest is dropped
+	if (m_outputTap) { m_outputTap->write(m_outputBufferRead, m_framesPerPeriod); }
 
 	// and trigger LFOs
 	EnvelopeAndLfoParameters::instances()->trigger();
@@ -446,17 +597,33 @@ void AudioEngine::renderStageMix()
 const surroundSampleFrame *AudioEngine::renderNextBuffer()
 {
 	const auto lock = std::lock_guard{m_changeMutex};
+	AudioEngineTracer::Scope traceScope("Period");
+	RealtimeChecker::Scope realtimeScope;
 
+	++m_renderEpoch;
+	++m_period;
+	m_periodStart = std::chrono::steady_clock::now();
 	m_profiler.startPeriod();
+	PeriodArena::reset();
 	s_renderingThread = true;
 
 	renderStageNoteSetup();     // STAGE 0: clear old play handles and buffers, setup new play handles
-	renderStageInstruments();   // STAGE 1: run and render all play handles
-	renderStageEffects();       // STAGE 2: process effects of all instrument- and sampletracks
+	if (m_taskGraph)
+	{
+		renderStageGraph();     // STAGES 1-3 as one task graph
+	}
+	else
+	{
+		renderStageInstruments();   // STAGE 1: run and render all play handles
+		renderStageEffects();       // STAGE 2: process effects of all instrument- and sampletracks
+	}
 	renderStageMix();           // STAGE 3: do master mix in mixer
 
 	s_renderingThread = false;
+	m_profiler.setPlayHandleCount(m_playHandles.size());
+	m_profiler.setRealtime(!Engine::getSong()->isExporting());
 	m_profiler.finishPeriod(processingSampleRate(), m_framesPerPeriod);
+	++m_renderEpoch;
 
 	return m_outputBufferRead;
 }
@@ -464,6 +631,26 @@ const surroundSampleFrame *AudioEngine::renderNextBuffer()
 
 
 
+const surroundSampleFrame * AudioEngine::nextBuffer()
+{
+	if( !hasFifoWriter() )
+	{
+		const surroundSampleFrame * buffer = renderNextBuffer();
+		m_servedPeriod = m_period;
+		return buffer;
+	}
+
+	const surroundSampleFrame * buffer = m_fifo->read();
+	if( buffer )
+	{
+		m_servedPeriod = m_fifoWriter->periodOf( buffer );
+	}
+	return buffer;
+}
+
+
+
+
 void AudioEngine::swapBuffers()
 {
 	m_inputBufferWrite = (m_inputBufferWrite + 1) % 2;
@@ -477,6 +664,31 @@ void AudioEngine::swapBuffers()
 
 
 
+void AudioEngine::updateMonitorInput()
+{
+	// what came in since the last period goes after what is left from before
+	const auto incoming = std::min(static_cast<std::size_t>(inputBufferFrames()), m_monitorBacklog.capacity());
+	const sampleFrame * input = inputBuffer() + inputBufferFrames() - incoming;
+	const auto kept = std::min(m_monitorBacklog.size(), m_monitorBacklog.capacity() - incoming);
+	m_monitorBacklog.erase(m_monitorBacklog.begin(), m_monitorBacklog.end() - kept);
+	m_monitorBacklog.insert(m_monitorBacklog.end(), input, input + incoming);
+
+	if (m_monitorBacklog.size() < m_framesPerPeriod)
+	{
+		BufferManager::clear(m_monitorInput.data(), m_framesPerPeriod);
+		return;
+	}
+	std::copy_n(m_monitorBacklog.begin(), m_framesPerPeriod, m_monitorInput.begin());
+
+	// a device capturing a little faster than it plays would otherwise make
+	// the backlog, and the latency with it, grow without end
+	const auto left = std::min(m_monitorBacklog.size() - m_framesPerPeriod, incoming);
+	m_monitorBacklog.erase(m_monitorBacklog.begin(), m_monitorBacklog.end() - left);
+}
+
+
+
+
 void AudioEngine::handleMetronome()
 {
 	static tick_t lastMetroTicks = -1;
@@ -554,7 +766,7 @@ void AudioEngine::clearInternal()
 	{
 		if (ph->type() != PlayHandle::Type::InstrumentPlayHandle)
 		{
-			m_playHandlesToRemove.push_back(ph);
+			ph->requestRemoval();
 		}
 	}
 }
@@ -611,6 +823,10 @@ void AudioEngine::doSetAudioDevice( AudioDevice * _dev )
 	// Currently, this is safe, because this is only called by
 	// ProjectRenderer, and after ProjectRenderer calls this function,
 	// it does not access the old device anymore.
+	// The outputs of the mixer channels belong to the device they came from,
+	// and the new one gets to offer its own
+	const bool replaced = m_audioDev != nullptr && m_audioDev != m_oldAudioDev;
+	if( replaced && Engine::mixer() ) { Engine::mixer()->releaseChannelOutputs(); }
 	if( m_audioDev != m_oldAudioDev ) {delete m_audioDev;}
 
 	if( _dev )
@@ -623,6 +839,8 @@ void AudioEngine::doSetAudioDevice( AudioDevice * _dev )
 					"Trying any working audio-device\n" );
 		m_audioDev = tryAudioDevices();
 	}
+
+	if( replaced && Engine::mixer() ) { Engine::mixer()->createChannelOutputs(); }
 }
 
 
@@ -648,6 +866,45 @@ void AudioEngine::setAudioDevice(AudioDevice * _dev,
 
 
 
+std::pair<fpp_t, int> AudioEngine::splitBufferSize( fpp_t framesPerAudioBuffer )
+{
+	// lmms works with chunks of size DEFAULT_BUFFER_SIZE (256) and only the final mix will use the actual
+	// buffer size. Plugins don't see a larger buffer size than 256. If the buffer size is larger than
+	// DEFAULT_BUFFER_SIZE, the period is DEFAULT_BUFFER_SIZE and the rest is handled by an increased fifoSize.
+	if( framesPerAudioBuffer > DEFAULT_BUFFER_SIZE )
+	{
+		return { DEFAULT_BUFFER_SIZE, std::min( framesPerAudioBuffer, MAXIMUM_BUFFER_SIZE ) / DEFAULT_BUFFER_SIZE };
+	}
+	return { framesPerAudioBuffer, 1 };
+}
+
+
+
+
+bool AudioEngine::setFramesPerAudioBuffer( fpp_t framesPerAudioBuffer )
+{
+	const auto [period, fifoSize] = splitBufferSize( std::max( framesPerAudioBuffer, MINIMUM_BUFFER_SIZE ) );
+	if( m_renderOnly || period != m_framesPerPeriod )
+	{
+		return false;
+	}
+	if( fifoSize == m_fifo->size() )
+	{
+		return true;
+	}
+
+	// the FIFO only passes on the periods of the fifo writer, which is
+	// started anew with buffers for the new size
+	stopProcessing();
+	delete m_fifo;
+	m_fifo = new Fifo( fifoSize );
+	startProcessing();
+	return true;
+}
+
+
+
+
 void AudioEngine::storeAudioDevice()
 {
 	if( !m_oldAudioDev )
@@ -690,6 +947,31 @@ void AudioEngine::removeAudioPort(AudioPort * port)
 }
 
 
+
+
+void AudioEngine::addMidiPort(MidiPort * port)
+{
+	requestChangeInModel();
+	m_midiPorts.push_back(port);
+	doneChangeInModel();
+}
+
+
+
+
+void AudioEngine::removeMidiPort(MidiPort * port)
+{
+	requestChangeInModel();
+
+	auto it = std::find(m_midiPorts.begin(), m_midiPorts.end(), port);
+	if (it != m_midiPorts.end())
+	{
+		m_midiPorts.erase(it);
+	}
+	doneChangeInModel();
+}
+
+
 bool AudioEngine::addPlayHandle( PlayHandle* handle )
 {
 	// Only add play handles if we have the CPU capacity to process them.
@@ -762,7 +1044,7 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 	}
 	else
 	{
-		m_playHandlesToRemove.push_back(ph);
+		ph->requestRemoval();
 	}
 	doneChangeInModel();
 }
@@ -773,24 +1055,10 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 void AudioEngine::removePlayHandlesOfTypes(Track * track, PlayHandle::Types types)
 {
 	requestChangeInModel();
-	PlayHandleList::Iterator it = m_playHandles.begin();
-	while( it != m_playHandles.end() )
+	removePlayHandlesIf( m_playHandles, [track, types]( const PlayHandle * ph )
 	{
-		if ((*it)->isFromTrack(track) && ((*it)->type() & types))
-		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::Type::NotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
-		}
-		else
-		{
-			++it;
-		}
-	}
+		return ph->isFromTrack( track ) && ( ph->type() & types );
+	} );
 	doneChangeInModel();
 }
 
@@ -811,6 +1079,26 @@ void AudioEngine::doneChangeInModel()
 	s_runningChange = false;
 }
 
+void AudioEngine::waitForGracePeriod()
+{
+	// nothing renders during a change in model, which holds the lock
+	if (s_renderingThread || s_runningChange) { return; }
+
+	// a period that starts after this sees what was published before
+	const auto epoch = m_renderEpoch.load();
+	if (epoch % 2 == 0) { return; }
+	while (m_renderEpoch.load() == epoch)
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+void RcuPointerBase::synchronize()
+{
+	// there's nothing left to wait for once the engine is gone
+	if (AudioEngine* audioEngine = Engine::audioEngine()) { audioEngine->waitForGracePeriod(); }
+}
+
 bool AudioEngine::isAudioDevNameValid(QString name)
 {
 #ifdef LMMS_HAVE_SDL
@@ -829,6 +1117,14 @@ bool AudioEngine::isAudioDevNameValid(QString name)
 #endif
 
 
+#ifdef LMMS_HAVE_PIPEWIRE
+	if (name == AudioPipeWire::name())
+	{
+		return true;
+	}
+#endif
+
+
 #ifdef LMMS_HAVE_PULSEAUDIO
 	if (name == AudioPulseAudio::name())
 	{
@@ -974,6 +1270,21 @@ AudioDevice * AudioEngine::tryAudioDevices()
 #endif
 
 
+#ifdef LMMS_HAVE_PIPEWIRE
+	// before PulseAudio, which is only a layer on top of it where it runs
+	if( dev_name == AudioPipeWire::name() || dev_name == "" )
+	{
+		dev = new AudioPipeWire( success_ful, this );
+		if( success_ful )
+		{
+			m_audioDevName = AudioPipeWire::name();
+			return dev;
+		}
+		delete dev;
+	}
+#endif
+
+
 #ifdef LMMS_HAVE_PULSEAUDIO
 	if( dev_name == AudioPulseAudio::name() || dev_name == "" )
 	{
@@ -1207,7 +1518,11 @@ MidiClient * AudioEngine::tryMidiClients()
 AudioEngine::fifoWriter::fifoWriter( AudioEngine* audioEngine, Fifo * fifo ) :
 	m_audioEngine( audioEngine ),
 	m_fifo( fifo ),
-	m_writing( true )
+	m_writing( true ),
+	// while the FIFO is full, the device may still be copying the period it
+	// read last and we wait to write the next one
+	m_buffers( static_cast<std::size_t>( fifo->size() + 2 ) * audioEngine->framesPerPeriod() ),
+	m_periods( fifo->size() + 2, 0 )
 {
 	setObjectName("AudioEngine::fifoWriter");
 }
@@ -1223,6 +1538,14 @@ void AudioEngine::fifoWriter::finish()
 
 
 
+std::uint64_t AudioEngine::fifoWriter::periodOf( const surroundSampleFrame * buffer ) const
+{
+	return m_periods[( buffer - m_buffers.data() ) / m_audioEngine->framesPerPeriod()];
+}
+
+
+
+
 void AudioEngine::fifoWriter::run()
 {
 	disable_denormals();
@@ -1239,12 +1562,21 @@ void AudioEngine::fifoWriter::run()
 #endif
 
 	const fpp_t frames = m_audioEngine->framesPerPeriod();
-	while( m_writing )
+	const std::size_t bufferCount = m_buffers.size() / frames;
+	for( std::size_t next = 0; m_writing; next = ( next + 1 ) % bufferCount )
 	{
-		auto buffer = new surroundSampleFrame[frames];
+		surroundSampleFrame * buffer = m_buffers.data() + next * frames;
 		const surroundSampleFrame * b = m_audioEngine->renderNextBuffer();
 		memcpy( buffer, b, frames * sizeof( surroundSampleFrame ) );
+		m_periods[next] = m_audioEngine->m_period;
 		m_fifo->write(buffer);
+
+		// when rendering ahead for an export, stop after the last period so
+		// the exporting thread knows when it has written everything
+		if( Engine::getSong()->isExporting() && Engine::getSong()->isExportDone() )
+		{
+			break;
+		}
 	}
 
 	// Let audio backend stop processing
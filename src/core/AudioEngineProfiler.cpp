@@ -24,11 +24,140 @@
 
 #include "AudioEngineProfiler.h"
 
+#include <algorithm>
 #include <cstdint>
 
+#include <QDateTime>
+#include <QThread>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "LocklessRingBuffer.h"
+#include "NotePlayHandle.h"
+
 namespace lmms
 {
 
+//! Writes the history handed over by the audio thread to the log file
+class AudioEngineProfiler::XrunLogger : public QThread
+{
+public:
+	explicit XrunLogger( const QString& logFile ) :
+		m_records( 4 * XrunHistory ),
+		m_reader( m_records ),
+		m_file( logFile ),
+		m_opened( m_file.open( QFile::WriteOnly | QFile::Append | QFile::Text ) ),
+		m_quit( false )
+	{
+		if( m_opened )
+		{
+			start( QThread::LowPriority );
+		}
+		else
+		{
+			qWarning( "Could not open xrun log %s", qPrintable( logFile ) );
+		}
+	}
+
+	~XrunLogger() override
+	{
+		m_quit = true;
+		wait();
+	}
+
+	//! Called by the audio thread, drops the history if the last one
+	//! hasn't been written yet
+	void push( const std::array<PeriodRecord, XrunHistory>& history, std::size_t oldest )
+	{
+		if( !m_opened || m_records.free() < XrunHistory )
+		{
+			return;
+		}
+		m_records.write( history.data() + oldest, XrunHistory - oldest );
+		m_records.write( history.data(), oldest );
+	}
+
+private:
+	void run() override
+	{
+		std::array<PeriodRecord, XrunHistory> history;
+		while( !m_quit )
+		{
+			if( m_reader.read_space() < XrunHistory )
+			{
+				msleep( 100 );
+				continue;
+			}
+			m_reader.read( XrunHistory ).copy( history.data(), XrunHistory );
+			write( history );
+		}
+	}
+
+	void write( const std::array<PeriodRecord, XrunHistory>& history )
+	{
+		const PeriodRecord& xrun = history[XrunHistory - XrunAftermath - 1];
+		const auto xrunTime = QDateTime::fromMSecsSinceEpoch( xrun.timestamp );
+		qWarning( "Missed the audio deadline at %s, see %s",
+			qPrintable( xrunTime.toString( "hh:mm:ss.zzz" ) ), qPrintable( m_file.fileName() ) );
+
+		QString log = QString( "Missed the deadline of %1 us at %2, the last %3 periods were:\n" )
+			.arg( xrun.timeLimit )
+			.arg( xrunTime.toString( Qt::ISODateWithMs ) )
+			.arg( XrunHistory );
+		const auto notes = NotePlayHandleManager::statistics();
+		log += QString( "Note play handles: %1 in the pool, %2 free, at most %3 in use, pool ran dry %4 times, "
+				"%5 notes stolen\n" )
+			.arg( notes.size )
+			.arg( notes.available )
+			.arg( notes.peakInUse )
+			.arg( notes.audioThreadGrowths )
+			.arg( notes.stolen );
+		const auto queue = Engine::audioEngine()->newPlayHandleStatistics();
+		log += QString( "New play handle queue: room for %1, %2 queued, at most %3, grew %4 times, "
+				"full %5 times\n" )
+			.arg( queue.capacity )
+			.arg( queue.inUse )
+			.arg( queue.peakInUse )
+			.arg( queue.growths )
+			.arg( queue.failures );
+		log += "time          total  notes  instr effect  mixer  graph handles  slowest jobs\n";
+		for( const PeriodRecord& record : history )
+		{
+			if( record.timestamp == 0 )
+			{
+				continue; // not that many periods yet
+			}
+			log += QString( "%1 %2" )
+				.arg( QDateTime::fromMSecsSinceEpoch( record.timestamp ).toString( "hh:mm:ss.zzz" ) )
+				.arg( record.periodTime, 6 );
+			for( const int detailTime : record.detailTime )
+			{
+				log += QString( " %1" ).arg( detailTime, 6 );
+			}
+			log += QString( " %1 " ).arg( record.playHandles, 7 );
+			for( const auto & job : record.slowestJobs )
+			{
+				if( job.time > 0 )
+				{
+					log += QString( " %1=%2" ).arg( QString::fromUtf8( job.name.data() ) ).arg( job.time );
+				}
+			}
+			log += record.periodTime > record.timeLimit ? "  <- missed\n" : "\n";
+		}
+		m_file.write( ( log + "\n" ).toUtf8() );
+		m_file.flush();
+	}
+
+	LocklessRingBuffer<PeriodRecord> m_records;
+	LocklessRingBufferReader<PeriodRecord> m_reader;
+	QFile m_file;
+	const bool m_opened;
+	std::atomic_bool m_quit;
+};
+
+
+
+
 AudioEngineProfiler::AudioEngineProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
@@ -38,6 +167,10 @@ AudioEngineProfiler::AudioEngineProfiler() :
 
 
 
+AudioEngineProfiler::~AudioEngineProfiler() = default;
+
+
+
 void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
 {
 	// Time taken to process all data and fill the audio buffer.
@@ -57,11 +190,72 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 		const auto newLoad = 100.f * m_detailTime[i] / timeLimit;
 		const auto oldLoad = m_detailLoad[i].load(std::memory_order_relaxed);
 		m_detailLoad[i].store(newLoad * 0.05f + oldLoad * 0.95f, std::memory_order_relaxed);
+		m_detailTotal[i] += m_detailTime[i];
 	}
 
+	PeriodRecord& record = m_history[m_historyPos];
+	record.timestamp = QDateTime::currentMSecsSinceEpoch();
+	record.periodTime = periodElapsed;
+	record.timeLimit = static_cast<int>( timeLimit );
+	record.detailTime = m_detailTime;
+	record.playHandles = m_playHandleCount;
+	record.slowestJobs = {};
+	m_historyPos = ( m_historyPos + 1 ) % XrunHistory;
+
 	if( m_outputFile.isOpen() )
 	{
-		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
+		// period time, followed by name=time of everything that took any time
+		QString line = QString::number( periodElapsed );
+		finishAccounts( timeLimit, &line, record );
+		m_outputFile.write( ( line + "\n" ).toUtf8() );
+	}
+	else
+	{
+		finishAccounts( timeLimit, nullptr, record );
+	}
+
+	// log what happened before and shortly after a missed deadline
+	if( m_xrunLogger )
+	{
+		if( m_realtime && periodElapsed > timeLimit && m_xrunCountdown < 0 )
+		{
+			m_xrunCountdown = XrunAftermath;
+		}
+		if( m_xrunCountdown >= 0 && m_xrunCountdown-- == 0 )
+		{
+			m_xrunLogger->push( m_history, m_historyPos );
+		}
+	}
+}
+
+
+
+void AudioEngineProfiler::finishAccounts(uint64_t timeLimit, QString* output, PeriodRecord& record)
+{
+	// a period's time is added to the next one if an account is being
+	// added or removed right now - better than blocking the audio thread
+	std::unique_lock<std::mutex> lock(m_accountsMutex, std::try_to_lock);
+	if (!lock.owns_lock()) { return; }
+
+	for (Account* account : m_accounts)
+	{
+		const int time = account->m_time.exchange(0, std::memory_order_relaxed);
+		const auto newLoad = 100.f * time / timeLimit;
+		const auto oldLoad = account->m_load.load(std::memory_order_relaxed);
+		account->m_load.store(newLoad * 0.05f + oldLoad * 0.95f, std::memory_order_relaxed);
+
+		if (output && time > 0)
+		{
+			*output += QString("\t%1=%2").arg(account->m_name).arg(time);
+		}
+
+		// keep the slowest jobs sorted, slowest first
+		auto& jobs = record.slowestJobs;
+		if (time > jobs.back().time)
+		{
+			jobs.back() = {account->m_shortName, time};
+			std::sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a.time > b.time; });
+		}
 	}
 }
 
@@ -74,4 +268,44 @@ void AudioEngineProfiler::setOutputFile( const QString& outputFile )
 	m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
 }
 
+
+
+void AudioEngineProfiler::setXrunLogFile( const QString& logFile )
+{
+	m_xrunLogger.reset();
+	if( !logFile.isEmpty() )
+	{
+		m_xrunLogger = std::make_unique<XrunLogger>( logFile );
+	}
+}
+
+
+
+AudioEngineProfiler::Account::Account(AudioEngineProfiler& profiler, const QString& name) :
+	m_profiler(profiler),
+	m_name(name)
+{
+	const auto lock = std::lock_guard{m_profiler.m_accountsMutex};
+	qstrncpy(m_shortName.data(), name.toUtf8().constData(), m_shortName.size());
+	m_profiler.m_accounts.push_back(this);
+}
+
+
+
+AudioEngineProfiler::Account::~Account()
+{
+	const auto lock = std::lock_guard{m_profiler.m_accountsMutex};
+	auto& accounts = m_profiler.m_accounts;
+	accounts.erase(std::find(accounts.begin(), accounts.end(), this));
+}
+
+
+
+void AudioEngineProfiler::Account::setName(const QString& name)
+{
+	const auto lock = std::lock_guard{m_profiler.m_accountsMutex};
+	m_name = name;
+	qstrncpy(m_shortName.data(), name.toUtf8().constData(), m_shortName.size());
+}
+
 } // namespace lmms
@@ -0,0 +1,260 @@
+/*
+ * AudioEngineTracer.cpp - record a timeline of what the audio engine does
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioEngineTracer.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+
+#include "AudioEngineWorkerThread.h"
+#include "LocklessRingBuffer.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+struct TraceEvent
+{
+	const char* name;
+	int index;
+	std::int64_t begin;
+	std::int64_t end;
+};
+
+// enough for a few seconds of a busy thread at small buffer sizes
+constexpr std::size_t EventsPerThread = 1 << 16;
+constexpr int MaxThreads = 128;
+
+struct ThreadBuffer
+{
+	ThreadBuffer(int tid, const QString& name)
+		: ring(EventsPerThread)
+		, reader(ring)
+		, tid(tid)
+		, name(name)
+	{
+	}
+
+	LocklessRingBuffer<TraceEvent> ring;
+	LocklessRingBufferReader<TraceEvent> reader;
+	const int tid;
+	const QString name;
+	std::atomic_int dropped{0};
+};
+
+struct ThreadBuffers
+{
+	~ThreadBuffers()
+	{
+		for (auto& buffer : buffers) { delete buffer.load(); }
+	}
+
+	std::array<std::atomic<ThreadBuffer*>, MaxThreads> buffers{};
+	std::atomic_int count{0};
+};
+
+ThreadBuffers s_threadBuffers;
+thread_local ThreadBuffer* t_threadBuffer = nullptr;
+
+std::chrono::steady_clock::time_point s_startTime;
+QFile s_outputFile;
+bool s_started = false;
+bool s_firstEvent = true;
+
+
+QByteArray toJson(const ThreadBuffer& thread, const TraceEvent& event)
+{
+	QString json = QString("{\"name\":\"%1\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4")
+		.arg(event.name)
+		.arg(thread.tid)
+		.arg(QString::number(event.begin / 1000.0, 'f', 3))
+		.arg(QString::number((event.end - event.begin) / 1000.0, 'f', 3));
+	if (event.index >= 0)
+	{
+		json += QString(",\"args\":{\"index\":%1}").arg(event.index);
+	}
+	return (json + "}").toUtf8();
+}
+
+
+void writeEvent(const QByteArray& json)
+{
+	s_outputFile.write(s_firstEvent ? "\n" : ",\n");
+	s_outputFile.write(json);
+	s_firstEvent = false;
+}
+
+
+void writePendingEvents()
+{
+	const int count = std::min(s_threadBuffers.count.load(std::memory_order_acquire), MaxThreads);
+	for (int i = 0; i < count; ++i)
+	{
+		ThreadBuffer* thread = s_threadBuffers.buffers[i].load(std::memory_order_acquire);
+		if (!thread) { continue; }
+
+		while (!thread->reader.empty())
+		{
+			auto events = thread->reader.read_max(thread->reader.read_space());
+			for (std::size_t e = 0; e < events.size(); ++e)
+			{
+				writeEvent(toJson(*thread, events[e]));
+			}
+		}
+	}
+}
+
+
+class TraceWriter : public QThread
+{
+public:
+	void quit() { m_quit = true; }
+
+private:
+	void run() override
+	{
+		while (!m_quit)
+		{
+			writePendingEvents();
+			msleep(20);
+		}
+	}
+
+	std::atomic_bool m_quit{false};
+};
+
+std::unique_ptr<TraceWriter> s_writer;
+
+} // namespace
+
+
+
+
+std::atomic_bool AudioEngineTracer::s_enabled{false};
+
+
+
+
+void AudioEngineTracer::start(const QString& outputFile)
+{
+	if (s_started) { return; }
+
+	s_outputFile.setFileName(outputFile);
+	if (!s_outputFile.open(QFile::WriteOnly | QFile::Truncate))
+	{
+		qWarning("Could not open trace output file %s", qPrintable(outputFile));
+		return;
+	}
+	s_outputFile.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	s_started = true;
+	s_startTime = std::chrono::steady_clock::now();
+	s_writer = std::make_unique<TraceWriter>();
+	s_writer->start(QThread::LowPriority);
+	s_enabled = true;
+}
+
+
+
+
+void AudioEngineTracer::stop()
+{
+	if (!s_writer) { return; }
+
+	s_enabled = false;
+	s_writer->quit();
+	s_writer->wait();
+	s_writer.reset();
+	writePendingEvents();
+
+	// name the threads, and tell how many events got lost
+	const int count = std::min(s_threadBuffers.count.load(std::memory_order_acquire), MaxThreads);
+	for (int i = 0; i < count; ++i)
+	{
+		const ThreadBuffer* thread = s_threadBuffers.buffers[i].load(std::memory_order_acquire);
+		if (!thread) { continue; }
+
+		writeEvent(QString("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+			.arg(thread->tid).arg(thread->name).toUtf8());
+		if (thread->dropped > 0)
+		{
+			qWarning("Tracing: dropped %d events of thread %s", thread->dropped.load(), qPrintable(thread->name));
+		}
+	}
+
+	s_outputFile.write("\n]}\n");
+	s_outputFile.close();
+}
+
+
+
+
+std::int64_t AudioEngineTracer::now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+
+
+
+void AudioEngineTracer::record(const char* name, int index, std::int64_t begin, std::int64_t end)
+{
+	ThreadBuffer* thread = t_threadBuffer;
+	if (!thread)
+	{
+		// first event of this thread - the only time we allocate
+		if (s_threadBuffers.count.load(std::memory_order_relaxed) >= MaxThreads) { return; }
+		const int tid = s_threadBuffers.count.fetch_add(1, std::memory_order_acq_rel);
+		if (tid >= MaxThreads) { return; }
+
+		const size_t worker = AudioEngineWorkerThread::currentWorker();
+		const auto app = QCoreApplication::instance();
+		const QString threadName = app && QThread::currentThread() == app->thread()
+			? QString("GUI")
+			: worker + 1 < AudioEngineWorkerThread::workerCount()
+			? QString("Worker %1").arg(worker)
+			: QString("Audio engine %1").arg(tid);
+		thread = new ThreadBuffer(tid, threadName);
+		s_threadBuffers.buffers[tid].store(thread, std::memory_order_release);
+		t_threadBuffer = thread;
+	}
+
+	const TraceEvent event{name, index, begin, end};
+	if (thread->ring.write(&event, 1) == 0)
+	{
+		++thread->dropped;
+	}
+}
+
+
+} // namespace lmms
@@ -26,28 +26,198 @@
 
 #include <QDebug>
 #include <QMutex>
+#include <QStringList>
 #include <QWaitCondition>
 
+#include <algorithm>
+#include <cstdint>
+
 #include "denormals.h"
+#include "lmmsconfig.h"
 #include "AudioEngine.h"
 #include "MemoryManager.h"
+#include "PeriodArena.h"
+#include "RealtimeChecker.h"
 #include "ThreadableJob.h"
 
 #if __SSE__
 #include <xmmintrin.h>
 #endif
 
+#ifdef LMMS_HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+#ifdef LMMS_HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
 namespace lmms
 {
 
 AudioEngineWorkerThread::JobQueue AudioEngineWorkerThread::globalJobQueue;
 QWaitCondition * AudioEngineWorkerThread::queueReadyWaitCond = nullptr;
 QList<AudioEngineWorkerThread *> AudioEngineWorkerThread::workerThreads;
+std::atomic<AudioEngineWorkerThread::WaitPolicy> AudioEngineWorkerThread::s_waitPolicy =
+	AudioEngineWorkerThread::WaitPolicy::Hybrid;
+std::atomic_int AudioEngineWorkerThread::s_stage = 0;
+
+// held while starting a stage and while workers check whether to sleep
+static QMutex s_stageMutex;
+
+// index of the worker queue owned by the calling thread, if any
+static constexpr size_t NoWorker = static_cast<size_t>(-1);
+static thread_local size_t s_currentWorker = NoWorker;
+
+// number of pause instructions to spin for before going to sleep when using
+// WaitPolicy::Hybrid - roughly a few hundred microseconds on current CPUs
+static constexpr int HybridSpinIterations = 4096;
+
+// returns a negative value if we should spin forever
+static int spinIterations()
+{
+	switch (AudioEngineWorkerThread::waitPolicy())
+	{
+		case AudioEngineWorkerThread::WaitPolicy::Spin: return -1;
+		case AudioEngineWorkerThread::WaitPolicy::Hybrid: return HybridSpinIterations;
+		case AudioEngineWorkerThread::WaitPolicy::Park: return 0;
+	}
+	return HybridSpinIterations;
+}
+
+static inline void pause()
+{
+#ifdef __SSE__
+	_mm_pause();
+#endif
+}
+
+// scheduling options of the worker threads - every thread compares the
+// generation with the one it applied last and updates itself if needed
+static QMutex s_schedulingMutex;
+static AudioEngineWorkerThread::SchedulingOptions s_schedulingOptions;
+static std::atomic_int s_schedulingGeneration = 0;
+static thread_local int s_appliedSchedulingGeneration = 0;
+
+// upper bound for core indices, matches CPU_SETSIZE on Linux
+static constexpr int MaxCores = 1024;
+
+static void applySchedulingOptions()
+{
+	if (s_appliedSchedulingGeneration == s_schedulingGeneration)
+	{
+		return;
+	}
+
+	s_schedulingMutex.lock();
+	const AudioEngineWorkerThread::SchedulingOptions options = s_schedulingOptions;
+	s_appliedSchedulingGeneration = s_schedulingGeneration;
+	s_schedulingMutex.unlock();
+
+#if defined(LMMS_BUILD_LINUX) && defined(LMMS_HAVE_SCHED_H)
+	if (!options.cores.empty())
+	{
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		for (int core : options.cores)
+		{
+			CPU_SET(core, &mask);
+		}
+		if (sched_setaffinity(0, sizeof(mask), &mask) == -1)
+		{
+			qWarning("Could not set CPU affinity of audio worker thread");
+		}
+	}
+#endif
+
+#if (defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)) && defined(LMMS_HAVE_PTHREAD_H)
+	if (options.realtimePriority > 0)
+	{
+		struct sched_param param;
+		param.sched_priority = std::clamp(options.realtimePriority,
+			sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+		if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+		{
+			qWarning("Could not set realtime priority of audio worker thread");
+		}
+	}
+#endif
+}
+
+
+
+// implementation of the per-worker queues
+void AudioEngineWorkerThread::JobQueue::WorkerQueue::reset()
+{
+	m_readIndex = 0;
+	m_writeIndex = 0;
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::WorkerQueue::push( ThreadableJob * _job )
+{
+	const auto index = m_writeIndex++;
+	if (index >= JOB_QUEUE_SIZE)
+	{
+		return false;
+	}
+	m_items[index] = _job;
+	return true;
+}
+
+
+
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::WorkerQueue::pop()
+{
+	auto index = m_readIndex.load();
+	while (index < std::min(m_writeIndex.load(), JOB_QUEUE_SIZE))
+	{
+		ThreadableJob * job = m_items[index].load();
+		if (job == nullptr)
+		{
+			// slot was reserved but the job is not published yet
+			return nullptr;
+		}
+		if (m_readIndex.compare_exchange_weak(index, index + 1))
+		{
+			m_items[index] = nullptr;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+
+
 
 // implementation of internal JobQueue
+void AudioEngineWorkerThread::JobQueue::addWorker( size_t worker )
+{
+	while (m_queues.size() <= worker)
+	{
+		m_queues.push_back(std::make_unique<WorkerQueue>());
+		m_fixedQueues.push_back(std::make_unique<WorkerQueue>());
+	}
+}
+
+
+
+
 void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 {
-	m_writeIndex = 0;
+	for (const auto& queue : m_queues)
+	{
+		queue->reset();
+	}
+	for (const auto& queue : m_fixedQueues)
+	{
+		queue->reset();
+	}
+	m_nextQueue = 0;
+	m_itemsQueued = 0;
 	m_itemsDone = 0;
 	m_opMode = _opMode;
 }
@@ -55,43 +225,124 @@ void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 
 
 
-void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
+bool AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 {
 	if( _job->requiresProcessing() )
 	{
 		// update job state
 		_job->queue();
-		// actually queue the job via atomic operations
-		auto index = m_writeIndex++;
-		if (index < JOB_QUEUE_SIZE) {
-			m_items[index] = _job;
-		} else {
+		++m_itemsQueued;
+
+		const size_t numQueues = m_queues.size();
+		if (const void* affinity = _job->workerAffinity())
+		{
+			// the same worker in every period, Fibonacci hashing spreads
+			// the keys although pointers are aligned
+			const auto hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(affinity))
+				* 0x9e3779b97f4a7c15;
+			if (m_fixedQueues[(hash >> 32) % numQueues]->push(_job))
+			{
+				return true;
+			}
 			qWarning() << "Job queue is full!";
-			++m_itemsDone;
+			finishJob();
+			return false;
+		}
+
+		// jobs spawned by other jobs (e.g. mixer channels whose inputs have
+		// been processed) stay with the current worker, as their input is
+		// still hot in its cache - everything else is spread evenly
+		size_t queue = m_opMode == OperationMode::Dynamic && s_currentWorker < numQueues
+			? s_currentWorker
+			: m_nextQueue++ % numQueues;
+
+		for (size_t i = 0; i < numQueues; ++i)
+		{
+			if (m_queues[(queue + i) % numQueues]->push(_job))
+			{
+				return true;
+			}
 		}
+		qWarning() << "Job queue is full!";
+		finishJob();
 	}
+	return false;
 }
 
 
 
-void AudioEngineWorkerThread::JobQueue::run()
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::nextJob( size_t _worker )
 {
-	bool processedJob = true;
-	while (processedJob && m_itemsDone < m_writeIndex)
+	const size_t numQueues = m_queues.size();
+	// jobs bound to us first, as no one else can process them
+	if (_worker < numQueues)
 	{
-		processedJob = false;
-		for( int i = 0; i < m_writeIndex && i < JOB_QUEUE_SIZE; ++i )
+		if (ThreadableJob * job = m_fixedQueues[_worker]->pop())
 		{
-			ThreadableJob * job = m_items[i].exchange(nullptr);
-			if( job )
-			{
-				job->process();
-				processedJob = true;
-				++m_itemsDone;
-			}
+			return job;
+		}
+	}
+	// then our own queue, then steal from the others
+	for (size_t i = 0; i < numQueues; ++i)
+	{
+		if (ThreadableJob * job = m_queues[(_worker + i) % numQueues]->pop())
+		{
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+
+
+
+void AudioEngineWorkerThread::JobQueue::run( size_t _worker )
+{
+	while (m_itemsDone < m_itemsQueued)
+	{
+		ThreadableJob * job = nextJob(_worker);
+		if (job == nullptr)
+		{
+			// all remaining jobs are in progress on other workers
+			break;
+		}
+		{
+			RealtimeChecker::Scope realtimeScope;
+			job->process();
 		}
-		// always exit loop if we're not in dynamic mode
-		processedJob = processedJob && ( m_opMode == OperationMode::Dynamic );
+		finishJob();
+	}
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::runOne( size_t _worker )
+{
+	ThreadableJob * job = nextJob(_worker);
+	if (job == nullptr)
+	{
+		return false;
+	}
+	{
+		RealtimeChecker::Scope realtimeScope;
+		job->process();
+	}
+	finishJob();
+	return true;
+}
+
+
+
+
+void AudioEngineWorkerThread::JobQueue::finishJob()
+{
+	if (++m_itemsDone >= m_itemsQueued && m_waiting)
+	{
+		m_doneMutex.lock();
+		m_doneCond.wakeAll();
+		m_doneMutex.unlock();
 	}
 }
 
@@ -100,11 +351,23 @@ void AudioEngineWorkerThread::JobQueue::run()
 
 void AudioEngineWorkerThread::JobQueue::wait()
 {
-	while (m_itemsDone < m_writeIndex)
+	const int spins = spinIterations();
+	for (int i = 0; hasPendingJobs(); ++i)
 	{
-#ifdef __SSE__
-		_mm_pause();
-#endif
+		if (spins >= 0 && i >= spins)
+		{
+			// stop burning the CPU and sleep until the last job is done
+			m_doneMutex.lock();
+			m_waiting = true;
+			while (hasPendingJobs())
+			{
+				m_doneCond.wait(&m_doneMutex);
+			}
+			m_waiting = false;
+			m_doneMutex.unlock();
+			return;
+		}
+		pause();
 	}
 }
 
@@ -116,6 +379,7 @@ void AudioEngineWorkerThread::JobQueue::wait()
 
 AudioEngineWorkerThread::AudioEngineWorkerThread( AudioEngine* audioEngine ) :
 	QThread( audioEngine ),
+	m_index( workerThreads.size() ),
 	m_quit( false )
 {
 	// initialize global static data
@@ -129,6 +393,9 @@ AudioEngineWorkerThread::AudioEngineWorkerThread( AudioEngine* audioEngine ) :
 	// AudioEngineWorkerThread::startAndWaitForJobs() for details
 	workerThreads << this;
 
+	// each worker owns one queue, including the one processed inline
+	globalJobQueue.addWorker( m_index );
+
 	resetJobQueue();
 }
 
@@ -152,31 +419,179 @@ void AudioEngineWorkerThread::quit()
 
 
 
+AudioEngineWorkerThread::WaitPolicy AudioEngineWorkerThread::waitPolicyFromName( const QString & name )
+{
+	if (name == "spin") { return WaitPolicy::Spin; }
+	if (name == "park") { return WaitPolicy::Park; }
+	return WaitPolicy::Hybrid;
+}
+
+
+
+
+size_t AudioEngineWorkerThread::currentWorker()
+{
+	return s_currentWorker < workerCount() ? s_currentWorker : workerCount();
+}
+
+
+
+
+void AudioEngineWorkerThread::setSchedulingOptions( const SchedulingOptions & options )
+{
+	s_schedulingMutex.lock();
+	s_schedulingOptions = options;
+	++s_schedulingGeneration;
+	s_schedulingMutex.unlock();
+
+	// make sleeping workers apply the options right away
+	if (queueReadyWaitCond)
+	{
+		queueReadyWaitCond->wakeAll();
+	}
+}
+
+
+
+
+void AudioEngineWorkerThread::avoidWorkerCores()
+{
+#if defined(LMMS_BUILD_LINUX) && defined(LMMS_HAVE_SCHED_H)
+	s_schedulingMutex.lock();
+	const std::vector<int> cores = s_schedulingOptions.cores;
+	s_schedulingMutex.unlock();
+
+	cpu_set_t mask;
+	if (cores.empty() || sched_getaffinity(0, sizeof(mask), &mask) == -1)
+	{
+		return;
+	}
+	for (int core : cores)
+	{
+		CPU_CLR(core, &mask);
+	}
+	// don't leave the thread without any core to run on
+	if (CPU_COUNT(&mask) > 0)
+	{
+		sched_setaffinity(0, sizeof(mask), &mask);
+	}
+#endif
+}
+
+
+
+
+std::vector<int> AudioEngineWorkerThread::coresFromList( const QString & list )
+{
+	std::vector<int> cores;
+	for (const QString & range : list.split(','))
+	{
+		if (range.trimmed().isEmpty())
+		{
+			continue;
+		}
+		const QStringList bounds = range.trimmed().split('-');
+		bool firstOk = false;
+		bool lastOk = false;
+		const int first = bounds.first().toInt(&firstOk);
+		const int last = bounds.size() == 2 ? bounds.last().toInt(&lastOk) : first;
+		if (!firstOk || (bounds.size() == 2 && !lastOk) || bounds.size() > 2)
+		{
+			qWarning("Ignoring invalid CPU core range \"%s\"", qPrintable(range));
+			continue;
+		}
+		for (int core = std::max(first, 0); core <= last && core < MaxCores; ++core)
+		{
+			if (std::find(cores.begin(), cores.end(), core) == cores.end())
+			{
+				cores.push_back(core);
+			}
+		}
+	}
+	std::sort(cores.begin(), cores.end());
+	return cores;
+}
+
+
+
+
 void AudioEngineWorkerThread::startAndWaitForJobs()
 {
+	s_stageMutex.lock();
+	++s_stage;
 	queueReadyWaitCond->wakeAll();
+	s_stageMutex.unlock();
 	// The last worker-thread is never started. Instead it's processed "inline"
 	// i.e. within the global AudioEngine thread. This way we can reduce latencies
 	// that otherwise would be caused by synchronizing with another thread.
-	globalJobQueue.run();
+	s_currentWorker = workerThreads.size() - 1;
+	applySchedulingOptions();
+	globalJobQueue.run( s_currentWorker );
 	globalJobQueue.wait();
 }
 
 
 
 
+bool AudioEngineWorkerThread::processOneJob()
+{
+	if (globalJobQueue.runOne( currentWorker() ))
+	{
+		return true;
+	}
+	pause();
+	return false;
+}
+
+
+
+
 void AudioEngineWorkerThread::run()
 {
 	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
 	disable_denormals();
 
-	QMutex m;
+	s_currentWorker = m_index;
+	PeriodArena::attachThread();
+
+	int stage = s_stage;
 	while( m_quit == false )
 	{
-		m.lock();
-		queueReadyWaitCond->wait( &m );
-		globalJobQueue.run();
-		m.unlock();
+		applySchedulingOptions();
+
+		// the next stage usually starts shortly after the last one, so
+		// look for new jobs for a while before going to sleep
+		const int spins = spinIterations();
+		for (int i = 0; (spins < 0 || i < spins) && m_quit == false; ++i)
+		{
+			if (globalJobQueue.hasPendingJobs())
+			{
+				stage = s_stage;
+				globalJobQueue.run( m_index );
+				i = 0;
+			}
+			pause();
+		}
+		if( m_quit )
+		{
+			break;
+		}
+
+		// only sleep if we looked for jobs in the current stage already, the
+		// ones bound to us would wait for us otherwise
+		s_stageMutex.lock();
+		if (stage == s_stage && m_quit == false)
+		{
+			queueReadyWaitCond->wait( &s_stageMutex );
+		}
+		// we may also have been woken to apply new scheduling options
+		const bool nextStage = stage != s_stage;
+		stage = s_stage;
+		s_stageMutex.unlock();
+		if (nextStage)
+		{
+			globalJobQueue.run( m_index );
+		}
 	}
 }
 
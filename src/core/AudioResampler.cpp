@@ -24,17 +24,91 @@
 
 #include "AudioResampler.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <samplerate.h>
 #include <stdexcept>
 #include <string>
 
+#include "interpolation.h"
+#include "lmms_constants.h"
+
 namespace lmms {
 
+namespace {
+
+constexpr int SincTaps = 16;
+constexpr int SincPhases = 256;
+
+//! The kernels for SincPhases + 1 evenly spaced positions between two input frames. Each
+//! kernel starts SincTaps / 2 - 1 frames before the position and is normalized to unity gain.
+using SincTable = std::array<std::array<float, SincTaps>, SincPhases + 1>;
+
+auto makeSincTable(double cutoff) -> SincTable
+{
+	auto table = SincTable{};
+	for (int phase = 0; phase <= SincPhases; ++phase)
+	{
+		auto& kernel = table[phase];
+		auto sum = 0.0;
+		for (int tap = 0; tap < SincTaps; ++tap)
+		{
+			const auto x = tap - (SincTaps / 2 - 1) - static_cast<double>(phase) / SincPhases;
+			const auto sinc = x == 0 ? 1.0 : std::sin(D_PI * cutoff * x) / (D_PI * cutoff * x);
+
+			// Blackman window over the SincTaps frames around the position
+			const auto n = (x + SincTaps / 2) / SincTaps;
+			const auto window = 0.42 - 0.5 * std::cos(D_2PI * n) + 0.08 * std::cos(2 * D_2PI * n);
+
+			kernel[tap] = static_cast<float>(sinc * window);
+			sum += kernel[tap];
+		}
+		for (auto& coefficient : kernel) { coefficient = static_cast<float>(coefficient / sum); }
+	}
+	return table;
+}
+
+//! Tables are made for every quarter of an octave
+constexpr int SincTablesPerOctave = 4;
+constexpr int SincTableCount = 2 * SincTablesPerOctave + 1;
+
+//! A table for playing at the same or a lower pitch, and more with lower cutoffs
+//! against aliasing when playing up to two octaves higher
+auto sincTables() -> const std::array<SincTable, SincTableCount>&
+{
+	static const auto s_tables = [] {
+		auto tables = std::array<SincTable, SincTableCount>{};
+		for (int i = 0; i < SincTableCount; ++i)
+		{
+			tables[i] = makeSincTable(0.9 * std::exp2(-static_cast<double>(i) / SincTablesPerOctave));
+		}
+		return tables;
+	}();
+	return s_tables;
+}
+
+//! The table with the highest cutoff that doesn't alias at @p ratio
+auto sincTable(double ratio) -> const SincTable&
+{
+	const auto index = ratio >= 1 ? 0 : static_cast<int>(std::ceil(-std::log2(ratio) * SincTablesPerOctave - 1e-9));
+	return sincTables()[std::min(index, SincTableCount - 1)];
+}
+
+} // namespace
+
 AudioResampler::AudioResampler(int interpolationMode, int channels)
 	: m_interpolationMode(interpolationMode)
 	, m_channels(channels)
-	, m_state(src_new(interpolationMode, channels, &m_error))
 {
+	if (interpolationMode == CubicHermite || interpolationMode == ShortSinc)
+	{
+		sincTables();
+		m_history.assign((SincTaps - 1) * channels, 0.0f);
+		return;
+	}
+
+	m_state = src_new(interpolationMode, channels, &m_error);
 	if (!m_state)
 	{
 		const auto errorMessage = std::string{src_strerror(m_error)};
@@ -45,12 +119,52 @@ AudioResampler::AudioResampler(int interpolationMode, int channels)
 
 AudioResampler::~AudioResampler()
 {
-	src_delete(m_state);
+	if (m_state) { src_delete(m_state); }
+}
+
+void AudioResampler::reset()
+{
+	if (m_state)
+	{
+		src_reset(m_state);
+		return;
+	}
+	std::fill(m_history.begin(), m_history.end(), 0.0f);
+	m_position = 0;
 }
 
 auto AudioResampler::resample(const float* in, long inputFrames, float* out, long outputFrames, double ratio)
 	-> ProcessResult
 {
+	if (m_interpolationMode == CubicHermite)
+	{
+		return resampleBuiltIn<4>(in, inputFrames, out, outputFrames, ratio,
+			[](const float* x, int stride, float frac) {
+				return hermiteInterpolate(x[0], x[stride], x[2 * stride], x[3 * stride], frac);
+			});
+	}
+	if (m_interpolationMode == ShortSinc)
+	{
+		const auto& table = sincTable(ratio);
+		return resampleBuiltIn<SincTaps>(in, inputFrames, out, outputFrames, ratio,
+			[&table](const float* x, int stride, float frac) {
+				// blend the kernels of the nearest two phases
+				const auto phase = frac * SincPhases;
+				const auto index = std::min(static_cast<int>(phase), SincPhases - 1);
+				const auto blend = phase - index;
+				const auto& k0 = table[index];
+				const auto& k1 = table[index + 1];
+				auto sum0 = 0.0f;
+				auto sum1 = 0.0f;
+				for (int tap = 0; tap < SincTaps; ++tap)
+				{
+					sum0 += k0[tap] * x[tap * stride];
+					sum1 += k1[tap] * x[tap * stride];
+				}
+				return sum0 + (sum1 - sum0) * blend;
+			});
+	}
+
 	auto data = SRC_DATA{};
 	data.data_in = in;
 	data.input_frames = inputFrames;
@@ -61,4 +175,45 @@ auto AudioResampler::resample(const float* in, long inputFrames, float* out, lon
 	return {src_process(m_state, &data), data.input_frames_used, data.output_frames_gen};
 }
 
+template<int Taps, class Kernel>
+auto AudioResampler::resampleBuiltIn(const float* in, long inputFrames, float* out, long outputFrames, double ratio,
+	Kernel kernel) -> ProcessResult
+{
+	// every output frame is made from the Taps input frames around it, the first
+	// Taps / 2 - 1 of those may still be in the history
+	constexpr auto before = Taps / 2 - 1;
+	constexpr auto after = Taps / 2;
+	const auto historyFrames = static_cast<long>(m_history.size()) / m_channels;
+
+	m_input.resize((historyFrames + inputFrames) * m_channels);
+	std::copy(m_history.begin(), m_history.end(), m_input.begin());
+	std::copy_n(in, inputFrames * m_channels, m_input.begin() + m_history.size());
+
+	const auto step = 1.0 / ratio;
+	auto position = m_position;
+	long outputFramesGenerated = 0;
+	while (outputFramesGenerated < outputFrames)
+	{
+		const auto frame = static_cast<long>(position);
+		if (frame + after >= inputFrames) { break; }
+
+		const auto frac = static_cast<float>(position - frame);
+		const float* x = m_input.data() + (historyFrames + frame - before) * m_channels;
+		for (int channel = 0; channel < m_channels; ++channel)
+		{
+			out[outputFramesGenerated * m_channels + channel] = kernel(x + channel, m_channels, frac);
+		}
+		++outputFramesGenerated;
+		position += step;
+	}
+
+	// what's before the next output frame isn't needed anymore, except for the history
+	const auto inputFramesUsed = std::min(static_cast<long>(position), inputFrames);
+	m_position = position - inputFramesUsed;
+	std::copy_n(m_input.begin() + inputFramesUsed * m_channels, m_history.size(), m_history.begin());
+
+	return {0, inputFramesUsed, outputFramesGenerated};
+}
+
+
 } // namespace lmms
@@ -24,6 +24,8 @@
 
 #include "AutomatableModel.h"
 
+#include <algorithm>
+
 #include "lmms_math.h"
 
 #include "AudioEngine.h"
@@ -53,10 +55,13 @@ AutomatableModel::AutomatableModel(
 	m_valueChanged( false ),
 	m_setValueDepth( 0 ),
 	m_hasStrictStepSize( false ),
+	m_linkedValueChanged( false ),
 	m_controllerConnection( nullptr ),
 	m_valueBuffer( static_cast<int>( Engine::audioEngine()->framesPerPeriod() ) ),
 	m_lastUpdatedPeriod( -1 ),
 	m_hasSampleExactData(false),
+	m_automatedPeriod( -1 ),
+	m_automatedFrames( 0 ),
 	m_useControllerValue(true)
 
 {
@@ -71,8 +76,10 @@ AutomatableModel::~AutomatableModel()
 {
 	while( m_linkedModels.empty() == false )
 	{
-		m_linkedModels.back()->unlinkModel(this);
+		AutomatableModel* model = m_linkedModels.back();
+		model->unlinkModel(this);
 		m_linkedModels.erase( m_linkedModels.end() - 1 );
+		model->regroupLinkedModels();
 	}
 
 	if( m_controllerConnection )
@@ -304,16 +311,7 @@ void AutomatableModel::setValue( const float value )
 		// add changes to history so user can undo it
 		addJournalCheckPoint();
 
-		// notify linked models
-		for (const auto& linkedModel : m_linkedModels)
-		{
-			if (linkedModel->m_setValueDepth < 1 && linkedModel->fittedValue(value) != linkedModel->m_value)
-			{
-				bool journalling = linkedModel->testAndSetJournalling(isJournalling());
-				linkedModel->setValue(value);
-				linkedModel->setJournalling(journalling);
-			}
-		}
+		setLinkedValues( value, false );
 		m_valueChanged = true;
 		emit dataChanged();
 	}
@@ -387,19 +385,125 @@ void AutomatableModel::setAutomatedValue( const float value )
 
 	if( oldValue != m_value )
 	{
-		// notify linked models
-		for (const auto& linkedModel : m_linkedModels)
+		setLinkedValues( value, true );
+		m_valueChanged = true;
+		emit dataChanged();
+	}
+	--m_setValueDepth;
+}
+
+
+
+
+void AutomatableModel::setAutomatedValues( const float* values, f_cnt_t offset, fpp_t frames )
+{
+	writeAutomatedValues( values, offset, frames );
+
+	if( m_linkGroup )
+	{
+		for( AutomatableModel* model : m_linkGroup->models )
 		{
-			if (!(linkedModel->controllerConnection()) && linkedModel->m_setValueDepth < 1 &&
-					linkedModel->fittedValue(m_value) != linkedModel->m_value)
+			if( model != this && !model->controllerConnection() )
 			{
-				linkedModel->setAutomatedValue(value);
+				model->writeAutomatedValues( values, offset, frames );
 			}
 		}
-		m_valueChanged = true;
-		emit dataChanged();
 	}
-	--m_setValueDepth;
+}
+
+
+
+
+void AutomatableModel::writeAutomatedValues( const float* values, f_cnt_t offset, fpp_t frames )
+{
+	QMutexLocker m( &m_valueBufferMutex );
+	if( m_automatedPeriod != s_periodCounter )
+	{
+		m_automatedPeriod = s_periodCounter;
+		m_automatedFrames = 0;
+	}
+
+	const auto length = static_cast<f_cnt_t>( m_valueBuffer.length() );
+	offset = std::min( offset, length );
+	frames = std::min<f_cnt_t>( frames, length - offset );
+
+	float* buffer = m_valueBuffer.values();
+	if( offset > m_automatedFrames )
+	{
+		std::fill( buffer + m_automatedFrames, buffer + offset, m_value );
+	}
+	for( fpp_t i = 0; i < frames; ++i )
+	{
+		buffer[offset + i] = fittedValue( scaledValue( values[i] ) );
+	}
+	m_automatedFrames = offset + frames;
+}
+
+
+
+
+void AutomatableModel::setLinkedValues( const float value, const bool automated )
+{
+	// kept, in case a model is unlinked while being told
+	const auto group = m_linkGroup;
+	if( !group )
+	{
+		return;
+	}
+
+	// linking a knob with the same one of many instruments would otherwise
+	// have each of them set the others and signal it once more every time
+	for( AutomatableModel* model : group->models )
+	{
+		if( model == this || model->m_setValueDepth > 0 || ( automated && model->controllerConnection() ) )
+		{
+			continue;
+		}
+
+		const float next = model->fittedValue( automated ? model->scaledValue( value ) : value );
+		if( next != model->m_value )
+		{
+			model->m_oldValue = model->m_value;
+			model->m_value = next;
+			model->m_valueChanged = true;
+			model->m_linkedValueChanged = true;
+			if( !automated )
+			{
+				const bool journalling = model->testAndSetJournalling( isJournalling() );
+				model->addJournalCheckPoint();
+				model->setJournalling( journalling );
+			}
+		}
+	}
+
+	for( AutomatableModel* model : group->models )
+	{
+		if( model->m_linkedValueChanged )
+		{
+			model->m_linkedValueChanged = false;
+			emit model->dataChanged();
+		}
+	}
+}
+
+
+
+
+void AutomatableModel::notifyLinkedModels()
+{
+	const auto group = m_linkGroup;
+	if( !group )
+	{
+		return;
+	}
+
+	for( AutomatableModel* model : group->models )
+	{
+		if( model != this )
+		{
+			emit model->dataChanged();
+		}
+	}
 }
 
 
@@ -477,12 +581,6 @@ void AutomatableModel::linkModel( AutomatableModel* model )
 	if (!containsModel && model != this)
 	{
 		m_linkedModels.push_back( model );
-
-		if( !model->hasLinkedModels() )
-		{
-			QObject::connect( this, SIGNAL(dataChanged()),
-					model, SIGNAL(dataChanged()), Qt::DirectConnection );
-		}
 	}
 }
 
@@ -522,6 +620,7 @@ void AutomatableModel::linkModels( AutomatableModel* model1, AutomatableModel* m
 		// finally: link the models
 		model1->linkModel( model2 );
 		model2->linkModel( model1 );
+		model1->regroupLinkedModels();
 	}
 }
 
@@ -532,6 +631,38 @@ void AutomatableModel::unlinkModels( AutomatableModel* model1, AutomatableModel*
 {
 	model1->unlinkModel( model2 );
 	model2->unlinkModel( model1 );
+	// they may still be linked through others
+	model1->regroupLinkedModels();
+	model2->regroupLinkedModels();
+}
+
+
+
+
+void AutomatableModel::regroupLinkedModels()
+{
+	auto group = std::make_shared<LinkGroup>();
+	group->models.push_back( this );
+	for( std::size_t i = 0; i < group->models.size(); ++i )
+	{
+		for( AutomatableModel* model : group->models[i]->m_linkedModels )
+		{
+			if( std::find( group->models.begin(), group->models.end(), model ) == group->models.end() )
+			{
+				group->models.push_back( model );
+			}
+		}
+	}
+
+	if( group->models.size() == 1 )
+	{
+		m_linkGroup.reset();
+		return;
+	}
+	for( AutomatableModel* model : group->models )
+	{
+		model->m_linkGroup = group;
+	}
 }
 
 
@@ -539,7 +670,9 @@ void AutomatableModel::unlinkModels( AutomatableModel* model1, AutomatableModel*
 
 void AutomatableModel::unlinkAllModels()
 {
-	for( AutomatableModel* model : m_linkedModels )
+	// unlinking takes them out of m_linkedModels
+	const auto linkedModels = m_linkedModels;
+	for( AutomatableModel* model : linkedModels )
 	{
 		unlinkModels( this, model );
 	}
@@ -553,11 +686,24 @@ void AutomatableModel::setControllerConnection( ControllerConnection* c )
 	m_controllerConnection = c;
 	if( c )
 	{
+		// so a controller that only controls a controller nothing reads
+		// knows it doesn't need to tell anybody about its changes
+		Controller* consumer = nullptr;
+		for( Model* m = parentModel(); m && !consumer; m = m->parentModel() )
+		{
+			consumer = dynamic_cast<Controller*>( m );
+		}
+		c->setConsumer( consumer );
+
 		QObject::connect( m_controllerConnection, SIGNAL(valueChanged()),
 				this, SIGNAL(dataChanged()), Qt::DirectConnection );
+		// the linked models play what the controller says as well
+		QObject::connect( m_controllerConnection, SIGNAL(valueChanged()),
+				this, SLOT(notifyLinkedModels()), Qt::DirectConnection );
 		QObject::connect( m_controllerConnection, SIGNAL(destroyed()), this, SLOT(unlinkControllerConnection()));
 		m_valueChanged = true;
 		emit dataChanged();
+		notifyLinkedModels();
 	}
 }
 
@@ -613,10 +759,28 @@ ValueBuffer * AutomatableModel::valueBuffer()
 
 	float val = m_value; // make sure our m_value doesn't change midway
 
+	if( m_automatedPeriod == s_periodCounter )
+	{
+		// sample-exact automation, the rest of the period stays at the last value
+		std::fill( m_valueBuffer.begin() + m_automatedFrames, m_valueBuffer.end(), val );
+		m_automatedFrames = m_valueBuffer.length();
+		m_oldValue = val;
+		m_lastUpdatedPeriod = s_periodCounter;
+		m_hasSampleExactData = true;
+		return &m_valueBuffer;
+	}
+
 	ValueBuffer * vb;
 	if (m_controllerConnection && m_useControllerValue && m_controllerConnection->getController()->isSampleExact())
 	{
 		vb = m_controllerConnection->valueBuffer();
+		if( vb && m_controllerConnection->getController()->isConstant() )
+		{
+			// value() has the same as every frame of the buffer
+			m_lastUpdatedPeriod = s_periodCounter;
+			m_hasSampleExactData = false;
+			return nullptr;
+		}
 		if( vb )
 		{
 			float * values = vb->values();
@@ -657,6 +821,13 @@ ValueBuffer * AutomatableModel::valueBuffer()
 				lm->controllerConnection()->getController()->isSampleExact())
 		{
 			vb = lm->valueBuffer();
+			if (!vb)
+			{
+				// the controller is constant, value() asks it
+				m_lastUpdatedPeriod = s_periodCounter;
+				m_hasSampleExactData = false;
+				return nullptr;
+			}
 			float * values = vb->values();
 			float * nvalues = m_valueBuffer.values();
 			for (int i = 0; i < vb->length(); i++)
@@ -784,11 +955,13 @@ void AutomatableModel::setUseControllerValue(bool b)
 	{
 		m_useControllerValue = true;
 		emit dataChanged();
+		notifyLinkedModels();
 	}
 	else if (m_controllerConnection && m_useControllerValue)
 	{
 		m_useControllerValue = false;
 		emit dataChanged();
+		notifyLinkedModels();
 	}
 }
 
@@ -26,6 +26,7 @@
 
 #include "AutomationClip.h"
 
+#include "AutomationIndex.h"
 #include "AutomationNode.h"
 #include "AutomationClipView.h"
 #include "AutomationTrack.h"
@@ -35,7 +36,9 @@
 #include "ProjectJournal.h"
 #include "Song.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace lmms
 {
@@ -133,6 +136,7 @@ bool AutomationClip::addObject( AutomatableModel * _obj, bool _search_dup )
 	}
 
 	m_objects.push_back(_obj);
+	AutomationIndex::invalidate();
 
 	connect( _obj, SIGNAL(destroyed(lmms::jo_id_t)),
 			this, SLOT(objectDestroyed(lmms::jo_id_t)),
@@ -156,6 +160,7 @@ void AutomationClip::setProgressionType(
 		_new_progression_type == ProgressionType::CubicHermite )
 	{
 		m_progressionType = _new_progression_type;
+		invalidateSegments();
 		emit dataChanged();
 	}
 }
@@ -173,6 +178,7 @@ void AutomationClip::setTension( QString _new_tension )
 	if( ok && nt > -0.01 && nt < 1.01 )
 	{
 		m_tension = nt;
+		invalidateSegments();
 	}
 }
 
@@ -575,91 +581,97 @@ void AutomationClip::applyDragValue()
 
 float AutomationClip::valueAt( const TimePos & _time ) const
 {
-	QMutexLocker m(&m_clipMutex);
+	return valueAt( static_cast<double>( _time.getTicks() ) );
+}
 
-	if( m_timeMap.isEmpty() )
-	{
-		return 0;
-	}
 
-	// If we have a node at that time, just return its value
-	if (m_timeMap.contains(_time))
-	{
-		// When the time is exactly the node's time, we want the inValue
-		return m_timeMap[_time].getInValue();
-	}
 
-	// lowerBound returns next value with equal or greater key. Since we already
-	// checked if the key contains a node, we know the returned node has a greater
-	// key than _time. Therefore we take the previous element to calculate the current value
-	timeMap::const_iterator v = m_timeMap.lowerBound(_time);
 
-	if( v == m_timeMap.begin() )
+float AutomationClip::valueAt( double time ) const
+{
+	QMutexLocker m(&m_clipMutex);
+
+	const std::vector<Segment> & segs = segments();
+	const std::size_t index = segmentAt( time );
+	if( index == segs.size() )
 	{
 		return 0;
 	}
-	if( v == m_timeMap.end() )
-	{
-		// When the time is after the last node, we want the outValue of it
-		return OUTVAL(v - 1);
-	}
 
-	return valueAt(v - 1, _time - POS(v - 1));
+	const Segment & s = segs[index];
+	// When the time is exactly the node's time, we want the inValue
+	return time == s.start
+		? s.inValue
+		: s.valueAt( static_cast<float>( time - s.start ) * s.invLength );
 }
 
 
 
 
-// This method will get the value at an offset from a node, so we use the outValue of
-// that node and the inValue of the next node for the calculations.
-float AutomationClip::valueAt( timeMap::const_iterator v, int offset ) const
+bool AutomationClip::valuesAt( double time, float timeStep, float * values, fpp_t frames ) const
 {
 	QMutexLocker m(&m_clipMutex);
 
-	// We never use it with offset 0, but doesn't hurt to return a correct
-	// value if we do
-	if (offset == 0) { return INVAL(v); }
+	const std::vector<Segment> & segs = segments();
+	if( segs.empty() || frames <= 0 )
+	{
+		return false;
+	}
 
-	if (m_progressionType == ProgressionType::Discrete)
+	const double last = time + static_cast<double>( timeStep ) * ( frames - 1 );
+	const std::size_t first = segmentAt( time );
+	if( first == segs.size() )
 	{
-		return OUTVAL(v);
+		if( last < segs.front().start ) { return false; }
 	}
-	else if( m_progressionType == ProgressionType::Linear )
+	else
 	{
-		float slope =
-			(INVAL(v + 1) - OUTVAL(v))
-			/ (POS(v + 1) - POS(v));
-
-		return OUTVAL(v) + offset * slope;
+		const Segment & s = segs[first];
+		if( s.isFlat() && last < s.end && ( time > s.start || s.inValue == s.c0 ) )
+		{
+			return false;
+		}
 	}
-	else /* ProgressionType::CubicHermite */
+
+	fpp_t frame = 0;
+	while( frame < frames )
 	{
-		// Implements a Cubic Hermite spline as explained at:
-		// http://en.wikipedia.org/wiki/Cubic_Hermite_spline#Unit_interval_.280.2C_1.29
-		//
-		// Note that we are not interpolating a 2 dimensional point over
-		// time as the article describes.  We are interpolating a single
-		// value: y.  To make this work we map the values of x that this
-		// segment spans to values of t for t = 0.0 -> 1.0 and scale the
-		// tangents _m1 and _m2
-		int numValues = (POS(v + 1) - POS(v));
-		float t = (float) offset / (float) numValues;
-		float m1 = OUTTAN(v) * numValues * m_tension;
-		float m2 = INTAN(v + 1) * numValues * m_tension;
-
-		auto t2 = pow(t, 2);
-		auto t3 = pow(t, 3);
-		return (2 * t3 - 3 * t2 + 1) * OUTVAL(v)
-			+ (t3 - 2 * t2 + t) * m1
-			+ (-2 * t3 + 3 * t2) * INVAL(v + 1)
-			+ (t3 - t2) * m2;
+		const double pos = time + static_cast<double>( timeStep ) * frame;
+		const std::size_t index = segmentAt( pos );
+		const int end = index == segs.size() ? segs.front().start : segs[index].end;
+
+		fpp_t count = 1;
+		while( frame + count < frames &&
+			time + static_cast<double>( timeStep ) * ( frame + count ) < end )
+		{
+			++count;
+		}
+
+		if( index == segs.size() )
+		{
+			// before the first node
+			std::fill( values + frame, values + frame + count, 0.f );
+		}
+		else
+		{
+			// no branches in here, so this gets vectorized
+			const Segment & s = segs[index];
+			const auto offset = static_cast<float>( pos - s.start );
+			for( fpp_t i = 0; i < count; ++i )
+			{
+				values[frame + i] = s.valueAt( ( offset + i * timeStep ) * s.invLength );
+			}
+			if( pos == s.start ) { values[frame] = s.inValue; }
+		}
+		frame += count;
 	}
+	return true;
 }
 
 
 
 
-float *AutomationClip::valuesAfter( const TimePos & _time ) const
+float *AutomationClip::valuesAfter( const TimePos & _time, int step ) const
 {
 	QMutexLocker m(&m_clipMutex);
 
@@ -669,12 +681,13 @@ float *AutomationClip::valuesAfter( const TimePos & _time ) const
 		return nullptr;
 	}
 
-	int numValues = POS(v + 1) - POS(v);
+	const int numValues = ( POS(v + 1) - POS(v) + step - 1 ) / step;
 	auto ret = new float[numValues];
 
-	for( int i = 0; i < numValues; i++ )
+	// the whole range is in one segment, so it's one curve to evaluate
+	if( !valuesAt( POS(v), static_cast<float>( step ), ret, numValues ) )
 	{
-		ret[i] = valueAt( v, i );
+		std::fill( ret, ret + numValues, valueAt( POS(v) ) );
 	}
 
 	return ret;
@@ -683,6 +696,94 @@ float *AutomationClip::valuesAfter( const TimePos & _time ) const
 
 
 
+const std::vector<AutomationClip::Segment> & AutomationClip::segments() const
+{
+	QMutexLocker m(&m_clipMutex);
+
+	if( !m_segmentsDirty )
+	{
+		return m_segments;
+	}
+
+	m_segments.clear();
+	m_segments.reserve( m_timeMap.size() );
+	for( timeMap::const_iterator v = m_timeMap.begin(); v != m_timeMap.end(); ++v )
+	{
+		Segment s;
+		s.start = POS(v);
+		s.inValue = INVAL(v);
+		s.c0 = OUTVAL(v);
+		s.c1 = s.c2 = s.c3 = 0;
+
+		if( v + 1 == m_timeMap.end() )
+		{
+			// after the last node we stay at its outValue
+			s.end = std::numeric_limits<int>::max();
+			s.invLength = 0;
+			m_segments.push_back( s );
+			break;
+		}
+
+		s.end = POS(v + 1);
+		const float length = s.end - s.start;
+		s.invLength = 1.f / length;
+
+		const float p0 = OUTVAL(v);
+		const float p1 = INVAL(v + 1);
+		if( m_progressionType == ProgressionType::Linear )
+		{
+			s.c1 = p1 - p0;
+		}
+		else if( m_progressionType == ProgressionType::CubicHermite )
+		{
+			// Implements a Cubic Hermite spline as explained at:
+			// http://en.wikipedia.org/wiki/Cubic_Hermite_spline#Unit_interval_.280.2C_1.29
+			//
+			// The tangents are per tick, so they're scaled to the length
+			// of the segment to interpolate over t = 0.0 -> 1.0. The Hermite
+			// basis functions are expanded into the coefficients of t.
+			const float m1 = OUTTAN(v) * length * m_tension;
+			const float m2 = INTAN(v + 1) * length * m_tension;
+			s.c1 = m1;
+			s.c2 = -3 * p0 - 2 * m1 + 3 * p1 - m2;
+			s.c3 = 2 * p0 + m1 - 2 * p1 + m2;
+		}
+		m_segments.push_back( s );
+	}
+
+	m_lastSegment = 0;
+	m_segmentsDirty = false;
+	return m_segments;
+}
+
+
+
+
+std::size_t AutomationClip::segmentAt( double time ) const
+{
+	const std::vector<Segment> & segs = segments();
+	if( segs.empty() || time < segs.front().start )
+	{
+		return segs.size();
+	}
+
+	// playback asks for the same segment or the next one most of the time
+	for( std::size_t index = m_lastSegment; index < segs.size() && index <= m_lastSegment + 1; ++index )
+	{
+		if( segs[index].start <= time && time < segs[index].end )
+		{
+			return m_lastSegment = index;
+		}
+	}
+
+	const auto it = std::upper_bound( segs.begin(), segs.end(), time,
+		[]( double t, const Segment & s ) { return t < s.start; } );
+	return m_lastSegment = ( it - segs.begin() ) - 1;
+}
+
+
+
+
 void AutomationClip::flipY(int min, int max)
 {
 	QMutexLocker m(&m_clipMutex);
@@ -936,6 +1037,7 @@ void AutomationClip::loadSettings( const QDomElement & _this )
 	}
 
 	if (shouldGenerateTangents) { generateTangents(); }
+	invalidateSegments();
 }
 
 
@@ -1066,6 +1168,7 @@ AutomationClip * AutomationClip::globalAutomationClip(
 
 void AutomationClip::resolveAllIDs()
 {
+	const auto journal = Engine::projectJournal();
 	auto l = combineAllTracks();
 	for (const auto& track : l)
 	{
@@ -1074,39 +1177,25 @@ void AutomationClip::resolveAllIDs()
 			for (const auto& clip : track->getClips())
 			{
 				auto a = dynamic_cast<AutomationClip*>(clip);
-				if( a )
+				// most clips have nothing left to resolve after being loaded once
+				if (!a || a->m_idsToResolve.empty()) { continue; }
+
+				for (const auto& id : a->m_idsToResolve)
 				{
-					for (const auto& id : a->m_idsToResolve)
+					// FIXME: Only look the ID itself up once the automation system gets fixed, the
+					// others are temporary fixes for https://github.com/LMMS/lmms/issues/3781 and
+					// https://github.com/LMMS/lmms/issues/4781
+					for (const auto candidate : {id, ProjectJournal::idFromSave(id), ProjectJournal::idToSave(id)})
 					{
-						JournallingObject* o = Engine::projectJournal()->journallingObject(id);
-						if( o && dynamic_cast<AutomatableModel *>( o ) )
-						{
-							a->addObject( dynamic_cast<AutomatableModel *>( o ), false );
-						}
-						else
+						if (auto model = dynamic_cast<AutomatableModel*>(journal->journallingObject(candidate)))
 						{
-							// FIXME: Remove this block once the automation system gets fixed
-							// This is a temporary fix for https://github.com/LMMS/lmms/issues/3781
-							o = Engine::projectJournal()->journallingObject(ProjectJournal::idFromSave(id));
-							if( o && dynamic_cast<AutomatableModel *>( o ) )
-							{
-								a->addObject( dynamic_cast<AutomatableModel *>( o ), false );
-							}
-							else
-							{
-								// FIXME: Remove this block once the automation system gets fixed
-								// This is a temporary fix for https://github.com/LMMS/lmms/issues/4781
-								o = Engine::projectJournal()->journallingObject(ProjectJournal::idToSave(id));
-								if( o && dynamic_cast<AutomatableModel *>( o ) )
-								{
-									a->addObject( dynamic_cast<AutomatableModel *>( o ), false );
-								}
-							}
+							a->addObject(model, false);
+							break;
 						}
 					}
-					a->m_idsToResolve.clear();
-					a->dataChanged();
 				}
+				a->m_idsToResolve.clear();
+				a->dataChanged();
 			}
 		}
 	}
@@ -1120,6 +1209,7 @@ void AutomationClip::clear()
 	QMutexLocker m(&m_clipMutex);
 
 	m_timeMap.clear();
+	invalidateSegments();
 
 	emit dataChanged();
 }
@@ -1147,6 +1237,7 @@ void AutomationClip::objectDestroyed( jo_id_t _id )
 			break;
 		}
 	}
+	AutomationIndex::invalidate();
 
 	emit dataChanged();
 }
@@ -1167,6 +1258,7 @@ void AutomationClip::cleanObjects()
 		else
 		{
 			it = m_objects.erase( it );
+			AutomationIndex::invalidate();
 		}
 	}
 }
@@ -1190,6 +1282,8 @@ void AutomationClip::generateTangents(timeMap::iterator it, int numToGenerate)
 {
 	QMutexLocker m(&m_clipMutex);
 
+	invalidateSegments();
+
 	for (int i = 0; i < numToGenerate && it != m_timeMap.end(); ++i, ++it)
 	{
 		// Skip the node if it has locked tangents (were manually edited)
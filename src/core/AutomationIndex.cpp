@@ -0,0 +1,189 @@
+/*
+ * AutomationIndex.cpp - find the automation clips that apply at some time
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AutomationIndex.h"
+
+#include <algorithm>
+
+#include "AutomationClip.h"
+#include "Engine.h"
+#include "PatternClip.h"
+#include "PatternStore.h"
+#include "PatternTrack.h"
+
+namespace lmms
+{
+
+
+std::atomic_int AutomationIndex::s_revision{0};
+
+
+
+void AutomationIndex::sourcesAt(const TrackList& tracks, TimePos time, Sources& sources)
+{
+	const int revision = s_revision;
+	if (revision != m_revision || tracks != m_tracks)
+	{
+		rebuild(tracks);
+		m_revision = revision;
+	}
+
+	// the clips starting after time don't matter yet
+	const std::size_t end = std::upper_bound(m_clips.begin(), m_clips.end(), time,
+		[](const TimePos& t, const Clip* clip) { return t < clip->startPosition(); }) - m_clips.begin();
+	const std::size_t none = m_clips.size();
+
+	// every model takes its value from the last clip automating it - unless
+	// that is muted or empty, then it's the one before and so on
+	m_slotClips.assign(m_models.size(), none);
+	m_slotSources.resize(m_models.size());
+	for (std::size_t slot = 0; slot < m_models.size(); ++slot)
+	{
+		const std::vector<std::size_t>& clips = m_modelClips[slot];
+		for (auto it = std::lower_bound(clips.begin(), clips.end(), end); it != clips.begin();)
+		{
+			const auto clip = static_cast<const AutomationClip*>(m_clips[*--it]);
+			if (clip->isMuted() || clip->getTrack()->isMuted() || !clip->hasAutomation()) { continue; }
+
+			m_slotSources[slot] = TrackContainer::automationSource(clip, time);
+			m_slotClips[slot] = *it;
+			break;
+		}
+	}
+
+	// the same goes for the clips of every pattern track, each of them
+	// always automates the same models
+	m_activePatterns.clear();
+	for (const auto& [track, clips] : m_patternClips)
+	{
+		if (track->isMuted()) { continue; }
+		for (auto it = std::lower_bound(clips.begin(), clips.end(), end); it != clips.begin();)
+		{
+			if (!m_clips[*--it]->isMuted())
+			{
+				m_activePatterns.push_back(*it);
+				break;
+			}
+		}
+	}
+
+	// a later clip takes precedence, no matter on which track it is
+	std::sort(m_activePatterns.begin(), m_activePatterns.end());
+	for (const std::size_t index : m_activePatterns)
+	{
+		const auto patSources = TrackContainer::patternAutomationSources(
+			static_cast<const PatternClip*>(m_clips[index]), time);
+		for (auto it = patSources.begin(); it != patSources.end(); ++it)
+		{
+			const std::size_t slot = slotOf(it.key());
+			if (slot >= m_slotClips.size())
+			{
+				m_slotClips.resize(slot + 1, none);
+				m_slotSources.resize(slot + 1);
+			}
+			if (m_slotClips[slot] == none || m_slotClips[slot] < index)
+			{
+				m_slotSources[slot] = it.value();
+				m_slotClips[slot] = index;
+			}
+		}
+	}
+
+	sources.clear();
+	for (std::size_t slot = 0; slot < m_slotClips.size(); ++slot)
+	{
+		if (m_slotClips[slot] != none)
+		{
+			sources.emplace_back(m_models[slot], m_slotSources[slot]);
+		}
+	}
+}
+
+
+
+
+void AutomationIndex::rebuild(const TrackList& tracks)
+{
+	m_tracks = tracks;
+	m_clips.clear();
+	m_models.clear();
+	m_modelClips.clear();
+	m_modelSlots.clear();
+	m_patternClips.clear();
+
+	for (Track* track : tracks)
+	{
+		switch (track->type())
+		{
+		case Track::Type::Automation:
+		case Track::Type::HiddenAutomation:
+		case Track::Type::Pattern:
+			m_clips.insert(m_clips.end(), track->getClips().begin(), track->getClips().end());
+			break;
+		default:
+			break;
+		}
+	}
+	// ordered like Track::getClipsInRange() would
+	std::stable_sort(m_clips.begin(), m_clips.end(), Clip::comparePosition);
+
+	for (std::size_t index = 0; index < m_clips.size(); ++index)
+	{
+		if (const auto clip = dynamic_cast<AutomationClip*>(m_clips[index]))
+		{
+			for (AutomatableModel* model : clip->objects())
+			{
+				if (model) { m_modelClips[slotOf(model)].push_back(index); }
+			}
+		}
+		else if (const auto pattern = dynamic_cast<PatternClip*>(m_clips[index]))
+		{
+			auto track = static_cast<PatternTrack*>(pattern->getTrack());
+			auto it = std::find_if(m_patternClips.begin(), m_patternClips.end(),
+				[track](const auto& clips) { return clips.first == track; });
+			if (it == m_patternClips.end())
+			{
+				it = m_patternClips.emplace(m_patternClips.end(), track, std::vector<std::size_t>{});
+			}
+			it->second.push_back(index);
+		}
+	}
+}
+
+
+
+
+std::size_t AutomationIndex::slotOf(AutomatableModel* model)
+{
+	const auto [it, added] = m_modelSlots.emplace(model, m_models.size());
+	if (added)
+	{
+		m_models.push_back(model);
+		m_modelClips.emplace_back();
+	}
+	return it->second;
+}
+
+
+} // namespace lmms
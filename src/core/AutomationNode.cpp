@@ -104,6 +104,26 @@ void AutomationNode::setOutValue(float value)
 	m_clip->generateTangents(it, 3);
 }
 
+/**
+ * @brief Sets the tangent of the left side of the node
+ * @param Float with the tangent for the inValue side
+ */
+void AutomationNode::setInTangent(float tangent)
+{
+	m_inTangent = tangent;
+	if (m_clip) { m_clip->invalidateSegments(); }
+}
+
+/**
+ * @brief Sets the tangent of the right side of the node
+ * @param Float with the tangent for the outValue side
+ */
+void AutomationNode::setOutTangent(float tangent)
+{
+	m_outTangent = tangent;
+	if (m_clip) { m_clip->invalidateSegments(); }
+}
+
 /**
  * @brief Resets the outValue so it matches inValue
 */
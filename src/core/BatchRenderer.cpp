@@ -0,0 +1,327 @@
+/*
+ * BatchRenderer.cpp - renders many projects with a pool of worker processes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "BatchRenderer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "Engine.h"
+#include "RenderManager.h"
+#include "Song.h"
+
+namespace lmms {
+
+namespace {
+
+// what a worker writes on its standard output for the renderer, everything
+// else it writes there is kept in case the project fails
+constexpr auto ProgressMessage = "lmms-batch progress ";
+constexpr auto DoneMessage = "lmms-batch done ";
+
+} // namespace
+
+
+
+
+BatchRenderer::BatchRenderer(const QString& listFile, int jobs, const QStringList& workerArguments) :
+	m_workerArguments(workerArguments)
+{
+	auto file = QFile{listFile};
+	if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		// relative paths are relative to the list
+		const auto listDir = QFileInfo{listFile}.absoluteDir();
+		auto stream = QTextStream{&file};
+		for (auto line = stream.readLine(); !line.isNull(); line = stream.readLine())
+		{
+			line = line.trimmed();
+			if (line.isEmpty() || line.startsWith('#')) { continue; }
+			m_projects << QDir::cleanPath(listDir.absoluteFilePath(line));
+		}
+	}
+	m_results.resize(m_projects.size());
+
+	for (auto i = 0; i < std::min(jobs, m_projects.size()); ++i)
+	{
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+
+	connect(&m_progressTimer, &QTimer::timeout, this, &BatchRenderer::printProgress);
+}
+
+
+
+
+BatchRenderer::~BatchRenderer()
+{
+	for (const auto& worker : m_workers)
+	{
+		if (!worker->process) { continue; }
+		worker->process->disconnect(this);
+		worker->process->kill();
+		worker->process->waitForFinished();
+	}
+}
+
+
+
+
+void BatchRenderer::start()
+{
+	printf("Rendering %d projects with %d jobs\n", m_projects.size(), static_cast<int>(m_workers.size()));
+
+	m_timer.start();
+	for (const auto& worker : m_workers)
+	{
+		startWorker(*worker);
+	}
+	m_progressTimer.start(200);
+}
+
+
+
+
+void BatchRenderer::startWorker(Worker& worker)
+{
+	worker.process = new QProcess(this);
+	worker.process->setProcessChannelMode(QProcess::MergedChannels);
+	worker.output.clear();
+
+	connect(worker.process, &QProcess::readyReadStandardOutput, this, [this, &worker] { readOutput(worker); });
+	connect(worker.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+		this, [this, &worker] { workerFinished(worker); });
+	connect(worker.process, &QProcess::errorOccurred, this, [this, &worker](QProcess::ProcessError error)
+	{
+		// there won't be a finished() for a worker that was never running
+		if (error == QProcess::FailedToStart) { workerFinished(worker); }
+	}, Qt::QueuedConnection);
+
+	worker.process->start(QCoreApplication::applicationFilePath(), m_workerArguments);
+	handOut(worker);
+}
+
+
+
+
+void BatchRenderer::handOut(Worker& worker)
+{
+	if (m_next == m_projects.size())
+	{
+		// the worker quits once it read everything
+		worker.process->closeWriteChannel();
+		return;
+	}
+
+	worker.project = m_next++;
+	worker.progress = 0;
+	worker.log.clear();
+	worker.timer.start();
+	worker.process->write((m_projects[worker.project] + '\n').toLocal8Bit());
+}
+
+
+
+
+void BatchRenderer::readOutput(Worker& worker)
+{
+	worker.output += worker.process->readAllStandardOutput();
+
+	for (auto end = worker.output.indexOf('\n'); end >= 0; end = worker.output.indexOf('\n'))
+	{
+		const auto line = worker.output.left(end);
+		worker.output.remove(0, end + 1);
+
+		if (line.startsWith(ProgressMessage))
+		{
+			worker.progress = line.mid(static_cast<int>(qstrlen(ProgressMessage))).toInt();
+		}
+		else if (line.startsWith(DoneMessage) && worker.project >= 0)
+		{
+			complete(worker, line.mid(static_cast<int>(qstrlen(DoneMessage))).toInt() != 0);
+			handOut(worker);
+		}
+		else
+		{
+			worker.log += line + '\n';
+		}
+	}
+}
+
+
+
+
+void BatchRenderer::complete(Worker& worker, bool successful)
+{
+	m_results[worker.project] = Result{true, successful, worker.timer.elapsed()};
+	++m_done;
+
+	if (!successful)
+	{
+		fprintf(stderr, "\nRendering %s failed:\n%s", m_projects[worker.project].toLocal8Bit().constData(),
+			worker.log.constData());
+	}
+	worker.project = -1;
+}
+
+
+
+
+void BatchRenderer::workerFinished(Worker& worker)
+{
+	if (!worker.process) { return; }
+	readOutput(worker);
+
+	// a worker that crashed takes its project with it, the others may have
+	// to be rendered by a new one
+	if (worker.project >= 0)
+	{
+		worker.log += worker.process->errorString().toLocal8Bit() + '\n';
+		complete(worker, false);
+	}
+	worker.process->disconnect(this);
+	worker.process->deleteLater();
+	worker.process = nullptr;
+
+	if (m_next < m_projects.size())
+	{
+		startWorker(worker);
+		return;
+	}
+
+	const auto running = std::any_of(m_workers.begin(), m_workers.end(),
+		[](const auto& other) { return other->process != nullptr; });
+	if (running) { return; }
+
+	m_progressTimer.stop();
+	printProgress();
+	printReport();
+
+	emit finished(std::all_of(m_results.begin(), m_results.end(),
+		[](const Result& result) { return result.successful; }));
+}
+
+
+
+
+void BatchRenderer::printProgress() const
+{
+	auto progress = 100 * m_done;
+	for (const auto& worker : m_workers)
+	{
+		if (worker->project >= 0) { progress += worker->progress; }
+	}
+
+	const auto failed = std::count_if(m_results.begin(), m_results.end(),
+		[](const Result& result) { return result.done && !result.successful; });
+	fprintf(stderr, "\r%3d%%  rendered %d of %d projects, %d failed", progress / m_projects.size(), m_done,
+		m_projects.size(), static_cast<int>(failed));
+}
+
+
+
+
+void BatchRenderer::printReport() const
+{
+	printf("\n\n");
+
+	auto total = qint64{0};
+	auto rendered = 0;
+	for (auto i = 0; i < m_projects.size(); ++i)
+	{
+		const auto& result = m_results[i];
+		printf("%9.2f s  %-6s  %s\n", result.milliseconds / 1000.0, result.successful ? "done" : "failed",
+			m_projects[i].toLocal8Bit().constData());
+
+		total += result.milliseconds;
+		if (result.successful) { ++rendered; }
+	}
+
+	printf("\nRendered %d of %d projects in %.2f s with %d jobs, %.2f s of rendering altogether\n", rendered,
+		m_projects.size(), m_timer.elapsed() / 1000.0, static_cast<int>(m_workers.size()), total / 1000.0);
+}
+
+
+
+
+auto BatchRenderer::work(const AudioEngine::qualitySettings& qualitySettings, const OutputSettings& outputSettings,
+	ProjectRenderer::ExportFileFormat format, bool loop, const QString& outputDir,
+	const std::function<void(RenderManager&)>& configure) -> int
+{
+	const auto extension = ProjectRenderer::getFileExtensionFromFormat(format);
+
+	QTextStream input(stdin);
+	for (auto project = input.readLine(); !project.isNull(); project = input.readLine())
+	{
+		if (project.isEmpty()) { continue; }
+
+		auto successful = false;
+		Engine::getSong()->loadProject(project);
+		if (!Engine::getSong()->isEmpty())
+		{
+			Engine::getSong()->setExportLoop(loop);
+
+			const auto info = QFileInfo{project};
+			const auto output = QDir{outputDir.isEmpty() ? info.absolutePath() : outputDir}
+				.filePath(info.completeBaseName() + extension);
+			QFile::remove(output);
+
+			auto renderer = RenderManager{qualitySettings, outputSettings, format, output};
+			configure(renderer);
+			auto done = false;
+			auto eventLoop = QEventLoop{};
+			QObject::connect(&renderer, &RenderManager::progressChanged, [](int progress)
+			{
+				printf("%s%d\n", ProgressMessage, progress);
+				fflush(stdout);
+			});
+			QObject::connect(&renderer, &RenderManager::finished, [&done, &eventLoop]
+			{
+				done = true;
+				eventLoop.quit();
+			});
+
+			renderer.renderProject();
+			// the renderer finishes right away if it couldn't start
+			if (!done) { eventLoop.exec(); }
+
+			successful = QFileInfo{output}.size() > 0;
+		}
+
+		printf("%s%d\n", DoneMessage, successful ? 1 : 0);
+		fflush(stdout);
+	}
+	return EXIT_SUCCESS;
+}
+
+
+} // namespace lmms
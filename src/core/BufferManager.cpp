@@ -26,24 +26,176 @@
 
 #include "BufferManager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
 
-#include "MemoryManager.h"
+#include <QThread>
+
+#include "LocklessIndexStack.h"
 
 namespace lmms
 {
 
+namespace
+{
+
+constexpr std::size_t CacheLineSize = 64;
+
+constexpr std::uint32_t MaxBuffers = 1 << 16;
+constexpr std::uint32_t InitialBuffers = 256;
+constexpr std::uint32_t GrowBy = 128;
+// start growing the pool when fewer buffers than this are left
+constexpr int LowWater = 64;
+
+// marks buffers allocated on their own because the pool was full
+constexpr std::uint32_t Unpooled = 0xffffffff;
+
+//! Sits right in front of every buffer, so it stays aligned too
+struct alignas(CacheLineSize) BufferHeader
+{
+	std::uint32_t index = Unpooled;
+};
+
+static_assert(sizeof(BufferHeader) == CacheLineSize);
+
+
+std::size_t s_stride = CacheLineSize;
+
+std::unique_ptr<BufferHeader*[]> s_headers;
+std::unique_ptr<LocklessIndexStack> s_freeList;
+std::uint32_t s_count = 0;
+std::atomic_bool s_growRequested{false};
+
+std::mutex s_growMutex;
+// never freed, buffers may still be released when the program ends
+std::vector<void*> s_chunks;
+
+
+BufferHeader* header(sampleFrame* buf)
+{
+	return reinterpret_cast<BufferHeader*>(reinterpret_cast<char*>(buf) - CacheLineSize);
+}
+
+
+sampleFrame* buffer(BufferHeader* header)
+{
+	return reinterpret_cast<sampleFrame*>(reinterpret_cast<char*>(header) + CacheLineSize);
+}
+
+
+BufferHeader* pop()
+{
+	const std::uint32_t index = s_freeList->pop();
+	return index != LocklessIndexStack::Empty ? s_headers[index] : nullptr;
+}
+
+
+bool grow(std::uint32_t count)
+{
+	const auto lock = std::lock_guard{s_growMutex};
+
+	const std::uint32_t first = s_count;
+	count = std::min(count, MaxBuffers - first);
+	if (count == 0) { return false; }
+
+	auto chunk = static_cast<char*>(::operator new(count * s_stride, std::align_val_t{CacheLineSize}));
+	s_chunks.push_back(chunk);
+
+	for (std::uint32_t i = first; i < first + count; ++i)
+	{
+		auto header = new (chunk + (i - first) * s_stride) BufferHeader;
+		header->index = i;
+		s_headers[i] = header;
+		// pushing publishes the header to the threads popping it
+		s_freeList->push(i);
+	}
+	s_count = first + count;
+	return true;
+}
+
+
+class PoolGrower : public QThread
+{
+public:
+	void quit() { m_quit = true; }
+
+private:
+	void run() override
+	{
+		while (!m_quit)
+		{
+			if (s_growRequested.exchange(false, std::memory_order_relaxed))
+			{
+				grow(GrowBy);
+			}
+			msleep(20);
+		}
+	}
+
+	std::atomic_bool m_quit{false};
+};
+
+std::unique_ptr<PoolGrower> s_grower;
+
+} // namespace
+
+
 fpp_t BufferManager::s_framesPerPeriod;
 
 void BufferManager::init( fpp_t fpp )
 {
+	// the frame count can only be set once, buffers never change their size
+	if (s_headers) { return; }
+
 	s_framesPerPeriod = fpp;
+	const std::size_t bytes = fpp * sizeof(sampleFrame);
+	s_stride = CacheLineSize + (bytes + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+
+	s_headers = std::make_unique<BufferHeader*[]>(MaxBuffers);
+	s_freeList = std::make_unique<LocklessIndexStack>(MaxBuffers);
+	grow(InitialBuffers);
+
+	s_grower = std::make_unique<PoolGrower>();
+	s_grower->start(QThread::LowPriority);
+}
+
+
+
+
+void BufferManager::cleanup()
+{
+	if (!s_grower) { return; }
+
+	s_grower->quit();
+	s_grower->wait();
+	s_grower.reset();
 }
 
 
 sampleFrame * BufferManager::acquire()
 {
-	return MM_ALLOC<sampleFrame>( s_framesPerPeriod );
+	BufferHeader* header = s_headers ? pop() : nullptr;
+	if (!header)
+	{
+		// the grower couldn't keep up - allocating here is better than failing
+		if (s_headers && grow(GrowBy)) { header = pop(); }
+		if (!header)
+		{
+			header = new (::operator new(s_stride, std::align_val_t{CacheLineSize})) BufferHeader;
+		}
+	}
+
+	if (s_freeList && s_freeList->size() < LowWater)
+	{
+		s_growRequested.store(true, std::memory_order_relaxed);
+	}
+	return buffer(header);
 }
 
 void BufferManager::clear( sampleFrame *ab, const f_cnt_t frames, const f_cnt_t offset )
@@ -60,9 +212,25 @@ void BufferManager::clear( surroundSampleFrame * ab, const f_cnt_t frames,
 #endif
 
 
+std::size_t BufferManager::poolBytes()
+{
+	const auto lock = std::lock_guard{s_growMutex};
+	return s_count * s_stride;
+}
+
+
 void BufferManager::release( sampleFrame * buf )
 {
-	MM_FREE( buf );
+	if (!buf) { return; }
+
+	BufferHeader* h = header(buf);
+	if (h->index == Unpooled)
+	{
+		h->~BufferHeader();
+		::operator delete(h, std::align_val_t{CacheLineSize});
+		return;
+	}
+	s_freeList->push(h->index);
 }
 
 } // namespace lmms
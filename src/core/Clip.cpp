@@ -28,6 +28,7 @@
 
 #include "AutomationEditor.h"
 #include "AutomationClip.h"
+#include "AutomationIndex.h"
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "Song.h"
@@ -95,6 +96,8 @@ void Clip::movePosition( const TimePos & pos )
 	{
 		Engine::audioEngine()->requestChangeInModel();
 		m_startPosition = newPos;
+		AutomationIndex::invalidate();
+		if (m_track) { m_track->invalidateClipIndex(); }
 		Engine::audioEngine()->doneChangeInModel();
 		Engine::getSong()->updateLength();
 		emit positionChanged();
@@ -114,6 +117,7 @@ void Clip::movePosition( const TimePos & pos )
 void Clip::changeLength( const TimePos & length )
 {
 	m_length = length;
+	if (m_track) { m_track->invalidateClipIndex(); }
 	Engine::getSong()->updateLength();
 	emit lengthChanged();
 }
@@ -27,6 +27,7 @@
 #include <QMimeData>
 
 #include "Clipboard.h"
+#include "DataFile.h"
 
 
 namespace lmms::Clipboard
@@ -81,6 +82,11 @@ namespace lmms::Clipboard
 
 	QString decodeKey( const QMimeData * mimeData )
 	{
+		// checking what's dragged shouldn't write all of it as a string
+		if( const auto local = dynamic_cast<const LocalMimeData *>( mimeData ) )
+		{
+			return local->hasFormat( mimeType( MimeType::StringPair ) ) ? local->key() : QString();
+		}
 		return( QString::fromUtf8( mimeData->data( mimeType( MimeType::StringPair ) ) ).section( ':', 0, 0 ) );
 	}
 
@@ -93,4 +99,71 @@ namespace lmms::Clipboard
 	}
 
 
+
+
+	LocalMimeData::LocalMimeData( MimeType type, const QString & key, std::any value,
+			std::function<QString()> serialize ) :
+		m_type( type ),
+		m_key( key ),
+		m_value( std::move( value ) ),
+		m_serialize( std::move( serialize ) )
+	{
+	}
+
+
+
+
+	QStringList LocalMimeData::formats() const
+	{
+		return { mimeType( m_type ) };
+	}
+
+
+
+
+	bool LocalMimeData::hasFormat( const QString & format ) const
+	{
+		return format == mimeType( m_type );
+	}
+
+
+
+
+	QVariant LocalMimeData::retrieveData( const QString & format, QVariant::Type type ) const
+	{
+		if( !hasFormat( format ) )
+		{
+			return QMimeData::retrieveData( format, type );
+		}
+		if( m_serialized.isNull() )
+		{
+			const QString value = m_serialize();
+			m_serialized = ( m_type == MimeType::StringPair ? m_key + ":" + value : value ).toUtf8();
+		}
+		return m_serialized;
+	}
+
+
+
+
+	void copyLocal( MimeType mT, const QString & key, std::any value, std::function<QString()> serialize )
+	{
+		auto content = new LocalMimeData( mT, key, std::move( value ), std::move( serialize ) );
+		QApplication::clipboard()->setMimeData( content, QClipboard::Clipboard );
+	}
+
+
+
+
+	DataFile decodeDataFile( const QMimeData * mimeData )
+	{
+		if( const auto dataFile = localValue<DataFile>( mimeData ) )
+		{
+			// shares the document, which pasting only reads
+			return *dataFile;
+		}
+		return DataFile( decodeValue( mimeData ).toUtf8() );
+	}
+
+
 } // namespace lmms::Clipboard
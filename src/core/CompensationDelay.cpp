@@ -0,0 +1,63 @@
+/*
+ * CompensationDelay.cpp - delays audio to line it up with audio that has latency
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "CompensationDelay.h"
+
+#include <algorithm>
+
+namespace lmms {
+
+void CompensationDelay::setDelay(f_cnt_t frames)
+{
+	frames = std::max(frames, f_cnt_t{0});
+	if (frames == m_delay) { return; }
+
+	if (static_cast<std::size_t>(frames) > m_buffer.size()) { m_buffer.resize(frames); }
+	std::fill_n(m_buffer.begin(), frames, sampleFrame{0, 0});
+	m_delay = frames;
+	m_position = 0;
+	m_tail = 0;
+}
+
+
+
+
+void CompensationDelay::process(sampleFrame* buf, fpp_t frames, bool hasInput)
+{
+	// without anything delayed, silence stays silence
+	if (m_delay == 0 || (!hasInput && m_tail == 0)) { return; }
+
+	for (fpp_t f = 0; f < frames; ++f)
+	{
+		auto& delayed = m_buffer[m_position];
+		const auto input = hasInput ? buf[f] : sampleFrame{0, 0};
+		buf[f] = delayed;
+		delayed = input;
+		if (++m_position == m_delay) { m_position = 0; }
+	}
+	m_tail = hasInput ? m_delay : std::max(m_tail - frames, f_cnt_t{0});
+}
+
+
+} // namespace lmms
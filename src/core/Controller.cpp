@@ -26,6 +26,7 @@
 
 #include <QDomElement>
 
+#include <algorithm>
 #include <vector>
 
 #include "AudioEngine.h"
@@ -50,7 +51,10 @@ Controller::Controller( ControllerType _type, Model * _parent,
 	JournallingObject(),
 	m_valueBuffer( Engine::audioEngine()->framesPerPeriod() ),
 	m_bufferLastUpdated( -1 ),
-	m_connectionCount( 0 ),
+	m_constant( true ),
+	m_changed( true ),
+	m_lastBufferValue( 0.5f ),
+	m_visiting( false ),
 	m_type( _type )
 {
 	if( _type != ControllerType::Dummy && _type != ControllerType::Midi )
@@ -115,7 +119,7 @@ float Controller::value( int offset )
 {
 	if( m_bufferLastUpdated != s_periods )
 	{
-		updateValueBuffer();
+		update();
 	}
 	return m_valueBuffer.values()[ offset ];
 }
@@ -125,12 +129,25 @@ ValueBuffer * Controller::valueBuffer()
 {
 	if( m_bufferLastUpdated != s_periods )
 	{
-		updateValueBuffer();
+		update();
 	}
 	return &m_valueBuffer;
 }
 
 
+
+void Controller::update()
+{
+	updateValueBuffer();
+
+	const float* values = m_valueBuffer.values();
+	const float* end = values + m_valueBuffer.length();
+	m_constant = std::all_of( values, end, [values]( float v ) { return v == values[0]; } );
+	m_changed = !m_constant || values[0] != m_lastBufferValue;
+	m_lastBufferValue = *( end - 1 );
+}
+
+
 void Controller::updateValueBuffer()
 {
 	m_valueBuffer.fill(0.5f);
@@ -158,6 +175,21 @@ void Controller::triggerFrameCounter()
 {
 	for (Controller * controller : s_controllers)
 	{
+		// one that nothing reads isn't evaluated at all, and one that held
+		// the value it had before all period hasn't changed anything
+		if( !controller->isUsed() )
+		{
+			continue;
+		}
+		if( controller->m_bufferLastUpdated != s_periods )
+		{
+			controller->update();
+		}
+		if( !controller->m_changed )
+		{
+			continue;
+		}
+
 		// This signal is for updating values for both stubborn knobs and for
 		// painting.  If we ever get all the widgets to use or at least check
 		// currentValue() then we can throttle the signal and only use it for
@@ -304,25 +336,53 @@ gui::ControllerDialog * Controller::createDialog( QWidget * _parent )
 
 
 
-void Controller::addConnection( ControllerConnection * )
+void Controller::addConnection( ControllerConnection * connection )
 {
-	m_connectionCount++;
+	QMutexLocker m( &m_connectionsMutex );
+	m_connections.push_back( connection );
 }
 
 
 
 
-void Controller::removeConnection( ControllerConnection * )
+void Controller::removeConnection( ControllerConnection * connection )
 {
-	m_connectionCount--;
-	Q_ASSERT( m_connectionCount >= 0 );
+	QMutexLocker m( &m_connectionsMutex );
+	auto it = std::find( m_connections.begin(), m_connections.end(), connection );
+	Q_ASSERT( it != m_connections.end() );
+	if( it != m_connections.end() )
+	{
+		m_connections.erase( it );
+	}
 }
 
 
 
 
 int Controller::connectionCount() const{
-	return m_connectionCount;
+	QMutexLocker m( &m_connectionsMutex );
+	return static_cast<int>( m_connections.size() );
+}
+
+
+
+
+bool Controller::isUsed() const
+{
+	if( m_visiting )
+	{
+		return false;
+	}
+
+	QMutexLocker m( &m_connectionsMutex );
+	m_visiting = true;
+	const bool used = std::any_of( m_connections.begin(), m_connections.end(),
+		[]( ControllerConnection* connection )
+		{
+			return connection->consumer() == nullptr || connection->consumer()->isUsed();
+		} );
+	m_visiting = false;
+	return used;
 }
 
 
@@ -29,22 +29,33 @@
 #include <algorithm>
 #include <cmath>
 #include <map>
+#include <vector>
 
+#include <sndfile.h>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QMessageBox>
 #include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
 
+#include "AudioEngine.h"
 #include "base64.h"
 #include "ConfigManager.h"
 #include "Effect.h"
 #include "embed.h"
+#include "Engine.h"
 #include "GuiApplication.h"
 #include "LocaleHelper.h"
 #include "Note.h"
 #include "PluginFactory.h"
+#include "SampleBuffer.h"
 #include "ProjectVersion.h"
 #include "SongEditor.h"
 #include "TextFloat.h"
@@ -67,6 +78,13 @@ const DataFile::ResourcesMap DataFile::ELEMENTS_WITH_RESOURCES = {
 { "audiofileprocessor", {"src"} },
 };
 
+// The DOM elements that can embed a sample instead, and the attribute with the samples
+const std::map<QString, QString> DataFile::EMBEDDED_SAMPLE_ATTRIBUTES = {
+{ "sampleclip", "data" },
+{ "audiofileprocessor", "sampledata" },
+{ "slicert", "sampledata" },
+};
+
 // Vector with all the upgrade methods
 const std::vector<DataFile::UpgradeMethod> DataFile::UPGRADE_METHODS = {
 	&DataFile::upgrade_0_2_1_20070501   ,   &DataFile::upgrade_0_2_1_20070508,
@@ -170,7 +188,43 @@ DataFile::DataFile( const QString & _fileName ) :
 		return;
 	}
 
+	// a legacy file is upgraded once, after that its upgraded copy is loaded
+	const QString cacheFile = upgradeCacheFile(_fileName);
+	QFile cached(cacheFile);
+	if (!cacheFile.isEmpty() && cached.open(QIODevice::ReadOnly))
+	{
+		loadData(cached.readAll(), _fileName);
+		return;
+	}
+
 	loadData( inFile.readAll(), _fileName );
+
+	if (m_upgraded && !cacheFile.isEmpty() && QDir().mkpath(QFileInfo(cacheFile).absolutePath()))
+	{
+		QSaveFile out(cacheFile);
+		if (out.open(QIODevice::WriteOnly))
+		{
+			out.write(qCompress(toByteArray()));
+			out.commit();
+		}
+	}
+}
+
+
+
+
+QString DataFile::upgradeCacheFile(const QString& fileName)
+{
+	const QFileInfo info(fileName);
+	const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	if (cacheDir.isEmpty()) { return QString(); }
+
+	// everything the upgraded copy depends on, so it's never used when it's stale
+	const QString key = QString("%1\n%2\n%3\n%4\n%5").arg(info.canonicalFilePath())
+		.arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size())
+		.arg(LMMS_VERSION).arg(static_cast<qulonglong>(UPGRADE_METHODS.size()));
+	return cacheDir + "/upgraded/"
+		+ QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex() + ".mmpz";
 }
 
 
@@ -305,11 +359,12 @@ void DataFile::write( QTextStream & _strm )
 
 
 
-bool DataFile::writeFile(const QString& filename, bool withResources)
+bool DataFile::writeFile(const QString& filename, bool withResources, bool keepBackup)
 {
 	// Small lambda function for displaying errors
 	auto showError = [](QString title, QString body){
-		if (gui::getGUI() != nullptr)
+		// the autosave writes from another thread, where there can't be a box
+		if (gui::getGUI() != nullptr && QThread::currentThread() == QCoreApplication::instance()->thread())
 		{
 			QMessageBox mb;
 			mb.setWindowTitle(title);
@@ -338,6 +393,7 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 		: nameWithExtension(filename);
 	const QString fullNameTemp = fullName + ".new";
 	const QString fullNameBak = fullName + ".bak";
+	keepBackup = keepBackup && !ConfigManager::inst()->value("app", "disablebackup").toInt();
 
 	using gui::SongEditor;
 
@@ -382,7 +438,8 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 		}
 	}
 
-	QSaveFile outfile(fullNameTemp);
+	// without a backup, QSaveFile alone replaces the file atomically
+	QSaveFile outfile(keepBackup ? fullNameTemp : fullName);
 
 	if (!outfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
 	{
@@ -415,20 +472,15 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 		return false;
 	}
 
-	if (ConfigManager::inst()->value("app", "disablebackup").toInt())
-	{
-		// remove current file
-		QFile::remove(fullName);
-	}
-	else
+	if (keepBackup)
 	{
 		// remove old backup file
 		QFile::remove(fullNameBak);
 		// move current file to backup file
 		QFile::rename(fullName, fullNameBak);
+		// move temporary file to current file
+		QFile::rename(fullNameTemp, fullName);
 	}
-	// move temporary file to current file
-	QFile::rename(fullNameTemp, fullName);
 
 	return true;
 }
@@ -514,12 +566,106 @@ bool DataFile::copyResources(const QString& resourcesDir)
 		++it;
 	}
 
+	// Samples embedded as Base64 become files of the bundle too, which are
+	// much smaller than the text and quicker to write and load
+	int embeddedCount = 0;
+	for (const auto& [tagName, dataAttribute] : EMBEDDED_SAMPLE_ATTRIBUTES)
+	{
+		QDomNodeList list = elementsByTagName(tagName);
+		for (int i = 0; !list.item(i).isNull(); ++i)
+		{
+			QDomElement el = list.item(i).toElement();
+			if (!el.attribute("src").isEmpty() || el.attribute(dataAttribute).isEmpty()) { continue; }
+
+			const int sampleRate = el.hasAttribute("sample_rate")
+				? el.attribute("sample_rate").toInt()
+				: static_cast<int>(Engine::audioEngine()->processingSampleRate());
+			const SampleBuffer buffer(el.attribute(dataAttribute), sampleRate);
+
+			// FLAC if it gives back the very same frames, everything else is kept as float WAV
+			const bool flac = isLossless24Bit(buffer);
+			QString finalFileName;
+			do
+			{
+				finalFileName = QString("embedded-%1.%2").arg(++embeddedCount).arg(flac ? "flac" : "wav");
+			} while (QFile::exists(resourcesDir + "/" + finalFileName));
+
+			if (!writeSampleFile(buffer, resourcesDir + "/" + finalFileName, flac))
+			{
+				qWarning("ERROR: Failed to write embedded sample");
+				return false;
+			}
+
+			el.setAttribute("src", PathUtil::basePrefix(PathUtil::Base::LocalDir) + "resources/" + finalFileName);
+			el.removeAttribute(dataAttribute);
+		}
+	}
+
 	return true;
 }
 
 
 
 
+bool DataFile::isLossless24Bit(const SampleBuffer& buffer)
+{
+	constexpr float Scale = 1 << 23;
+	return std::all_of(buffer.begin(), buffer.end(), [](const sampleFrame& frame)
+	{
+		return std::all_of(frame.begin(), frame.end(), [](float sample)
+		{
+			const float scaled = sample * Scale;
+			return scaled >= -Scale && scaled < Scale && scaled == std::floor(scaled);
+		});
+	});
+}
+
+
+
+
+bool DataFile::writeSampleFile(const SampleBuffer& buffer, const QString& fileName, bool flac)
+{
+	SF_INFO info = {};
+	info.samplerate = buffer.sampleRate();
+	info.channels = DEFAULT_CHANNELS;
+	info.format = flac ? (SF_FORMAT_FLAC | SF_FORMAT_PCM_24) : (SF_FORMAT_WAV | SF_FORMAT_FLOAT);
+
+	SNDFILE* file = sf_open(
+#ifdef LMMS_BUILD_WIN32
+		fileName.toLocal8Bit().constData(),
+#else
+		fileName.toUtf8().constData(),
+#endif
+		SFM_WRITE, &info);
+	if (file == nullptr) { return false; }
+
+	const auto frames = static_cast<sf_count_t>(buffer.size());
+	sf_count_t written = 0;
+	if (flac)
+	{
+		// as integers, so nothing gets rounded on the way
+		auto samples = std::vector<int>(buffer.size() * DEFAULT_CHANNELS);
+		for (std::size_t f = 0; f < buffer.size(); ++f)
+		{
+			for (int c = 0; c < DEFAULT_CHANNELS; ++c)
+			{
+				samples[f * DEFAULT_CHANNELS + c] = static_cast<int>(buffer.data()[f][c] * (1 << 23)) * (1 << 8);
+			}
+		}
+		written = sf_writef_int(file, samples.data(), frames);
+	}
+	else
+	{
+		written = sf_writef_float(file, &buffer.data()[0][0], frames);
+	}
+
+	sf_close(file);
+	return written == frames;
+}
+
+
+
+
 /**
  * @brief This recursive method will go through all XML nodes of the DataFile
  *        and check whether any of them have local paths. If they are not on
@@ -1936,6 +2082,7 @@ void DataFile::upgrade()
 
 	// Bump the file version (which should be the size of the upgrade methods vector)
 	m_fileVersion = UPGRADE_METHODS.size();
+	m_upgraded = true;
 
 	// update document meta data
 	documentElement().setAttribute( "version", m_fileVersion );
@@ -1998,7 +2145,10 @@ void DataFile::loadData( const QByteArray & _data, const QString & _sourceFile )
 
 	QDomElement root = documentElement();
 	m_type = type( root.attribute( "type" ) );
-	m_head = root.elementsByTagName( "head" ).item( 0 ).toElement();
+	// elementsByTagName() would walk the whole document, which for a project
+	// with embedded samples and lots of automation is a big one
+	m_head = root.firstChildElement("head");
+	if (m_head.isNull()) { m_head = root.elementsByTagName("head").item(0).toElement(); }
 
 	if (!root.hasAttribute("version") || root.attribute("version")=="1.0")
 	{
@@ -2041,7 +2191,8 @@ void DataFile::loadData( const QByteArray & _data, const QString & _sourceFile )
 	// Perform upgrade routines
 	if (m_fileVersion < UPGRADE_METHODS.size()) { upgrade(); }
 
-	m_content = root.elementsByTagName(typeName(m_type)).item(0).toElement();
+	m_content = root.firstChildElement(typeName(m_type));
+	if (m_content.isNull()) { m_content = root.elementsByTagName(typeName(m_type)).item(0).toElement(); }
 }
 
 
@@ -0,0 +1,403 @@
+/*
+ * DistributedRenderer.cpp - renders segments of a song with several processes and joins them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "DistributedRenderer.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "AudioEngine.h"
+#include "AudioFileDevice.h"
+#include "Engine.h"
+#include "TimePos.h"
+#include "endian_handling.h"
+
+namespace lmms {
+
+namespace {
+
+// what a worker writes on its standard error for the renderer, since the
+// audio goes to its standard output - everything else there is kept in case
+// the segment fails
+constexpr auto ProgressMessage = "lmms-segment progress ";
+constexpr auto SegmentMessage = "lmms-segment frames ";
+
+//! The segments are sent as raw 32 bit float
+constexpr auto FrameBytes = static_cast<qint64>(DEFAULT_CHANNELS * sizeof(float));
+constexpr fpp_t BlockFrames = 4096;
+
+//! When the beat two segments both rendered differs by more than that,
+//! relative to the signal, the pre-roll was too short
+constexpr double MismatchWarningDb = -40;
+
+//! Reads up to @p count frames of the raw audio @p file, from where it is
+auto readFrames(QFile& file, f_cnt_t count) -> std::vector<surroundSampleFrame>
+{
+	const auto bytes = file.read(count * FrameBytes);
+	auto frames = std::vector<surroundSampleFrame>(bytes.size() / FrameBytes);
+	for (std::size_t f = 0; f < frames.size(); ++f)
+	{
+		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+		{
+			int32_t bits;
+			std::memcpy(&bits, bytes.constData() + (f * DEFAULT_CHANNELS + ch) * sizeof(float), sizeof(bits));
+			bits = swap32IfBE(bits);
+			std::memcpy(&frames[f][ch], &bits, sizeof(bits));
+		}
+	}
+	return frames;
+}
+
+} // namespace
+
+
+
+
+DistributedRenderer::DistributedRenderer(const QString& project, tick_t length, tick_t preroll,
+	const QStringList& workers, const QStringList& workerArguments, const OutputSettings& outputSettings,
+	ProjectRenderer::ExportFileFormat format, const QString& output) :
+	m_project(project),
+	m_preroll(preroll),
+	m_workers(workers),
+	m_workerArguments(workerArguments),
+	m_outputSettings(outputSettings),
+	m_format(format),
+	m_output(output)
+{
+	// a segment per worker, which are at least a bar long, and begin on one
+	const tick_t bar = TimePos::ticksPerBar();
+	const auto bars = std::max((length + bar - 1) / bar, 1);
+	const auto count = std::min(static_cast<int>(workers.size()), bars);
+	for (auto i = 0; i < count; ++i)
+	{
+		auto segment = std::make_unique<Segment>();
+		segment->begin = bars * i / count * bar;
+		segment->end = i + 1 < count ? bars * (i + 1) / count * bar : length;
+		m_segments.push_back(std::move(segment));
+	}
+
+	connect(&m_progressTimer, &QTimer::timeout, this, &DistributedRenderer::printProgress);
+}
+
+
+
+
+DistributedRenderer::~DistributedRenderer()
+{
+	for (const auto& segment : m_segments)
+	{
+		if (!segment->process) { continue; }
+		segment->process->disconnect(this);
+		segment->process->kill();
+		segment->process->waitForFinished();
+	}
+}
+
+
+
+
+void DistributedRenderer::addFormat(ProjectRenderer::ExportFileFormat format)
+{
+	if (format != m_format) { m_copyFormats.push_back(format); }
+}
+
+
+
+
+void DistributedRenderer::start()
+{
+	printf("Rendering %s in %d segments\n", m_project.toUtf8().constData(), static_cast<int>(m_segments.size()));
+
+	for (std::size_t i = 0; i < m_segments.size(); ++i)
+	{
+		Segment& segment = *m_segments[i];
+		segment.audio = std::make_unique<QTemporaryFile>();
+		if (!segment.audio->open())
+		{
+			fprintf(stderr, "Can't create a file for the segment %d\n", static_cast<int>(i));
+			emit finished(false);
+			return;
+		}
+
+		// the worker command may start LMMS elsewhere, like "ssh host lmms",
+		// without one it's this LMMS here
+		const auto command = m_workers[static_cast<int>(i)].simplified();
+		auto arguments = command.isEmpty() ? QStringList{} : command.split(' ');
+		const auto program = command.isEmpty() ? QCoreApplication::applicationFilePath() : arguments.takeFirst();
+		arguments << "render" << m_project << segmentArguments(segment.begin, segment.end, m_preroll)
+			<< m_workerArguments;
+
+		segment.process = new QProcess(this);
+		connect(segment.process, &QProcess::readyReadStandardOutput, this, [this, &segment] { readAudio(segment); });
+		connect(segment.process, &QProcess::readyReadStandardError, this, [this, &segment] { readErrors(segment); });
+		connect(segment.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+			this, [this, &segment] { workerFinished(segment); });
+		connect(segment.process, &QProcess::errorOccurred, this, [this, &segment](QProcess::ProcessError error)
+		{
+			// there won't be a finished() for a worker that was never running
+			if (error == QProcess::FailedToStart) { workerFinished(segment); }
+		}, Qt::QueuedConnection);
+
+		segment.process->start(program, arguments);
+	}
+	m_progressTimer.start(200);
+}
+
+
+
+
+auto DistributedRenderer::segmentArguments(tick_t begin, tick_t end, tick_t preroll) -> QStringList
+{
+	// they meet in the quarter of a bar after the end
+	const tick_t overlap = TimePos::ticksPerBar() / 4;
+	return {"--segment", QString("%1:%2:%3:%4").arg(begin).arg(end).arg(preroll).arg(overlap),
+		"--format", "raw", "--float", "--output", "-"};
+}
+
+
+
+
+void DistributedRenderer::reportSegment(f_cnt_t beginFrame, f_cnt_t endFrame)
+{
+	fprintf(stderr, "\n%s%d %d\n", SegmentMessage, beginFrame, endFrame);
+	fflush(stderr);
+}
+
+
+
+
+void DistributedRenderer::reportProgress(int progress)
+{
+	fprintf(stderr, "\n%s%d\n", ProgressMessage, progress);
+	fflush(stderr);
+}
+
+
+
+
+void DistributedRenderer::readAudio(Segment& segment)
+{
+	const auto audio = segment.process->readAllStandardOutput();
+	if (segment.audio->write(audio) != audio.size() && !segment.done)
+	{
+		fprintf(stderr, "\nCan't write the segment to %s\n", segment.audio->fileName().toUtf8().constData());
+		segment.process->kill();
+	}
+}
+
+
+
+
+void DistributedRenderer::readErrors(Segment& segment)
+{
+	segment.errors += segment.process->readAllStandardError();
+
+	for (auto end = segment.errors.indexOf('\n'); end >= 0; end = segment.errors.indexOf('\n'))
+	{
+		const auto line = segment.errors.left(end);
+		segment.errors.remove(0, end + 1);
+
+		if (line.startsWith(ProgressMessage))
+		{
+			segment.progress = line.mid(static_cast<int>(qstrlen(ProgressMessage))).toInt();
+		}
+		else if (line.startsWith(SegmentMessage))
+		{
+			const auto frames = line.mid(static_cast<int>(qstrlen(SegmentMessage))).split(' ');
+			if (frames.size() == 2)
+			{
+				segment.beginFrame = frames[0].toInt();
+				segment.endFrame = frames[1].toInt();
+			}
+		}
+		else if (!line.trimmed().isEmpty())
+		{
+			segment.log += line + '\n';
+		}
+	}
+}
+
+
+
+
+void DistributedRenderer::workerFinished(Segment& segment)
+{
+	if (!segment.process || segment.done) { return; }
+	readAudio(segment);
+	readErrors(segment);
+	segment.done = true;
+	++m_done;
+
+	const auto successful = segment.process->exitStatus() == QProcess::NormalExit
+		&& segment.process->exitCode() == EXIT_SUCCESS
+		&& segment.beginFrame >= 0 && segment.endFrame >= segment.beginFrame
+		&& segment.audio->size() >= segment.endFrame * FrameBytes;
+	if (!successful)
+	{
+		fprintf(stderr, "\nRendering the segment from bar %d to %d failed:\n%s%s\n",
+			segment.begin / TimePos::ticksPerBar() + 1, segment.end / TimePos::ticksPerBar() + 1,
+			segment.log.constData(), segment.process->errorString().toLocal8Bit().constData());
+		m_failed = true;
+	}
+
+	segment.process->disconnect(this);
+	segment.process->deleteLater();
+	segment.process = nullptr;
+
+	if (m_done < static_cast<int>(m_segments.size())) { return; }
+
+	m_progressTimer.stop();
+	printProgress();
+	printf("\n");
+	emit finished(!m_failed && join());
+}
+
+
+
+
+auto DistributedRenderer::join() -> bool
+{
+	const auto factory = ProjectRenderer::fileEncodeDevices[static_cast<std::size_t>(m_format)].m_getDevInst;
+	if (!factory) { return false; }
+
+	auto successful = false;
+	const auto output = std::unique_ptr<AudioFileDevice>{factory(m_output, m_outputSettings, DEFAULT_CHANNELS,
+		Engine::audioEngine(), successful)};
+	if (!successful)
+	{
+		fprintf(stderr, "Can't write to %s\n", m_output.toUtf8().constData());
+		return false;
+	}
+
+	auto copies = std::vector<std::unique_ptr<AudioFileDevice>>{};
+	for (const auto format : m_copyFormats)
+	{
+		const auto path = QFileInfo{m_output}.dir().filePath(QFileInfo{m_output}.completeBaseName()
+			+ ProjectRenderer::getFileExtensionFromFormat(format));
+		const auto copyFactory = ProjectRenderer::fileEncodeDevices[static_cast<std::size_t>(format)].m_getDevInst;
+		auto copyCreated = false;
+		auto copy = std::unique_ptr<AudioFileDevice>{copyFactory
+			? copyFactory(path, m_outputSettings, DEFAULT_CHANNELS, Engine::audioEngine(), copyCreated) : nullptr};
+		if (!copyCreated) { continue; }
+		output->addCopy(copy.get());
+		copies.push_back(std::move(copy));
+	}
+	if (m_loudnessReport) { output->enableLoudnessReport(); }
+
+	// the workers applied the master volume already
+	Engine::audioEngine()->setMasterGain(1.0f);
+
+	const auto write = [&output](const surroundSampleFrame* frames, f_cnt_t count)
+	{
+		for (f_cnt_t f = 0; f < count; f += BlockFrames)
+		{
+			output->writeFrames(frames + f, static_cast<fpp_t>(std::min<f_cnt_t>(count - f, BlockFrames)));
+		}
+	};
+
+	// what the segment before rendered past its end
+	auto overlap = std::vector<surroundSampleFrame>{};
+	for (std::size_t i = 0; i < m_segments.size(); ++i)
+	{
+		Segment& segment = *m_segments[i];
+		QFile& file = *segment.audio;
+		file.flush();
+		file.seek(segment.beginFrame * FrameBytes);
+		f_cnt_t frame = segment.beginFrame;
+
+		if (!overlap.empty())
+		{
+			auto head = readFrames(file, std::min<f_cnt_t>(overlap.size(), segment.endFrame - segment.beginFrame));
+			frame += static_cast<f_cnt_t>(head.size());
+
+			// both rendered the same audio, if the pre-roll was long enough
+			auto difference = 0.0;
+			auto energy = 0.0;
+			for (std::size_t f = 0; f < head.size(); ++f)
+			{
+				const auto fade = static_cast<float>((f + 0.5) / head.size());
+				for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+				{
+					const auto before = overlap[f][ch];
+					const auto after = head[f][ch];
+					difference += (before - after) * (before - after);
+					energy += after * after;
+					head[f][ch] = before + (after - before) * fade;
+				}
+			}
+			if (difference > 0 && energy > 0)
+			{
+				const auto mismatch = 10 * std::log10(difference / energy);
+				if (mismatch > MismatchWarningDb)
+				{
+					printf("Segments %d and %d differ by %.1f dB where they meet at bar %d, a longer pre-roll "
+						"would take care of that\n", static_cast<int>(i), static_cast<int>(i + 1), mismatch,
+						segment.begin / TimePos::ticksPerBar() + 1);
+				}
+			}
+			write(head.data(), static_cast<f_cnt_t>(head.size()));
+		}
+
+		while (frame < segment.endFrame)
+		{
+			const auto block = readFrames(file, std::min<f_cnt_t>(segment.endFrame - frame, BlockFrames));
+			if (block.empty()) { break; }
+			write(block.data(), static_cast<f_cnt_t>(block.size()));
+			frame += static_cast<f_cnt_t>(block.size());
+		}
+
+		overlap = readFrames(file, static_cast<f_cnt_t>((file.size() - file.pos()) / FrameBytes));
+		segment.audio.reset();
+	}
+
+	// the last segment ends with the song, what it rendered past that is silence
+	output->finishEncoder();
+	if (m_loudnessReport) { output->writeLoudnessReport(); }
+	return true;
+}
+
+
+
+
+void DistributedRenderer::printProgress() const
+{
+	auto progress = 0;
+	for (const auto& segment : m_segments)
+	{
+		progress += segment->done ? 100 : segment->progress;
+	}
+
+	fprintf(stderr, "\r%3d%%  rendered %d of %d segments", progress / static_cast<int>(m_segments.size()), m_done,
+		static_cast<int>(m_segments.size()));
+}
+
+
+} // namespace lmms
@@ -25,6 +25,9 @@
 
 #include <QDomElement>
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "Effect.h"
 #include "EffectChain.h"
 #include "EffectControls.h"
@@ -35,6 +38,10 @@
 namespace lmms
 {
 
+//! Mean power of a frame of -96 dBFS on both channels, below which effects
+//! that know their tail are considered silent
+static constexpr double SilenceLevel = 5e-10;
+
 
 Effect::Effect( const Plugin::Descriptor * _desc,
 			Model * _parent,
@@ -50,30 +57,22 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	m_wetDryModel( 1.0f, -1.0f, 1.0f, 0.01f, this, tr( "Wet/Dry mix" ) ),
 	m_gateModel( 0.0f, 0.0f, 1.0f, 0.01f, this, tr( "Gate" ) ),
 	m_autoQuitModel( 1.0f, 1.0f, 8000.0f, 100.0f, 1.0f, this, tr( "Decay" ) ),
-	m_autoQuitDisabled( false )
+	m_autoQuitDisabled( false ),
+	m_cpuAccount( Engine::audioEngine()->profiler(), displayName() )
 {
-	m_srcState[0] = m_srcState[1] = nullptr;
-	reinitSRC();
-	
 	if( ConfigManager::inst()->value( "ui", "disableautoquit").toInt() )
 	{
 		m_autoQuitDisabled = true;
 	}
+
+	// models may only be changed from the main thread
+	connect( this, &Effect::quarantined, this, &Effect::switchOffQuarantined, Qt::QueuedConnection );
 }
 
 
 
 
-Effect::~Effect()
-{
-	for (const auto& state : m_srcState)
-	{
-		if (state != nullptr)
-		{
-			src_delete(state);
-		}
-	}
-}
+Effect::~Effect() = default;
 
 
 
@@ -147,7 +146,8 @@ void Effect::checkGate( double _out_sum )
 
 	// Check whether we need to continue processing input.  Restart the
 	// counter if the threshold has been exceeded.
-	if( _out_sum - gate() <= typeInfo<float>::minEps() )
+	const double threshold = tailLength() == UnknownTail ? gate() : std::max<double>( gate(), SilenceLevel );
+	if( _out_sum - threshold <= typeInfo<float>::minEps() )
 	{
 		incrementBufferCount();
 		if( bufferCount() > timeout() )
@@ -165,6 +165,28 @@ void Effect::checkGate( double _out_sum )
 
 
 
+void Effect::quarantine()
+{
+	if( !m_quarantined.exchange( true ) )
+	{
+		emit quarantined();
+	}
+}
+
+
+
+
+void Effect::switchOffQuarantined()
+{
+	qWarning( "Effect \"%s\" produced invalid output and was switched off",
+			qPrintable( displayName() ) );
+	m_enabledModel.setValue( false );
+	m_quarantined = false;
+}
+
+
+
+
 gui::PluginView * Effect::instantiateView( QWidget * _parent )
 {
 	return new gui::EffectView( this, _parent );
@@ -173,19 +195,31 @@ gui::PluginView * Effect::instantiateView( QWidget * _parent )
 	
 
 
-void Effect::reinitSRC()
+void Effect::prepareResampling()
 {
-	for (auto& state : m_srcState)
+	int interpolation = AudioResampler::ShortSinc;
+	switch( resamplingTier() )
+	{
+		case ResamplingTier::Fast:
+			interpolation = AudioResampler::CubicHermite;
+			break;
+		case ResamplingTier::Balanced:
+			interpolation = AudioResampler::ShortSinc;
+			break;
+		case ResamplingTier::Best:
+			interpolation = Engine::audioEngine()->currentQualitySettings().libsrcInterpolation();
+			break;
+	}
+
+	for (auto& resampler : m_resamplers)
 	{
-		if (state != nullptr)
+		try
 		{
-			src_delete(state);
+			resampler = std::make_unique<AudioResampler>(interpolation, DEFAULT_CHANNELS);
 		}
-		int error;
-		const int currentInterpolation = Engine::audioEngine()->currentQualitySettings().libsrcInterpolation();
-		if((state = src_new(currentInterpolation, DEFAULT_CHANNELS, &error)) == nullptr)
+		catch (const std::runtime_error& error)
 		{
-			qFatal( "Error: src_new() failed in effect.cpp!\n" );
+			qFatal( "Effect::prepareResampling(): %s\n", error.what() );
 		}
 	}
 }
@@ -198,21 +232,17 @@ void Effect::resample( int _i, const sampleFrame * _src_buf,
 				sampleFrame * _dst_buf, sample_rate_t _dst_sr,
 								f_cnt_t _frames )
 {
-	if( m_srcState[_i] == nullptr )
+	if( m_resamplers[_i] == nullptr )
 	{
 		return;
 	}
-	m_srcData[_i].input_frames = _frames;
-	m_srcData[_i].output_frames = Engine::audioEngine()->framesPerPeriod();
-	m_srcData[_i].data_in = const_cast<float*>(_src_buf[0].data());
-	m_srcData[_i].data_out = _dst_buf[0].data ();
-	m_srcData[_i].src_ratio = (double) _dst_sr / _src_sr;
-	m_srcData[_i].end_of_input = 0;
-	int error;
-	if( ( error = src_process( m_srcState[_i], &m_srcData[_i] ) ) )
+	const auto result = m_resamplers[_i]->resample( _src_buf[0].data(), _frames,
+		_dst_buf[0].data(), Engine::audioEngine()->framesPerPeriod(),
+		static_cast<double>( _dst_sr ) / _src_sr );
+	if( result.error )
 	{
 		qFatal( "Effect::resample(): error while resampling: %s\n",
-							src_strerror( error ) );
+							src_strerror( result.error ) );
 	}
 }
 
@@ -25,21 +25,88 @@
 
 
 #include <QDomElement>
+#include <algorithm>
+#include <array>
 #include <cassert>
 
+#include "AudioEngineWorkerThread.h"
 #include "EffectChain.h"
 #include "Effect.h"
 #include "DummyEffect.h"
 #include "MixHelpers.h"
+#include "ThreadableJob.h"
 
 namespace lmms
 {
 
 
+//! One effect of a pipelined chain, processing the buffer it's given as a
+//! job of its own
+class EffectChain::Stage : public ThreadableJob
+{
+public:
+	Stage( fpp_t frames ) :
+		m_planarBuffer( frames )
+	{
+	}
+
+	bool requiresProcessing() const override
+	{
+		return true;
+	}
+
+	//! Set before the stage is processed
+	Effect * m_effect = nullptr;
+	sampleFrame * m_buffer = nullptr;
+	fpp_t m_frames = 0;
+	bool m_hasInputNoise = false;
+	bool m_sanitize = false;
+	bool m_quarantineIfBad = false;
+
+	//! What the effect returned, false if it didn't run
+	bool m_stillRunning = false;
+
+private:
+	void doProcessing() override
+	{
+		m_stillRunning = false;
+		if( m_effect->isQuarantined() || !( m_hasInputNoise || m_effect->isRunning() ) )
+		{
+			return;
+		}
+
+		AudioEngineProfiler::AccountProbe profilerProbe( m_effect->m_cpuAccount );
+		if( m_effect->processesPlanar() )
+		{
+			m_planarBuffer.deinterleave( m_buffer, m_frames );
+			m_stillRunning = m_effect->processPlanarBuffer( m_planarBuffer, m_frames );
+			m_planarBuffer.interleave( m_buffer, m_frames );
+		}
+		else
+		{
+			m_stillRunning = m_effect->processAudioBuffer( m_buffer, m_frames );
+		}
+
+		if( m_sanitize && MixHelpers::sanitize( m_buffer, m_frames ) && m_quarantineIfBad )
+		{
+			m_effect->quarantine();
+		}
+	}
+
+	PlanarBuffer m_planarBuffer;
+} ;
+
+
+bool EffectChain::s_sanitizeEveryEffect = false;
+
+
 EffectChain::EffectChain( Model * _parent ) :
 	Model( _parent ),
 	SerializingObject(),
-	m_enabledModel( false, nullptr, tr( "Effects enabled" ) )
+	m_enabledModel( false, nullptr, tr( "Effects enabled" ) ),
+	m_findBadEffect( false ),
+	m_planarBuffer( Engine::audioEngine()->framesPerPeriod() ),
+	m_pipelinedModel( false, nullptr, tr( "Pipelined effects" ) )
 {
 }
 
@@ -57,6 +124,10 @@ EffectChain::~EffectChain()
 void EffectChain::saveSettings( QDomDocument & _doc, QDomElement & _this )
 {
 	m_enabledModel.saveSettings( _doc, _this, "enabled" );
+	if( m_pipelinedModel.value() )
+	{
+		m_pipelinedModel.saveSettings( _doc, _this, "pipelined" );
+	}
 	_this.setAttribute("numofeffects", static_cast<int>(m_effects.size()));
 
 	for( Effect* effect : m_effects)
@@ -78,9 +149,9 @@ void EffectChain::loadSettings( const QDomElement & _this )
 {
 	clear();
 
-	// TODO This method should probably also lock the audio engine
-
 	m_enabledModel.loadSettings( _this, "enabled" );
+	m_pipelinedModel.setValue( false );
+	m_pipelinedModel.loadSettings( _this, "pipelined" );
 
 	const int plugin_cnt = _this.attribute( "numofeffects" ).toInt();
 
@@ -112,6 +183,7 @@ void EffectChain::loadSettings( const QDomElement & _this )
 		}
 		node = node.nextSibling();
 	}
+	publish();
 
 	emit dataChanged();
 }
@@ -121,9 +193,8 @@ void EffectChain::loadSettings( const QDomElement & _this )
 
 void EffectChain::appendEffect( Effect * _effect )
 {
-	Engine::audioEngine()->requestChangeInModel();
 	m_effects.push_back(_effect);
-	Engine::audioEngine()->doneChangeInModel();
+	publish();
 
 	m_enabledModel.setValue( true );
 
@@ -135,17 +206,13 @@ void EffectChain::appendEffect( Effect * _effect )
 
 void EffectChain::removeEffect( Effect * _effect )
 {
-	Engine::audioEngine()->requestChangeInModel();
-
 	auto found = std::find(m_effects.begin(), m_effects.end(), _effect);
 	if( found == m_effects.end() )
 	{
-		Engine::audioEngine()->doneChangeInModel();
 		return;
 	}
 	m_effects.erase( found );
-
-	Engine::audioEngine()->doneChangeInModel();
+	publish();
 
 	if (m_effects.empty())
 	{
@@ -165,6 +232,7 @@ void EffectChain::moveDown( Effect * _effect )
 		auto it = std::find(m_effects.begin(), m_effects.end(), _effect);
 		assert(it != m_effects.end());
 		std::swap(*std::next(it), *it);
+		publish();
 	}
 }
 
@@ -178,6 +246,7 @@ void EffectChain::moveUp( Effect * _effect )
 		auto it = std::find(m_effects.begin(), m_effects.end(), _effect);
 		assert(it != m_effects.end());
 		std::swap(*std::prev(it), *it);
+		publish();
 	}
 }
 
@@ -186,29 +255,331 @@ void EffectChain::moveUp( Effect * _effect )
 
 bool EffectChain::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise )
 {
-	if( m_enabledModel.value() == false )
+	Processing & processing = *m_processing.get();
+	const EffectList & effects = processing.effects;
+
+	// silence in, silence out - no need to sanitize either
+	if( !isActive( hasInputNoise ) )
 	{
+		processing.pipelineRunning = false;
 		return false;
 	}
 
-	MixHelpers::sanitize( _buf, _frames );
+	if( m_pipelinedModel.value() && effects.size() > 1 )
+	{
+		return processPipelined( processing, _buf, _frames, hasInputNoise );
+	}
+	processing.pipelineRunning = false;
+
+	const bool sanitizeEveryEffect = s_sanitizeEveryEffect || m_findBadEffect;
+	if( sanitizeEveryEffect )
+	{
+		MixHelpers::sanitize( _buf, _frames );
+	}
 
 	bool moreEffects = false;
-	for (const auto& effect : m_effects)
+	bool planar = false;
+	for (auto it = effects.begin(); it != effects.end(); ++it)
 	{
+		Effect* effect = *it;
+		if (effect->isQuarantined()) { continue; }
+
+		// consecutive effects processing frame by frame take a single pass,
+		// unless each one's output has to be checked
+		if (effect->processesFrames() && !sanitizeEveryEffect && (hasInputNoise || effect->isRunning()))
+		{
+			auto fused = std::array<Effect*, MaxFusedEffects>{};
+			std::size_t count = 0;
+			auto last = it;
+			for (auto next = it; next != effects.end() && count < MaxFusedEffects; ++next)
+			{
+				if ((*next)->isQuarantined() || !(hasInputNoise || (*next)->isRunning())) { continue; }
+				if (!(*next)->processesFrames()) { break; }
+				fused[count++] = *next;
+				last = next;
+			}
+
+			if (count > 1)
+			{
+				if (planar)
+				{
+					planar = false;
+					m_planarBuffer.interleave(_buf, _frames);
+				}
+				moreEffects |= processFrames(fused.data(), count, _buf, _frames);
+				it = last;
+				continue;
+			}
+		}
+
 		if (hasInputNoise || effect->isRunning())
 		{
-			moreEffects |= effect->processAudioBuffer(_buf, _frames);
-			MixHelpers::sanitize(_buf, _frames);
+			// only convert where the layout changes between two effects
+			if (effect->processesPlanar() != planar)
+			{
+				planar = !planar;
+				if (planar) { m_planarBuffer.deinterleave(_buf, _frames); }
+				else { m_planarBuffer.interleave(_buf, _frames); }
+			}
+
+			AudioEngineProfiler::AccountProbe profilerProbe(effect->m_cpuAccount);
+			bool bad = false;
+			if (planar)
+			{
+				moreEffects |= effect->processPlanarBuffer(m_planarBuffer, _frames);
+				if (sanitizeEveryEffect && (MixHelpers::sanitize(m_planarBuffer.channel(0), _frames)
+					|| MixHelpers::sanitize(m_planarBuffer.channel(1), _frames)))
+				{
+					m_planarBuffer.clear(_frames);
+					bad = true;
+				}
+			}
+			else
+			{
+				moreEffects |= effect->processAudioBuffer(_buf, _frames);
+				bad = sanitizeEveryEffect && MixHelpers::sanitize(_buf, _frames);
+			}
+
+			if (bad && m_findBadEffect)
+			{
+				effect->quarantine();
+			}
 		}
 	}
 
+	if (planar)
+	{
+		m_planarBuffer.interleave(_buf, _frames);
+	}
+
+	if (m_findBadEffect)
+	{
+		// could have been a one-off, go back to checking the output only
+		m_findBadEffect = false;
+	}
+	else if (!s_sanitizeEveryEffect && MixHelpers::sanitize(_buf, _frames))
+	{
+		// relies on denormals being flushed to zero, we only look for infs
+		// and nans, and check every effect next time to find the culprit
+		m_findBadEffect = true;
+	}
+
 	return moreEffects;
 }
 
 
 
 
+bool EffectChain::processFrames( Effect * const * effects, std::size_t count, sampleFrame * _buf, const fpp_t _frames )
+{
+	MicroTimer timer;
+
+	// the effects that process this buffer at all
+	auto active = std::array<Effect*, MaxFusedEffects>{};
+	std::size_t activeCount = 0;
+	for( std::size_t e = 0; e < count; ++e )
+	{
+		if( effects[e]->startFrames( _frames ) )
+		{
+			active[activeCount++] = effects[e];
+		}
+	}
+
+	auto outSums = std::array<double, MaxFusedEffects>{};
+	for( fpp_t f = 0; f < _frames; ++f )
+	{
+		sampleFrame & frame = _buf[f];
+		for( std::size_t e = 0; e < activeCount; ++e )
+		{
+			active[e]->processFrame( frame, f );
+			outSums[e] += frame[0] * frame[0] + frame[1] * frame[1];
+		}
+	}
+
+	bool moreEffects = false;
+	for( std::size_t e = 0; e < activeCount; ++e )
+	{
+		moreEffects |= active[e]->finishFrames( outSums[e], _frames );
+	}
+
+	// the time can't be told apart anymore, share it evenly
+	const int time = timer.elapsed() / static_cast<int>( count );
+	for( std::size_t e = 0; e < count; ++e )
+	{
+		effects[e]->m_cpuAccount.add( time );
+	}
+
+	return moreEffects;
+}
+
+
+
+
+bool EffectChain::processPipelined( Processing & processing, sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise )
+{
+	const std::size_t stages = processing.stages.size();
+	if( !processing.pipelineRunning )
+	{
+		// whatever is left from the last time is long gone
+		for( PipelineBuffer & buffer : processing.pipelineBuffers )
+		{
+			buffer.hasInput = false;
+		}
+		processing.pipelineRunning = true;
+	}
+
+	const bool sanitizeEveryEffect = s_sanitizeEveryEffect || m_findBadEffect;
+	PipelineBuffer & input = processing.pipelineBuffers[processing.pipelineHead];
+	std::copy( _buf, _buf + _frames, input.frames.begin() );
+	input.hasInput = hasInputNoise;
+	if( sanitizeEveryEffect )
+	{
+		MixHelpers::sanitize( input.frames.data(), _frames );
+	}
+
+	for( std::size_t i = 0; i < stages; ++i )
+	{
+		Stage & stage = *processing.stages[i];
+		stage.m_effect = processing.effects[i];
+		PipelineBuffer & buffer = processing.pipelineBuffers[( processing.pipelineHead + i ) % stages];
+		stage.m_buffer = buffer.frames.data();
+		stage.m_frames = _frames;
+		stage.m_hasInputNoise = buffer.hasInput;
+		stage.m_sanitize = sanitizeEveryEffect;
+		stage.m_quarantineIfBad = m_findBadEffect;
+		stage.reset();
+	}
+
+	// the later stages go to other workers, the first one is processed
+	// right here. Outside of the workers, they are processed one after the
+	// other, which gives the same result.
+	const bool parallel = AudioEngineWorkerThread::currentWorker() < AudioEngineWorkerThread::workerCount();
+	for( std::size_t i = stages - 1; i > 0; --i )
+	{
+		if( !parallel || !AudioEngineWorkerThread::addJob( processing.stages[i].get() ) )
+		{
+			processing.stages[i]->queue();
+			processing.stages[i]->process();
+		}
+	}
+	processing.stages[0]->queue();
+	processing.stages[0]->process();
+
+	const auto pending = [&processing]
+	{
+		return std::any_of( processing.stages.begin(), processing.stages.end(),
+			[]( const std::unique_ptr<Stage> & stage ) { return stage->state() != ThreadableJob::ProcessingState::Done; } );
+	};
+	while( pending() )
+	{
+		AudioEngineWorkerThread::processOneJob();
+	}
+
+	bool moreEffects = false;
+	for( std::size_t i = 0; i < stages; ++i )
+	{
+		PipelineBuffer & buffer = processing.pipelineBuffers[( processing.pipelineHead + i ) % stages];
+		buffer.hasInput |= processing.stages[i]->m_stillRunning;
+		moreEffects |= buffer.hasInput;
+	}
+
+	// the output of the last stage goes out, and its buffer takes the next
+	// input - the others move on to the next stage
+	const std::size_t last = ( processing.pipelineHead + stages - 1 ) % stages;
+	PipelineBuffer & output = processing.pipelineBuffers[last];
+	std::copy( output.frames.begin(), output.frames.begin() + _frames, _buf );
+	output.hasInput = false;
+	processing.pipelineHead = last;
+
+	if( m_findBadEffect )
+	{
+		m_findBadEffect = false;
+	}
+	else if( !s_sanitizeEveryEffect && MixHelpers::sanitize( _buf, _frames ) )
+	{
+		m_findBadEffect = true;
+	}
+
+	return moreEffects;
+}
+
+
+
+
+void EffectChain::publish()
+{
+	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+
+	auto processing = std::make_unique<Processing>();
+	processing->effects = m_effects;
+	for( std::size_t i = 0; i < m_effects.size(); ++i )
+	{
+		processing->stages.push_back( std::make_unique<Stage>( frames ) );
+	}
+	processing->pipelineBuffers.resize( m_effects.size() );
+	for( PipelineBuffer & buffer : processing->pipelineBuffers )
+	{
+		buffer.frames.resize( frames );
+	}
+
+	m_processing.publish( std::move( processing ) );
+}
+
+
+
+
+f_cnt_t EffectChain::latency() const
+{
+	if( !m_enabledModel.value() )
+	{
+		return 0;
+	}
+
+	// effects that are switched off don't delay anything, those that
+	// merely stopped running because of silence still do once they restart
+	const EffectList & effects = m_processing->effects;
+	f_cnt_t frames = 0;
+	for( const Effect * effect : effects )
+	{
+		if( effect->isEnabled() && !effect->isQuarantined() )
+		{
+			frames += effect->latency();
+		}
+	}
+
+	if( m_pipelinedModel.value() && effects.size() > 1 )
+	{
+		frames += static_cast<f_cnt_t>( effects.size() - 1 ) * Engine::audioEngine()->framesPerPeriod();
+	}
+	return frames;
+}
+
+
+
+
+bool EffectChain::isActive( bool hasInputNoise ) const
+{
+	if( m_enabledModel.value() == false )
+	{
+		return false;
+	}
+
+	const Processing & processing = *m_processing.get();
+
+	// audio still on its way through the pipeline has to come out
+	if( processing.pipelineRunning && std::any_of( processing.pipelineBuffers.begin(), processing.pipelineBuffers.end(),
+		[]( const PipelineBuffer & buffer ) { return buffer.hasInput; } ) )
+	{
+		return true;
+	}
+
+	return hasInputNoise || std::any_of( processing.effects.begin(), processing.effects.end(),
+		[]( const Effect * effect ) { return effect->isRunning(); } );
+}
+
+
+
+
 void EffectChain::startRunning()
 {
 	if( m_enabledModel.value() == false )
@@ -216,7 +587,7 @@ void EffectChain::startRunning()
 		return;
 	}
 
-	for (const auto& effect : m_effects)
+	for (const auto& effect : m_processing->effects)
 	{
 		effect->startRunning();
 	}
@@ -229,17 +600,16 @@ void EffectChain::clear()
 {
 	emit aboutToClear();
 
-	Engine::audioEngine()->requestChangeInModel();
+	// deleted once they aren't processed anymore
+	const EffectList removed = std::move( m_effects );
+	m_effects.clear();
+	publish();
 
-	while (m_effects.size())
+	for( auto it = removed.rbegin(); it != removed.rend(); ++it )
 	{
-		auto e = m_effects[m_effects.size() - 1];
-		m_effects.pop_back();
-		delete e;
+		delete *it;
 	}
 
-	Engine::audioEngine()->doneChangeInModel();
-
 	m_enabledModel.setValue( false );
 }
 
@@ -24,6 +24,12 @@
 
 
 #include "Engine.h"
+
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <memory>
+
 #include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Mixer.h"
@@ -31,15 +37,64 @@
 #include "Lv2Manager.h"
 #include "PatternStore.h"
 #include "Plugin.h"
+#include "PluginFactory.h"
 #include "PresetPreviewPlayHandle.h"
 #include "ProjectJournal.h"
 #include "Song.h"
 #include "BandLimitedWave.h"
 #include "Oscillator.h"
+#include "fft_helpers.h"
 
 namespace lmms
 {
 
+namespace
+{
+
+//! A part of the start up that runs next to the others
+class InitTask : public QThread
+{
+public:
+	explicit InitTask(std::function<void()> task) :
+		m_task(std::move(task))
+	{
+		start();
+	}
+
+	//! Returns at once when the task is done, so it's fine to call often
+	void waitUntilDone()
+	{
+		if (!m_done.load(std::memory_order_acquire)) { wait(); }
+	}
+
+private:
+	void run() override
+	{
+		m_task();
+		m_done.store(true, std::memory_order_release);
+	}
+
+	std::function<void()> m_task;
+	std::atomic_bool m_done{false};
+};
+
+std::unique_ptr<InitTask> s_ladspaScan;
+#ifdef LMMS_HAVE_LV2
+std::unique_ptr<InitTask> s_lv2Scan;
+#endif
+std::unique_ptr<InitTask> s_pluginDiscovery;
+
+void finishTask(std::unique_ptr<InitTask>& task)
+{
+	if (task)
+	{
+		task->wait();
+		task.reset();
+	}
+}
+
+} // namespace
+
 float Engine::s_framesPerTick;
 AudioEngine* Engine::s_audioEngine = nullptr;
 Mixer * Engine::s_mixer = nullptr;
@@ -55,7 +110,7 @@ void* Engine::s_dndPluginKey = nullptr;
 
 
 
-void Engine::init( bool renderOnly )
+void Engine::init( bool renderOnly, fpp_t renderFramesPerPeriod )
 {
 	Engine *engine = inst();
 
@@ -67,17 +122,31 @@ void Engine::init( bool renderOnly )
 
 	emit engine->initProgress(tr("Initializing data structures"));
 	s_projectJournal = new ProjectJournal;
-	s_audioEngine = new AudioEngine( renderOnly );
+	s_audioEngine = new AudioEngine( renderOnly,
+		renderFramesPerPeriod > 0 ? renderFramesPerPeriod : DEFAULT_BUFFER_SIZE );
+
+	// nothing needs the plugins before a project is loaded or the main window
+	// is set up, so they are scanned while the rest is initialized. The
+	// plugin factory lists the LADSPA and LV2 plugins, which waits for them.
+	emit engine->initProgress(tr("Scanning plugins"));
+	s_ladspaScan = std::make_unique<InitTask>([] { s_ladspaManager = new Ladspa2LMMS; });
+#ifdef LMMS_HAVE_LV2
+	s_lv2Scan = std::make_unique<InitTask>([]
+	{
+		s_lv2Manager = new Lv2Manager;
+		s_lv2Manager->initPlugins();
+	});
+#endif
+	if (!renderOnly)
+	{
+		// rendering loads the plugins on demand
+		s_pluginDiscovery = std::make_unique<InitTask>([] { getPluginFactory(); });
+	}
+
 	s_song = new Song;
 	s_mixer = new Mixer;
 	s_patternStore = new PatternStore;
 
-#ifdef LMMS_HAVE_LV2
-	s_lv2Manager = new Lv2Manager;
-	s_lv2Manager->initPlugins();
-#endif
-	s_ladspaManager = new Ladspa2LMMS;
-
 	s_projectJournal->setJournalling( true );
 
 	emit engine->initProgress(tr("Opening audio and midi devices"));
@@ -94,6 +163,13 @@ void Engine::init( bool renderOnly )
 
 void Engine::destroy()
 {
+	// the plugins may still be scanned if LMMS quits right away
+	finishTask(s_pluginDiscovery);
+	finishTask(s_ladspaScan);
+#ifdef LMMS_HAVE_LV2
+	finishTask(s_lv2Scan);
+#endif
+
 	s_projectJournal->stopAllJournalling();
 	s_audioEngine->stopProcessing();
 
@@ -121,6 +197,27 @@ void Engine::destroy()
 	// The oscillator FFT plans remain throughout the application lifecycle
 	// due to being expensive to create, and being used whenever a userwave form is changed
 	Oscillator::destroyFFTPlans();
+	destroySharedFFTPlans();
+}
+
+
+
+
+#ifdef LMMS_HAVE_LV2
+Lv2Manager * Engine::getLv2Manager()
+{
+	if (s_lv2Scan) { s_lv2Scan->waitUntilDone(); }
+	return s_lv2Manager;
+}
+#endif
+
+
+
+
+Ladspa2LMMS * Engine::getLADSPAManager()
+{
+	if (s_ladspaScan) { s_ladspaScan->waitUntilDone(); }
+	return s_ladspaManager;
 }
 
 
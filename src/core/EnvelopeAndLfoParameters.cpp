@@ -26,6 +26,7 @@
 
 #include <QDomElement>
 #include <QFileInfo>
+#include <algorithm>
 
 #include "AudioEngine.h"
 #include "Engine.h"
@@ -55,6 +56,7 @@ void EnvelopeAndLfoParameters::LfoInstances::trigger()
 	{
 		lfo->m_lfoFrame += Engine::audioEngine()->framesPerPeriod();
 		lfo->m_bad_lfoShapeData = true;
+		lfo->m_levelsCached = false;
 	}
 }
 
@@ -68,6 +70,7 @@ void EnvelopeAndLfoParameters::LfoInstances::reset()
 	{
 		lfo->m_lfoFrame = 0;
 		lfo->m_bad_lfoShapeData = true;
+		lfo->m_levelsCached = false;
 	}
 }
 
@@ -122,7 +125,8 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_controlEnvAmountModel( false, this, tr( "Modulate env amount" ) ),
 	m_lfoFrame( 0 ),
 	m_lfoAmountIsZero( false ),
-	m_lfoShapeData(nullptr)
+	m_lfoShapeData(nullptr),
+	m_levels(nullptr)
 {
 	m_amountModel.setCenterValue( 0 );
 	m_lfoAmountModel.setCenterValue( 0 );
@@ -168,6 +172,7 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 
 	m_lfoShapeData =
 		new sample_t[Engine::audioEngine()->framesPerPeriod()];
+	m_levels = new float[Engine::audioEngine()->framesPerPeriod()];
 
 	updateSampleVars();
 }
@@ -194,6 +199,7 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 	delete[] m_pahdEnv;
 	delete[] m_rEnv;
 	delete[] m_lfoShapeData;
+	delete[] m_levels;
 
 	instances()->remove( this );
 
@@ -207,51 +213,70 @@ EnvelopeAndLfoParameters::~EnvelopeAndLfoParameters()
 
 
 
-inline sample_t EnvelopeAndLfoParameters::lfoShapeSample( fpp_t _frame_offset )
+template<typename ShapeFunction>
+inline void EnvelopeAndLfoParameters::fillLfoShapeData( fpp_t _frames, ShapeFunction _shape )
 {
-	f_cnt_t frame = ( m_lfoFrame + _frame_offset ) % m_lfoOscillationFrames;
-	const float phase = frame / static_cast<float>(
-						m_lfoOscillationFrames );
-	sample_t shape_sample;
+	// wrap the phase around instead of taking the modulo of every frame, and
+	// with the shape a lambda of its own it's inlined instead of switched on
+	f_cnt_t frame = m_lfoFrame % m_lfoOscillationFrames;
+	const float oscillationFrames = static_cast<float>( m_lfoOscillationFrames );
+	for( fpp_t offset = 0; offset < _frames; ++offset )
+	{
+		m_lfoShapeData[offset] = _shape( frame / oscillationFrames ) * m_lfoAmount;
+		if( ++frame == m_lfoOscillationFrames )
+		{
+			frame = 0;
+		}
+	}
+}
+
+
+
+
+void EnvelopeAndLfoParameters::updateLfoShapeData()
+{
+	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
 	switch( static_cast<LfoShape>(m_lfoWaveModel.value())  )
 	{
 		case LfoShape::TriangleWave:
-			shape_sample = Oscillator::triangleSample( phase );
+			fillLfoShapeData( frames, []( float phase ) { return Oscillator::triangleSample( phase ); } );
 			break;
 		case LfoShape::SquareWave:
-			shape_sample = Oscillator::squareSample( phase );
+			fillLfoShapeData( frames, []( float phase ) { return Oscillator::squareSample( phase ); } );
 			break;
 		case LfoShape::SawWave:
-			shape_sample = Oscillator::sawSample( phase );
+			fillLfoShapeData( frames, []( float phase ) { return Oscillator::sawSample( phase ); } );
 			break;
 		case LfoShape::UserDefinedWave:
-			shape_sample = Oscillator::userWaveSample(m_userWave.get(), phase);
+		{
+			const SampleBuffer* userWave = m_userWave.get();
+			fillLfoShapeData( frames, [userWave]( float phase )
+				{ return Oscillator::userWaveSample( userWave, phase ); } );
 			break;
+		}
 		case LfoShape::RandomWave:
-			if( frame == 0 )
+		{
+			// a new random value at the start of every oscillation
+			f_cnt_t frame = m_lfoFrame % m_lfoOscillationFrames;
+			for( fpp_t offset = 0; offset < frames; ++offset )
 			{
-				m_random = Oscillator::noiseSample( 0.0f );
+				if( frame == 0 )
+				{
+					m_random = Oscillator::noiseSample( 0.0f );
+				}
+				m_lfoShapeData[offset] = m_random * m_lfoAmount;
+				if( ++frame == m_lfoOscillationFrames )
+				{
+					frame = 0;
+				}
 			}
-			shape_sample = m_random;
 			break;
+		}
 		case LfoShape::SineWave:
 		default:
-			shape_sample = Oscillator::sinSample( phase );
+			fillLfoShapeData( frames, []( float phase ) { return Oscillator::sinSample( phase ); } );
 			break;
 	}
-	return shape_sample * m_lfoAmount;
-}
-
-
-
-
-void EnvelopeAndLfoParameters::updateLfoShapeData()
-{
-	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
-	for( fpp_t offset = 0; offset < frames; ++offset )
-	{
-		m_lfoShapeData[offset] = lfoShapeSample( offset );
-	}
 	m_bad_lfoShapeData = false;
 }
 
@@ -293,6 +318,39 @@ inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
 
 
 
+inline void EnvelopeAndLfoParameters::fillEnvLevel( float * _buf, f_cnt_t _frame,
+						const f_cnt_t _release_begin,
+						const fpp_t _frames )
+{
+	// a run of each stage the period covers instead of a branch per frame:
+	// pre-delay, attack, hold and decay, sustain, release and silence
+	const auto framesUntil = [_frame, _frames]( f_cnt_t _end )
+	{
+		return static_cast<fpp_t>( std::clamp<f_cnt_t>( _end - _frame, 0, _frames ) );
+	};
+
+	const fpp_t pahdEnd = framesUntil( std::min( _release_begin, m_pahdFrames ) );
+	const fpp_t sustainEnd = std::max( pahdEnd, framesUntil( _release_begin ) );
+	const fpp_t releaseEnd = std::max( sustainEnd, framesUntil( _release_begin + m_rFrames ) );
+
+	if( pahdEnd > 0 )
+	{
+		std::copy_n( m_pahdEnv + _frame, pahdEnd, _buf );
+	}
+	std::fill( _buf + pahdEnd, _buf + sustainEnd, m_sustainLevel );
+
+	const float releaseLevel = _release_begin < m_pahdFrames ?
+				m_pahdEnv[_release_begin] : m_sustainLevel;
+	for( fpp_t offset = sustainEnd; offset < releaseEnd; ++offset )
+	{
+		_buf[offset] = m_rEnv[_frame + offset - _release_begin] * releaseLevel;
+	}
+	std::fill( _buf + releaseEnd, _buf + _frames, 0.0f );
+}
+
+
+
+
 void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 						const f_cnt_t _release_begin,
 						const fpp_t _frames )
@@ -304,38 +362,40 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 		return;
 	}
 
+	// the LFO is the same for all notes of the track and the envelope only
+	// depends on where a note is, so the notes of a chord or those played
+	// at once otherwise get the levels the first of them got
+	if( m_levelsCached && _frame == m_cachedFrame &&
+		_release_begin == m_cachedReleaseBegin && _frames == m_cachedFrames )
+	{
+		std::copy_n( m_levels, _frames, _buf );
+		return;
+	}
+
 	fillLfoLevel( _buf, _frame, _frames );
+	fillEnvLevel( m_levels, _frame, _release_begin, _frames );
 
-	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
+	// at this point, _buf is the LFO level and m_levels the envelope level
+	if( m_controlEnvAmountModel.value() )
 	{
-		float env_level;
-		if( _frame < _release_begin )
-		{
-			if( _frame < m_pahdFrames )
-			{
-				env_level = m_pahdEnv[_frame];
-			}
-			else
-			{
-				env_level = m_sustainLevel;
-			}
-		}
-		else if( ( _frame - _release_begin ) < m_rFrames )
+		for( fpp_t offset = 0; offset < _frames; ++offset )
 		{
-			env_level = m_rEnv[_frame - _release_begin] *
-				( ( _release_begin < m_pahdFrames ) ?
-				m_pahdEnv[_release_begin] : m_sustainLevel );
+			m_levels[offset] *= 0.5f + _buf[offset];
 		}
-		else
+	}
+	else
+	{
+		for( fpp_t offset = 0; offset < _frames; ++offset )
 		{
-			env_level = 0.0f;
+			m_levels[offset] += _buf[offset];
 		}
-
-		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
-			env_level * ( 0.5f + *_buf ) :
-			env_level + *_buf;
 	}
+	std::copy_n( m_levels, _frames, _buf );
+
+	m_levelsCached = true;
+	m_cachedFrame = _frame;
+	m_cachedReleaseBegin = _release_begin;
+	m_cachedFrames = _frames;
 }
 
 
@@ -538,6 +598,7 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 	}
 
 	m_bad_lfoShapeData = true;
+	m_levelsCached = false;
 
 	emit dataChanged();
 
@@ -26,9 +26,14 @@
 
 #include <cmath>
 
+#include "AudioEngine.h"
+#include "AutomatableModel.h"
+#include "BufferManager.h"
 #include "DummyInstrument.h"
+#include "Engine.h"
 #include "InstrumentTrack.h"
 #include "lmms_constants.h"
+#include "MixHelpers.h"
 
 
 namespace lmms
@@ -39,7 +44,8 @@ Instrument::Instrument(InstrumentTrack * _instrument_track,
 			const Descriptor * _descriptor,
 			const Descriptor::SubPluginFeatures::Key *key) :
 	Plugin(_descriptor, nullptr/* _instrument_track*/, key),
-	m_instrumentTrack( _instrument_track )
+	m_instrumentTrack( _instrument_track ),
+	m_noteBatchPeriod( -1 )
 {
 }
 
@@ -65,6 +71,51 @@ f_cnt_t Instrument::beatLen( NotePlayHandle * ) const
 
 
 
+void Instrument::playNotes( NotePlayHandle * const * _notes, std::size_t _count,
+					sampleFrame * _working_buf )
+{
+	// render them one by one, like without batching
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	auto noteBuf = PeriodAllocator<sampleFrame>::vector( fpp );
+	for( std::size_t i = 0; i < _count; ++i )
+	{
+		BufferManager::clear( noteBuf.data(), fpp );
+		playNote( _notes[i], noteBuf.data() );
+		mixNote( _notes[i], noteBuf.data(), _working_buf );
+	}
+}
+
+
+
+
+NotePlayHandle * Instrument::queueBatchedNote( NotePlayHandle * _n )
+{
+	const long period = AutomatableModel::periodCounter();
+	if( m_noteBatchPeriod != period )
+	{
+		// the notes of the last period and the memory they were kept in
+		// are gone by now
+		m_noteBatch = PeriodAllocator<NotePlayHandle *>::vector();
+		m_noteBatchPeriod = period;
+	}
+	m_noteBatch.push_back( _n );
+	return m_noteBatch.front();
+}
+
+
+
+
+void Instrument::mixNote( NotePlayHandle * _n, sampleFrame * _note_buf, sampleFrame * _working_buf )
+{
+	const fpp_t frames = _n->framesLeftForCurrentPeriod();
+	const f_cnt_t offset = _n->noteOffset();
+	m_instrumentTrack->processAudioBuffer( _note_buf, frames + offset, _n );
+	MixHelpers::add( _working_buf + offset, _note_buf + offset, frames );
+}
+
+
+
+
 Instrument *Instrument::instantiate(const QString &_plugin_name,
 	InstrumentTrack *_instrument_track, const Descriptor::SubPluginFeatures::Key *key, bool keyFromDnd)
 {
@@ -239,17 +239,17 @@ void InstrumentFunctionNoteStacking::processNote( NotePlayHandle * _n )
 			m_chordsEnabledModel.value() == true && ! _n->isReleased() )
 	{
 		// then insert sub-notes for chord
-		const int selected_chord = m_chordsModel.value();
+		const Chord & chord = chord_table.chords()[m_chordsModel.value()];
 
 		for( int octave_cnt = 0; octave_cnt < m_chordRangeModel.value(); ++octave_cnt )
 		{
 			const int sub_note_key_base = base_note_key + octave_cnt * KeysPerOctave;
 
 			// process all notes in the chord
-			for( int i = 0; i < chord_table.chords()[selected_chord].size(); ++i )
+			for( int i = 0; i < chord.size(); ++i )
 			{
 				// add interval to sub-note-key
-				const int sub_note_key = sub_note_key_base + (int) chord_table.chords()[selected_chord][i];
+				const int sub_note_key = sub_note_key_base + (int) chord[i];
 				// maybe we're out of range -> let's get outta
 				// here!
 				if( sub_note_key > NumKeys )
@@ -363,8 +363,9 @@ void InstrumentFunctionArpeggio::processNote( NotePlayHandle * _n )
 		}
 	}
 
-	const InstrumentFunctionNoteStacking::ChordTable & chord_table = InstrumentFunctionNoteStacking::ChordTable::getInstance();
-	const int cur_chord_size = chord_table.chords()[selected_arp].size();
+	const InstrumentFunctionNoteStacking::Chord & chord =
+		InstrumentFunctionNoteStacking::ChordTable::getInstance().chords()[selected_arp];
+	const int cur_chord_size = chord.size();
 	const int range = static_cast<int>(cur_chord_size * m_arpRangeModel.value() * m_arpRepeatsModel.value());
 	const int total_range = range * cnphv.size();
 
@@ -376,10 +377,10 @@ void InstrumentFunctionArpeggio::processNote( NotePlayHandle * _n )
 	// arp_frames-1, otherwise the first arp-note will not be setup
 	// correctly... -> arp_frames frames silence at the start of every note!
 	int cur_frame = ( ( static_cast<ArpMode>(m_arpModeModel.value()) != ArpMode::Free ) ?
-						cnphv.first()->totalFramesPlayed() :
+						cnphv.front()->totalFramesPlayed() :
 						_n->totalFramesPlayed() ) + arp_frames - 1;
 	// used for loop
-	f_cnt_t frames_processed = ( static_cast<ArpMode>(m_arpModeModel.value()) != ArpMode::Free ) ? cnphv.first()->noteOffset() : _n->noteOffset();
+	f_cnt_t frames_processed = ( static_cast<ArpMode>(m_arpModeModel.value()) != ArpMode::Free ) ? cnphv.front()->noteOffset() : _n->noteOffset();
 
 	while( frames_processed < Engine::audioEngine()->framesPerPeriod() )
 	{
@@ -487,7 +488,7 @@ void InstrumentFunctionArpeggio::processNote( NotePlayHandle * _n )
 
 		// now calculate final key for our arp-note
 		const int sub_note_key = base_note_key + (cur_arp_idx / cur_chord_size ) *
-							KeysPerOctave + chord_table.chords()[selected_arp][cur_arp_idx % cur_chord_size];
+							KeysPerOctave + chord[cur_arp_idx % cur_chord_size];
 
 		// range-checking
 		if( sub_note_key >= NumKeys ||
@@ -28,6 +28,7 @@
 #include "InstrumentTrack.h"
 #include "Engine.h"
 #include "AudioEngine.h"
+#include "TrackFreezer.h"
 
 namespace lmms
 {
@@ -46,6 +47,12 @@ void InstrumentPlayHandle::play(sampleFrame * working_buffer)
 
 	// ensure that all our nph's have been processed first
 	auto nphv = NotePlayHandle::nphsOfInstrumentTrack(instrumentTrack, true);
+
+	// frozen tracks only need the instrument for notes played live
+	if (nphv.empty() && instrumentTrack->freezer()->isFrozen())
+	{
+		return;
+	}
 	
 	bool nphsLeft;
 	do
@@ -65,6 +72,7 @@ void InstrumentPlayHandle::play(sampleFrame * working_buffer)
 	while (nphsLeft);
 	
 	m_instrument->play(working_buffer);
+	instrumentTrack->audioPort()->setSourceLatency(m_instrument->latency());
 
 	// Process the audio buffer that the instrument has just worked on...
 	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
@@ -76,5 +84,10 @@ bool InstrumentPlayHandle::isFromTrack(const Track* track) const
 	return m_instrument->isFromTrack(track);
 }
 
+const void* InstrumentPlayHandle::workerAffinity() const
+{
+	return m_instrument->flags().testFlag(Instrument::Flag::NeedsFixedThread) ? m_instrument : nullptr;
+}
+
 
 } // namespace lmms
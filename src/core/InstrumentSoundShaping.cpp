@@ -140,10 +140,8 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		envReleaseBegin += frames;
 	}
 
-	// because of optimizations, there's special code for several cases:
-	// 	- cut- and res-lfo/envelope active
-	// 	- cut-lfo/envelope active
-	// 	- res-lfo/envelope active
+	// because of optimizations, there's special code for two cases:
+	// 	- cut- and/or res-lfo/envelope active
 	//	- no lfo/envelope active but filter is used
 
 	// only use filter, if it is really needed
@@ -174,70 +172,40 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		const float fcv = m_filterCutModel.value();
 		const float frv = m_filterResModel.value();
 
-		if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() &&
-			m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
+		const bool cutUsed = m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed();
+		const bool resUsed = m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed();
+
+		if( cutUsed || resUsed )
 		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
+			// the coefficients follow the envelopes every few frames, and
+			// the filter moves to them over the blocks in between
+			for( fpp_t frame = 0; frame < frames; frame += BasicFilters<>::CoeffUpdateFrames )
 			{
-				const float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
+				const fpp_t block = std::min<fpp_t>( frames - frame, BasicFilters<>::CoeffUpdateFrames );
 
-				const float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
+				const float new_cut_val = cutUsed
+					? EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) * CUT_FREQ_MULTIPLIER + fcv
+					: fcv;
+				const float new_res_val = resUsed ? frv + RES_MULTIPLIER * resBuffer[frame] : frv;
 
-				if( static_cast<int>( new_cut_val ) != old_filter_cut ||
+				if( frame == 0 ||
+					static_cast<int>( new_cut_val ) != old_filter_cut ||
 					static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
 				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, new_res_val );
+					n->m_filter->processRamped( buffer + frame, block, new_cut_val, new_res_val );
 					old_filter_cut = static_cast<int>( new_cut_val );
 					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[static_cast<std::size_t>(Target::Cut)]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_cut_val = EnvelopeAndLfoParameters::expKnobVal( cutBuffer[frame] ) *
-								CUT_FREQ_MULTIPLIER + fcv;
-
-				if( static_cast<int>( new_cut_val ) != old_filter_cut )
+				else
 				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, frv );
-					old_filter_cut = static_cast<int>( new_cut_val );
+					n->m_filter->process( buffer + frame, block );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
-		}
-		else if( m_envLfoParameters[static_cast<std::size_t>(Target::Resonance)]->isUsed() )
-		{
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				float new_res_val = frv + RES_MULTIPLIER * resBuffer[frame];
-
-				if( static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
-				{
-					n->m_filter->calcFilterCoeffs( fcv, new_res_val );
-					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
-				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
 			}
 		}
 		else
 		{
 			n->m_filter->calcFilterCoeffs( fcv, frv );
-
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
+			n->m_filter->process( buffer, frames );
 		}
 	}
 
@@ -253,6 +221,10 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 			buffer[frame][0] = vol_level * buffer[frame][0];
 			buffer[frame][1] = vol_level * buffer[frame][1];
 		}
+		if( frames > 0 )
+		{
+			n->setEnvelopeGain( volBuffer[frames - 1] * volBuffer[frames - 1] );
+		}
 	}
 
 /*	else if( m_envLfoParameters[static_cast<std::size_t>(Target::Volume)]->isUsed() == false && m_envLfoParameters[PANNING]->isUsed() )
@@ -26,13 +26,19 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QLibrary>
+#include <QSaveFile>
 
 #include <cmath>
 
 #include "ConfigManager.h"
 #include "LadspaManager.h"
+#include "PathUtil.h"
 #include "PluginFactory.h"
 
 
@@ -40,6 +46,14 @@ namespace lmms
 {
 
 
+static QString cacheFile()
+{
+	return PathUtil::cacheDir() + "/ladspa-plugins.json";
+}
+
+
+
+
 LadspaManager::LadspaManager()
 {
 	// Make sure plugin search paths are set up
@@ -59,6 +73,15 @@ LadspaManager::LadspaManager()
 	ladspaDirectories.push_back( "/Library/Audio/Plug-Ins/LADSPA" );
 #endif
 
+	QJsonObject cache;
+	QFile file( cacheFile() );
+	if( file.open( QIODevice::ReadOnly ) )
+	{
+		cache = QJsonDocument::fromJson( file.readAll() ).object();
+		file.close();
+	}
+	QJsonObject newCache;
+
 	for (const auto& ladspaDirectory : ladspaDirectories)
 	{
 		// Skip empty entries as QDir will interpret it as the working directory
@@ -78,21 +101,17 @@ LadspaManager::LadspaManager()
 				continue;
 			}
 
-			QLibrary plugin_lib( f.absoluteFilePath() );
+			addPlugins( f, cache, newCache );
+		}
+	}
 
-			if( plugin_lib.load() == true )
-			{
-				auto descriptorFunction = (LADSPA_Descriptor_Function)plugin_lib.resolve("ladspa_descriptor");
-				if( descriptorFunction != nullptr )
-				{
-					addPlugins( descriptorFunction,
-							f.fileName() );
-				}
-			}
-			else
-			{
-				qWarning() << plugin_lib.errorString();
-			}
+	if( newCache != cache && QDir().mkpath( PathUtil::cacheDir() ) )
+	{
+		QSaveFile saveFile( cacheFile() );
+		if( saveFile.open( QIODevice::WriteOnly ) )
+		{
+			saveFile.write( QJsonDocument( newCache ).toJson( QJsonDocument::Compact ) );
+			saveFile.commit();
 		}
 	}
 	
@@ -135,27 +154,69 @@ LadspaManagerDescription * LadspaManager::getDescription(
 
 
 
-void LadspaManager::addPlugins(
-		LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file )
+void LadspaManager::addPlugins( const QFileInfo & _file,
+		const QJsonObject & _cache, QJsonObject & _newCache )
 {
-	const LADSPA_Descriptor * descriptor;
+	const QString path = _file.absoluteFilePath();
+	QJsonObject library = _cache.value( path ).toObject();
+	LADSPA_Descriptor_Function descriptorFunction = nullptr;
+
+	if( library.value( "modified" ).toDouble() !=
+			static_cast<double>( _file.lastModified().toMSecsSinceEpoch() ) ||
+		library.value( "size" ).toDouble() !=
+			static_cast<double>( _file.size() ) )
+	{
+		QLibrary plugin_lib( path );
+		if( plugin_lib.load() == false )
+		{
+			// not cached, it may load once whatever it misses is installed
+			qWarning() << plugin_lib.errorString();
+			return;
+		}
 
-	for( long pluginIndex = 0;
-		( descriptor = _descriptor_func( pluginIndex ) ) != nullptr;
+		// libraries without plug-ins are cached as well, so they aren't
+		// loaded again
+		QJsonArray plugins;
+		descriptorFunction = (LADSPA_Descriptor_Function)plugin_lib.resolve("ladspa_descriptor");
+		const LADSPA_Descriptor * descriptor;
+		for( long pluginIndex = 0; descriptorFunction != nullptr &&
+			( descriptor = descriptorFunction( pluginIndex ) ) != nullptr;
 								++pluginIndex )
+		{
+			QJsonObject plugin;
+			plugin["index"] = static_cast<int>( pluginIndex );
+			plugin["label"] = QString( descriptor->Label );
+			plugin["name"] = QString( descriptor->Name );
+			plugin["properties"] = static_cast<int>( descriptor->Properties );
+			plugin["inputs"] = getPluginInputs( descriptor );
+			plugin["outputs"] = getPluginOutputs( descriptor );
+			plugins.append( plugin );
+		}
+
+		library = QJsonObject();
+		library["modified"] = static_cast<double>( _file.lastModified().toMSecsSinceEpoch() );
+		library["size"] = static_cast<double>( _file.size() );
+		library["plugins"] = plugins;
+	}
+	_newCache[path] = library;
+
+	for( const auto& value : library.value( "plugins" ).toArray() )
 	{
-		ladspa_key_t key( _file, QString( descriptor->Label ) );
+		const QJsonObject plugin = value.toObject();
+		ladspa_key_t key( _file.fileName(), plugin.value( "label" ).toString() );
 		if( m_ladspaManagerMap.contains( key ) )
 		{
 			continue;
 		}
 
 		auto plugIn = new LadspaManagerDescription;
-		plugIn->descriptorFunction = _descriptor_func;
-		plugIn->index = pluginIndex;
-		plugIn->inputChannels = getPluginInputs( descriptor );
-		plugIn->outputChannels = getPluginOutputs( descriptor );
+		plugIn->descriptorFunction = descriptorFunction;
+		plugIn->index = plugin.value( "index" ).toInt();
+		plugIn->inputChannels = plugin.value( "inputs" ).toInt();
+		plugIn->outputChannels = plugin.value( "outputs" ).toInt();
+		plugIn->libraryPath = path;
+		plugIn->name = plugin.value( "name" ).toString();
+		plugIn->properties = plugin.value( "properties" ).toInt();
 
 		if( plugIn->inputChannels == 0 && plugIn->outputChannels > 0 )
 		{
@@ -265,8 +326,7 @@ l_sortable_plugin_t LadspaManager::getSortedPlugins()
 
 QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? descriptor->Label : "" );
+	return( m_ladspaManagerMap.contains( _plugin ) ? _plugin.second : "" );
 }
 
 
@@ -275,9 +335,9 @@ QString LadspaManager::getLabel( const ladspa_key_t & _plugin )
 bool LadspaManager::hasRealTimeDependency(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? LADSPA_IS_REALTIME( descriptor->Properties )
-					   : false );
+	const LadspaManagerDescription * description = getDescription( _plugin );
+	return( description ? LADSPA_IS_REALTIME( description->properties )
+						: false );
 }
 
 
@@ -285,9 +345,9 @@ bool LadspaManager::hasRealTimeDependency(
 
 bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? LADSPA_IS_INPLACE_BROKEN( descriptor->Properties )
-					   : false );
+	const LadspaManagerDescription * description = getDescription( _plugin );
+	return( description ? LADSPA_IS_INPLACE_BROKEN( description->properties )
+						: false );
 }
 
 
@@ -296,9 +356,9 @@ bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 bool LadspaManager::isRealTimeCapable(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? LADSPA_IS_HARD_RT_CAPABLE( descriptor->Properties )
-					   : false );
+	const LadspaManagerDescription * description = getDescription( _plugin );
+	return( description ? LADSPA_IS_HARD_RT_CAPABLE( description->properties )
+						: false );
 }
 
 
@@ -306,8 +366,8 @@ bool LadspaManager::isRealTimeCapable(
 
 QString LadspaManager::getName( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? descriptor->Name : "" );
+	const LadspaManagerDescription * description = getDescription( _plugin );
+	return( description ? description->name : "" );
 }
 
 
@@ -523,14 +583,9 @@ bool LadspaManager::isInteger( const ladspa_key_t & _plugin,
 
 bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 {
-	if( m_ladspaManagerMap.contains( _plugin )
-		   && _port < getPortCount( _plugin ) )
+	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
+	if( descriptor && _port < descriptor->PortCount )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		// This is an LMMS extension to ladspa
@@ -569,19 +624,33 @@ const void * LadspaManager::getImplementationData(
 const LADSPA_Descriptor * LadspaManager::getDescriptor(
 						const ladspa_key_t & _plugin )
 {
-	if( m_ladspaManagerMap.contains( _plugin ) )
+	LadspaManagerDescription * description = getDescription( _plugin );
+	if( description == nullptr )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
-		return( descriptor );
+		return( nullptr );
 	}
-	else
+
+	// cached plug-ins are only loaded once they're needed
+	if( description->descriptorFunction == nullptr )
 	{
-		return( nullptr );
+		QLibrary plugin_lib( description->libraryPath );
+		if( plugin_lib.load() == false )
+		{
+			qWarning() << plugin_lib.errorString();
+			return( nullptr );
+		}
+		description->descriptorFunction = (LADSPA_Descriptor_Function)plugin_lib.resolve("ladspa_descriptor");
+		if( description->descriptorFunction == nullptr )
+		{
+			return( nullptr );
+		}
 	}
+
+	const LADSPA_Descriptor * descriptor =
+			description->descriptorFunction( description->index );
+	// the library may have changed since it was cached
+	return( descriptor && _plugin.second == descriptor->Label ?
+							descriptor : nullptr );
 }
 
 
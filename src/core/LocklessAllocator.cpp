@@ -27,18 +27,9 @@
 #include <algorithm>
 #include <cstdio>
 
-#include "lmmsconfig.h"
-
-#ifndef LMMS_BUILD_WIN32
-#include <strings.h>
-#endif
-
 namespace lmms
 {
 
-static const size_t SIZEOF_SET = sizeof( int ) * 8;
-
-
 static size_t align( size_t size, size_t alignment )
 {
 	size_t misalignment = size % alignment;
@@ -52,18 +43,34 @@ static size_t align( size_t size, size_t alignment )
 
 
 
-LocklessAllocator::LocklessAllocator( size_t nmemb, size_t size )
+//! Threads are spread over the magazines in the order they first allocate
+static std::size_t magazineOfThisThread()
 {
-	m_capacity = align( nmemb, SIZEOF_SET );
-	m_elementSize = align( size, sizeof( void * ) );
-	m_pool = new char[m_capacity * m_elementSize];
+	static std::atomic<std::size_t> s_threads{0};
+	thread_local const std::size_t magazine = s_threads++ % LocklessAllocator::MagazineCount;
+	return magazine;
+}
 
-	m_freeStateSets = m_capacity / SIZEOF_SET;
-	m_freeState = new std::atomic_int[m_freeStateSets];
-	std::fill(m_freeState, m_freeState + m_freeStateSets, 0);
 
-	m_available = m_capacity;
-	m_startIndex = 0;
+
+
+static std::uint64_t nextTag( std::uint64_t head )
+{
+	return ( ( head >> 32 ) + 1 ) << 32;
+}
+
+
+
+
+LocklessAllocator::LocklessAllocator( size_t nmemb, size_t size ) :
+	m_chunkCapacity( std::max<size_t>( nmemb, 1 ) ),
+	m_elementSize( align( size, sizeof( void * ) ) )
+{
+	for( auto & chunk : m_chunks )
+	{
+		chunk = nullptr;
+	}
+	grow();
 }
 
 
@@ -71,100 +78,188 @@ LocklessAllocator::LocklessAllocator( size_t nmemb, size_t size )
 
 LocklessAllocator::~LocklessAllocator()
 {
-	int available = m_available;
-	if( available != m_capacity )
+	if( m_inUse != 0 )
 	{
 		fprintf( stderr, "LocklessAllocator: "
 				"Destroying with elements still allocated\n" );
 	}
 
-	delete[] m_pool;
-	delete[] m_freeState;
+	for( auto & chunk : m_chunks )
+	{
+		if( Chunk * c = chunk.load() )
+		{
+			delete[] c->pool;
+			delete[] c->next;
+			delete c;
+		}
+	}
 }
 
 
 
 
-#ifdef LMMS_BUILD_WIN32
-static int ffs( int i )
+void * LocklessAllocator::alloc()
 {
-	if( !i )
+	const std::size_t own = magazineOfThisThread();
+	std::uint32_t index = Empty;
+	// a few rounds, for the elements another thread is adding right now
+	for( int round = 0; round < 3 && index == Empty; ++round )
 	{
-		return 0;
+		for( std::size_t i = 0; i < MagazineCount && index == Empty; ++i )
+		{
+			index = pop( m_magazines[( own + i ) % MagazineCount] );
+		}
+		if( index == Empty )
+		{
+			grow();
+		}
+	}
+	if( index == Empty )
+	{
+		++m_failures;
+		fprintf( stderr, "LocklessAllocator: No free space\n" );
+		return nullptr;
 	}
-	for( int j = 0;; )
+	next( index ).store( InUse, std::memory_order_relaxed );
+
+	const std::size_t inUse = ++m_inUse;
+	std::size_t peak = m_peakInUse.load( std::memory_order_relaxed );
+	while( inUse > peak && !m_peakInUse.compare_exchange_weak( peak, inUse, std::memory_order_relaxed ) ) {}
+
+	// grow before running dry, so it rarely has to happen in the middle of it
+	const std::size_t capacity = m_chunkCount.load( std::memory_order_acquire ) * m_chunkCapacity;
+	if( capacity - inUse < m_chunkCapacity / 4 )
 	{
-		if( i & 1 << j++ )
+		grow();
+	}
+
+	return m_chunks[index / m_chunkCapacity].load( std::memory_order_acquire )->pool
+		+ ( index % m_chunkCapacity ) * m_elementSize;
+}
+
+
+
+
+void LocklessAllocator::free( void * ptr )
+{
+	const std::size_t chunks = m_chunkCount.load( std::memory_order_acquire );
+	for( std::size_t c = 0; c < chunks; ++c )
+	{
+		const Chunk * chunk = m_chunks[c].load( std::memory_order_acquire );
+		const ptrdiff_t diff = (char *)ptr - chunk->pool;
+		if( diff < 0 || static_cast<size_t>( diff ) >= m_chunkCapacity * m_elementSize )
 		{
-			return j;
+			continue;
 		}
+		if( diff % m_elementSize )
+		{
+			break;
+		}
+		const auto index = static_cast<std::uint32_t>( c * m_chunkCapacity + diff / m_elementSize );
+		if( next( index ).load( std::memory_order_relaxed ) != InUse )
+		{
+			fprintf( stderr, "LocklessAllocator: Block not in use\n" );
+			return;
+		}
+		--m_inUse;
+		push( m_magazines[magazineOfThisThread()], index );
+		return;
 	}
+	fprintf( stderr, "LocklessAllocator: Invalid pointer\n" );
 }
-#endif
 
 
 
 
-void * LocklessAllocator::alloc()
+LocklessAllocator::Statistics LocklessAllocator::statistics() const
+{
+	return { m_chunkCount.load() * m_chunkCapacity, m_inUse.load(), m_peakInUse.load(),
+		m_growths.load(), m_failures.load() };
+}
+
+
+
+
+std::atomic<std::uint32_t> & LocklessAllocator::next( std::uint32_t index ) const
+{
+	return m_chunks[index / m_chunkCapacity].load( std::memory_order_acquire )->next[index % m_chunkCapacity];
+}
+
+
+
+
+void LocklessAllocator::push( Magazine & magazine, std::uint32_t index )
 {
-	// Some of these CAS loops could probably use relaxed atomics, as discussed
-	// in http://en.cppreference.com/w/cpp/atomic/atomic/compare_exchange.
-	// Let's use sequentially-consistent ops to be safe for now.
-	int available = m_available.load();
+	std::uint64_t head = magazine.head.load( std::memory_order_relaxed );
+	std::uint64_t newHead;
 	do
 	{
-		if( !available )
-		{
-			fprintf( stderr, "LocklessAllocator: No free space\n" );
-			return nullptr;
-		}
+		next( index ).store( static_cast<std::uint32_t>( head ), std::memory_order_relaxed );
+		newHead = nextTag( head ) | ( index + 1 );
 	}
-	while (!m_available.compare_exchange_weak(available, available - 1));
+	while( !magazine.head.compare_exchange_weak( head, newHead,
+				std::memory_order_release, std::memory_order_relaxed ) );
+}
 
-	const size_t startIndex = m_startIndex++ % m_freeStateSets;
-	for (size_t set = startIndex;; set = ( set + 1 ) % m_freeStateSets)
+
+
+
+std::uint32_t LocklessAllocator::pop( Magazine & magazine )
+{
+	std::uint64_t head = magazine.head.load( std::memory_order_acquire );
+	std::uint32_t index;
+	std::uint64_t newHead;
+	do
 	{
-		for (int freeState = m_freeState[set]; freeState != -1;)
+		index = static_cast<std::uint32_t>( head );
+		if( index == 0 )
 		{
-			int bit = ffs( ~freeState ) - 1;
-			if (m_freeState[set].compare_exchange_weak(freeState,
-							freeState | 1 << bit ) )
-			{
-				return m_pool + ( SIZEOF_SET * set + bit )
-								* m_elementSize;
-			}
+			return Empty;
 		}
+		// if another thread took this element in the meantime, the tag
+		// changed and the exchange fails
+		newHead = nextTag( head ) | next( index - 1 ).load( std::memory_order_relaxed );
 	}
+	while( !magazine.head.compare_exchange_weak( head, newHead,
+				std::memory_order_acquire, std::memory_order_acquire ) );
+	return index - 1;
 }
 
 
 
 
-void LocklessAllocator::free( void * ptr )
+bool LocklessAllocator::grow()
 {
-	ptrdiff_t diff = (char *)ptr - m_pool;
-	if( diff < 0 || diff % m_elementSize )
+	if( m_growing.exchange( true, std::memory_order_acquire ) )
 	{
-invalid:
-		fprintf( stderr, "LocklessAllocator: Invalid pointer\n" );
-		return;
+		return false;
 	}
-	size_t offset = diff / m_elementSize;
-	if( offset >= m_capacity )
+	const std::size_t count = m_chunkCount.load( std::memory_order_relaxed );
+	if( count == MaxChunks )
 	{
-		goto invalid;
+		m_growing.store( false, std::memory_order_release );
+		return false;
 	}
-	size_t set = offset / SIZEOF_SET;
-	int bit = offset % SIZEOF_SET;
-	int mask = 1 << bit;
-	int prevState = m_freeState[set].fetch_and(~mask);
-	if ( !( prevState & mask ) )
+
+	auto chunk = new Chunk{ new char[m_chunkCapacity * m_elementSize],
+				new std::atomic<std::uint32_t>[m_chunkCapacity] };
+	m_chunks[count].store( chunk, std::memory_order_release );
+	m_chunkCount.store( count + 1, std::memory_order_release );
+	if( count > 0 )
 	{
-		fprintf( stderr, "LocklessAllocator: Block not in use\n" );
-		return;
+		++m_growths;
 	}
-	++m_available;
+
+	// spread over all magazines, so no thread has to look far for them
+	const auto first = static_cast<std::uint32_t>( count * m_chunkCapacity );
+	for( std::uint32_t i = 0; i < m_chunkCapacity; ++i )
+	{
+		push( m_magazines[i % MagazineCount], first + i );
+	}
+
+	m_growing.store( false, std::memory_order_release );
+	return true;
 }
 
 
-} // namespace lmms
\ No newline at end of file
+} // namespace lmms
@@ -0,0 +1,242 @@
+/*
+ * LoudnessMeter.cpp - EBU R128 loudness, true peak and clipping of audio
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LoudnessMeter.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace lmms {
+
+namespace {
+
+constexpr auto Pi = 3.14159265358979323846;
+
+//! The loudness of a K-weighted mean square summed over both channels
+auto loudness(double meanSquare) -> double
+{
+	return meanSquare > 0 ? -0.691 + 10 * std::log10(meanSquare) : -std::numeric_limits<double>::infinity();
+}
+
+auto decibels(float amplitude) -> double
+{
+	return amplitude > 0 ? 20 * std::log10(amplitude) : -std::numeric_limits<double>::infinity();
+}
+
+//! The mean square of the blocks louder than @p gate, and how many there are
+auto gatedMean(const std::vector<double>& blocks, double gate) -> std::pair<double, std::size_t>
+{
+	auto sum = 0.0;
+	auto count = std::size_t{0};
+	for (const auto block : blocks)
+	{
+		if (loudness(block) > gate)
+		{
+			sum += block;
+			++count;
+		}
+	}
+	return {count > 0 ? sum / count : 0.0, count};
+}
+
+//! JSON has no infinity, silence is null
+auto jsonValue(double value) -> QJsonValue
+{
+	return std::isfinite(value) ? QJsonValue{value} : QJsonValue{};
+}
+
+} // namespace
+
+
+
+
+LoudnessMeter::LoudnessMeter(sample_rate_t sampleRate) :
+	m_sampleRate(sampleRate),
+	m_subBlockFrames(std::max<std::size_t>(1, (sampleRate + 5) / 10))
+{
+	// the K-weighting filters of BS.1770, derived for any sample rate
+	{
+		const auto k = std::tan(Pi * 1681.974450955533 / sampleRate);
+		const auto q = 0.7071752369554196;
+		const auto vh = std::pow(10.0, 3.999843853973347 / 20);
+		const auto vb = std::pow(vh, 0.4996667741545416);
+		const auto a0 = 1 + k / q + k * k;
+		m_shelf = Biquad{(vh + vb * k / q + k * k) / a0, 2 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+			2 * (k * k - 1) / a0, (1 - k / q + k * k) / a0};
+	}
+	{
+		const auto k = std::tan(Pi * 38.13547087602444 / sampleRate);
+		const auto q = 0.5003270373238773;
+		const auto a0 = 1 + k / q + k * k;
+		m_highPass = Biquad{1, -2, 1, 2 * (k * k - 1) / a0, (1 - k / q + k * k) / a0};
+	}
+}
+
+
+
+
+void LoudnessMeter::process(const sampleFrame* frames, std::size_t count, float gain)
+{
+	for (std::size_t f = 0; f < count; ++f)
+	{
+		auto sum = 0.0;
+		for (int channel = 0; channel < 2; ++channel)
+		{
+			const auto sample = frames[f][channel] * gain;
+			const auto magnitude = std::abs(sample);
+
+			m_samplePeak = std::max(m_samplePeak, magnitude);
+			if (magnitude > 1.0f)
+			{
+				if (m_clippedSamples == 0) { m_firstClip = m_frames; }
+				++m_clippedSamples;
+			}
+			m_truePeak = std::max(m_truePeak, m_truePeakMeter.process(channel, sample));
+
+			const auto weighted = m_highPass.process(m_shelf.process(sample, channel), channel);
+			sum += weighted * weighted;
+		}
+		m_truePeakMeter.nextFrame();
+
+		m_subBlockSum += sum;
+		if (++m_subBlockFill == m_subBlockFrames) { finishSubBlock(); }
+		++m_frames;
+	}
+}
+
+
+
+
+void LoudnessMeter::finishSubBlock()
+{
+	m_subBlocks[m_subBlockCount % m_subBlocks.size()] = m_subBlockSum / m_subBlockFrames;
+	++m_subBlockCount;
+	m_subBlockSum = 0;
+	m_subBlockFill = 0;
+
+	const auto meanOfLast = [this](std::size_t blocks)
+	{
+		auto sum = 0.0;
+		for (std::size_t i = 0; i < blocks; ++i)
+		{
+			sum += m_subBlocks[(m_subBlockCount - 1 - i) % m_subBlocks.size()];
+		}
+		return sum / blocks;
+	};
+
+	// a block every 100 ms, momentary ones overlap by 75 %
+	if (m_subBlockCount >= 4) { m_momentary.push_back(meanOfLast(4)); }
+	if (m_subBlockCount >= m_subBlocks.size()) { m_shortTerm.push_back(meanOfLast(m_subBlocks.size())); }
+}
+
+
+
+
+auto LoudnessMeter::report() const -> Report
+{
+	auto report = Report{};
+	report.seconds = static_cast<double>(m_frames) / m_sampleRate;
+
+	// gated first at -70 LUFS, then at 10 LU below the loudness of what's left
+	const auto [absoluteMean, absoluteCount] = gatedMean(m_momentary, -70);
+	report.integrated = absoluteCount > 0
+		? loudness(gatedMean(m_momentary, loudness(absoluteMean) - 10).first)
+		: loudness(0);
+
+	// the range between the 10th and 95th percentile of the short-term loudness,
+	// gated at -70 LUFS and then 20 LU below their loudness
+	const auto [shortTermMean, shortTermCount] = gatedMean(m_shortTerm, -70);
+	const auto rangeGate = std::max(-70.0, loudness(shortTermMean) - 20);
+	auto levels = std::vector<double>();
+	for (const auto block : m_shortTerm)
+	{
+		if (loudness(block) > rangeGate) { levels.push_back(loudness(block)); }
+	}
+	std::sort(levels.begin(), levels.end());
+	if (shortTermCount > 0 && !levels.empty())
+	{
+		const auto percentile = [&levels](double p)
+		{
+			return levels[std::min(levels.size() - 1, static_cast<std::size_t>(p * (levels.size() - 1) + 0.5))];
+		};
+		report.range = percentile(0.95) - percentile(0.10);
+	}
+
+	const auto max = [](const std::vector<double>& blocks)
+	{
+		return blocks.empty() ? 0.0 : *std::max_element(blocks.begin(), blocks.end());
+	};
+	report.maxMomentary = loudness(max(m_momentary));
+	report.maxShortTerm = loudness(max(m_shortTerm));
+
+	report.truePeak = decibels(m_truePeak);
+	report.samplePeak = decibels(m_samplePeak);
+	report.clippedSamples = m_clippedSamples;
+	report.firstClip = m_firstClip < 0 ? -1 : static_cast<double>(m_firstClip) / m_sampleRate;
+	return report;
+}
+
+
+
+
+auto LoudnessMeter::writeReport(const QString& file, const QString& audioFile) const -> bool
+{
+	const auto r = report();
+
+	auto json = QJsonObject{};
+	json["file"] = QFileInfo{audioFile}.fileName();
+	json["duration"] = r.seconds;
+	json["integratedLoudness"] = jsonValue(r.integrated);
+	json["loudnessRange"] = r.range;
+	json["maxMomentaryLoudness"] = jsonValue(r.maxMomentary);
+	json["maxShortTermLoudness"] = jsonValue(r.maxShortTerm);
+	json["truePeak"] = jsonValue(r.truePeak);
+	json["samplePeak"] = jsonValue(r.samplePeak);
+	json["clippedSamples"] = static_cast<qint64>(r.clippedSamples);
+	json["firstClip"] = r.firstClip < 0 ? QJsonValue{} : QJsonValue{r.firstClip};
+
+	auto out = QFile{file};
+	return out.open(QFile::WriteOnly | QFile::Truncate)
+		&& out.write(QJsonDocument{json}.toJson()) >= 0;
+}
+
+
+
+
+auto LoudnessMeter::reportFile(const QString& audioFile) -> QString
+{
+	const auto info = QFileInfo{audioFile};
+	return info.dir().filePath(info.completeBaseName() + ".loudness.json");
+}
+
+
+} // namespace lmms
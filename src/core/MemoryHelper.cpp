@@ -21,14 +21,61 @@
  *
  */
 
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 
+#include <QtGlobal>
+
+#include "lmmsconfig.h"
 #include "lmms_basics.h"
 #include "MemoryHelper.h"
 
+#ifdef LMMS_HAVE_UNISTD_H
+#	include <unistd.h>
+#endif
+
+#if defined(_POSIX_MEMLOCK_RANGE) && _POSIX_MEMLOCK_RANGE > 0
+#	include <sys/mman.h>
+#	define LMMS_HAVE_MLOCK
+#endif
+
 namespace lmms
 {
 
+namespace
+{
+
+std::atomic_bool s_hugePages = false;
+std::atomic_bool s_locked = false;
+
+#ifdef LMMS_HAVE_MLOCK
+//! Smaller buffers don't span a huge page, so there's nothing to gain
+constexpr size_t HugePageSize = size_t{2} << 20;
+
+std::atomic_flag s_hugePagesWarned = ATOMIC_FLAG_INIT;
+std::atomic_flag s_lockWarned = ATOMIC_FLAG_INIT;
+
+//! The whole pages within @p size bytes at @p buffer, so pages shared with
+//! other allocations are left as they are
+bool pagesWithin( void* buffer, size_t size, void** begin, size_t* length )
+{
+	const auto pageSize = static_cast<std::uintptr_t>( sysconf( _SC_PAGESIZE ) );
+	const auto start = reinterpret_cast<std::uintptr_t>( buffer );
+	const auto first = ( start + pageSize - 1 ) & ~( pageSize - 1 );
+	const auto last = ( start + size ) & ~( pageSize - 1 );
+	if( last <= first ) { return false; }
+
+	*begin = reinterpret_cast<void*>( first );
+	*length = last - first;
+	return true;
+}
+#endif
+
+} // namespace
+
 
 /**
  * Allocate a number of bytes and return them.
@@ -68,4 +115,60 @@ void MemoryHelper::alignedFree( void* _buffer )
 }
 
 
+void MemoryHelper::setLargeBufferOptions( bool hugePages, bool locked )
+{
+	s_hugePages = hugePages;
+	s_locked = locked;
+}
+
+
+void MemoryHelper::prepareLargeBuffer( void* buffer, size_t size )
+{
+#ifdef LMMS_HAVE_MLOCK
+	void* begin;
+	size_t length;
+	if( !pagesWithin( buffer, size, &begin, &length ) ) { return; }
+
+#ifdef MADV_HUGEPAGE
+	// memory already written to is collapsed into huge pages in the background
+	if( s_hugePages && length >= HugePageSize && madvise( begin, length, MADV_HUGEPAGE ) != 0
+		&& !s_hugePagesWarned.test_and_set() )
+	{
+		qWarning( "Samples can't be kept in huge pages: %s", std::strerror( errno ) );
+	}
+#else
+	if( s_hugePages && !s_hugePagesWarned.test_and_set() )
+	{
+		qWarning( "Samples can't be kept in huge pages on this system" );
+	}
+#endif
+
+	// usually fails because of the limit on locked memory, see ulimit -l
+	if( s_locked && mlock( begin, length ) != 0 && !s_lockWarned.test_and_set() )
+	{
+		qWarning( "Samples can't be locked in memory, they may be swapped out: %s", std::strerror( errno ) );
+	}
+#else
+	(void) buffer;
+	(void) size;
+#endif
+}
+
+
+void MemoryHelper::releaseLargeBuffer( void* buffer, size_t size )
+{
+#ifdef LMMS_HAVE_MLOCK
+	void* begin;
+	size_t length;
+	if( s_locked && pagesWithin( buffer, size, &begin, &length ) )
+	{
+		munlock( begin, length );
+	}
+#else
+	(void) buffer;
+	(void) size;
+#endif
+}
+
+
 } // namespace lmms
@@ -26,6 +26,7 @@
 #include "MemoryManager.h"
 
 #include <QtGlobal>
+#include "RealtimeChecker.h"
 #include "rpmalloc.h"
 
 namespace lmms
@@ -69,6 +70,7 @@ void* MemoryManager::alloc(size_t size)
 	// Compilers may optimize the instance away otherwise.
 	Q_UNUSED(&local_mm_thread_guard);
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::alloc", "Thread not initialized");
+	RealtimeChecker::check("MemoryManager::alloc");
 	return rpmalloc(size);
 }
 
@@ -77,6 +79,7 @@ void MemoryManager::free(void * ptr)
 {
 	Q_UNUSED(&local_mm_thread_guard);
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::free", "Thread not initialized");
+	if (ptr) { RealtimeChecker::check("MemoryManager::free"); }
 	return rpfree(ptr);
 }
 
@@ -0,0 +1,219 @@
+/*
+ * MemoryReport.cpp - tell where the memory of a project goes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <map>
+
+#include "BandLimitedWave.h"
+#include "BufferManager.h"
+#include "Effect.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "Instrument.h"
+#include "InstrumentTrack.h"
+#include "Mixer.h"
+#include "NotePlayHandle.h"
+#include "Oscillator.h"
+#include "PatternStore.h"
+#include "SampleClip.h"
+#include "SampleTrack.h"
+#include "Song.h"
+#include "TrackFreezer.h"
+
+namespace lmms
+{
+
+
+static void addTracks( MemoryReport & report, const TrackContainer::TrackList & tracks, const QString & prefix )
+{
+	for( Track * track : tracks )
+	{
+		report.setOwner( prefix + track->name() );
+
+		if( auto instrumentTrack = dynamic_cast<InstrumentTrack *>( track ) )
+		{
+			if( const Instrument * instrument = instrumentTrack->instrument() )
+			{
+				instrument->reportMemoryUsage( report );
+			}
+			report.addEffects( *instrumentTrack->audioPort()->effects() );
+		}
+		else if( auto sampleTrack = dynamic_cast<SampleTrack *>( track ) )
+		{
+			for( Clip * clip : sampleTrack->getClips() )
+			{
+				report.addSample( static_cast<SampleClip *>( clip )->sample(), QObject::tr( "Sample %1" ).arg( clip->name() ) );
+			}
+			report.addEffects( *sampleTrack->audioPort()->effects() );
+		}
+
+		if( const TrackFreezer * freezer = track->freezer(); freezer && freezer->isFrozen() )
+		{
+			report.addSample( freezer->cache(), QObject::tr( "Frozen track" ) );
+		}
+	}
+}
+
+
+
+
+MemoryReport MemoryReport::collect()
+{
+	MemoryReport report;
+
+	addTracks( report, Engine::getSong()->tracks(), QString() );
+	addTracks( report, Engine::patternStore()->tracks(), QObject::tr( "Pattern editor: " ) );
+
+	Mixer * mixer = Engine::mixer();
+	for( mix_ch_t i = 0; i < mixer->numChannels(); ++i )
+	{
+		MixerChannel * channel = mixer->mixerChannel( i );
+		report.setOwner( channel->m_name.isEmpty() ? QObject::tr( "Mixer channel %1" ).arg( i ) : channel->m_name );
+		report.addEffects( channel->m_fxChain );
+	}
+
+	report.setOwner( QObject::tr( "Engine" ) );
+	report.add( QObject::tr( "Oscillator wave tables" ), Oscillator::waveTableMemoryUsage() );
+	report.add( QObject::tr( "Band limited wave tables" ), BandLimitedWave::memoryUsage() );
+	report.add( QObject::tr( "Period buffer pool" ), BufferManager::poolBytes() );
+	report.add( QObject::tr( "Note play handle pool" ),
+				NotePlayHandleManager::statistics().size * sizeof( NotePlayHandle ) );
+
+	return report;
+}
+
+
+
+
+void MemoryReport::setOwner( const QString & owner )
+{
+	m_owner = owner;
+}
+
+
+
+
+void MemoryReport::add( const QString & what, std::size_t bytes )
+{
+	if( bytes > 0 )
+	{
+		m_entries.push_back( { m_owner, what, bytes } );
+	}
+}
+
+
+
+
+void MemoryReport::addSample( const Sample & sample, const QString & what )
+{
+	addSampleBuffer( sample.buffer(), what );
+}
+
+
+
+
+void MemoryReport::addSampleBuffer( const std::shared_ptr<const SampleBuffer> & buffer, const QString & what )
+{
+	if( !buffer || buffer->empty() || m_sampleBuffers.count( buffer.get() ) )
+	{
+		return;
+	}
+	m_sampleBuffers[buffer.get()] = m_entries.size();
+
+	const QString file = buffer->audioFile();
+	add( file.isEmpty() ? what : QString( "%1 (%2)" ).arg( what, file ), buffer->size() * sizeof( sampleFrame ) );
+}
+
+
+
+
+void MemoryReport::addEffects( const EffectChain & effects )
+{
+	for( const Effect * effect : effects.effects() )
+	{
+		effect->reportMemoryUsage( *this );
+	}
+}
+
+
+
+
+std::size_t MemoryReport::totalBytes() const
+{
+	std::size_t total = 0;
+	for( const Entry & entry : m_entries )
+	{
+		total += entry.bytes;
+	}
+	return total;
+}
+
+
+
+
+QString MemoryReport::toText() const
+{
+	QString text = QObject::tr( "Total: %1\n" ).arg( formatBytes( totalBytes() ) );
+
+	std::map<QString, std::size_t> owners;
+	for( const Entry & entry : m_entries )
+	{
+		owners[entry.owner] += entry.bytes;
+	}
+	std::vector<std::pair<QString, std::size_t>> byOwner( owners.begin(), owners.end() );
+	std::stable_sort( byOwner.begin(), byOwner.end(), []( const auto & a, const auto & b ) { return a.second > b.second; } );
+
+	text += QObject::tr( "\nBy owner:\n" );
+	for( const auto & [owner, bytes] : byOwner )
+	{
+		text += QString( "%1  %2\n" ).arg( formatBytes( bytes ), 10 ).arg( owner );
+	}
+
+	std::vector<Entry> entries = m_entries;
+	std::stable_sort( entries.begin(), entries.end(), []( const Entry & a, const Entry & b ) { return a.bytes > b.bytes; } );
+
+	text += QObject::tr( "\nLargest blocks:\n" );
+	for( const Entry & entry : entries )
+	{
+		text += QString( "%1  %2: %3\n" ).arg( formatBytes( entry.bytes ), 10 ).arg( entry.owner, entry.what );
+	}
+	return text;
+}
+
+
+
+
+QString MemoryReport::formatBytes( std::size_t bytes )
+{
+	if( bytes >= 1024 * 1024 )
+	{
+		return QString( "%1 MiB" ).arg( bytes / ( 1024.0 * 1024.0 ), 0, 'f', 1 );
+	}
+	return QString( "%1 KiB" ).arg( bytes / 1024.0, 0, 'f', 1 );
+}
+
+
+} // namespace lmms
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <cmath>
+#include <utility>
 
 #include "Engine.h"
 #include "Keymap.h"
@@ -55,6 +56,11 @@ Microtuner::Microtuner() :
 	}
 	connect(Engine::getSong(), SIGNAL(scaleListChanged(int)), this, SLOT(updateScaleList(int)));
 	connect(Engine::getSong(), SIGNAL(keymapListChanged(int)), this, SLOT(updateKeymapList(int)));
+
+	connect(&m_scaleModel, SIGNAL(dataChanged()), this, SLOT(updateTuning()), Qt::DirectConnection);
+	connect(&m_keymapModel, SIGNAL(dataChanged()), this, SLOT(updateTuning()), Qt::DirectConnection);
+	connect(&m_keyRangeImportModel, SIGNAL(dataChanged()), this, SLOT(updateTuning()), Qt::DirectConnection);
+	updateTuning();
 }
 
 
@@ -65,49 +71,74 @@ Microtuner::Microtuner() :
 float Microtuner::keyToFreq(int key, int userBaseNote) const
 {
 	if (key < 0 || key >= NumKeys) {return 0;}
+	const auto tuning = std::atomic_load(&m_tuning);
+	if (!tuning) {return 0;}
+
+	const double keyRatio = tuning->keyRatios[key];
+	if (keyRatio == 0) {return 0;}							// key is not mapped, abort
+
+	const int baseNote = tuning->keyRangeImport ? tuning->baseKey : userBaseNote;
+	if (baseNote < 0 || baseNote >= NumKeys) {return 0;}
+	const double baseRatio = tuning->baseRatios[baseNote];
+	if (baseRatio == 0) {return 0;}							// base key is not mapped, umm...
+
+	return tuning->baseFreq * keyRatio / baseRatio;
+}
+
+
+/**
+ * \brief Precompute keyToFreq() for the selected scale and keymap, whenever either changes.
+ */
+void Microtuner::updateTuning()
+{
 	Song *song = Engine::getSong();
-	if (!song) {return 0;}
+	if (!song) {return;}
 
 	// Get keymap and scale selected at this moment
 	std::shared_ptr<const Keymap> keymap = song->getKeymap(m_keymapModel.value());
 	std::shared_ptr<const Scale> scale = song->getScale(m_scaleModel.value());
+	if (!keymap || !scale) {return;}
 	const std::vector<Interval> &intervals = scale->getIntervals();
 
+	auto tuning = std::make_shared<Tuning>();
+	tuning->baseFreq = keymap->getBaseFreq();
+	tuning->baseKey = keymap->getBaseKey();
+	tuning->keyRangeImport = m_keyRangeImportModel.value();
+
 	// Convert MIDI key to scale degree + octave offset.
 	// The octaves are primarily driven by the keymap wraparound: octave count is increased or decreased if the key
 	// goes over or under keymap range. In case the keymap refers to a degree that does not exist in the scale, it is
 	// assumed the keymap is non-repeating or just really big, so the octaves are also driven by the scale wraparound.
-	const int keymapDegree = keymap->getDegree(key);		// which interval should be used according to the keymap
-	if (keymapDegree == -1) {return 0;}						// key is not mapped, abort
-	const int keymapOctave = keymap->getOctave(key);		// how many times did the keymap repeat
 	const int octaveDegree = intervals.size() - 1;			// index of the interval with octave ratio
-	if (octaveDegree == 0) {								// octave interval is 1/1, i.e. constant base frequency
-		return keymap->getBaseFreq();						// → return the baseFreq directly
+	for (int key = 0; key < NumKeys; ++key)
+	{
+		const int keymapDegree = keymap->getDegree(key);	// which interval should be used according to the keymap
+		if (keymapDegree == -1) {continue;}					// key is not mapped
+		if (octaveDegree == 0) {							// octave interval is 1/1, i.e. constant base frequency
+			tuning->keyRatios[key] = tuning->baseRatios[key] = 1;
+			continue;
+		}
+		const int keymapOctave = keymap->getOctave(key);	// how many times did the keymap repeat
+		const int scaleOctave = keymapDegree / octaveDegree;
+
+		// which interval should be used according to the scale and keymap together
+		const int degree_rem = keymapDegree % octaveDegree;
+		const int scaleDegree = degree_rem >= 0 ? degree_rem : degree_rem + octaveDegree;	// get true modulo
+
+		// the same describes the key as the base note (the "A4 reference") of other keys
+		const double octaveRatio = intervals[octaveDegree].getRatio();
+		const double ratio = intervals[scaleDegree].getRatio() * std::pow(octaveRatio, keymapOctave + scaleOctave);
+		tuning->keyRatios[key] = ratio;
+		tuning->baseRatios[key] = ratio;
 	}
-	const int scaleOctave = keymapDegree / octaveDegree;
 
-	// which interval should be used according to the scale and keymap together
-	const int degree_rem = keymapDegree % octaveDegree;
-	const int scaleDegree = degree_rem >= 0 ? degree_rem : degree_rem + octaveDegree;	// get true modulo
+	// a constant base frequency doesn't depend on the base note, even an unmapped one
+	if (octaveDegree == 0) {tuning->baseRatios.fill(1);}
 
-	// Compute base note (the "A4 reference") degree and octave
-	const int baseNote = m_keyRangeImportModel.value() ? keymap->getBaseKey() : userBaseNote;
-	const int baseKeymapDegree = keymap->getDegree(baseNote);
-	if (baseKeymapDegree == -1) {return 0;}					// base key is not mapped, umm...
-	const int baseKeymapOctave = keymap->getOctave(baseNote);
-	const int baseScaleOctave = baseKeymapDegree / octaveDegree;
-
-	const int baseDegree_rem = baseKeymapDegree % octaveDegree;
-	const int baseScaleDegree = baseDegree_rem >= 0 ? baseDegree_rem : baseDegree_rem + octaveDegree;
-
-	// Compute frequency of the middle note and return the final frequency
-	const double octaveRatio = intervals[octaveDegree].getRatio();
-	const float middleFreq = (keymap->getBaseFreq() / pow(octaveRatio, (baseScaleOctave + baseKeymapOctave)))
-								/ intervals[baseScaleDegree].getRatio();
-
-	return middleFreq * intervals[scaleDegree].getRatio() * pow(octaveRatio, keymapOctave + scaleOctave);
+	std::atomic_store(&m_tuning, std::shared_ptr<const Tuning>(std::move(tuning)));
 }
 
+
 int Microtuner::octaveSize() const
 {
 	const int keymapSize = Engine::getSong()->getKeymap(currentKeymap())->getSize();
@@ -139,6 +170,7 @@ void Microtuner::updateScaleList(int index)
 				QString::number(i) + ": " + Engine::getSong()->getScale(i)->getDescription());
 		}
 	}
+	updateTuning();
 }
 
 /**
@@ -160,6 +192,7 @@ void Microtuner::updateKeymapList(int index)
 				QString::number(i) + ": " + Engine::getSong()->getKeymap(i)->getDescription());
 		}
 	}
+	updateTuning();
 }
 
 
@@ -28,11 +28,19 @@
 #include <cstdio>
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <QtGlobal>
 
+#include "lmmsconfig.h"
+#include "MixKernels.h"
 #include "ValueBuffer.h"
 
+#if (defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64)) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 
 
 static bool s_NaNHandler;
@@ -41,6 +49,97 @@ static bool s_NaNHandler;
 namespace lmms::MixHelpers
 {
 
+namespace
+{
+
+#if defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64)
+#ifdef _MSC_VER
+bool cpuHasSse2()
+{
+	int info[4];
+	__cpuid(info, 1);
+	return info[3] & (1 << 26);
+}
+
+bool cpuHasAvx()
+{
+	int info[4];
+	__cpuid(info, 1);
+	const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+	return osSavesYmm && (info[2] & (1 << 28));
+}
+
+bool cpuHasAvx512()
+{
+	if (!cpuHasAvx()) { return false; }
+	int info[4];
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 16)) && (_xgetbv(0) & 0xe6) == 0xe6;
+}
+#else
+// these check whether the OS saves the registers, too
+bool cpuHasSse2() { return __builtin_cpu_supports("sse2"); }
+bool cpuHasAvx() { return __builtin_cpu_supports("avx"); }
+bool cpuHasAvx512() { return __builtin_cpu_supports("avx512f"); }
+#endif
+#endif
+
+
+//! The best kernels LMMS was built with and this CPU can run, or nullptr
+//! to use the scalar code only
+const Kernels* selectKernels()
+{
+#if defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64)
+#ifndef _MSC_VER
+	// we run before main(), possibly before libgcc filled in the CPU info
+	__builtin_cpu_init();
+#endif
+	if (avx512Kernels() && cpuHasAvx512()) { return avx512Kernels(); }
+	if (avxKernels() && cpuHasAvx()) { return avxKernels(); }
+	if (sse2Kernels() && cpuHasSse2()) { return sse2Kernels(); }
+	return nullptr;
+#else
+	return neonKernels();
+#endif
+}
+
+
+// Static initialization runs before anything mixes. Should it not, this is
+// still null and the scalar code is used.
+const Kernels* const s_kernels = selectKernels();
+
+
+//! How many of @p frames the kernels can process, the rest is left to the
+//! scalar code
+int vectorFrames(int frames)
+{
+	return s_kernels ? frames - frames % s_kernels->blockFrames : 0;
+}
+
+
+float* samples(sampleFrame* buf)
+{
+	return reinterpret_cast<float*>(buf);
+}
+
+
+const float* samples(const sampleFrame* buf)
+{
+	return reinterpret_cast<const float*>(buf);
+}
+
+} // namespace
+
+
+
+const char* instructionSet()
+{
+	return s_kernels ? s_kernels->name : "scalar";
+}
+
+
+
+
 /*! \brief Function for applying MIXOP on all sample frames */
 template<typename MIXOP>
 static inline void run( sampleFrame* dst, const sampleFrame* src, int frames, const MIXOP& OP )
@@ -66,11 +165,15 @@ static inline void run( sampleFrame* dst, const sample_t* srcLeft, const sample_
 
 bool isSilent( const sampleFrame* src, int frames )
 {
-	const float silenceThreshold = 0.0000001f;
+	const int done = vectorFrames( frames );
+	if( done > 0 && !s_kernels->isSilent( samples( src ), done ) )
+	{
+		return false;
+	}
 
-	for( int i = 0; i < frames; ++i )
+	for( int i = done; i < frames; ++i )
 	{
-		if( fabsf( src[i][0] ) >= silenceThreshold || fabsf( src[i][1] ) >= silenceThreshold )
+		if( fabsf( src[i][0] ) >= SilenceThreshold || fabsf( src[i][1] ) >= SilenceThreshold )
 		{
 			return false;
 		}
@@ -79,6 +182,17 @@ bool isSilent( const sampleFrame* src, int frames )
 	return true;
 }
 
+bool hasNonFinite( const sampleFrame* src, int frames )
+{
+	const int done = vectorFrames( frames );
+	bool found = done > 0 && s_kernels->hasNonFinite( samples( src ), done );
+	for( int f = done; f < frames; ++f )
+	{
+		found |= !std::isfinite( src[f][0] ) | !std::isfinite( src[f][1] );
+	}
+	return found;
+}
+
 bool useNaNHandler()
 {
 	return s_NaNHandler;
@@ -97,38 +211,61 @@ bool sanitize( sampleFrame * src, int frames )
 		return false;
 	}
 
-	bool found = false;
-	for( int f = 0; f < frames; ++f )
+	const int done = vectorFrames( frames );
+	bool found = done > 0 && s_kernels->sanitize( samples( src ), 2 * done );
+	for( int f = done; f < frames && !found; ++f )
 	{
 		for( int c = 0; c < 2; ++c )
 		{
-			if( std::isinf( src[f][c] ) || std::isnan( src[f][c] ) )
+			if( !std::isfinite( src[f][c] ) )
 			{
-				#ifdef LMMS_DEBUG
-					// TODO don't use printf here
-					printf("Bad data, clearing buffer. frame: ");
-					printf("%d: value %f\n", f, src[f][c]);
-				#endif
-				for( int f = 0; f < frames; ++f )
-				{
-					for( int c = 0; c < 2; ++c )
-					{
-						src[f][c] = 0.0f;
-					}
-				}
 				found = true;
-				return found;
-			}
-			else
-			{
-				src[f][c] = std::clamp(src[f][c], -1000.0f, 1000.0f);
+				break;
 			}
+			src[f][c] = std::clamp(src[f][c], -SanitizeLimit, SanitizeLimit);
 		}
 	}
+
+	if( found )
+	{
+		#ifdef LMMS_DEBUG
+			// TODO don't use printf here
+			printf("Bad data, clearing buffer.\n");
+		#endif
+		std::fill_n( src, frames, sampleFrame{} );
+	}
 	return found;
 }
 
 
+bool sanitize( sample_t * src, int frames )
+{
+	if( !useNaNHandler() )
+	{
+		return false;
+	}
+
+	// the kernels count two samples of the channel as a frame
+	const int done = 2 * vectorFrames( frames / 2 );
+	if( done > 0 && s_kernels->sanitize( src, done ) )
+	{
+		std::fill_n( src, frames, 0.0f );
+		return true;
+	}
+
+	for( int f = done; f < frames; ++f )
+	{
+		if( !std::isfinite( src[f] ) )
+		{
+			std::fill_n( src, frames, 0.0f );
+			return true;
+		}
+		src[f] = std::clamp( src[f], -SanitizeLimit, SanitizeLimit );
+	}
+	return false;
+}
+
+
 struct AddOp
 {
 	void operator()( sampleFrame& dst, const sampleFrame& src ) const
@@ -140,7 +277,9 @@ struct AddOp
 
 void add( sampleFrame* dst, const sampleFrame* src, int frames )
 {
-	run<>( dst, src, frames, AddOp() );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->add( samples( dst ), samples( src ), done ); }
+	run<>( dst + done, src + done, frames - done, AddOp() );
 }
 
 
@@ -161,7 +300,9 @@ struct AddMultipliedOp
 
 void addMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
-	run<>( dst, src, frames, AddMultipliedOp(coeffSrc) );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->addMultiplied( samples( dst ), samples( src ), coeffSrc, done ); }
+	run<>( dst + done, src + done, frames - done, AddMultipliedOp(coeffSrc) );
 }
 
 
@@ -180,13 +321,21 @@ struct AddSwappedMultipliedOp
 
 void addSwappedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
-	run<>( dst, src, frames, AddSwappedMultipliedOp(coeffSrc) );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->addSwappedMultiplied( samples( dst ), samples( src ), coeffSrc, done ); }
+	run<>( dst + done, src + done, frames - done, AddSwappedMultipliedOp(coeffSrc) );
 }
 
 
 void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
 {
-	for( int f = 0; f < frames; ++f )
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->addMultipliedByBuffer( samples( dst ), samples( src ), coeffSrc, coeffSrcBuf->values(), done );
+	}
+
+	for( int f = done; f < frames; ++f )
 	{
 		dst[f][0] += src[f][0] * coeffSrc * coeffSrcBuf->values()[f];
 		dst[f][1] += src[f][1] * coeffSrc * coeffSrcBuf->values()[f];
@@ -195,7 +344,14 @@ void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coef
 
 void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
 {
-	for( int f = 0; f < frames; ++f )
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->addMultipliedByBuffers( samples( dst ), samples( src ),
+			coeffSrcBuf1->values(), coeffSrcBuf2->values(), done );
+	}
+
+	for( int f = done; f < frames; ++f )
 	{
 		dst[f][0] += src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
 		dst[f][1] += src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
@@ -203,41 +359,53 @@ void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuff
 
 }
 
-void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
+bool addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
 {
-	if ( !useNaNHandler() )
+	if( !useNaNHandler() || !hasNonFinite( src, frames ) )
+	{
+		addMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf, frames );
+		return false;
+	}
+
+	const int done = vectorFrames( frames );
+	if( done > 0 )
 	{
-		addMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf,
-								frames );
-		return;
+		s_kernels->addSanitizedMultipliedByBuffer( samples( dst ), samples( src ), coeffSrc, coeffSrcBuf->values(), done );
 	}
 
-	for( int f = 0; f < frames; ++f )
+	for( int f = done; f < frames; ++f )
 	{
-		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) ) ? 0.0f : src[f][0] * coeffSrc * coeffSrcBuf->values()[f];
-		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) ) ? 0.0f : src[f][1] * coeffSrc * coeffSrcBuf->values()[f];
+		dst[f][0] += std::isfinite( src[f][0] ) ? src[f][0] * coeffSrc * coeffSrcBuf->values()[f] : 0.0f;
+		dst[f][1] += std::isfinite( src[f][1] ) ? src[f][1] * coeffSrc * coeffSrcBuf->values()[f] : 0.0f;
 	}
+	return true;
 }
 
-void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+bool addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
 {
-	if ( !useNaNHandler() )
+	if( !useNaNHandler() || !hasNonFinite( src, frames ) )
 	{
-		addMultipliedByBuffers( dst, src, coeffSrcBuf1, coeffSrcBuf2,
-								frames );
-		return;
+		addMultipliedByBuffers( dst, src, coeffSrcBuf1, coeffSrcBuf2, frames );
+		return false;
 	}
 
-	for( int f = 0; f < frames; ++f )
+	const int done = vectorFrames( frames );
+	if( done > 0 )
 	{
-		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) )
-			? 0.0f
-			: src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) )
-			? 0.0f
-			: src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
+		s_kernels->addSanitizedMultipliedByBuffers( samples( dst ), samples( src ),
+			coeffSrcBuf1->values(), coeffSrcBuf2->values(), done );
 	}
 
+	for( int f = done; f < frames; ++f )
+	{
+		dst[f][0] += std::isfinite( src[f][0] )
+			? src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f]
+			: 0.0f;
+		dst[f][1] += std::isfinite( src[f][1] )
+			? src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f]
+			: 0.0f;
+	}
+	return true;
 }
 
 
@@ -247,22 +415,76 @@ struct AddSanitizedMultipliedOp
 
 	void operator()( sampleFrame& dst, const sampleFrame& src ) const
 	{
-		dst[0] += ( std::isinf( src[0] ) || std::isnan( src[0] ) ) ? 0.0f : src[0] * m_coeff;
-		dst[1] += ( std::isinf( src[1] ) || std::isnan( src[1] ) ) ? 0.0f : src[1] * m_coeff;
+		dst[0] += std::isfinite( src[0] ) ? src[0] * m_coeff : 0.0f;
+		dst[1] += std::isfinite( src[1] ) ? src[1] * m_coeff : 0.0f;
 	}
 
 	const float m_coeff;
 };
 
-void addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+bool addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
-	if ( !useNaNHandler() )
+	if( !useNaNHandler() || !hasNonFinite( src, frames ) )
 	{
 		addMultiplied( dst, src, coeffSrc, frames );
-		return;
+		return false;
 	}
 
-	run<>( dst, src, frames, AddSanitizedMultipliedOp(coeffSrc) );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->addSanitizedMultiplied( samples( dst ), samples( src ), coeffSrc, done ); }
+	run<>( dst + done, src + done, frames - done, AddSanitizedMultipliedOp(coeffSrc) );
+	return true;
+}
+
+
+
+void measure( const sampleFrame* src, int frames, Measurement& measurement )
+{
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->measure( samples( src ), done, measurement.peaks, measurement.squares ); }
+
+	for( int f = done; f < frames; ++f )
+	{
+		for( int ch = 0; ch < 2; ++ch )
+		{
+			const float value = std::isfinite( src[f][ch] ) ? src[f][ch] : 0.0f;
+			measurement.peaks[ch] = std::max( measurement.peaks[ch], std::abs( value ) );
+			measurement.squares[ch] += value * value;
+		}
+	}
+}
+
+bool addSanitizedMultipliedMeasured( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames, Measurement& measurement )
+{
+	if( !useNaNHandler() )
+	{
+		addMultiplied( dst, src, coeffSrc, frames );
+		measure( src, frames, measurement );
+		return false;
+	}
+
+	// measuring skips infs and nans anyway, in the same pass as mixing, so
+	// that is done either way
+	const bool found = hasNonFinite( src, frames );
+
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->addSanitizedMultipliedMeasured( samples( dst ), samples( src ), coeffSrc, done,
+			measurement.peaks, measurement.squares );
+	}
+
+	for( int f = done; f < frames; ++f )
+	{
+		for( int ch = 0; ch < 2; ++ch )
+		{
+			const float value = std::isfinite( src[f][ch] ) ? src[f][ch] : 0.0f;
+			measurement.peaks[ch] = std::max( measurement.peaks[ch], std::abs( value ) );
+			measurement.squares[ch] += value * value;
+			dst[f][ch] += value * coeffSrc;
+		}
+	}
+	return found;
 }
 
 
@@ -287,8 +509,9 @@ struct AddMultipliedStereoOp
 
 void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames )
 {
-
-	run<>( dst, src, frames, AddMultipliedStereoOp(coeffSrcLeft, coeffSrcRight) );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->addMultipliedStereo( samples( dst ), samples( src ), coeffSrcLeft, coeffSrcRight, done ); }
+	run<>( dst + done, src + done, frames - done, AddMultipliedStereoOp(coeffSrcLeft, coeffSrcRight) );
 }
 
 
@@ -315,7 +538,9 @@ struct MultiplyAndAddMultipliedOp
 
 void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames )
 {
-	run<>( dst, src, frames, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
+	const int done = vectorFrames( frames );
+	if( done > 0 ) { s_kernels->multiplyAndAddMultiplied( samples( dst ), samples( src ), coeffDst, coeffSrc, done ); }
+	run<>( dst + done, src + done, frames - done, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
 }
 
 
@@ -325,7 +550,72 @@ void multiplyAndAddMultipliedJoined( sampleFrame* dst,
 										const sample_t* srcRight,
 										float coeffDst, float coeffSrc, int frames )
 {
-	run<>( dst, srcLeft, srcRight, frames, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->multiplyAndAddMultipliedJoined( samples( dst ), srcLeft, srcRight, coeffDst, coeffSrc, done );
+	}
+	run<>( dst + done, srcLeft + done, srcRight + done, frames - done, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
+}
+
+
+
+
+/*! \brief dst = (dst + src) * gain, or src * gain if OVERWRITE */
+template<bool OVERWRITE>
+static void mixWithGain( sampleFrame* dst, const sampleFrame* src, const StereoGain& gain, int frames )
+{
+	const float* volume = gain.volumeBuffer ? gain.volumeBuffer->values() : nullptr;
+	const float* panning = gain.panningBuffer ? gain.panningBuffer->values() : nullptr;
+
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->mixWithGain( samples( dst ), samples( src ), OVERWRITE,
+			volume, gain.volume, panning, gain.panning, done );
+	}
+
+	for( int f = done; f < frames; ++f )
+	{
+		const float v = ( volume ? volume[f] : gain.volume ) * 0.01f;
+		const float p = ( panning ? panning[f] : gain.panning ) * 0.01f;
+		// panning to the right attenuates the left channel and vice versa
+		const float left = std::min( 1.0f, 1.0f - p ) * v;
+		const float right = std::min( 1.0f, 1.0f + p ) * v;
+		dst[f][0] = ( OVERWRITE ? src[f][0] : dst[f][0] + src[f][0] ) * left;
+		dst[f][1] = ( OVERWRITE ? src[f][1] : dst[f][1] + src[f][1] ) * right;
+	}
+}
+
+
+
+void copyWithGain( sampleFrame* dst, const sampleFrame* src, const StereoGain& gain, int frames )
+{
+	mixWithGain<true>( dst, src, gain, frames );
+}
+
+
+
+void addWithGain( sampleFrame* dst, const sampleFrame* src, const StereoGain& gain, int frames )
+{
+	mixWithGain<false>( dst, src, gain, frames );
+}
+
+
+
+void deinterleaveMultiplied( const sampleFrame* src, sample_t* left, sample_t* right, float coeffSrc, int frames )
+{
+	const int done = vectorFrames( frames );
+	if( done > 0 )
+	{
+		s_kernels->deinterleaveMultiplied( samples( src ), left, right, coeffSrc, done );
+	}
+
+	for( int f = done; f < frames; ++f )
+	{
+		left[f] = src[f][0] * coeffSrc;
+		right[f] = src[f][1] * coeffSrc;
+	}
 }
 
 } // namespace lmms::MixHelpers
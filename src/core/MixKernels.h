@@ -0,0 +1,441 @@
+/*
+ * MixKernels.h - vectorised MixHelpers loops for one instruction set
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef LMMS_MIX_KERNELS_H
+#define LMMS_MIX_KERNELS_H
+
+// This header is also compiled with flags for instruction sets the CPU
+// running LMMS might not have. It mustn't include anything that could emit
+// inline functions which other source files share.
+
+namespace lmms::MixHelpers
+{
+
+constexpr float SilenceThreshold = 0.0000001f;
+constexpr float SanitizeLimit = 1000.0f;
+
+
+/*! \brief Vectorised versions of the MixHelpers loops for one instruction set
+ *
+ *  Buffers are interleaved stereo unless noted. The number of frames passed
+ *  must be a multiple of blockFrames, MixHelpers processes what is left with
+ *  its scalar code, which also is the reference these must agree with.
+ */
+struct Kernels
+{
+	const char* name;
+	int blockFrames;
+
+	bool (*isSilent)(const float* src, int frames);
+	//! Whether there is an inf or nan, without a branch per vector
+	bool (*hasNonFinite)(const float* src, int frames);
+	//! Clamps to +-SanitizeLimit, returns true as soon as it finds an inf or
+	//! nan. Works on a single channel, too, @p samples must be a multiple of
+	//! 2 * blockFrames.
+	bool (*sanitize)(float* buf, int samples);
+	void (*add)(float* dst, const float* src, int frames);
+	void (*addMultiplied)(float* dst, const float* src, float coeffSrc, int frames);
+	void (*addSwappedMultiplied)(float* dst, const float* src, float coeffSrc, int frames);
+	void (*addMultipliedByBuffer)(float* dst, const float* src, float coeffSrc, const float* coeffSrcBuf, int frames);
+	void (*addMultipliedByBuffers)(float* dst, const float* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames);
+	void (*addSanitizedMultiplied)(float* dst, const float* src, float coeffSrc, int frames);
+	void (*addSanitizedMultipliedByBuffer)(float* dst, const float* src,
+		float coeffSrc, const float* coeffSrcBuf, int frames);
+	void (*addSanitizedMultipliedByBuffers)(float* dst, const float* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames);
+	//! addSanitizedMultiplied, which measures @p src on the way: raises
+	//! @p peaks to the largest absolute value of each channel and adds the
+	//! squares to @p squares, infs and nans count as 0. The squares are summed
+	//! in a different order than the scalar code does.
+	void (*addSanitizedMultipliedMeasured)(float* dst, const float* src, float coeffSrc, int frames,
+		float* peaks, float* squares);
+	//! The measuring part of addSanitizedMultipliedMeasured only
+	void (*measure)(const float* src, int frames, float* peaks, float* squares);
+	void (*addMultipliedStereo)(float* dst, const float* src, float coeffSrcLeft, float coeffSrcRight, int frames);
+	void (*multiplyAndAddMultiplied)(float* dst, const float* src, float coeffDst, float coeffSrc, int frames);
+	//! @p srcLeft and @p srcRight are single channels
+	void (*multiplyAndAddMultipliedJoined)(float* dst, const float* srcLeft, const float* srcRight,
+		float coeffDst, float coeffSrc, int frames);
+	//! dst = (dst + src) * gain, or src * gain if @p overwrite. The gain of
+	//! each frame comes from @p volume and @p panning in percent, one value
+	//! per frame, or if they are null, @p volumeValue and @p panningValue.
+	void (*mixWithGain)(float* dst, const float* src, bool overwrite,
+		const float* volume, float volumeValue, const float* panning, float panningValue, int frames);
+	//! @p left and @p right are single channels
+	void (*deinterleaveMultiplied)(const float* src, float* left, float* right, float coeffSrc, int frames);
+};
+
+
+// These return nullptr if LMMS was built without support for the
+// instruction set. Whether the CPU has it is up to the caller to check.
+const Kernels* sse2Kernels();
+const Kernels* avxKernels();
+const Kernels* avx512Kernels();
+const Kernels* neonKernels();
+
+
+/*! \brief The loops of Kernels, written once for every instruction set
+ *
+ *  Simd wraps the intrinsics and provides:
+ *  - Vector, Mask and the number of Frames in a Vector
+ *  - load(), store(), set1(v), set2(left, right), add(), mul(), min(), max(), abs()
+ *  - swapPairs(), which swaps the channels of each frame
+ *  - duplicateFrames(p), one value from p per frame for both channels
+ *  - interleave(left, right), Frames frames from two single channels
+ *  - deinterleave(v, left, right), the other way round
+ *  - nonFinite(v), atLeast(a, b) and any(mask)
+ *  - zeroNonFinite(value, test), value where test is finite, 0 elsewhere
+ *
+ *  The operations happen in the same order as in the scalar code, so the
+ *  results are the same as long as the compiler doesn't fuse multiplies and
+ *  adds.
+ */
+template<typename Simd>
+struct KernelsFor
+{
+	using V = typename Simd::Vector;
+	static constexpr int Step = 2 * Simd::Frames;
+
+
+	static bool isSilent(const float* src, int frames)
+	{
+		const V threshold = Simd::set1(SilenceThreshold);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			if (Simd::any(Simd::atLeast(Simd::abs(Simd::load(src + i)), threshold))) { return false; }
+		}
+		return true;
+	}
+
+
+	static bool hasNonFinite(const float* src, int frames)
+	{
+		// x * 0 is 0 unless x is an inf or nan, which makes it a nan that
+		// stays in the sum
+		const V zero = Simd::set1(0.0f);
+		V sum = zero;
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			sum = Simd::add(sum, Simd::mul(Simd::load(src + i), zero));
+		}
+		return Simd::any(Simd::nonFinite(sum));
+	}
+
+
+	static bool sanitize(float* buf, int samples)
+	{
+		const V low = Simd::set1(-SanitizeLimit);
+		const V high = Simd::set1(SanitizeLimit);
+		for (int i = 0; i < samples; i += Step)
+		{
+			const V value = Simd::load(buf + i);
+			if (Simd::any(Simd::nonFinite(value))) { return true; }
+			Simd::store(buf + i, Simd::min(Simd::max(value, low), high));
+		}
+		return false;
+	}
+
+
+	static void add(float* dst, const float* src, int frames)
+	{
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::load(src + i)));
+		}
+	}
+
+
+	static void addMultiplied(float* dst, const float* src, float coeffSrc, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::mul(Simd::load(src + i), coeff)));
+		}
+	}
+
+
+	static void addSwappedMultiplied(float* dst, const float* src, float coeffSrc, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V swapped = Simd::swapPairs(Simd::load(src + i));
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::mul(swapped, coeff)));
+		}
+	}
+
+
+	static void addMultipliedByBuffer(float* dst, const float* src, float coeffSrc, const float* coeffSrcBuf, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V product = Simd::mul(Simd::mul(Simd::load(src + i), coeff), Simd::duplicateFrames(coeffSrcBuf + i / 2));
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), product));
+		}
+	}
+
+
+	static void addMultipliedByBuffers(float* dst, const float* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames)
+	{
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V product = Simd::mul(Simd::mul(Simd::load(src + i), Simd::duplicateFrames(coeffSrcBuf1 + i / 2)),
+				Simd::duplicateFrames(coeffSrcBuf2 + i / 2));
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), product));
+		}
+	}
+
+
+	static void addSanitizedMultiplied(float* dst, const float* src, float coeffSrc, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V value = Simd::load(src + i);
+			const V product = Simd::zeroNonFinite(Simd::mul(value, coeff), value);
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), product));
+		}
+	}
+
+
+	static void addSanitizedMultipliedByBuffer(float* dst, const float* src,
+		float coeffSrc, const float* coeffSrcBuf, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V value = Simd::load(src + i);
+			const V product = Simd::mul(Simd::mul(value, coeff), Simd::duplicateFrames(coeffSrcBuf + i / 2));
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::zeroNonFinite(product, value)));
+		}
+	}
+
+
+	static void addSanitizedMultipliedByBuffers(float* dst, const float* src,
+		const float* coeffSrcBuf1, const float* coeffSrcBuf2, int frames)
+	{
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V value = Simd::load(src + i);
+			const V product = Simd::mul(Simd::mul(value, Simd::duplicateFrames(coeffSrcBuf1 + i / 2)),
+				Simd::duplicateFrames(coeffSrcBuf2 + i / 2));
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::zeroNonFinite(product, value)));
+		}
+	}
+
+
+	//! Adds what the lanes of @p peak and @p sum measured to @p peaks and @p squares
+	static void finishMeasurement(V peak, V sum, float* peaks, float* squares)
+	{
+		float peakLanes[Step];
+		float sumLanes[Step];
+		Simd::store(peakLanes, peak);
+		Simd::store(sumLanes, sum);
+		for (int i = 0; i < Step; ++i)
+		{
+			peaks[i % 2] = peakLanes[i] > peaks[i % 2] ? peakLanes[i] : peaks[i % 2];
+			squares[i % 2] += sumLanes[i];
+		}
+	}
+
+
+	static void addSanitizedMultipliedMeasured(float* dst, const float* src, float coeffSrc, int frames,
+		float* peaks, float* squares)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		V peak = Simd::set1(0.0f);
+		V sum = Simd::set1(0.0f);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V value = Simd::load(src + i);
+			const V finite = Simd::zeroNonFinite(value, value);
+			peak = Simd::max(peak, Simd::abs(finite));
+			sum = Simd::add(sum, Simd::mul(finite, finite));
+
+			const V product = Simd::zeroNonFinite(Simd::mul(value, coeff), value);
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), product));
+		}
+		finishMeasurement(peak, sum, peaks, squares);
+	}
+
+
+	static void measure(const float* src, int frames, float* peaks, float* squares)
+	{
+		V peak = Simd::set1(0.0f);
+		V sum = Simd::set1(0.0f);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V value = Simd::load(src + i);
+			const V finite = Simd::zeroNonFinite(value, value);
+			peak = Simd::max(peak, Simd::abs(finite));
+			sum = Simd::add(sum, Simd::mul(finite, finite));
+		}
+		finishMeasurement(peak, sum, peaks, squares);
+	}
+
+
+	static void addMultipliedStereo(float* dst, const float* src, float coeffSrcLeft, float coeffSrcRight, int frames)
+	{
+		const V coeffs = Simd::set2(coeffSrcLeft, coeffSrcRight);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			Simd::store(dst + i, Simd::add(Simd::load(dst + i), Simd::mul(Simd::load(src + i), coeffs)));
+		}
+	}
+
+
+	static void multiplyAndAddMultiplied(float* dst, const float* src, float coeffDst, float coeffSrc, int frames)
+	{
+		const V dstCoeff = Simd::set1(coeffDst);
+		const V srcCoeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			Simd::store(dst + i, Simd::add(Simd::mul(Simd::load(dst + i), dstCoeff),
+				Simd::mul(Simd::load(src + i), srcCoeff)));
+		}
+	}
+
+
+	static void multiplyAndAddMultipliedJoined(float* dst, const float* srcLeft, const float* srcRight,
+		float coeffDst, float coeffSrc, int frames)
+	{
+		const V dstCoeff = Simd::set1(coeffDst);
+		const V srcCoeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V src = Simd::interleave(srcLeft + i / 2, srcRight + i / 2);
+			Simd::store(dst + i, Simd::add(Simd::mul(Simd::load(dst + i), dstCoeff), Simd::mul(src, srcCoeff)));
+		}
+	}
+
+
+	template<bool Overwrite, bool VolumePerFrame, bool PanningPerFrame>
+	static void mixWithGainLoop(float* dst, const float* src,
+		const float* volume, float volumeValue, const float* panning, float panningValue, int frames)
+	{
+		const V percent = Simd::set1(0.01f);
+		const V one = Simd::set1(1.0f);
+		// panning to the right attenuates the left channel and vice versa
+		const V directions = Simd::set2(-1.0f, 1.0f);
+
+		const float v = volumeValue * 0.01f;
+		const float p = panningValue * 0.01f;
+		const V constantVolume = Simd::set1(v);
+		const V constantPanning = Simd::min(one, Simd::add(one, Simd::mul(Simd::set1(p), directions)));
+
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			const V vol = VolumePerFrame ? Simd::mul(Simd::duplicateFrames(volume + i / 2), percent) : constantVolume;
+			const V pan = PanningPerFrame
+				? Simd::min(one, Simd::add(one, Simd::mul(Simd::mul(Simd::duplicateFrames(panning + i / 2), percent), directions)))
+				: constantPanning;
+			const V sum = Overwrite ? Simd::load(src + i) : Simd::add(Simd::load(dst + i), Simd::load(src + i));
+			Simd::store(dst + i, Simd::mul(sum, Simd::mul(pan, vol)));
+		}
+	}
+
+
+	template<bool Overwrite>
+	static void mixWithGainFor(float* dst, const float* src,
+		const float* volume, float volumeValue, const float* panning, float panningValue, int frames)
+	{
+		if (volume && panning)
+		{
+			mixWithGainLoop<Overwrite, true, true>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+		else if (volume)
+		{
+			mixWithGainLoop<Overwrite, true, false>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+		else if (panning)
+		{
+			mixWithGainLoop<Overwrite, false, true>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+		else
+		{
+			mixWithGainLoop<Overwrite, false, false>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+	}
+
+
+	static void mixWithGain(float* dst, const float* src, bool overwrite,
+		const float* volume, float volumeValue, const float* panning, float panningValue, int frames)
+	{
+		if (overwrite)
+		{
+			mixWithGainFor<true>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+		else
+		{
+			mixWithGainFor<false>(dst, src, volume, volumeValue, panning, panningValue, frames);
+		}
+	}
+
+
+	static void deinterleaveMultiplied(const float* src, float* left, float* right, float coeffSrc, int frames)
+	{
+		const V coeff = Simd::set1(coeffSrc);
+		for (int i = 0; i < 2 * frames; i += Step)
+		{
+			Simd::deinterleave(Simd::mul(Simd::load(src + i), coeff), left + i / 2, right + i / 2);
+		}
+	}
+
+
+	static constexpr Kernels table()
+	{
+		return {
+			Simd::Name,
+			Simd::Frames,
+			&isSilent,
+			&hasNonFinite,
+			&sanitize,
+			&add,
+			&addMultiplied,
+			&addSwappedMultiplied,
+			&addMultipliedByBuffer,
+			&addMultipliedByBuffers,
+			&addSanitizedMultiplied,
+			&addSanitizedMultipliedByBuffer,
+			&addSanitizedMultipliedByBuffers,
+			&addSanitizedMultipliedMeasured,
+			&measure,
+			&addMultipliedStereo,
+			&multiplyAndAddMultiplied,
+			&multiplyAndAddMultipliedJoined,
+			&mixWithGain,
+			&deinterleaveMultiplied
+		};
+	}
+};
+
+
+} // namespace lmms::MixHelpers
+
+#endif // LMMS_MIX_KERNELS_H
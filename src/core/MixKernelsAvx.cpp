@@ -0,0 +1,117 @@
+/*
+ * MixKernelsAvx.cpp - MixHelpers loops using AVX
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+#ifdef __AVX__
+
+#include <cfloat>
+#include <immintrin.h>
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Avx
+{
+	using Vector = __m256;
+	using Mask = __m256;
+	static constexpr const char* Name = "avx";
+	static constexpr int Frames = 4;
+
+	static Vector load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+	static Vector set1(float v) { return _mm256_set1_ps(v); }
+	static Vector set2(float left, float right)
+	{
+		return _mm256_setr_ps(left, right, left, right, left, right, left, right);
+	}
+	static Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+	static Vector mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+	static Vector min(Vector a, Vector b) { return _mm256_min_ps(a, b); }
+	static Vector max(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+	static Vector abs(Vector v) { return _mm256_and_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+
+	static Vector swapPairs(Vector v) { return _mm256_permute_ps(v, 0xb1); }
+
+	static Vector combine(__m128 low, __m128 high)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+	}
+
+	static Vector duplicateFrames(const float* p)
+	{
+		const __m128 values = _mm_loadu_ps(p);
+		return combine(_mm_unpacklo_ps(values, values), _mm_unpackhi_ps(values, values));
+	}
+
+	static Vector interleave(const float* left, const float* right)
+	{
+		const __m128 l = _mm_loadu_ps(left);
+		const __m128 r = _mm_loadu_ps(right);
+		return combine(_mm_unpacklo_ps(l, r), _mm_unpackhi_ps(l, r));
+	}
+
+	static void deinterleave(Vector v, float* left, float* right)
+	{
+		const __m128 low = _mm256_castps256_ps128(v);
+		const __m128 high = _mm256_extractf128_ps(v, 1);
+		_mm_storeu_ps(left, _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(right, _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	// infs are larger than FLT_MAX, and nans compare unordered
+	static Mask nonFinite(Vector v) { return _mm256_cmp_ps(abs(v), _mm256_set1_ps(FLT_MAX), _CMP_NLE_UQ); }
+	static Mask atLeast(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static bool any(Mask m) { return _mm256_movemask_ps(m) != 0; }
+
+	static Vector zeroNonFinite(Vector value, Vector test)
+	{
+		return _mm256_and_ps(value, _mm256_cmp_ps(abs(test), _mm256_set1_ps(FLT_MAX), _CMP_LE_OQ));
+	}
+};
+
+const Kernels s_avxKernels = KernelsFor<Avx>::table();
+
+} // namespace
+
+
+const Kernels* avxKernels()
+{
+	return &s_avxKernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#else
+
+const lmms::MixHelpers::Kernels* lmms::MixHelpers::avxKernels()
+{
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * MixKernelsAvx512.cpp - MixHelpers loops using AVX-512
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+#ifdef __AVX512F__
+
+#include <cfloat>
+#include <immintrin.h>
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12 warns about the placeholder operands of its own AVX-512 intrinsics
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Avx512
+{
+	using Vector = __m512;
+	using Mask = __mmask16;
+	static constexpr const char* Name = "avx512";
+	static constexpr int Frames = 8;
+
+	static Vector load(const float* p) { return _mm512_loadu_ps(p); }
+	static void store(float* p, Vector v) { _mm512_storeu_ps(p, v); }
+	static Vector set1(float v) { return _mm512_set1_ps(v); }
+	static Vector set2(float left, float right)
+	{
+		return _mm512_broadcast_f32x4(_mm_setr_ps(left, right, left, right));
+	}
+	static Vector add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+	static Vector mul(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+	static Vector min(Vector a, Vector b) { return _mm512_min_ps(a, b); }
+	static Vector max(Vector a, Vector b) { return _mm512_max_ps(a, b); }
+	static Vector abs(Vector v)
+	{
+		return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+	}
+
+	static Vector swapPairs(Vector v) { return _mm512_permute_ps(v, 0xb1); }
+
+	static Vector duplicateFrames(const float* p)
+	{
+		const __m512i indices = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+		return _mm512_permutexvar_ps(indices, _mm512_castps256_ps512(_mm256_loadu_ps(p)));
+	}
+
+	static Vector interleave(const float* left, const float* right)
+	{
+		// indices from 16 on select from the second operand
+		const __m512i indices = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+		return _mm512_permutex2var_ps(_mm512_castps256_ps512(_mm256_loadu_ps(left)), indices,
+			_mm512_castps256_ps512(_mm256_loadu_ps(right)));
+	}
+
+	static void deinterleave(Vector v, float* left, float* right)
+	{
+		// the left channel into the lower half, the right one into the upper
+		const __m512i indices = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+		const Vector channels = _mm512_permutexvar_ps(indices, v);
+		_mm256_storeu_ps(left, _mm512_castps512_ps256(channels));
+		_mm256_storeu_ps(right, _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(channels), 1)));
+	}
+
+	// infs are larger than FLT_MAX, and nans compare unordered
+	static Mask nonFinite(Vector v) { return _mm512_cmp_ps_mask(abs(v), _mm512_set1_ps(FLT_MAX), _CMP_NLE_UQ); }
+	static Mask atLeast(Vector a, Vector b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+	static bool any(Mask m) { return m != 0; }
+
+	static Vector zeroNonFinite(Vector value, Vector test)
+	{
+		return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(abs(test), _mm512_set1_ps(FLT_MAX), _CMP_LE_OQ), value);
+	}
+};
+
+const Kernels s_avx512Kernels = KernelsFor<Avx512>::table();
+
+} // namespace
+
+
+const Kernels* avx512Kernels()
+{
+	return &s_avx512Kernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#else
+
+const lmms::MixHelpers::Kernels* lmms::MixHelpers::avx512Kernels()
+{
+	return nullptr;
+}
+
+#endif
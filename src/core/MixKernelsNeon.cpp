@@ -0,0 +1,116 @@
+/*
+ * MixKernelsNeon.cpp - MixHelpers loops using NEON
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <cfloat>
+#include <arm_neon.h>
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Neon
+{
+	using Vector = float32x4_t;
+	using Mask = uint32x4_t;
+	static constexpr const char* Name = "neon";
+	static constexpr int Frames = 2;
+
+	static Vector load(const float* p) { return vld1q_f32(p); }
+	static void store(float* p, Vector v) { vst1q_f32(p, v); }
+	static Vector set1(float v) { return vdupq_n_f32(v); }
+	static Vector set2(float left, float right)
+	{
+		const float32x2_t pair = vset_lane_f32(right, vdup_n_f32(left), 1);
+		return vcombine_f32(pair, pair);
+	}
+	static Vector add(Vector a, Vector b) { return vaddq_f32(a, b); }
+	static Vector mul(Vector a, Vector b) { return vmulq_f32(a, b); }
+	static Vector min(Vector a, Vector b) { return vminq_f32(a, b); }
+	static Vector max(Vector a, Vector b) { return vmaxq_f32(a, b); }
+	static Vector abs(Vector v) { return vabsq_f32(v); }
+
+	static Vector swapPairs(Vector v) { return vrev64q_f32(v); }
+
+	static Vector duplicateFrames(const float* p)
+	{
+		const float32x2_t values = vld1_f32(p);
+		return vcombine_f32(vdup_lane_f32(values, 0), vdup_lane_f32(values, 1));
+	}
+
+	static Vector interleave(const float* left, const float* right)
+	{
+		const float32x2x2_t zipped = vzip_f32(vld1_f32(left), vld1_f32(right));
+		return vcombine_f32(zipped.val[0], zipped.val[1]);
+	}
+
+	static void deinterleave(Vector v, float* left, float* right)
+	{
+		const float32x2x2_t channels = vuzp_f32(vget_low_f32(v), vget_high_f32(v));
+		vst1_f32(left, channels.val[0]);
+		vst1_f32(right, channels.val[1]);
+	}
+
+	// infs are larger than FLT_MAX, and nans compare unordered
+	static Mask finite(Vector v) { return vcleq_f32(abs(v), vdupq_n_f32(FLT_MAX)); }
+	static Mask nonFinite(Vector v) { return vmvnq_u32(finite(v)); }
+	static Mask atLeast(Vector a, Vector b) { return vcgeq_f32(a, b); }
+	static bool any(Mask m)
+	{
+		const uint32x2_t halves = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+		return (vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0;
+	}
+
+	static Vector zeroNonFinite(Vector value, Vector test)
+	{
+		return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(value), finite(test)));
+	}
+};
+
+const Kernels s_neonKernels = KernelsFor<Neon>::table();
+
+} // namespace
+
+
+const Kernels* neonKernels()
+{
+	return &s_neonKernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#else
+
+const lmms::MixHelpers::Kernels* lmms::MixHelpers::neonKernels()
+{
+	return nullptr;
+}
+
+#endif
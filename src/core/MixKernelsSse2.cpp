@@ -0,0 +1,112 @@
+/*
+ * MixKernelsSse2.cpp - MixHelpers loops using SSE2
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <cfloat>
+#include <emmintrin.h>
+
+namespace lmms::MixHelpers
+{
+
+namespace
+{
+
+struct Sse2
+{
+	using Vector = __m128;
+	using Mask = __m128;
+	static constexpr const char* Name = "sse2";
+	static constexpr int Frames = 2;
+
+	static Vector load(const float* p) { return _mm_loadu_ps(p); }
+	static void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+	static Vector set1(float v) { return _mm_set1_ps(v); }
+	static Vector set2(float left, float right) { return _mm_setr_ps(left, right, left, right); }
+	static Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+	static Vector mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+	static Vector min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+	static Vector max(Vector a, Vector b) { return _mm_max_ps(a, b); }
+	static Vector abs(Vector v) { return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+
+	static Vector swapPairs(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+
+	//! Loads two floats into the lower half
+	static Vector loadPair(const float* p)
+	{
+		return _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(p));
+	}
+
+	static Vector duplicateFrames(const float* p)
+	{
+		const Vector values = loadPair(p);
+		return _mm_unpacklo_ps(values, values);
+	}
+
+	static Vector interleave(const float* left, const float* right)
+	{
+		return _mm_unpacklo_ps(loadPair(left), loadPair(right));
+	}
+
+	static void deinterleave(Vector v, float* left, float* right)
+	{
+		const Vector channels = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storel_pi(reinterpret_cast<__m64*>(left), channels);
+		_mm_storeh_pi(reinterpret_cast<__m64*>(right), channels);
+	}
+
+	// infs are larger than FLT_MAX, and nans compare unordered
+	static Mask nonFinite(Vector v) { return _mm_cmpnle_ps(abs(v), _mm_set1_ps(FLT_MAX)); }
+	static Mask atLeast(Vector a, Vector b) { return _mm_cmpge_ps(a, b); }
+	static bool any(Mask m) { return _mm_movemask_ps(m) != 0; }
+
+	static Vector zeroNonFinite(Vector value, Vector test)
+	{
+		return _mm_and_ps(value, _mm_cmple_ps(abs(test), _mm_set1_ps(FLT_MAX)));
+	}
+};
+
+const Kernels s_sse2Kernels = KernelsFor<Sse2>::table();
+
+} // namespace
+
+
+const Kernels* sse2Kernels()
+{
+	return &s_sse2Kernels;
+}
+
+} // namespace lmms::MixHelpers
+
+#else
+
+const lmms::MixHelpers::Kernels* lmms::MixHelpers::sse2Kernels()
+{
+	return nullptr;
+}
+
+#endif
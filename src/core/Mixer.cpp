@@ -23,10 +23,15 @@
  */
 
 #include <QDomElement>
+#include <algorithm>
+#include <cmath>
 
 #include "AudioEngine.h"
+#include "AudioDevice.h"
 #include "AudioEngineWorkerThread.h"
+#include "AudioPort.h"
 #include "BufferManager.h"
+#include "ChannelOutput.h"
 #include "Mixer.h"
 #include "MixHelpers.h"
 #include "Song.h"
@@ -51,6 +56,28 @@ MixerRoute::MixerRoute( MixerChannel * from, MixerChannel * to, float amount ) :
 }
 
 
+void MixerRoute::setCompensation( f_cnt_t frames )
+{
+	m_compensation.setDelay( frames );
+	const auto fpp = static_cast<std::size_t>( Engine::audioEngine()->framesPerPeriod() );
+	if( frames > 0 && m_compensationBuffer.size() < fpp )
+	{
+		m_compensationBuffer.resize( fpp );
+	}
+}
+
+
+const sampleFrame * MixerRoute::compensate( const sampleFrame * buf, fpp_t frames, bool hasInput )
+{
+	if( hasInput )
+	{
+		std::copy_n( buf, frames, m_compensationBuffer.data() );
+	}
+	m_compensation.process( m_compensationBuffer.data(), frames, hasInput );
+	return m_compensationBuffer.data();
+}
+
+
 void MixerRoute::updateName()
 {
 	m_amount.setDisplayName(
@@ -62,19 +89,40 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_fxChain( nullptr ),
 	m_hasInput( false ),
 	m_stillRunning( false ),
-	m_peakLeft( 0.0f ),
-	m_peakRight( 0.0f ),
+	m_fxChainActive( false ),
 	m_buffer( new sampleFrame[Engine::audioEngine()->framesPerPeriod()] ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
 	m_volumeModel( 1.0, 0.0, 2.0, 0.001, _parent ),
+	m_outputModel( false, _parent ),
 	m_name(),
 	m_lock(),
 	m_channelIndex( idx ),
 	m_queued( false ),
-	m_dependenciesMet(0)
+	m_bypassTarget( nullptr ),
+	m_bypassGain( 1.0f ),
+	m_measuredBySend( false ),
+	m_portInputs( 0 ),
+	m_dependenciesMet(0),
+	m_partialInputs( AudioEngineWorkerThread::workerCount() ),
+	m_pendingSquares{ 0.0, 0.0 },
+	m_pendingFrames( 0 ),
+	m_levelsSequence( 0 ),
+	m_levelsTaken( 0 ),
+	m_cpuAccount( Engine::audioEngine()->profiler(), QString( "Mixer %1" ).arg( idx ) )
 {
 	BufferManager::clear( m_buffer, Engine::audioEngine()->framesPerPeriod() );
+	for( PartialInput & partial : m_partialInputs )
+	{
+		partial.buffer = new sampleFrame[Engine::audioEngine()->framesPerPeriod()];
+		partial.hasInput = false;
+	}
+	for( std::atomic<float> & level : m_publishedLevels )
+	{
+		level.store( 0.0f, std::memory_order_relaxed );
+	}
+
+	QObject::connect( &m_outputModel, &BoolModel::dataChanged, [this] { updateOutput(); } );
 }
 
 
@@ -82,6 +130,10 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 
 MixerChannel::~MixerChannel()
 {
+	for( PartialInput & partial : m_partialInputs )
+	{
+		delete[] partial.buffer;
+	}
 	delete[] m_buffer;
 }
 
@@ -100,13 +152,168 @@ inline void MixerChannel::processed()
 void MixerChannel::incrementDeps()
 {
 	int i = m_dependenciesMet++ + 1;
-	if( i >= m_receives.size() && ! m_queued )
+	if( i >= m_receives.size() + m_portInputs && ! m_queued )
 	{
 		m_queued = true;
 		AudioEngineWorkerThread::addJob( this );
 	}
 }
 
+void MixerChannel::addInput( const sampleFrame * buf )
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	const size_t worker = AudioEngineWorkerThread::currentWorker();
+
+	if( worker >= m_partialInputs.size() )
+	{
+		// not called from one of the workers this channel knows about
+		m_lock.lock();
+		MixHelpers::add( m_buffer, buf, fpp );
+		m_hasInput = true;
+		m_lock.unlock();
+		return;
+	}
+
+	PartialInput & partial = m_partialInputs[worker];
+	if( partial.hasInput )
+	{
+		MixHelpers::add( partial.buffer, buf, fpp );
+	}
+	else
+	{
+		// first input in this period, saves clearing the buffer beforehand
+		std::copy( buf, buf + fpp, partial.buffer );
+		partial.hasInput = true;
+	}
+}
+
+
+
+
+void MixerChannel::addInput( const sampleFrame * buf, float gain )
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	const size_t worker = AudioEngineWorkerThread::currentWorker();
+
+	if( worker >= m_partialInputs.size() )
+	{
+		m_lock.lock();
+		if( MixHelpers::addSanitizedMultiplied( m_buffer, buf, gain, fpp ) )
+		{
+			m_nonFinite.store( true, std::memory_order_relaxed );
+		}
+		m_hasInput = true;
+		m_lock.unlock();
+		return;
+	}
+
+	PartialInput & partial = m_partialInputs[worker];
+	if( !partial.hasInput )
+	{
+		BufferManager::clear( partial.buffer, fpp );
+		partial.hasInput = true;
+	}
+	if( MixHelpers::addSanitizedMultiplied( partial.buffer, buf, gain, fpp ) )
+	{
+		m_nonFinite.store( true, std::memory_order_relaxed );
+	}
+}
+
+
+
+
+void MixerChannel::mixPartialInputs()
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+
+	for( PartialInput & partial : m_partialInputs )
+	{
+		if( partial.hasInput )
+		{
+			MixHelpers::add( m_buffer, partial.buffer, fpp );
+			partial.hasInput = false;
+			m_hasInput = true;
+		}
+	}
+}
+
+
+
+
+void MixerChannel::discardPartialInputs()
+{
+	for( PartialInput & partial : m_partialInputs )
+	{
+		partial.hasInput = false;
+	}
+}
+
+
+
+
+auto MixerChannel::takeLevels() -> std::optional<Levels>
+{
+	unsigned sequence;
+	Levels levels;
+	do
+	{
+		sequence = m_levelsSequence.load( std::memory_order_acquire );
+		if( sequence == m_levelsTaken.load( std::memory_order_relaxed ) )
+		{
+			return std::nullopt;
+		}
+		levels.peakLeft = m_publishedLevels[0].load( std::memory_order_relaxed );
+		levels.peakRight = m_publishedLevels[1].load( std::memory_order_relaxed );
+		levels.rmsLeft = m_publishedLevels[2].load( std::memory_order_relaxed );
+		levels.rmsRight = m_publishedLevels[3].load( std::memory_order_relaxed );
+		levels.truePeak = m_publishedLevels[4].load( std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_acquire );
+	}
+	// try again if the audio thread was publishing meanwhile
+	while( sequence % 2 != 0 || m_levelsSequence.load( std::memory_order_relaxed ) != sequence );
+
+	m_levelsTaken.store( sequence, std::memory_order_release );
+	return levels;
+}
+
+
+
+
+void MixerChannel::publishLevels( float gain, float truePeak )
+{
+	const unsigned sequence = m_levelsSequence.load( std::memory_order_relaxed );
+	if( m_levelsTaken.load( std::memory_order_acquire ) == sequence )
+	{
+		// the GUI has got everything before, if it took an older sequence
+		// it gets that again along with this period
+		m_pendingLevels = Levels();
+		m_pendingSquares[0] = m_pendingSquares[1] = 0.0;
+		m_pendingFrames = 0;
+	}
+
+	m_pendingLevels.peakLeft = std::max( m_pendingLevels.peakLeft, m_measurement.peaks[0] * gain );
+	m_pendingLevels.peakRight = std::max( m_pendingLevels.peakRight, m_measurement.peaks[1] * gain );
+	m_pendingLevels.truePeak = std::max( m_pendingLevels.truePeak, truePeak );
+	m_pendingSquares[0] += m_measurement.squares[0] * gain * gain;
+	m_pendingSquares[1] += m_measurement.squares[1] * gain * gain;
+	m_pendingFrames += Engine::audioEngine()->framesPerPeriod();
+	m_pendingLevels.rmsLeft = static_cast<float>( std::sqrt( m_pendingSquares[0] / m_pendingFrames ) );
+	m_pendingLevels.rmsRight = static_cast<float>( std::sqrt( m_pendingSquares[1] / m_pendingFrames ) );
+	m_measurement = MixHelpers::Measurement();
+
+	m_levelsSequence.store( sequence + 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	m_publishedLevels[0].store( m_pendingLevels.peakLeft, std::memory_order_relaxed );
+	m_publishedLevels[1].store( m_pendingLevels.peakRight, std::memory_order_relaxed );
+	m_publishedLevels[2].store( m_pendingLevels.rmsLeft, std::memory_order_relaxed );
+	m_publishedLevels[3].store( m_pendingLevels.rmsRight, std::memory_order_relaxed );
+	m_publishedLevels[4].store( m_pendingLevels.truePeak, std::memory_order_relaxed );
+	m_levelsSequence.store( sequence + 2, std::memory_order_release );
+}
+
+
+
+
 void MixerChannel::unmuteForSolo()
 {
 	//TODO: Recursively activate every channel, this channel sends to
@@ -115,69 +322,150 @@ void MixerChannel::unmuteForSolo()
 
 
 
+void MixerChannel::updateCpuAccountName()
+{
+	m_cpuAccount.setName( QString( "Mixer %1" ).arg( m_channelIndex ) );
+}
+
+
+
+
+
+void MixerChannel::updateOutput()
+{
+	// the master is what the device outputs anyway
+	AudioDevice * device = Engine::audioEngine()->audioDev();
+	std::unique_ptr<ChannelOutput> output;
+	if( m_outputModel.value() && m_channelIndex != 0 && device )
+	{
+		output = device->createChannelOutput( outputName() );
+	}
+
+	const auto guard = Engine::audioEngine()->requestChangesGuard();
+	std::swap( output, m_output );
+}
+
+
+
+
+void MixerChannel::updateOutputName()
+{
+	if( m_output )
+	{
+		m_output->rename( outputName() );
+	}
+}
+
+
+
+
+QString MixerChannel::outputName() const
+{
+	// a channel's name needn't be unique
+	return QString( "%1 %2" ).arg( m_channelIndex ).arg( m_name );
+}
+
+
+
+
 void MixerChannel::doProcessing()
 {
+	AudioEngineTracer::Scope traceScope( "MixerChannel", m_channelIndex );
+	AudioEngineProfiler::AccountProbe profilerProbe( m_cpuAccount );
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
 	if( m_muted == false )
 	{
+		mixPartialInputs();
+
 		for( MixerRoute * senderRoute : m_receives )
 		{
 			MixerChannel * sender = senderRoute->sender();
 			FloatModel * sendModel = senderRoute->amount();
 			if( ! sendModel ) qFatal( "Error: no send model found from %d to %d", senderRoute->senderIndex(), m_channelIndex );
 
-			if( sender->m_hasInput || sender->m_stillRunning )
+			const bool senderActive = sender->m_hasInput || sender->m_fxChainActive;
+			if( senderActive || senderRoute->hasCompensationTail() )
 			{
 				// figure out if we're getting sample-exact input
 				ValueBuffer * sendBuf = sendModel->valueBuffer();
 				ValueBuffer * volBuf = sender->m_volumeModel.valueBuffer();
 
-				// mix it's output with this one's output
-				sampleFrame * ch_buf = sender->m_buffer;
+				// mix it's output with this one's output, as late as
+				// the other paths to this channel with more latency
+				const sampleFrame * ch_buf = senderRoute->compensation() > 0
+					? senderRoute->compensate( sender->m_buffer, fpp, senderActive )
+					: sender->m_buffer;
 
+				bool nonFinite;
 				// use sample-exact mixing if sample-exact values are available
 				if( ! volBuf && ! sendBuf ) // neither volume nor send has sample-exact data...
 				{
 					const float v = sender->m_volumeModel.value() * sendModel->value();
-					MixHelpers::addSanitizedMultiplied( m_buffer, ch_buf, v, fpp );
+					if( senderRoute == sender->m_sends.front() && sender->m_measuredBySend )
+					{
+						nonFinite = MixHelpers::addSanitizedMultipliedMeasured( m_buffer, ch_buf, v, fpp, sender->m_measurement );
+					}
+					else
+					{
+						nonFinite = MixHelpers::addSanitizedMultiplied( m_buffer, ch_buf, v, fpp );
+					}
 				}
 				else if( volBuf && sendBuf ) // both volume and send have sample-exact data
 				{
-					MixHelpers::addSanitizedMultipliedByBuffers( m_buffer, ch_buf, volBuf, sendBuf, fpp );
+					nonFinite = MixHelpers::addSanitizedMultipliedByBuffers( m_buffer, ch_buf, volBuf, sendBuf, fpp );
 				}
 				else if( volBuf ) // volume has sample-exact data but send does not
 				{
 					const float v = sendModel->value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, volBuf, fpp );
+					nonFinite = MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, volBuf, fpp );
 				}
 				else // vice versa
 				{
 					const float v = sender->m_volumeModel.value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, sendBuf, fpp );
+					nonFinite = MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, sendBuf, fpp );
+				}
+				if( nonFinite )
+				{
+					// the sender's effects quarantine themselves if they're to
+					// blame, so it's what its tracks sent
+					sender->m_nonFinite.store( true, std::memory_order_relaxed );
 				}
 				m_hasInput = true;
 			}
 		}
 
-
-		const float v = m_volumeModel.value();
-
 		if( m_hasInput )
 		{
 			// only start fxchain when we have input...
 			m_fxChain.startRunning();
 		}
 
+		m_fxChainActive = m_fxChain.isActive( m_hasInput );
 		m_stillRunning = m_fxChain.processAudioBuffer( m_buffer, fpp, m_hasInput );
 
-		AudioEngine::StereoSample peakSamples = Engine::audioEngine()->getPeakValues(m_buffer, fpp);
-		m_peakLeft = std::max(m_peakLeft, peakSamples.left * v);
-		m_peakRight = std::max(m_peakRight, peakSamples.right * v);
-	}
-	else
-	{
-		m_peakLeft = m_peakRight = 0.0f;
+		// a silent buffer can't raise the levels. The master is measured
+		// while it's mixed into the output, the others while the first
+		// channel they send to mixes them in, unless it's muted or mixes
+		// them sample-exactly or delayed.
+		if( ( m_hasInput || m_fxChainActive ) && m_channelIndex != 0 )
+		{
+			MixerRoute * send = m_sends.empty() ? nullptr : m_sends.front();
+			m_measuredBySend = send && !send->receiver()->m_muted && send->compensation() == 0
+				&& !m_volumeModel.valueBuffer() && !send->amount()->valueBuffer();
+			if( !m_measuredBySend )
+			{
+				MixHelpers::measure( m_buffer, fpp, m_measurement );
+			}
+		}
+
+		// straight to the device, after the fader - it plays silence
+		// in every period the channel doesn't write
+		if( m_output && ( m_hasInput || m_fxChainActive ) )
+		{
+			m_output->write( m_buffer, fpp, m_volumeModel.value(),
+						Engine::audioEngine()->currentPeriod() );
+		}
 	}
 
 	// increment dependency counter of all receivers
@@ -190,7 +478,9 @@ Mixer::Mixer() :
 	Model( nullptr ),
 	JournallingObject(),
 	m_mixerChannels(),
-	m_lastSoloed(-1)
+	m_lastSoloed(-1),
+	m_taskGraph(false),
+	m_levelsChanged(true)
 {
 	// create master channel
 	createChannel();
@@ -219,6 +509,7 @@ int Mixer::createChannel()
 	const int index = m_mixerChannels.size();
 	// create new channel
 	m_mixerChannels.push_back( new MixerChannel( index, this ) );
+	m_levelsChanged = true;
 
 	// reset channel state
 	clearChannel( index );
@@ -354,6 +645,7 @@ void Mixer::deleteChannel( int index )
 	// actually delete the channel
 	m_mixerChannels.erase(m_mixerChannels.begin() + index);
 	delete ch;
+	m_levelsChanged = true;
 
 	for( int i = index; i < m_mixerChannels.size(); ++i )
 	{
@@ -361,6 +653,8 @@ void Mixer::deleteChannel( int index )
 
 		// set correct channel index
 		m_mixerChannels[i]->m_channelIndex = i;
+		m_mixerChannels[i]->updateCpuAccountName();
+		m_mixerChannels[i]->updateOutputName();
 
 		// now check all routes and update names of the send models
 		for( MixerRoute * r : m_mixerChannels[i]->m_sends )
@@ -435,6 +729,10 @@ void Mixer::moveChannelLeft( int index )
 	// Update m_channelIndex of both channels
 	m_mixerChannels[index]->m_channelIndex = index;
 	m_mixerChannels[index - 1]->m_channelIndex = index -1;
+	m_mixerChannels[index]->updateCpuAccountName();
+	m_mixerChannels[index - 1]->updateCpuAccountName();
+	m_mixerChannels[index]->updateOutputName();
+	m_mixerChannels[index - 1]->updateOutputName();
 }
 
 
@@ -486,6 +784,7 @@ MixerRoute * Mixer::createRoute( MixerChannel * from, MixerChannel * to, float a
 
 	// add us to mixer's list
 	Engine::mixer()->m_mixerRoutes.push_back(route);
+	Engine::mixer()->m_levelsChanged = true;
 	Engine::audioEngine()->doneChangeInModel();
 
 	return route;
@@ -529,6 +828,7 @@ void Mixer::deleteChannelSend( MixerRoute * route )
 
 	// remove us from mixer's list
 	removeFromMixerRoute(Engine::mixer()->m_mixerRoutes);
+	Engine::mixer()->m_levelsChanged = true;
 
 	delete route;
 	Engine::audioEngine()->doneChangeInModel();
@@ -598,30 +898,203 @@ FloatModel * Mixer::channelSendModel( mix_ch_t fromChannel, mix_ch_t toChannel )
 
 void Mixer::mixToChannel( const sampleFrame * _buf, mix_ch_t _ch )
 {
-	if( m_mixerChannels[_ch]->m_muteModel.value() == false )
+	MixerChannel * ch = m_mixerChannels[_ch];
+	if( ch->m_muteModel.value() == false )
 	{
-		m_mixerChannels[_ch]->m_lock.lock();
-		MixHelpers::add( m_mixerChannels[_ch]->m_buffer, _buf, Engine::audioEngine()->framesPerPeriod() );
-		m_mixerChannels[_ch]->m_hasInput = true;
-		m_mixerChannels[_ch]->m_lock.unlock();
+		if( ch->m_bypassTarget )
+		{
+			ch->m_bypassTarget->addInput( _buf, ch->m_bypassGain );
+		}
+		else
+		{
+			ch->addInput( _buf );
+		}
 	}
 }
 
 
 
 
-void Mixer::prepareMasterMix()
+void Mixer::prepareMasterMix( const std::vector<AudioPort*> & ports )
 {
 	BufferManager::clear( m_mixerChannels[0]->m_buffer,
 					Engine::audioEngine()->framesPerPeriod() );
+
+	if( m_levelsChanged )
+	{
+		updateLevels();
+	}
+	// effects change their latency without the routing changing
+	updateCompensation( ports );
+
+	// the meters of bypassed channels would stay dark, which only doesn't
+	// matter while exporting. Effects, mute, compensation and sample-exact
+	// volume or send automation change without the routing changing, so
+	// they are checked every period.
+	const bool exporting = Engine::getSong()->isExporting();
+	for( MixerChannel * ch : m_passThrough )
+	{
+		MixerRoute * send = ch->m_sends.front();
+		if( exporting && ch->m_fxChain.effects().empty() && !ch->m_muteModel.value()
+			&& send->compensation() == 0 && !send->hasCompensationTail()
+			&& !ch->m_volumeModel.valueBuffer() && !send->amount()->valueBuffer() )
+		{
+			ch->m_bypassTarget = send->receiver();
+			ch->m_bypassGain = ch->m_volumeModel.value() * send->amount()->value();
+		}
+		else
+		{
+			ch->m_bypassTarget = nullptr;
+		}
+	}
 }
 
 
 
 void Mixer::masterMix( sampleFrame * _buf )
 {
-	const int fpp = Engine::audioEngine()->framesPerPeriod();
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		ch->m_muted = ch->m_muteModel.value();
+		// the levels decide when a channel is processed, so the channels
+		// sending to it mustn't queue it
+		ch->m_queued = true;
+	}
+
+	// muted and bypassed channels are skipped, like the task graph does
+	for( const auto & level : m_levels )
+	{
+		AudioEngineWorkerThread::resetJobQueue();
+		for( MixerChannel * ch : level )
+		{
+			if( !ch->m_muted && !ch->m_bypassTarget )
+			{
+				AudioEngineWorkerThread::addJob( ch );
+			}
+		}
+		AudioEngineWorkerThread::startAndWaitForJobs();
+	}
+
+	finishMasterMix( _buf );
+}
+
+
+
+
+void Mixer::updateLevels()
+{
+	// count down the senders of every channel, a channel belongs to the
+	// level after the one its last sender was found in
+	std::vector<int> senders( m_mixerChannels.size() );
+	std::vector<MixerChannel*> level;
+	m_passThrough.clear();
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		senders[ch->m_channelIndex] = static_cast<int>( ch->m_receives.size() );
+		if( ch->m_receives.empty() )
+		{
+			level.push_back( ch );
+		}
+
+		// its route may be gone
+		ch->m_bypassTarget = nullptr;
+		if( ch->m_channelIndex > 0 && ch->m_receives.empty() && ch->m_sends.size() == 1 )
+		{
+			m_passThrough.push_back( ch );
+		}
+	}
+
+	m_levels.clear();
+	while( !level.empty() )
+	{
+		std::vector<MixerChannel*> next;
+		for( const MixerChannel * ch : level )
+		{
+			for( const MixerRoute * route : ch->m_sends )
+			{
+				if( --senders[route->receiverIndex()] == 0 )
+				{
+					next.push_back( route->receiver() );
+				}
+			}
+		}
+		m_levels.push_back( std::move( level ) );
+		level = std::move( next );
+	}
+	m_levelsChanged = false;
+}
+
+
+
+
+void Mixer::updateCompensation( const std::vector<AudioPort*> & ports )
+{
+	// a channel's input is as late as its latest input, its output is
+	// later by the latency of its effects
+	m_inputLatencies.assign( m_mixerChannels.size(), 0 );
+	m_outputLatencies.assign( m_mixerChannels.size(), 0 );
+	for( const AudioPort * port : ports )
+	{
+		if( port->nextMixerChannel() < m_mixerChannels.size() )
+		{
+			f_cnt_t & input = m_inputLatencies[port->nextMixerChannel()];
+			input = std::max( input, port->latency() );
+		}
+	}
+	for( const auto & level : m_levels )
+	{
+		for( const MixerChannel * ch : level )
+		{
+			f_cnt_t & input = m_inputLatencies[ch->m_channelIndex];
+			for( const MixerRoute * route : ch->m_receives )
+			{
+				input = std::max( input, m_outputLatencies[route->senderIndex()] );
+			}
+			m_outputLatencies[ch->m_channelIndex] = input + ch->m_fxChain.latency();
+		}
+	}
+
+	// and everything arriving earlier waits for it
+	for( MixerRoute * route : m_mixerRoutes )
+	{
+		route->setCompensation( m_inputLatencies[route->receiverIndex()]
+			- m_outputLatencies[route->senderIndex()] );
+	}
+	for( AudioPort * port : ports )
+	{
+		if( port->nextMixerChannel() < m_mixerChannels.size() )
+		{
+			port->setCompensation( m_inputLatencies[port->nextMixerChannel()] - port->latency() );
+		}
+	}
+}
 
+
+
+
+void Mixer::prepareTaskGraph( const std::vector<AudioPort*> & ports )
+{
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		ch->m_muted = ch->m_muteModel.value();
+		ch->m_portInputs = 0;
+	}
+	for( const AudioPort * port : ports )
+	{
+		if( port->nextMixerChannel() < m_mixerChannels.size() )
+		{
+			MixerChannel * ch = m_mixerChannels[port->nextMixerChannel()];
+			++( ch->m_bypassTarget ? ch->m_bypassTarget : ch )->m_portInputs;
+		}
+	}
+	m_taskGraph = true;
+}
+
+
+
+
+void Mixer::scheduleChannels()
+{
 	// add the channels that have no dependencies (no incoming senders, ie.
 	// no receives) to the jobqueue. The channels that have receives get
 	// added when their senders get processed, which is detected by
@@ -629,41 +1102,51 @@ void Mixer::masterMix( sampleFrame * _buf )
 	// also instantly add all muted channels as they don't need to care
 	// about their senders, and can just increment the deps of their
 	// recipients right away.
-	AudioEngineWorkerThread::resetJobQueue( AudioEngineWorkerThread::JobQueue::OperationMode::Dynamic );
 	for( MixerChannel * ch : m_mixerChannels )
 	{
-		ch->m_muted = ch->m_muteModel.value();
-		if( ch->m_muted ) // instantly "process" muted channels
+		// instantly "process" muted channels and bypassed ones, whose
+		// inputs went to the channel they send to
+		if( ch->m_muted || ch->m_bypassTarget )
 		{
 			ch->processed();
 			ch->done();
 		}
-		else if( ch->m_receives.size() == 0 )
+		else if( ch->m_receives.size() == 0 && ch->m_portInputs == 0 )
 		{
 			ch->m_queued = true;
 			AudioEngineWorkerThread::addJob( ch );
 		}
 	}
-	while (m_mixerChannels[0]->state() != ThreadableJob::ProcessingState::Done)
+}
+
+
+
+
+void Mixer::inputProcessed( mix_ch_t _ch )
+{
+	if( !m_taskGraph || _ch >= m_mixerChannels.size() )
 	{
-		bool found = false;
-		for( MixerChannel * ch : m_mixerChannels )
-		{
-			const auto s = ch->state();
-			if (s == ThreadableJob::ProcessingState::Queued
-				|| s == ThreadableJob::ProcessingState::InProgress)
-			{
-				found = true;
-				break;
-			}
-		}
-		if( !found )
-		{
-			break;
-		}
-		AudioEngineWorkerThread::startAndWaitForJobs();
+		return;
 	}
 
+	MixerChannel * ch = m_mixerChannels[_ch];
+	if( ch->m_bypassTarget )
+	{
+		ch = ch->m_bypassTarget;
+	}
+	if( !ch->m_muted )
+	{
+		ch->incrementDeps();
+	}
+}
+
+
+
+
+void Mixer::finishMasterMix( sampleFrame * _buf )
+{
+	const int fpp = Engine::audioEngine()->framesPerPeriod();
+
 	// handle sample-exact data in master volume fader
 	ValueBuffer * volBuf = m_mixerChannels[0]->m_volumeModel.valueBuffer();
 
@@ -679,20 +1162,36 @@ void Mixer::masterMix( sampleFrame * _buf )
 	const float v = volBuf
 		? 1.0f
 		: m_mixerChannels[0]->m_volumeModel.value();
-	MixHelpers::addSanitizedMultiplied( _buf, m_mixerChannels[0]->m_buffer, v, fpp );
+	if( MixHelpers::addSanitizedMultipliedMeasured( _buf, m_mixerChannels[0]->m_buffer, v, fpp,
+		m_mixerChannels[0]->m_measurement ) )
+	{
+		m_mixerChannels[0]->m_nonFinite.store( true, std::memory_order_relaxed );
+	}
+	m_mixerChannels[0]->publishLevels( v, m_masterTruePeak.process( _buf, fpp ) );
 
-	// clear all channel buffers and
+	// clear all channel buffers that had anything written to them and
 	// reset channel process state
 	for( int i = 0; i < numChannels(); ++i)
 	{
-		BufferManager::clear( m_mixerChannels[i]->m_buffer,
-				Engine::audioEngine()->framesPerPeriod() );
+		if( i > 0 )
+		{
+			m_mixerChannels[i]->publishLevels( m_mixerChannels[i]->m_volumeModel.value() );
+		}
+		if( m_mixerChannels[i]->m_hasInput || m_mixerChannels[i]->m_fxChainActive )
+		{
+			BufferManager::clear( m_mixerChannels[i]->m_buffer,
+					Engine::audioEngine()->framesPerPeriod() );
+		}
 		m_mixerChannels[i]->reset();
+		m_mixerChannels[i]->m_fxChainActive = false;
 		m_mixerChannels[i]->m_queued = false;
 		// also reset hasInput
 		m_mixerChannels[i]->m_hasInput = false;
+		m_mixerChannels[i]->discardPartialInputs();
 		m_mixerChannels[i]->m_dependenciesMet = 0;
+		m_mixerChannels[i]->m_portInputs = 0;
 	}
+	m_taskGraph = false;
 }
 
 
@@ -717,6 +1216,7 @@ void Mixer::clearChannel(mix_ch_t index)
 	ch->m_volumeModel.setValue( 1.0f );
 	ch->m_muteModel.setValue( false );
 	ch->m_soloModel.setValue( false );
+	ch->m_outputModel.setValue( false );
 	ch->m_name = ( index == 0 ) ? tr( "Master" ) : tr( "Channel %1" ).arg( index );
 	ch->m_volumeModel.setDisplayName( ch->m_name + ">" + tr( "Volume" ) );
 	ch->m_muteModel.setDisplayName( ch->m_name + ">" + tr( "Mute" ) );
@@ -757,6 +1257,7 @@ void Mixer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 		ch->m_volumeModel.saveSettings( _doc, mixch, "volume" );
 		ch->m_muteModel.saveSettings( _doc, mixch, "muted" );
 		ch->m_soloModel.saveSettings( _doc, mixch, "soloed" );
+		ch->m_outputModel.saveSettings( _doc, mixch, "output" );
 		mixch.setAttribute( "num", i );
 		mixch.setAttribute( "name", ch->m_name );
 		if (const auto& color = ch->color()) { mixch.setAttribute("color", color->name()); }
@@ -804,7 +1305,9 @@ void Mixer::loadSettings( const QDomElement & _this )
 		m_mixerChannels[num]->m_volumeModel.loadSettings( mixch, "volume" );
 		m_mixerChannels[num]->m_muteModel.loadSettings( mixch, "muted" );
 		m_mixerChannels[num]->m_soloModel.loadSettings( mixch, "soloed" );
+		m_mixerChannels[num]->m_outputModel.loadSettings( mixch, "output" );
 		m_mixerChannels[num]->m_name = mixch.attribute( "name" );
+		m_mixerChannels[num]->updateOutputName();
 		if (mixch.hasAttribute("color"))
 		{
 			m_mixerChannels[num]->setColor(QColor{mixch.attribute("color")});
@@ -844,6 +1347,28 @@ void Mixer::validateChannelName( int index, int oldIndex )
 	}
 }
 
+
+
+
+void Mixer::createChannelOutputs()
+{
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		ch->updateOutput();
+	}
+}
+
+
+
+
+void Mixer::releaseChannelOutputs()
+{
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		ch->m_output.reset();
+	}
+}
+
 bool Mixer::isChannelInUse(int index)
 {
 	// check if the index mixer channel receives audio from any other channel
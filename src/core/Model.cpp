@@ -24,14 +24,24 @@
 
 #include "Model.h"
 
+#include <QThread>
+
 namespace lmms
 {
 
+std::atomic<Model*> Model::s_displayChanges = nullptr;
+
 Model::Model(Model* parent, QString displayName, bool defaultConstructed) :
 	QObject(parent),
 	m_displayName(displayName),
 	m_defaultConstructed(defaultConstructed)
 {
+	connect(this, &Model::dataChanged, this, &Model::markDisplayChanged, Qt::DirectConnection);
+}
+
+Model::~Model()
+{
+	if (m_displayChangePending) { removeFromDisplayChanges(); }
 }
 
 bool Model::isDefaultConstructed() const
@@ -71,6 +81,50 @@ QString Model::fullDisplayName() const
 	return n;
 }
 
+void Model::emitDisplayChanges()
+{
+	auto model = s_displayChanges.exchange(nullptr);
+	while (model)
+	{
+		// once it's no longer pending another thread may mark it again
+		const auto next = model->m_nextDisplayChange;
+		model->m_displayChangePending = false;
+		emit model->displayChanged();
+		model = next;
+	}
+}
+
+void Model::markDisplayChanged()
+{
+	if (QThread::currentThread() == thread())
+	{
+		emit displayChanged();
+		return;
+	}
+
+	if (m_displayChangePending.exchange(true)) { return; }
+
+	m_nextDisplayChange = s_displayChanges.load();
+	while (!s_displayChanges.compare_exchange_weak(m_nextDisplayChange, this)) {}
+}
+
+void Model::removeFromDisplayChanges()
+{
+	// models are destroyed on the GUI thread, which is the only one taking
+	// models off the list, so the others can be put back one by one
+	auto model = s_displayChanges.exchange(nullptr);
+	while (model)
+	{
+		const auto next = model->m_nextDisplayChange;
+		if (model != this)
+		{
+			model->m_nextDisplayChange = s_displayChanges.load();
+			while (!s_displayChanges.compare_exchange_weak(model->m_nextDisplayChange, model)) {}
+		}
+		model = next;
+	}
+}
+
 
 
 } // namespace lmms
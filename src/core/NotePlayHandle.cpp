@@ -25,20 +25,127 @@
 
 #include "NotePlayHandle.h"
 
+#include <algorithm>
+
+#include <QMutex>
+#include <QThread>
+
 #include "AudioEngine.h"
 #include "BasicFilters.h"
 #include "DetuningHelper.h"
 #include "InstrumentSoundShaping.h"
 #include "InstrumentTrack.h"
 #include "Instrument.h"
+#include "LocklessIndexStack.h"
+#include "lmms_math.h"
 #include "Song.h"
 
 namespace lmms
 {
 
+namespace
+{
+
+// notes playing that weren't stolen, and how many were
+std::atomic_int s_voices{0};
+std::atomic_int s_stolen{0};
+std::atomic_int s_voiceLimit{0};
+
+// how long a released note has to be inaudible for to be ended
+constexpr float InaudibleSeconds = 0.05f;
+
+} // namespace
+
+
 NotePlayHandle::BaseDetuning::BaseDetuning( DetuningHelper *detuning ) :
-	m_value( detuning ? detuning->automationClip()->valueAt( 0 ) : 0 )
+	m_detuning( detuning ),
+	m_time( 0 ),
+	m_offset( 0 ),
+	m_period( 0 )
+{
+}
+
+
+
+
+const AutomationClip* NotePlayHandle::BaseDetuning::clip() const
+{
+	return m_detuning ? m_detuning->automationClip() : nullptr;
+}
+
+
+
+
+void NotePlayHandle::BaseDetuning::follow( double time, f_cnt_t offset )
+{
+	m_time = time;
+	m_offset = offset;
+	m_period = Engine::audioEngine()->currentPeriod();
+}
+
+
+
+
+std::optional<double> NotePlayHandle::BaseDetuning::timeAtPeriodStart() const
+{
+	if( m_detuning == nullptr || m_period == 0 )
+	{
+		return std::nullopt;
+	}
+
+	const AudioEngine * audioEngine = Engine::audioEngine();
+	const auto framesPerTick = Engine::framesPerTick();
+	const double elapsed = static_cast<double>( audioEngine->currentPeriod() - m_period )
+		* audioEngine->framesPerPeriod() - m_offset;
+	// the song would have played the next tick by now if it still played
+	if( elapsed > framesPerTick + 1 )
+	{
+		return std::nullopt;
+	}
+	return m_time + elapsed / framesPerTick;
+}
+
+
+
+
+void NotePlayHandle::SubNotes::push_back( NotePlayHandle * note )
+{
+	note->m_siblings = this;
+	note->m_previousSibling = m_last;
+	note->m_nextSibling = nullptr;
+	( m_last ? m_last->m_nextSibling : m_first ) = note;
+	m_last = note;
+}
+
+
+
+
+void NotePlayHandle::SubNotes::removeOne( NotePlayHandle * note )
 {
+	if( note->m_siblings != this )
+	{
+		return;
+	}
+
+	( note->m_previousSibling ? note->m_previousSibling->m_nextSibling : m_first ) = note->m_nextSibling;
+	( note->m_nextSibling ? note->m_nextSibling->m_previousSibling : m_last ) = note->m_previousSibling;
+	note->m_siblings = nullptr;
+	note->m_previousSibling = note->m_nextSibling = nullptr;
+}
+
+
+
+
+void NotePlayHandle::SubNotes::clear()
+{
+	for( NotePlayHandle * note = m_first; note; )
+	{
+		NotePlayHandle * next = note->m_nextSibling;
+		note->m_siblings = nullptr;
+		note->m_previousSibling = note->m_nextSibling = nullptr;
+		note = next;
+	}
+	m_first = m_last = nullptr;
 }
 
 
@@ -63,6 +170,9 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_releaseFramesToDo( 0 ),
 	m_releaseFramesDone( 0 ),
 	m_subNotes(),
+	m_siblings( nullptr ),
+	m_previousSibling( nullptr ),
+	m_nextSibling( nullptr ),
 	m_released( false ),
 	m_releaseStarted( false ),
 	m_hasMidiNote( false ),
@@ -75,16 +185,28 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	m_origBaseNote( instrumentTrack->baseNote() ),
 	m_frequency( 0 ),
 	m_unpitchedFrequency( 0 ),
-	m_baseDetuning( nullptr ),
+	m_baseDetuning( &m_ownBaseDetuning ),
+	m_ownBaseDetuning( parent ? nullptr : detuning() ),
+	m_detuning( parent ? parent->m_detuning : detuning() ? detuning()->automationClip()->valueAt( 0 ) : 0 ),
+	m_frequencyBuffer( nullptr ),
 	m_songGlobalParentOffset( 0 ),
 	m_midiChannel( midiEventChannel >= 0 ? midiEventChannel : instrumentTrack->midiPort()->realOutputChannel() ),
 	m_origin( origin ),
-	m_frequencyNeedsUpdate( false )
+	m_frequencyNeedsUpdate( false ),
+	m_batchLead( nullptr ),
+	m_stolen( false ),
+	m_stealFading( false ),
+	m_stealFadeStart( 0 ),
+	m_stealFadeFrames( 0 ),
+	m_envelopeGain( 1.0f ),
+	m_inaudibleFrames( 0 )
 {
+	++m_instrumentTrack->m_voices;
+	++s_voices;
+
 	lock();
 	if( hasParent() == false )
 	{
-		m_baseDetuning = new BaseDetuning( detuning() );
 		m_instrumentTrack->m_processHandles.push_back( this );
 	}
 	else
@@ -122,12 +244,18 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 
 NotePlayHandle::~NotePlayHandle()
 {
+	// whoever marks the note stolen first stops counting it
+	if( !m_stolen.exchange( true ) )
+	{
+		--m_instrumentTrack->m_voices;
+		--s_voices;
+	}
+
 	lock();
 	noteOff( 0 );
 
 	if( hasParent() == false )
 	{
-		delete m_baseDetuning;
 		m_instrumentTrack->m_processHandles.removeAll( this );
 	}
 	else
@@ -183,22 +311,131 @@ int NotePlayHandle::midiKey() const
 
 
 
+void NotePlayHandle::queueForBatch()
+{
+	m_batchLead = nullptr;
+	setRenderedElsewhere( false );
+
+	Instrument* instrument = m_instrumentTrack->instrument();
+	if( instrument == nullptr || !instrument->flags().testFlag( Instrument::Flag::PlaysNotesBatched ) )
+	{
+		return;
+	}
+
+	// skip the notes play() won't let the instrument render
+	if( m_muted || isMasterNote() || !usesBuffer() || isFinished()
+		|| offset() >= Engine::audioEngine()->framesPerPeriod() )
+	{
+		return;
+	}
+	m_batchLead = instrument->queueBatchedNote( this );
+	setRenderedElsewhere( m_batchLead != this );
+}
+
+
+
+
 void NotePlayHandle::play( sampleFrame * _working_buffer )
 {
-	if (m_muted)
+	if( m_batchLead != nullptr )
+	{
+		// the first note of the batch plays all of them
+		if( m_batchLead == this )
+		{
+			playBatch( _working_buffer );
+		}
+		return;
+	}
+
+	if( !startPeriod() )
 	{
 		return;
 	}
 
+	// under some circumstances we're called even if there's nothing to play
+	// therefore do an additional check which fixes crash e.g. when
+	// decreasing release of an instrument-track while the note is active
+	if( framesLeft() > 0 )
+	{
+		// play note!
+		m_instrumentTrack->playNote( this, _working_buffer );
+	}
+
+	finishPeriod();
+}
+
+
+
+
+void NotePlayHandle::playBatch( sampleFrame * _working_buffer )
+{
+	auto started = PeriodAllocator<NotePlayHandle *>::vector();
+	auto playing = PeriodAllocator<NotePlayHandle *>::vector();
+	for( NotePlayHandle * n : m_instrumentTrack->instrument()->noteBatch() )
+	{
+		if( n->startPeriod() )
+		{
+			started.push_back( n );
+			if( n->framesLeft() > 0 )
+			{
+				playing.push_back( n );
+			}
+		}
+	}
+
+	m_instrumentTrack->playNotes( playing.data(), playing.size(), _working_buffer );
+
+	for( NotePlayHandle * n : started )
+	{
+		n->finishPeriod();
+	}
+}
+
+
+
+
+f_cnt_t NotePlayHandle::framesThisPeriod() const
+{
+	return m_totalFramesPlayed == 0
+		? Engine::audioEngine()->framesPerPeriod() - offset()
+		: Engine::audioEngine()->framesPerPeriod();
+}
+
+
+
+
+bool NotePlayHandle::startPeriod()
+{
+	if (m_muted)
+	{
+		return false;
+	}
+
 	// if the note offset falls over to next period, then don't start playback yet
 	if( offset() >= Engine::audioEngine()->framesPerPeriod() )
 	{
 		setOffset( offset() - Engine::audioEngine()->framesPerPeriod() );
-		return;
+		return false;
 	}
 
 	lock();
 
+	if( isStolen() && !m_stealFading )
+	{
+		// a note that didn't start yet simply ends, the others fade out
+		// over 10 ms no matter the envelopes, and their sub-notes with them
+		noteOff( 0 );
+		for( NotePlayHandle * n : m_subNotes )
+		{
+			n->steal();
+		}
+		m_stealFading = true;
+		m_framesBeforeRelease = 0;
+		m_stealFadeStart = m_releaseFramesDone;
+		m_stealFadeFrames = m_totalFramesPlayed == 0 ? 0 : Engine::audioEngine()->processingSampleRate() / 100;
+		m_releaseFramesToDo = m_releaseFramesDone + m_stealFadeFrames;
+	}
+
 	// Don't play the note if it falls outside of the user defined key range
 	// TODO: handle the range check by Microtuner, and if the key becomes "not mapped", save the current frequency
 	// so that the note release can finish playing using a valid frequency instead of a 1 Hz placeholder
@@ -211,7 +448,7 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		if (m_totalFramesPlayed == 0)
 		{
 			unlock();
-			return;
+			return false;
 		}
 	}
 
@@ -238,33 +475,31 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 	{
 		updateFrequency();
 	}
-
-	// number of frames that can be played this period
-	f_cnt_t framesThisPeriod = m_totalFramesPlayed == 0
-		? Engine::audioEngine()->framesPerPeriod() - offset()
-		: Engine::audioEngine()->framesPerPeriod();
+	updateDetuning();
 
 	// check if we start release during this period
 	if( m_released == false &&
 		instrumentTrack()->isSustainPedalPressed() == false &&
-		m_totalFramesPlayed + framesThisPeriod > m_frames )
+		m_totalFramesPlayed + framesThisPeriod() > m_frames )
 	{
 		noteOff( m_totalFramesPlayed == 0
 			? ( m_frames + offset() ) // if we have noteon and noteoff during the same period, take offset in account for release frame
 			: ( m_frames - m_totalFramesPlayed ) ); // otherwise, the offset is already negated and can be ignored
 	}
 
-	// under some circumstances we're called even if there's nothing to play
-	// therefore do an additional check which fixes crash e.g. when
-	// decreasing release of an instrument-track while the note is active
-	if( framesLeft() > 0 )
-	{
-		// play note!
-		m_instrumentTrack->playNote( this, _working_buffer );
-	}
+	return true;
+}
+
+
+
+
+void NotePlayHandle::finishPeriod()
+{
+	// number of frames that can be played this period
+	const f_cnt_t framesThisPeriod = this->framesThisPeriod();
 
 	if( m_released && (!instrumentTrack()->isSustainPedalPressed() ||
-		m_releaseStarted) )
+		m_releaseStarted || m_stealFading) )
 	{
 		m_releaseStarted = true;
 
@@ -328,7 +563,11 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 
 f_cnt_t NotePlayHandle::framesLeft() const
 {
-	if( instrumentTrack()->isSustainPedalPressed() )
+	if( m_stealFading )
+	{
+		return m_releaseFramesToDo - m_releaseFramesDone;
+	}
+	else if( instrumentTrack()->isSustainPedalPressed() )
 	{
 		return 4 * Engine::audioEngine()->framesPerPeriod();
 	}
@@ -366,6 +605,18 @@ bool NotePlayHandle::isFromTrack( const Track * _track ) const
 
 
 
+const void* NotePlayHandle::workerAffinity() const
+{
+	// played by the same worker as the instrument itself
+	const Instrument* instrument = m_instrumentTrack->instrument();
+	return instrument && instrument->flags().testFlag( Instrument::Flag::NeedsFixedThread )
+		? instrument
+		: nullptr;
+}
+
+
+
+
 void NotePlayHandle::noteOff( const f_cnt_t _s )
 {
 	if( m_released )
@@ -453,6 +704,62 @@ void NotePlayHandle::mute()
 
 
 
+bool NotePlayHandle::steal()
+{
+	if( m_stolen.exchange( true ) )
+	{
+		return false;
+	}
+	--m_instrumentTrack->m_voices;
+	--s_voices;
+	++s_stolen;
+	return true;
+}
+
+
+
+
+void NotePlayHandle::applyStealFade( sampleFrame* buf, const fpp_t frames ) const
+{
+	if( !m_stealFading || m_stealFadeFrames == 0 )
+	{
+		return;
+	}
+
+	const f_cnt_t done = m_releaseFramesDone - m_stealFadeStart;
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		const float gain = std::max( 0.0f, 1.0f - static_cast<float>( done + f ) / m_stealFadeFrames );
+		buf[f][0] *= gain;
+		buf[f][1] *= gain;
+	}
+}
+
+
+
+
+void NotePlayHandle::checkAudibility( float peak, const fpp_t frames )
+{
+	// before the release, or while the sustain pedal holds it, a note may
+	// well be quiet for a while, and master notes keep their sub-notes
+	if( !m_releaseStarted || m_stealFading || !m_subNotes.isEmpty() || peak >= InaudibleLevel )
+	{
+		m_inaudibleFrames = 0;
+		return;
+	}
+
+	m_inaudibleFrames += frames;
+	if( m_inaudibleFrames >= InaudibleSeconds * Engine::audioEngine()->processingSampleRate() )
+	{
+		// finishPeriod() then leaves nothing to do
+		m_framesBeforeRelease = 0;
+		m_releaseFramesToDo = m_releaseFramesDone;
+	}
+}
+
+
+
+
 int NotePlayHandle::index() const
 {
 	const PlayHandleList & playHandles = Engine::audioEngine()->playHandles();
@@ -518,10 +825,23 @@ bool NotePlayHandle::operator==( const NotePlayHandle & _nph ) const
 
 
 void NotePlayHandle::updateFrequency()
+{
+	updateOwnFrequency();
+
+	for (auto it : m_subNotes)
+	{
+		it->updateFrequency();
+	}
+}
+
+
+
+
+void NotePlayHandle::updateOwnFrequency()
 {
 	int masterPitch = m_instrumentTrack->m_useMasterPitchModel.value() ? Engine::getSong()->masterPitch() : 0;
 	int baseNote = m_instrumentTrack->baseNoteModel()->value();
-	float detune = m_baseDetuning->value();
+	float detune = m_detuning;
 	float instrumentPitch = m_instrumentTrack->pitchModel()->value();
 
 	if (m_instrumentTrack->m_microtuner.enabled())
@@ -532,8 +852,8 @@ void NotePlayHandle::updateFrequency()
 		if (m_instrumentTrack->isKeyMapped(transposedKey))
 		{
 			const auto frequency = m_instrumentTrack->m_microtuner.keyToFreq(transposedKey, baseNote);
-			m_frequency = frequency * powf(2.f, (detune + instrumentPitch / 100) / 12.f);
-			m_unpitchedFrequency = frequency * powf(2.f, detune / 12.f);
+			m_frequency = frequency * fastExp2f((detune + instrumentPitch / 100) / 12.f);
+			m_unpitchedFrequency = frequency * fastExp2f(detune / 12.f);
 		}
 		else
 		{
@@ -544,35 +864,69 @@ void NotePlayHandle::updateFrequency()
 	{
 		// default key mapping and 12-TET frequency computation with default 440 Hz base note frequency
 		const float pitch = (key() - baseNote + masterPitch + detune) / 12.0f;
-		m_frequency = DefaultBaseFreq * powf(2.0f, pitch + instrumentPitch / (100 * 12.0f));
-		m_unpitchedFrequency = DefaultBaseFreq * powf(2.0f, pitch);
+		m_frequency = DefaultBaseFreq * fastExp2f(pitch + instrumentPitch / (100 * 12.0f));
+		m_unpitchedFrequency = DefaultBaseFreq * fastExp2f(pitch);
 	}
+}
 
-	for (auto it : m_subNotes)
+
+
+
+void NotePlayHandle::updateDetuning()
+{
+	m_frequencyBuffer = nullptr;
+
+	// every note evaluates the automation it shares with its parent on its own,
+	// once per period, as they all may be rendered by different threads
+	const auto time = m_baseDetuning->timeAtPeriodStart();
+	if (!time) { return; }
+
+	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+	const f_cnt_t first = noteOffset();
+	const float timeStep = 1.f / Engine::framesPerTick();
+	// the automation starts with the note
+	const double start = std::max(*time + first * static_cast<double>(timeStep), 0.0);
+
+	auto values = static_cast<float*>(PeriodArena::allocate(sizeof(float) * frames, alignof(float)));
+	const AutomationClip* clip = m_baseDetuning->clip();
+	const bool moving = clip->valuesAt(start, timeStep, values + first, frames - first);
+
+	const float detune = moving ? values[first] : clip->valueAt(start);
+	if (!typeInfo<float>::isEqual(detune, m_detuning))
 	{
-		it->updateFrequency();
+		m_detuning = detune;
+		updateOwnFrequency();
+	}
+
+	if (moving)
+	{
+		// the frequency goes with 2 to the power of the detuning in semitones
+		for (fpp_t frame = first; frame < frames; ++frame)
+		{
+			values[frame] = m_frequency * fastExp2f((values[frame] - detune) / 12.f);
+		}
+		m_frequencyBuffer = values;
 	}
 }
 
 
 
 
-void NotePlayHandle::processTimePos(const TimePos& time, float pitchValue, bool isRecording)
+void NotePlayHandle::processTimePos(const TimePos& time, f_cnt_t offset, float pitchValue, bool isRecording)
 {
-	if (!detuning() || time < songGlobalParentOffset() + pos()) { return; }
+	if (!detuning()) { return; }
 
 	if (isRecording && m_origin == Origin::MidiInput)
 	{
-		detuning()->automationClip()->recordValue(time - songGlobalParentOffset() - pos(), pitchValue / 100);
+		if (time >= songGlobalParentOffset() + pos())
+		{
+			detuning()->automationClip()->recordValue(time - songGlobalParentOffset() - pos(), pitchValue / 100);
+		}
 	}
 	else
 	{
-		const float v = detuning()->automationClip()->valueAt(time - songGlobalParentOffset() - pos());
-		if (!typeInfo<float>::isEqual(v, m_baseDetuning->value()))
-		{
-			m_baseDetuning->setValue(v);
-			updateFrequency();
-		}
+		// the notes evaluate the automation themselves when they're rendered
+		m_baseDetuning->follow(time.getTicks() - songGlobalParentOffset().getTicks() - pos().getTicks(), offset);
 	}
 }
 
@@ -602,28 +956,126 @@ void NotePlayHandle::resize( const bpm_t _new_tempo )
 }
 
 
-NotePlayHandle ** NotePlayHandleManager::s_available;
-QReadWriteLock NotePlayHandleManager::s_mutex;
-std::atomic_int NotePlayHandleManager::s_availableIndex;
-int NotePlayHandleManager::s_size;
+namespace
+{
 
+constexpr std::uint32_t MaxNotePlayHandles = 1 << 15;
+// marks handles allocated on their own because the pool was full
+constexpr std::uint32_t Unpooled = 0xffffffff;
 
-void NotePlayHandleManager::init()
+//! The handle comes first, so a handle's address is its slot's too
+struct NotePlayHandleSlot
+{
+	alignas(NotePlayHandle) unsigned char handle[sizeof(NotePlayHandle)];
+	std::uint32_t index = Unpooled;
+	//! Whether the handle is constructed, so notes can be stolen from it
+	std::atomic_bool playing{false};
+};
+
+std::unique_ptr<NotePlayHandleSlot*[]> s_slots;
+std::unique_ptr<LocklessIndexStack> s_available;
+std::atomic_int s_size{0};
+std::atomic_int s_peakInUse{0};
+std::atomic_int s_audioThreadGrowths{0};
+std::atomic_int s_highWaterMark{INITIAL_NPH_CACHE};
+std::atomic_bool s_refillRequested{false};
+//! Free handles wanted for the notes about to start, beyond the high-water mark
+std::atomic_int s_expected{0};
+QMutex s_extendMutex;
+
+
+class NotePlayHandleRefiller : public QThread
+{
+public:
+	void quit() { m_quit = true; }
+
+private:
+	void run() override
+	{
+		while (!m_quit)
+		{
+			if (s_refillRequested.exchange(false, std::memory_order_relaxed))
+			{
+				const int target = std::max(s_highWaterMark.load(), s_expected.exchange(0));
+				while (s_available->size() < target && s_size < static_cast<int>(MaxNotePlayHandles))
+				{
+					NotePlayHandleManager::extend(NPH_CACHE_INCREMENT);
+				}
+			}
+			msleep(20);
+		}
+	}
+
+	std::atomic_bool m_quit{false};
+};
+
+std::unique_ptr<NotePlayHandleRefiller> s_refiller;
+
+
+//! Whether @p candidate should be stolen rather than @p victim, for a new note of @p key
+bool isBetterVictim( const NotePlayHandle* candidate, const NotePlayHandle* victim,
+	InstrumentTrack::VoiceStealing policy, int key )
 {
-	s_available = MM_ALLOC<NotePlayHandle*>( INITIAL_NPH_CACHE );
+	using VoiceStealing = InstrumentTrack::VoiceStealing;
 
-	auto n = MM_ALLOC<NotePlayHandle>(INITIAL_NPH_CACHE);
+	// the notes that are released already are the least missed
+	if (candidate->isReleased() != victim->isReleased()) { return candidate->isReleased(); }
 
-	for( int i=0; i < INITIAL_NPH_CACHE; ++i )
+	switch (policy)
 	{
-		s_available[ i ] = n;
-		++n;
+	case VoiceStealing::Quietest:
+		if (candidate->getVolume() != victim->getVolume()) { return candidate->getVolume() < victim->getVolume(); }
+		break;
+	case VoiceStealing::SameKey:
+		if ((candidate->key() == key) != (victim->key() == key)) { return candidate->key() == key; }
+		break;
+	case VoiceStealing::Oldest:
+		break;
 	}
-	s_availableIndex = INITIAL_NPH_CACHE - 1;
-	s_size = INITIAL_NPH_CACHE;
+	return candidate->totalFramesPlayed() > victim->totalFramesPlayed();
+}
+
+
+//! Steals the note of @p track, or of any track if it's null, that @p policy picks. The
+//! handles may be playing on other threads meanwhile, which only complicates reading
+//! when they started: stealing one only marks it.
+void stealVoice( const InstrumentTrack* track, InstrumentTrack::VoiceStealing policy, int key,
+	const NotePlayHandle* parent )
+{
+	NotePlayHandle* victim = nullptr;
+	const int size = s_size.load(std::memory_order_acquire);
+	for (int i = 0; i < size; ++i)
+	{
+		NotePlayHandleSlot* slot = s_slots[i];
+		if (!slot->playing.load(std::memory_order_acquire)) { continue; }
+
+		auto nph = reinterpret_cast<NotePlayHandle*>(slot->handle);
+		// never the note the new one belongs to
+		if (nph->isStolen() || nph == parent || (track && nph->instrumentTrack() != track)) { continue; }
+		if (!victim || isBetterVictim(nph, victim, policy, key)) { victim = nph; }
+	}
+
+	if (victim) { victim->steal(); }
+}
+
+} // namespace
+
+
+
+
+void NotePlayHandleManager::init()
+{
+	s_slots = std::make_unique<NotePlayHandleSlot*[]>(MaxNotePlayHandles);
+	s_available = std::make_unique<LocklessIndexStack>(MaxNotePlayHandles);
+	extend(INITIAL_NPH_CACHE);
+
+	s_refiller = std::make_unique<NotePlayHandleRefiller>();
+	s_refiller->start(QThread::LowPriority);
 }
 
 
+
+
 NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrack,
 				const f_cnt_t offset,
 				const f_cnt_t frames,
@@ -632,45 +1084,133 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 				int midiEventChannel,
 				NotePlayHandle::Origin origin )
 {
-	// TODO: use some lockless data structures
-	s_mutex.lockForWrite();
-	if (s_availableIndex < 0) { extend(NPH_CACHE_INCREMENT); }
-	NotePlayHandle * nph = s_available[s_availableIndex--];
-	s_mutex.unlock();
+	// make room for the note, what's stolen fades out from the next period on. A
+	// handle over the limit now and then when notes start at once on several
+	// threads only waits until the next note starts.
+	const int polyphony = instrumentTrack->polyphony();
+	if (polyphony > 0 && instrumentTrack->voices() >= polyphony)
+	{
+		stealVoice(instrumentTrack, instrumentTrack->voiceStealing(), noteToPlay.key(), parent);
+	}
+	const int voiceLimit = s_voiceLimit.load(std::memory_order_relaxed);
+	if (voiceLimit > 0 && s_voices.load(std::memory_order_relaxed) >= voiceLimit)
+	{
+		stealVoice(nullptr, InstrumentTrack::VoiceStealing::Oldest, noteToPlay.key(), parent);
+	}
 
-	new( (void*)nph ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
+	std::uint32_t index = s_available->pop();
+	if (index == LocklessIndexStack::Empty)
+	{
+		// the refiller couldn't keep up, better grow here than drop the note
+		++s_audioThreadGrowths;
+		extend(NPH_CACHE_INCREMENT);
+		index = s_available->pop();
+	}
+
+	NotePlayHandleSlot* slot = index != LocklessIndexStack::Empty ? s_slots[index] : new NotePlayHandleSlot;
+
+	const int available = s_available->size();
+	if (available < s_highWaterMark.load(std::memory_order_relaxed) / 2)
+	{
+		s_refillRequested.store(true, std::memory_order_relaxed);
+	}
+
+	const int inUse = s_size.load(std::memory_order_relaxed) - available;
+	int peak = s_peakInUse.load(std::memory_order_relaxed);
+	while (inUse > peak && !s_peakInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {}
+
+	auto nph = new( slot->handle ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
+	slot->playing.store(true, std::memory_order_release);
 	return nph;
 }
 
 
+
+
 void NotePlayHandleManager::release( NotePlayHandle * nph )
 {
+	auto slot = reinterpret_cast<NotePlayHandleSlot*>(nph);
+	slot->playing.store(false, std::memory_order_release);
 	nph->NotePlayHandle::~NotePlayHandle();
-	s_mutex.lockForRead();
-	s_available[++s_availableIndex] = nph;
-	s_mutex.unlock();
+
+	if (slot->index == Unpooled)
+	{
+		delete slot;
+		return;
+	}
+	s_available->push(slot->index);
 }
 
 
+
+
 void NotePlayHandleManager::extend( int c )
 {
-	s_size += c;
-	auto tmp = MM_ALLOC<NotePlayHandle*>(s_size);
-	MM_FREE( s_available );
-	s_available = tmp;
+	QMutexLocker lock(&s_extendMutex);
+
+	const int first = s_size;
+	c = std::min(c, static_cast<int>(MaxNotePlayHandles) - first);
+	if (c <= 0) { return; }
+
+	auto slots = new NotePlayHandleSlot[c];
+	for (int i = 0; i < c; ++i)
+	{
+		slots[i].index = first + i;
+		s_slots[first + i] = &slots[i];
+		// pushing publishes the slot to the threads taking it
+		s_available->push(first + i);
+	}
+	s_size = first + c;
+}
+
+
+
+
+void NotePlayHandleManager::setHighWaterMark( int handles )
+{
+	s_highWaterMark = std::clamp(handles, NPH_CACHE_INCREMENT, static_cast<int>(MaxNotePlayHandles));
+	s_refillRequested = true;
+}
+
 
-	auto n = MM_ALLOC<NotePlayHandle>(c);
 
-	for( int i=0; i < c; ++i )
+
+void NotePlayHandleManager::expect( int handles )
+{
+	if( s_available && s_available->size() < handles )
 	{
-		s_available[++s_availableIndex] = n;
-		++n;
+		s_expected.store( std::min( handles, static_cast<int>( MaxNotePlayHandles ) ), std::memory_order_relaxed );
+		s_refillRequested.store( true, std::memory_order_relaxed );
 	}
 }
 
+
+
+
+NotePlayHandleManager::Statistics NotePlayHandleManager::statistics()
+{
+	return { s_size, s_available ? s_available->size() : 0, s_peakInUse, s_audioThreadGrowths, s_stolen };
+}
+
+
+
+
+void NotePlayHandleManager::setVoiceLimit( int voices )
+{
+	s_voiceLimit = std::max(voices, 0);
+}
+
+
+
+
 void NotePlayHandleManager::free()
 {
-	MM_FREE(s_available);
+	if (s_refiller)
+	{
+		s_refiller->quit();
+		s_refiller->wait();
+		s_refiller.reset();
+	}
 }
 
 
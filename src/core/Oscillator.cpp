@@ -26,30 +26,130 @@
 #include "Oscillator.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #if !defined(__MINGW32__) && !defined(__MINGW64__)
 	#include <thread>
 #endif
 
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+
 #include "BufferManager.h"
 #include "Engine.h"
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
+#include "PathUtil.h"
 #include "fftw3.h"
 #include "fft_helpers.h"
+#include "lmmsversion.h"
 
 
 namespace lmms
 {
 
+namespace
+{
+
+// bump this whenever the generated tables change
+constexpr int WaveTableCacheVersion = 1;
+
+struct WaveTableCacheHeader
+{
+	char magic[8];
+	std::uint64_t key;
+};
+
+constexpr char WaveTableCacheMagic[8] = {'L', 'M', 'M', 'S', 'W', 'T', 'B', 'L'};
+
+// identifies the layout and the code the cached tables were made with, a
+// cache with any other key gets regenerated
+std::uint64_t waveTableCacheKey()
+{
+	const QByteArray key = QString("%1/%2/%3/%4/%5/%6/%7")
+		.arg(LMMS_VERSION)
+		.arg(WaveTableCacheVersion)
+		.arg(Oscillator::NumWaveShapes)
+		.arg(OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT)
+		.arg(OscillatorConstants::WAVETABLE_LENGTH)
+		.arg(OscillatorConstants::MAX_FREQ)
+		.arg(sizeof(sample_t)).toUtf8();
+
+	// FNV-1a
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const char c : key)
+	{
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+	}
+	return hash;
+}
+
+// stays open while its tables are in use
+QFile s_waveTableCacheFile;
+
+// s_fftPlan, s_ifftPlan and the buffers they work on are shared
+std::mutex s_fftMutex;
+
+std::array<std::once_flag, Oscillator::NumWaveShapeTables> s_waveTableOnce;
+
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+std::thread s_waveTableThread;
+#endif
+
+//! The user wave tables in use, by a hash of the frames they are made from
+std::mutex s_userWaveTablesMutex;
+std::unordered_map<std::size_t, std::weak_ptr<UserWaveTable>> s_userWaveTables;
+
+auto userWaveTablePool() -> QThreadPool&
+{
+	static QThreadPool pool;
+	return pool;
+}
+
+} // namespace
+
+
+
 
 void Oscillator::waveTableInit()
 {
 	createFFTPlans();
-	generateWaveTables();
 	// The oscillator FFT plans remain throughout the application lifecycle
 	// due to being expensive to create, and being used whenever a userwave form is changed
-	// deleted in main.cpp main()
+	// deleted in Engine::destroy()
+
+	if (loadWaveTableCache())
+	{
+		return;
+	}
+
+	s_waveTables = s_generatedWaveTables;
+
+	// Generating all tables takes a while, so let it happen in the background.
+	// A table needed earlier is generated right away, see requireWaveTable().
+	const auto generateAll = []
+	{
+		for (std::size_t table = 0; table < NumWaveShapeTables; ++table)
+		{
+			requireWaveTable(table);
+		}
+		saveWaveTableCache();
+	};
 
+// TODO: Mingw compilers currently do not support std::thread. There are some 3rd-party workarounds available,
+// but since threading is not essential in this case, it is easier and more reliable to simply generate
+// the wavetables serially. Remove the the check and #else branch once std::thread is well supported.
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	s_waveTableThread = std::thread(generateAll);
+#else
+	generateAll();
+#endif
 }
 
 Oscillator::Oscillator(const IntModel *wave_shape_model,
@@ -70,6 +170,7 @@ Oscillator::Oscillator(const IntModel *wave_shape_model,
 	m_phase(phase_offset),
 	m_userWave(nullptr),
 	m_useWaveTable(false),
+	m_usePolyBlep(false),
 	m_isModulator(false)
 {
 }
@@ -88,6 +189,14 @@ void Oscillator::update(sampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl
 	// The sampling functions will check this variable and avoid using band-limited
 	// wavetables, since they contain ringing that would lead to unexpected results.
 	m_isModulator = modulator;
+	if (m_useWaveTable && !modulator)
+	{
+		const auto shape = static_cast<std::size_t>(m_waveShapeModel->value());
+		if (shape >= FirstWaveShapeTable && shape < FirstWaveShapeTable + NumWaveShapeTables)
+		{
+			requireWaveTable(shape - FirstWaveShapeTable);
+		}
+	}
 	if (m_subOsc != nullptr)
 	{
 		switch (static_cast<ModulationAlgo>(m_modulationAlgoModel->value()))
@@ -177,36 +286,83 @@ void Oscillator::generateFromFFT(int bands, sample_t* table)
 		s_specBuf[i][1] = 0.0f;
 	}
 	//ifft
-	fftwf_execute(s_ifftPlan);
+	fftwf_execute_dft_c2r(s_ifftPlan, s_specBuf, s_sampleBuffer.data());
 	//normalize and copy to result buffer
 	normalize(s_sampleBuffer.data(), table, OscillatorConstants::WAVETABLE_LENGTH, 2*OscillatorConstants::WAVETABLE_LENGTH + 1);
 }
 
-std::unique_ptr<OscillatorConstants::waveform_t> Oscillator::generateAntiAliasUserWaveTable(const SampleBuffer* sampleBuffer)
+class Oscillator::UserWaveTableTask : public QRunnable
+{
+public:
+	UserWaveTableTask(std::shared_ptr<UserWaveTable> waveTable)
+		: m_waveTable(std::move(waveTable))
+	{
+	}
+
+	void run() override
+	{
+		generateUserWaveTable(*m_waveTable);
+	}
+
+private:
+	std::shared_ptr<UserWaveTable> m_waveTable;
+};
+
+void Oscillator::generateUserWaveTable(UserWaveTable& waveTable)
 {
-	auto userAntiAliasWaveTable = std::make_unique<OscillatorConstants::waveform_t>();
+	const auto guard = std::lock_guard{s_fftMutex};
 	for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 	{
-		// TODO: This loop seems to be doing the same thing for each iteration of the outer loop,
-		// and could probably be moved out of it
+		// generateFromFFT() leaves its result in s_sampleBuffer, so the wave
+		// has to be sampled again for every band
 		for (int j = 0; j < OscillatorConstants::WAVETABLE_LENGTH; ++j)
 		{
 			s_sampleBuffer[j] = Oscillator::userWaveSample(
-				sampleBuffer, static_cast<float>(j) / OscillatorConstants::WAVETABLE_LENGTH);
+				waveTable.m_wave.get(), static_cast<float>(j) / OscillatorConstants::WAVETABLE_LENGTH);
 		}
-		fftwf_execute(s_fftPlan);
-		Oscillator::generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), (*userAntiAliasWaveTable)[i].data());
+		fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer.data(), s_specBuf);
+		Oscillator::generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), waveTable.m_tables[i].data());
 	}
-
-	return userAntiAliasWaveTable;
+	waveTable.m_ready.store(true, std::memory_order_release);
 }
 
+auto Oscillator::userWaveTable(std::shared_ptr<const SampleBuffer> wave) -> std::shared_ptr<const UserWaveTable>
+{
+	if (!wave) { return nullptr; }
+
+	const auto frames = std::string_view{reinterpret_cast<const char*>(wave->data()), wave->size() * sizeof(sampleFrame)};
+	const auto key = std::hash<std::string_view>{}(frames);
+
+	const auto lock = std::lock_guard{s_userWaveTablesMutex};
+	if (const auto it = s_userWaveTables.find(key); it != s_userWaveTables.end())
+	{
+		// undo, presets and other instances often bring back a wave that is in use
+		// already, though not always in the same buffer
+		auto waveTable = it->second.lock();
+		if (waveTable && (waveTable->m_wave == wave
+			|| std::equal(wave->begin(), wave->end(), waveTable->m_wave->begin(), waveTable->m_wave->end())))
+		{
+			return waveTable;
+		}
+	}
+
+	for (auto it = s_userWaveTables.begin(); it != s_userWaveTables.end();)
+	{
+		it = it->second.expired() ? s_userWaveTables.erase(it) : std::next(it);
+	}
 
+	auto waveTable = std::make_shared<UserWaveTable>();
+	waveTable->m_wave = std::move(wave);
+	s_userWaveTables[key] = waveTable;
+	userWaveTablePool().start(new UserWaveTableTask(waveTable));
+	return waveTable;
+}
 
-sample_t Oscillator::s_waveTables
-	[Oscillator::NumWaveShapeTables]
-	[OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT]
-	[OscillatorConstants::WAVETABLE_LENGTH];
+
+Oscillator::WaveTables Oscillator::s_generatedWaveTables;
+const sample_t ( *Oscillator::s_waveTables )[OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT][OscillatorConstants::WAVETABLE_LENGTH]
+	= Oscillator::s_generatedWaveTables;
+std::array<std::atomic_bool, Oscillator::NumWaveShapeTables> Oscillator::s_waveTableReady{};
 fftwf_plan Oscillator::s_fftPlan;
 fftwf_plan Oscillator::s_ifftPlan;
 fftwf_complex * Oscillator::s_specBuf;
@@ -217,8 +373,8 @@ std::array<float, OscillatorConstants::WAVETABLE_LENGTH> Oscillator::s_sampleBuf
 void Oscillator::createFFTPlans()
 {
 	Oscillator::s_specBuf = ( fftwf_complex * ) fftwf_malloc( ( OscillatorConstants::WAVETABLE_LENGTH * 2 + 1 ) * sizeof( fftwf_complex ) );
-	Oscillator::s_fftPlan = fftwf_plan_dft_r2c_1d(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer.data(), s_specBuf, FFTW_MEASURE );
-	Oscillator::s_ifftPlan = fftwf_plan_dft_c2r_1d(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer.data(), FFTW_MEASURE);
+	Oscillator::s_fftPlan = realToComplexPlan(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer.data(), s_specBuf);
+	Oscillator::s_ifftPlan = complexToRealPlan(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer.data());
 	// initialize s_specBuf content to zero, since the values are used in a condition inside generateFromFFT()
 	for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH * 2 + 1; i++)
 	{
@@ -229,158 +385,174 @@ void Oscillator::createFFTPlans()
 
 void Oscillator::destroyFFTPlans()
 {
-	fftwf_destroy_plan(s_fftPlan);
-	fftwf_destroy_plan(s_ifftPlan);
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	if (s_waveTableThread.joinable())
+	{
+		s_waveTableThread.join();
+	}
+#endif
+	userWaveTablePool().clear();
+	userWaveTablePool().waitForDone();
+	// the plans are shared, see destroySharedFFTPlans()
 	fftwf_free(s_specBuf);
 }
 
-void Oscillator::generateWaveTables()
+void Oscillator::generateWaveTable(std::size_t table)
 {
 	// Generate tables for simple shaped (constructed by summing sine waves).
 	// Start from the table that contains the least number of bands, and re-use each table in the following
 	// iteration, adding more bands in each step and avoiding repeated computation of earlier bands.
 	using generator_t = void (*)(int, sample_t*, int);
-	auto simpleGen = [](WaveShape shape, generator_t generator)
+	auto simpleGen = [](std::size_t shapeID, generator_t generator)
 	{
-		const int shapeID = static_cast<std::size_t>(shape) - FirstWaveShapeTable;
 		int lastBands = 0;
 
 		// Clear the first wave table
 		std::fill(
-		    std::begin(s_waveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
-		    std::end(s_waveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
+		    std::begin(s_generatedWaveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
+		    std::end(s_generatedWaveTables[shapeID][OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1]),
 		    0.f);
 
 		for (int i = OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT - 1; i >= 0; i--)
 		{
 			const int bands = OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i);
-			generator(bands, s_waveTables[shapeID][i], lastBands + 1);
+			generator(bands, s_generatedWaveTables[shapeID][i], lastBands + 1);
 			lastBands = bands;
 			if (i)
 			{
 				std::copy(
-					s_waveTables[shapeID][i],
-					s_waveTables[shapeID][i] + OscillatorConstants::WAVETABLE_LENGTH,
-					s_waveTables[shapeID][i - 1]);
+					s_generatedWaveTables[shapeID][i],
+					s_generatedWaveTables[shapeID][i] + OscillatorConstants::WAVETABLE_LENGTH,
+					s_generatedWaveTables[shapeID][i - 1]);
 			}
 		}
 	};
 
 	// FFT-based wave shapes: make standard wave table without band limit, convert to frequency domain, remove bands
 	// above maximum frequency and convert back to time domain.
-	auto fftGen = []()
+	using sampler_t = sample_t (*)(const float);
+	auto fftGen = [](std::size_t shapeID, sampler_t sampler)
 	{
-		// Generate moogSaw tables
+		const auto guard = std::lock_guard{s_fftMutex};
 		for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 		{
 			for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH; ++i)
 			{
-				Oscillator::s_sampleBuffer[i] = moogSawSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
+				s_sampleBuffer[i] = sampler((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
-			fftwf_execute(s_fftPlan);
-			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable][i]);
+			fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer.data(), s_specBuf);
+			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_generatedWaveTables[shapeID][i]);
 		}
+	};
 
-		// Generate exponential tables
-		for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
+	std::call_once(s_waveTableOnce[table], [&]
+	{
+		switch (static_cast<WaveShape>(table + FirstWaveShapeTable))
 		{
-			for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH; ++i)
-			{
-				s_sampleBuffer[i] = expSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
-			}
-			fftwf_execute(s_fftPlan);
-			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable][i]);
+			case WaveShape::Triangle: simpleGen(table, generateTriangleWaveTable); break;
+			case WaveShape::Saw: simpleGen(table, generateSawWaveTable); break;
+			case WaveShape::Square: simpleGen(table, generateSquareWaveTable); break;
+			case WaveShape::MoogSaw: fftGen(table, moogSawSample); break;
+			case WaveShape::Exponential: fftGen(table, expSample); break;
+			default: break;
 		}
-	};
+		s_waveTableReady[table].store(true, std::memory_order_release);
+	});
+}
 
-// TODO: Mingw compilers currently do not support std::thread. There are some 3rd-party workarounds available,
-// but since threading is not essential in this case, it is easier and more reliable to simply generate
-// the wavetables serially. Remove the the check and #else branch once std::thread is well supported.
-#if !defined(__MINGW32__) && !defined(__MINGW64__)
-	std::thread sawThread(simpleGen, WaveShape::Saw, generateSawWaveTable);
-	std::thread squareThread(simpleGen, WaveShape::Square, generateSquareWaveTable);
-	std::thread triangleThread(simpleGen, WaveShape::Triangle, generateTriangleWaveTable);
-	std::thread fftThread(fftGen);
-	sawThread.join();
-	squareThread.join();
-	triangleThread.join();
-	fftThread.join();
-#else
-	simpleGen(WaveShape::Saw, generateSawWaveTable);
-	simpleGen(WaveShape::Square, generateSquareWaveTable);
-	simpleGen(WaveShape::Triangle, generateTriangleWaveTable);
-	fftGen();
-#endif
+bool Oscillator::loadWaveTableCache()
+{
+	s_waveTableCacheFile.setFileName(PathUtil::cacheDir() + "/oscillator-wavetables.bin");
+	if (!s_waveTableCacheFile.open(QIODevice::ReadOnly)) { return false; }
+
+	const auto size = static_cast<qint64>(sizeof(WaveTableCacheHeader) + sizeof(WaveTables));
+	const uchar* data = s_waveTableCacheFile.size() == size ? s_waveTableCacheFile.map(0, size) : nullptr;
+	const auto header = reinterpret_cast<const WaveTableCacheHeader*>(data);
+	if (!header || !std::equal(std::begin(header->magic), std::end(header->magic), WaveTableCacheMagic)
+		|| header->key != waveTableCacheKey())
+	{
+		s_waveTableCacheFile.close();
+		return false;
+	}
+
+	s_waveTables = reinterpret_cast<const WaveTables*>(data + sizeof(WaveTableCacheHeader))[0];
+	for (auto& ready : s_waveTableReady)
+	{
+		ready.store(true, std::memory_order_release);
+	}
+	return true;
 }
 
+void Oscillator::saveWaveTableCache()
+{
+	if (!QDir().mkpath(PathUtil::cacheDir())) { return; }
 
+	// written to a temporary file first, so other instances starting at the
+	// same time never see half of it
+	QSaveFile file(PathUtil::cacheDir() + "/oscillator-wavetables.bin");
+	if (!file.open(QIODevice::WriteOnly)) { return; }
 
+	WaveTableCacheHeader header{};
+	std::copy(std::begin(WaveTableCacheMagic), std::end(WaveTableCacheMagic), header.magic);
+	header.key = waveTableCacheKey();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(s_generatedWaveTables), sizeof(s_generatedWaveTables));
+	file.commit();
+}
 
-void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
-							const ch_cnt_t _chnl )
+
+
+
+auto Oscillator::sampling(WaveShape shape) const -> Sampling
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
+	switch (shape)
 	{
 		case WaveShape::Sine:
-		default:
-			updateNoSub<WaveShape::Sine>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Triangle:
-			updateNoSub<WaveShape::Triangle>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Saw:
-			updateNoSub<WaveShape::Saw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Square:
-			updateNoSub<WaveShape::Square>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::MoogSaw:
-			updateNoSub<WaveShape::MoogSaw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Exponential:
-			updateNoSub<WaveShape::Exponential>( _ab, _frames, _chnl );
-			break;
+		{
+			// there's nothing left of a band-limited sine above the highest frequency
+			const float currentFreq = m_freq * m_detuning_div_samplerate
+				* Engine::audioEngine()->processingSampleRate();
+			return !m_useWaveTable || currentFreq < OscillatorConstants::MAX_FREQ
+				? Sampling::Direct
+				: Sampling::WaveTable;
+		}
 		case WaveShape::WhiteNoise:
-			updateNoSub<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
-			break;
+			return Sampling::Direct;
 		case WaveShape::UserDefined:
-			updateNoSub<WaveShape::UserDefined>( _ab, _frames, _chnl );
-			break;
+			return m_useWaveTable && m_userAntiAliasWaveTable && m_userAntiAliasWaveTable->tables() && !m_isModulator
+				? Sampling::WaveTable
+				: Sampling::Direct;
+		default:
+			if (m_usePolyBlep && !m_isModulator) { return Sampling::PolyBlep; }
+			return m_useWaveTable && !m_isModulator ? Sampling::WaveTable : Sampling::Direct;
 	}
 }
 
 
 
 
-void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
-							const ch_cnt_t _chnl )
+template<Oscillator::WaveShape W, typename F>
+void Oscillator::dispatch(F&& update)
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
+	using DirectSampling = std::integral_constant<Sampling, Sampling::Direct>;
+	using WaveTableSampling = std::integral_constant<Sampling, Sampling::WaveTable>;
+	using PolyBlepSampling = std::integral_constant<Sampling, Sampling::PolyBlep>;
+	constexpr auto shape = std::integral_constant<WaveShape, W>{};
+
+	// only instantiate the loops a shape can actually take
+	switch (sampling(W))
 	{
-		case WaveShape::Sine:
-		default:
-			updatePM<WaveShape::Sine>( _ab, _frames, _chnl );
+		case Sampling::Direct:
+			update(shape, DirectSampling{});
 			break;
-		case WaveShape::Triangle:
-			updatePM<WaveShape::Triangle>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Saw:
-			updatePM<WaveShape::Saw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Square:
-			updatePM<WaveShape::Square>( _ab, _frames, _chnl );
+		case Sampling::WaveTable:
+			if constexpr (W != WaveShape::WhiteNoise) { update(shape, WaveTableSampling{}); }
 			break;
-		case WaveShape::MoogSaw:
-			updatePM<WaveShape::MoogSaw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Exponential:
-			updatePM<WaveShape::Exponential>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::WhiteNoise:
-			updatePM<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::UserDefined:
-			updatePM<WaveShape::UserDefined>( _ab, _frames, _chnl );
+		case Sampling::PolyBlep:
+			if constexpr (W != WaveShape::Sine && W != WaveShape::WhiteNoise && W != WaveShape::UserDefined)
+			{
+				update(shape, PolyBlepSampling{});
+			}
 			break;
 	}
 }
@@ -388,35 +560,37 @@ void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 
 
 
-void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
-							const ch_cnt_t _chnl )
+// calls update with the wave shape and how to sample it as compile-time
+// constants, so the loops don't have to look at them for every sample
+template<typename F>
+void Oscillator::dispatch(F&& update)
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
+	switch (static_cast<WaveShape>(m_waveShapeModel->value()))
 	{
 		case WaveShape::Sine:
 		default:
-			updateAM<WaveShape::Sine>( _ab, _frames, _chnl );
+			dispatch<WaveShape::Sine>(update);
 			break;
 		case WaveShape::Triangle:
-			updateAM<WaveShape::Triangle>( _ab, _frames, _chnl );
+			dispatch<WaveShape::Triangle>(update);
 			break;
 		case WaveShape::Saw:
-			updateAM<WaveShape::Saw>( _ab, _frames, _chnl );
+			dispatch<WaveShape::Saw>(update);
 			break;
 		case WaveShape::Square:
-			updateAM<WaveShape::Square>( _ab, _frames, _chnl );
+			dispatch<WaveShape::Square>(update);
 			break;
 		case WaveShape::MoogSaw:
-			updateAM<WaveShape::MoogSaw>( _ab, _frames, _chnl );
+			dispatch<WaveShape::MoogSaw>(update);
 			break;
 		case WaveShape::Exponential:
-			updateAM<WaveShape::Exponential>( _ab, _frames, _chnl );
+			dispatch<WaveShape::Exponential>(update);
 			break;
 		case WaveShape::WhiteNoise:
-			updateAM<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
+			dispatch<WaveShape::WhiteNoise>(update);
 			break;
 		case WaveShape::UserDefined:
-			updateAM<WaveShape::UserDefined>( _ab, _frames, _chnl );
+			dispatch<WaveShape::UserDefined>(update);
 			break;
 	}
 }
@@ -424,124 +598,67 @@ void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 
 
 
-void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
+void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
-	{
-		case WaveShape::Sine:
-		default:
-			updateMix<WaveShape::Sine>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Triangle:
-			updateMix<WaveShape::Triangle>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Saw:
-			updateMix<WaveShape::Saw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Square:
-			updateMix<WaveShape::Square>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::MoogSaw:
-			updateMix<WaveShape::MoogSaw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Exponential:
-			updateMix<WaveShape::Exponential>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::WhiteNoise:
-			updateMix<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::UserDefined:
-			updateMix<WaveShape::UserDefined>( _ab, _frames, _chnl );
-			break;
-	}
+	dispatch([&](auto shape, auto sampling) {
+		updateNoSub<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
 }
 
 
 
 
-void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
+void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
-	{
-		case WaveShape::Sine:
-		default:
-			updateSync<WaveShape::Sine>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Triangle:
-			updateSync<WaveShape::Triangle>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Saw:
-			updateSync<WaveShape::Saw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Square:
-			updateSync<WaveShape::Square>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::MoogSaw:
-			updateSync<WaveShape::MoogSaw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Exponential:
-			updateSync<WaveShape::Exponential>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::WhiteNoise:
-			updateSync<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::UserDefined:
-			updateSync<WaveShape::UserDefined>( _ab, _frames, _chnl );
-			break;
-	}
+	dispatch([&](auto shape, auto sampling) {
+		updatePM<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
 }
 
 
 
 
-void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
+void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
-	switch( static_cast<WaveShape>(m_waveShapeModel->value()) )
-	{
-		case WaveShape::Sine:
-		default:
-			updateFM<WaveShape::Sine>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Triangle:
-			updateFM<WaveShape::Triangle>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Saw:
-			updateFM<WaveShape::Saw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Square:
-			updateFM<WaveShape::Square>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::MoogSaw:
-			updateFM<WaveShape::MoogSaw>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::Exponential:
-			updateFM<WaveShape::Exponential>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::WhiteNoise:
-			updateFM<WaveShape::WhiteNoise>( _ab, _frames, _chnl );
-			break;
-		case WaveShape::UserDefined:
-			updateFM<WaveShape::UserDefined>( _ab, _frames, _chnl );
-			break;
-	}
+	dispatch([&](auto shape, auto sampling) {
+		updateAM<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
 }
 
 
 
 
-// should be called every time phase-offset is changed...
-inline void Oscillator::recalcPhase()
+void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
+							const ch_cnt_t _chnl )
 {
-	if( !typeInfo<float>::isEqual( m_phaseOffset, m_ext_phaseOffset ) )
-	{
-		m_phase -= m_phaseOffset;
-		m_phaseOffset = m_ext_phaseOffset;
-		m_phase += m_phaseOffset;
-	}
-	m_phase = absFraction( m_phase );
+	dispatch([&](auto shape, auto sampling) {
+		updateMix<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
+}
+
+
+
+
+void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
+							const ch_cnt_t _chnl )
+{
+	dispatch([&](auto shape, auto sampling) {
+		updateSync<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
+}
+
+
+
+
+void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
+							const ch_cnt_t _chnl )
+{
+	dispatch([&](auto shape, auto sampling) {
+		updateFM<decltype(shape)::value, decltype(sampling)::value>(_ab, _frames, _chnl);
+	});
 }
 
 
@@ -573,7 +690,7 @@ float Oscillator::syncInit( sampleFrame * _ab, const fpp_t _frames,
 
 
 // if we have no sub-osc, we can't do any modulation... just get our samples
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -582,7 +699,7 @@ void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 
 	for( fpp_t frame = 0; frame < _frames; ++frame )
 	{
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
+		_ab[frame][_chnl] = getSample<W, S>( m_phase ) * m_volume;
 		m_phase += osc_coeff;
 	}
 }
@@ -591,7 +708,7 @@ void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 
 
 // do pm by using sub-osc as modulator
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -601,7 +718,7 @@ void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 
 	for( fpp_t frame = 0; frame < _frames; ++frame )
 	{
-		_ab[frame][_chnl] = getSample<W>( m_phase +
+		_ab[frame][_chnl] = getSample<W, S>( m_phase +
 					_ab[frame][_chnl] )
 							* m_volume;
 		m_phase += osc_coeff;
@@ -612,7 +729,7 @@ void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 
 
 // do am by using sub-osc as modulator
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -622,7 +739,7 @@ void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 
 	for( fpp_t frame = 0; frame < _frames; ++frame )
 	{
-		_ab[frame][_chnl] *= getSample<W>( m_phase ) * m_volume;
+		_ab[frame][_chnl] *= getSample<W, S>( m_phase ) * m_volume;
 		m_phase += osc_coeff;
 	}
 }
@@ -631,7 +748,7 @@ void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 
 
 // do mix by using sub-osc as mix-sample
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -641,7 +758,7 @@ void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
 
 	for( fpp_t frame = 0; frame < _frames; ++frame )
 	{
-		_ab[frame][_chnl] += getSample<W>( m_phase ) * m_volume;
+		_ab[frame][_chnl] += getSample<W, S>( m_phase ) * m_volume;
 		m_phase += osc_coeff;
 	}
 }
@@ -651,7 +768,7 @@ void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
 
 // sync with sub-osc (every time sub-osc starts new period, we also start new
 // period)
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -665,7 +782,7 @@ void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
 		{
 			m_phase = m_phaseOffset;
 		}
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
+		_ab[frame][_chnl] = getSample<W, S>( m_phase ) * m_volume;
 		m_phase += osc_coeff;
 	}
 }
@@ -674,7 +791,7 @@ void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
 
 
 // do fm by using sub-osc as modulator
-template<Oscillator::WaveShape W>
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
 void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl )
 {
@@ -686,7 +803,7 @@ void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
 	for( fpp_t frame = 0; frame < _frames; ++frame )
 	{
 		m_phase += _ab[frame][_chnl] * sampleRateCorrection;
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
+		_ab[frame][_chnl] = getSample<W, S>( m_phase ) * m_volume;
 		m_phase += osc_coeff;
 	}
 }
@@ -694,130 +811,43 @@ void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
 
 
 
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Sine>(const float sample)
-{
-	const float current_freq = m_freq * m_detuning_div_samplerate * Engine::audioEngine()->processingSampleRate();
-
-	if (!m_useWaveTable || current_freq < OscillatorConstants::MAX_FREQ)
-	{
-		return sinSample(sample);
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Triangle>(
-		const float _sample )
+template<Oscillator::WaveShape W, Oscillator::Sampling S>
+inline sample_t Oscillator::getSample(const float sample)
 {
-	if (m_useWaveTable && !m_isModulator)
+	if constexpr (W == WaveShape::Sine)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Triangle) - FirstWaveShapeTable],_sample);
+		if constexpr (S == Sampling::Direct) { return sinSample(sample); }
+		else { return 0; }
 	}
-	else
-	{
-		return triangleSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Saw>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	else if constexpr (W == WaveShape::WhiteNoise)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Saw) - FirstWaveShapeTable], _sample);
+		return noiseSample(sample);
 	}
-	else
+	else if constexpr (W == WaveShape::UserDefined)
 	{
-		return sawSample(_sample);
+		if constexpr (S == Sampling::WaveTable) { return wtSample(m_userAntiAliasWaveTable->tables(), sample); }
+		else { return userWaveSample(m_userWave.get(), sample); }
 	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Square>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	else if constexpr (S == Sampling::WaveTable)
 	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Square) - FirstWaveShapeTable], _sample);
+		return wtSample(s_waveTables[static_cast<std::size_t>(W) - FirstWaveShapeTable], sample);
 	}
-	else
-	{
-		return squareSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::MoogSaw>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::MoogSaw) - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return moogSawSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::Exponential>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[static_cast<std::size_t>(WaveShape::Exponential) - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return expSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::WhiteNoise>(
-							const float _sample )
-{
-	return( noiseSample( _sample ) );
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WaveShape::UserDefined>(
-							const float _sample )
-{
-	if (m_useWaveTable && m_userAntiAliasWaveTable && !m_isModulator)
+	else if constexpr (S == Sampling::PolyBlep)
 	{
-		return wtSample(m_userAntiAliasWaveTable.get(), _sample);
+		const float inc = m_freq * m_detuning_div_samplerate;
+		if constexpr (W == WaveShape::Triangle) { return triangleBlepSample(sample, inc); }
+		else if constexpr (W == WaveShape::Saw) { return sawBlepSample(sample, inc); }
+		else if constexpr (W == WaveShape::Square) { return squareBlepSample(sample, inc); }
+		else if constexpr (W == WaveShape::MoogSaw) { return moogSawBlepSample(sample, inc); }
+		else { return expBlepSample(sample, inc); }
 	}
 	else
 	{
-		return userWaveSample(m_userWave.get(), _sample);
+		if constexpr (W == WaveShape::Triangle) { return triangleSample(sample); }
+		else if constexpr (W == WaveShape::Saw) { return sawSample(sample); }
+		else if constexpr (W == WaveShape::Square) { return squareSample(sample); }
+		else if constexpr (W == WaveShape::MoogSaw) { return moogSawSample(sample); }
+		else { return expSample(sample); }
 	}
 }
 
@@ -0,0 +1,265 @@
+/*
+ * OscillatorBatch.cpp - update the oscillators of several voices at once
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "Oscillator.h"
+
+#include <algorithm>
+#include <array>
+
+#include "AudioEngine.h"
+#include "AutomatableModel.h"
+#include "Engine.h"
+#include "OscillatorLanes.h"
+#include "PeriodArena.h"
+
+
+namespace lmms
+{
+
+using OscillatorLanes::LaneArray;
+using OscillatorLanes::Lanes;
+
+namespace
+{
+
+using Combine = OscillatorLanes::Combine;
+using RenderFunction = void (*)(float*, LaneArray<float>&, const LaneArray<float>&,
+	const LaneArray<float>&, const LaneArray<int>&, int, float);
+
+
+template<typename Shape>
+RenderFunction renderFunction(const Combine combine)
+{
+	switch (combine)
+	{
+		case Combine::Replace: return OscillatorLanes::render<Shape, Combine::Replace>;
+		case Combine::Mix: return OscillatorLanes::render<Shape, Combine::Mix>;
+		case Combine::Multiply: return OscillatorLanes::render<Shape, Combine::Multiply>;
+		case Combine::PhaseModulate: return OscillatorLanes::render<Shape, Combine::PhaseModulate>;
+		case Combine::FrequencyModulate: return OscillatorLanes::render<Shape, Combine::FrequencyModulate>;
+	}
+	return nullptr;
+}
+
+
+RenderFunction renderFunction(const Oscillator::WaveShape shape, const bool polyBlep, const Combine combine)
+{
+	using namespace OscillatorLanes;
+	using WaveShape = Oscillator::WaveShape;
+
+	switch (shape)
+	{
+		case WaveShape::Sine: return renderFunction<Sine>(combine);
+		case WaveShape::Triangle:
+			return polyBlep ? renderFunction<TriangleBlep>(combine) : renderFunction<Triangle>(combine);
+		case WaveShape::Saw:
+			return polyBlep ? renderFunction<SawBlep>(combine) : renderFunction<Saw>(combine);
+		case WaveShape::Square:
+			return polyBlep ? renderFunction<SquareBlep>(combine) : renderFunction<Square>(combine);
+		case WaveShape::MoogSaw:
+			return polyBlep ? renderFunction<MoogSawBlep>(combine) : renderFunction<MoogSaw>(combine);
+		case WaveShape::Exponential:
+			return polyBlep ? renderFunction<ExponentialBlep>(combine) : renderFunction<Exponential>(combine);
+		default: return nullptr;
+	}
+}
+
+
+Combine combineWithSubOsc(const Oscillator::ModulationAlgo algo)
+{
+	switch (algo)
+	{
+		case Oscillator::ModulationAlgo::PhaseModulation: return Combine::PhaseModulate;
+		case Oscillator::ModulationAlgo::AmplitudeModulation: return Combine::Multiply;
+		case Oscillator::ModulationAlgo::FrequencyModulation: return Combine::FrequencyModulate;
+		default: return Combine::Mix;
+	}
+}
+
+} // namespace
+
+
+
+
+bool Oscillator::updateVoices(Oscillator* const* voices, sampleFrame* const* buffers, const fpp_t* frames,
+	std::size_t count, const ch_cnt_t chnl)
+{
+	if (count == 0) { return true; }
+
+	const Oscillator* first = voices[0];
+	if (!first->canUpdateInLanes(false)) { return false; }
+	for (std::size_t voice = 1; voice < count; ++voice)
+	{
+		if (!first->canUpdateWith(*voices[voice])) { return false; }
+	}
+
+	const float nyquist = Engine::audioEngine()->processingSampleRate() / 2;
+	auto signal = PeriodAllocator<float>::vector(*std::max_element(frames, frames + count) * Lanes);
+
+	std::array<Oscillator*, Lanes> lanes{};
+	std::array<sampleFrame*, Lanes> laneBuffers{};
+	std::array<fpp_t, Lanes> laneFrames{};
+	std::size_t used = 0;
+
+	const auto renderLanes = [&]
+	{
+		const fpp_t maxFrames = *std::max_element(laneFrames.begin(), laneFrames.begin() + used);
+		updateLanes(lanes.data(), used, signal.data(), laneFrames.data(), maxFrames, false);
+		for (std::size_t lane = 0; lane < used; ++lane)
+		{
+			for (fpp_t frame = 0; frame < laneFrames[lane]; ++frame)
+			{
+				laneBuffers[lane][frame][chnl] = signal[frame * Lanes + lane];
+			}
+		}
+		used = 0;
+	};
+
+	for (std::size_t voice = 0; voice < count; ++voice)
+	{
+		// update() silences the whole buffer in this case, leave that to it
+		bool audible = true;
+		for (const Oscillator* osc = voices[voice]; osc; osc = osc->m_subOsc)
+		{
+			audible = audible && osc->m_freq < nyquist;
+		}
+		if (!audible)
+		{
+			voices[voice]->update(buffers[voice], frames[voice], chnl);
+			continue;
+		}
+
+		lanes[used] = voices[voice];
+		laneBuffers[used] = buffers[voice];
+		laneFrames[used] = frames[voice];
+		if (++used == Lanes) { renderLanes(); }
+	}
+	if (used > 0) { renderLanes(); }
+
+	return true;
+}
+
+
+
+
+bool Oscillator::canUpdateWith(const Oscillator& other) const
+{
+	if (m_waveShapeModel->value() != other.m_waveShapeModel->value()
+		|| m_useWaveTable != other.m_useWaveTable
+		|| m_usePolyBlep != other.m_usePolyBlep
+		|| (m_subOsc == nullptr) != (other.m_subOsc == nullptr))
+	{
+		return false;
+	}
+	return m_subOsc == nullptr
+		|| (m_modulationAlgoModel->value() == other.m_modulationAlgoModel->value()
+			&& m_subOsc->canUpdateWith(*other.m_subOsc));
+}
+
+
+
+
+bool Oscillator::canUpdateInLanes(const bool modulator) const
+{
+	switch (static_cast<WaveShape>(m_waveShapeModel->value()))
+	{
+		case WaveShape::Sine:
+			break;
+		case WaveShape::Triangle:
+		case WaveShape::Saw:
+		case WaveShape::Square:
+		case WaveShape::MoogSaw:
+		case WaveShape::Exponential:
+			// gathering from the band-limited tables lane by lane wouldn't
+			// gain anything, modulators don't read them though
+			if (m_useWaveTable && !m_usePolyBlep && !modulator) { return false; }
+			break;
+		default:
+			return false;
+	}
+
+	if (m_subOsc == nullptr) { return true; }
+
+	const auto algo = static_cast<ModulationAlgo>(m_modulationAlgoModel->value());
+	if (algo == ModulationAlgo::SynchronizedBySubOsc) { return false; }
+	return m_subOsc->canUpdateInLanes(algo == ModulationAlgo::PhaseModulation
+		|| algo == ModulationAlgo::FrequencyModulation);
+}
+
+
+
+
+void Oscillator::updateLanes(Oscillator* const* lanes, std::size_t count, float* signal,
+	const fpp_t* frames, fpp_t maxFrames, bool modulator)
+{
+	const Oscillator* first = lanes[0];
+	auto combine = Combine::Replace;
+	if (first->m_subOsc != nullptr)
+	{
+		combine = combineWithSubOsc(static_cast<ModulationAlgo>(first->m_modulationAlgoModel->value()));
+
+		std::array<Oscillator*, Lanes> subOscs{};
+		for (std::size_t lane = 0; lane < count; ++lane)
+		{
+			subOscs[lane] = lanes[lane]->m_subOsc;
+		}
+		updateLanes(subOscs.data(), count, signal, frames, maxFrames,
+			combine == Combine::PhaseModulate || combine == Combine::FrequencyModulate);
+	}
+
+	const auto shape = static_cast<WaveShape>(first->m_waveShapeModel->value());
+	const float sampleRate = Engine::audioEngine()->processingSampleRate();
+
+	// unused lanes get a harmless increment, and play no frames
+	LaneArray<float> phase{};
+	LaneArray<float> inc{};
+	LaneArray<float> gain{};
+	LaneArray<int> length{};
+	inc.fill(0.25f);
+	for (std::size_t lane = 0; lane < count; ++lane)
+	{
+		Oscillator* osc = lanes[lane];
+		osc->m_isModulator = modulator;
+		osc->recalcPhase();
+		phase[lane] = osc->m_phase;
+		inc[lane] = osc->m_freq * osc->m_detuning_div_samplerate;
+		// like sampling(WaveShape::Sine)
+		const bool silent = shape == WaveShape::Sine && osc->m_useWaveTable
+			&& inc[lane] * sampleRate >= OscillatorConstants::MAX_FREQ;
+		gain[lane] = silent ? 0.0f : osc->m_volume;
+		length[lane] = frames[lane];
+	}
+
+	const auto render = renderFunction(shape, first->m_usePolyBlep && !modulator, combine);
+	render(signal, phase, inc, gain, length, maxFrames, 44100.0f / sampleRate);
+
+	for (std::size_t lane = 0; lane < count; ++lane)
+	{
+		lanes[lane]->m_phase = phase[lane];
+	}
+}
+
+
+} // namespace lmms
@@ -0,0 +1,243 @@
+/*
+ * OscillatorLanes.h - render an oscillator for several voices at once
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef LMMS_OSCILLATOR_LANES_H
+#define LMMS_OSCILLATOR_LANES_H
+
+#include <array>
+#include <cmath>
+
+namespace lmms::OscillatorLanes
+{
+
+/*! \brief The loops of Oscillator::updateVoices()
+ *
+ *  Every voice runs in a lane of its own. Signals are kept lane by lane,
+ *  frame after frame, so a frame of all lanes is contiguous and the loops
+ *  over the lanes can be vectorised by the compiler. Voices have to share
+ *  everything but their phase, phase increment and length, which may be
+ *  shorter than the block for voices starting in the middle of a period.
+ *
+ *  The shapes and polyBLEP residuals compute the same as their
+ *  counterparts in Oscillator, just without branches. Only the sine is
+ *  approximated by a polynomial instead of calling sinf().
+ */
+constexpr int Lanes = 8;
+
+template<typename T>
+using LaneArray = std::array<T, Lanes>;
+
+
+inline float fraction(const float x)
+{
+	// Oscillator's absFraction()
+	return x - (x >= 0.0f ? static_cast<int>(x) : static_cast<int>(x) - 1);
+}
+
+
+inline float polyBlep(const float phase, const float inc)
+{
+	const float before = phase / inc;
+	const float after = (phase - 1.0f) / inc;
+	return phase < inc ? before + before - before * before - 1.0f
+		: phase > 1.0f - inc ? after * after + after + after + 1.0f
+		: 0.0f;
+}
+
+
+inline float polyBlamp(const float phase, const float inc)
+{
+	const float before = 1.0f - phase / inc;
+	const float after = 1.0f + (phase - 1.0f) / inc;
+	return phase < inc ? before * before * before * (1.0f / 6.0f)
+		: phase > 1.0f - inc ? after * after * after * (1.0f / 6.0f)
+		: 0.0f;
+}
+
+
+struct Sine
+{
+	static float sample(const float x, float)
+	{
+		// sin(2 pi x) = -sin(2 pi (x - 1/2)), the remaining quarters are
+		// mirrored into [-1/4, 1/4] where a Taylor series of 11th order is
+		// off by less than 6e-8
+		float q = fraction(x) - 0.5f;
+		q = std::fabs(q) > 0.25f ? std::copysign(0.5f, q) - q : q;
+		const float t = q * 6.28318531f;
+		const float t2 = t * t;
+		const float series = 1.0f - t2 / 6.0f * (1.0f - t2 / 20.0f * (1.0f - t2 / 42.0f
+			* (1.0f - t2 / 72.0f * (1.0f - t2 / 110.0f))));
+		return -t * series;
+	}
+};
+
+struct Triangle
+{
+	static float sample(const float x, float)
+	{
+		const float ph = fraction(x);
+		return ph <= 0.25f ? ph * 4.0f : ph <= 0.75f ? 2.0f - ph * 4.0f : ph * 4.0f - 4.0f;
+	}
+};
+
+struct Saw
+{
+	static float sample(const float x, float)
+	{
+		return -1.0f + fraction(x) * 2.0f;
+	}
+};
+
+struct Square
+{
+	static float sample(const float x, float)
+	{
+		return fraction(x) > 0.5f ? -1.0f : 1.0f;
+	}
+};
+
+struct MoogSaw
+{
+	static float sample(const float x, float)
+	{
+		const float ph = fraction(x);
+		return ph < 0.5f ? -1.0f + ph * 4.0f : 1.0f - 2.0f * ph;
+	}
+};
+
+struct Exponential
+{
+	static float sample(const float x, float)
+	{
+		float ph = fraction(x);
+		ph = ph > 0.5f ? 1.0f - ph : ph;
+		return -1.0f + 8.0f * ph * ph;
+	}
+};
+
+struct TriangleBlep
+{
+	static float sample(const float x, const float inc)
+	{
+		const float ph = fraction(x);
+		return Triangle::sample(ph, inc) + 8.0f * inc * (polyBlamp(fraction(ph + 0.25f), inc)
+			- polyBlamp(fraction(ph + 0.75f), inc));
+	}
+};
+
+struct SawBlep
+{
+	static float sample(const float x, const float inc)
+	{
+		const float ph = fraction(x);
+		return Saw::sample(ph, inc) - polyBlep(ph, inc);
+	}
+};
+
+struct SquareBlep
+{
+	static float sample(const float x, const float inc)
+	{
+		const float ph = fraction(x);
+		return Square::sample(ph, inc) + polyBlep(ph, inc) - polyBlep(fraction(ph + 0.5f), inc);
+	}
+};
+
+struct MoogSawBlep
+{
+	static float sample(const float x, const float inc)
+	{
+		const float ph = fraction(x);
+		const float half = fraction(ph + 0.5f);
+		return MoogSaw::sample(ph, inc) - 0.5f * polyBlep(half, inc)
+			+ 6.0f * inc * (polyBlamp(ph, inc) - polyBlamp(half, inc));
+	}
+};
+
+struct ExponentialBlep
+{
+	static float sample(const float x, const float inc)
+	{
+		const float ph = fraction(x);
+		return Exponential::sample(ph, inc) - 16.0f * inc * polyBlamp(fraction(ph + 0.5f), inc);
+	}
+};
+
+
+//! How an oscillator's samples are combined with the signal of its sub-oscillator
+enum class Combine
+{
+	Replace,
+	Mix,
+	Multiply,
+	PhaseModulate,
+	FrequencyModulate
+};
+
+
+/*! Renders @p frames frames of one oscillator of all lanes into @p signal,
+ *  which holds the output of the sub-oscillators.
+ *
+ *  @param phase Phases of the lanes, advanced by the frames each one plays
+ *  @param inc Phase increments per frame
+ *  @param gain Volume of the lanes
+ *  @param length Number of frames each lane plays, at most @p frames
+ *  @param fmScale Scale of the signal when it modulates the frequency
+ */
+template<typename Shape, Combine C>
+void render(float* signal, LaneArray<float>& phase, const LaneArray<float>& inc,
+	const LaneArray<float>& gain, const LaneArray<int>& length, const int frames, const float fmScale)
+{
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		float* lanes = signal + frame * Lanes;
+		for (int lane = 0; lane < Lanes; ++lane)
+		{
+			// loaded unconditionally, in the ternaries below they would
+			// keep GCC from vectorising
+			const bool active = frame < length[lane];
+			const float step = inc[lane];
+			const float in = lanes[lane];
+			if constexpr (C == Combine::FrequencyModulate)
+			{
+				phase[lane] += active ? in * fmScale : 0.0f;
+			}
+
+			const float x = C == Combine::PhaseModulate ? phase[lane] + in : phase[lane];
+			const float sample = Shape::sample(x, step) * gain[lane];
+			lanes[lane] = C == Combine::Mix ? in + sample
+				: C == Combine::Multiply ? in * sample
+				: sample;
+
+			phase[lane] += active ? step : 0.0f;
+		}
+	}
+}
+
+
+} // namespace lmms::OscillatorLanes
+
+#endif // LMMS_OSCILLATOR_LANES_H
@@ -2,6 +2,8 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QStandardPaths>
+#include <cstdlib>
 
 #include "ConfigManager.h"
 #include "Engine.h"
@@ -188,4 +190,16 @@ namespace lmms::PathUtil
 		return basePrefix(shortestBase) + relativeOrAbsolute(absolutePath, shortestBase);
 	}
 
+
+
+
+	QString cacheDir()
+	{
+		if (const char* dir = std::getenv("LMMS_CACHE_DIR"))
+		{
+			return QString::fromLocal8Bit(dir);
+		}
+		return QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	}
+
 } // namespace lmms::PathUtil
@@ -109,7 +109,8 @@ bar_t PatternStore::lengthOfPattern(int pattern) const
 
 int PatternStore::numOfPatterns() const
 {
-	return Engine::getSong()->countTracks(Track::Type::Pattern);
+	// every pattern track is one of the song's, and this doesn't have to count them
+	return PatternTrack::numOfPatternTracks();
 }
 
 
@@ -160,9 +161,10 @@ void PatternStore::updatePatternTrack(Clip* clip)
 void PatternStore::fixIncorrectPositions()
 {
 	const TrackList& tl = tracks();
+	const int patterns = numOfPatterns();
 	for (Track * t : tl)
 	{
-		for (int i = 0; i < numOfPatterns(); ++i)
+		for (int i = 0; i < patterns; ++i)
 		{
 			t->getClip(i)->movePosition(TimePos(i, 0));
 		}
@@ -201,7 +203,8 @@ void PatternStore::updateComboBox()
 
 	m_patternComboBoxModel.clear();
 
-	for (int i = 0; i < numOfPatterns(); ++i)
+	const int patterns = numOfPatterns();
+	for (int i = 0; i < patterns; ++i)
 	{
 		PatternTrack* pt = PatternTrack::findPatternTrack(i);
 		m_patternComboBoxModel.addItem(pt->name());
@@ -214,15 +217,15 @@ void PatternStore::updateComboBox()
 
 void PatternStore::currentPatternChanged()
 {
-	// now update all track-labels (the current one has to become white, the others gray)
-	const TrackList& tl = Engine::getSong()->tracks();
-	for (Track * t : tl)
+	// now update the track-labels (the current one has to become white, the others gray),
+	// which only changes for the track that was current and the one that is now
+	PatternTrack* current = PatternTrack::findPatternTrack(currentPattern());
+	if (m_currentPatternTrack && m_currentPatternTrack != current)
 	{
-		if (t->type() == Track::Type::Pattern)
-		{
-			t->dataChanged();
-		}
+		m_currentPatternTrack->dataChanged();
 	}
+	if (current) { current->dataChanged(); }
+	m_currentPatternTrack = current;
 }
 
 
@@ -237,19 +240,25 @@ void PatternStore::createClipsForPattern(int pattern)
 	}
 }
 
-AutomatedValueMap PatternStore::automatedValuesAt(TimePos time, int clipNum) const
+AutomationSourceMap PatternStore::automationSourcesAt(TimePos time, int clipNum) const
 {
 	Q_ASSERT(clipNum >= 0);
 	Q_ASSERT(time.getTicks() >= 0);
 
 	auto lengthBars = lengthOfPattern(clipNum);
 	auto lengthTicks = lengthBars * TimePos::ticksPerBar();
+	const bool moving = time < lengthTicks;
 	if (time > lengthTicks)
 	{
 		time = lengthTicks;
 	}
 
-	return TrackContainer::automatedValuesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	auto sources = TrackContainer::automationSourcesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	if (!moving)
+	{
+		for (auto& source : sources) { source.moving = false; }
+	}
+	return sources;
 }
 
 
@@ -25,6 +25,7 @@
 
 #include "PeakController.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <QDomElement>
@@ -83,6 +84,8 @@ void PeakController::updateValueBuffer()
 		const float ratio = 44100.0f / Engine::audioEngine()->processingSampleRate();
 		m_attackCoeff = 1.0f - powf( 2.0f, -0.3f * ( 1.0f - m_peakEffect->attackModel()->value() ) * ratio );
 		m_decayCoeff = 1.0f -  powf( 2.0f, -0.3f * ( 1.0f - m_peakEffect->decayModel()->value()  ) * ratio );
+		m_attackBlockCoeff = 1.0f - powf( 1.0f - m_attackCoeff, ControlRateFrames );
+		m_decayBlockCoeff = 1.0f - powf( 1.0f - m_decayCoeff, ControlRateFrames );
 		m_coeffNeedsUpdate = false;
 	}
 
@@ -94,18 +97,30 @@ void PeakController::updateValueBuffer()
 			const f_cnt_t frames = Engine::audioEngine()->framesPerPeriod();
 			float * values = m_valueBuffer.values();
 
-			for( f_cnt_t f = 0; f < frames; ++f )
+			// the target stays the same for the whole period, so the envelope
+			// only goes up or down: it's followed at control rate, where it's
+			// exact, and interpolated linearly in between
+			const bool up = m_currentSample < targetSample;
+			const float coeff = up ? m_attackCoeff : m_decayCoeff;
+			const float blockCoeff = up ? m_attackBlockCoeff : m_decayBlockCoeff;
+			for( f_cnt_t f = 0; f < frames; f += ControlRateFrames )
 			{
-				const float diff = ( targetSample - m_currentSample );
-				if( m_currentSample < targetSample ) // going up...
+				const f_cnt_t count = std::min( ControlRateFrames, frames - f );
+				const float reached = count == ControlRateFrames
+					? blockCoeff
+					: 1.0f - powf( 1.0f - coeff, count );
+				const float next = m_currentSample + ( targetSample - m_currentSample ) * reached;
+				const float step = ( next - m_currentSample ) / count;
+				for( f_cnt_t i = 0; i < count; ++i )
 				{
-					m_currentSample += diff * m_attackCoeff;
+					values[f + i] = m_currentSample + step * ( i + 1 );
 				}
-				else if( m_currentSample > targetSample ) // going down
-				{
-					m_currentSample += diff * m_decayCoeff;
-				}
-				values[f] = m_currentSample;
+				m_currentSample = next;
+			}
+			// it never quite gets there otherwise, and would be followed forever
+			if( std::abs( targetSample - m_currentSample ) < 1e-6f )
+			{
+				m_currentSample = targetSample;
 			}
 		}
 		else
@@ -0,0 +1,137 @@
+/*
+ * PeriodArena.cpp - memory for temporaries which only live for one period
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "PeriodArena.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "MemoryManager.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+// plenty for the lists of clips and notes of one period
+constexpr std::size_t ArenaSize = 256 * 1024;
+constexpr int MaxArenas = 128;
+
+struct Arena
+{
+	std::unique_ptr<char[]> memory{new char[ArenaSize]};
+	std::size_t used = 0;
+	unsigned generation = 0;
+};
+
+std::atomic<unsigned> s_generation{0};
+
+// every arena ever attached, to find the owner of memory given back on
+// another thread - arenas live until the program ends
+std::array<std::atomic<const char*>, MaxArenas> s_arenaMemory{};
+std::atomic_int s_arenaCount{0};
+
+thread_local Arena* t_arena = nullptr;
+
+
+bool isArenaMemory(const char* ptr, const char* memory)
+{
+	return memory && ptr >= memory && ptr < memory + ArenaSize;
+}
+
+} // namespace
+
+
+
+
+void PeriodArena::reset()
+{
+	s_generation.fetch_add(1, std::memory_order_relaxed);
+	attachThread();
+}
+
+
+
+
+void PeriodArena::attachThread()
+{
+	if (t_arena) { return; }
+
+	const int index = s_arenaCount.fetch_add(1, std::memory_order_relaxed);
+	if (index >= MaxArenas) { return; }
+
+	t_arena = new Arena;
+	t_arena->generation = s_generation.load(std::memory_order_relaxed);
+	s_arenaMemory[index].store(t_arena->memory.get(), std::memory_order_release);
+}
+
+
+
+
+void* PeriodArena::allocate(std::size_t size, std::size_t alignment)
+{
+	Arena* arena = t_arena;
+	if (arena)
+	{
+		const unsigned generation = s_generation.load(std::memory_order_relaxed);
+		if (arena->generation != generation)
+		{
+			// a new period started, nothing from the last one is in use anymore
+			arena->used = 0;
+			arena->generation = generation;
+		}
+
+		const auto base = reinterpret_cast<std::uintptr_t>(arena->memory.get());
+		const std::size_t offset = ((base + arena->used + alignment - 1) & ~(alignment - 1)) - base;
+		if (offset + size <= ArenaSize)
+		{
+			arena->used = offset + size;
+			return arena->memory.get() + offset;
+		}
+	}
+	return MemoryManager::alloc(size);
+}
+
+
+
+
+void PeriodArena::deallocate(void* ptr)
+{
+	const auto p = static_cast<const char*>(ptr);
+	if (!p || (t_arena && isArenaMemory(p, t_arena->memory.get()))) { return; }
+
+	const int count = std::min(s_arenaCount.load(std::memory_order_relaxed), MaxArenas);
+	for (int i = 0; i < count; ++i)
+	{
+		if (isArenaMemory(p, s_arenaMemory[i].load(std::memory_order_acquire))) { return; }
+	}
+	MemoryManager::free(ptr);
+}
+
+
+} // namespace lmms
@@ -0,0 +1,92 @@
+/*
+ * PlanarBuffer.cpp - audio with every channel in a separate aligned array
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "PlanarBuffer.h"
+
+#include <algorithm>
+#include <new>
+
+namespace lmms
+{
+
+
+PlanarBuffer::PlanarBuffer( fpp_t frames ) :
+	m_frames( frames ),
+	// round up so the right channel starts on a cache line too
+	m_stride( ( frames * sizeof( sample_t ) + Alignment - 1 ) / Alignment * Alignment / sizeof( sample_t ) ),
+	m_data( static_cast<sample_t*>( ::operator new( DEFAULT_CHANNELS * m_stride * sizeof( sample_t ),
+												std::align_val_t{ Alignment } ) ) )
+{
+	clear( frames );
+}
+
+
+
+
+void PlanarBuffer::clear( fpp_t frames )
+{
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		std::fill_n( channel( ch ), frames, 0.f );
+	}
+}
+
+
+
+
+void PlanarBuffer::deinterleave( const sampleFrame * src, fpp_t frames )
+{
+	sample_t * left = channel( 0 );
+	sample_t * right = channel( 1 );
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		left[f] = src[f][0];
+		right[f] = src[f][1];
+	}
+}
+
+
+
+
+void PlanarBuffer::interleave( sampleFrame * dst, fpp_t frames ) const
+{
+	const sample_t * left = channel( 0 );
+	const sample_t * right = channel( 1 );
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		dst[f][0] = left[f];
+		dst[f][1] = right[f];
+	}
+}
+
+
+
+
+void PlanarBuffer::AlignedDeleter::operator()( sample_t * data ) const
+{
+	::operator delete( data, std::align_val_t{ Alignment } );
+}
+
+
+} // namespace lmms
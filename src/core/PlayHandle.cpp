@@ -24,8 +24,11 @@
  
 #include "PlayHandle.h"
 #include "AudioEngine.h"
+#include "AudioEngineTracer.h"
+#include "AudioPort.h"
 #include "BufferManager.h"
 #include "Engine.h"
+#include "MicroTimer.h"
 
 #include <QThread>
 
@@ -39,7 +42,9 @@ PlayHandle::PlayHandle(const Type type, f_cnt_t offset) :
 		m_affinity(QThread::currentThread()),
 		m_playHandleBuffer(BufferManager::acquire()),
 		m_bufferReleased(true),
-		m_usesBuffer(true)
+		m_usesBuffer(true),
+		m_renderedElsewhere(false),
+		m_removalRequested(false)
 {
 }
 
@@ -50,9 +55,25 @@ PlayHandle::~PlayHandle()
 }
 
 
+static const char* traceName(PlayHandle::Type type)
+{
+	switch (type)
+	{
+		case PlayHandle::Type::NotePlayHandle: return "NotePlayHandle";
+		case PlayHandle::Type::InstrumentPlayHandle: return "InstrumentPlayHandle";
+		case PlayHandle::Type::SamplePlayHandle: return "SamplePlayHandle";
+		case PlayHandle::Type::PresetPreviewHandle: return "PresetPreviewHandle";
+	}
+	return "PlayHandle";
+}
+
+
 void PlayHandle::doProcessing()
 {
-	if( m_usesBuffer )
+	AudioEngineTracer::Scope traceScope(traceName(m_type));
+	MicroTimer timer;
+
+	if( m_usesBuffer && !m_renderedElsewhere )
 	{
 		m_bufferReleased = false;
 		BufferManager::clear(m_playHandleBuffer, Engine::audioEngine()->framesPerPeriod());
@@ -62,6 +83,13 @@ void PlayHandle::doProcessing()
 	{
 		play( nullptr );
 	}
+
+	// let our audio port start as soon as all of its play handles are done
+	if( m_audioPort )
+	{
+		m_audioPort->addCpuTime( timer.elapsed() );
+		m_audioPort->inputProcessed();
+	}
 }
 
 
@@ -29,6 +29,7 @@
 #include <QDir>
 #include <QLibrary>
 #include <memory>
+#include <mutex>
 #include "lmmsconfig.h"
 
 #include "ConfigManager.h"
@@ -50,12 +51,16 @@ namespace lmms
 	QStringList nameFilters("lib*.so");
 #endif
 
+bool PluginFactory::s_discoverOnDemand = false;
 std::unique_ptr<PluginFactory> PluginFactory::s_instance;
 
 PluginFactory::PluginFactory()
 {
 	setupSearchPaths();
-	discoverPlugins();
+	if (!s_discoverOnDemand)
+	{
+		discoverPlugins();
+	}
 }
 
 void PluginFactory::setupSearchPaths()
@@ -91,10 +96,16 @@ void PluginFactory::setupSearchPaths()
 	QDir::addSearchPath("plugins", ConfigManager::inst()->workingDir() + "plugins");
 }
 
+void PluginFactory::setDiscoverOnDemand(bool onDemand)
+{
+	s_discoverOnDemand = onDemand;
+}
+
 PluginFactory* PluginFactory::instance()
 {
-	if (s_instance == nullptr)
-		s_instance = std::make_unique<PluginFactory>();
+	// Engine::init() may have started the discovery on another thread
+	static std::once_flag created;
+	std::call_once(created, [] { s_instance = std::make_unique<PluginFactory>(); });
 
 	return s_instance.get();
 }
@@ -104,33 +115,51 @@ PluginFactory* getPluginFactory()
 	return PluginFactory::instance();
 }
 
-Plugin::DescriptorList PluginFactory::descriptors() const
+Plugin::DescriptorList PluginFactory::descriptors()
 {
+	discoverAllPlugins();
 	return m_descriptors.values();
 }
 
-Plugin::DescriptorList PluginFactory::descriptors(Plugin::Type type) const
+Plugin::DescriptorList PluginFactory::descriptors(Plugin::Type type)
 {
+	discoverAllPlugins();
 	return m_descriptors.values(type);
 }
 
-const PluginFactory::PluginInfoList& PluginFactory::pluginInfos() const
+const PluginFactory::PluginInfoList& PluginFactory::pluginInfos()
 {
+	discoverAllPlugins();
 	return m_pluginInfos;
 }
 
 PluginFactory::PluginInfoAndKey PluginFactory::pluginSupportingExtension(const QString& ext)
 {
+	discoverAllPlugins();
 	return m_pluginByExt.value(ext, PluginInfoAndKey());
 }
 
-PluginFactory::PluginInfo PluginFactory::pluginInfo(const char* name) const
+PluginFactory::PluginInfo PluginFactory::pluginInfo(const char* name)
 {
 	for (const PluginInfo& info : m_pluginInfos)
 	{
 		if (qstrcmp(info.descriptor->name, name) == 0)
 			return info;
 	}
+
+	if (!m_discovered)
+	{
+		PluginInfo info = loadPluginOnDemand(name);
+		if (!info.isNull())
+		{
+			return info;
+		}
+
+		// the library may be named differently or need another plugin's
+		// library, which the full discovery takes care of
+		discoverPlugins();
+		return pluginInfo(name);
+	}
 	return PluginInfo();
 }
 
@@ -142,9 +171,10 @@ QString PluginFactory::errorString(QString pluginName) const
 
 void PluginFactory::discoverPlugins()
 {
-	DescriptorMap descriptors;
-	PluginInfoList pluginInfos;
+	m_descriptors.clear();
+	m_pluginInfos.clear();
 	m_pluginByExt.clear();
+	m_discovered = true;
 
 	QSet<QFileInfo> files;
 	for (const QString& searchPath : QDir::searchPaths("plugins"))
@@ -166,83 +196,132 @@ void PluginFactory::discoverPlugins()
 
 	for (const QFileInfo& file : files)
 	{
-		auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
-		if (! library->load()) {
-			m_errors[file.baseName()] = library->errorString();
-			qWarning("%s", library->errorString().toLocal8Bit().data());
+		PluginInfo info = loadPlugin(file);
+		if (info.isNull())
+		{
+			if (m_errors.contains(file.baseName()))
+			{
+				qWarning("%s", m_errors[file.baseName()].toLocal8Bit().data());
+			}
 			continue;
 		}
 
-		Plugin::Descriptor* pluginDescriptor = nullptr;
-		if (library->resolve("lmms_plugin_main"))
+		m_pluginInfos << info;
+
+		auto addSupportedFileTypes =
+			[this](QString supportedFileTypes,
+				const PluginInfo& info,
+				const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
 		{
-			QString descriptorName = file.baseName() + "_plugin_descriptor";
-			if( descriptorName.left(3) == "lib" )
+			if(!supportedFileTypes.isNull())
 			{
-				descriptorName = descriptorName.mid(3);
+				for (const QString& ext : supportedFileTypes.split(','))
+				{
+					//qDebug() << "Plugin " << info.name()
+					//	<< "supports" << ext;
+					PluginInfoAndKey infoAndKey;
+					infoAndKey.info = info;
+					infoAndKey.key = key
+						? *key
+						: Plugin::Descriptor::SubPluginFeatures::Key();
+					m_pluginByExt.insert(ext, infoAndKey);
+				}
 			}
+		};
+
+		if (info.descriptor->supportedFileTypes)
+			addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
 
-			pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library->resolve(descriptorName.toUtf8().constData()));
-			if(pluginDescriptor == nullptr)
+		if (info.descriptor->subPluginFeatures)
+		{
+			Plugin::Descriptor::SubPluginFeatures::KeyList
+				subPluginKeys;
+			info.descriptor->subPluginFeatures->listSubPluginKeys(
+				info.descriptor,
+				subPluginKeys);
+			for(const Plugin::Descriptor::SubPluginFeatures::Key& key
+				: subPluginKeys)
 			{
-				qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
-							  arg(file.absoluteFilePath()).arg(descriptorName);
-				continue;
+				addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
 			}
 		}
 
-		if(pluginDescriptor)
-		{
-			PluginInfo info;
-			info.file = file;
-			info.library = library;
-			info.descriptor = pluginDescriptor;
-			pluginInfos << info;
-
-			auto addSupportedFileTypes =
-				[this](QString supportedFileTypes,
-					const PluginInfo& info,
-					const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
-			{
-				if(!supportedFileTypes.isNull())
-				{
-					for (const QString& ext : supportedFileTypes.split(','))
-					{
-						//qDebug() << "Plugin " << info.name()
-						//	<< "supports" << ext;
-						PluginInfoAndKey infoAndKey;
-						infoAndKey.info = info;
-						infoAndKey.key = key
-							? *key
-							: Plugin::Descriptor::SubPluginFeatures::Key();
-						m_pluginByExt.insert(ext, infoAndKey);
-					}
-				}
-			};
+		m_descriptors.insert(info.descriptor->type, info.descriptor);
+	}
+}
+
+void PluginFactory::discoverAllPlugins()
+{
+	if (!m_discovered)
+	{
+		discoverPlugins();
+	}
+}
+
+PluginFactory::PluginInfo PluginFactory::loadPlugin(const QFileInfo& file)
+{
+	auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
+	if (! library->load()) {
+		m_errors[file.baseName()] = library->errorString();
+		return PluginInfo();
+	}
+	m_errors.remove(file.baseName());
+
+	if (!library->resolve("lmms_plugin_main"))
+	{
+		return PluginInfo();
+	}
+
+	QString descriptorName = file.baseName() + "_plugin_descriptor";
+	if( descriptorName.left(3) == "lib" )
+	{
+		descriptorName = descriptorName.mid(3);
+	}
+
+	auto pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library->resolve(descriptorName.toUtf8().constData()));
+	if(pluginDescriptor == nullptr)
+	{
+		qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
+					  arg(file.absoluteFilePath()).arg(descriptorName);
+		return PluginInfo();
+	}
+
+	PluginInfo info;
+	info.file = file;
+	info.library = library;
+	info.descriptor = pluginDescriptor;
+	return info;
+}
 
-			if (info.descriptor->supportedFileTypes)
-				addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
+PluginFactory::PluginInfo PluginFactory::loadPluginOnDemand(const char* name)
+{
+#ifdef LMMS_BUILD_WIN32
+	const QStringList fileNames{QString("%1.dll").arg(name), QString("lib%1.dll").arg(name)};
+#else
+	const QStringList fileNames{QString("lib%1.so").arg(name)};
+#endif
 
-			if (info.descriptor->subPluginFeatures)
+	for (const QString& searchPath : QDir::searchPaths("plugins"))
+	{
+		for (const QString& fileName : fileNames)
+		{
+			const QFileInfo file(QDir(searchPath).filePath(fileName));
+			if (!file.exists())
 			{
-				Plugin::Descriptor::SubPluginFeatures::KeyList
-					subPluginKeys;
-				info.descriptor->subPluginFeatures->listSubPluginKeys(
-					info.descriptor,
-					subPluginKeys);
-				for(const Plugin::Descriptor::SubPluginFeatures::Key& key
-					: subPluginKeys)
-				{
-					addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
-				}
+				continue;
 			}
 
-			descriptors.insert(info.descriptor->type, info.descriptor);
+			PluginInfo info = loadPlugin(file);
+			if (!info.isNull() && qstrcmp(info.descriptor->name, name) == 0)
+			{
+				// only the plugins that were asked for are known until the full discovery
+				m_pluginInfos << info;
+				m_descriptors.insert(info.descriptor->type, info.descriptor);
+				return info;
+			}
 		}
 	}
-
-	m_pluginInfos = pluginInfos;
-	m_descriptors = descriptors;
+	return PluginInfo();
 }
 
 
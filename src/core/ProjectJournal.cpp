@@ -22,6 +22,7 @@
  *
  */
 
+#include <algorithm>
 #include <cstdlib>
 
 #include "ProjectJournal.h"
@@ -32,14 +33,11 @@
 namespace lmms
 {
 
-//! Avoid clashes between loaded IDs (have the bit cleared)
-//! and newly created IDs (have the bit set)
-static const int EO_ID_MSB = 1 << 23;
-
 const int ProjectJournal::MAX_UNDO_STATES = 100; // TODO: make this configurable in settings
 
 ProjectJournal::ProjectJournal() :
-	m_joIDs(),
+	m_sparseIDs(),
+	m_nextID( 0 ),
 	m_undoCheckPoints(),
 	m_redoCheckPoints(),
 	m_journalling( false )
@@ -54,17 +52,15 @@ void ProjectJournal::undo()
 	while( !m_undoCheckPoints.isEmpty() )
 	{
 		CheckPoint c = m_undoCheckPoints.pop();
-		JournallingObject *jo = m_joIDs[c.joID];
+		JournallingObject *jo = journallingObject( c.joID );
 
 		if( jo )
 		{
-			DataFile curState( DataFile::Type::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_redoCheckPoints.push( saveCheckPoint( jo ) );
 
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			restoreCheckPoint( jo, c );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -79,17 +75,15 @@ void ProjectJournal::redo()
 	while( !m_redoCheckPoints.isEmpty() )
 	{
 		CheckPoint c = m_redoCheckPoints.pop();
-		JournallingObject *jo = m_joIDs[c.joID];
+		JournallingObject *jo = journallingObject( c.joID );
 
 		if( jo )
 		{
-			DataFile curState( DataFile::Type::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_undoCheckPoints.push( saveCheckPoint( jo ) );
 
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			restoreCheckPoint( jo, c );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -115,10 +109,7 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 	{
 		m_redoCheckPoints.clear();
 
-		DataFile dataFile( DataFile::Type::JournalData );
-		jo->saveState( dataFile, dataFile.content() );
-
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
+		m_undoCheckPoints.push( saveCheckPoint( jo ) );
 		if( m_undoCheckPoints.size() > MAX_UNDO_STATES )
 		{
 			m_undoCheckPoints.remove( 0, m_undoCheckPoints.size() - MAX_UNDO_STATES );
@@ -129,16 +120,48 @@ void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 
 
 
+ProjectJournal::CheckPoint ProjectJournal::saveCheckPoint( JournallingObject * jo )
+{
+	DataFile dataFile( DataFile::Type::JournalData );
+	jo->saveState( dataFile, dataFile.content() );
+
+	// checkpoints are made while editing, so compress fast rather than small
+	return CheckPoint{ jo->id(), qCompress( dataFile.toByteArray( -1 ), 1 ) };
+}
+
+
+
+
+void ProjectJournal::restoreCheckPoint( JournallingObject * jo, const CheckPoint & checkPoint )
+{
+	DataFile dataFile( qUncompress( checkPoint.data ) );
+	jo->restoreState( dataFile.content().firstChildElement() );
+}
+
+
+
+
 jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 {
+	// hand out new IDs in order, so they stay in the dense table
+	while( m_nextID < NewIDBit )
+	{
+		const jo_id_t id = m_nextID++ | NewIDBit;
+		if( journallingObject( id ) == nullptr )
+		{
+			reallocID( id, _obj );
+			return id;
+		}
+	}
+
+	// all of them were handed out, look for a free one anywhere
 	jo_id_t id;
-	for( jo_id_t tid = rand(); m_joIDs.contains( id = tid % EO_ID_MSB
-							| EO_ID_MSB ); tid++ )
+	for( jo_id_t tid = rand(); journallingObject( id = tid % NewIDBit
+							| NewIDBit ); tid++ )
 	{
 	}
 
-	m_joIDs[id] = _obj;
-	//printf("new id: %d\n", id );
+	reallocID( id, _obj );
 	return id;
 }
 
@@ -147,11 +170,23 @@ jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 
 void ProjectJournal::reallocID( const jo_id_t _id, JournallingObject * _obj )
 {
-	//printf("realloc %d %d\n", _id, _obj );
-//	if( m_joIDs.contains( _id ) )
+	auto& table = m_denseIDs[denseHalf( _id )];
+	const auto index = denseIndex( _id );
+	if( index >= DenseIDs )
 	{
-		m_joIDs[_id] = _obj;
+		m_sparseIDs[_id] = _obj;
+		return;
+	}
+
+	if( index >= table.size() )
+	{
+		if( _obj == nullptr )
+		{
+			return;
+		}
+		table.resize( index + 1, nullptr );
 	}
+	table[index] = _obj;
 }
 
 
@@ -159,12 +194,12 @@ void ProjectJournal::reallocID( const jo_id_t _id, JournallingObject * _obj )
 
 jo_id_t ProjectJournal::idToSave( jo_id_t id )
 {
-	return id & ~EO_ID_MSB;
+	return id & ~NewIDBit;
 }
 
 jo_id_t ProjectJournal::idFromSave( jo_id_t id )
 {
-	return id | EO_ID_MSB;
+	return id | NewIDBit;
 }
 
 
@@ -175,22 +210,41 @@ void ProjectJournal::clearJournal()
 	m_undoCheckPoints.clear();
 	m_redoCheckPoints.clear();
 
-	for( JoIdMap::Iterator it = m_joIDs.begin(); it != m_joIDs.end(); )
+	for( JoIdMap::Iterator it = m_sparseIDs.begin(); it != m_sparseIDs.end(); )
 	{
 		if( it.value() == nullptr )
 		{
-			it = m_joIDs.erase( it );
+			it = m_sparseIDs.erase( it );
 		}
 		else
 		{
 			++it;
 		}
 	}
+
+	// the unused IDs at the ends of the tables can go, m_nextID keeps new IDs
+	// from being handed out twice, which pasted clips might still refer to
+	for( auto& table : m_denseIDs )
+	{
+		const auto last = std::find_if( table.rbegin(), table.rend(),
+			[]( const JournallingObject* jo ) { return jo != nullptr; } );
+		table.erase( last.base(), table.end() );
+	}
 }
 
 void ProjectJournal::stopAllJournalling()
 {
-	for( JoIdMap::Iterator it = m_joIDs.begin(); it != m_joIDs.end(); ++it)
+	for( const auto& table : m_denseIDs )
+	{
+		for( JournallingObject* jo : table )
+		{
+			if( jo != nullptr )
+			{
+				jo->setJournalling(false);
+			}
+		}
+	}
+	for( JoIdMap::Iterator it = m_sparseIDs.begin(); it != m_sparseIDs.end(); ++it)
 	{
 		if( it.value() != nullptr )
 		{
@@ -23,9 +23,11 @@
  */
 
 
+#include <QElapsedTimer>
 #include <QFile>
 
 #include "ProjectRenderer.h"
+#include "ConfigManager.h"
 #include "Song.h"
 #include "PerfLog.h"
 
@@ -33,13 +35,14 @@
 #include "AudioFileOgg.h"
 #include "AudioFileMP3.h"
 #include "AudioFileFlac.h"
+#include "AudioFileRaw.h"
 
 
 namespace lmms
 {
 
 
-const std::array<ProjectRenderer::FileEncodeDevice, 5> ProjectRenderer::fileEncodeDevices
+const std::array<ProjectRenderer::FileEncodeDevice, 6> ProjectRenderer::fileEncodeDevices
 {
 
 	FileEncodeDevice{ ProjectRenderer::ExportFileFormat::Wave,
@@ -68,6 +71,9 @@ const std::array<ProjectRenderer::FileEncodeDevice, 5> ProjectRenderer::fileEnco
 					nullptr
 #endif
 									},
+	FileEncodeDevice{ ProjectRenderer::ExportFileFormat::Raw,
+		QT_TRANSLATE_NOOP( "ProjectRenderer", "Raw PCM (*.raw)" ),
+					".raw", &AudioFileRaw::getInst },
 	// Insert your own file-encoder infos here.
 	// Maybe one day the user can add own encoders inside the program.
 
@@ -85,8 +91,12 @@ ProjectRenderer::ProjectRenderer( const AudioEngine::qualitySettings & qualitySe
 	QThread( Engine::audioEngine() ),
 	m_fileDev( nullptr ),
 	m_qualitySettings( qualitySettings ),
+	m_outputSettings( outputSettings ),
 	m_progress( 0 ),
-	m_abort( false )
+	m_abort( false ),
+	m_renderAhead( ConfigManager::inst()->value( "audioengine", "renderahead", "1" ).toInt() ),
+	m_realtime( false ),
+	m_loudnessReport( false )
 {
 	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[static_cast<std::size_t>(exportFileFormat)].m_getDevInst;
 
@@ -108,6 +118,31 @@ ProjectRenderer::ProjectRenderer( const AudioEngine::qualitySettings & qualitySe
 
 
 
+bool ProjectRenderer::addOutput( ExportFileFormat _file_format, const QString & _out_file )
+{
+	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[static_cast<std::size_t>(_file_format)].m_getDevInst;
+	if( !isReady() || !audioEncoderFactory )
+	{
+		return false;
+	}
+
+	bool successful = false;
+	auto copy = std::unique_ptr<AudioFileDevice>( audioEncoderFactory(
+				_out_file, m_outputSettings, DEFAULT_CHANNELS,
+				Engine::audioEngine(), successful ) );
+	if( !successful )
+	{
+		return false;
+	}
+
+	m_fileDev->addCopy( copy.get() );
+	m_copies.push_back( std::move( copy ) );
+	return true;
+}
+
+
+
+
 // Little help function for getting file format from a file extension
 // (only for registered file-encoders).
 ProjectRenderer::ExportFileFormat ProjectRenderer::getFileFormatFromExtension(
@@ -180,11 +215,40 @@ void ProjectRenderer::run()
 	m_progress = 0;
 
 	// Now start processing
-	Engine::audioEngine()->startProcessing(false);
+	AudioEngine * audioEngine = Engine::audioEngine();
+	audioEngine->startProcessing(m_renderAhead);
+
+	// Compress on other threads while this one keeps the audio engine busy,
+	// one for every output
+	if( m_loudnessReport )
+	{
+		m_fileDev->enableLoudnessReport();
+	}
+	m_fileDev->startEncoder();
+
+	// When rendering ahead, the FIFO thread stops after the last period and
+	// the file device stops processing once it has read all of them
+	const auto moreToWrite = [this]()
+	{
+		return m_renderAhead ? m_fileDev->isProcessing() : !Engine::getSong()->isExportDone();
+	};
+
+	// in realtime, every period is written when it would be played
+	QElapsedTimer clock;
+	clock.start();
+	const double periodNanoseconds = 1e9 * audioEngine->framesPerPeriod() / audioEngine->processingSampleRate();
+	qint64 periods = 0;
 
 	// Continually track and emit progress percentage to listeners.
-	while (!Engine::getSong()->isExportDone() && !m_abort)
+	while (moreToWrite() && !m_abort)
 	{
+		if (m_realtime)
+		{
+			const auto ahead = static_cast<qint64>(periods * periodNanoseconds) - clock.nsecsElapsed();
+			if (ahead > 0) { usleep(static_cast<unsigned long>(ahead / 1000)); }
+			++periods;
+		}
+
 		m_fileDev->processNextBuffer();
 		const int nprog = Engine::getSong()->getExportProgress();
 		if (m_progress != nprog)
@@ -194,19 +258,48 @@ void ProjectRenderer::run()
 		}
 	}
 
+	if (m_renderAhead && m_abort)
+	{
+		// The FIFO thread may be blocked on a full FIFO, and we're the only
+		// one reading from it. The file is removed afterwards anyway.
+		audioEngine->m_fifoWriter->finish();
+		while (m_fileDev->isProcessing())
+		{
+			m_fileDev->processNextBuffer();
+		}
+	}
+
 	// Notify the audio engine of the end of processing.
 	Engine::audioEngine()->stopProcessing();
 
 	Engine::getSong()->stopExport();
 
+	m_fileDev->finishEncoder();
+
 	perfLog.end();
 
 	// If the user aborted export-process, the file has to be deleted.
 	const QString f = m_fileDev->outputFile();
-	if( m_abort )
+	if( m_abort && f != "-" )
 	{
 		QFile( f ).remove();
 	}
+	else if( m_loudnessReport && !m_abort )
+	{
+		m_fileDev->writeLoudnessReport();
+	}
+
+	// the copies are done, so close their files
+	for( auto& copy : m_copies )
+	{
+		const QString file = copy->outputFile();
+		copy.reset();
+		if( m_abort )
+		{
+			QFile( file ).remove();
+		}
+	}
+	m_copies.clear();
 }
 
 
@@ -0,0 +1,235 @@
+/*
+ * QualityGovernor.cpp - trades quality for time when the CPU can't keep up
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QualityGovernor.h"
+
+#include <QtGlobal>
+
+#include "AudioEngine.h"
+#include "AudioResampler.h"
+#include "ConfigManager.h"
+#include "Engine.h"
+#include "NotePlayHandle.h"
+#include "Song.h"
+
+namespace lmms
+{
+
+namespace
+{
+
+constexpr int PollInterval = 250; // ms
+//! A step is lowered once the load stayed at least this high for StepDownPolls
+constexpr int HighLoad = 90;
+constexpr int StepDownPolls = 2;
+//! and raised again once it stayed below this for StepUpPolls
+constexpr int LowLoad = 60;
+constexpr int StepUpPolls = 20;
+//! Notes playing at once while the voices are limited, if they weren't before
+constexpr int LoweredVoiceLimit = 64;
+
+constexpr int StepCount = static_cast<int>( QualityGovernor::Step::Count );
+
+const char * describe( QualityGovernor::Step step, bool lowered )
+{
+	switch( step )
+	{
+		case QualityGovernor::Step::AnalyserUpdates:
+			return lowered ? "analysers update less often" : "analysers update as often as set";
+		case QualityGovernor::Step::SampleInterpolation:
+			return lowered ? "samples interpolate cubically" : "samples interpolate as set";
+		case QualityGovernor::Step::EffectOversampling:
+			return lowered ? "effects oversample twice at most" : "effects oversample as set";
+		case QualityGovernor::Step::RemotePipelining:
+			return lowered ? "remote plugins are pipelined" : "remote plugins are pipelined as set";
+		case QualityGovernor::Step::VoiceLimit:
+			return lowered ? "fewer notes play at once" : "as many notes play at once as set";
+		case QualityGovernor::Step::Count:
+			break;
+	}
+	return "";
+}
+
+} // namespace
+
+
+
+
+QualityGovernor::QualityGovernor( QObject * parent ) :
+	QObject( parent )
+{
+	m_timer.setInterval( PollInterval );
+	connect( &m_timer, &QTimer::timeout, this, &QualityGovernor::poll );
+}
+
+
+
+
+QualityGovernor::~QualityGovernor()
+{
+	// don't leave the voice limit lowered for the next engine
+	if( isLowered( Step::VoiceLimit ) )
+	{
+		apply( Step::VoiceLimit, false );
+	}
+}
+
+
+
+
+void QualityGovernor::setEnabled( bool enabled )
+{
+	if( enabled == isEnabled() )
+	{
+		return;
+	}
+	if( enabled )
+	{
+		m_highPolls = m_lowPolls = 0;
+		m_timer.start();
+	}
+	else
+	{
+		m_timer.stop();
+		reset();
+	}
+}
+
+
+
+
+int QualityGovernor::sampleInterpolation( int mode ) const
+{
+	if( !isLowered( Step::SampleInterpolation ) )
+	{
+		return mode;
+	}
+	switch( mode )
+	{
+		case SRC_SINC_BEST_QUALITY:
+		case SRC_SINC_MEDIUM_QUALITY:
+		case SRC_SINC_FASTEST:
+		case AudioResampler::ShortSinc:
+			return AudioResampler::CubicHermite;
+		default:
+			return mode;
+	}
+}
+
+
+
+
+void QualityGovernor::poll()
+{
+	// an export takes as long as it has to
+	const Song * song = Engine::getSong();
+	if( song != nullptr && song->isExporting() )
+	{
+		reset();
+		return;
+	}
+
+	const int cpuLoad = Engine::audioEngine()->cpuLoad();
+	m_highPolls = cpuLoad >= HighLoad ? m_highPolls + 1 : 0;
+	m_lowPolls = cpuLoad < LowLoad ? m_lowPolls + 1 : 0;
+
+	if( m_highPolls >= StepDownPolls )
+	{
+		lower( cpuLoad );
+		m_highPolls = 0;
+	}
+	else if( m_lowPolls >= StepUpPolls )
+	{
+		raise( cpuLoad );
+		m_lowPolls = 0;
+	}
+}
+
+
+
+
+void QualityGovernor::lower( int cpuLoad )
+{
+	const int current = level();
+	if( current >= StepCount )
+	{
+		return;
+	}
+	const auto step = static_cast<Step>( current );
+	apply( step, true );
+	m_level.store( current + 1, std::memory_order_relaxed );
+	qInfo( "Quality governor: CPU load at %d%%, %s", cpuLoad, describe( step, true ) );
+}
+
+
+
+
+void QualityGovernor::raise( int cpuLoad )
+{
+	const int current = level();
+	if( current == 0 )
+	{
+		return;
+	}
+	const auto step = static_cast<Step>( current - 1 );
+	m_level.store( current - 1, std::memory_order_relaxed );
+	apply( step, false );
+	qInfo( "Quality governor: CPU load at %d%%, %s", cpuLoad, describe( step, false ) );
+}
+
+
+
+
+void QualityGovernor::reset()
+{
+	while( level() > 0 )
+	{
+		raise( Engine::audioEngine()->cpuLoad() );
+	}
+	m_highPolls = m_lowPolls = 0;
+}
+
+
+
+
+void QualityGovernor::apply( Step step, bool lowered )
+{
+	// the other steps are read by what they lower as it goes
+	if( step != Step::VoiceLimit )
+	{
+		return;
+	}
+	const int configured = ConfigManager::inst()->value( "audioengine", "maxvoices" ).toInt();
+	if( lowered )
+	{
+		NotePlayHandleManager::setVoiceLimit( configured > 0 ? std::max( configured / 2, 1 ) : LoweredVoiceLimit );
+	}
+	else
+	{
+		NotePlayHandleManager::setVoiceLimit( configured );
+	}
+}
+
+} // namespace lmms
@@ -0,0 +1,337 @@
+/*
+ * RealtimeChecker.cpp - reports what the audio threads shouldn't do
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RealtimeChecker.h"
+
+#ifdef LMMS_DEBUG_REALTIME
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace lmms
+{
+
+namespace
+{
+
+constexpr int MaxFrames = 32;
+//! check() and the function that called it
+constexpr int SkippedFrames = 2;
+//! How many callers tell call sites apart
+constexpr int SiteFrames = 8;
+constexpr std::size_t MaxSites = 4096;
+
+//! How many Scopes the thread is in
+thread_local int t_depth = 0;
+//! Whether the thread is in check() already, which calls some of what it checks
+thread_local bool t_checking = false;
+
+//! In static memory, since recording a call site mustn't allocate
+struct Site
+{
+	const char* what;
+	std::uint64_t hash;
+	void* frames[MaxFrames];
+	int frameCount;
+	std::uint64_t count;
+};
+
+std::mutex s_mutex;
+Site s_sites[MaxSites];
+std::size_t s_siteCount = 0;
+
+// backtrace() loads what it needs on its first call, which shouldn't happen
+// in the middle of a check
+const int s_backtraceLoaded = [] {
+	void* frame;
+	return backtrace(&frame, 1);
+}();
+
+} // namespace
+
+
+
+
+RealtimeChecker::Scope::Scope()
+{
+	++t_depth;
+}
+
+
+
+
+RealtimeChecker::Scope::~Scope()
+{
+	--t_depth;
+}
+
+
+
+
+void RealtimeChecker::check(const char* what)
+{
+	if (t_depth == 0 || t_checking) { return; }
+	t_checking = true;
+
+	void* frames[MaxFrames];
+	const int frameCount = backtrace(frames, MaxFrames);
+
+	// FNV-1a of what was called, and from where
+	auto hash = std::uint64_t{0xcbf29ce484222325};
+	const auto mix = [&hash](std::uintptr_t value) { hash = (hash ^ value) * 0x100000001b3; };
+	mix(reinterpret_cast<std::uintptr_t>(what));
+	for (int f = SkippedFrames; f < std::min(frameCount, SkippedFrames + SiteFrames); ++f)
+	{
+		mix(reinterpret_cast<std::uintptr_t>(frames[f]));
+	}
+
+	bool first = false;
+	{
+		const auto lock = std::lock_guard{s_mutex};
+		const auto end = s_sites + s_siteCount;
+		const auto site = std::find_if(s_sites, end, [hash](const Site& s) { return s.hash == hash; });
+		if (site != end) { ++site->count; }
+		else if (s_siteCount < MaxSites)
+		{
+			auto& added = s_sites[s_siteCount++];
+			added.what = what;
+			added.hash = hash;
+			added.frameCount = frameCount;
+			std::copy_n(frames, frameCount, added.frames);
+			added.count = 1;
+			first = true;
+		}
+	}
+
+	if (first)
+	{
+		fprintf(stderr, "Realtime violation: %s on an audio thread\n", what);
+		backtrace_symbols_fd(frames + SkippedFrames, std::max(frameCount - SkippedFrames, 0), STDERR_FILENO);
+	}
+
+	t_checking = false;
+}
+
+
+
+
+void RealtimeChecker::report()
+{
+	const auto lock = std::lock_guard{s_mutex};
+	if (s_siteCount == 0)
+	{
+		fprintf(stderr, "No realtime violations on the audio threads\n");
+		return;
+	}
+
+	auto sites = std::vector<const Site*>{};
+	for (std::size_t s = 0; s < s_siteCount; ++s) { sites.push_back(&s_sites[s]); }
+	std::sort(sites.begin(), sites.end(), [](const Site* a, const Site* b) { return a->count > b->count; });
+
+	fprintf(stderr, "Realtime violations on the audio threads, by call site:\n");
+	for (const auto site : sites)
+	{
+		fprintf(stderr, "\n%llu x %s\n", static_cast<unsigned long long>(site->count), site->what);
+		backtrace_symbols_fd(site->frames + SkippedFrames, std::max(site->frameCount - SkippedFrames, 0),
+			STDERR_FILENO);
+	}
+}
+
+
+} // namespace lmms
+
+
+
+
+// The checked functions replace the ones of the C and C++ libraries, for the
+// whole process including the plugins, and forward to them
+
+namespace
+{
+
+//! The function called @p name that this one replaces. It's looked up on the
+//! first call, without a function static, since those can lock.
+template<typename Fn>
+Fn nextSymbol(std::atomic<Fn>& fn, const char* name)
+{
+	Fn result = fn.load(std::memory_order_relaxed);
+	if (!result)
+	{
+		result = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+		fn.store(result, std::memory_order_relaxed);
+	}
+	return result;
+}
+
+std::atomic<int (*)(pthread_mutex_t*)> s_pthreadMutexLock{nullptr};
+std::atomic<ssize_t (*)(int, void*, size_t)> s_read{nullptr};
+std::atomic<ssize_t (*)(int, const void*, size_t)> s_write{nullptr};
+std::atomic<int (*)(const char*, int, ...)> s_open{nullptr};
+std::atomic<FILE* (*)(const char*, const char*)> s_fopen{nullptr};
+std::atomic<int (*)(const struct timespec*, struct timespec*)> s_nanosleep{nullptr};
+std::atomic<int (*)(useconds_t)> s_usleep{nullptr};
+std::atomic<long (*)(long, ...)> s_syscall{nullptr};
+
+void* checkedNew(std::size_t size, const char* what)
+{
+	lmms::RealtimeChecker::check(what);
+	return std::malloc(size ? size : 1);
+}
+
+} // namespace
+
+extern "C"
+{
+
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+	lmms::RealtimeChecker::check("pthread_mutex_lock");
+	return nextSymbol(s_pthreadMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+ssize_t read(int fd, void* buffer, size_t count)
+{
+	lmms::RealtimeChecker::check("read");
+	return nextSymbol(s_read, "read")(fd, buffer, count);
+}
+
+ssize_t write(int fd, const void* buffer, size_t count)
+{
+	lmms::RealtimeChecker::check("write");
+	return nextSymbol(s_write, "write")(fd, buffer, count);
+}
+
+int open(const char* path, int flags, ...)
+{
+	lmms::RealtimeChecker::check("open");
+
+	// the mode is only passed when creating a file
+	mode_t mode = 0;
+#ifdef O_TMPFILE
+	if (flags & (O_CREAT | O_TMPFILE))
+#else
+	if (flags & O_CREAT)
+#endif
+	{
+		va_list args;
+		va_start(args, flags);
+		mode = va_arg(args, mode_t);
+		va_end(args);
+	}
+	return nextSymbol(s_open, "open")(path, flags, mode);
+}
+
+FILE* fopen(const char* path, const char* mode)
+{
+	lmms::RealtimeChecker::check("fopen");
+	return nextSymbol(s_fopen, "fopen")(path, mode);
+}
+
+int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+	lmms::RealtimeChecker::check("nanosleep");
+	return nextSymbol(s_nanosleep, "nanosleep")(duration, remaining);
+}
+
+int usleep(useconds_t microseconds)
+{
+	lmms::RealtimeChecker::check("usleep");
+	return nextSymbol(s_usleep, "usleep")(microseconds);
+}
+
+// QMutex and QWaitCondition wait in futex calls through this
+long syscall(long number, ...)
+{
+	lmms::RealtimeChecker::check("syscall");
+
+	// no system call takes more than six arguments
+	va_list args;
+	va_start(args, number);
+	long a[6];
+	for (auto& arg : a) { arg = va_arg(args, long); }
+	va_end(args);
+	return nextSymbol(s_syscall, "syscall")(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+
+} // extern "C"
+
+void* operator new(std::size_t size)
+{
+	if (void* p = checkedNew(size, "operator new")) { return p; }
+	throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* p = checkedNew(size, "operator new[]")) { return p; }
+	throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return checkedNew(size, "operator new");
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return checkedNew(size, "operator new[]");
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (ptr) { lmms::RealtimeChecker::check("operator delete"); }
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	if (ptr) { lmms::RealtimeChecker::check("operator delete[]"); }
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	operator delete[](ptr);
+}
+
+#endif // LMMS_DEBUG_REALTIME
@@ -35,6 +35,9 @@
 
 #include "BufferManager.h"
 #include "AudioEngine.h"
+#include "AudioEngineTracer.h"
+#include "AudioEngineWorkerThread.h"
+#include "ConfigManager.h"
 #include "Engine.h"
 #include "Song.h"
 
@@ -48,6 +51,14 @@
 #include <sys/un.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#if __SSE__
+#include <xmmintrin.h>
+#endif
+
 #ifdef LMMS_BUILD_WIN32
 
 namespace {
@@ -196,7 +207,14 @@ RemotePlugin::~RemotePlugin()
 
 	if( m_failed == false )
 	{
-		if( isRunning() )
+		if( m_host )
+		{
+			// only our client quits, the process goes on with the others
+			lock();
+			sendMessage( IdQuit );
+			unlock();
+		}
+		else if( isRunning() )
 		{
 			lock();
 			sendMessage( IdQuit );
@@ -264,6 +282,8 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 	// (e.g. 32-bit VST plugins on Windows)
 	m_watcher.wait();
 	m_watcher.reset();
+	// the counts are compared with the ones of the new process
+	resetMessageCounts();
 
 	QStringList args;
 #ifdef SYNC_WITH_SHM_FIFO
@@ -286,6 +306,46 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 	qDebug() << exec << args;
 #endif
 
+	startCommunication( waitForInitDoneMsg );
+	unlock();
+
+	return failed();
+}
+
+
+
+
+#ifndef SYNC_WITH_SHM_FIFO
+bool RemotePlugin::attach( const std::shared_ptr<RemotePlugin> & host, bool waitForInitDoneMsg )
+{
+	lock();
+	if( !host || host->failed() || !host->isRunning() )
+	{
+		m_failed = true;
+		invalidate();
+		unlock();
+		return failed();
+	}
+	m_failed = false;
+	m_host = host;
+	resetMessageCounts();
+
+	host->lock();
+	host->sendMessage( message( IdAttachClient ).addString( m_socketFile.toStdString() ) );
+	host->unlock();
+
+	startCommunication( waitForInitDoneMsg );
+	unlock();
+
+	return failed();
+}
+#endif
+
+
+
+
+void RemotePlugin::startCommunication( bool waitForInitDoneMsg )
+{
 #ifndef SYNC_WITH_SHM_FIFO
 	struct pollfd pollin;
 	pollin.fd = m_server;
@@ -310,16 +370,19 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 	}
 #endif
 
+	m_pipelined = ConfigManager::inst()->value("audioengine", "pipelinedremoteplugins").toInt();
+	m_pendingRequest = false;
+
 	sendMessage(message(IdSyncKey).addString(Engine::getSong()->syncKey()));
 	resizeSharedProcessingMemory();
+#ifdef LMMS_BUILD_LINUX
+	createProcessingSync();
+#endif
 
 	if( waitForInitDoneMsg )
 	{
 		waitForInitDone();
 	}
-	unlock();
-
-	return failed();
 }
 
 
@@ -327,6 +390,7 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 
 bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf )
 {
+	AudioEngineTracer::Scope traceScope( "RemotePlugin::process" );
 	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
 
 	if( m_failed || !isRunning() )
@@ -357,6 +421,112 @@ bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf
 		return false;
 	}
 
+	lock();
+#ifdef LMMS_BUILD_LINUX
+	// a client that overran its deadline isn't handed anything else until it
+	// finished that period, and whatever it output by then is too late
+	if( m_overrun )
+	{
+		if( !isProcessingSyncDone() )
+		{
+			unlock();
+			if( _out_buf != nullptr )
+			{
+				BufferManager::clear( _out_buf, frames );
+			}
+			return false;
+		}
+		fetchMessagesSentWhileProcessing();
+		m_overrun = false;
+		m_pendingRequest = false;
+	}
+#endif
+
+	// in the pipelined mode the client may still be working on the last
+	// period, and we need its output
+	bool collect = m_pendingRequest;
+#ifdef LMMS_BUILD_LINUX
+	if( m_pendingRequest && !waitForProcessingSync() )
+	{
+		m_pendingRequest = false;
+		unlock();
+		if( _out_buf != nullptr )
+		{
+			BufferManager::clear( _out_buf, frames );
+		}
+		return false;
+	}
+#endif
+	m_pendingRequest = false;
+
+	const bool wait = !m_failed && _out_buf != nullptr && m_outputCount > 0;
+	const bool inSync = wait && isProcessingInSync();
+	const bool pipelined = inSync && isPipelined();
+	if( pipelined )
+	{
+		if( collect )
+		{
+			readOutput( _out_buf, frames );
+		}
+		else
+		{
+			BufferManager::clear( _out_buf, frames );
+		}
+	}
+
+	if( wait )
+	{
+		prepareProcessing();
+	}
+	writeInput( _in_buf, frames );
+#ifdef LMMS_BUILD_LINUX
+	if( inSync )
+	{
+		RemoteProcessingSync::store( m_processingSync->requested, ++m_processingRequests );
+	}
+#endif
+	sendMessage( IdStartProcessing );
+
+	if( !wait )
+	{
+		unlock();
+		return false;
+	}
+
+	if( pipelined )
+	{
+		// collected in the next period, we go on with other work meanwhile
+		m_pendingRequest = true;
+		unlock();
+		return true;
+	}
+
+#ifdef LMMS_BUILD_LINUX
+	if( inSync )
+	{
+		if( !waitForProcessingSync() )
+		{
+			unlock();
+			BufferManager::clear( _out_buf, frames );
+			return false;
+		}
+	}
+	else
+#endif
+	{
+		waitForMessage( IdProcessingDone );
+	}
+	unlock();
+
+	readOutput( _out_buf, frames );
+	return true;
+}
+
+
+
+
+void RemotePlugin::writeInput( const sampleFrame * _in_buf, const fpp_t frames )
+{
 	memset( m_audioBuffer.get(), 0, m_audioBufferSize );
 
 	ch_cnt_t inputs = std::min<ch_cnt_t>(m_inputCount, DEFAULT_CHANNELS);
@@ -390,19 +560,13 @@ bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf
 			}
 		}
 	}
+}
 
-	lock();
-	sendMessage( IdStartProcessing );
 
-	if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
-	{
-		unlock();
-		return false;
-	}
 
-	waitForMessage( IdProcessingDone );
-	unlock();
 
+void RemotePlugin::readOutput( sampleFrame * _out_buf, const fpp_t frames )
+{
 	const ch_cnt_t outputs = std::min<ch_cnt_t>(m_outputCount,
 							DEFAULT_CHANNELS);
 	if( m_splitChannels )
@@ -436,8 +600,34 @@ bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf
 			}
 		}
 	}
+}
 
-	return true;
+
+
+
+bool RemotePlugin::isProcessingInSync() const
+{
+#ifdef LMMS_BUILD_LINUX
+	return m_processingSync && RemoteProcessingSync::load( m_processingSync->clientReady ) != 0;
+#else
+	return false;
+#endif
+}
+
+
+
+
+bool RemotePlugin::isPipelined() const
+{
+	return m_pipelined || Engine::audioEngine()->qualityGovernor().pipelineRemotePlugins();
+}
+
+
+
+
+f_cnt_t RemotePlugin::latency() const
+{
+	return isPipelined() && isProcessingInSync() ? Engine::audioEngine()->framesPerPeriod() : 0;
 }
 
 
@@ -494,6 +684,122 @@ void RemotePlugin::resizeSharedProcessingMemory()
 
 
 
+#ifdef LMMS_BUILD_LINUX
+// pause instructions to spin for, while waiting for the remote process, with
+// the hybrid wait policy - on the order of a hundred microseconds
+static constexpr int ProcessingSyncSpins = 2048;
+
+
+
+
+void RemotePlugin::createProcessingSync()
+{
+	try
+	{
+		m_processingSync.create(QUuid::createUuid().toString().toStdString());
+	}
+	catch (const std::runtime_error& error)
+	{
+		// then we wait for IdProcessingDone messages
+		qWarning() << "Failed to allocate shared processing sync:" << error.what();
+		m_processingSync.detach();
+		return;
+	}
+	*m_processingSync = RemoteProcessingSync{};
+	m_processingRequests = 0;
+	m_overrun = false;
+	sendMessage(message(IdChangeProcessingSyncKey).addString(m_processingSync.key()));
+}
+
+
+
+
+bool RemotePlugin::waitForProcessingSync()
+{
+	auto& sync = *m_processingSync;
+	const int32_t request = m_processingRequests;
+
+	using namespace std::chrono;
+	const auto periodLength = duration<double>(Engine::audioEngine()->framesPerPeriod()
+		/ static_cast<double>(Engine::audioEngine()->processingSampleRate()));
+	const auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(periodLength * m_deadline);
+
+	// most plugins take less than a period's time to process one, so spinning
+	// for a moment often spares us going to sleep, unless the worker threads
+	// were told not to spin either
+	auto spins = 0;
+	switch (AudioEngineWorkerThread::waitPolicy())
+	{
+		case AudioEngineWorkerThread::WaitPolicy::Spin: spins = std::numeric_limits<int>::max(); break;
+		case AudioEngineWorkerThread::WaitPolicy::Hybrid: spins = ProcessingSyncSpins; break;
+		case AudioEngineWorkerThread::WaitPolicy::Park: break;
+	}
+	for (auto i = 0; i < spins && RemoteProcessingSync::load(sync.done) != request && !isInvalid(); ++i)
+	{
+#ifdef __SSE__
+		_mm_pause();
+#endif
+		// looking at the clock costs more than a pause
+		if (i % 256 == 255 && steady_clock::now() >= deadline) { break; }
+	}
+
+	auto inTime = true;
+	while (!isInvalid())
+	{
+		RemoteProcessingSync::store(sync.hostWaiting, 1);
+		const int32_t done = RemoteProcessingSync::load(sync.done);
+		if (done == request) { break; }
+
+		const auto left = duration_cast<microseconds>(deadline - steady_clock::now()).count();
+		if (left <= 0)
+		{
+			inTime = false;
+			break;
+		}
+		// at most until the deadline, and wake up now and then in case the
+		// process died
+		RemoteProcessingSync::wait(sync.done, done, std::min<long>(left, 20000));
+	}
+	RemoteProcessingSync::store(sync.hostWaiting, 0);
+
+	if (!inTime)
+	{
+		// the client still has the shared memory, we leave it alone till it's
+		// done and keep the rest of the mix on time meanwhile
+		m_overrun = true;
+		++m_overruns;
+		return false;
+	}
+
+	fetchMessagesSentWhileProcessing();
+	return true;
+}
+
+
+
+
+bool RemotePlugin::isProcessingSyncDone() const
+{
+	return isInvalid() || RemoteProcessingSync::load(m_processingSync->done) == m_processingRequests;
+}
+
+
+
+
+void RemotePlugin::fetchMessagesSentWhileProcessing()
+{
+	// what the client sent while processing, e.g. parameter changes, is
+	// handled before the next period like when waiting for IdProcessingDone
+	while (!isInvalid() && receivedMessages() < RemoteProcessingSync::load(m_processingSync->clientMessages))
+	{
+		fetchAndProcessNextMessage();
+	}
+}
+#endif // LMMS_BUILD_LINUX
+
+
+
+
 void RemotePlugin::processFinished( int exitCode,
 					QProcess::ExitStatus exitStatus )
 {
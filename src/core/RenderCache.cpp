@@ -0,0 +1,114 @@
+/*
+ * RenderCache.cpp - keeps synthesised sounds that only depend on their parameters
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RenderCache.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SampleBuffer.h"
+
+namespace lmms {
+
+namespace {
+
+struct Entry
+{
+	std::uint64_t hash;
+	std::shared_ptr<const SampleBuffer> buffer;
+};
+
+std::mutex s_mutex;
+//! The most recently used first
+std::list<Entry> s_entries;
+std::unordered_map<std::uint64_t, std::list<Entry>::iterator> s_index;
+std::size_t s_bytes = 0;
+
+auto bytesOf(const SampleBuffer& buffer) -> std::size_t
+{
+	return buffer.size() * sizeof(sampleFrame);
+}
+
+} // namespace
+
+auto RenderCache::get(const Key& key) -> std::shared_ptr<const SampleBuffer>
+{
+	const auto lock = std::lock_guard{s_mutex};
+	const auto it = s_index.find(key.hash());
+	if (it == s_index.end()) { return nullptr; }
+
+	s_entries.splice(s_entries.begin(), s_entries, it->second);
+	return it->second->buffer;
+}
+
+void RenderCache::put(const Key& key, std::shared_ptr<const SampleBuffer> buffer)
+{
+	if (!buffer || bytesOf(*buffer) > MaxBytes) { return; }
+
+	// freed after unlocking, so the others don't have to wait for it
+	auto dropped = std::vector<std::shared_ptr<const SampleBuffer>>{};
+
+	const auto lock = std::lock_guard{s_mutex};
+	if (const auto it = s_index.find(key.hash()); it != s_index.end())
+	{
+		s_bytes -= bytesOf(*it->second->buffer);
+		dropped.push_back(std::move(it->second->buffer));
+		s_entries.erase(it->second);
+		s_index.erase(it);
+	}
+
+	s_bytes += bytesOf(*buffer);
+	s_entries.push_front(Entry{key.hash(), std::move(buffer)});
+	s_index.emplace(key.hash(), s_entries.begin());
+
+	while (s_bytes > MaxBytes)
+	{
+		auto& oldest = s_entries.back();
+		s_bytes -= bytesOf(*oldest.buffer);
+		s_index.erase(oldest.hash);
+		dropped.push_back(std::move(oldest.buffer));
+		s_entries.pop_back();
+	}
+}
+
+auto RenderCache::bytes() -> std::size_t
+{
+	const auto lock = std::lock_guard{s_mutex};
+	return s_bytes;
+}
+
+void RenderCache::clear()
+{
+	auto dropped = std::list<Entry>{};
+
+	const auto lock = std::lock_guard{s_mutex};
+	dropped.swap(s_entries);
+	s_index.clear();
+	s_bytes = 0;
+}
+
+} // namespace lmms
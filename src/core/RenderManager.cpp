@@ -23,11 +23,17 @@
  */
 
 #include <QDir>
+#include <QFile>
+#include <QFileInfo>
 
 #include "RenderManager.h"
 
+#include "AudioPort.h"
+#include "InstrumentTrack.h"
 #include "PatternStore.h"
+#include "SampleTrack.h"
 #include "Song.h"
+#include "TrackFreezer.h"
 
 
 namespace lmms
@@ -58,78 +64,75 @@ void RenderManager::abortProcessing()
 {
 	if ( m_activeRenderer ) {
 		disconnect( m_activeRenderer.get(), SIGNAL(finished()),
-				this, SLOT(renderNextTrack()));
+				this, SLOT(renderFinished()));
 		m_activeRenderer->abortProcessing();
 	}
-	restoreMutedState();
+	finishStems(true);
 }
 
-// Called to render each new track when rendering tracks individually.
-void RenderManager::renderNextTrack()
+void RenderManager::renderFinished()
 {
+	finishStems(false);
 	m_activeRenderer.reset();
-
-	if (m_tracksToRender.empty())
-	{
-		// nothing left to render
-		restoreMutedState();
-		emit finished();
-	}
-	else
-	{
-		// pop the next track from our rendering queue
-		Track* renderTrack = m_tracksToRender.back();
-		m_tracksToRender.pop_back();
-
-		// mute everything but the track we are about to render
-		for (auto track : m_unmuted)
-		{
-			track->setMuted(track != renderTrack);
-		}
-
-		// for multi-render, prefix each output file with a different number
-		int trackNum = m_tracksToRender.size() + 1;
-
-		render( pathForTrack(renderTrack, trackNum) );
-	}
+	emit finished();
 }
 
 // Render the song into individual tracks
 void RenderManager::renderTracks()
 {
-	const TrackContainer::TrackList& tl = Engine::getSong()->tracks();
-
-	// find all currently unnmuted tracks -- we want to render these.
-	for (const auto& tk : tl)
+	std::vector<Track*> tracks;
+	const auto addUnmuted = [&tracks](const TrackContainer::TrackList& tl)
 	{
-		Track::Type type = tk->type();
-
-		// Don't render automation tracks
-		if ( tk->isMuted() == false &&
-				( type == Track::Type::Instrument || type == Track::Type::Sample ) )
+		for (const auto& tk : tl)
 		{
-			m_unmuted.push_back(tk);
+			Track::Type type = tk->type();
+
+			// Don't render automation tracks
+			if ( tk->isMuted() == false &&
+					( type == Track::Type::Instrument || type == Track::Type::Sample ) )
+			{
+				tracks.push_back(tk);
+			}
 		}
-	}
-
-	const TrackContainer::TrackList& t2 = Engine::patternStore()->tracks();
-	for (const auto& tk : t2)
+	};
+	addUnmuted(Engine::getSong()->tracks());
+	addUnmuted(Engine::patternStore()->tracks());
+
+	// rather than rendering the song once per track with all others muted,
+	// every track's port writes what it sends to the mixer to its own file
+	const auto encoderFactory = ProjectRenderer::fileEncodeDevices[static_cast<std::size_t>(m_format)].m_getDevInst;
+	for (std::size_t i = 0; encoderFactory && i < tracks.size(); ++i)
 	{
-		Track::Type type = tk->type();
-
-		// Don't render automation tracks
-		if ( tk->isMuted() == false &&
-				( type == Track::Type::Instrument || type == Track::Type::Sample ) )
+		Track* track = tracks[i];
+		AudioPort* port = track->type() == Track::Type::Instrument
+			? static_cast<InstrumentTrack*>(track)->audioPort()
+			: static_cast<SampleTrack*>(track)->audioPort();
+
+		// a frozen track plays its cache through another port
+		if (track->freezer() && track->freezer()->audioPort()) { port = track->freezer()->audioPort(); }
+
+		bool successful = false;
+		auto file = std::unique_ptr<AudioFileDevice>(encoderFactory(
+			pathForTrack(track, i + 1), m_outputSettings, DEFAULT_CHANNELS, Engine::audioEngine(), successful));
+		if (!successful)
 		{
-			m_unmuted.push_back(tk);
+			qDebug( "Renderer failed to acquire a file device for a track!" );
+			continue;
 		}
+
+		if (m_loudnessReport) { file->enableLoudnessReport(); }
+		file->startEncoder();
+		port->setStemFile(file.get());
+		m_stems.push_back(Stem{port, std::move(file)});
 	}
 
-	// copy the list of unmuted tracks into our rendering queue.
-	// we need to remember which tracks were unmuted to restore state at the end.
-	m_tracksToRender = m_unmuted;
+	const QString extension = ProjectRenderer::getFileExtensionFromFormat( m_format );
+	render( QDir(m_outputPath).filePath(QString("0_master%1").arg(extension)) );
+}
 
-	renderNextTrack();
+void RenderManager::addFormat(ProjectRenderer::ExportFileFormat fmt)
+{
+	if (fmt != m_format) { m_copyFormats.push_back(fmt); }
 }
 
 // Render the song into a single track
@@ -148,33 +151,48 @@ void RenderManager::render(QString outputPath)
 
 	if( m_activeRenderer->isReady() )
 	{
+		m_activeRenderer->setRealtime(m_realtime);
+		m_activeRenderer->setLoudnessReport(m_loudnessReport);
+		for (const auto format : m_copyFormats)
+		{
+			const QString copyPath = QFileInfo(outputPath).dir().filePath(QFileInfo(outputPath).completeBaseName()
+				+ ProjectRenderer::getFileExtensionFromFormat(format));
+			if (!m_activeRenderer->addOutput(format, copyPath))
+			{
+				qDebug( "Renderer failed to acquire a file device for %s!", qPrintable(copyPath) );
+			}
+		}
+
 		// pass progress signals through
 		connect( m_activeRenderer.get(), SIGNAL(progressChanged(int)),
 				this, SIGNAL(progressChanged(int)));
 
-		// when it is finished, render the next track.
-		// if we have not queued any tracks, renderNextTrack will just clean up
 		connect( m_activeRenderer.get(), SIGNAL(finished()),
-				this, SLOT(renderNextTrack()));
+				this, SLOT(renderFinished()));
 
 		m_activeRenderer->startProcessing();
 	}
 	else
 	{
 		qDebug( "Renderer failed to acquire a file device!" );
-		renderNextTrack();
+		renderFinished();
 	}
 }
 
-// Unmute all tracks that were muted while rendering tracks
-void RenderManager::restoreMutedState()
+void RenderManager::finishStems(bool remove)
 {
-	while (!m_unmuted.empty())
+	for (auto& stem : m_stems)
 	{
-		Track* restoreTrack = m_unmuted.back();
-		m_unmuted.pop_back();
-		restoreTrack->setMuted( false );
+		stem.port->setStemFile(nullptr);
+		stem.file->finishEncoder();
+		if (!remove && m_loudnessReport) { stem.file->writeLoudnessReport(); }
+		const QString file = stem.file->outputFile();
+
+		// closes the file
+		stem.file.reset();
+		if (remove) { QFile::remove(file); }
 	}
+	m_stems.clear();
 }
 
 // Determine the output path for a track when rendering tracks individually
@@ -192,16 +210,8 @@ void RenderManager::updateConsoleProgress()
 	if ( m_activeRenderer )
 	{
 		m_activeRenderer->updateConsoleProgress();
-
-		int totalNum = m_unmuted.size();
-		if ( totalNum > 0 )
-		{
-			// we are rendering multiple tracks, append a track counter to the output
-			int trackNum = totalNum - m_tracksToRender.size();
-			fprintf( stderr, "(%d/%d)", trackNum, totalNum );
-		}
 	}
 }
 
 
-} // namespace lmms
\ No newline at end of file
+} // namespace lmms
@@ -65,8 +65,20 @@ Sample::Sample(std::shared_ptr<const SampleBuffer> buffer)
 {
 }
 
+Sample::Sample(std::shared_ptr<SampleStream> stream)
+	: m_buffer(stream->head())
+	, m_stream(std::move(stream))
+	, m_startFrame(0)
+	, m_endFrame(m_stream->size())
+	, m_loopStartFrame(0)
+	, m_loopEndFrame(m_stream->size())
+{
+}
+
 Sample::Sample(const Sample& other)
 	: m_buffer(other.m_buffer)
+	// every player needs its own reader
+	, m_stream(other.m_stream ? std::make_shared<SampleStream>(*other.m_stream) : nullptr)
 	, m_startFrame(other.startFrame())
 	, m_endFrame(other.endFrame())
 	, m_loopStartFrame(other.loopStartFrame())
@@ -79,6 +91,7 @@ Sample::Sample(const Sample& other)
 
 Sample::Sample(Sample&& other)
 	: m_buffer(std::move(other.m_buffer))
+	, m_stream(std::move(other.m_stream))
 	, m_startFrame(other.startFrame())
 	, m_endFrame(other.endFrame())
 	, m_loopStartFrame(other.loopStartFrame())
@@ -92,6 +105,7 @@ Sample::Sample(Sample&& other)
 auto Sample::operator=(const Sample& other) -> Sample&
 {
 	m_buffer = other.m_buffer;
+	m_stream = other.m_stream ? std::make_shared<SampleStream>(*other.m_stream) : nullptr;
 	m_startFrame = other.startFrame();
 	m_endFrame = other.endFrame();
 	m_loopStartFrame = other.loopStartFrame();
@@ -106,6 +120,7 @@ auto Sample::operator=(const Sample& other) -> Sample&
 auto Sample::operator=(Sample&& other) -> Sample&
 {
 	m_buffer = std::move(other.m_buffer);
+	m_stream = std::move(other.m_stream);
 	m_startFrame = other.startFrame();
 	m_endFrame = other.endFrame();
 	m_loopStartFrame = other.loopStartFrame();
@@ -121,13 +136,25 @@ bool Sample::play(sampleFrame* dst, PlaybackState* state, int numFrames, float d
 {
 	if (numFrames <= 0 || desiredFrequency <= 0) { return false; }
 
+	// at the sample's own pitch, a buffer converted to the engine's rate in advance can be copied
+	if (loopMode == Loop::Off && !m_stream && !state->m_varyingPitch
+		&& typeInfo<float>::isEqual(frequency(), desiredFrequency))
+	{
+		if (const auto resampled = m_buffer->resampled(Engine::audioEngine()->processingSampleRate()))
+		{
+			return playResampled(dst, state, numFrames, *resampled);
+		}
+	}
+
 	auto resampleRatio = static_cast<float>(Engine::audioEngine()->processingSampleRate()) / m_buffer->sampleRate();
 	resampleRatio *= frequency() / desiredFrequency;
 
 	auto playBuffer = std::vector<sampleFrame>(numFrames / resampleRatio);
-	if (!typeInfo<float>::isEqual(resampleRatio, 1.0f))
+	// the built-in modes always need to look ahead, even when not changing the rate
+	const auto interpolationMode = state->resampler().interpolationMode();
+	if (!typeInfo<float>::isEqual(resampleRatio, 1.0f) || interpolationMode > SRC_LINEAR)
 	{
-		playBuffer.resize(playBuffer.size() + s_interpolationMargins[state->resampler().interpolationMode()]);
+		playBuffer.resize(playBuffer.size() + s_interpolationMargins[interpolationMode]);
 	}
 
 	const auto start = startFrame();
@@ -172,6 +199,39 @@ bool Sample::play(sampleFrame* dst, PlaybackState* state, int numFrames, float d
 	return true;
 }
 
+auto Sample::playResampled(sampleFrame* dst, PlaybackState* state, int numFrames, const SampleBuffer& resampled) -> bool
+{
+	const auto start = startFrame();
+	const auto end = endFrame();
+	state->m_frameIndex = std::clamp(state->m_frameIndex, start, end);
+	if (state->m_frameIndex == end) { return false; }
+
+	// the frame index is in frames of the original buffer, which rarely map to whole frames of the
+	// resampled one, so carry on from the exact position unless someone moved the frame index
+	const auto ratio = static_cast<double>(resampled.sampleRate()) / m_buffer->sampleRate();
+	if (state->m_resampledFrameIndex < 0 || state->m_frameIndex != state->m_resampledFrom)
+	{
+		state->m_resampledFrameIndex = static_cast<f_cnt_t>(std::lround(state->m_frameIndex * ratio));
+	}
+
+	const auto resampledEnd = std::min(static_cast<f_cnt_t>(std::lround(end * ratio)), static_cast<f_cnt_t>(resampled.size()));
+	const auto position = state->m_resampledFrameIndex;
+	const auto frames = std::clamp(resampledEnd - position, 0, numFrames);
+
+	reversed() ? std::copy_n(resampled.rbegin() + position, frames, dst)
+			   : std::copy_n(resampled.begin() + position, frames, dst);
+	std::fill_n(dst + frames, numFrames - frames, sampleFrame{0, 0});
+
+	state->m_resampledFrameIndex = position + frames;
+	state->m_frameIndex = frames < numFrames
+		? end
+		: std::min(static_cast<f_cnt_t>(std::lround(state->m_resampledFrameIndex / ratio)), end);
+	state->m_resampledFrom = state->m_frameIndex;
+
+	amplifySampleRange(dst, numFrames);
+	return true;
+}
+
 auto Sample::sampleDuration() const -> std::chrono::milliseconds
 {
 	const auto numFrames = endFrame() - startFrame();
@@ -187,6 +247,11 @@ void Sample::setAllPointFrames(int startFrame, int endFrame, int loopStartFrame,
 	setLoopEndFrame(loopEndFrame);
 }
 
+void Sample::prefetch(f_cnt_t frame)
+{
+	if (m_stream) { m_stream->prefetch(reversed() ? m_stream->size() - frame - 1 : frame, reversed()); }
+}
+
 void Sample::playSampleRange(PlaybackState* state, sampleFrame* dst, size_t numFrames) const
 {
 	auto framesToCopy = 0;
@@ -206,12 +271,34 @@ void Sample::playSampleRange(PlaybackState* state, sampleFrame* dst, size_t numF
 
 void Sample::copyBufferForward(sampleFrame* dst, int initialPosition, int advanceAmount) const
 {
+	if (m_stream)
+	{
+		if (reversed())
+		{
+			m_stream->read(dst, m_stream->size() - initialPosition - advanceAmount, advanceAmount, true);
+			std::reverse(dst, dst + advanceAmount);
+		}
+		else { m_stream->read(dst, initialPosition, advanceAmount); }
+		return;
+	}
+
 	reversed() ? std::copy_n(m_buffer->rbegin() + initialPosition, advanceAmount, dst)
 			   : std::copy_n(m_buffer->begin() + initialPosition, advanceAmount, dst);
 }
 
 void Sample::copyBufferBackward(sampleFrame* dst, int initialPosition, int advanceAmount) const
 {
+	if (m_stream)
+	{
+		if (reversed()) { m_stream->read(dst, m_stream->size() - initialPosition, advanceAmount); }
+		else
+		{
+			m_stream->read(dst, initialPosition - advanceAmount, advanceAmount, true);
+			std::reverse(dst, dst + advanceAmount);
+		}
+		return;
+	}
+
 	reversed() ? std::reverse_copy(
 		m_buffer->rbegin() + initialPosition - advanceAmount, m_buffer->rbegin() + initialPosition, dst)
 			   : std::reverse_copy(
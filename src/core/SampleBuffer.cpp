@@ -23,18 +23,87 @@
  */
 
 #include "SampleBuffer.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "MemoryHelper.h"
 #include "PathUtil.h"
 #include "SampleDecoder.h"
+#include "SamplePeaks.h"
 #include "lmms_basics.h"
 
 namespace lmms {
 
+namespace {
+
+//! Shorter buffers are drawn from their frames quickly enough
+constexpr std::size_t MinimumPeakFrames = std::size_t{1} << 16;
+
+void prepareFrames(std::vector<sampleFrame>& data)
+{
+	MemoryHelper::prepareLargeBuffer(data.data(), data.size() * sizeof(sampleFrame));
+}
+
+} // namespace
+
+struct SampleBuffer::PeakState
+{
+	//! Held while the frames are read, cancelled before they go away
+	std::mutex mutex;
+	bool cancelled = false;
+	std::atomic<const SamplePeaks*> peaks = nullptr;
+	std::unique_ptr<const SamplePeaks> ownedPeaks;
+};
+
+class SampleBuffer::PeakTask : public QRunnable
+{
+public:
+	PeakTask(std::shared_ptr<PeakState> state, const sampleFrame* frames, std::size_t size)
+		: m_state(std::move(state))
+		, m_frames(frames)
+		, m_size(size)
+	{
+	}
+
+	void run() override
+	{
+		constexpr auto ChunkFrames = std::size_t{1} << 16;
+
+		auto peaks = std::make_unique<SamplePeaks>();
+		auto chunk = std::vector<sampleFrame>(ChunkFrames);
+		for (std::size_t start = 0; start < m_size; start += ChunkFrames)
+		{
+			const auto count = std::min(ChunkFrames, m_size - start);
+			{
+				// copy a bit at a time, so the buffer can go away in between
+				const auto lock = std::lock_guard{m_state->mutex};
+				if (m_state->cancelled) { return; }
+				std::copy_n(m_frames + start, count, chunk.begin());
+			}
+			peaks->append(chunk.data(), count);
+		}
+		peaks->finish();
+
+		const auto lock = std::lock_guard{m_state->mutex};
+		m_state->ownedPeaks = std::move(peaks);
+		m_state->peaks.store(m_state->ownedPeaks.get(), std::memory_order_release);
+	}
+
+private:
+	std::shared_ptr<PeakState> m_state;
+	const sampleFrame* m_frames;
+	std::size_t m_size;
+};
+
 SampleBuffer::SampleBuffer(const sampleFrame* data, int numFrames, int sampleRate)
 	: m_data(data, data + numFrames)
 	, m_sampleRate(sampleRate)
 {
+	prepareFrames(m_data);
 }
 
 SampleBuffer::SampleBuffer(const QString& audioFile)
@@ -48,6 +117,7 @@ SampleBuffer::SampleBuffer(const QString& audioFile)
 		m_data = std::move(data);
 		m_sampleRate = sampleRate;
 		m_audioFile = PathUtil::toShortestRelative(audioFile);
+		prepareFrames(m_data);
 		return;
 	}
 
@@ -59,15 +129,38 @@ SampleBuffer::SampleBuffer(const QString& base64, int sampleRate)
 	: m_sampleRate(sampleRate)
 {
 	// TODO: Replace with non-Qt equivalent
-	const auto bytes = QByteArray::fromBase64(base64.toUtf8());
+	// Base64 is all ASCII, converting it to Latin-1 is cheaper than to UTF-8
+	const auto bytes = QByteArray::fromBase64(base64.toLatin1());
 	m_data.resize(bytes.size() / sizeof(sampleFrame));
 	std::memcpy(reinterpret_cast<char*>(m_data.data()), bytes, m_data.size() * sizeof(sampleFrame));
+	prepareFrames(m_data);
 }
 
-SampleBuffer::SampleBuffer(std::vector<sampleFrame> data, int sampleRate)
+SampleBuffer::SampleBuffer(std::vector<sampleFrame> data, int sampleRate, const QString& audioFile)
 	: m_data(std::move(data))
+	, m_audioFile(audioFile)
 	, m_sampleRate(sampleRate)
 {
+	prepareFrames(m_data);
+}
+
+SampleBuffer::SampleBuffer(SampleBuffer&& other) noexcept = default;
+
+SampleBuffer::~SampleBuffer()
+{
+	if (m_peaks)
+	{
+		const auto lock = std::lock_guard{m_peaks->mutex};
+		m_peaks->cancelled = true;
+	}
+	MemoryHelper::releaseLargeBuffer(m_data.data(), m_data.size() * sizeof(sampleFrame));
+}
+
+auto SampleBuffer::operator=(SampleBuffer&& other) noexcept -> SampleBuffer&
+{
+	// the frames stay with whatever is summarizing them, they go away with other
+	swap(*this, other);
+	return *this;
 }
 
 void swap(SampleBuffer& first, SampleBuffer& second) noexcept
@@ -76,15 +169,55 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 	swap(first.m_data, second.m_data);
 	swap(first.m_audioFile, second.m_audioFile);
 	swap(first.m_sampleRate, second.m_sampleRate);
+	swap(first.m_resampled, second.m_resampled);
+	swap(first.m_peaks, second.m_peaks);
+	swap(first.m_base64, second.m_base64);
 }
 
 QString SampleBuffer::toBase64() const
 {
-	// TODO: Replace with non-Qt equivalent
-	const auto data = reinterpret_cast<const char*>(m_data.data());
-	const auto size = static_cast<int>(m_data.size() * sizeof(sampleFrame));
-	const auto byteArray = QByteArray{data, size};
-	return byteArray.toBase64();
+	const auto lock = std::lock_guard{m_base64->mutex};
+	if (m_base64->text.isEmpty() && !m_data.empty())
+	{
+		// TODO: Replace with non-Qt equivalent
+		const auto data = reinterpret_cast<const char*>(m_data.data());
+		const auto size = static_cast<int>(m_data.size() * sizeof(sampleFrame));
+		m_base64->text = QByteArray::fromRawData(data, size).toBase64();
+	}
+	return QString::fromLatin1(m_base64->text);
+}
+
+void SampleBuffer::resampleTo(sample_rate_t sampleRate) const
+{
+	const auto lock = std::lock_guard{m_resampled->mutex};
+	if (resampled(sampleRate) || m_data.empty()) { return; }
+
+	const auto ratio = static_cast<double>(sampleRate) / m_sampleRate;
+	auto data = std::vector<sampleFrame>(static_cast<std::size_t>(std::ceil(m_data.size() * ratio)));
+
+	auto srcData = SRC_DATA{};
+	srcData.data_in = &m_data[0][0];
+	srcData.input_frames = static_cast<long>(m_data.size());
+	srcData.data_out = &data[0][0];
+	srcData.output_frames = static_cast<long>(data.size());
+	srcData.src_ratio = ratio;
+	if (src_simple(&srcData, SRC_SINC_MEDIUM_QUALITY, DEFAULT_CHANNELS) != 0) { return; }
+	data.resize(srcData.output_frames_gen);
+
+	auto& version = m_resampled->versions.emplace_back(std::make_unique<const SampleBuffer>(std::move(data), sampleRate));
+	m_resampled->current.store(version.get(), std::memory_order_release);
+}
+
+auto SampleBuffer::peaks() const -> const SamplePeaks*
+{
+	if (m_data.size() < MinimumPeakFrames) { return nullptr; }
+
+	if (!m_peaks)
+	{
+		m_peaks = std::make_shared<PeakState>();
+		QThreadPool::globalInstance()->start(new PeakTask(m_peaks, m_data.data(), m_data.size()));
+	}
+	return m_peaks->peaks.load(std::memory_order_acquire);
 }
 
 auto SampleBuffer::emptyBuffer() -> std::shared_ptr<const SampleBuffer>
@@ -0,0 +1,396 @@
+/*
+ * SampleCache.cpp - shares the sample buffers decoded from the same file
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "PathUtil.h"
+#include "SampleBuffer.h"
+#include "SampleStream.h"
+
+namespace lmms {
+
+namespace {
+
+struct Entry
+{
+	QDateTime modified;
+	qint64 size;
+	std::weak_ptr<const SampleBuffer> buffer;
+	//! Whether some thread is decoding the file right now
+	bool decoding = false;
+};
+
+std::mutex s_mutex;
+std::condition_variable s_decoded;
+QHash<QString, Entry> s_entries;
+
+//! The preloads that are alive, for getEmbedded()
+std::mutex s_embeddedMutex;
+std::condition_variable s_embeddedDecoded;
+std::vector<SampleCache::Preload*> s_preloads;
+
+//! Drops the entries whose buffers are gone, has to be called with s_mutex held
+void removeUnused()
+{
+	for (auto it = s_entries.begin(); it != s_entries.end();)
+	{
+		it = it->buffer.expired() && !it->decoding ? s_entries.erase(it) : std::next(it);
+	}
+}
+
+// bump this whenever the decoders change what they produce
+constexpr std::uint32_t DecodedCacheVersion = 1;
+
+constexpr char DecodedCacheMagic[8] = {'L', 'M', 'M', 'S', 'P', 'C', 'M', ' '};
+
+//! The decoded cache gets trimmed to this size, dropping the oldest files first
+constexpr qint64 MaxDecodedCacheSize = qint64{2} << 30;
+
+//! Followed by the decoded frames
+struct DecodedCacheHeader
+{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t sampleRate;
+	//! When the original file was last modified, in ms since the epoch, and its size
+	std::int64_t modified;
+	std::int64_t size;
+	std::int64_t frames;
+};
+
+auto decodedCacheDir() -> QString
+{
+	return PathUtil::cacheDir() + "/samples";
+}
+
+auto decodedCacheFile(const QString& key) -> QString
+{
+	const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+	return decodedCacheDir() + '/' + QString::fromLatin1(hash) + ".lmmscache";
+}
+
+//! PCM files are read as quickly as their decoded cache would be, and DrumSynth
+//! files are rendered at the engine's sample rate, which the cache doesn't know
+auto isWorthCaching(const QFileInfo& fileInfo) -> bool
+{
+	static const auto s_uncached = QStringList{"wav", "aif", "aiff", "au", "raw", "ds"};
+	return !s_uncached.contains(fileInfo.suffix().toLower());
+}
+
+auto loadDecoded(const QString& audioFile, const QString& key, const QDateTime& modified, qint64 size)
+	-> std::shared_ptr<const SampleBuffer>
+{
+	auto file = QFile{decodedCacheFile(key)};
+	if (!file.open(QIODevice::ReadOnly)) { return nullptr; }
+
+	auto header = DecodedCacheHeader{};
+	if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+		|| !std::equal(std::begin(header.magic), std::end(header.magic), DecodedCacheMagic)
+		|| header.version != DecodedCacheVersion
+		|| header.modified != modified.toMSecsSinceEpoch() || header.size != size
+		|| header.frames < 0 || file.size() != static_cast<qint64>(sizeof(header) + header.frames * sizeof(sampleFrame)))
+	{
+		return nullptr;
+	}
+
+	auto data = std::vector<sampleFrame>(header.frames);
+	const auto bytes = static_cast<qint64>(data.size() * sizeof(sampleFrame));
+	if (file.read(reinterpret_cast<char*>(data.data()), bytes) != bytes) { return nullptr; }
+
+	return std::make_shared<const SampleBuffer>(
+		std::move(data), header.sampleRate, PathUtil::toShortestRelative(audioFile));
+}
+
+void trimDecoded()
+{
+	const auto files = QDir{decodedCacheDir()}.entryInfoList({"*.lmmscache"}, QDir::Files, QDir::Time);
+
+	auto total = qint64{0};
+	for (const auto& file : files)
+	{
+		total += file.size();
+		if (total > MaxDecodedCacheSize) { QFile::remove(file.filePath()); }
+	}
+}
+
+void saveDecoded(const SampleBuffer& buffer, const QString& key, const QDateTime& modified, qint64 size)
+{
+	if (buffer.empty() || !QDir().mkpath(decodedCacheDir())) { return; }
+
+	// written to a temporary file first, so a load never sees half of it
+	auto file = QSaveFile{decodedCacheFile(key)};
+	if (!file.open(QIODevice::WriteOnly)) { return; }
+
+	auto header = DecodedCacheHeader{};
+	std::copy(std::begin(DecodedCacheMagic), std::end(DecodedCacheMagic), header.magic);
+	header.version = DecodedCacheVersion;
+	header.sampleRate = buffer.sampleRate();
+	header.modified = modified.toMSecsSinceEpoch();
+	header.size = size;
+	header.frames = static_cast<std::int64_t>(buffer.size());
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(sampleFrame));
+	if (file.commit()) { trimDecoded(); }
+}
+
+//! Only samples up to this long get a copy at the engine's sample rate, the
+//! others would take up too much memory for too little gain
+constexpr auto MaxResampledSeconds = 60;
+
+class ResampleTask : public QRunnable
+{
+public:
+	ResampleTask(std::shared_ptr<const SampleBuffer> buffer, sample_rate_t sampleRate)
+		: m_buffer(std::move(buffer))
+		, m_sampleRate(sampleRate)
+	{
+	}
+
+	void run() override
+	{
+		m_buffer->resampleTo(m_sampleRate);
+	}
+
+private:
+	std::shared_ptr<const SampleBuffer> m_buffer;
+	sample_rate_t m_sampleRate;
+};
+
+auto isWorthResampling(const SampleBuffer& buffer, sample_rate_t sampleRate) -> bool
+{
+	return buffer.sampleRate() != sampleRate
+		&& buffer.size() <= static_cast<std::size_t>(MaxResampledSeconds) * buffer.sampleRate();
+}
+
+//! Gives all buffers in use a copy at the new sample rate, in the background
+void resampleAll()
+{
+	const auto sampleRate = Engine::audioEngine()->processingSampleRate();
+	const auto lock = std::lock_guard{s_mutex};
+	for (const auto& entry : s_entries)
+	{
+		auto buffer = entry.buffer.lock();
+		if (buffer && isWorthResampling(*buffer, sampleRate))
+		{
+			QThreadPool::globalInstance()->start(new ResampleTask(std::move(buffer), sampleRate));
+		}
+	}
+}
+
+} // namespace
+
+auto SampleCache::get(const QString& audioFile) -> std::shared_ptr<const SampleBuffer>
+{
+	// the same file can be referred to by different relative paths
+	const auto fileInfo = QFileInfo{PathUtil::toAbsolute(audioFile)};
+	const auto key = fileInfo.canonicalFilePath();
+	if (key.isEmpty())
+	{
+		// doesn't exist, let SampleBuffer report that
+		return std::make_shared<const SampleBuffer>(audioFile);
+	}
+
+	const auto modified = fileInfo.lastModified();
+	const auto size = fileInfo.size();
+	{
+		auto lock = std::unique_lock{s_mutex};
+		for (auto it = s_entries.constFind(key);
+			it != s_entries.constEnd() && it->modified == modified && it->size == size;
+			it = s_entries.constFind(key))
+		{
+			if (auto buffer = it->buffer.lock()) { return buffer; }
+			if (!it->decoding) { break; }
+
+			// decoding the same file twice at once would only waste time
+			s_decoded.wait(lock);
+		}
+		s_entries[key] = Entry{modified, size, {}, true};
+	}
+
+	// decode without holding the lock, other files can be looked up meanwhile
+	auto buffer = std::shared_ptr<const SampleBuffer>{};
+	try
+	{
+		const auto cached = isWorthCaching(fileInfo);
+		buffer = cached ? loadDecoded(audioFile, key, modified, size) : nullptr;
+		if (!buffer)
+		{
+			buffer = std::make_shared<const SampleBuffer>(audioFile);
+			if (cached) { saveDecoded(*buffer, key, modified, size); }
+		}
+
+		if (const auto audioEngine = Engine::audioEngine())
+		{
+			static auto s_connected = std::once_flag{};
+			std::call_once(s_connected, [audioEngine] {
+				QObject::connect(audioEngine, &AudioEngine::sampleRateChanged, &resampleAll);
+			});
+
+			// so playing it at its original pitch doesn't need any conversion
+			const auto sampleRate = audioEngine->processingSampleRate();
+			if (isWorthResampling(*buffer, sampleRate)) { buffer->resampleTo(sampleRate); }
+		}
+	}
+	catch (...)
+	{
+		// whoever waited for this will try on their own and get the error themselves
+		{
+			const auto lock = std::lock_guard{s_mutex};
+			s_entries.remove(key);
+		}
+		s_decoded.notify_all();
+		throw;
+	}
+
+	{
+		const auto lock = std::lock_guard{s_mutex};
+		s_entries[key] = Entry{modified, size, buffer};
+		removeUnused();
+	}
+	s_decoded.notify_all();
+	return buffer;
+}
+
+SampleCache::Preload::Preload(const QStringList& audioFiles, const std::vector<Embedded>& embedded)
+{
+	// never resized after this, the tasks point into it
+	m_embedded.reserve(embedded.size());
+	for (const auto& data : embedded) { m_embedded.push_back(EmbeddedEntry{data}); }
+	{
+		const auto lock = std::lock_guard{s_embeddedMutex};
+		s_preloads.push_back(this);
+	}
+
+	for (const auto& audioFile : audioFiles)
+	{
+		m_pool.start(new Task(this, audioFile));
+	}
+	for (auto& entry : m_embedded)
+	{
+		m_pool.start(new EmbeddedTask(&entry));
+	}
+}
+
+SampleCache::Preload::~Preload()
+{
+	{
+		const auto lock = std::lock_guard{s_embeddedMutex};
+		s_preloads.erase(std::find(s_preloads.begin(), s_preloads.end(), this));
+	}
+
+	// whatever hasn't started yet wasn't needed in the end
+	m_pool.clear();
+	m_pool.waitForDone();
+}
+
+void SampleCache::Preload::Task::run()
+{
+	// streamed files don't get decoded as a whole
+	if (SampleStream::canStream(m_audioFile)) { return; }
+
+	try
+	{
+		auto buffer = SampleCache::get(m_audioFile);
+		const auto lock = std::lock_guard{m_preload->m_mutex};
+		m_preload->m_buffers.push_back(std::move(buffer));
+	}
+	catch (const std::runtime_error&)
+	{
+		// reported when the file is really loaded
+	}
+}
+
+void SampleCache::Preload::EmbeddedTask::run()
+{
+	auto lock = std::unique_lock{s_embeddedMutex};
+	decode(*m_entry, lock);
+}
+
+void SampleCache::Preload::decode(EmbeddedEntry& entry, std::unique_lock<std::mutex>& lock)
+{
+	if (entry.decoding || entry.decoded) { return; }
+	entry.decoding = true;
+
+	lock.unlock();
+	auto buffer = std::shared_ptr<const SampleBuffer>{};
+	try
+	{
+		buffer = std::make_shared<const SampleBuffer>(entry.embedded.data, entry.embedded.sampleRate);
+	}
+	catch (const std::runtime_error&)
+	{
+		// reported when the element decodes it again
+	}
+	lock.lock();
+
+	entry.buffer = std::move(buffer);
+	entry.decoding = false;
+	entry.decoded = true;
+	s_embeddedDecoded.notify_all();
+}
+
+auto SampleCache::getEmbedded(const QString& data, int sampleRate) -> std::shared_ptr<const SampleBuffer>
+{
+	auto lock = std::unique_lock{s_embeddedMutex};
+	for (const auto preload : s_preloads)
+	{
+		for (auto& entry : preload->m_embedded)
+		{
+			// the element hands out the very string that was queued, comparing
+			// the contents of a big one would take almost as long as decoding it
+			if (entry.embedded.data.constData() != data.constData() || entry.embedded.sampleRate != sampleRate)
+			{
+				continue;
+			}
+
+			// decode it here if no task got to it yet
+			Preload::decode(entry, lock);
+			s_embeddedDecoded.wait(lock, [&entry] { return entry.decoded; });
+			return entry.buffer;
+		}
+	}
+	return nullptr;
+}
+
+auto SampleCache::size() -> std::size_t
+{
+	const auto lock = std::lock_guard{s_mutex};
+	removeUnused();
+	return s_entries.size();
+}
+
+} // namespace lmms
@@ -31,6 +31,7 @@
 #include "SampleBuffer.h"
 #include "SampleClipView.h"
 #include "SampleLoader.h"
+#include "SamplePlayHandle.h"
 #include "SampleTrack.h"
 #include "TimeLineWidget.h"
 
@@ -53,12 +54,9 @@ SampleClip::SampleClip(Track* _track, Sample sample, bool isPlaying)
 	connect( Engine::getSong(), SIGNAL(timeSignatureChanged(int,int)),
 					this, SLOT(updateLength()));
 
-	//playbutton clicked or space key / on Export Song set isPlaying to false
-	connect( Engine::getSong(), SIGNAL(playbackStateChanged()),
-			this, SLOT(playbackPositionChanged()), Qt::DirectConnection );
-	//care about loops and jumps
-	connect( Engine::getSong(), SIGNAL(updateSampleTracks()),
-			this, SLOT(playbackPositionChanged()), Qt::DirectConnection );
+	// the track takes care of starting and stopping playback, loops and jumps
+	// once for all of its clips
+
 	//care about mute Clips
 	connect( this, SIGNAL(dataChanged()), this, SLOT(playbackPositionChanged()));
 	//care about mute track
@@ -80,6 +78,9 @@ SampleClip::SampleClip(Track* _track, Sample sample, bool isPlaying)
 			break;
 	}
 	updateTrackClips();
+
+	// the first time it plays doesn't have to set up a resampler either
+	m_playbackStates[0] = new Sample::PlaybackState();
 }
 
 SampleClip::SampleClip(Track* track)
@@ -102,6 +103,13 @@ SampleClip::~SampleClip()
 	{
 		sampletrack->updateClips();
 	}
+
+	// the handles give their states back to us
+	delete takeArmedPlayHandle();
+	for( auto& state : m_playbackStates )
+	{
+		delete state.exchange( nullptr );
+	}
 }
 
 
@@ -138,7 +146,12 @@ void SampleClip::setSampleFile(const QString& sf)
 	if (!sf.isEmpty())
 	{
 		//Otherwise set it to the sample's length
-		m_sample = Sample(gui::SampleLoader::createBufferFromFile(sf));
+		if (auto stream = gui::SampleLoader::createStreamFromFile(sf))
+		{
+			// long recordings are played from disk instead of taking up memory
+			m_sample = Sample(std::move(stream));
+		}
+		else { m_sample = Sample(gui::SampleLoader::createBufferFromFile(sf)); }
 		length = sampleLength();
 	}
 
@@ -207,6 +220,54 @@ void SampleClip::setIsPlaying(bool isPlaying)
 
 
 
+Sample::PlaybackState* SampleClip::acquirePlaybackState()
+{
+	for( auto& pooled : m_playbackStates )
+	{
+		if( const auto state = pooled.exchange( nullptr, std::memory_order_acquire ) )
+		{
+			return state;
+		}
+	}
+	return new Sample::PlaybackState();
+}
+
+
+
+
+void SampleClip::releasePlaybackState( Sample::PlaybackState* state )
+{
+	state->reset();
+	for( auto& pooled : m_playbackStates )
+	{
+		Sample::PlaybackState* empty = nullptr;
+		if( pooled.compare_exchange_strong( empty, state, std::memory_order_release ) )
+		{
+			return;
+		}
+	}
+	delete state;
+}
+
+
+
+
+void SampleClip::armPlayHandle( SamplePlayHandle* handle )
+{
+	delete m_armedPlayHandle.exchange( handle, std::memory_order_acq_rel );
+}
+
+
+
+
+SamplePlayHandle* SampleClip::takeArmedPlayHandle()
+{
+	return m_armedPlayHandle.exchange( nullptr, std::memory_order_acq_rel );
+}
+
+
+
+
 void SampleClip::updateLength()
 {
 	emit sampleChanged();
@@ -24,9 +24,11 @@
 
 #include "SampleDecoder.h"
 
+#include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
 #include <QString>
+#include <algorithm>
 #include <memory>
 #include <sndfile.h>
 
@@ -38,6 +40,8 @@
 #include "DrumSynth.h"
 #include "Engine.h"
 #include "lmms_basics.h"
+#include "RenderCache.h"
+#include "SampleBuffer.h"
 
 namespace lmms {
 
@@ -97,11 +101,23 @@ auto decodeSampleSF(const QString& audioFile) -> std::optional<SampleDecoder::Re
 
 auto decodeSampleDS(const QString& audioFile) -> std::optional<SampleDecoder::Result>
 {
+	const auto engineRate = Engine::audioEngine()->processingSampleRate();
+
+	// files that are loaded or previewed again don't have to be synthesised again
+	const auto fileInfo = QFileInfo{audioFile};
+	auto key = RenderCache::Key{"DrumSynth"};
+	key << fileInfo.absoluteFilePath() << fileInfo.lastModified().toMSecsSinceEpoch() << fileInfo.size()
+		<< engineRate;
+	if (const auto rendered = RenderCache::get(key))
+	{
+		return SampleDecoder::Result{std::vector<sampleFrame>(rendered->begin(), rendered->end()),
+			static_cast<int>(engineRate)};
+	}
+
 	// Populated by DrumSynth::GetDSFileSamples
 	int_sample_t* dataPtr = nullptr;
 
 	auto ds = DrumSynth{};
-	const auto engineRate = Engine::audioEngine()->processingSampleRate();
 	const auto frames = ds.GetDSFileSamples(audioFile, dataPtr, DEFAULT_CHANNELS, engineRate);
 	const auto data = std::unique_ptr<int_sample_t[]>{dataPtr}; // NOLINT, we have to use a C-style array here
 
@@ -110,6 +126,7 @@ auto decodeSampleDS(const QString& audioFile) -> std::optional<SampleDecoder::Re
 	auto result = std::vector<sampleFrame>(frames);
 	src_short_to_float_array(data.get(), &result[0][0], frames * DEFAULT_CHANNELS);
 
+	RenderCache::put(key, std::make_shared<const SampleBuffer>(result, engineRate));
 	return SampleDecoder::Result{std::move(result), static_cast<int>(engineRate)};
 }
 
@@ -221,6 +238,41 @@ auto SampleDecoder::supportedAudioTypes() -> const std::vector<AudioType>&
 	return s_audioTypes;
 }
 
+auto SampleDecoder::decodeHead(const QString& audioFile, int seconds) -> std::optional<Result>
+{
+	auto sfInfo = SF_INFO{};
+
+	// TODO: Remove use of QFile
+	auto file = QFile{audioFile};
+	if (!file.open(QIODevice::ReadOnly)) { return std::nullopt; }
+
+	SNDFILE* sndFile = sf_open_fd(file.handle(), SFM_READ, &sfInfo, false);
+	if (sf_error(sndFile) != 0) { return std::nullopt; }
+	if (sfInfo.channels <= 0 || !sfInfo.seekable)
+	{
+		sf_close(sndFile);
+		return std::nullopt;
+	}
+
+	const auto frames = std::min<sf_count_t>(sfInfo.frames, static_cast<sf_count_t>(seconds) * sfInfo.samplerate);
+	auto buf = std::vector<sample_t>(sfInfo.channels * frames);
+	const auto framesRead = sf_readf_float(sndFile, buf.data(), frames);
+
+	sf_close(sndFile);
+	file.close();
+
+	auto result = std::vector<sampleFrame>(framesRead);
+	for (int i = 0; i < static_cast<int>(result.size()); ++i)
+	{
+		// the same as decodeSampleSF()
+		result[i] = sfInfo.channels == 1
+			? sampleFrame{buf[i], buf[i]}
+			: sampleFrame{buf[i * sfInfo.channels], buf[i * sfInfo.channels + 1]};
+	}
+
+	return Result{std::move(result), static_cast<int>(sfInfo.samplerate)};
+}
+
 auto SampleDecoder::decode(const QString& audioFile) -> std::optional<Result>
 {
 	auto result = std::optional<Result>{};
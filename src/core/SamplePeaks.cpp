@@ -0,0 +1,81 @@
+/*
+ * SamplePeaks.cpp - summary of sample frames for drawing them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SamplePeaks.h"
+
+#include <algorithm>
+
+namespace lmms {
+
+void SamplePeaks::append(const sampleFrame* frames, std::size_t count)
+{
+	auto& bins = m_levels.front();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const auto value = (frames[i][0] + frames[i][1]) / 2;
+		m_bin.min = std::min(m_bin.min, value);
+		m_bin.max = std::max(m_bin.max, value);
+		m_bin.squares += value * value;
+
+		if (++m_binFrames == BinFrames)
+		{
+			bins.push_back(m_bin);
+			m_bin = Peak{};
+			m_binFrames = 0;
+		}
+	}
+}
+
+void SamplePeaks::finish()
+{
+	if (m_binFrames > 0)
+	{
+		m_levels.front().push_back(m_bin);
+		m_bin = Peak{};
+		m_binFrames = 0;
+	}
+
+	while (m_levels.back().size() > 1)
+	{
+		const auto& lower = m_levels.back();
+		auto upper = std::vector<Peak>((lower.size() + 1) / 2);
+		for (std::size_t i = 0; i < lower.size(); ++i)
+		{
+			auto& peak = upper[i / 2];
+			peak.min = std::min(peak.min, lower[i].min);
+			peak.max = std::max(peak.max, lower[i].max);
+			peak.squares += lower[i].squares;
+		}
+		m_levels.push_back(std::move(upper));
+	}
+}
+
+auto SamplePeaks::levelFor(std::size_t frames) const -> int
+{
+	auto level = -1;
+	while (level + 1 < levelCount() && binFrames(level + 1) <= frames) { ++level; }
+	return level;
+}
+
+} // namespace lmms
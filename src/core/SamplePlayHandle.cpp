@@ -40,6 +40,8 @@ SamplePlayHandle::SamplePlayHandle(Sample* sample, bool ownAudioPort) :
 	m_sample(sample),
 	m_doneMayReturnTrue( true ),
 	m_frame( 0 ),
+	m_ownState( std::make_unique<Sample::PlaybackState>() ),
+	m_state( m_ownState.get() ),
 	m_ownAudioPort( ownAudioPort ),
 	m_defaultVolumeModel( DefaultVolume, MinVolume, MaxVolume, 1 ),
 	m_volumeModel( &m_defaultVolumeModel ),
@@ -64,7 +66,17 @@ SamplePlayHandle::SamplePlayHandle( const QString& sampleFile ) :
 
 
 SamplePlayHandle::SamplePlayHandle( SampleClip* clip ) :
-	SamplePlayHandle(&clip->sample(), false)
+	PlayHandle( Type::SamplePlayHandle ),
+	m_sample( &clip->sample() ),
+	m_doneMayReturnTrue( true ),
+	m_frame( 0 ),
+	m_clip( clip ),
+	m_state( clip->acquirePlaybackState() ),
+	m_ownAudioPort( false ),
+	m_defaultVolumeModel( DefaultVolume, MinVolume, MaxVolume, 1 ),
+	m_volumeModel( &m_defaultVolumeModel ),
+	m_track( nullptr ),
+	m_patternTrack( nullptr )
 {
 	m_track = clip->getTrack();
 	setAudioPort( ( (SampleTrack *)clip->getTrack() )->audioPort() );
@@ -75,10 +87,16 @@ SamplePlayHandle::SamplePlayHandle( SampleClip* clip ) :
 
 SamplePlayHandle::~SamplePlayHandle()
 {
+	if( m_clip )
+	{
+		m_clip->releasePlaybackState( m_state );
+	}
 	if( m_ownAudioPort )
 	{
 		delete audioPort();
 		delete m_sample;
+		delete m_replacedSample;
+		delete m_nextSample.load();
 	}
 }
 
@@ -89,6 +107,13 @@ void SamplePlayHandle::play( sampleFrame * buffer )
 {
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 	//play( 0, _try_parallelizing );
+	if (const auto next = m_nextSample.exchange(nullptr))
+	{
+		// the replaced one is freed later, not on the audio thread
+		m_replacedSample = m_sample;
+		m_sample = next;
+	}
+
 	if( framesDone() >= totalFrames() )
 	{
 		memset( buffer, 0, sizeof( sampleFrame ) * fpp );
@@ -114,7 +139,7 @@ void SamplePlayHandle::play( sampleFrame * buffer )
 				m_volumeModel->value() / DefaultVolume } };*/
 		// SamplePlayHandle always plays the sample at its original pitch;
 		// it is used only for previews, SampleTracks and the metronome.
-		if (!m_sample->play(workingBuffer, &m_state, frames, DefaultBaseFreq))
+		if (!m_sample->play(workingBuffer, m_state, frames, DefaultBaseFreq))
 		{
 			memset(workingBuffer, 0, frames * sizeof(sampleFrame));
 		}
@@ -24,8 +24,19 @@
 
 
 #include "SampleRecordHandle.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+#include <atomic>
+#include <sndfile.h>
+#include <vector>
+
 #include "AudioEngine.h"
+#include "ConfigManager.h"
 #include "Engine.h"
+#include "LocklessRingBuffer.h"
 #include "PatternTrack.h"
 #include "SampleBuffer.h"
 #include "SampleClip.h"
@@ -36,14 +47,125 @@ namespace lmms
 {
 
 
+class SampleRecordHandle::Writer : public QThread
+{
+public:
+	//! Enough for the writer to be held up for a few seconds
+	static constexpr std::size_t RingFrames = 1 << 18;
+
+	explicit Writer(sample_rate_t sampleRate) :
+		m_ring(RingFrames),
+		m_reader(m_ring),
+		m_sampleRate(sampleRate)
+	{
+	}
+
+	//! Called by the audio thread, the frames that don't fit anymore are lost
+	void write(const sampleFrame* frames, f_cnt_t count)
+	{
+		const auto written = m_ring.write(frames, count);
+		if (written < static_cast<std::size_t>(count)) { m_dropped += count - written; }
+	}
+
+	//! Writes the rest of the frames and closes the file
+	void finish()
+	{
+		m_quit = true;
+		wait();
+		writePending();
+		if (m_sndFile)
+		{
+			sf_close(m_sndFile);
+			m_sndFile = nullptr;
+		}
+		m_file.close();
+
+		if (m_dropped > 0)
+		{
+			qWarning("SampleRecordHandle: %d recorded frames were lost, the disk was too slow", m_dropped.load());
+		}
+	}
+
+	//! After finish(), the file the frames were written to, or empty if they are in frames()
+	auto fileName() const -> const QString& { return m_fileName; }
+	auto frames() -> std::vector<sampleFrame>& { return m_frames; }
+
+private:
+	void run() override
+	{
+		const auto dir = QDir{ConfigManager::inst()->userSamplesDir() + "recordings"};
+		m_fileName = dir.filePath(QDateTime::currentDateTime().toString("'recording-'yyyyMMdd-hhmmss-zzz'.wav'"));
+
+		auto info = SF_INFO{};
+		info.samplerate = m_sampleRate;
+		info.channels = DEFAULT_CHANNELS;
+		info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+		// Use file handle to handle unicode file name on Windows
+		m_file.setFileName(m_fileName);
+		if (dir.mkpath(".") && m_file.open(QFile::WriteOnly | QFile::Truncate))
+		{
+			m_sndFile = sf_open_fd(m_file.handle(), SFM_WRITE, &info, false);
+		}
+		if (!m_sndFile)
+		{
+			// the take is still kept, in memory like it used to be
+			qWarning("SampleRecordHandle: could not write %s, recording to memory", qPrintable(m_fileName));
+			m_file.close();
+			m_file.remove();
+			m_fileName.clear();
+		}
+
+		while (!m_quit)
+		{
+			writePending();
+			msleep(20);
+		}
+	}
+
+	void writePending()
+	{
+		while (!m_reader.empty())
+		{
+			const auto frames = m_reader.read_max(m_reader.read_space());
+			const auto start = m_frames.size();
+			m_frames.resize(start + frames.size());
+			for (std::size_t i = 0; i < frames.size(); ++i) { m_frames[start + i] = frames[i]; }
+
+			if (m_sndFile)
+			{
+				sf_writef_float(m_sndFile, m_frames.front().data(), m_frames.size());
+				m_frames.clear();
+			}
+		}
+	}
+
+	LocklessRingBuffer<sampleFrame> m_ring;
+	LocklessRingBufferReader<sampleFrame> m_reader;
+	const sample_rate_t m_sampleRate;
+	std::atomic<bool> m_quit = false;
+	std::atomic<int> m_dropped = 0;
+
+	QString m_fileName;
+	QFile m_file;
+	SNDFILE* m_sndFile = nullptr;
+	//! What was read from the ring and not written to the file yet
+	std::vector<sampleFrame> m_frames;
+};
+
+
+
+
 SampleRecordHandle::SampleRecordHandle( SampleClip* clip ) :
 	PlayHandle( Type::SamplePlayHandle ),
+	m_writer(std::make_unique<Writer>(Engine::audioEngine()->inputSampleRate())),
 	m_framesRecorded( 0 ),
 	m_minLength( clip->length() ),
 	m_track( clip->getTrack() ),
 	m_patternTrack( nullptr ),
 	m_clip( clip )
 {
+	m_writer->start(QThread::LowPriority);
 }
 
 
@@ -51,12 +173,22 @@ SampleRecordHandle::SampleRecordHandle( SampleClip* clip ) :
 
 SampleRecordHandle::~SampleRecordHandle()
 {
-	if (!m_buffers.empty()) { m_clip->setSampleBuffer(createSampleBuffer()); }
+	m_writer->finish();
 
-	while( !m_buffers.empty() )
+	const auto fileName = m_writer->fileName();
+	if (m_framesRecorded == 0)
 	{
-		delete[] m_buffers.front().first;
-		m_buffers.erase( m_buffers.begin() );
+		if (!fileName.isEmpty()) { QFile::remove(fileName); }
+	}
+	else if (!fileName.isEmpty())
+	{
+		// loading the take is left to the clip's thread, it may well be streamed from disk
+		QMetaObject::invokeMethod(m_clip, "setSampleFile", Qt::QueuedConnection, Q_ARG(QString, fileName));
+	}
+	else
+	{
+		m_clip->setSampleBuffer(std::make_shared<const SampleBuffer>(
+			std::move(m_writer->frames()), Engine::audioEngine()->inputSampleRate()));
 	}
 	m_clip->setRecord( false );
 }
@@ -68,7 +200,7 @@ void SampleRecordHandle::play( sampleFrame * /*_working_buffer*/ )
 {
 	const sampleFrame * recbuf = Engine::audioEngine()->inputBuffer();
 	const f_cnt_t frames = Engine::audioEngine()->inputBufferFrames();
-	writeBuffer( recbuf, frames );
+	m_writer->write(recbuf, frames);
 	m_framesRecorded += frames;
 
 	TimePos len = (tick_t)( m_framesRecorded / Engine::framesPerTick() );
@@ -104,41 +236,4 @@ f_cnt_t SampleRecordHandle::framesRecorded() const
 }
 
 
-
-
-std::shared_ptr<const SampleBuffer> SampleRecordHandle::createSampleBuffer()
-{
-	const f_cnt_t frames = framesRecorded();
-	// create buffer to store all recorded buffers in
-	auto bigBuffer = std::vector<sampleFrame>(frames);
-
-	// now copy all buffers into big buffer
-	auto framesCopied = 0;
-	for (const auto& [buf, numFrames] : m_buffers)
-	{
-		std::copy_n(buf, numFrames, bigBuffer.begin() + framesCopied);
-		framesCopied += numFrames;
-	}
-
-	// create according sample-buffer out of big buffer
-	return std::make_shared<const SampleBuffer>(std::move(bigBuffer), Engine::audioEngine()->inputSampleRate());
-}
-
-
-
-
-void SampleRecordHandle::writeBuffer( const sampleFrame * _ab, const f_cnt_t _frames )
-{
-	auto buf = new sampleFrame[_frames];
-	for( f_cnt_t frame = 0; frame < _frames; ++frame )
-	{
-		for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS; ++chnl )
-		{
-			buf[frame][chnl] = _ab[frame][chnl];
-		}
-	}
-	m_buffers.push_back( qMakePair( buf, _frames ) );
-}
-
-
 } // namespace lmms
@@ -0,0 +1,338 @@
+/*
+ * SampleStream.cpp - plays long audio files from disk instead of from memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleStream.h"
+
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+#include <sndfile.h>
+#include <vector>
+
+#include "Engine.h"
+#include "PathUtil.h"
+#include "Song.h"
+
+namespace lmms {
+
+namespace {
+
+//! A file opened with libsndfile, read as stereo frames
+class SoundFile
+{
+public:
+	explicit SoundFile(const QString& audioFile)
+		: m_file(PathUtil::toAbsolute(audioFile))
+	{
+		// TODO: Remove use of QFile
+		if (!m_file.open(QIODevice::ReadOnly)) { return; }
+		m_sndFile = sf_open_fd(m_file.handle(), SFM_READ, &m_info, false);
+		if (m_sndFile && (m_info.channels <= 0 || !m_info.seekable))
+		{
+			sf_close(m_sndFile);
+			m_sndFile = nullptr;
+		}
+	}
+
+	~SoundFile()
+	{
+		if (m_sndFile) { sf_close(m_sndFile); }
+	}
+
+	SoundFile(const SoundFile&) = delete;
+	auto operator=(const SoundFile&) -> SoundFile& = delete;
+
+	auto isOpen() const -> bool { return m_sndFile != nullptr; }
+	auto size() const -> f_cnt_t { return static_cast<f_cnt_t>(m_info.frames); }
+	auto sampleRate() const -> int { return m_info.samplerate; }
+
+	//! Reads @p frames frames from @p frame on to @p dst and returns how many there were
+	auto read(sampleFrame* dst, f_cnt_t frame, f_cnt_t frames) -> f_cnt_t
+	{
+		if (frame != m_frame && sf_seek(m_sndFile, frame, SEEK_SET) < 0) { return 0; }
+
+		const auto channels = m_info.channels;
+		m_buffer.resize(static_cast<std::size_t>(frames) * channels);
+		const auto framesRead = static_cast<f_cnt_t>(sf_readf_float(m_sndFile, m_buffer.data(), frames));
+		m_frame = frame + framesRead;
+
+		for (f_cnt_t i = 0; i < framesRead; ++i)
+		{
+			// the same as SampleDecoder: mono is upmixed, only the first two of more channels are used
+			dst[i] = channels == 1
+				? sampleFrame{m_buffer[i], m_buffer[i]}
+				: sampleFrame{m_buffer[i * channels], m_buffer[i * channels + 1]};
+		}
+		return framesRead;
+	}
+
+private:
+	QFile m_file;
+	SNDFILE* m_sndFile = nullptr;
+	SF_INFO m_info = {};
+	f_cnt_t m_frame = 0;
+	std::vector<float> m_buffer;
+};
+
+} // namespace
+
+
+
+
+class SampleStream::Reader : public QThread
+{
+public:
+	explicit Reader(SampleStream* stream)
+		: m_stream(stream)
+	{
+	}
+
+private:
+	void run() override
+	{
+		m_stream->run();
+	}
+
+	SampleStream* m_stream;
+};
+
+
+
+
+auto SampleStream::canStream(const QString& audioFile) -> bool
+{
+	if (audioFile.isEmpty()) { return false; }
+
+	const auto file = SoundFile{audioFile};
+	return file.isOpen() && file.size() >= static_cast<f_cnt_t>(MinimumSeconds) * file.sampleRate();
+}
+
+
+
+
+SampleStream::SampleStream(const QString& audioFile)
+{
+	auto file = SoundFile{audioFile};
+	if (!file.isOpen())
+	{
+		throw std::runtime_error{
+			"Failed to decode audio file: Either the audio codec is unsupported, or the file is corrupted."};
+	}
+
+	// the head is made of whole blocks, so every block is either in the
+	// head or read by the reader
+	const auto headBlocks = (static_cast<f_cnt_t>(HeadSeconds) * file.sampleRate() + BlockFrames - 1) / BlockFrames;
+	auto head = std::vector<sampleFrame>(std::min(headBlocks * BlockFrames, file.size()));
+	auto overview = std::vector<sampleFrame>();
+	overview.reserve((file.size() / OverviewFrames + 1) * 2);
+
+	auto chunk = std::vector<sampleFrame>(BlockFrames);
+	auto size = f_cnt_t{0};
+	while (const auto framesRead = file.read(chunk.data(), size, BlockFrames))
+	{
+		if (size < static_cast<f_cnt_t>(head.size()))
+		{
+			std::copy_n(chunk.begin(), std::min<f_cnt_t>(framesRead, head.size() - size), head.begin() + size);
+		}
+
+		// SampleWaveform draws the average of both channels, so keep its extremes
+		for (f_cnt_t start = 0; start < framesRead; start += OverviewFrames)
+		{
+			auto min = 1.0f;
+			auto max = -1.0f;
+			for (f_cnt_t i = start; i < std::min<f_cnt_t>(start + OverviewFrames, framesRead); ++i)
+			{
+				const auto value = (chunk[i][0] + chunk[i][1]) / 2;
+				min = std::min(min, value);
+				max = std::max(max, value);
+			}
+			overview.push_back({min, min});
+			overview.push_back({max, max});
+		}
+		size += framesRead;
+	}
+
+	auto source = std::make_shared<Source>();
+	source->audioFile = PathUtil::toShortestRelative(audioFile);
+	source->size = size;
+	source->head = std::make_shared<const SampleBuffer>(std::move(head), file.sampleRate());
+	source->overview = SampleBuffer{std::move(overview), file.sampleRate()};
+	m_source = std::move(source);
+
+	m_blocks = std::make_unique<Block[]>(CachedBlocks);
+	m_reader = std::make_unique<Reader>(this);
+	m_reader->start(QThread::LowPriority);
+}
+
+
+
+
+SampleStream::SampleStream(const SampleStream& other)
+	: m_source(other.m_source)
+	, m_blocks(std::make_unique<Block[]>(CachedBlocks))
+	, m_reader(std::make_unique<Reader>(this))
+{
+	m_reader->start(QThread::LowPriority);
+}
+
+
+
+
+SampleStream::~SampleStream()
+{
+	m_quit = true;
+	m_positionChanged.wakeAll();
+	m_reader->wait();
+}
+
+
+
+
+void SampleStream::prefetch(f_cnt_t frame, bool backwards)
+{
+	const auto turned = m_backwards.exchange(backwards, std::memory_order_relaxed) != backwards;
+	const auto previous = m_position.exchange(frame, std::memory_order_relaxed);
+
+	// the reader only cares about blocks, don't wake it for every period
+	if (turned || previous / BlockFrames != frame / BlockFrames) { m_positionChanged.wakeOne(); }
+}
+
+
+
+
+void SampleStream::read(sampleFrame* dst, f_cnt_t frame, f_cnt_t frames, bool backwards)
+{
+	prefetch(frame, backwards);
+
+	const auto& head = *m_source->head;
+	const auto headSize = static_cast<f_cnt_t>(head.size());
+	while (frames > 0)
+	{
+		auto count = frames;
+		if (frame < headSize)
+		{
+			count = std::min(count, headSize - frame);
+			std::copy_n(head.begin() + frame, count, dst);
+		}
+		else if (frame >= m_source->size)
+		{
+			std::fill_n(dst, count, sampleFrame{0, 0});
+		}
+		else
+		{
+			count = std::min({count, BlockFrames - frame % BlockFrames, m_source->size - frame});
+			auto cached = readCached(dst, frame, count);
+
+			// an export has all the time in the world, but it must not miss anything
+			while (!cached && !m_quit && Engine::getSong()->isExporting())
+			{
+				QThread::usleep(100);
+				cached = readCached(dst, frame, count);
+			}
+			if (!cached) { std::fill_n(dst, count, sampleFrame{0, 0}); }
+		}
+
+		dst += count;
+		frame += count;
+		frames -= count;
+	}
+}
+
+
+
+
+auto SampleStream::readCached(sampleFrame* dst, f_cnt_t frame, f_cnt_t frames) const -> bool
+{
+	const auto index = frame / BlockFrames;
+	const auto& block = m_blocks[index % CachedBlocks];
+	if (block.index.load(std::memory_order_acquire) != index) { return false; }
+
+	std::copy_n(block.frames + frame % BlockFrames, frames, dst);
+
+	// the reader may have started to replace the block while we copied it
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return block.index.load(std::memory_order_relaxed) == index;
+}
+
+
+
+
+void SampleStream::run()
+{
+	auto file = SoundFile{m_source->audioFile};
+	if (!file.isOpen())
+	{
+		// nothing will ever be read, don't let an export wait for it
+		m_quit = true;
+		return;
+	}
+
+	const auto headBlocks = static_cast<f_cnt_t>(m_source->head->size()) / BlockFrames;
+	const auto blockCount = (m_source->size + BlockFrames - 1) / BlockFrames;
+
+	m_mutex.lock();
+	while (!m_quit)
+	{
+		// fill the blocks from the play position on in play direction, the nearest first
+		const auto position = m_position.load(std::memory_order_relaxed) / BlockFrames;
+		const auto step = m_backwards.load(std::memory_order_relaxed) ? -1 : 1;
+		auto index = position;
+		auto distance = 0;
+		for (; distance < CachedBlocks; ++distance, index += step)
+		{
+			if (index < headBlocks || index >= blockCount)
+			{
+				// the head needs no reading, but there may be blocks beyond it
+				if (step > 0 && index < headBlocks) { continue; }
+				distance = CachedBlocks;
+				break;
+			}
+			if (m_blocks[index % CachedBlocks].index.load(std::memory_order_relaxed) != index) { break; }
+		}
+
+		if (distance == CachedBlocks)
+		{
+			// the timeout covers wake ups that were missed because prefetch() doesn't lock
+			m_positionChanged.wait(&m_mutex, 50);
+			continue;
+		}
+		m_mutex.unlock();
+
+		auto& block = m_blocks[index % CachedBlocks];
+		block.index.store(-1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		const auto start = index * BlockFrames;
+		const auto frames = std::min(BlockFrames, m_source->size - start);
+		const auto framesRead = file.read(block.frames, start, frames);
+		std::fill(block.frames + framesRead, block.frames + BlockFrames, sampleFrame{0, 0});
+
+		block.index.store(index, std::memory_order_release);
+		m_mutex.lock();
+	}
+	m_mutex.unlock();
+}
+
+
+} // namespace lmms
@@ -49,9 +49,11 @@
 #include "PatternEditor.h"
 #include "PatternStore.h"
 #include "PatternTrack.h"
+#include "PeriodArena.h"
 #include "PianoRoll.h"
 #include "ProjectJournal.h"
 #include "ProjectNotes.h"
+#include "SampleCache.h"
 #include "Scale.h"
 #include "SongEditor.h"
 #include "TimeLineWidget.h"
@@ -97,7 +99,15 @@ Song::Song() :
 	m_elapsedBars( 0 ),
 	m_loopRenderCount(1),
 	m_loopRenderRemaining(1),
-	m_oldAutomatedValues()
+	m_exportSegment(false),
+	m_exportSegmentBegin(0),
+	m_exportSegmentEnd(0),
+	m_exportSegmentPreroll(0),
+	m_exportSegmentOverlap(0),
+	m_exportFrames(0),
+	m_exportSegmentBeginFrame(-1),
+	m_exportSegmentEndFrame(-1),
+	m_prefetchedAt(-1)
 {
 	for (double& millisecondsElapsed : m_elapsedMilliSeconds) { millisecondsElapsed = 0; }
 	connect( &m_tempoModel, SIGNAL(dataChanged()),
@@ -145,26 +155,43 @@ void Song::masterVolumeChanged()
 
 void Song::setTempo()
 {
-	Engine::audioEngine()->requestChangeInModel();
 	const auto tempo = (bpm_t)m_tempoModel.value();
-	PlayHandleList & playHandles = Engine::audioEngine()->playHandles();
-	for (const auto& playHandle : playHandles)
+	// the notes are resized by the audio engine itself, so automating the
+	// tempo doesn't have to stop it every time
+	m_pendingTempo = tempo;
+
+	Engine::updateFramesPerTick();
+
+	m_vstSyncController.setTempo( tempo );
+
+	emit tempoChanged( tempo );
+}
+
+
+
+
+void Song::resizeNotesToTempo()
+{
+	const bpm_t tempo = m_pendingTempo.exchange( 0 );
+	if( tempo == 0 )
 	{
-		auto nph = dynamic_cast<NotePlayHandle*>(playHandle);
-		if( nph && !nph->isReleased() )
+		return;
+	}
+
+	for( PlayHandle * playHandle : Engine::audioEngine()->playHandles() )
+	{
+		if( playHandle->type() != PlayHandle::Type::NotePlayHandle )
+		{
+			continue;
+		}
+		auto nph = static_cast<NotePlayHandle *>( playHandle );
+		if( !nph->isReleased() )
 		{
 			nph->lock();
 			nph->resize( tempo );
 			nph->unlock();
 		}
 	}
-	Engine::audioEngine()->doneChangeInModel();
-
-	Engine::updateFramesPerTick();
-
-	m_vstSyncController.setTempo( tempo );
-
-	emit tempoChanged( tempo );
 }
 
 
@@ -197,7 +224,11 @@ void Song::processNextBuffer()
 	m_vstSyncController.setPlaybackJumped(false);
 
 	// If nothing is playing, there is nothing to do
-	if (!m_playing) { return; }
+	if (!m_playing)
+	{
+		m_prefetchedAt = -1;
+		return;
+	}
 
 	// At the beginning of the song, we have to reset the LFOs
 	if (m_playMode == PlayMode::Song && getPlayPos() == 0)
@@ -265,8 +296,11 @@ void Song::processNextBuffer()
 		m_vstSyncController.setPlaybackJumped(true);
 		emit updateSampleTracks();
 		getPlayPos().setJumped(false);
+		m_prefetchedAt = -1;
 	}
 
+	if (m_playMode == PlayMode::Song) { prefetchAhead(trackList); }
+
 	const auto framesPerTick = Engine::framesPerTick();
 	const auto framesPerPeriod = Engine::audioEngine()->framesPerPeriod();
 
@@ -333,13 +367,27 @@ void Song::processNextBuffer()
 
 		if (static_cast<f_cnt_t>(frameOffsetInTick) == 0)
 		{
+			if (m_exportSegment)
+			{
+				const auto ticks = getPlayPos().getTicks();
+				const auto frame = m_exportFrames + frameOffsetInPeriod;
+				if (m_exportSegmentBeginFrame < 0 && ticks >= m_exportSegmentBegin) { m_exportSegmentBeginFrame = frame; }
+				if (m_exportSegmentEndFrame < 0 && ticks >= m_exportSegmentEnd) { m_exportSegmentEndFrame = frame; }
+			}
+
 			// First frame of tick: process automation and play tracks
-			processAutomations(trackList, getPlayPos(), framesToPlay);
+			processAutomations(trackList, getPlayPos(), frameOffsetInTick, frameOffsetInPeriod, framesToPlay);
 			for (const auto track : trackList)
 			{
 				track->play(getPlayPos(), framesToPlay, frameOffsetInPeriod, clipNum);
 			}
 		}
+		else if (frameOffsetInPeriod == 0)
+		{
+			// The rest of a tick that began in the last period: the automation
+			// has to go on sample-exact in this one
+			processAutomations(trackList, getPlayPos(), frameOffsetInTick, frameOffsetInPeriod, framesToPlay);
+		}
 
 		// Update frame counters
 		frameOffsetInPeriod += framesToPlay;
@@ -349,13 +397,54 @@ void Song::processNextBuffer()
 		m_elapsedBars = getPlayPos(PlayMode::Song).getBar();
 		m_elapsedTicks = (getPlayPos(PlayMode::Song).getTicks() % ticksPerBar()) / 48;
 	}
+
+	if (m_exporting) { m_exportFrames += framesPerPeriod; }
 }
 
 
-void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp_t)
+void Song::prefetchAhead(const TrackList& tracks)
 {
-	AutomatedValueMap values;
+	// far enough for a stream to read its first blocks and the note pool to
+	// grow, looking again every second finds what was added in between
+	constexpr auto LookAheadSeconds = 3;
+	constexpr auto RescanSeconds = 1;
+
+	const auto ticksPerSecond = Engine::audioEngine()->processingSampleRate() / Engine::framesPerTick();
+	const auto lookAhead = static_cast<tick_t>(LookAheadSeconds * ticksPerSecond);
+	const auto pos = getPlayPos().getTicks();
+	if (m_prefetchedAt >= 0 && pos >= m_prefetchedAt && pos < m_prefetchedAt + RescanSeconds * ticksPerSecond)
+	{
+		return;
+	}
+	m_prefetchedAt = pos;
+
+	// what comes after the end of the loop is its beginning
+	const auto& timeline = getTimeline();
+	auto end = pos + lookAhead;
+	auto wrapped = 0;
+	if (!m_exporting && timeline.loopEnabled() && pos < timeline.loopEnd() && end > timeline.loopEnd())
+	{
+		wrapped = end - timeline.loopEnd();
+		end = timeline.loopEnd();
+	}
+
+	int notes = 0;
+	for (const auto track : tracks)
+	{
+		notes += track->prefetch(TimePos{pos}, TimePos{end});
+		if (wrapped > 0)
+		{
+			const auto begin = timeline.loopBegin().getTicks();
+			notes += track->prefetch(TimePos{begin}, TimePos{begin + std::min(wrapped, lookAhead)});
+		}
+	}
+	NotePlayHandleManager::expect(notes);
+}
+
 
+void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, float frameOffsetInTick,
+	f_cnt_t frameOffsetInPeriod, fpp_t frames)
+{
 	QSet<const AutomatableModel*> recordedModels;
 
 	TrackContainer* container = this;
@@ -378,53 +467,78 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		return;
 	}
 
-	values = container->automatedValuesAt(timeStart, clipNum);
-	const TrackList& tracks = container->tracks();
-
-	Track::clipVector clips;
-	for (Track* track : tracks)
+	if (container == this)
 	{
-		if (track->type() == Track::Type::Automation) {
-			track->getClipsInRange(clips, 0, timeStart);
+		auto trackList = TrackList{m_globalAutomationTrack};
+		trackList.insert(trackList.end(), tracks().begin(), tracks().end());
+		m_automationIndex.sourcesAt(trackList, timeStart, m_automationSources);
+	}
+	else
+	{
+		const AutomationSourceMap sources = container->automationSourcesAt(timeStart, clipNum);
+		m_automationSources.clear();
+		for (auto it = sources.begin(); it != sources.end(); ++it)
+		{
+			m_automationSources.emplace_back(it.key(), it.value());
 		}
 	}
 
+	m_automatedModels.clear();
+	for (const auto& source : m_automationSources)
+	{
+		m_automatedModels.push_back(source.first);
+	}
+	std::sort(m_automatedModels.begin(), m_automatedModels.end());
+
 	// Process recording
-	for (Clip* clip : clips)
+	for (Track* track : container->tracks())
 	{
-		auto p = dynamic_cast<AutomationClip *>(clip);
-		TimePos relTime = timeStart - p->startPosition();
-		if (p->isRecording() && relTime >= 0 && relTime < p->length())
+		if (track->type() != Track::Type::Automation) { continue; }
+
+		for (Clip* clip : track->getClips())
 		{
-			const AutomatableModel* recordedModel = p->firstObject();
-			p->recordValue(relTime, recordedModel->value<float>());
+			auto p = dynamic_cast<AutomationClip *>(clip);
+			TimePos relTime = timeStart - p->startPosition();
+			if (p->isRecording() && relTime >= 0 && relTime < p->length())
+			{
+				const AutomatableModel* recordedModel = p->firstObject();
+				p->recordValue(relTime, recordedModel->value<float>());
 
-			recordedModels << recordedModel;
+				recordedModels << recordedModel;
+			}
 		}
 	}
 
 	// Checks if an automated model stopped being automated by automation clip
 	// so we can move the control back to any connected controller again
-	for (auto it = m_oldAutomatedValues.begin(); it != m_oldAutomatedValues.end(); it++)
+	for (AutomatableModel* am : m_oldAutomatedModels)
 	{
-		AutomatableModel * am = it.key();
-		if (am->controllerConnection() && !values.contains(am))
+		if (am->controllerConnection()
+			&& !std::binary_search(m_automatedModels.begin(), m_automatedModels.end(), am))
 		{
 			am->setUseControllerValue(true);
 		}
 	}
-	m_oldAutomatedValues = values;
+	std::swap(m_oldAutomatedModels, m_automatedModels);
 
-	// Apply values
-	for (auto it = values.begin(); it != values.end(); it++)
+	// Apply values, sample-exact where the automation changes within the
+	// frames we play now
+	const auto framesPerTick = Engine::framesPerTick();
+	PeriodAllocator<float>::vector frameValues(frames);
+	for (const auto& [model, source] : m_automationSources)
 	{
-		if (! recordedModels.contains(it.key()))
+		if (! recordedModels.contains(model))
 		{
-			it.key()->setAutomatedValue(it.value());
+			if (source.moving && source.clip->valuesAt(source.time.getTicks() + frameOffsetInTick / framesPerTick,
+				1.f / framesPerTick, frameValues.data(), frames))
+			{
+				model->setAutomatedValues(frameValues.data(), frameOffsetInPeriod, frames);
+			}
+			model->setAutomatedValue(source.clip->valueAt(source.time));
 		}
-		else if (!it.key()->useControllerValue())
+		else if (!model->useControllerValue())
 		{
-			it.key()->setUseControllerValue(true);
+			model->setUseControllerValue(true);
 		}
 	}
 }
@@ -682,12 +796,11 @@ void Song::stop()
 
 	// Moves the control of the models that were processed on the last frame
 	// back to their controllers.
-	for (auto it = m_oldAutomatedValues.begin(); it != m_oldAutomatedValues.end(); it++)
+	for (AutomatableModel* am : m_oldAutomatedModels)
 	{
-		AutomatableModel * am = it.key();
 		am->setUseControllerValue(true);
 	}
-	m_oldAutomatedValues.clear();
+	m_oldAutomatedModels.clear();
 
 	m_playMode = PlayMode::None;
 
@@ -709,7 +822,15 @@ void Song::startExport()
 
 	const auto& timeline = getTimeline(PlayMode::Song);
 
-	if (m_renderBetweenMarkers)
+	if (m_exportSegment)
+	{
+		m_exportSongBegin = m_exportLoopBegin = m_exportLoopEnd
+			= TimePos{std::max(m_exportSegmentBegin - m_exportSegmentPreroll, 0)};
+		m_exportSongEnd = TimePos{m_exportSegmentEnd + m_exportSegmentOverlap};
+
+		getPlayPos(PlayMode::Song).setTicks(m_exportSongBegin.getTicks());
+	}
+	else if (m_renderBetweenMarkers)
 	{
 		m_exportSongBegin = m_exportLoopBegin = timeline.loopBegin();
 		m_exportSongEnd = m_exportLoopEnd = timeline.loopEnd();
@@ -742,7 +863,10 @@ void Song::startExport()
 
 	m_exportEffectiveLength = (m_exportLoopBegin - m_exportSongBegin) + (m_exportLoopEnd - m_exportLoopBegin) 
 		* m_loopRenderCount + (m_exportSongEnd - m_exportLoopEnd);
-	m_loopRenderRemaining = m_loopRenderCount;
+	// a segment plays straight through, the loop is in the way
+	m_loopRenderRemaining = m_exportSegment ? 1 : m_loopRenderCount;
+	m_exportFrames = 0;
+	m_exportSegmentBeginFrame = m_exportSegmentEndFrame = -1;
 
 	playSong();
 
@@ -752,6 +876,18 @@ void Song::startExport()
 
 
 
+void Song::setExportSegment(tick_t begin, tick_t end, tick_t preroll, tick_t overlap)
+{
+	m_exportSegment = true;
+	m_exportSegmentBegin = begin;
+	m_exportSegmentEnd = end;
+	m_exportSegmentPreroll = preroll;
+	m_exportSegmentOverlap = overlap;
+}
+
+
+
+
 void Song::stopExport()
 {
 	stop();
@@ -824,11 +960,11 @@ bpm_t Song::getTempo()
 }
 
 
-AutomatedValueMap Song::automatedValuesAt(TimePos time, int clipNum) const
+AutomationSourceMap Song::automationSourcesAt(TimePos time, int clipNum) const
 {
 	auto trackList = TrackList{m_globalAutomationTrack};
 	trackList.insert(trackList.end(), tracks().begin(), tracks().end());
-	return TrackContainer::automatedValuesFromTracks(trackList, time, clipNum);
+	return TrackContainer::automationSourcesFromTracks(trackList, time, clipNum);
 }
 
 
@@ -886,8 +1022,8 @@ void Song::clearProject()
 	m_masterPitchModel.reset();
 	m_timeSigModel.reset();
 
-	// Clear the m_oldAutomatedValues AutomatedValueMap
-	m_oldAutomatedValues.clear();
+	// Forget which models were automated
+	m_oldAutomatedModels.clear();
 
 	AutomationClip::globalAutomationClip( &m_tempoModel )->clear();
 	AutomationClip::globalAutomationClip( &m_masterVolumeModel )->
@@ -1089,6 +1225,41 @@ void Song::loadProject( const QString & fileName )
 		}
 	}
 
+	// decode all samples in parallel, while the tracks are loaded and ask for them one after another
+	// in a single walk over the document rather than one per tag, it can be large
+	QStringList sampleFiles;
+	std::vector<SampleCache::Preload::Embedded> embeddedSamples;
+	const QDomElement content = dataFile.content();
+	for (QDomElement element = content.firstChildElement(); !element.isNull();)
+	{
+		const QString tagName = element.tagName();
+		if (tagName == "sampleclip" || tagName == "audiofileprocessor" || tagName == "slicert")
+		{
+			const QString src = element.attribute("src");
+			if (!src.isEmpty() && !sampleFiles.contains(src)) { sampleFiles.append(src); }
+
+			// no file, the frames are in the project then, see the loadSettings() of each
+			const bool clip = tagName == "sampleclip";
+			const QString data = element.attribute(clip ? "data" : "sampledata");
+			if (src.isEmpty() && !data.isEmpty())
+			{
+				const int sampleRate = clip && element.hasAttribute("sample_rate")
+					? element.attribute("sample_rate").toInt()
+					: static_cast<int>(Engine::audioEngine()->processingSampleRate());
+				embeddedSamples.push_back({data, sampleRate});
+			}
+		}
+
+		// depth first: the children, else the next sibling of this or of the closest parent that has one
+		QDomElement next = element.firstChildElement();
+		for (QDomElement up = element; next.isNull() && up != content; up = up.parentNode().toElement())
+		{
+			next = up.nextSiblingElement();
+		}
+		element = next;
+	}
+	const SampleCache::Preload samplePreload(sampleFiles, embeddedSamples);
+
 	node = dataFile.content().firstChild();
 
 	QDomNodeList tclist=dataFile.content().elementsByTagName("trackcontainer");
@@ -1214,10 +1385,20 @@ void Song::loadProject( const QString & fileName )
 
 // only save current song as filename and do nothing else
 bool Song::saveProjectFile(const QString & filename, bool withResources)
+{
+	DataFile dataFile( DataFile::Type::SongProject );
+	saveProjectData(dataFile);
+
+	return dataFile.writeFile(filename, withResources);
+}
+
+
+
+
+void Song::saveProjectData(DataFile& dataFile)
 {
 	using gui::getGUI;
 
-	DataFile dataFile( DataFile::Type::SongProject );
 	m_savingProject = true;
 
 	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
@@ -1244,8 +1425,6 @@ bool Song::saveProjectFile(const QString & filename, bool withResources)
 	saveKeymapStates(dataFile, dataFile.content());
 
 	m_savingProject = false;
-
-	return dataFile.writeFile(filename, withResources);
 }
 
 
@@ -1381,7 +1560,7 @@ void Song::restoreKeymapStates(const QDomElement &element)
 }
 
 
-void Song::exportProjectMidi(QString const & exportFileName) const
+bool Song::exportProjectMidi(QString const & exportFileName) const
 {
 	// instantiate midi export plugin
 	TrackContainer::TrackList const & tracks = this->tracks();
@@ -1390,13 +1569,12 @@ void Song::exportProjectMidi(QString const & exportFileName) const
 	ExportFilter *exf = dynamic_cast<ExportFilter *> (Plugin::instantiate("midiexport", nullptr, nullptr));
 	if (exf)
 	{
-		exf->tryExport(tracks, patternStoreTracks, getTempo(), m_masterPitchModel.value(), exportFileName);
-	}
-	else
-	{
-		qDebug() << "failed to load midi export filter!";
+		const bool successful = exf->tryExport(tracks, patternStoreTracks, getTempo(),
+			m_masterPitchModel.value(), exportFileName);
+		return successful;
 	}
-
+	qDebug() << "failed to load midi export filter!";
+	return false;
 }
 
 
@@ -33,6 +33,7 @@
 #include <QVariant>
 
 #include "AutomationClip.h"
+#include "AutomationIndex.h"
 #include "AutomationTrack.h"
 #include "ConfigManager.h"
 #include "Engine.h"
@@ -326,6 +327,8 @@ void Track::loadSettings( const QDomElement & element )
 Clip * Track::addClip( Clip * clip )
 {
 	m_clips.push_back( clip );
+	AutomationIndex::invalidate();
+	invalidateClipIndex();
 
 	emit clipAdded( clip );
 
@@ -345,6 +348,8 @@ void Track::removeClip( Clip * clip )
 	if( it != m_clips.end() )
 	{
 		m_clips.erase( it );
+		AutomationIndex::invalidate();
+		invalidateClipIndex();
 		if( Engine::getSong() )
 		{
 			Engine::getSong()->updateLength();
@@ -438,14 +443,38 @@ int Track::getClipNum( const Clip * clip )
  *  \param start The MIDI start time of the range.
  *  \param end   The MIDI endi time of the range.
  */
-void Track::getClipsInRange( clipVector & clipV, const TimePos & start,
+void Track::getClipsInRange( periodClipVector & clipV, const TimePos & start,
 							const TimePos & end )
 {
-	for( Clip* clip : m_clips )
+	const auto lock = std::lock_guard{m_clipIndexMutex};
+
+	const int revision = m_clipRevision.load();
+	if (revision != m_clipIndexRevision)
+	{
+		m_clipIndex.clear();
+		for (Clip* clip : m_clips)
+		{
+			m_clipIndex.push_back({clip->startPosition().getTicks(), clip->endPosition().getTicks(), clip});
+		}
+		// stable, so clips starting together stay in the order they'd be found in m_clips
+		std::stable_sort(m_clipIndex.begin(), m_clipIndex.end(),
+			[](const ClipRange& a, const ClipRange& b) { return a.start < b.start; });
+		for (std::size_t i = 1; i < m_clipIndex.size(); ++i)
+		{
+			m_clipIndex[i].latestEnd = std::max(m_clipIndex[i].latestEnd, m_clipIndex[i - 1].latestEnd);
+		}
+		m_clipIndexRevision = revision;
+	}
+
+	// the clips that start by end, from the first one that any of them ends after start on
+	const auto last = std::upper_bound(m_clipIndex.begin(), m_clipIndex.end(), end.getTicks(),
+		[](tick_t ticks, const ClipRange& range) { return ticks < range.start; });
+	const auto first = std::lower_bound(m_clipIndex.begin(), last, start.getTicks(),
+		[](const ClipRange& range, tick_t ticks) { return range.latestEnd < ticks; });
+	for (auto it = first; it != last; ++it)
 	{
-		int s = clip->startPosition();
-		int e = clip->endPosition();
-		if( ( s <= end ) && ( e >= start ) )
+		Clip* clip = it->clip;
+		if (clip->endPosition() >= start)
 		{
 			// Clip is within given range
 			// Insert sorted by Clip's position
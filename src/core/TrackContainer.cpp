@@ -252,13 +252,26 @@ bool TrackContainer::isEmpty() const
 
 AutomatedValueMap TrackContainer::automatedValuesAt(TimePos time, int clipNum) const
 {
-	return automatedValuesFromTracks(tracks(), time, clipNum);
+	const AutomationSourceMap sources = automationSourcesAt(time, clipNum);
+
+	AutomatedValueMap valueMap;
+	for (auto it = sources.begin(); it != sources.end(); ++it)
+	{
+		valueMap[it.key()] = it->clip->valueAt(it->time);
+	}
+	return valueMap;
+}
+
+
+AutomationSourceMap TrackContainer::automationSourcesAt(TimePos time, int clipNum) const
+{
+	return automationSourcesFromTracks(tracks(), time, clipNum);
 }
 
 
-AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
+AutomationSourceMap TrackContainer::automationSourcesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
 {
-	Track::clipVector clips;
+	Track::periodClipVector clips;
 
 	for (Track* track: tracks)
 	{
@@ -282,7 +295,7 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	AutomatedValueMap valueMap;
+	AutomationSourceMap sourceMap;
 
 	Q_ASSERT(std::is_sorted(clips.begin(), clips.end(), Clip::comparePosition));
 
@@ -297,31 +310,19 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 			if (! p->hasAutomation()) {
 				continue;
 			}
-			TimePos relTime = time - p->startPosition();
-			if (! p->getAutoResize()) {
-				relTime = std::min(relTime, p->length());
-			}
-			float value = p->valueAt(relTime);
-
+			const AutomationSource source = automationSource(p, time);
 			for (AutomatableModel* model : p->objects())
 			{
-				valueMap[model] = value;
+				sourceMap[model] = source;
 			}
 		}
 		else if (auto* pattern = dynamic_cast<PatternClip*>(clip))
 		{
-			auto patIndex = dynamic_cast<class PatternTrack*>(pattern->getTrack())->patternIndex();
-			auto patStore = Engine::patternStore();
-
-			TimePos patTime = time - clip->startPosition();
-			patTime = std::min(patTime, clip->length());
-			patTime = patTime % (patStore->lengthOfPattern(patIndex) * TimePos::ticksPerBar());
-
-			auto patValues = patStore->automatedValuesAt(patTime, patIndex);
-			for (auto it=patValues.begin(); it != patValues.end(); it++)
+			auto patSources = patternAutomationSources(pattern, time);
+			for (auto it=patSources.begin(); it != patSources.end(); it++)
 			{
 				// override old values, pattern track with the highest index takes precedence
-				valueMap[it.key()] = it.value();
+				sourceMap[it.key()] = it.value();
 			}
 		}
 		else
@@ -330,8 +331,39 @@ AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tra
 		}
 	}
 
-	return valueMap;
+	return sourceMap;
 };
 
 
+AutomationSource TrackContainer::automationSource(const AutomationClip* clip, TimePos time)
+{
+	TimePos relTime = time - clip->startPosition();
+	bool moving = true;
+	if (! clip->getAutoResize()) {
+		moving = relTime < clip->length();
+		relTime = std::min(relTime, clip->length());
+	}
+	return AutomationSource{clip, relTime, moving};
+}
+
+
+AutomationSourceMap TrackContainer::patternAutomationSources(const PatternClip* clip, TimePos time)
+{
+	auto patIndex = dynamic_cast<class PatternTrack*>(clip->getTrack())->patternIndex();
+	auto patStore = Engine::patternStore();
+
+	TimePos patTime = time - clip->startPosition();
+	const bool moving = patTime < clip->length();
+	patTime = std::min(patTime, clip->length());
+	patTime = patTime % (patStore->lengthOfPattern(patIndex) * TimePos::ticksPerBar());
+
+	auto patSources = patStore->automationSourcesAt(patTime, patIndex);
+	if (!moving)
+	{
+		for (auto& source : patSources) { source.moving = false; }
+	}
+	return patSources;
+}
+
+
 } // namespace lmms
@@ -0,0 +1,332 @@
+/*
+ * TrackFreezer.cpp - render a track into a cache and play that back instead
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "TrackFreezer.h"
+
+#include <QFile>
+#include <QTemporaryFile>
+
+#include "AudioEngine.h"
+#include "AudioPort.h"
+#include "AutomationClip.h"
+#include "Clip.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "OutputSettings.h"
+#include "PatternStore.h"
+#include "RenderManager.h"
+#include "SampleBuffer.h"
+#include "SamplePlayHandle.h"
+#include "Song.h"
+#include "Track.h"
+
+
+namespace lmms
+{
+
+
+TrackFreezer::TrackFreezer( Track * track, AudioPort * trackPort ) :
+	m_track( track ),
+	m_trackPort( trackPort ),
+	m_frozen( false ),
+	m_playing( false ),
+	m_renderSampleRate( 0 )
+{
+	// same as for sample clips: restart the playback whenever the song
+	// starts, stops or jumps
+	connect( Engine::getSong(), SIGNAL(playbackStateChanged()),
+			this, SLOT(stopPlaying()), Qt::DirectConnection );
+	connect( Engine::getSong(), SIGNAL(updateSampleTracks()),
+			this, SLOT(stopPlaying()), Qt::DirectConnection );
+}
+
+
+
+
+TrackFreezer::~TrackFreezer()
+{
+	if( isFreezing() )
+	{
+		abortFreezing();
+	}
+	unfreeze();
+}
+
+
+
+
+bool TrackFreezer::play( const TimePos & start, f_cnt_t offset )
+{
+	if( m_playing )
+	{
+		return true;
+	}
+
+	const auto framesPerTick = Engine::framesPerTick( m_sample.sampleRate() );
+	const auto startFrame = static_cast<f_cnt_t>( start.getTicks() * framesPerTick );
+	if( startFrame >= static_cast<f_cnt_t>( m_sample.sampleSize() ) )
+	{
+		return false;
+	}
+
+	// the track might have been moved to another mixer channel
+	m_audioPort->setNextMixerChannel( m_trackPort->nextMixerChannel() );
+
+	m_sample.setStartFrame( startFrame );
+	auto handle = new SamplePlayHandle( &m_sample, false );
+	handle->setAudioPort( m_audioPort.get() );
+	handle->setTrack( m_track );
+	handle->setOffset( offset );
+	Engine::audioEngine()->addPlayHandle( handle );
+	m_playing = true;
+
+	return true;
+}
+
+
+
+
+void TrackFreezer::capture( const sampleFrame * buf, fpp_t frames )
+{
+	if( !Engine::getSong()->isExporting() )
+	{
+		return;
+	}
+
+	if( buf )
+	{
+		m_captured.insert( m_captured.end(), buf, buf + frames );
+	}
+	else
+	{
+		m_captured.resize( m_captured.size() + frames, sampleFrame{ 0, 0 } );
+	}
+}
+
+
+
+
+void TrackFreezer::freeze()
+{
+	if( m_frozen || isFreezing() )
+	{
+		return;
+	}
+
+	QTemporaryFile renderFile;
+	renderFile.setAutoRemove( false );
+	if( !renderFile.open() )
+	{
+		qWarning( "Could not create temporary file for freezing track" );
+		return;
+	}
+	m_renderFile = renderFile.fileName();
+	renderFile.close();
+
+	// only our track has to be rendered, everything else just costs time
+	const auto muteOthers = [this]( const TrackContainer::TrackList & tracks )
+	{
+		for( Track * track : tracks )
+		{
+			if( track != m_track && !track->isMuted()
+				&& ( track->type() == Track::Type::Instrument || track->type() == Track::Type::Sample ) )
+			{
+				track->setMuted( true );
+				m_mutedTracks.push_back( track );
+			}
+		}
+	};
+	muteOthers( Engine::getSong()->tracks() );
+	muteOthers( Engine::patternStore()->tracks() );
+
+	// the whole song, once, and the tail of the effects
+	Engine::getSong()->setRenderBetweenMarkers( false );
+	Engine::getSong()->setExportLoop( false );
+	Engine::getSong()->setLoopRenderCount( 1 );
+
+	m_renderSampleRate = Engine::audioEngine()->processingSampleRate();
+	const OutputSettings outputSettings( m_renderSampleRate,
+		OutputSettings::BitRateSettings( 160, false ),
+		OutputSettings::BitDepth::Depth32Bit,
+		OutputSettings::StereoMode::Stereo );
+
+	m_captured.clear();
+	m_captured.reserve( static_cast<size_t>( Engine::getSong()->length() )
+		* TimePos::ticksPerBar() * Engine::framesPerTick() );
+	m_trackPort->setFreezer( this );
+
+	m_renderManager = std::make_unique<RenderManager>(
+		Engine::audioEngine()->currentQualitySettings(), outputSettings,
+		ProjectRenderer::ExportFileFormat::Wave, m_renderFile );
+	connect( m_renderManager.get(), SIGNAL(progressChanged(int)),
+			this, SIGNAL(progressChanged(int)) );
+	connect( m_renderManager.get(), SIGNAL(finished()),
+			this, SLOT(renderFinished()) );
+	m_renderManager->renderProject();
+}
+
+
+
+
+void TrackFreezer::unfreeze()
+{
+	for( const auto & watch : m_watches )
+	{
+		disconnect( watch );
+	}
+	m_watches.clear();
+
+	if( !m_frozen )
+	{
+		return;
+	}
+
+	// the play handle refers to our audio port and sample
+	Engine::audioEngine()->removePlayHandlesOfTypes( m_track, PlayHandle::Type::SamplePlayHandle );
+	m_audioPort.reset();
+	m_sample = Sample();
+	m_playing = false;
+	m_frozen = false;
+
+	emit frozenChanged();
+}
+
+
+
+
+void TrackFreezer::abortFreezing()
+{
+	if( !isFreezing() )
+	{
+		return;
+	}
+
+	m_renderManager->abortProcessing();
+	m_trackPort->setFreezer( nullptr );
+	m_renderManager.release()->deleteLater();
+	restoreMutedTracks();
+	QFile::remove( m_renderFile );
+	m_captured.clear();
+}
+
+
+
+
+void TrackFreezer::renderFinished()
+{
+	m_trackPort->setFreezer( nullptr );
+
+	// we're called from within a signal of the render manager
+	m_renderManager.release()->deleteLater();
+	restoreMutedTracks();
+	QFile::remove( m_renderFile );
+
+	m_sample = Sample( std::make_shared<SampleBuffer>( std::move( m_captured ), m_renderSampleRate ) );
+	m_captured = {};
+
+	m_audioPort = std::make_unique<AudioPort>( m_track->name() + " (frozen)", false,
+		nullptr, nullptr, m_track->getMutedModel() );
+	m_audioPort->setNextMixerChannel( m_trackPort->nextMixerChannel() );
+	m_playing = false;
+	m_frozen = true;
+
+	watchForChanges();
+
+	emit frozenChanged();
+}
+
+
+
+
+void TrackFreezer::stopPlaying()
+{
+	m_playing = false;
+}
+
+
+
+
+void TrackFreezer::watchForChanges()
+{
+	const auto watch = [this]( const QObject * sender, const char * signal )
+	{
+		m_watches.push_back( connect( sender, signal, this, SLOT(unfreeze()) ) );
+	};
+
+	// anything that changes the clips
+	watch( m_track, SIGNAL(clipAdded(lmms::Clip*)) );
+	for( const Clip * clip : m_track->getClips() )
+	{
+		watch( clip, SIGNAL(dataChanged()) );
+		watch( clip, SIGNAL(positionChanged()) );
+		watch( clip, SIGNAL(lengthChanged()) );
+		watch( clip, SIGNAL(destroyedClip()) );
+	}
+
+	// the cache is indexed by ticks at the current tempo
+	watch( Engine::getSong(), SIGNAL(tempoChanged(lmms::bpm_t)) );
+
+	// models of the track, its instrument and its effects - muting and
+	// soloing don't affect the cache, automated models change on their own
+	// while playing, so we watch their automation clips instead
+	QList<AutomatableModel *> models = m_track->findChildren<AutomatableModel *>();
+	if( EffectChain * effects = m_trackPort->effects() )
+	{
+		watch( effects, SIGNAL(dataChanged()) );
+		models += effects->findChildren<AutomatableModel *>();
+	}
+	for( const AutomatableModel * model : models )
+	{
+		if( model == m_track->getMutedModel() || model == m_track->getSoloModel() )
+		{
+			continue;
+		}
+		if( AutomationClip::isAutomated( model ) )
+		{
+			for( const AutomationClip * clip : AutomationClip::clipsForModel( model ) )
+			{
+				watch( clip, SIGNAL(dataChanged()) );
+			}
+		}
+		else if( !model->controllerConnection() )
+		{
+			watch( model, SIGNAL(dataChanged()) );
+		}
+	}
+}
+
+
+
+
+void TrackFreezer::restoreMutedTracks()
+{
+	for( Track * track : m_mutedTracks )
+	{
+		track->setMuted( false );
+	}
+	m_mutedTracks.clear();
+}
+
+
+} // namespace lmms
@@ -0,0 +1,82 @@
+/*
+ * TruePeakMeter.cpp - the peaks of stereo audio in between its samples
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "TruePeakMeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lmms {
+
+TruePeakMeter::TruePeakMeter()
+{
+	// a Hann windowed sinc interpolating three samples in between each two
+	constexpr auto Pi = 3.14159265358979323846;
+	constexpr auto Length = 4 * Taps;
+	for (std::size_t n = 0; n < Length; ++n)
+	{
+		const auto t = (n - (Length - 1) / 2.0) / 4;
+		const auto sinc = std::sin(Pi * t) / (Pi * t);
+		const auto window = 0.5 - 0.5 * std::cos(2 * Pi * (n + 0.5) / Length);
+		m_filter[n % 4][n / 4] = static_cast<float>(sinc * window);
+	}
+}
+
+
+
+
+auto TruePeakMeter::process(int channel, float sample) -> float
+{
+	auto& history = m_history[channel];
+	history[m_pos] = sample;
+	history[m_pos + Taps] = sample;
+
+	// the newest sample is first, and the phases don't depend on each other
+	const auto window = history.data() + m_pos;
+	auto peak = std::abs(sample);
+	for (const auto& phase : m_filter)
+	{
+		auto value = 0.0f;
+		for (std::size_t tap = 0; tap < Taps; ++tap) { value += phase[tap] * window[tap]; }
+		peak = std::max(peak, std::abs(value));
+	}
+	return peak;
+}
+
+
+
+
+auto TruePeakMeter::process(const sampleFrame* frames, std::size_t count, float gain) -> float
+{
+	auto peak = 0.0f;
+	for (std::size_t f = 0; f < count; ++f)
+	{
+		peak = std::max({peak, process(0, frames[f][0] * gain), process(1, frames[f][1] * gain)});
+		nextFrame();
+	}
+	return peak;
+}
+
+
+} // namespace lmms
@@ -26,6 +26,7 @@
 
 #include "AudioDevice.h"
 #include "AudioEngine.h"
+#include "ChannelOutput.h"
 #include "ConfigManager.h"
 #include "debug.h"
 
@@ -68,7 +69,7 @@ void AudioDevice::processNextBuffer()
 	const fpp_t frames = getNextBuffer( m_buffer );
 	if( frames )
 	{
-		writeBuffer( m_buffer, frames, audioEngine()->masterGain() );
+		processBuffer( m_buffer, frames );
 	}
 	else
 	{
@@ -79,6 +80,15 @@ void AudioDevice::processNextBuffer()
 
 
 
+void AudioDevice::processBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames )
+{
+	writeBuffer( _buf, _frames, audioEngine()->masterGain() );
+}
+
+
+
+
 fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 {
 	fpp_t frames = audioEngine()->framesPerPeriod();
@@ -104,11 +114,6 @@ fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 	// release lock
 	unlock();
 
-	if( audioEngine()->hasFifoWriter() )
-	{
-		delete[] b;
-	}
-
 	return frames;
 }
 
@@ -182,6 +187,14 @@ void AudioDevice::renamePort( AudioPort * )
 
 
 
+std::unique_ptr<ChannelOutput> AudioDevice::createChannelOutput( const QString & )
+{
+	return nullptr;
+}
+
+
+
+
 fpp_t AudioDevice::resample( const surroundSampleFrame * _src,
 						const fpp_t _frames,
 						surroundSampleFrame * _dst,
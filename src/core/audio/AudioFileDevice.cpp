@@ -24,14 +24,109 @@
  */
 
 #include <QMessageBox>
+#include <QThread>
+#include <atomic>
+#include <cstdio>
+
+#include "lmmsconfig.h"
+
+#ifdef LMMS_BUILD_WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "AudioFileDevice.h"
+#include "AudioEngine.h"
 #include "ExportProjectDialog.h"
 #include "GuiApplication.h"
+#include "LocklessRingBuffer.h"
+#include "LoudnessMeter.h"
 
 namespace lmms
 {
 
+class AudioFileDevice::Encoder : public QThread
+{
+public:
+	//! Some seconds of frames, far more than a render gets ahead of the
+	//! encoder between two polls
+	static constexpr std::size_t RingFrames = 1 << 18;
+
+	//! The encoders are given at most this many frames at once
+	static constexpr std::size_t ChunkFrames = 4096;
+
+	explicit Encoder( AudioFileDevice * device ) :
+		m_device( device ),
+		m_ring( RingFrames ),
+		m_reader( m_ring )
+	{
+	}
+
+	//! Waits for room if the ring is full, an export can't lose frames
+	void write( const surroundSampleFrame * frames, fpp_t count )
+	{
+		auto written = m_ring.write( frames, count );
+		while( written < static_cast<std::size_t>( count ) )
+		{
+			QThread::usleep( 100 );
+			written += m_ring.write( frames + written, count - written );
+		}
+	}
+
+	//! Encodes the rest of the frames and stops the thread
+	void finish()
+	{
+		m_quit = true;
+		wait();
+		encodePending();
+	}
+
+private:
+	void run() override
+	{
+		while( !m_quit )
+		{
+			if( !encodePending() )
+			{
+				QThread::msleep( 1 );
+			}
+		}
+	}
+
+	bool encodePending()
+	{
+		if( m_reader.empty() )
+		{
+			return false;
+		}
+
+		while( !m_reader.empty() )
+		{
+			const auto frames = m_reader.read_max( ChunkFrames );
+			m_frames.resize( frames.size() );
+			for( std::size_t i = 0; i < frames.size(); ++i )
+			{
+				m_frames[i] = frames[i];
+			}
+			m_device->measure( m_frames.data(), static_cast<fpp_t>( m_frames.size() ) );
+			m_device->writeBuffer( m_frames.data(), static_cast<fpp_t>( m_frames.size() ),
+						m_device->audioEngine()->masterGain() );
+		}
+		return true;
+	}
+
+	AudioFileDevice * m_device;
+	LocklessRingBuffer<surroundSampleFrame> m_ring;
+	LocklessRingBufferReader<surroundSampleFrame> m_reader;
+	std::atomic<bool> m_quit = false;
+	std::vector<surroundSampleFrame> m_frames;
+} ;
+
+
+
+
 AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 					const ch_cnt_t _channels,
 					const QString & _file,
@@ -44,7 +139,11 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 
 	setSampleRate( outputSettings.getSampleRate() );
 
-	if( m_outputFile.open( QFile::WriteOnly | QFile::Truncate ) == false )
+	// "-" streams to the standard output, a named pipe is opened like a file
+	const bool opened = _file == "-"
+		? m_outputFile.open( takeStandardOutput(), QFile::WriteOnly )
+		: m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
+	if( opened == false )
 	{
 		QString title, message;
 		title = ExportProjectDialog::tr( "Could not open file" );
@@ -73,14 +172,152 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 
 
 
+int AudioFileDevice::takeStandardOutput()
+{
+	static const int handle = []
+	{
+		fflush( stdout );
+#ifdef LMMS_BUILD_WIN32
+		const int handle = _dup( _fileno( stdout ) );
+		_setmode( handle, _O_BINARY );
+		_dup2( _fileno( stderr ), _fileno( stdout ) );
+#else
+		const int handle = dup( fileno( stdout ) );
+		dup2( fileno( stderr ), fileno( stdout ) );
+#endif
+		return handle;
+	}();
+	return handle;
+}
+
+
+
+
 AudioFileDevice::~AudioFileDevice()
 {
+	// the encoder should have been finished while the subclass still existed
+	if( m_encoder )
+	{
+		m_encoder->finish();
+	}
 	m_outputFile.close();
 }
 
 
 
 
+void AudioFileDevice::writeFrames( const surroundSampleFrame * frames, fpp_t count )
+{
+	if( frames == nullptr )
+	{
+		m_silence.resize( count );
+		frames = m_silence.data();
+	}
+	encode( frames, count );
+}
+
+
+
+
+void AudioFileDevice::startEncoder()
+{
+	if( !m_encoder )
+	{
+		m_encoder = std::make_unique<Encoder>( this );
+		m_encoder->start();
+	}
+	for( const auto copy : m_copies )
+	{
+		copy->startEncoder();
+	}
+}
+
+
+
+
+void AudioFileDevice::finishEncoder()
+{
+	if( m_encoder )
+	{
+		m_encoder->finish();
+		m_encoder.reset();
+	}
+	for( const auto copy : m_copies )
+	{
+		copy->finishEncoder();
+	}
+}
+
+
+
+
+void AudioFileDevice::addCopy( AudioFileDevice * copy )
+{
+	m_copies.push_back( copy );
+}
+
+
+
+
+void AudioFileDevice::enableLoudnessReport()
+{
+	m_loudnessMeter = std::make_unique<LoudnessMeter>( sampleRate() );
+}
+
+
+
+
+bool AudioFileDevice::writeLoudnessReport() const
+{
+	const QString file = outputFile();
+	return m_loudnessMeter && file != "-" &&
+		m_loudnessMeter->writeReport( LoudnessMeter::reportFile( file ), file );
+}
+
+
+
+
+void AudioFileDevice::measure( const surroundSampleFrame * frames, fpp_t count )
+{
+	if( m_loudnessMeter )
+	{
+		m_loudnessMeter->process( frames, count, audioEngine()->masterGain() );
+	}
+}
+
+
+
+
+void AudioFileDevice::processBuffer( const surroundSampleFrame * _buf,
+						const fpp_t _frames )
+{
+	encode( _buf, _frames );
+}
+
+
+
+
+void AudioFileDevice::encode( const surroundSampleFrame * frames, fpp_t count )
+{
+	if( m_encoder )
+	{
+		m_encoder->write( frames, count );
+	}
+	else
+	{
+		measure( frames, count );
+		writeBuffer( frames, count, audioEngine()->masterGain() );
+	}
+
+	for( const auto copy : m_copies )
+	{
+		copy->encode( frames, count );
+	}
+}
+
+
+
+
 int AudioFileDevice::writeData( const void* data, int len )
 {
 	if( m_outputFile.isOpen() )
@@ -0,0 +1,94 @@
+/*
+ * AudioFileRaw.cpp - audio-device which writes headerless PCM samples, to a
+ *                    file, a named pipe or the standard output
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioFileRaw.h"
+
+#include <cstring>
+
+#include "AudioEngine.h"
+#include "endian_handling.h"
+
+
+namespace lmms
+{
+
+AudioFileRaw::AudioFileRaw( OutputSettings const & outputSettings,
+				const ch_cnt_t channels, bool & successful,
+				const QString & file,
+				AudioEngine* audioEngine ) :
+	AudioFileDevice( outputSettings, channels, file, audioEngine )
+{
+	successful = outputFileOpened();
+}
+
+
+
+
+void AudioFileRaw::writeBuffer( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain )
+{
+	const int samples = _frames * channels();
+
+	switch( getOutputSettings().getBitDepth() )
+	{
+	case OutputSettings::BitDepth::Depth32Bit:
+		m_bytes.resize( samples * sizeof( float ) );
+		for( int i = 0; i < samples; ++i )
+		{
+			const float value = _ab[i / channels()][i % channels()] * _master_gain;
+			int32_t bits;
+			std::memcpy( &bits, &value, sizeof( bits ) );
+			bits = swap32IfBE( bits );
+			std::memcpy( &m_bytes[i * sizeof( float )], &bits, sizeof( bits ) );
+		}
+		break;
+
+	case OutputSettings::BitDepth::Depth24Bit:
+		m_bytes.resize( samples * 3 );
+		for( int i = 0; i < samples; ++i )
+		{
+			const auto value = static_cast<int32_t>( AudioEngine::clip(
+				_ab[i / channels()][i % channels()] * _master_gain ) * 8388607.0f );
+			m_bytes[i * 3] = static_cast<char>( value & 0xff );
+			m_bytes[i * 3 + 1] = static_cast<char>( ( value >> 8 ) & 0xff );
+			m_bytes[i * 3 + 2] = static_cast<char>( ( value >> 16 ) & 0xff );
+		}
+		break;
+
+	case OutputSettings::BitDepth::Depth16Bit:
+	default:
+		m_bytes.resize( samples * BYTES_PER_INT_SAMPLE );
+		convertToS16( _ab, _frames, _master_gain,
+				reinterpret_cast<int_sample_t *>( m_bytes.data() ),
+				!isLittleEndian() );
+		break;
+	}
+
+	writeData( m_bytes.data(), static_cast<int>( m_bytes.size() ) );
+}
+
+
+} // namespace lmms
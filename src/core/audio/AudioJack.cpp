@@ -26,23 +26,129 @@
 
 #ifdef LMMS_HAVE_JACK
 
+#include <algorithm>
+
+#include <QCheckBox>
 #include <QFormLayout>
 #include <QLineEdit>
 #include <QMessageBox>
 
 #include "AudioEngine.h"
+#include "ChannelOutput.h"
 #include "ConfigManager.h"
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "LcdSpinBox.h"
 #include "MainWindow.h"
 #include "MidiJack.h"
+#include "MixHelpers.h"
 #include "gui_templates.h"
 
 namespace lmms
 {
 
 
+class AudioJack::JackChannelOutput : public ChannelOutput
+{
+public:
+	JackChannelOutput(AudioJack* jack, const QString& name)
+		: ChannelOutput(jack->audioEngine()->periodsInFlight(), jack->audioEngine()->framesPerPeriod())
+		, m_jack(jack)
+		, m_name(name)
+	{
+		// JACK may wait for the process callback while it registers ports,
+		// so that is done without the lock the callback takes
+		registerPorts();
+		const auto lock = std::lock_guard{m_jack->m_channelOutputsMutex};
+		m_jack->m_channelOutputs.push_back(this);
+	}
+
+	~JackChannelOutput() override
+	{
+		{
+			const auto lock = std::lock_guard{m_jack->m_channelOutputsMutex};
+			m_jack->m_channelOutputs.erase(
+				std::find(m_jack->m_channelOutputs.begin(), m_jack->m_channelOutputs.end(), this));
+		}
+		if (m_jack->m_client == nullptr) { return; }
+		for (jack_port_t* port : m_ports)
+		{
+			if (port != nullptr) { jack_port_unregister(m_jack->m_client, port); }
+		}
+	}
+
+	void rename(const QString& name) override
+	{
+		{
+			const auto lock = std::lock_guard{m_jack->m_channelOutputsMutex};
+			m_name = name;
+		}
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			if (m_ports[ch] == nullptr) { continue; }
+#ifdef LMMS_HAVE_JACK_PRENAME
+			jack_port_rename(m_jack->m_client, m_ports[ch], portName(ch).constData());
+#else
+			jack_port_set_name(m_ports[ch], portName(ch).constData());
+#endif
+		}
+	}
+
+	//! With the client of the device - also when it was restarted, before
+	//! it is activated again
+	void registerPorts()
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			m_ports[ch] = m_jack->m_client == nullptr ? nullptr
+				: jack_port_register(m_jack->m_client, portName(ch).constData(), JACK_DEFAULT_AUDIO_TYPE,
+					JackPortIsOutput, 0);
+		}
+	}
+
+	// the process callback calls these the way it plays the master
+
+	void beginCycle(jack_nframes_t nframes)
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			m_buffers[ch] = m_ports[ch] == nullptr ? nullptr
+				: static_cast<jack_default_audio_sample_t*>(jack_port_get_buffer(m_ports[ch], nframes));
+		}
+	}
+
+	using ChannelOutput::playPeriod;
+
+	void play(jack_nframes_t done, f_cnt_t offset, jack_nframes_t frames)
+	{
+		ChannelOutput::play(m_buffers[0] == nullptr ? nullptr : m_buffers[0] + done,
+			m_buffers[1] == nullptr ? nullptr : m_buffers[1] + done, offset, frames);
+	}
+
+	void silence(jack_nframes_t done, jack_nframes_t nframes)
+	{
+		for (jack_default_audio_sample_t* buffer : m_buffers)
+		{
+			if (buffer != nullptr) { std::fill(buffer + done, buffer + nframes, 0.f); }
+		}
+	}
+
+private:
+	QByteArray portName(int ch) const
+	{
+		return (m_name + (ch == 0 ? " L" : " R")).toLatin1();
+	}
+
+	AudioJack* m_jack;
+	QString m_name;
+	jack_port_t* m_ports[2] = {nullptr, nullptr};
+	//! Those of the ports in this cycle, none if it was added during the cycle
+	jack_default_audio_sample_t* m_buffers[2] = {nullptr, nullptr};
+};
+
+
+
+
 AudioJack::AudioJack(bool& successful, AudioEngine* audioEngineParam)
 	: AudioDevice(
 		// clang-format off
@@ -56,6 +162,7 @@ AudioJack::AudioJack(bool& successful, AudioEngine* audioEngineParam)
 	, m_client(nullptr)
 	, m_active(false)
 	, m_midiClient(nullptr)
+	, m_renderInCallback(ConfigManager::inst()->value("audiojack", "renderincallback").toInt())
 	, m_tempOutBufs(new jack_default_audio_sample_t*[channels()])
 	, m_outBuf(new surroundSampleFrame[audioEngine()->framesPerPeriod()])
 	, m_framesDoneInCurBuf(0)
@@ -75,12 +182,6 @@ AudioJack::AudioJack(bool& successful, AudioEngine* audioEngineParam)
 AudioJack::~AudioJack()
 {
 	AudioJack::stopProcessing();
-#ifdef AUDIO_PORT_SUPPORT
-	while (m_portMap.size())
-	{
-		unregisterPort(m_portMap.begin().key());
-	}
-#endif
 
 	if (m_client != nullptr)
 	{
@@ -175,6 +276,13 @@ bool AudioJack::initJackClient()
 		}
 	}
 
+	// the ports of the mixer channels went with the client, if it was restarted
+	const auto lock = std::lock_guard{m_channelOutputsMutex};
+	for (JackChannelOutput* output : m_channelOutputs)
+	{
+		output->registerPorts();
+	}
+
 	return true;
 }
 
@@ -248,60 +356,9 @@ void AudioJack::applyQualitySettings()
 
 
 
-void AudioJack::registerPort(AudioPort* port)
+std::unique_ptr<ChannelOutput> AudioJack::createChannelOutput(const QString& name)
 {
-#ifdef AUDIO_PORT_SUPPORT
-	// make sure, port is not already registered
-	unregisterPort(port);
-	const QString name[2] = {port->name() + " L", port->name() + " R"};
-
-	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
-	{
-		m_portMap[port].ports[ch] = jack_port_register(
-			m_client, name[ch].toLatin1().constData(), JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0);
-	}
-#else
-	(void)port;
-#endif
-}
-
-
-
-
-void AudioJack::unregisterPort(AudioPort* port)
-{
-#ifdef AUDIO_PORT_SUPPORT
-	if (m_portMap.contains(port))
-	{
-		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
-		{
-			if (m_portMap[port].ports[ch] != nullptr) { jack_port_unregister(m_client, m_portMap[port].ports[ch]); }
-		}
-		m_portMap.erase(m_portMap.find(port));
-	}
-#else
-	(void)port;
-#endif
-}
-
-void AudioJack::renamePort(AudioPort* port)
-{
-#ifdef AUDIO_PORT_SUPPORT
-	if (m_portMap.contains(port))
-	{
-		const QString name[2] = {port->name() + " L", port->name() + " R"};
-		for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
-		{
-#ifdef LMMS_HAVE_JACK_PRENAME
-			jack_port_rename(m_client, m_portMap[port].ports[ch], name[ch].toLatin1().constData());
-#else
-			jack_port_set_name(m_portMap[port].ports[ch], name[ch].toLatin1().constData());
-#endif
-		}
-	}
-#else
-	(void)port;
-#endif // AUDIO_PORT_SUPPORT
+	return std::make_unique<JackChannelOutput>(this, name);
 }
 
 
@@ -323,28 +380,22 @@ int AudioJack::processCallback(jack_nframes_t nframes)
 		m_tempOutBufs[c] = (jack_default_audio_sample_t*)jack_port_get_buffer(m_outputPorts[c], nframes);
 	}
 
-#ifdef AUDIO_PORT_SUPPORT
-	const int frames = std::min<int>(nframes, audioEngine()->framesPerPeriod());
-	for (JackPortMap::iterator it = m_portMap.begin(); it != m_portMap.end(); ++it)
+	auto channelOutputsLock = std::unique_lock{m_channelOutputsMutex};
+	for (JackChannelOutput* output : m_channelOutputs)
 	{
-		for (ch_cnt_t ch = 0; ch < channels(); ++ch)
-		{
-			if (it.value().ports[ch] == nullptr) { continue; }
-			jack_default_audio_sample_t* buf
-				= (jack_default_audio_sample_t*)jack_port_get_buffer(it.value().ports[ch], nframes);
-			for (int frame = 0; frame < frames; ++frame)
-			{
-				buf[frame] = it.key()->buffer()[frame][ch];
-			}
-		}
+		output->beginCycle(nframes);
 	}
-#endif
 
 	jack_nframes_t done = 0;
 	while (done < nframes && !m_stopped)
 	{
 		jack_nframes_t todo = std::min<jack_nframes_t>(nframes - done, m_framesToDoInCurBuf - m_framesDoneInCurBuf);
 		const float gain = audioEngine()->masterGain();
+#ifdef LMMS_DISABLE_SURROUND
+		// the frames are stereo then, which the mix kernels split into the port buffers
+		MixHelpers::deinterleaveMultiplied(m_outBuf + m_framesDoneInCurBuf, m_tempOutBufs[0] + done,
+			m_tempOutBufs[1] + done, gain, static_cast<int>(todo));
+#else
 		for (int c = 0; c < channels(); ++c)
 		{
 			jack_default_audio_sample_t* o = m_tempOutBufs[c];
@@ -353,17 +404,34 @@ int AudioJack::processCallback(jack_nframes_t nframes)
 				o[done + frame] = m_outBuf[m_framesDoneInCurBuf + frame][c] * gain;
 			}
 		}
+#endif
+		for (JackChannelOutput* output : m_channelOutputs)
+		{
+			output->play(done, m_framesDoneInCurBuf, todo);
+		}
 		done += todo;
 		m_framesDoneInCurBuf += todo;
 		if (m_framesDoneInCurBuf == m_framesToDoInCurBuf)
 		{
+			// rendering may wait for someone adding or removing an output
+			channelOutputsLock.unlock();
 			m_framesToDoInCurBuf = getNextBuffer(m_outBuf);
+			channelOutputsLock.lock();
 			m_framesDoneInCurBuf = 0;
 			if (!m_framesToDoInCurBuf)
 			{
 				m_stopped = true;
 				break;
 			}
+
+			// the channels wrote their periods at the processing rate, so
+			// they can only go along with the master if it isn't resampled
+			const auto period = audioEngine()->processingSampleRate() == sampleRate()
+				? audioEngine()->servedPeriod() : 0;
+			for (JackChannelOutput* output : m_channelOutputs)
+			{
+				output->playPeriod(period);
+			}
 		}
 	}
 
@@ -374,6 +442,10 @@ int AudioJack::processCallback(jack_nframes_t nframes)
 			jack_default_audio_sample_t* b = m_tempOutBufs[c] + done;
 			memset(b, 0, sizeof(*b) * (nframes - done));
 		}
+		for (JackChannelOutput* output : m_channelOutputs)
+		{
+			output->silence(done, nframes);
+		}
 	}
 
 	return 0;
@@ -420,6 +492,12 @@ AudioJack::setupWidget::setupWidget(QWidget* parent)
 	m_channels->setModel(m);
 
 	form->addRow(tr("Channels"), m_channels);
+
+	m_renderInCallback = new QCheckBox(tr("Render in the process callback"), this);
+	m_renderInCallback->setToolTip(tr("Lowers the latency by a buffer, but every buffer has to be done "
+		"within the time JACK gives its clients"));
+	m_renderInCallback->setChecked(ConfigManager::inst()->value("audiojack", "renderincallback").toInt());
+	form->addRow(m_renderInCallback);
 }
 
 
@@ -437,6 +515,7 @@ void AudioJack::setupWidget::saveSettings()
 {
 	ConfigManager::inst()->setValue("audiojack", "clientname", m_clientName->text());
 	ConfigManager::inst()->setValue("audiojack", "channels", QString::number(m_channels->value<int>()));
+	ConfigManager::inst()->setValue("audiojack", "renderincallback", QString::number(m_renderInCallback->isChecked()));
 }
 
 
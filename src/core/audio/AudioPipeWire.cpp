@@ -0,0 +1,352 @@
+/*
+ * AudioPipeWire.cpp - support for PipeWire, with ports like JACK
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AudioPipeWire.h"
+
+#ifdef LMMS_HAVE_PIPEWIRE
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QFormLayout>
+#include <QLineEdit>
+
+#include "AudioEngine.h"
+#include "ChannelOutput.h"
+#include "ConfigManager.h"
+#include "MixHelpers.h"
+
+namespace lmms
+{
+
+
+class AudioPipeWire::PipeWireChannelOutput : public ChannelOutput
+{
+public:
+	PipeWireChannelOutput(AudioPipeWire* device, const QString& name)
+		: ChannelOutput(device->audioEngine()->periodsInFlight(), device->audioEngine()->framesPerPeriod())
+		, m_device(device)
+	{
+		pw_thread_loop_lock(m_device->m_loop);
+		m_ports[0] = m_device->addPort(name + " L", nullptr);
+		m_ports[1] = m_device->addPort(name + " R", nullptr);
+		pw_thread_loop_unlock(m_device->m_loop);
+
+		const auto lock = std::lock_guard{m_device->m_channelOutputsMutex};
+		m_device->m_channelOutputs.push_back(this);
+	}
+
+	~PipeWireChannelOutput() override
+	{
+		{
+			const auto lock = std::lock_guard{m_device->m_channelOutputsMutex};
+			m_device->m_channelOutputs.erase(
+				std::find(m_device->m_channelOutputs.begin(), m_device->m_channelOutputs.end(), this));
+		}
+
+		pw_thread_loop_lock(m_device->m_loop);
+		for (void* port : m_ports)
+		{
+			if (port != nullptr) { pw_filter_remove_port(port); }
+		}
+		pw_thread_loop_unlock(m_device->m_loop);
+	}
+
+	void rename(const QString& name) override
+	{
+		pw_thread_loop_lock(m_device->m_loop);
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			if (m_ports[ch] == nullptr) { continue; }
+			const auto portName = (name + (ch == 0 ? " L" : " R")).toUtf8();
+			const spa_dict_item item = {PW_KEY_PORT_NAME, portName.constData()};
+			const spa_dict dict = {0, 1, &item};
+			pw_filter_update_properties(m_device->m_filter, m_ports[ch], &dict);
+		}
+		pw_thread_loop_unlock(m_device->m_loop);
+	}
+
+	// the process callback calls these the way it plays the master
+
+	void beginCycle(f_cnt_t frames)
+	{
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			m_buffers[ch] = m_ports[ch] == nullptr ? nullptr
+				: static_cast<float*>(pw_filter_get_dsp_buffer(m_ports[ch], frames));
+		}
+	}
+
+	using ChannelOutput::playPeriod;
+
+	void play(f_cnt_t done, f_cnt_t offset, f_cnt_t frames)
+	{
+		ChannelOutput::play(m_buffers[0] == nullptr ? nullptr : m_buffers[0] + done,
+			m_buffers[1] == nullptr ? nullptr : m_buffers[1] + done, offset, frames);
+	}
+
+	void silence(f_cnt_t done, f_cnt_t frames)
+	{
+		for (float* buffer : m_buffers)
+		{
+			if (buffer != nullptr) { std::fill(buffer + done, buffer + frames, 0.f); }
+		}
+	}
+
+private:
+	AudioPipeWire* m_device;
+	void* m_ports[2] = {nullptr, nullptr};
+	//! Those of the ports in this cycle, none if it was added during the cycle
+	float* m_buffers[2] = {nullptr, nullptr};
+};
+
+
+
+
+AudioPipeWire::AudioPipeWire(bool& successful, AudioEngine* audioEngineParam)
+	: AudioDevice(DEFAULT_CHANNELS, audioEngineParam)
+	, m_loop(nullptr)
+	, m_context(nullptr)
+	, m_core(nullptr)
+	, m_filter(nullptr)
+	, m_filterListener{}
+	, m_filterEvents{}
+	, m_stopped(true)
+	, m_masterPorts{nullptr, nullptr}
+	, m_outBuf(new surroundSampleFrame[audioEngine()->framesPerPeriod()])
+	, m_framesDoneInCurBuf(0)
+	, m_framesToDoInCurBuf(0)
+{
+	successful = false;
+	pw_init(nullptr, nullptr);
+
+	QString nodeName = ConfigManager::inst()->value("audiopipewire", "nodename");
+	if (nodeName.isEmpty()) { nodeName = "LMMS"; }
+
+	m_loop = pw_thread_loop_new("lmms-pipewire", nullptr);
+	if (m_loop == nullptr) { return; }
+	m_context = pw_context_new(pw_thread_loop_get_loop(m_loop), nullptr, 0);
+	if (m_context == nullptr || pw_thread_loop_start(m_loop) != 0) { return; }
+
+	pw_thread_loop_lock(m_loop);
+	m_core = pw_context_connect(m_context, nullptr, 0);
+	if (m_core == nullptr)
+	{
+		pw_thread_loop_unlock(m_loop);
+		printf("Could not connect to PipeWire\n");
+		return;
+	}
+
+	// ask for a period as the quantum, at the rate the audio engine runs at -
+	// the graph may run differently anyway, see process()
+	const auto latency = QString("%1/%2").arg(audioEngine()->framesPerPeriod()).arg(sampleRate()).toLatin1();
+	const auto rate = QString("1/%1").arg(sampleRate()).toLatin1();
+	m_filter = pw_filter_new(m_core, nodeName.toUtf8().constData(), pw_properties_new(
+		PW_KEY_MEDIA_TYPE, "Audio",
+		PW_KEY_MEDIA_CATEGORY, "Playback",
+		PW_KEY_MEDIA_ROLE, "Production",
+		PW_KEY_MEDIA_CLASS, "Stream/Output/Audio",
+		PW_KEY_NODE_AUTOCONNECT, "true",
+		PW_KEY_NODE_LATENCY, latency.constData(),
+		PW_KEY_NODE_RATE, rate.constData(),
+		nullptr));
+	if (m_filter != nullptr)
+	{
+		m_filterEvents.version = PW_VERSION_FILTER_EVENTS;
+		m_filterEvents.process = processCallback;
+		pw_filter_add_listener(m_filter, &m_filterListener, &m_filterEvents, this);
+
+		// the channel positions let the session manager link them to the default sink
+		m_masterPorts[0] = addPort("master out L", "FL");
+		m_masterPorts[1] = addPort("master out R", "FR");
+		successful = m_masterPorts[0] != nullptr && m_masterPorts[1] != nullptr
+			&& pw_filter_connect(m_filter, PW_FILTER_FLAG_RT_PROCESS, nullptr, 0) == 0;
+	}
+	pw_thread_loop_unlock(m_loop);
+
+	if (!successful) { printf("Could not set up the PipeWire node\n"); }
+}
+
+
+
+
+AudioPipeWire::~AudioPipeWire()
+{
+	AudioPipeWire::stopProcessing();
+
+	if (m_loop != nullptr) { pw_thread_loop_stop(m_loop); }
+	if (m_filter != nullptr) { pw_filter_destroy(m_filter); }
+	if (m_core != nullptr) { pw_core_disconnect(m_core); }
+	if (m_context != nullptr) { pw_context_destroy(m_context); }
+	if (m_loop != nullptr) { pw_thread_loop_destroy(m_loop); }
+	pw_deinit();
+
+	delete[] m_outBuf;
+}
+
+
+
+
+void AudioPipeWire::startProcessing()
+{
+	m_stopped = false;
+}
+
+
+
+
+void AudioPipeWire::stopProcessing()
+{
+	m_stopped = true;
+}
+
+
+
+
+std::unique_ptr<ChannelOutput> AudioPipeWire::createChannelOutput(const QString& name)
+{
+	return std::make_unique<PipeWireChannelOutput>(this, name);
+}
+
+
+
+
+void* AudioPipeWire::addPort(const QString& name, const char* channel)
+{
+	// called with the thread loop locked
+	pw_properties* props = pw_properties_new(
+		PW_KEY_FORMAT_DSP, "32 bit float mono audio",
+		PW_KEY_PORT_NAME, name.toUtf8().constData(),
+		nullptr);
+	if (channel != nullptr) { pw_properties_set(props, PW_KEY_AUDIO_CHANNEL, channel); }
+	return pw_filter_add_port(m_filter, PW_DIRECTION_OUTPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS, 0, props, nullptr, 0);
+}
+
+
+
+
+void AudioPipeWire::processCallback(void* data, spa_io_position* position)
+{
+	static_cast<AudioPipeWire*>(data)->process(position);
+}
+
+
+
+
+void AudioPipeWire::process(spa_io_position* position)
+{
+	if (position == nullptr) { return; }
+
+	// the quantum of this cycle, the graph may change it any time
+	const auto nframes = static_cast<f_cnt_t>(position->clock.duration);
+
+	// the periods get resampled if the graph doesn't run at the rate asked for
+	const auto rate = static_cast<sample_rate_t>(position->clock.rate.denom);
+	if (rate != 0 && rate != sampleRate()) { setSampleRate(rate); }
+
+	const auto left = static_cast<float*>(pw_filter_get_dsp_buffer(m_masterPorts[0], nframes));
+	const auto right = static_cast<float*>(pw_filter_get_dsp_buffer(m_masterPorts[1], nframes));
+
+	auto channelOutputsLock = std::unique_lock{m_channelOutputsMutex};
+	for (PipeWireChannelOutput* output : m_channelOutputs)
+	{
+		output->beginCycle(nframes);
+	}
+
+	f_cnt_t done = 0;
+	while (done < nframes && !m_stopped)
+	{
+		const f_cnt_t todo = std::min(nframes - done, m_framesToDoInCurBuf - m_framesDoneInCurBuf);
+		if (left != nullptr && right != nullptr)
+		{
+			MixHelpers::deinterleaveMultiplied(m_outBuf + m_framesDoneInCurBuf, left + done, right + done,
+				audioEngine()->masterGain(), todo);
+		}
+		for (PipeWireChannelOutput* output : m_channelOutputs)
+		{
+			output->play(done, m_framesDoneInCurBuf, todo);
+		}
+		done += todo;
+		m_framesDoneInCurBuf += todo;
+		if (m_framesDoneInCurBuf == m_framesToDoInCurBuf)
+		{
+			// rendering may wait for someone adding or removing an output
+			channelOutputsLock.unlock();
+			m_framesToDoInCurBuf = getNextBuffer(m_outBuf);
+			channelOutputsLock.lock();
+			m_framesDoneInCurBuf = 0;
+			if (!m_framesToDoInCurBuf)
+			{
+				m_stopped = true;
+				break;
+			}
+
+			// the channels wrote their periods at the processing rate
+			const auto period = audioEngine()->processingSampleRate() == sampleRate()
+				? audioEngine()->servedPeriod() : 0;
+			for (PipeWireChannelOutput* output : m_channelOutputs)
+			{
+				output->playPeriod(period);
+			}
+		}
+	}
+
+	if (done != nframes)
+	{
+		if (left != nullptr) { std::fill(left + done, left + nframes, 0.f); }
+		if (right != nullptr) { std::fill(right + done, right + nframes, 0.f); }
+		for (PipeWireChannelOutput* output : m_channelOutputs)
+		{
+			output->silence(done, nframes);
+		}
+	}
+}
+
+
+
+
+AudioPipeWire::setupWidget::setupWidget(QWidget* parent)
+	: AudioDeviceSetupWidget(AudioPipeWire::name(), parent)
+{
+	QFormLayout* form = new QFormLayout(this);
+
+	QString nodeName = ConfigManager::inst()->value("audiopipewire", "nodename");
+	if (nodeName.isEmpty()) { nodeName = "LMMS"; }
+	m_nodeName = new QLineEdit(nodeName, this);
+
+	form->addRow(tr("Node name"), m_nodeName);
+}
+
+
+
+
+void AudioPipeWire::setupWidget::saveSettings()
+{
+	ConfigManager::inst()->setValue("audiopipewire", "nodename", m_nodeName->text());
+}
+
+
+} // namespace lmms
+
+#endif // LMMS_HAVE_PIPEWIRE
@@ -23,13 +23,17 @@
  */
 
 #include "AudioPort.h"
-#include "AudioDevice.h"
+#include "AudioFileDevice.h"
 #include "AudioEngine.h"
+#include "AudioEngineTracer.h"
+#include "AudioEngineWorkerThread.h"
 #include "EffectChain.h"
 #include "Mixer.h"
 #include "Engine.h"
 #include "MixHelpers.h"
 #include "BufferManager.h"
+#include "PeriodArena.h"
+#include "TrackFreezer.h"
 
 namespace lmms
 {
@@ -38,11 +42,18 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain,
 		FloatModel * volumeModel, FloatModel * panningModel,
 		BoolModel * mutedModel ) :
 	m_bufferUsage( false ),
+	m_bufferSilent( false ),
+	m_pendingInputs( 0 ),
+	m_freezer( nullptr ),
+	m_stemFile( nullptr ),
+	m_monitorInput( false ),
 	m_portBuffer( BufferManager::acquire() ),
 	m_extOutputEnabled( false ),
 	m_nextMixerChannel( 0 ),
 	m_name( "unnamed port" ),
+	m_cpuAccount( Engine::audioEngine()->profiler(), _name ),
 	m_effects( _has_effect_chain ? new EffectChain( nullptr ) : nullptr ),
+	m_sourceLatency( 0 ),
 	m_volumeModel( volumeModel ),
 	m_panningModel( panningModel ),
 	m_mutedModel( mutedModel )
@@ -86,12 +97,22 @@ void AudioPort::setExtOutputEnabled( bool _enabled )
 void AudioPort::setName( const QString & _name )
 {
 	m_name = _name;
+	m_cpuAccount.setName( _name );
 	Engine::audioEngine()->audioDev()->renamePort( this );
 }
 
 
 
 
+void AudioPort::addCpuTime( int time )
+{
+	m_cpuAccount.add( time );
+	Engine::mixer()->mixerChannel( m_nextMixerChannel )->addCpuTime( time );
+}
+
+
+
+
 bool AudioPort::processEffects()
 {
 	if( m_effects )
@@ -103,131 +124,171 @@ bool AudioPort::processEffects()
 }
 
 
+
+
+f_cnt_t AudioPort::latency() const
+{
+	return m_sourceLatency + ( m_effects ? m_effects->latency() : 0 );
+}
+
+
 void AudioPort::doProcessing()
 {
-	if( m_mutedModel && m_mutedModel->value() )
+	AudioEngineTracer::Scope traceScope( "AudioPort" );
+	MicroTimer timer;
+
+	if( !m_mutedModel || !m_mutedModel->value() )
+	{
+		processPlayHandles();
+	}
+	else
 	{
-		return;
+		if( m_freezer )
+		{
+			m_freezer->capture( nullptr, Engine::audioEngine()->framesPerPeriod() );
+		}
+		if( m_stemFile )
+		{
+			m_stemFile->writeFrames( nullptr, Engine::audioEngine()->framesPerPeriod() );
+		}
 	}
+	addCpuTime( timer.elapsed() );
+
+	// the mixer channel may be waiting for us
+	Engine::mixer()->inputProcessed( m_nextMixerChannel );
+}
+
+
 
-	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
-	// clear the buffer
-	BufferManager::clear( m_portBuffer, fpp );
+void AudioPort::processPlayHandles()
+{
+	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
-	//qDebug( "Playhandles: %d", m_playHandles.size() );
-	for( PlayHandle * ph : m_playHandles ) // now we mix all playhandle buffers into the audioport buffer
+	PeriodAllocator<const sampleFrame*>::vector buffers;
+	for( PlayHandle * ph : m_playHandles )
 	{
-		if( ph->buffer() )
+		if( ph->buffer() && ph->usesBuffer()
+			&& ( ph->type() == PlayHandle::Type::NotePlayHandle
+				|| !MixHelpers::isSilent( ph->buffer(), fpp ) ) )
 		{
-			if( ph->usesBuffer()
-				&& ( ph->type() == PlayHandle::Type::NotePlayHandle
-					|| !MixHelpers::isSilent( ph->buffer(), fpp ) ) )
-			{
-				m_bufferUsage = true;
-				MixHelpers::add( m_portBuffer, ph->buffer(), fpp );
-			}
-			ph->releaseBuffer(); 	// gets rid of playhandle's buffer and sets
-									// pointer to null, so if it doesn't get re-acquired we know to skip it next time
+			buffers.push_back( ph->buffer() );
+		}
+	}
+	if( m_monitorInput )
+	{
+		const sampleFrame * input = Engine::audioEngine()->monitorInput();
+		if( !MixHelpers::isSilent( input, fpp ) )
+		{
+			buffers.push_back( input );
 		}
 	}
 
-	if( m_bufferUsage )
+	if( buffers.empty() )
 	{
-		// handle volume and panning
-		// has both vol and pan models
+		// clear the buffer, unless nothing got written to it since last time
+		if( !m_bufferSilent )
+		{
+			BufferManager::clear( m_portBuffer, fpp );
+			m_bufferSilent = true;
+		}
+	}
+	else
+	{
+		m_bufferUsage = true;
+		m_bufferSilent = false;
+
+		// as of now there's no situation where we only have panning model but no volume model
+		// if we have neither, we don't have to do anything here - just pass the audio as is
+		MixHelpers::StereoGain gain;
+		if( m_volumeModel )
+		{
+			gain.volumeBuffer = m_volumeModel->valueBuffer();
+			if( !gain.volumeBuffer ) { gain.volume = m_volumeModel->value(); }
+		}
 		if( m_volumeModel && m_panningModel )
 		{
-			ValueBuffer * volBuf = m_volumeModel->valueBuffer();
-			ValueBuffer * panBuf = m_panningModel->valueBuffer();
+			gain.panningBuffer = m_panningModel->valueBuffer();
+			if( !gain.panningBuffer ) { gain.panning = m_panningModel->value(); }
+		}
 
-			// both vol and pan have s.ex.data:
-			if( volBuf && panBuf )
+		// the first buffer overwrites what's left from the last period, and
+		// volume and panning get applied while adding the last one, so each
+		// sample is written only once per play handle
+		for( std::size_t i = 0; i < buffers.size(); ++i )
+		{
+			const bool first = i == 0;
+			const bool last = i + 1 == buffers.size();
+			if( last && first && m_volumeModel )
 			{
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					float p = panBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
+				MixHelpers::copyWithGain( m_portBuffer, buffers[i], gain, fpp );
 			}
-
-			// only vol has s.ex.data:
-			else if( volBuf )
+			else if( last && m_volumeModel )
 			{
-				float p = m_panningModel->value() * 0.01f;
-				float l = ( p <= 0 ? 1.0f : 1.0f - p );
-				float r = ( p >= 0 ? 1.0f : 1.0f + p );
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= v * l;
-					m_portBuffer[f][1] *= v * r;
-				}
+				MixHelpers::addWithGain( m_portBuffer, buffers[i], gain, fpp );
 			}
-
-			// only pan has s.ex.data:
-			else if( panBuf )
+			else if( first )
 			{
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float p = panBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
+				std::copy_n( buffers[i], fpp, m_portBuffer );
 			}
-
-			// neither has s.ex.data:
 			else
 			{
-				float p = m_panningModel->value() * 0.01f;
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
+				MixHelpers::add( m_portBuffer, buffers[i], fpp );
 			}
 		}
+	}
 
-		// has vol model only
-		else if( m_volumeModel )
+	for( PlayHandle * ph : m_playHandles )
+	{
+		if( ph->buffer() )
 		{
-			ValueBuffer * volBuf = m_volumeModel->valueBuffer();
-
-			if( volBuf )
-			{
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= v;
-					m_portBuffer[f][1] *= v;
-				}
-			}
-			else
-			{
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					m_portBuffer[f][0] *= v;
-					m_portBuffer[f][1] *= v;
-				}
-			}
+			ph->releaseBuffer(); 	// gets rid of playhandle's buffer and sets
+									// pointer to null, so if it doesn't get re-acquired we know to skip it next time
 		}
 	}
-	// as of now there's no situation where we only have panning model but no volume model
-	// if we have neither, we don't have to do anything here - just pass the audio as is
 
-	// handle effects
+	// handle effects - they might produce output without any input
+	if( m_effects && m_effects->isActive( m_bufferUsage ) )
+	{
+		m_bufferSilent = false;
+	}
 	const bool me = processEffects();
-	if( me || m_bufferUsage )
+	bool hasOutput = me || m_bufferUsage;
+
+	// line up with the other inputs of the mixer channel with more latency,
+	// what went in before still has to come out when there's nothing new
+	if( ( hasOutput && m_compensation.delay() > 0 ) || m_compensation.hasTail() )
+	{
+		m_compensation.process( m_portBuffer, fpp, hasOutput );
+		m_bufferSilent = false;
+		hasOutput = true;
+	}
+
+	if( hasOutput )
 	{
 		Engine::mixer()->mixToChannel( m_portBuffer, m_nextMixerChannel ); 	// send output to mixer
 																			// TODO: improve the flow here - convert to pull model
 		m_bufferUsage = false;
 	}
+
+	if( m_freezer )
+	{
+		m_freezer->capture( hasOutput ? m_portBuffer : nullptr, fpp );
+	}
+	if( m_stemFile )
+	{
+		m_stemFile->writeFrames( hasOutput ? m_portBuffer : nullptr, fpp );
+	}
+}
+
+
+void AudioPort::inputProcessed()
+{
+	// m_pendingInputs is only non-zero while rendering the task graph
+	if( m_pendingInputs > 0 && --m_pendingInputs == 0 )
+	{
+		AudioEngineWorkerThread::addJob( this );
+	}
 }
 
 
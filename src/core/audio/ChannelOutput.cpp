@@ -0,0 +1,93 @@
+/*
+ * ChannelOutput.cpp - an output of a single mixer channel offered by a driver
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ChannelOutput.h"
+
+#include <algorithm>
+
+#include "MixHelpers.h"
+
+namespace lmms
+{
+
+
+ChannelOutput::ChannelOutput( int periods, fpp_t framesPerPeriod ) :
+	m_framesPerPeriod( framesPerPeriod ),
+	m_samples( static_cast<std::size_t>( periods ) * framesPerPeriod * 2 ),
+	m_periods( new std::atomic<std::uint64_t>[periods] ),
+	m_slots( periods )
+{
+	for( int slot = 0; slot < m_slots; ++slot )
+	{
+		m_periods[slot].store( 0, std::memory_order_relaxed );
+	}
+}
+
+
+
+
+void ChannelOutput::write( const sampleFrame * buf, fpp_t frames, float gain, std::uint64_t period )
+{
+	// the slot can't be read now, the period in it is older than all the
+	// driver may still be playing
+	const int slot = static_cast<int>( period % m_slots );
+	sample_t * left = m_samples.data() + static_cast<std::size_t>( slot ) * m_framesPerPeriod * 2;
+	frames = std::min( frames, m_framesPerPeriod );
+	MixHelpers::deinterleaveMultiplied( buf, left, left + m_framesPerPeriod, gain, frames );
+	m_periods[slot].store( period, std::memory_order_release );
+}
+
+
+
+
+void ChannelOutput::playPeriod( std::uint64_t period )
+{
+	const int slot = static_cast<int>( period % m_slots );
+	m_playing = period != 0 && m_periods[slot].load( std::memory_order_acquire ) == period
+		? m_samples.data() + static_cast<std::size_t>( slot ) * m_framesPerPeriod * 2
+		: nullptr;
+}
+
+
+
+
+void ChannelOutput::play( sample_t * left, sample_t * right, f_cnt_t offset, f_cnt_t frames ) const
+{
+	sample_t * const sides[2] = { left, right };
+	for( int side = 0; side < 2; ++side )
+	{
+		if( sides[side] == nullptr ) { continue; }
+		if( m_playing == nullptr )
+		{
+			std::fill_n( sides[side], frames, 0.0f );
+		}
+		else
+		{
+			std::copy_n( m_playing + side * m_framesPerPeriod + offset, frames, sides[side] );
+		}
+	}
+}
+
+
+} // namespace lmms
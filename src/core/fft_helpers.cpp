@@ -26,12 +26,122 @@
 
 #include "fft_helpers.h"
 
+#include <algorithm>
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include <QDir>
+#include <QFile>
+
+#include "PathUtil.h"
 #include "lmms_constants.h"
 
 namespace lmms
 {
 
+namespace
+{
+
+struct PlanKey
+{
+	bool realToComplex;
+	unsigned int size;
+	int inAlignment;
+	int outAlignment;
+	bool inPlace;
+
+	bool operator<(const PlanKey& other) const
+	{
+		return std::tie(realToComplex, size, inAlignment, outAlignment, inPlace)
+			< std::tie(other.realToComplex, other.size, other.inAlignment, other.outAlignment, other.inPlace);
+	}
+};
+
+
+//! Guards the plans and everything else of FFTW's planner, which isn't thread-safe
+std::mutex s_planMutex;
+std::map<PlanKey, fftwf_plan> s_plans;
+bool s_wisdomLoaded = false;
+
+
+QByteArray wisdomFile()
+{
+	return QFile::encodeName(PathUtil::cacheDir() + "/fftw-wisdom");
+}
+
+
+fftwf_plan sharedPlan(const PlanKey& key)
+{
+	const auto guard = std::lock_guard{s_planMutex};
+	const auto it = s_plans.find(key);
+	if (it != s_plans.end()) { return it->second; }
+
+	if (!s_wisdomLoaded)
+	{
+		fftwf_import_wisdom_from_filename(wisdomFile().constData());
+		s_wisdomLoaded = true;
+	}
+
+	// FFTW_MEASURE tries the transform out, on arrays of our own which are
+	// aligned like the caller's, off by less than the widest SIMD alignment.
+	// The complex array is the bigger one.
+	constexpr auto MaxAlignment = 64;
+	const auto bytes = sizeof(fftwf_complex) * (key.size / 2 + 1) + MaxAlignment;
+	auto inArray = static_cast<char*>(fftwf_malloc(bytes));
+	auto outArray = key.inPlace ? inArray : static_cast<char*>(fftwf_malloc(bytes));
+	char* in = inArray + key.inAlignment;
+	char* out = key.inPlace ? in : outArray + key.outAlignment;
+
+	const auto plan = key.realToComplex
+		? fftwf_plan_dft_r2c_1d(key.size, reinterpret_cast<float*>(in), reinterpret_cast<fftwf_complex*>(out),
+			FFTW_MEASURE)
+		: fftwf_plan_dft_c2r_1d(key.size, reinterpret_cast<fftwf_complex*>(in), reinterpret_cast<float*>(out),
+			FFTW_MEASURE);
+
+	if (outArray != inArray) { fftwf_free(outArray); }
+	fftwf_free(inArray);
+
+	if (plan != nullptr)
+	{
+		s_plans.emplace(key, plan);
+		// so the next start knows this size already
+		if (QDir().mkpath(PathUtil::cacheDir()))
+		{
+			fftwf_export_wisdom_to_filename(wisdomFile().constData());
+		}
+	}
+	return plan;
+}
+
+} // namespace
+
+
+fftwf_plan realToComplexPlan(unsigned int size, float *in, fftwf_complex *out)
+{
+	return sharedPlan({true, size, fftwf_alignment_of(in), fftwf_alignment_of(reinterpret_cast<float*>(out)),
+		static_cast<void*>(in) == static_cast<void*>(out)});
+}
+
+
+fftwf_plan complexToRealPlan(unsigned int size, fftwf_complex *in, float *out)
+{
+	return sharedPlan({false, size, fftwf_alignment_of(reinterpret_cast<float*>(in)), fftwf_alignment_of(out),
+		static_cast<void*>(in) == static_cast<void*>(out)});
+}
+
+
+void destroySharedFFTPlans()
+{
+	const auto guard = std::lock_guard{s_planMutex};
+	for (const auto& [key, plan] : s_plans)
+	{
+		fftwf_destroy_plan(plan);
+	}
+	s_plans.clear();
+}
+
 
 /* Returns biggest value from abs_spectrum[spec_size] array.
  *
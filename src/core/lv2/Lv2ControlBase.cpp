@@ -172,6 +172,55 @@ void Lv2ControlBase::copyBuffersToLmms(sampleFrame *buf, fpp_t frames) const {
 
 
 
+void Lv2ControlBase::copyBuffersFromLmms(const PlanarBuffer &buf, fpp_t frames)
+{
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		c->copyBuffersFromCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+void Lv2ControlBase::copyBuffersToLmms(PlanarBuffer &buf, fpp_t frames) const
+{
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		c->copyBuffersToCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+bool Lv2ControlBase::connectBuffersToLmms(PlanarBuffer &in, PlanarBuffer &out)
+{
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs)
+	{
+		if (!c->connectBuffersToCore(in, out, firstChan, m_channelsPerProc)) { return false; }
+		firstChan += m_channelsPerProc;
+	}
+	return true;
+}
+
+
+
+
+bool Lv2ControlBase::canProcessInPlace() const
+{
+	return std::all_of(m_procs.begin(), m_procs.end(),
+		[](const auto& c) { return c->canProcessInPlace(); });
+}
+
+
+
+
 void Lv2ControlBase::run(fpp_t frames) {
 	for (const auto& c : m_procs) { c->run(frames); }
 }
@@ -32,6 +32,7 @@
 #include <lv2/lv2plug.in/ns/ext/buf-size/buf-size.h>
 #include <lv2/lv2plug.in/ns/ext/options/options.h>
 #include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+#include <lv2/lv2plug.in/ns/lv2core/lv2.h>
 #include <QDebug>
 #include <QElapsedTimer>
 
@@ -174,6 +175,9 @@ Lv2Manager::Lv2Manager() :
 	m_supportedFeatureURIs.insert(LV2_URID__unmap);
 	m_supportedFeatureURIs.insert(LV2_OPTIONS__options);
 	m_supportedFeatureURIs.insert(LV2_WORKER__schedule);
+	// inputs and outputs are only connected to the same buffer if the
+	// plugin doesn't require this
+	m_supportedFeatureURIs.insert(LV2_CORE__inPlaceBroken);
 	// min/max is always passed in the options
 	m_supportedFeatureURIs.insert(LV2_BUF_SIZE__boundedBlockLength);
 	// block length is only changed initially in AudioEngine CTOR
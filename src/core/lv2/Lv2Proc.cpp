@@ -26,6 +26,7 @@
 
 #ifdef LMMS_HAVE_LV2
 
+#include <algorithm>
 #include <cmath>
 #include <lv2/lv2plug.in/ns/ext/midi/midi.h>
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
@@ -45,7 +46,7 @@
 #include "Lv2Evbuf.h"
 #include "MidiEvent.h"
 #include "MidiEventToByteSeq.h"
-#include "NoCopyNoMove.h"
+#include "PlanarBuffer.h"
 
 
 namespace lmms
@@ -56,8 +57,7 @@ namespace lmms
 struct MidiInputEvent
 {
 	MidiEvent ev;
-	TimePos time;
-	f_cnt_t offset;
+	f_cnt_t frame; //!< where in the period it happens
 };
 
 
@@ -169,33 +169,12 @@ Plugin::Type Lv2Proc::check(const LilvPlugin *plugin,
 
 
 
-class Lv2ProcSuspender : NoCopyNoMove
-{
-public:
-	Lv2ProcSuspender(Lv2Proc* proc)
-		: m_proc(proc)
-		, m_wasActive(proc->m_instance)
-	{
-		if (m_wasActive) { m_proc->shutdownPlugin(); }
-	}
-	~Lv2ProcSuspender()
-	{
-		if (m_wasActive) { m_proc->initPlugin(); }
-	}
-private:
-	Lv2Proc* const m_proc;
-	const bool m_wasActive;
-};
-
-
-
-
 Lv2Proc::Lv2Proc(const LilvPlugin *plugin, Model* parent) :
 	LinkedModelGroup(parent),
 	m_plugin(plugin),
 	m_workLock(1),
-	m_midiInputBuf(m_maxMidiInputEvents),
-	m_midiInputReader(m_midiInputBuf)
+	m_midiInputEvents(m_maxMidiInputEvents),
+	m_midiInputBatch(m_maxMidiInputEvents)
 {
 	createPorts();
 	initPlugin();
@@ -209,7 +188,36 @@ Lv2Proc::~Lv2Proc() { shutdownPlugin(); }
 
 
 
-void Lv2Proc::reload() { Lv2ProcSuspender(this); }
+void Lv2Proc::reload()
+{
+	if (!m_instance) { return; }
+
+	// the old instance keeps running meanwhile, with the same ports
+	Lv2Features features;
+	Lv2Options options;
+	std::unique_ptr<Lv2Worker> worker;
+	LilvInstance* instance = instantiate(features, options, worker);
+	if (!instance)
+	{
+		// better keep the one we have
+		return;
+	}
+
+	Engine::audioEngine()->requestChangeInModel();
+	std::swap(m_instance, instance);
+	std::swap(m_features, features);
+	std::swap(m_options, options);
+	std::swap(m_worker, worker);
+	// the new instance is connected to our own audio buffers
+	m_audioPortsMoved = false;
+	Engine::audioEngine()->doneChangeInModel();
+
+	// the old one is out of the audio thread's reach now, and out of the
+	// worker's once that is gone - what it was created with goes after it
+	worker.reset();
+	lilv_instance_deactivate(instance);
+	lilv_instance_free(instance);
+}
 
 
 
@@ -277,15 +285,37 @@ void Lv2Proc::copyModelsFromCore()
 	// send pending MIDI events to atom port
 	if(m_midiIn)
 	{
+		// take all of them at once, and bring them back into the order they
+		// were pushed in
+		std::size_t count = 0;
+		for (auto e = m_midiInputEvents.popList(); e; )
+		{
+			m_midiInputBatch[count++] = e->value;
+			auto next = e->next;
+			m_midiInputEvents.free(e);
+			e = next;
+		}
+		std::reverse(m_midiInputBatch.begin(), m_midiInputBatch.begin() + count);
+
+		// atom sequences must be sorted by time, and events of the same
+		// frame must stay in order - the events hardly ever are out of order,
+		// so insertion sort has next to nothing to do
+		for (std::size_t i = 1; i < count; ++i)
+		{
+			for (std::size_t j = i; j > 0 && m_midiInputBatch[j].frame < m_midiInputBatch[j - 1].frame; --j)
+			{
+				std::swap(m_midiInputBatch[j], m_midiInputBatch[j - 1]);
+			}
+		}
+
 		LV2_Evbuf_Iterator iter = lv2_evbuf_begin(m_midiIn->m_buf.get());
-		// MIDI events waiting to go to the plugin?
-		while(m_midiInputReader.read_space() > 0)
+		const uint32_t type = Engine::getLv2Manager()->
+			uridCache()[Lv2UridCache::Id::midi_MidiEvent];
+		const auto lastFrame = static_cast<f_cnt_t>(Engine::audioEngine()->framesPerPeriod() - 1);
+		for (std::size_t i = 0; i < count; ++i)
 		{
-			const MidiInputEvent ev = m_midiInputReader.read(1)[0];
-			uint32_t atomStamp =
-				ev.time.frames(Engine::framesPerTick()) + ev.offset;
-			uint32_t type = Engine::getLv2Manager()->
-				uridCache()[Lv2UridCache::Id::midi_MidiEvent];
+			const MidiInputEvent& ev = m_midiInputBatch[i];
+			const auto atomStamp = static_cast<uint32_t>(std::clamp(ev.frame, 0, lastFrame));
 			auto buf = std::array<uint8_t, 4>{};
 			std::size_t bufsize = writeToByteSeq(ev.ev, buf.data(), buf.size());
 			if(bufsize)
@@ -328,6 +358,7 @@ void Lv2Proc::copyBuffersFromCore(const sampleFrame *buf,
 									unsigned firstChan, unsigned num,
 									fpp_t frames)
 {
+	if (m_audioPortsMoved) { connectOwnAudioBuffers(); }
 	inPorts().m_left->copyBuffersFromCore(buf, firstChan, frames);
 	if (num > 1)
 	{
@@ -368,6 +399,91 @@ void Lv2Proc::copyBuffersToCore(sampleFrame* buf,
 
 
 
+void Lv2Proc::copyBuffersFromCore(const PlanarBuffer &buf,
+									unsigned firstChan, unsigned num,
+									fpp_t frames)
+{
+	if (m_audioPortsMoved) { connectOwnAudioBuffers(); }
+	inPorts().m_left->copyBuffersFromCore(buf.channel(firstChan), frames);
+	if (num > 1)
+	{
+		// see above
+		if (inPorts().m_right)
+		{
+			inPorts().m_right->copyBuffersFromCore(buf.channel(firstChan + 1), frames);
+		}
+		else
+		{
+			inPorts().m_left->averageWithBuffersFromCore(buf.channel(firstChan + 1), frames);
+		}
+	}
+}
+
+
+
+
+void Lv2Proc::copyBuffersToCore(PlanarBuffer &buf,
+								unsigned firstChan, unsigned num,
+								fpp_t frames) const
+{
+	outPorts().m_left->copyBuffersToCore(buf.channel(firstChan), frames);
+	if (num > 1)
+	{
+		// see above
+		Lv2Ports::Audio* ap = outPorts().m_right
+			? outPorts().m_right : outPorts().m_left;
+		ap->copyBuffersToCore(buf.channel(firstChan + 1), frames);
+	}
+}
+
+
+
+
+bool Lv2Proc::connectBuffersToCore(PlanarBuffer &in, PlanarBuffer &out,
+									unsigned firstChan, unsigned num)
+{
+	// mono ports for stereo channels are averaged or duplicated, which
+	// needs our own buffers
+	const bool stereo = num > 1;
+	if (!inPorts().m_left || !outPorts().m_left
+		|| stereo != (inPorts().m_right != nullptr)
+		|| stereo != (outPorts().m_right != nullptr))
+	{
+		return false;
+	}
+
+	const auto connect = [this](const Lv2Ports::Audio* port, sample_t* channel)
+	{
+		lilv_instance_connect_port(m_instance,
+			lilv_port_get_index(m_plugin, port->m_port), channel);
+	};
+	connect(inPorts().m_left, in.channel(firstChan));
+	connect(outPorts().m_left, out.channel(firstChan));
+	if (stereo)
+	{
+		connect(inPorts().m_right, in.channel(firstChan + 1));
+		connect(outPorts().m_right, out.channel(firstChan + 1));
+	}
+	m_audioPortsMoved = true;
+	return true;
+}
+
+
+
+
+void Lv2Proc::connectOwnAudioBuffers()
+{
+	// the other ports are connected to where they already are
+	for (std::size_t portNum = 0; portNum < m_ports.size(); ++portNum)
+	{
+		connectPort(portNum);
+	}
+	m_audioPortsMoved = false;
+}
+
+
+
+
 void Lv2Proc::run(fpp_t frames)
 {
 	if (m_worker)
@@ -395,23 +511,13 @@ void Lv2Proc::handleMidiInputEvent(const MidiEvent &event, const TimePos &time,
 {
 	if(m_midiIn)
 	{
-		// ringbuffer allows only one writer at a time
-		// however, this function can be called by multiple threads
-		// (different RT and non-RT!) at the same time
-		// for now, a spinlock looks like the most safe/easy compromise
-
-		// source: https://en.cppreference.com/w/cpp/atomic/atomic_flag
-		while (m_ringLock.test_and_set(std::memory_order_acquire))  // acquire lock
-			 ; // spin
-
-		MidiInputEvent ev { event, time, offset };
-		std::size_t written = m_midiInputBuf.write(&ev, 1);
-		if(written != 1)
+		// this function can be called by multiple threads (different RT and
+		// non-RT!) at the same time, which the list allows without locking
+		const f_cnt_t frame = time.frames(Engine::framesPerTick()) + offset;
+		if (!m_midiInputEvents.push(MidiInputEvent{event, frame}))
 		{
-			qWarning("MIDI ringbuffer is too small! Discarding MIDI event.");
+			qWarning("MIDI event list is full! Discarding MIDI event.");
 		}
-
-		m_ringLock.clear(std::memory_order_release);
 	}
 	else
 	{
@@ -438,27 +544,39 @@ AutomatableModel *Lv2Proc::modelAtPort(const QString &uri)
 
 void Lv2Proc::initPlugin()
 {
-	m_features.initCommon();
-	initPluginSpecificFeatures();
-	m_features.createFeatureVectors();
+	m_inPlaceBroken = lilv_plugin_has_feature(m_plugin,
+		uri(LV2_CORE__inPlaceBroken).get());
+	m_instance = instantiate(m_features, m_options, m_worker);
+	if (!m_instance) { m_valid = false; }
+}
+
+
+
+
+LilvInstance* Lv2Proc::instantiate(Lv2Features& features, Lv2Options& options,
+	std::unique_ptr<Lv2Worker>& worker)
+{
+	features.initCommon();
+	initPluginSpecificFeatures(features, options, worker);
+	features.createFeatureVectors();
 
-	m_instance = lilv_plugin_instantiate(m_plugin,
+	LilvInstance* instance = lilv_plugin_instantiate(m_plugin,
 		Engine::audioEngine()->processingSampleRate(),
-		m_features.featurePointers());
+		features.featurePointers());
 
-	if (m_instance)
+	if (instance)
 	{
 		const auto iface = static_cast<const LV2_Worker_Interface*>(
-			lilv_instance_get_extension_data(m_instance, LV2_WORKER__interface));
+			lilv_instance_get_extension_data(instance, LV2_WORKER__interface));
 		if (iface) {
-			m_worker->setHandle(lilv_instance_get_handle(m_instance));
-			m_worker->setInterface(iface);
+			worker->setHandle(lilv_instance_get_handle(instance));
+			worker->setInterface(iface);
 		}
 		for (std::size_t portNum = 0; portNum < m_ports.size(); ++portNum)
 		{
-			connectPort(portNum);
+			connectPort(portNum, instance);
 		}
-		lilv_instance_activate(m_instance);
+		lilv_instance_activate(instance);
 	}
 	else
 	{
@@ -467,8 +585,8 @@ void Lv2Proc::initPlugin()
 			<< "(URI:"
 			<< lilv_node_as_uri(lilv_plugin_get_uri(m_plugin))
 			<< ")";
-		m_valid = false;
 	}
+	return instance;
 }
 
 
@@ -478,6 +596,8 @@ void Lv2Proc::shutdownPlugin()
 {
 	if (m_valid)
 	{
+		// nobody may work for the instance anymore
+		m_worker.reset();
 		lilv_instance_deactivate(m_instance);
 		lilv_instance_free(m_instance);
 		m_instance = nullptr;
@@ -503,7 +623,7 @@ bool Lv2Proc::hasNoteInput() const
 
 
 
-void Lv2Proc::initMOptions()
+void Lv2Proc::initMOptions(Lv2Options& options)
 {
 	/*
 		sampleRate:
@@ -520,29 +640,30 @@ void Lv2Proc::initMOptions()
 	int32_t sequenceSize = defaultEvbufSize();
 
 	using Id = Lv2UridCache::Id;
-	m_options.initOption<float>(Id::param_sampleRate, sampleRate);
-	m_options.initOption<int32_t>(Id::bufsz_maxBlockLength, blockLength);
-	m_options.initOption<int32_t>(Id::bufsz_minBlockLength, blockLength);
-	m_options.initOption<int32_t>(Id::bufsz_nominalBlockLength, blockLength);
-	m_options.initOption<int32_t>(Id::bufsz_sequenceSize, sequenceSize);
-	m_options.createOptionVectors();
+	options.initOption<float>(Id::param_sampleRate, sampleRate);
+	options.initOption<int32_t>(Id::bufsz_maxBlockLength, blockLength);
+	options.initOption<int32_t>(Id::bufsz_minBlockLength, blockLength);
+	options.initOption<int32_t>(Id::bufsz_nominalBlockLength, blockLength);
+	options.initOption<int32_t>(Id::bufsz_sequenceSize, sequenceSize);
+	options.createOptionVectors();
 }
 
 
 
 
-void Lv2Proc::initPluginSpecificFeatures()
+void Lv2Proc::initPluginSpecificFeatures(Lv2Features& features, Lv2Options& options,
+	std::unique_ptr<Lv2Worker>& worker)
 {
 	// options
-	initMOptions();
-	m_features[LV2_OPTIONS__options] = const_cast<LV2_Options_Option*>(m_options.feature());
+	initMOptions(options);
+	features[LV2_OPTIONS__options] = const_cast<LV2_Options_Option*>(options.feature());
 
 	// worker (if plugin has worker extension)
 	Lv2Manager* mgr = Engine::getLv2Manager();
 	if (lilv_plugin_has_extension_data(m_plugin, mgr->uri(LV2_WORKER__interface).get())) {
 		bool threaded = !Engine::audioEngine()->renderOnly();
-		m_worker.emplace(&m_workLock, threaded);
-		m_features[LV2_WORKER__schedule] = m_worker->feature();
+		worker = std::make_unique<Lv2Worker>(&m_workLock, threaded);
+		features[LV2_WORKER__schedule] = worker->feature();
 		// note: the worker interface can not be instantiated yet - it requires m_instance. see initPlugin()
 	}
 }
@@ -841,10 +962,18 @@ struct ConnectPortVisitor : public Lv2Ports::Visitor
 // !This function must be realtime safe!
 // use createPort to create any port before connecting
 void Lv2Proc::connectPort(std::size_t num)
+{
+	connectPort(num, m_instance);
+}
+
+
+
+
+void Lv2Proc::connectPort(std::size_t num, LilvInstance* instance)
 {
 	ConnectPortVisitor connect;
 	connect.m_num = num;
-	connect.m_instance = m_instance;
+	connect.m_instance = instance;
 	m_ports[num]->accept(connect);
 }
 
@@ -28,8 +28,11 @@
 
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
 #include <lv2/lv2plug.in/ns/ext/buf-size/buf-size.h>
+#include <lv2/lv2plug.in/ns/ext/log/log.h>
 #include <lv2/lv2plug.in/ns/ext/midi/midi.h>
 #include <lv2/lv2plug.in/ns/ext/parameters/parameters.h>
+#include <lv2/lv2plug.in/ns/ext/patch/patch.h>
+#include <lv2/lv2plug.in/ns/ext/time/time.h>
 #include <QtGlobal>
 
 #include "Lv2UridMap.h"
@@ -69,6 +72,22 @@ Lv2UridCache::Lv2UridCache(UridMap &mapper)
 	init(Id::param_sampleRate, LV2_PARAMETERS__sampleRate);
 
 	for(uint32_t urid : m_cache) { Q_ASSERT(urid != noIdYet); }
+
+	// URIs that plugins commonly map, often in their run function: mapped
+	// now, so that is only a lookup that doesn't have to take the map's lock
+	for (const char* uri : {
+		LV2_ATOM__Blank, LV2_ATOM__Bool, LV2_ATOM__Chunk, LV2_ATOM__Double, LV2_ATOM__Long,
+		LV2_ATOM__Object, LV2_ATOM__Path, LV2_ATOM__Property, LV2_ATOM__Resource, LV2_ATOM__Sequence,
+		LV2_ATOM__String, LV2_ATOM__Tuple, LV2_ATOM__URI, LV2_ATOM__URID, LV2_ATOM__Vector,
+		LV2_ATOM__atomTransfer, LV2_ATOM__eventTransfer, LV2_ATOM__frameTime,
+		LV2_LOG__Error, LV2_LOG__Note, LV2_LOG__Trace, LV2_LOG__Warning,
+		LV2_PATCH__Get, LV2_PATCH__Put, LV2_PATCH__Set, LV2_PATCH__body, LV2_PATCH__property,
+		LV2_PATCH__subject, LV2_PATCH__value,
+		LV2_TIME__Position, LV2_TIME__bar, LV2_TIME__barBeat, LV2_TIME__beat, LV2_TIME__beatUnit,
+		LV2_TIME__beatsPerBar, LV2_TIME__beatsPerMinute, LV2_TIME__frame, LV2_TIME__speed })
+	{
+		mapper.map(uri);
+	}
 }
 
 
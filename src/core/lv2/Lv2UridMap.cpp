@@ -43,60 +43,76 @@ static const char* staticUnmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
 	return map->unmap(urid);
 }
 
-UridMap::UridMap()
+static std::size_t hashOf(const char* uri)
 {
+	// FNV-1a
+	std::size_t hash = 2166136261u;
+	for (; *uri; ++uri)
+	{
+		hash = (hash ^ static_cast<unsigned char>(*uri)) * 16777619u;
+	}
+	return hash;
+}
+
+UridMap::UridMap() :
+	m_slots(new std::atomic<const Entry*>[Slots]()),
+	m_unMap(new std::atomic<const char*>[MaxUrids]())
+{
+	// never reallocated, so adding an entry can't throw after publishing it
+	m_entries.reserve(MaxUrids);
+
 	m_mapFeature.handle = static_cast<LV2_URID_Map_Handle>(this);
 	m_mapFeature.map = staticMap;
 	m_unmapFeature.handle = static_cast<LV2_URID_Unmap_Handle>(this);
 	m_unmapFeature.unmap = staticUnmap;
 }
 
+const UridMap::Entry* UridMap::find(const char* uri, std::size_t hash) const
+{
+	// entries are never removed, and at least half of the slots are empty
+	for (std::size_t slot = hash & (Slots - 1);; slot = (slot + 1) & (Slots - 1))
+	{
+		const Entry* entry = m_slots[slot].load(std::memory_order_acquire);
+		if (!entry) { return nullptr; }
+		if (entry->uri == uri) { return entry; }
+	}
+}
+
 LV2_URID UridMap::map(const char *uri)
 {
-	LV2_URID result = 0u;
+	if (!uri) { return 0u; }
+
+	const std::size_t hash = hashOf(uri);
+	if (const Entry* entry = find(uri, hash)) { return entry->urid; }
 
 	// the Lv2 docs say that 0 should be returned in any case
 	// where creating an ID for the given URI fails
 	try
 	{
-		// TODO:
-		// when using C++14, we can get around any string allocation
-		// in the case the URI is already inside the map:
-		// * use `m_map.find(uri)` instead of `m_map.find(uriStr)`
-		// * to avoid temporary string construction in the `find` call, create
-		//   m_map like this:
-		//   std::unordered_map<std::string, LV2_URID,
-		//     std::hash<std::string>, std::equal<>> m_map;
-		// * move the try block inside the case where the URI is not in the map
-		const std::string uriStr = uri;
-
-		std::lock_guard<std::mutex> guard (m_MapMutex);
-
-		auto itr = m_map.find(uriStr);
-		if (itr == m_map.end())
-		{
-			// 1 is the first free URID
-			std::size_t index = 1u + m_unMap.size();
-			auto pr = m_map.emplace(std::move(uriStr), index);
-			if (pr.second)
-			{
-				m_unMap.emplace_back(pr.first->first.c_str());
-				result = static_cast<LV2_URID>(index);
-			}
-		}
-		else { result = itr->second; }
+		std::lock_guard<std::mutex> guard (m_insertMutex);
+
+		// another thread may have added it in the meantime
+		if (const Entry* entry = find(uri, hash)) { return entry->urid; }
+		if (m_entries.size() >= MaxUrids) { return 0u; }
+
+		// 1 is the first free URID
+		const auto urid = static_cast<LV2_URID>(1u + m_entries.size());
+		m_entries.emplace_back(new Entry{uri, urid});
+		const Entry* entry = m_entries.back().get();
+
+		m_unMap[urid - 1].store(entry->uri.c_str(), std::memory_order_release);
+		std::size_t slot = hash & (Slots - 1);
+		while (m_slots[slot].load(std::memory_order_relaxed)) { slot = (slot + 1) & (Slots - 1); }
+		m_slots[slot].store(entry, std::memory_order_release);
+		return urid;
 	}
-	catch(...) { /* result variable is already 0 */ }
-
-	return result;
+	catch(...) { return 0u; }
 }
 
 const char *UridMap::unmap(LV2_URID urid)
 {
 	std::size_t idx = static_cast<std::size_t>(urid) - 1;
-
-	std::lock_guard<std::mutex> guard (m_MapMutex);
-	return (idx < m_unMap.size()) ? m_unMap[idx] : nullptr;
+	return (idx < MaxUrids) ? m_unMap[idx].load(std::memory_order_acquire) : nullptr;
 }
 
 
@@ -24,11 +24,17 @@
 
 #include "Lv2Worker.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <QDebug>
 
 #ifdef LMMS_HAVE_LV2
 
+#include "AudioEngineWorkerThread.h"
 #include "Engine.h"
 
 
@@ -49,6 +55,89 @@ staticWorkerRespond(LV2_Worker_Respond_Handle handle,
 
 
 
+//! The threads working for all threaded workers. Most plugins hardly ever
+//! schedule any work, so a few threads are plenty.
+class Lv2Worker::Pool
+{
+public:
+	static Pool& instance()
+	{
+		static Pool pool;
+		return pool;
+	}
+
+	void add(Lv2Worker* worker)
+	{
+		const auto lock = std::lock_guard{m_mutex};
+		m_workers.push_back(worker);
+	}
+
+	void remove(Lv2Worker* worker)
+	{
+		auto lock = std::unique_lock{m_mutex};
+		m_idle.wait(lock, [worker] { return !worker->m_busy; });
+		m_workers.erase(std::find(m_workers.begin(), m_workers.end(), worker));
+	}
+
+	//! Called from the audio thread for every request that was queued
+	void notify() { m_sem.post(); }
+
+private:
+	Pool() :
+		m_sem(0)
+	{
+		for (auto& thread : m_threads) { thread = std::thread(&Pool::threadFunc, this); }
+	}
+
+	~Pool()
+	{
+		m_exit = true;
+		for (std::size_t i = 0; i < m_threads.size(); ++i) { m_sem.post(); }
+		for (auto& thread : m_threads) { thread.join(); }
+	}
+
+	void threadFunc()
+	{
+		AudioEngineWorkerThread::avoidWorkerCores();
+
+		while (true)
+		{
+			m_sem.wait();
+			if (m_exit) { break; }
+
+			// a worker which another thread works for already is drained by
+			// that one, its requests are never worked on at the same time
+			auto lock = std::unique_lock{m_mutex};
+			const auto it = std::find_if(m_workers.begin(), m_workers.end(), [](const Lv2Worker* worker)
+				{ return !worker->m_busy && worker->m_pendingRequests > 0; });
+			if (it == m_workers.end()) { continue; }
+
+			Lv2Worker* worker = *it;
+			worker->m_busy = true;
+			do
+			{
+				--worker->m_pendingRequests;
+				lock.unlock();
+				worker->processRequest();
+				lock.lock();
+			}
+			while (worker->m_pendingRequests > 0);
+			worker->m_busy = false;
+			m_idle.notify_all();
+		}
+	}
+
+	std::array<std::thread, 2> m_threads;
+	std::vector<Lv2Worker*> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_idle; //!< a worker isn't busy anymore
+	Semaphore m_sem;
+	std::atomic<bool> m_exit = false;
+};
+
+
+
+
 std::size_t Lv2Worker::bufferSize() const
 {
 	// ardour uses this fixed size for ALSA:
@@ -67,7 +156,6 @@ Lv2Worker::Lv2Worker(Semaphore* commonWorkLock, bool threaded) :
 	m_responses(bufferSize()),
 	m_requestsReader(m_requests),
 	m_responsesReader(m_responses),
-	m_sem(0),
 	m_workLock(commonWorkLock)
 {
 	m_scheduleFeature.handle = static_cast<LV2_Worker_Schedule_Handle>(this);
@@ -78,10 +166,10 @@ Lv2Worker::Lv2Worker(Semaphore* commonWorkLock, bool threaded) :
 			return worker->scheduleWork(size, data);
 		};
 
-	if (threaded) { m_thread = std::thread(&Lv2Worker::workerFunc, this); }
-
 	m_requests.mlock();
 	m_responses.mlock();
+
+	if (threaded) { Pool::instance().add(this); }
 }
 
 
@@ -107,11 +195,7 @@ void Lv2Worker::setInterface(const LV2_Worker_Interface* newInterface)
 
 Lv2Worker::~Lv2Worker()
 {
-	m_exit = true;
-	if(m_threaded) {
-		m_sem.post();
-		m_thread.join();
-	}
+	if (m_threaded) { Pool::instance().remove(this); }
 }
 
 
@@ -145,28 +229,22 @@ LV2_Worker_Status Lv2Worker::respond(uint32_t size, const void* data)
 
 
 // Let the worker receive work from the audio thread and "work" on it
-void Lv2Worker::workerFunc()
+void Lv2Worker::processRequest()
 {
-	std::vector<char> buf;
 	uint32_t size;
-	while (true) {
-		m_sem.wait();
-		if (m_exit) { break; }
-
-		const std::size_t readSpace = m_requestsReader.read_space();
-		if (readSpace <= sizeof(size)) { continue; } // (should not happen)
-
-		m_requestsReader.read(sizeof(size)).copy((char*)&size, sizeof(size));
-		assert(size <= readSpace - sizeof(size));
-		if(size > buf.size()) { buf.resize(size); }
-		if(size) { m_requestsReader.read(size).copy(buf.data(), size); }
-
-		assert(m_handle);
-		assert(m_interface);
-		m_workLock->wait();
-		m_interface->work(m_handle, staticWorkerRespond, this, size, buf.data());
-		m_workLock->post();
-	}
+	const std::size_t readSpace = m_requestsReader.read_space();
+	if (readSpace <= sizeof(size)) { return; } // (should not happen)
+
+	m_requestsReader.read(sizeof(size)).copy((char*)&size, sizeof(size));
+	assert(size <= readSpace - sizeof(size));
+	if(size > m_request.size()) { m_request.resize(size); }
+	if(size) { m_requestsReader.read(size).copy(m_request.data(), size); }
+
+	assert(m_handle);
+	assert(m_interface);
+	m_workLock->wait();
+	m_interface->work(m_handle, staticWorkerRespond, this, size, m_request.data());
+	m_workLock->post();
 }
 
 
@@ -186,7 +264,8 @@ LV2_Worker_Status Lv2Worker::scheduleWork(uint32_t size, const void *data)
 			// Schedule a request to be executed by the worker thread
 			m_requests.write((const char*)&size, sizeof(size));
 			if(size && data) { m_requests.write((const char*)data, size); }
-			m_sem.post();
+			++m_pendingRequests;
+			Pool::instance().notify();
 		}
 	}
 	else
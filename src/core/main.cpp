@@ -35,9 +35,11 @@
 #include <QTimer>
 #include <QTranslator>
 #include <QApplication>
+#include <QDir>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QTextStream>
+#include <QThread>
 
 #ifdef LMMS_BUILD_WIN32
 #include <windows.h>
@@ -58,16 +60,23 @@
 #include <csignal>
 
 #include "MainApplication.h"
+#include "AudioEngineTracer.h"
+#include "BatchRenderer.h"
 #include "ConfigManager.h"
 #include "DataFile.h"
+#include "DistributedRenderer.h"
+#include "EffectChain.h"
 #include "NotePlayHandle.h"
+#include "RealtimeChecker.h"
 #include "embed.h"
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "ImportFilter.h"
 #include "MainWindow.h"
+#include "MemoryReport.h"
 #include "MixHelpers.h"
 #include "OutputSettings.h"
+#include "PluginFactory.h"
 #include "ProjectRenderer.h"
 #include "RenderManager.h"
 #include "Song.h"
@@ -165,6 +174,8 @@ void printHelp()
 		"  compress <in>                         Compress file <in>\n"
 		"  render <project> [options...]         Render given project file\n"
 		"  rendertracks <project> [options...]   Render each track to a different file\n"
+		"  render --batch <list> [options...]    Render every project listed in <list>,\n"
+		"                                        one per line, and report the times\n"
 		"  upgrade <in> [out]                    Upgrade file <in> and save as <out>\n"
 		"                                        Standard out is used if no output file\n"
 		"                                        is specified\n"
@@ -176,6 +187,8 @@ void printHelp()
 		"          caution).\n"
 		"  -c, --config <configfile>      Get the configuration from <configfile>\n"
 		"  -h, --help                     Show this usage information and exit.\n"
+		"      --trace <out>              Write a timeline of the audio engine to\n"
+		"          <out> in the Chrome trace event format.\n"
 		"  -v, --version                  Show version information and exit.\n"
 		"\nOptions if no action is given:\n"
 		"      --geometry <geometry>      Specify the size and position of\n"
@@ -183,12 +196,22 @@ void printHelp()
 		"          geometry is <xsizexysize+xoffset+yoffsety>.\n"
 		"      --import <in> [-e]         Import MIDI or Hydrogen file <in>.\n"
 		"          If -e is specified lmms exits after importing the file.\n"
+		"      --watchdog <ms>            Report when the user interface doesn't\n"
+		"          respond for <ms> milliseconds, with a backtrace.\n"
 		"\nOptions for \"render\" and \"rendertracks\":\n"
 		"  -a, --float                    Use 32bit float bit depth\n"
 		"  -b, --bitrate <bitrate>        Specify output bitrate in KBit/s\n"
 		"          Default: 160.\n"
+		"      --buffersize <frames>      Specify the internal block size\n"
+		"          Range: 32 to 4096, default: 256\n"
+		"      --distributed              Render segments of the song at the same\n"
+		"          time with worker processes and join them, for \"render\"\n"
 		"  -f, --format <format>         Specify format of render-output where\n"
-		"          Format is either 'wav', 'flac', 'ogg' or 'mp3'.\n"
+		"          Format is either 'wav', 'flac', 'ogg', 'mp3', 'raw' or 'mid'.\n"
+		"          'raw' is headerless little endian PCM, s16 or f32 with -a.\n"
+		"          'mid' exports the notes as a MIDI file, only for \"render\".\n"
+		"          More formats separated by commas, like 'wav,mp3',\n"
+		"          are encoded from the same render.\n"
 		"  -i, --interpolation <method>   Specify interpolation method\n"
 		"          Possible values:\n"
 		"            - linear\n"
@@ -202,17 +225,33 @@ void printHelp()
 		"            j: Joint Stereo\n"
 		"            m: Mono\n"
 		"          Default: j\n"
+		"  -j, --jobs <count>             Render with <count> processes\n"
+		"          Only for \"render --batch\" and --distributed,\n"
+		"          default: one per CPU core\n"
 		"  -o, --output <path>            Render into <path>\n"
-		"          For \"render\", provide a file path\n"
+		"          For \"render\", provide a file path, a named pipe, or\n"
+		"          - for the standard output\n"
+		"          For \"render --batch\", provide a directory path\n"
 		"          For \"rendertracks\", provide a directory path\n"
 		"          If not specified, render will overwrite the input file\n"
 		"          For \"rendertracks\", this might be required\n"
+		"      --loudness-report          Write the EBU R128 loudness, true peak and\n"
+		"          clipping of every file to <file>.loudness.json\n"
+		"  --memory-report                Print what holds how much memory after\n"
+		"          loading the project\n"
 		"  -p, --profile <out>            Dump profiling information to file <out>\n"
+		"      --preroll <bars>           Start rendering each segment <bars> early,\n"
+		"          for effect tails, only for --distributed, default: 2\n"
+		"      --realtime                 Don't render faster than the song plays\n"
 		"  -s, --samplerate <samplerate>  Specify output samplerate in Hz\n"
 		"          Range: 44100 (default) to 192000\n"
 		"  -x, --oversampling <value>     Specify oversampling\n"
 		"          Possible values: 1, 2, 4, 8\n"
-		"          Default: 2\n\n",
+		"          Default: 2\n"
+		"      --worker <command>         Render a segment with <command>, like\n"
+		"          \"ssh host lmms\", instead of a process here, for --distributed.\n"
+		"          The project and its samples have to be at the same path there.\n"
+		"          Give it once for every worker.\n\n",
 		LMMS_VERSION, LMMS_PROJECT_COPYRIGHT );
 }
 
@@ -307,8 +346,22 @@ int main( int argc, char * * argv )
 	bool exitAfterImport = false;
 	bool allowRoot = false;
 	bool renderLoop = false;
+	bool renderRealtime = false;
+	bool loudnessReport = false;
+	bool memoryReport = false;
 	bool renderTracks = false;
-	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, configFile;
+	bool renderMidi = false;
+	bool batchWorker = false;
+	bool distributed = false;
+	bool renderSegment = false;
+	int batchJobs = QThread::idealThreadCount();
+	int prerollBars = 2;
+	QStringList distributedWorkers;
+	// the ticks a worker renders of a distributed render, see DistributedRenderer
+	tick_t segmentBegin = 0, segmentEnd = 0, segmentPreroll = 0, segmentOverlap = 0;
+	int watchdogThreshold = 0;
+	QString batchList;
+	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, traceOutputFile, configFile;
 
 	// first of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -366,6 +419,8 @@ int main( int argc, char * * argv )
 	AudioEngine::qualitySettings qs( AudioEngine::qualitySettings::Mode::HighQuality );
 	OutputSettings os( 44100, OutputSettings::BitRateSettings(160, false), OutputSettings::BitDepth::Depth16Bit, OutputSettings::StereoMode::JointStereo );
 	ProjectRenderer::ExportFileFormat eff = ProjectRenderer::ExportFileFormat::Wave;
+	std::vector<ProjectRenderer::ExportFileFormat> copyFormats;
+	fpp_t renderFramesPerPeriod = DEFAULT_BUFFER_SIZE;
 
 	// second of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -484,13 +539,101 @@ int main( int argc, char * * argv )
 			}
 
 
-			fileToLoad = QString::fromLocal8Bit( argv[i] );
-			renderOut = fileToLoad;
+			const QString project = QString::fromLocal8Bit( argv[i] );
+			if( project == "--batch" )
+			{
+				++i;
+
+				if( i == argc || renderTracks )
+				{
+					return usageError( "--batch needs a project list and can't be used with rendertracks" );
+				}
+
+				batchList = QString::fromLocal8Bit( argv[i] );
+			}
+			else if( project == "--batch-worker" )
+			{
+				batchWorker = true;
+			}
+			else
+			{
+				fileToLoad = project;
+				renderOut = fileToLoad;
+			}
+		}
+		else if( arg == "--jobs" || arg == "-j" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No number of jobs specified" );
+			}
+
+			batchJobs = QString( argv[i] ).toInt();
+			if( batchJobs < 1 )
+			{
+				return usageError( QString( "Invalid number of jobs %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--distributed" )
+		{
+			distributed = true;
+		}
+		else if( arg == "--worker" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No worker command specified" );
+			}
+
+			distributedWorkers << QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "--preroll" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No pre-roll specified" );
+			}
+
+			bool ok = false;
+			prerollBars = QString( argv[i] ).toInt( &ok );
+			if( !ok || prerollBars < 0 )
+			{
+				return usageError( QString( "Invalid pre-roll %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--segment" )
+		{
+			++i;
+
+			const QStringList ticks = i < argc ? QString( argv[i] ).split( ':' ) : QStringList{};
+			if( ticks.size() != 4 )
+			{
+				return usageError( "--segment needs <begin>:<end>:<preroll>:<overlap> in ticks" );
+			}
+			segmentBegin = ticks[0].toInt();
+			segmentEnd = ticks[1].toInt();
+			segmentPreroll = ticks[2].toInt();
+			segmentOverlap = ticks[3].toInt();
+			renderSegment = true;
 		}
 		else if( arg == "--loop" || arg == "-l" )
 		{
 			renderLoop = true;
 		}
+		else if( arg == "--realtime" )
+		{
+			renderRealtime = true;
+		}
+		else if( arg == "--loudness-report" )
+		{
+			loudnessReport = true;
+		}
 		else if( arg == "--output" || arg == "-o" )
 		{
 			++i;
@@ -513,31 +656,61 @@ int main( int argc, char * * argv )
 			}
 
 
-			const QString ext = QString( argv[i] );
-
-			if( ext == "wav" )
+			// the first format is the one of the output file, the
+			// others are encoded from the same render
+			copyFormats.clear();
+			renderMidi = false;
+			const QStringList exts = QString( argv[i] ).split( ',' );
+			for( int e = 0; e < exts.size(); ++e )
 			{
-				eff = ProjectRenderer::ExportFileFormat::Wave;
-			}
+				const QString& ext = exts[e];
+				auto format = ProjectRenderer::ExportFileFormat::Wave;
+				// the notes are exported, nothing is rendered
+				if( ext == "mid" )
+				{
+					if( exts.size() > 1 )
+					{
+						return usageError( "The mid format can't be combined with others" );
+					}
+					renderMidi = true;
+				}
+				else if( ext == "wav" )
+				{
+					format = ProjectRenderer::ExportFileFormat::Wave;
+				}
 #ifdef LMMS_HAVE_OGGVORBIS
-			else if( ext == "ogg" )
-			{
-				eff = ProjectRenderer::ExportFileFormat::Ogg;
-			}
+				else if( ext == "ogg" )
+				{
+					format = ProjectRenderer::ExportFileFormat::Ogg;
+				}
 #endif
 #ifdef LMMS_HAVE_MP3LAME
-			else if( ext == "mp3" )
-			{
-				eff = ProjectRenderer::ExportFileFormat::MP3;
-			}
+				else if( ext == "mp3" )
+				{
+					format = ProjectRenderer::ExportFileFormat::MP3;
+				}
 #endif
-			else if (ext == "flac")
-			{
-				eff = ProjectRenderer::ExportFileFormat::Flac;
-			}
-			else
-			{
-				return usageError( QString( "Invalid output format %1" ).arg( argv[i] ) );
+				else if (ext == "flac")
+				{
+					format = ProjectRenderer::ExportFileFormat::Flac;
+				}
+				else if( ext == "raw" )
+				{
+					format = ProjectRenderer::ExportFileFormat::Raw;
+				}
+				else
+				{
+					return usageError( QString( "Invalid output format %1" ).arg( ext ) );
+				}
+
+				if( e == 0 )
+				{
+					eff = format;
+				}
+				else
+				{
+					copyFormats.push_back( format );
+				}
 			}
 		}
 		else if( arg == "--samplerate" || arg == "-s" )
@@ -583,6 +756,27 @@ int main( int argc, char * * argv )
 				return usageError( QString( "Invalid bitrate %1" ).arg( argv[i] ) );
 			}
 		}
+		else if( arg == "--buffersize" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No buffer size specified" );
+			}
+
+
+			int frames = QString( argv[i] ).toUInt();
+
+			if( frames >= MINIMUM_BUFFER_SIZE && frames <= MAXIMUM_RENDER_BUFFER_SIZE )
+			{
+				renderFramesPerPeriod = frames;
+			}
+			else
+			{
+				return usageError( QString( "Invalid buffer size %1" ).arg( argv[i] ) );
+			}
+		}
 		else if( arg == "--mode" || arg == "-m" )
 		{
 			++i;
@@ -696,6 +890,25 @@ int main( int argc, char * * argv )
 				++i;
 			}
 		}
+		else if( arg == "--watchdog" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No watchdog threshold specified" );
+			}
+
+			watchdogThreshold = QString( argv[i] ).toInt();
+			if( watchdogThreshold < 1 )
+			{
+				return usageError( QString( "Invalid watchdog threshold %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--memory-report" )
+		{
+			memoryReport = true;
+		}
 		else if( arg == "--profile" || arg == "-p" )
 		{
 			++i;
@@ -719,6 +932,17 @@ int main( int argc, char * * argv )
 
 			configFile = QString::fromLocal8Bit( argv[i] );
 		}
+		else if( arg == "--trace" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No trace file specified" );
+			}
+
+			traceOutputFile = QString::fromLocal8Bit( argv[i] );
+		}
 		else
 		{
 			if( argv[i][0] == '-' )
@@ -729,6 +953,12 @@ int main( int argc, char * * argv )
 		}
 	}
 
+	// nothing but the samples may go to the standard output
+	if( renderOut == "-" )
+	{
+		AudioFileDevice::takeStandardOutput();
+	}
+
 	// Test file argument before continuing
 	if( !fileToLoad.isEmpty() )
 	{
@@ -744,6 +974,8 @@ int main( int argc, char * * argv )
 	// Hidden settings
 	MixHelpers::setNaNHandler( ConfigManager::inst()->value( "app",
 						"nanhandler", "1" ).toInt() );
+	EffectChain::setSanitizeEveryEffect( ConfigManager::inst()->value( "app",
+						"sanitizeeveryeffect", "0" ).toInt() );
 
 	// set language
 	QString pos = ConfigManager::inst()->value( "app", "language" );
@@ -800,13 +1032,184 @@ int main( int argc, char * * argv )
 	}
 #endif
 
+	if( !traceOutputFile.isEmpty() )
+	{
+		AudioEngineTracer::start( traceOutputFile );
+	}
+
 	bool destroyEngine = false;
 
+	if( renderMidi && ( !batchList.isEmpty() || batchWorker || distributed || renderTracks || renderOut == "-" ) )
+	{
+		return usageError( "The mid format is only for \"render\" to a file" );
+	}
+
+	// render a list of projects with worker processes, which are started
+	// with the same options, but get the projects from us
+	if( !batchList.isEmpty() )
+	{
+		QStringList workerArguments{ "render", "--batch-worker" };
+		for( int i = 1; i < argc; ++i )
+		{
+			const QString arg = QString::fromLocal8Bit( argv[i] );
+			if( arg == "render" || arg == "--render" || arg == "-r" )
+			{
+				// skip --batch and the list as well
+				i += 2;
+			}
+			else if( arg == "--jobs" || arg == "-j" )
+			{
+				++i;
+			}
+			else
+			{
+				workerArguments << arg;
+			}
+		}
+
+		// with a list, the output is a directory
+		if( !renderOut.isEmpty() )
+		{
+			QDir().mkpath( renderOut );
+		}
+
+		auto batch = new BatchRenderer( batchList, batchJobs, workerArguments );
+		if( !batch->isReady() )
+		{
+			printf( "There are no projects to render in %s\n", batchList.toUtf8().constData() );
+			return EXIT_FAILURE;
+		}
+		QObject::connect( batch, &BatchRenderer::finished, []( bool successful )
+		{
+			QCoreApplication::exit( successful ? EXIT_SUCCESS : EXIT_FAILURE );
+		} );
+		batch->start();
+	}
+	else if( batchWorker )
+	{
+		// a worker only loads the plugins its projects use
+		PluginFactory::setDiscoverOnDemand( true );
+		Engine::init( true, renderFramesPerPeriod );
+		destroyEngine = true;
+
+		// render inside the event loop, RenderManager needs it
+		QTimer::singleShot( 0, [=]
+		{
+			QCoreApplication::exit( BatchRenderer::work( qs, os, eff, renderLoop, renderOut,
+				[&]( RenderManager& r )
+				{
+					for( const auto format : copyFormats )
+					{
+						r.addFormat( format );
+					}
+					r.setRealtime( renderRealtime );
+					r.setLoudnessReport( loudnessReport );
+				} ) );
+		} );
+	}
+	// render segments of the song with worker processes, which get the
+	// same options and what to render of it, and join them
+	else if( distributed )
+	{
+		if( fileToLoad.isEmpty() || renderTracks || renderOut == "-" )
+		{
+			return usageError( "--distributed needs a project to render to a file and can't be used with rendertracks" );
+		}
+
+		QStringList workerArguments;
+		for( int i = 1; i < argc; ++i )
+		{
+			const QString arg = QString::fromLocal8Bit( argv[i] );
+			if( arg == "render" || arg == "--render" || arg == "-r" || arg == "--worker" || arg == "--jobs"
+				|| arg == "-j" || arg == "--preroll" || arg == "--output" || arg == "-o" || arg == "--format"
+				|| arg == "-f" || arg == "--profile" || arg == "-p" || arg == "--trace" )
+			{
+				// the value as well
+				++i;
+			}
+			else if( arg != "--distributed" && arg != "--float" && arg != "-a" && arg != "--loop" && arg != "-l"
+				&& arg != "--loudness-report" && arg != "--memory-report" && arg != "--realtime" )
+			{
+				workerArguments << arg;
+			}
+		}
+
+		// an empty command starts this LMMS here
+		if( distributedWorkers.isEmpty() )
+		{
+			for( int j = 0; j < batchJobs; ++j )
+			{
+				distributedWorkers << QString();
+			}
+		}
+
+		// the length of the song is needed to split it
+		PluginFactory::setDiscoverOnDemand( true );
+		Engine::init( true, renderFramesPerPeriod );
+		destroyEngine = true;
+
+		printf( "Loading project...\n" );
+		Engine::getSong()->loadProject( fileToLoad );
+		if( Engine::getSong()->isEmpty() )
+		{
+			printf("The project %s is empty, aborting!\n", fileToLoad.toUtf8().constData() );
+			exit( EXIT_FAILURE );
+		}
+		printf( "Done\n" );
+
+		// like a whole export, with a bar for the tails unless it loops
+		Engine::getSong()->updateLength();
+		const tick_t length = ( Engine::getSong()->length() + ( renderLoop ? 0 : 1 ) ) * TimePos::ticksPerBar();
+
+		renderOut = baseName( renderOut ) + ProjectRenderer::getFileExtensionFromFormat( eff );
+		auto renderer = new DistributedRenderer( QFileInfo( fileToLoad ).absoluteFilePath(), length,
+			prerollBars * TimePos::ticksPerBar(), distributedWorkers, workerArguments, os, eff, renderOut );
+		for( const auto format : copyFormats )
+		{
+			renderer->addFormat( format );
+		}
+		renderer->setLoudnessReport( loudnessReport );
+		QObject::connect( renderer, &DistributedRenderer::finished, []( bool successful )
+		{
+			QCoreApplication::exit( successful ? EXIT_SUCCESS : EXIT_FAILURE );
+		} );
+		renderer->start();
+	}
+	// export the notes of the song without rendering it, which takes only
+	// the tracks and works through them one at a time
+	else if( renderMidi && !renderOut.isEmpty() )
+	{
+		PluginFactory::setDiscoverOnDemand( true );
+		Engine::init( true, renderFramesPerPeriod );
+		destroyEngine = true;
+
+		printf( "Loading project...\n" );
+		Engine::getSong()->loadProject( fileToLoad );
+		if( Engine::getSong()->isEmpty() )
+		{
+			printf("The project %s is empty, aborting!\n", fileToLoad.toUtf8().constData() );
+			exit( EXIT_FAILURE );
+		}
+		printf( "Done\n" );
+
+		renderOut = baseName( renderOut ) + ".mid";
+		const bool successful = Engine::getSong()->exportProjectMidi( renderOut );
+		if( !successful )
+		{
+			printf( "Could not export %s\n", renderOut.toUtf8().constData() );
+		}
+		QTimer::singleShot( 0, [successful]
+		{
+			QCoreApplication::exit( successful ? EXIT_SUCCESS : EXIT_FAILURE );
+		} );
+	}
 	// if we have an output file for rendering, just render the song
 	// without starting the GUI
-	if( !renderOut.isEmpty() )
+	else if( !renderOut.isEmpty() )
 	{
-		Engine::init( true );
+		// rendering only needs the plugins of the project
+		PluginFactory::setDiscoverOnDemand( true );
+		Engine::init( true, renderFramesPerPeriod );
 		destroyEngine = true;
 
 		printf( "Loading project...\n" );
@@ -818,11 +1221,21 @@ int main( int argc, char * * argv )
 		}
 		printf( "Done\n" );
 
+		if( memoryReport )
+		{
+			printf( "\nMemory usage:\n%s\n", MemoryReport::collect().toText().toUtf8().constData() );
+		}
+
 		Engine::getSong()->setExportLoop( renderLoop );
+		if( renderSegment )
+		{
+			Engine::getSong()->setExportSegment( segmentBegin, segmentEnd, segmentPreroll, segmentOverlap );
+		}
 
 		// when rendering multiple tracks, renderOut is a directory
-		// otherwise, it is a file, so we need to append the file extension
-		if ( !renderTracks )
+		// otherwise, it is a file, so we need to append the file extension,
+		// unless it's "-" for the standard output
+		if ( !renderTracks && renderOut != "-" )
 		{
 			renderOut = baseName( renderOut ) +
 				ProjectRenderer::getFileExtensionFromFormat(eff);
@@ -830,14 +1243,33 @@ int main( int argc, char * * argv )
 
 		// create renderer
 		auto r = new RenderManager(qs, os, eff, renderOut);
+		for( const auto format : copyFormats )
+		{
+			r->addFormat( format );
+		}
+		r->setRealtime( renderRealtime );
+		r->setLoudnessReport( loudnessReport );
+		if( renderSegment )
+		{
+			// the renderer that started this worker joins the segments
+			QObject::connect( r, &RenderManager::progressChanged, &DistributedRenderer::reportProgress );
+			QObject::connect( r, &RenderManager::finished, []
+			{
+				DistributedRenderer::reportSegment( Engine::getSong()->exportSegmentBeginFrame(),
+					Engine::getSong()->exportSegmentEndFrame() );
+			} );
+		}
 		QCoreApplication::instance()->connect( r,
 				SIGNAL(finished()), SLOT(quit()));
 
-		// timer for progress-updates
-		auto t = new QTimer(r);
-		r->connect( t, SIGNAL(timeout()),
-				SLOT(updateConsoleProgress()));
-		t->start( 200 );
+		// timer for progress-updates, the renderer of the segments shows them
+		if( !renderSegment )
+		{
+			auto t = new QTimer(r);
+			r->connect( t, SIGNAL(timeout()),
+					SLOT(updateConsoleProgress()));
+			t->start( 200 );
+		}
 
 		if( profilerOutputFile.isEmpty() == false )
 		{
@@ -860,6 +1292,11 @@ int main( int argc, char * * argv )
 
 		new GuiApplication();
 
+		if( watchdogThreshold > 0 )
+		{
+			static_cast<MainApplication *>( app )->detectStalls( watchdogThreshold );
+		}
+
 		// re-intialize RNG - shared libraries might have srand() or
 		// srandom() calls in their init procedure
 		srand( getpid() + time( 0 ) );
@@ -1023,6 +1460,9 @@ int main( int argc, char * * argv )
 		Engine::destroy();
 	}
 
+	AudioEngineTracer::stop();
+	RealtimeChecker::report();
+
 	// ProjectRenderer::updateConsoleProgress() doesn't return line after render
 	if( coreOnly )
 	{
@@ -83,10 +83,11 @@ void MidiController::processInEvent(const MidiEvent& event, const TimePos& time,
 			if (m_midiPort.inputController() == controllerNum &&
 				(m_midiPort.inputChannel() == event.channel() + 1 || m_midiPort.inputChannel() == 0))
 			{
+				// the port only passes on the last value of a period, the
+				// buffer ramps to it from where the one before ended, and
+				// triggerFrameCounter() tells the connections once a period
 				unsigned char val = event.controllerValue();
-				m_previousValue = m_lastValue;
 				m_lastValue = static_cast<float>(val) / 127.0f;
-				emit valueChanged();
 			}
 			break;
 
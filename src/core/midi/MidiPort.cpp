@@ -24,12 +24,18 @@
  */
 
 #include <QDomElement>
+#include <QThread>
+
+#include <algorithm>
+#include <bitset>
 
 #include "MidiPort.h"
 #include "MidiClient.h"
 #include "MidiDummy.h"
 #include "MidiEventProcessor.h"
 #include "Note.h"
+#include "Engine.h"
+#include "AudioEngine.h"
 #include "Song.h"
 #include "MidiController.h"
 
@@ -40,6 +46,20 @@ namespace lmms
 
 static MidiDummy s_dummyClient;
 
+//! Enough for several periods of someone playing a chord with all of their fingers
+static constexpr std::size_t InEventQueueSize = 1024;
+//! How many milliseconds a client waits for room in the queue
+static constexpr int InEventMaxWait = 100;
+
+
+// whether only the latest value of a controller matters, which isn't the case
+// for the switches, bank and parameter selection, data entry and channel modes
+static bool isContinuousController( int controller )
+{
+	return ( controller > 0 && controller < 64 && controller % 32 != 0 && controller % 32 != MidiControllerDataEntry )
+		|| ( controller >= 70 && controller < 96 );
+}
+
 
 
 MidiPort::MidiPort( const QString& name,
@@ -63,8 +83,12 @@ MidiPort::MidiPort( const QString& name,
 	m_outputProgramModel( 1, 1, MidiProgramCount, this, tr( "Output MIDI program" ) ),
 	m_baseVelocityModel( MidiMaxVelocity/2, 1, MidiMaxVelocity, this, tr( "Base velocity" ) ),
 	m_readableModel( false, this, tr( "Receive MIDI-events" ) ),
-	m_writableModel( false, this, tr( "Send MIDI-events" ) )
+	m_writableModel( false, this, tr( "Send MIDI-events" ) ),
+	m_inEvents( InEventQueueSize ),
+	m_inEventReader( m_inEvents )
 {
+	m_dispatchedEvents.reserve( InEventQueueSize );
+	Engine::audioEngine()->addMidiPort( this );
 	m_midiClient->addPort( this );
 
 	m_readableModel.setValue( m_mode == Mode::Input || m_mode == Mode::Duplex );
@@ -104,6 +128,10 @@ MidiPort::~MidiPort()
 
 	// and finally unregister ourself
 	m_midiClient->removePort( this );
+	if( Engine::audioEngine() )
+	{
+		Engine::audioEngine()->removeMidiPort( this );
+	}
 }
 
 
@@ -127,7 +155,7 @@ void MidiPort::setMode( Mode mode )
 
 
 
-void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
+void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time, Clock::time_point arrival )
 {
 	// mask event
 	if( isInputEnabled() &&
@@ -149,7 +177,89 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 			}
 		}
 
-		m_midiEventProcessor->processInEvent( inEvent, time );
+		// system exclusive data belongs to the client and only lasts as long
+		// as this call
+		if( inEvent.type() == MidiSysEx )
+		{
+			m_midiEventProcessor->processInEvent( inEvent, time );
+			return;
+		}
+
+		// if the audio thread lags far behind, hold up the client rather than
+		// the rendering
+		const InEvent queued = { inEvent, time, arrival, false };
+		for( int waited = 0; m_inEvents.write( &queued, 1 ) == 0; ++waited )
+		{
+			if( waited == InEventMaxWait )
+			{
+				qWarning( "MidiPort: dropped an input event, the audio engine isn't taking any" );
+				return;
+			}
+			QThread::msleep( 1 );
+		}
+	}
+}
+
+
+
+
+void MidiPort::dispatchInEvents( Clock::time_point periodStart, sample_rate_t sampleRate, fpp_t frames )
+{
+	// only what arrived until now, whatever comes in meanwhile is for the next period
+	m_dispatchedEvents.clear();
+	auto count = m_inEventReader.read_space();
+	while( count > 0 )
+	{
+		auto events = m_inEventReader.read_max( count );
+		for( std::size_t e = 0; e < events.size(); ++e )
+		{
+			m_dispatchedEvents.push_back( events[e] );
+		}
+		count -= events.size();
+	}
+
+	// a controller sending at a rate of kHz would otherwise move its models
+	// many times a period, with all the signals that come with it
+	std::bitset<MidiChannelCount * MidiControllerCount> laterControllers;
+	std::bitset<MidiChannelCount> laterPitchBends;
+	std::bitset<MidiChannelCount> laterPressures;
+	for( auto it = m_dispatchedEvents.rbegin(); it != m_dispatchedEvents.rend(); ++it )
+	{
+		const MidiEvent& event = it->event;
+		const auto channel = static_cast<std::size_t>( event.channel() ) % MidiChannelCount;
+		switch( event.type() )
+		{
+			case MidiControlChange:
+				if( isContinuousController( event.controllerNumber() ) )
+				{
+					const auto index = channel * MidiControllerCount + event.controllerNumber();
+					it->superseded = laterControllers.test( index );
+					laterControllers.set( index );
+				}
+				break;
+			case MidiPitchBend:
+				it->superseded = laterPitchBends.test( channel );
+				laterPitchBends.set( channel );
+				break;
+			case MidiChannelPressure:
+				it->superseded = laterPressures.test( channel );
+				laterPressures.set( channel );
+				break;
+			default:
+				break;
+		}
+	}
+
+	for( const InEvent& inEvent : m_dispatchedEvents )
+	{
+		if( inEvent.superseded )
+		{
+			continue;
+		}
+		const auto age = std::chrono::duration<double>( periodStart - inEvent.arrival ).count();
+		const auto framesAgo = std::clamp( age * sampleRate, 1.0, static_cast<double>( frames ) );
+		m_midiEventProcessor->processInEvent( inEvent.event, inEvent.time,
+			frames - static_cast<f_cnt_t>( framesAgo ) );
 	}
 }
 
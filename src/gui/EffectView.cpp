@@ -94,30 +94,6 @@ EffectView::EffectView( Effect * _model, QWidget * _parent ) :
 		ctls_btn->setGeometry( 150, 14, 50, 20 );
 		connect( ctls_btn, SIGNAL(clicked()),
 					this, SLOT(editControls()));
-
-		m_controlView = effect()->controls()->createView();
-		if( m_controlView )
-		{
-			m_subWindow = getGUI()->mainWindow()->addWindowedWidget( m_controlView );
-
-			if ( !m_controlView->isResizable() )
-			{
-				m_subWindow->setSizePolicy( QSizePolicy::Fixed, QSizePolicy::Fixed );
-				if (m_subWindow->layout())
-				{
-					m_subWindow->layout()->setSizeConstraint(QLayout::SetFixedSize);
-				}
-			}
-
-			Qt::WindowFlags flags = m_subWindow->windowFlags();
-			flags &= ~Qt::WindowMaximizeButtonHint;
-			m_subWindow->setWindowFlags( flags );
-
-			connect( m_controlView, SIGNAL(closed()),
-					this, SLOT(closeEffects()));
-
-			m_subWindow->hide();
-		}
 	}
 	
 	m_opacityEffect = new QGraphicsOpacityEffect(this);
@@ -139,8 +115,42 @@ EffectView::~EffectView()
 
 
 
+void EffectView::createControlView()
+{
+	m_controlView = effect()->controls()->createView();
+	if( m_controlView )
+	{
+		m_subWindow = getGUI()->mainWindow()->addWindowedWidget( m_controlView );
+
+		if ( !m_controlView->isResizable() )
+		{
+			m_subWindow->setSizePolicy( QSizePolicy::Fixed, QSizePolicy::Fixed );
+			if (m_subWindow->layout())
+			{
+				m_subWindow->layout()->setSizeConstraint(QLayout::SetFixedSize);
+			}
+		}
+
+		Qt::WindowFlags flags = m_subWindow->windowFlags();
+		flags &= ~Qt::WindowMaximizeButtonHint;
+		m_subWindow->setWindowFlags( flags );
+
+		connect( m_controlView, SIGNAL(closed()),
+				this, SLOT(closeEffects()));
+
+		m_subWindow->hide();
+	}
+}
+
+
+
+
 void EffectView::editControls()
 {
+	if( !m_subWindow )
+	{
+		createControlView();
+	}
 	if( m_subWindow )
 	{
 		if( !m_subWindow->isVisible() )
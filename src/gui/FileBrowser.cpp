@@ -28,6 +28,7 @@
 #include <QApplication>
 #include <QDesktopServices>
 #include <QDirIterator>
+#include <QFile>
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QLineEdit>
@@ -54,11 +55,14 @@
 #include "InstrumentTrack.h"
 #include "InstrumentTrackWindow.h"
 #include "MainWindow.h"
+#include "PathUtil.h"
 #include "PatternStore.h"
 #include "PluginFactory.h"
 #include "PresetPreviewPlayHandle.h"
 #include "Sample.h"
+#include "SampleCache.h"
 #include "SampleClip.h"
+#include "SampleDecoder.h"
 #include "SampleLoader.h"
 #include "SamplePlayHandle.h"
 #include "SampleTrack.h"
@@ -299,6 +303,9 @@ void FileBrowser::toggleSearch(bool on)
 
 void FileBrowser::reloadTree()
 {
+	// the files may have changed since they were indexed for searching
+	FileBrowserSearcher::instance()->refresh();
+
 	if (m_filterEdit->text().isEmpty())
 	{
 		saveDirectoriesStates();	
@@ -467,6 +474,96 @@ void FileBrowser::keyPressEvent(QKeyEvent * ke )
 
 
 
+namespace
+{
+
+//! Sample previews start right away from the first seconds of the file
+constexpr auto PreviewHeadSeconds = 3;
+//! Sound fonts can be huge, the start of them is what's loaded first
+constexpr qint64 MaxPrefetchBytes = 64 * 1024 * 1024;
+
+} // namespace
+
+
+
+
+//! Decodes the whole sample of a preview, through the SampleCache so files
+//! auditioned before are read back from its decoded copies on disk
+class FileBrowserTreeWidget::PreviewDecoder : public QRunnable
+{
+public:
+	PreviewDecoder(FileBrowserTreeWidget* tree, const QString& fileName, int generation) :
+		m_tree(tree),
+		m_fileName(fileName),
+		m_generation(generation)
+	{
+	}
+
+	void run() override
+	{
+		auto buffer = std::shared_ptr<const SampleBuffer>{};
+		try
+		{
+			buffer = SampleCache::get(m_fileName);
+		}
+		catch (const std::runtime_error&)
+		{
+			// the head keeps playing, there's nothing to tell about it
+			return;
+		}
+
+		QMutexLocker previewLocker(&m_tree->m_pphMutex);
+		if (m_generation != m_tree->m_previewGeneration) { return; }
+		m_tree->m_decodedPreview = std::move(buffer);
+		QMetaObject::invokeMethod(m_tree, "continuePreview", Qt::QueuedConnection);
+	}
+
+private:
+	FileBrowserTreeWidget* m_tree;
+	QString m_fileName;
+	int m_generation;
+};
+
+
+
+
+//! Reads a preset, so loading it for a preview doesn't wait for the disk.
+//! What was read stays in the cache of the operating system.
+class FileBrowserTreeWidget::PresetPrefetcher : public QRunnable
+{
+public:
+	PresetPrefetcher(FileBrowserTreeWidget* tree, const QString& fileName, int generation) :
+		m_tree(tree),
+		m_fileName(fileName),
+		m_generation(generation)
+	{
+	}
+
+	void run() override
+	{
+		QFile file(m_fileName);
+		if (!file.open(QIODevice::ReadOnly)) { return; }
+
+		auto chunk = QByteArray(1024 * 1024, Qt::Uninitialized);
+		for (qint64 done = 0; done < MaxPrefetchBytes;)
+		{
+			// samples decoded for a preview are waiting
+			if (m_generation != m_tree->m_prefetchGeneration.load(std::memory_order_relaxed)) { return; }
+			const qint64 read = file.read(chunk.data(), chunk.size());
+			if (read <= 0) { return; }
+			done += read;
+		}
+	}
+
+private:
+	FileBrowserTreeWidget* m_tree;
+	QString m_fileName;
+	int m_generation;
+};
+
+
+
+
 FileBrowserTreeWidget::FileBrowserTreeWidget(QWidget * parent ) :
 	QTreeWidget( parent ),
 	m_mousePressed( false ),
@@ -478,6 +575,7 @@ FileBrowserTreeWidget::FileBrowserTreeWidget(QWidget * parent ) :
 {
 	setColumnCount( 1 );
 	headerItem()->setHidden( true );
+	m_previewPool.setMaxThreadCount(1);
 	setSortingEnabled( false );
 
 	connect( this, SIGNAL(itemDoubleClicked(QTreeWidgetItem*,int)),
@@ -711,19 +809,23 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 	// handling() rather than directly creating a SamplePlayHandle
 	if (file->type() == FileItem::FileType::Sample)
 	{
-		TextFloat * tf = TextFloat::displayMessage(
-			tr("Loading sample"),
-			tr("Please wait, loading sample for preview..."),
-			embed::getIconPixmap("sample_file", 24, 24), 0);
-		// TODO: this can be removed once we do this outside the event thread
-		qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
-		if (auto buffer = SampleLoader::createBufferFromFile(fileName))
+		newPPH = previewSampleHead(fileName);
+		if (newPPH == nullptr)
 		{
-			auto s = new SamplePlayHandle(new lmms::Sample{std::move(buffer)});
-			s->setDoneMayReturnTrue(false);
-			newPPH = s;
+			TextFloat * tf = TextFloat::displayMessage(
+				tr("Loading sample"),
+				tr("Please wait, loading sample for preview..."),
+				embed::getIconPixmap("sample_file", 24, 24), 0);
+			// TODO: this can be removed once we do this outside the event thread
+			qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+			if (auto buffer = SampleLoader::createBufferFromFile(fileName))
+			{
+				auto s = new SamplePlayHandle(new lmms::Sample{std::move(buffer)});
+				s->setDoneMayReturnTrue(false);
+				newPPH = s;
+			}
+			delete tf;
 		}
-		delete tf;
 	}
 	else if (
 		(ext == "xiz" || ext == "sf2" || ext == "sf3" ||
@@ -732,6 +834,7 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 	{
 		const bool isPlugin = file->handling() == FileItem::FileHandling::LoadByPlugin;
 		newPPH = new PresetPreviewPlayHandle(fileName, isPlugin);
+		prefetchPresetAfter(file);
 	}
 	else if (file->type() != FileItem::FileType::VstPlugin && file->isTrack())
 	{
@@ -740,6 +843,7 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 		{
 			const bool isPlugin = file->handling() == FileItem::FileHandling::LoadByPlugin;
 			newPPH = new PresetPreviewPlayHandle(fileName, isPlugin, &dataFile);
+			prefetchPresetAfter(file);
 		}
 		else
 		{
@@ -763,9 +867,61 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 
 
 
+PlayHandle* FileBrowserTreeWidget::previewSampleHead(const QString& fileName)
+{
+	auto head = SampleDecoder::decodeHead(PathUtil::toAbsolute(fileName), PreviewHeadSeconds);
+	if (!head) { return nullptr; }
+
+	// a file that ended within the head needs no more decoding
+	const auto complete = head->data.size() < static_cast<std::size_t>(PreviewHeadSeconds) * head->sampleRate;
+	auto s = new SamplePlayHandle(new lmms::Sample{
+		std::make_shared<const SampleBuffer>(std::move(head->data), head->sampleRate)});
+	s->setDoneMayReturnTrue(false);
+
+	if (!complete)
+	{
+		// a new preview makes the ones waiting for their turn pointless
+		++m_prefetchGeneration;
+		m_previewPool.clear();
+		m_previewPool.start(new PreviewDecoder(this, fileName, m_previewGeneration));
+	}
+	return s;
+}
+
+
+
+
+void FileBrowserTreeWidget::prefetchPresetAfter(FileItem* file)
+{
+	const auto next = dynamic_cast<FileItem*>(itemBelow(file));
+	if (next == nullptr || next->type() == FileItem::FileType::Sample || !next->isTrack()) { return; }
+
+	m_previewPool.clear();
+	m_previewPool.start(new PresetPrefetcher(this, next->fullName(), ++m_prefetchGeneration));
+}
+
+
+
+
+void FileBrowserTreeWidget::continuePreview()
+{
+	QMutexLocker previewLocker(&m_pphMutex);
+	auto buffer = std::move(m_decodedPreview);
+	if (buffer && m_previewPlayHandle != nullptr
+		&& m_previewPlayHandle->type() == PlayHandle::Type::SamplePlayHandle)
+	{
+		static_cast<SamplePlayHandle*>(m_previewPlayHandle)->replaceSample(new lmms::Sample{std::move(buffer)});
+	}
+}
+
+
+
+
 void FileBrowserTreeWidget::stopPreview()
 {
 	QMutexLocker previewLocker(&m_pphMutex);
+	++m_previewGeneration;
+	m_decodedPreview = nullptr;
 	if (m_previewPlayHandle != nullptr)
 	{
 		Engine::audioEngine()->removePlayHandle(m_previewPlayHandle);
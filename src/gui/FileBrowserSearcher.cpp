@@ -25,12 +25,23 @@
 #include "FileBrowserSearcher.h"
 
 #include <QDir>
-#include <stack>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
 
 #include "FileBrowser.h"
 
 namespace lmms::gui {
 
+namespace {
+
+auto trigram(const QChar* chars) -> std::uint64_t
+{
+	return std::uint64_t{chars[0].unicode()} << 32 | std::uint64_t{chars[1].unicode()} << 16 | chars[2].unicode();
+}
+
+} // namespace
+
 FileBrowserSearcher::~FileBrowserSearcher()
 {
 	m_cancelRunningSearch = true;
@@ -47,13 +58,14 @@ FileBrowserSearcher::~FileBrowserSearcher()
 auto FileBrowserSearcher::search(const QString& filter, const QStringList& paths, const QStringList& extensions)
 	-> std::shared_ptr<SearchFuture>
 {
-	m_cancelRunningSearch = true;
 	auto future = std::make_shared<SearchFuture>(filter, paths, extensions);
 
 	{
 		const auto lock = std::lock_guard{m_workerMutex};
 		m_searchQueue.push(future);
-		m_cancelRunningSearch = false;
+
+		// whatever runs now is outdated by this search
+		m_cancelRunningSearch = true;
 	}
 
 	m_workerCond.notify_one();
@@ -69,16 +81,39 @@ auto FileBrowserSearcher::run() -> void
 
 		if (m_workerStopped) { return; }
 
+		// only the latest search is still of interest
+		while (m_searchQueue.size() > 1)
+		{
+			m_searchQueue.front()->m_state = SearchFuture::State::Cancelled;
+			m_searchQueue.pop();
+		}
+
 		const auto future = m_searchQueue.front();
 		future->m_state = SearchFuture::State::Running;
 		m_searchQueue.pop();
+		m_cancelRunningSearch = false;
+		lock.unlock();
+
+		if (m_indicesOutdated.exchange(false))
+		{
+			for (auto& indexed : m_indices) { indexed.second.built = {}; }
+		}
 
 		auto cancelled = false;
 		for (const auto& path : future->m_paths)
 		{
 			if (FileBrowser::directoryBlacklist().contains(path)) { continue; }
 
-			if (!process(future.get(), path))
+			auto it = m_indices.find(path);
+			if (it == m_indices.end())
+			{
+				// not cancelled by later searches, they need the index just as well
+				auto index = buildIndex(path, false);
+				if (!index) { return; }
+				it = m_indices.emplace(path, std::move(*index)).first;
+			}
+
+			if (!process(future.get(), it->second))
 			{
 				future->m_state = SearchFuture::State::Cancelled;
 				cancelled = true;
@@ -86,50 +121,147 @@ auto FileBrowserSearcher::run() -> void
 			}
 		}
 
-		if (!cancelled) { future->m_state = SearchFuture::State::Completed; }
+		if (cancelled) { continue; }
+		future->m_state = SearchFuture::State::Completed;
+
+		// walk the outdated directories again while nobody is searching, the next search interrupts it
+		for (const auto& path : future->m_paths)
+		{
+			auto it = m_indices.find(path);
+			if (it == m_indices.end() || std::chrono::steady_clock::now() - it->second.built < IndexLifetime)
+			{
+				continue;
+			}
+
+			auto index = buildIndex(path, true);
+			if (m_workerStopped) { return; }
+			if (!index) { break; }
+			it->second = std::move(*index);
+		}
 	}
 }
 
-auto FileBrowserSearcher::process(SearchFuture* searchFuture, const QString& path) -> bool
+auto FileBrowserSearcher::buildIndex(const QString& path, bool interruptible) -> std::optional<Index>
 {
-	auto stack = QFileInfoList{};
+	auto index = Index{};
+	index.path = QDir{path}.absolutePath();
+
+	// directories linked into themselves must only be walked once
+	auto visited = QSet<QString>{};
 
 	auto dir = QDir{path};
-	stack.append(dir.entryInfoList(FileBrowser::dirFilters(), FileBrowser::sortFlags()));
+	auto stack = std::vector<std::pair<QFileInfo, std::uint32_t>>{};
+	const auto push = [&](std::uint32_t parent)
+	{
+		auto entries = dir.entryInfoList(FileBrowser::dirFilters(), FileBrowser::sortFlags());
+
+		// Reverse to maintain the sorting within this directory when popped
+		std::for_each(entries.rbegin(), entries.rend(), [&](const QFileInfo& entry) { stack.emplace_back(entry, parent); });
+	};
+	push(Index::None);
 
 	while (!stack.empty())
 	{
-		if (m_cancelRunningSearch)
-		{
-			m_cancelRunningSearch = false;
-			return false;
-		}
+		if (m_workerStopped || (interruptible && m_cancelRunningSearch)) { return std::nullopt; }
+
+		const auto [info, parent] = std::move(stack.back());
+		stack.pop_back();
 
-		const auto info = stack.takeFirst();
 		const auto path = info.absoluteFilePath();
 		if (FileBrowser::directoryBlacklist().contains(path)) { continue; }
 
-		const auto name = info.fileName();
-		const auto validFile = info.isFile() && searchFuture->m_extensions.contains(info.suffix(), Qt::CaseInsensitive);
-		const auto passesFilter = name.contains(searchFuture->m_filter, Qt::CaseInsensitive);
+		const auto position = static_cast<std::uint32_t>(index.entries.size());
+		const auto isDir = info.isDir();
+		index.entries.push_back(Index::Entry{info.fileName(), isDir, parent, position + 1});
 
-		// Only when a directory doesn't pass the filter should we search further
-		if (info.isDir() && !passesFilter)
+		const auto name = index.entries.back().name.toCaseFolded();
+		for (int i = 0; i + 3 <= name.size(); ++i)
+		{
+			auto& indices = index.trigrams[trigram(name.constData() + i)];
+			if (indices.empty() || indices.back() != position) { indices.push_back(position); }
+		}
+
+		if (isDir && !visited.contains(info.canonicalFilePath()))
 		{
+			visited.insert(info.canonicalFilePath());
 			dir.setPath(path);
-			auto entries = dir.entryInfoList(FileBrowser::dirFilters(), FileBrowser::sortFlags());
+			push(position);
+		}
+	}
 
-			// Reverse to maintain the sorting within this directory when popped
-			std::reverse(entries.begin(), entries.end());
+	// the entries below a directory follow it
+	for (auto i = index.entries.size(); i-- > 0;)
+	{
+		const auto& entry = index.entries[i];
+		if (entry.parent != Index::None)
+		{
+			auto& end = index.entries[entry.parent].end;
+			end = std::max(end, entry.end);
+		}
+	}
 
-			for (const auto& entry : entries)
-			{
-				stack.push_front(entry);
-			}
+	index.built = std::chrono::steady_clock::now();
+	return index;
+}
+
+auto FileBrowserSearcher::process(SearchFuture* searchFuture, const Index& index) -> bool
+{
+	const auto& filter = searchFuture->m_filter;
+	const auto folded = filter.toCaseFolded();
+
+	// the entries to look at, those with every three characters of the filter in their name
+	auto candidates = std::optional<std::vector<std::uint32_t>>{};
+	for (int i = 0; i + 3 <= folded.size(); ++i)
+	{
+		const auto it = index.trigrams.find(trigram(folded.constData() + i));
+		if (it == index.trigrams.end()) { return true; }
+
+		if (!candidates)
+		{
+			candidates = it->second;
+			continue;
 		}
-		else if ((validFile || info.isDir()) && passesFilter) { searchFuture->addMatch(path); }
+
+		auto remaining = std::vector<std::uint32_t>{};
+		std::set_intersection(candidates->begin(), candidates->end(), it->second.begin(), it->second.end(),
+			std::back_inserter(remaining));
+		candidates = std::move(remaining);
+	}
+
+	const auto count = candidates ? candidates->size() : index.entries.size();
+	auto skipUntil = std::uint32_t{0};
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (i % 1024 == 0 && m_cancelRunningSearch) { return false; }
+
+		const auto position = candidates ? (*candidates)[i] : static_cast<std::uint32_t>(i);
+		if (position < skipUntil) { continue; }
+
+		const auto& entry = index.entries[position];
+		if (!entry.name.contains(filter, Qt::CaseInsensitive)) { continue; }
+
+		// Only when a directory doesn't pass the filter should we search further
+		if (entry.isDir) { skipUntil = entry.end; }
+		else
+		{
+			const auto dot = entry.name.lastIndexOf('.');
+			const auto suffix = dot < 0 ? QString{} : entry.name.mid(dot + 1);
+			if (!searchFuture->m_extensions.contains(suffix, Qt::CaseInsensitive)) { continue; }
+		}
+
+		searchFuture->addMatch(index.pathOf(position));
 	}
 	return true;
 }
 
+auto FileBrowserSearcher::Index::pathOf(std::uint32_t index) const -> QString
+{
+	auto parts = QStringList{};
+	for (; index != None; index = entries[index].parent)
+	{
+		parts.prepend(entries[index].name);
+	}
+	return QDir{path}.filePath(parts.join('/'));
+}
+
 } // namespace lmms::gui
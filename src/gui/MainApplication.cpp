@@ -25,11 +25,14 @@
 
 #include <QDebug>
 #include <QFileOpenEvent>
+#include <QThread>
 
+#include "AudioEngineTracer.h"
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "MainWindow.h"
 #include "Song.h"
+#include "StallDetector.h"
 
 namespace lmms::gui
 {
@@ -57,6 +60,8 @@ MainApplication::MainApplication(int& argc, char** argv) :
 #endif
 }
 
+MainApplication::~MainApplication() = default;
+
 bool MainApplication::event(QEvent* event)
 {
 	switch(event->type())
@@ -85,6 +90,28 @@ bool MainApplication::event(QEvent* event)
 	}
 }
 
+bool MainApplication::notify(QObject* receiver, QEvent* event)
+{
+	if ((!m_stallDetector && !AudioEngineTracer::isEnabled()) || QThread::currentThread() != thread())
+	{
+		return QApplication::notify(receiver, event);
+	}
+
+	// the events of the GUI thread go into the timeline of the audio engine, too
+	AudioEngineTracer::Scope traceScope("GuiEvent", event->type());
+	if (!m_stallDetector) { return QApplication::notify(receiver, event); }
+
+	m_stallDetector->beginEvent(receiver, event);
+	const bool handled = QApplication::notify(receiver, event);
+	m_stallDetector->endEvent();
+	return handled;
+}
+
+void MainApplication::detectStalls(int thresholdMs)
+{
+	m_stallDetector = std::make_unique<StallDetector>(thresholdMs);
+}
+
 #ifdef LMMS_BUILD_WIN32
 // This can be moved into nativeEventFilter once Qt4 support has been dropped
 bool MainApplication::winEventFilter(MSG* msg, long* result)
@@ -27,17 +27,24 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QDesktopServices>
+#include <QDialog>
+#include <QDialogButtonBox>
 #include <QDomElement>
 #include <QFileInfo>
+#include <QFontDatabase>
 #include <QMdiArea>
 #include <QMenuBar>
 #include <QMessageBox>
+#include <QPlainTextEdit>
 #include <QShortcut>
 #include <QSplitter>
+#include <QVBoxLayout>
+#include <memory>
 
 #include "AboutDialog.h"
 #include "AutomationEditor.h"
 #include "ControllerRackView.h"
+#include "DataFile.h"
 #include "embed.h"
 #include "Engine.h"
 #include "ExportProjectDialog.h"
@@ -48,7 +55,9 @@
 #include "ImportFilter.h"
 #include "InstrumentTrackView.h"
 #include "InstrumentTrackWindow.h"
+#include "MemoryReport.h"
 #include "MicrotunerConfig.h"
+#include "Model.h"
 #include "PatternEditor.h"
 #include "PianoRoll.h"
 #include "PianoView.h"
@@ -211,6 +220,7 @@ MainWindow::MainWindow() :
 	{
 		// connect auto save
 		connect(&m_autoSaveTimer, SIGNAL(timeout()), this, SLOT(autoSave()));
+		m_autoSavePool.setMaxThreadCount(1);
 		m_autoSaveInterval = ConfigManager::inst()->value(
 					"ui", "saveinterval" ).toInt() < 1 ?
 						DEFAULT_AUTO_SAVE_INTERVAL :
@@ -243,6 +253,7 @@ MainWindow::MainWindow() :
 
 MainWindow::~MainWindow()
 {
+	m_autoSavePool.waitForDone();
 	for( PluginView *view : m_tools )
 	{
 		delete view->model();
@@ -404,6 +415,7 @@ void MainWindow::finalize()
 #if !(defined(LMMS_BUILD_APPLE) && (QT_VERSION < 0x050600))
 	help_menu->addSeparator();
 #endif
+	help_menu->addAction( tr( "Memory usage" ), this, SLOT(showMemoryReport()));
 	help_menu->addAction( embed::getIconPixmap( "icon_small" ), tr( "About" ),
 				  this, SLOT(aboutLMMS()));
 
@@ -917,6 +929,29 @@ void MainWindow::aboutLMMS()
 
 
 
+void MainWindow::showMemoryReport()
+{
+	Engine::audioEngine()->requestChangeInModel();
+	const MemoryReport report = MemoryReport::collect();
+	Engine::audioEngine()->doneChangeInModel();
+
+	QDialog dialog( this );
+	dialog.setWindowTitle( tr( "Memory usage" ) );
+	auto layout = new QVBoxLayout( &dialog );
+	auto text = new QPlainTextEdit( report.toText(), &dialog );
+	text->setReadOnly( true );
+	text->setFont( QFontDatabase::systemFont( QFontDatabase::FixedFont ) );
+	text->setMinimumSize( 600, 400 );
+	layout->addWidget( text );
+	auto buttons = new QDialogButtonBox( QDialogButtonBox::Close, &dialog );
+	connect( buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+	layout->addWidget( buttons );
+	dialog.exec();
+}
+
+
+
+
 void MainWindow::help()
 {
 	QMessageBox::information( this, tr( "Help not available" ),
@@ -1277,7 +1312,8 @@ void MainWindow::closeEvent( QCloseEvent * _ce )
 
 void MainWindow::sessionCleanup()
 {
-	// delete recover session files
+	// delete recover session files, once an autosave being written is done
+	m_autoSavePool.waitForDone();
 	QFile::remove( ConfigManager::inst()->recoveryFile() );
 	setSession( SessionState::Normal );
 }
@@ -1360,6 +1396,7 @@ void MainWindow::keyReleaseEvent( QKeyEvent * _ke )
 
 void MainWindow::timerEvent( QTimerEvent * _te)
 {
+	Model::emitDisplayChanges();
 	emit periodicUpdate();
 }
 
@@ -1389,17 +1426,49 @@ void MainWindow::browseHelp()
 
 
 
+namespace {
+
+class AutoSaveTask : public QRunnable
+{
+public:
+	AutoSaveTask(std::unique_ptr<DataFile> dataFile, const QString& fileName) :
+		m_dataFile(std::move(dataFile)),
+		m_fileName(fileName)
+	{
+	}
+
+	void run() override
+	{
+		// a backup of the recovery file would be of no use
+		m_dataFile->writeFile(m_fileName, false, false);
+	}
+
+private:
+	std::unique_ptr<DataFile> m_dataFile;
+	QString m_fileName;
+};
+
+} // namespace
+
+
+
+
 void MainWindow::autoSave()
 {
 	if( !Engine::getSong()->isExporting() &&
 		!Engine::getSong()->isLoadingProject() &&
+		m_autoSavePool.activeThreadCount() == 0 &&
 		!RemotePluginBase::isMainThreadWaiting() &&
 		!QApplication::mouseButtons() &&
 		( ConfigManager::inst()->value( "ui",
 				"enablerunningautosave" ).toInt() ||
 			! Engine::getSong()->isPlaying() ) )
 	{
-		Engine::getSong()->saveProjectFile(ConfigManager::inst()->recoveryFile());
+		// only collecting the project has to be done here, formatting,
+		// compressing and writing a big one would stall the GUI
+		auto dataFile = std::make_unique<DataFile>(DataFile::Type::SongProject);
+		Engine::getSong()->saveProjectData(*dataFile);
+		m_autoSavePool.start(new AutoSaveTask(std::move(dataFile), ConfigManager::inst()->recoveryFile()));
 		autoSaveTimerReset();  // Reset timer
 	}
 	else
@@ -67,6 +67,11 @@ namespace lmms::gui
         m_channelNumberLcd->setValue(channelIndex);
         retainSizeWhenHidden(m_channelNumberLcd);
 
+        m_cpuLoadLabel = new QLabel{this};
+        m_cpuLoadLabel->setFont(pointSizeF(font(), 7.5f));
+        m_cpuLoadLabel->setAlignment(Qt::AlignHCenter);
+        m_cpuLoadLabel->setToolTip(tr("CPU load of this channel, its effects and the tracks sending to it"));
+
         const auto mixerChannel = Engine::mixer()->mixerChannel(channelIndex);
         const auto mixerName = mixerChannel->m_name;
         setToolTip(mixerName);
@@ -133,6 +138,7 @@ namespace lmms::gui
         mainLayout->addWidget(m_sendKnob, 0, Qt::AlignHCenter);
         mainLayout->addWidget(m_sendArrow, 0, Qt::AlignHCenter);
         mainLayout->addWidget(m_channelNumberLcd, 0, Qt::AlignHCenter);
+        mainLayout->addWidget(m_cpuLoadLabel, 0, Qt::AlignHCenter);
         mainLayout->addStretch();
         mainLayout->addWidget(m_renameLineEditView, 0, Qt::AlignHCenter);
         mainLayout->addLayout(soloMuteLayout, 0);
@@ -152,6 +158,23 @@ namespace lmms::gui
         }
 
         contextMenu->addAction(tr("Rename &channel"), this, &MixerChannelView::renameChannel);
+
+        // the effects run in parallel, but every one after the first delays the channel by a period
+        BoolModel* pipelined = mixerChannel()->m_fxChain.pipelinedModel();
+        QAction* pipelineAction = contextMenu->addAction(tr("&Pipeline effects (adds latency)"));
+        pipelineAction->setCheckable(true);
+        pipelineAction->setChecked(pipelined->value());
+        connect(pipelineAction, &QAction::toggled, [pipelined](bool checked) { pipelined->setValue(checked); });
+
+        if (!isMasterChannel()) // the master is the device's output anyway
+        {
+            // only drivers with outputs for channels (JACK) do anything with it
+            BoolModel* output = &mixerChannel()->m_outputModel;
+            QAction* outputAction = contextMenu->addAction(tr("Own &output on the audio device"));
+            outputAction->setCheckable(true);
+            outputAction->setChecked(output->value());
+            connect(outputAction, &QAction::toggled, [output](bool checked) { output->setValue(checked); });
+        }
         contextMenu->addSeparator();
 
         if (!isMasterChannel()) // no remove-option in master
@@ -373,6 +396,7 @@ namespace lmms::gui
         if (!newName.isEmpty() && mc->m_name != newName)
         {
             mc->m_name = newName;
+            mc->updateOutputName();
             m_renameLineEdit->setText(elideName(newName));
             Engine::getSong()->setModified();
         }
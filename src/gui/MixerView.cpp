@@ -30,6 +30,7 @@
 #include <QScrollArea>
 #include <QStyle>
 #include <QKeyEvent>
+#include <algorithm>
 
 #include "lmms_math.h"
 
@@ -602,35 +603,36 @@ void MixerView::updateFaders()
 {
 	Mixer * m = getMixer();
 
-	// apply master gain
-	m->mixerChannel(0)->m_peakLeft *= Engine::audioEngine()->masterGain();
-	m->mixerChannel(0)->m_peakRight *= Engine::audioEngine()->masterGain();
-
 	for (int i = 0; i < m_mixerChannelViews.size(); ++i)
 	{
-		const float opl = m_mixerChannelViews[i]->m_fader->getPeak_L();
-		const float opr = m_mixerChannelViews[i]->m_fader->getPeak_R();
-		const float fallOff = 1.25;
-		if (m->mixerChannel(i)->m_peakLeft >= opl/fallOff)
-		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L(m->mixerChannel(i)->m_peakLeft);
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakLeft = -1;
-		}
-		else if (m->mixerChannel(i)->m_peakLeft != -1)
+		// nothing new if no period was mixed since the last update
+		auto levels = m->mixerChannel(i)->takeLevels();
+		if (levels)
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L(opl/fallOff);
+			// apply master gain
+			if (i == 0)
+			{
+				levels->peakLeft *= Engine::audioEngine()->masterGain();
+				levels->peakRight *= Engine::audioEngine()->masterGain();
+			}
+
+			Fader * fader = m_mixerChannelViews[i]->m_fader;
+			const float fallOff = 1.25;
+			fader->setPeak_L(std::max(levels->peakLeft, fader->getPeak_L() / fallOff));
+			fader->setPeak_R(std::max(levels->peakRight, fader->getPeak_R() / fallOff));
 		}
 
-		if (m->mixerChannel(i)->m_peakRight >= opr/fallOff)
+		const auto cpuLoad = QString("%1%").arg(m->mixerChannel(i)->cpuLoad());
+		if (m_mixerChannelViews[i]->m_cpuLoadLabel->text() != cpuLoad)
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R(m->mixerChannel(i)->m_peakRight);
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakRight = -1;
+			m_mixerChannelViews[i]->m_cpuLoadLabel->setText(cpuLoad);
 		}
-		else if (m->mixerChannel(i)->m_peakRight != -1)
+
+		// the audio thread mutes infs and nans, say where they came from
+		if (m->mixerChannel(i)->takeNonFinite())
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R(opr/fallOff);
+			m_mixerChannelViews[i]->setToolTip(tr("%1\nInfinite or NaN samples came from this channel "
+				"or the tracks sending to it, and were muted").arg(m->mixerChannel(i)->m_name));
 		}
 	}
 }
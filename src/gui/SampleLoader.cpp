@@ -32,6 +32,7 @@
 #include "FileDialog.h"
 #include "GuiApplication.h"
 #include "PathUtil.h"
+#include "SampleCache.h"
 #include "SampleDecoder.h"
 #include "Song.h"
 
@@ -94,7 +95,7 @@ std::shared_ptr<const SampleBuffer> SampleLoader::createBufferFromFile(const QSt
 
 	try
 	{
-		return std::make_shared<SampleBuffer>(filePath);
+		return SampleCache::get(filePath);
 	}
 	catch (const std::runtime_error& error)
 	{
@@ -103,10 +104,28 @@ std::shared_ptr<const SampleBuffer> SampleLoader::createBufferFromFile(const QSt
 	}
 }
 
+std::shared_ptr<SampleStream> SampleLoader::createStreamFromFile(const QString& filePath)
+{
+	if (!SampleStream::canStream(filePath)) { return nullptr; }
+
+	try
+	{
+		return std::make_shared<SampleStream>(filePath);
+	}
+	catch (const std::runtime_error& error)
+	{
+		if (getGUI()) { displayError(QString::fromStdString(error.what())); }
+		return nullptr;
+	}
+}
+
 std::shared_ptr<const SampleBuffer> SampleLoader::createBufferFromBase64(const QString& base64, int sampleRate)
 {
 	if (base64.isEmpty()) { return SampleBuffer::emptyBuffer(); }
 
+	// decoded already if it's a sample of the project that is being loaded
+	if (auto buffer = SampleCache::getEmbedded(base64, sampleRate)) { return buffer; }
+
 	try
 	{
 		return std::make_shared<SampleBuffer>(base64, sampleRate);
@@ -24,6 +24,8 @@
 
 #include "SampleWaveform.h"
 
+#include "SamplePeaks.h"
+
 namespace lmms::gui {
 
 void SampleWaveform::visualize(Parameters parameters, QPainter& painter, const QRect& rect)
@@ -45,35 +47,76 @@ void SampleWaveform::visualize(Parameters parameters, QPainter& painter, const Q
 	const auto framesPerResolution = framesPerPixel / resolution;
 
 	const auto numPixels = std::min<size_t>(parameters.size, width);
-	auto min = std::vector<float>(numPixels, 1);
-	auto max = std::vector<float>(numPixels, -1);
-	auto squared = std::vector<float>(numPixels);
+
+	// only the columns inside the painter's clipping are worked out, a long
+	// sample on the timeline is much wider than the part of it that shows
+	auto firstPixel = size_t{0};
+	auto lastPixel = numPixels;
+	if (painter.hasClipping())
+	{
+		const auto clip = painter.clipBoundingRect().toAlignedRect();
+		firstPixel = std::clamp<qint64>(clip.left() - x, 0, numPixels);
+		lastPixel = std::clamp<qint64>(clip.right() + 1 - x, firstPixel, numPixels);
+	}
+
+	auto min = std::vector<float>(lastPixel - firstPixel, 1);
+	auto max = std::vector<float>(lastPixel - firstPixel, -1);
+	auto rms = std::vector<float>(lastPixel - firstPixel);
 
 	const auto maxFrames = numPixels * framesPerPixel;
-	for (int i = 0; i < maxFrames; i += resolution)
+	const auto peaks = parameters.source ? parameters.source->peaks() : nullptr;
+	const auto level = peaks ? peaks->levelFor(framesPerPixel / 4) : -1;
+	if (level >= 0)
+	{
+		// a few bins per pixel are close enough to the frames, and much faster to go through
+		const auto& bins = peaks->level(level);
+		const auto binFrames = peaks->binFrames(level);
+		const auto offset = static_cast<size_t>(parameters.buffer - parameters.source->data());
+		for (auto pixel = firstPixel; pixel < lastPixel; pixel++)
+		{
+			const auto i = pixel - firstPixel;
+			const auto start = !parameters.reversed ? pixel * framesPerPixel : maxFrames - (pixel + 1) * framesPerPixel;
+			const auto first = (offset + start) / binFrames;
+			const auto last = std::min(bins.size(), (offset + start + framesPerPixel - 1) / binFrames + 1);
+
+			auto squares = 0.0f;
+			for (auto bin = first; bin < last; ++bin)
+			{
+				min[i] = std::min(min[i], bins[bin].min);
+				max[i] = std::max(max[i], bins[bin].max);
+				squares += bins[bin].squares;
+			}
+			if (last > first) { rms[i] = std::sqrt(squares / ((last - first) * binFrames)); }
+		}
+	}
+	else
 	{
-		const auto pixelIndex = i / framesPerPixel;
-		const auto frameIndex = !parameters.reversed ? i : maxFrames - i;
+		for (auto i = firstPixel * framesPerPixel; i < lastPixel * framesPerPixel; i += resolution)
+		{
+			const auto pixelIndex = i / framesPerPixel - firstPixel;
+			const auto frameIndex = !parameters.reversed ? i : maxFrames - i;
+
+			const auto& frame = parameters.buffer[frameIndex];
+			const auto value = std::accumulate(frame.begin(), frame.end(), 0.0f) / frame.size();
 
-		const auto& frame = parameters.buffer[frameIndex];
-		const auto value = std::accumulate(frame.begin(), frame.end(), 0.0f) / frame.size();
+			if (value > max[pixelIndex]) { max[pixelIndex] = value; }
+			if (value < min[pixelIndex]) { min[pixelIndex] = value; }
 
-		if (value > max[pixelIndex]) { max[pixelIndex] = value; }
-		if (value < min[pixelIndex]) { min[pixelIndex] = value; }
+			rms[pixelIndex] += value * value;
+		}
 
-		squared[pixelIndex] += value * value;
+		for (auto& value : rms) { value = std::sqrt(value / framesPerResolution); }
 	}
 
-	for (int i = 0; i < numPixels; i++)
+	for (size_t i = 0; i < min.size(); i++)
 	{
 		const auto lineY1 = centerY - max[i] * halfHeight * parameters.amplification;
 		const auto lineY2 = centerY - min[i] * halfHeight * parameters.amplification;
-		const auto lineX = i + x;
+		const auto lineX = static_cast<int>(firstPixel + i) + x;
 		painter.drawLine(lineX, lineY1, lineX, lineY2);
 
-		const auto rms = std::sqrt(squared[i] / framesPerResolution);
-		const auto maxRMS = std::clamp(rms, min[i], max[i]);
-		const auto minRMS = std::clamp(-rms, min[i], max[i]);
+		const auto maxRMS = std::clamp(rms[i], min[i], max[i]);
+		const auto minRMS = std::clamp(-rms[i], min[i], max[i]);
 
 		const auto rmsLineY1 = centerY - maxRMS * halfHeight * parameters.amplification;
 		const auto rmsLineY2 = centerY - minRMS * halfHeight * parameters.amplification;
@@ -0,0 +1,185 @@
+/*
+ * StallDetector.cpp - reports when the user interface stops responding
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "StallDetector.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QAbstractEventDispatcher>
+#include <QEvent>
+#include <QMetaEnum>
+
+#if defined(LMMS_HAVE_BACKTRACE) && defined(LMMS_HAVE_PTHREAD_H)
+#define LMMS_SAMPLE_GUI_STACK
+#include <csignal>
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+namespace lmms::gui
+{
+
+#ifdef LMMS_SAMPLE_GUI_STACK
+namespace
+{
+
+constexpr int MaxFrames = 64;
+void* s_frames[MaxFrames];
+std::atomic_int s_frameCount{-1};
+
+// runs on the GUI thread when the detector sends it SIGUSR2
+void sampleStack(int)
+{
+	s_frameCount.store(backtrace(s_frames, MaxFrames), std::memory_order_release);
+}
+
+} // namespace
+#endif
+
+
+
+
+StallDetector::StallDetector(int thresholdMs) :
+	m_thresholdMs(std::max(1, thresholdMs))
+{
+	m_clock.start();
+
+	const auto dispatcher = QAbstractEventDispatcher::instance();
+	connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this,
+		[this] { m_busySince.store(-1, std::memory_order_release); }, Qt::DirectConnection);
+	connect(dispatcher, &QAbstractEventDispatcher::awake, this, [this] { progress(); }, Qt::DirectConnection);
+
+#ifdef LMMS_SAMPLE_GUI_STACK
+	m_guiThread = pthread_self();
+
+	// backtrace() loads what it needs on its first call, which mustn't be in the signal handler
+	backtrace(s_frames, 1);
+
+	struct sigaction action = {};
+	action.sa_handler = sampleStack;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGUSR2, &action, nullptr);
+#endif
+
+	start(QThread::LowPriority);
+}
+
+
+
+
+StallDetector::~StallDetector()
+{
+	m_quit = true;
+	wait();
+}
+
+
+
+
+void StallDetector::beginEvent(const QObject* receiver, const QEvent* event)
+{
+	m_events.emplace_back(event->type(), receiver->metaObject()->className());
+	m_eventType.store(m_events.back().first, std::memory_order_relaxed);
+	m_receiverClass.store(m_events.back().second, std::memory_order_relaxed);
+	progress();
+}
+
+
+
+
+void StallDetector::endEvent()
+{
+	m_events.pop_back();
+	m_eventType.store(m_events.empty() ? 0 : m_events.back().first, std::memory_order_relaxed);
+	m_receiverClass.store(m_events.empty() ? nullptr : m_events.back().second, std::memory_order_relaxed);
+	progress();
+}
+
+
+
+
+void StallDetector::progress()
+{
+	m_busySince.store(m_clock.elapsed(), std::memory_order_release);
+}
+
+
+
+
+void StallDetector::run()
+{
+	// every stall is reported once, when it gets longer than the threshold
+	auto reported = std::int64_t{-1};
+	while (!m_quit)
+	{
+		msleep(std::max(1, m_thresholdMs / 4));
+
+		const auto busySince = m_busySince.load(std::memory_order_acquire);
+		if (busySince < 0 || busySince == reported) { continue; }
+
+		const auto stalledMs = m_clock.elapsed() - busySince;
+		if (stalledMs < m_thresholdMs) { continue; }
+
+		report(stalledMs);
+		reported = busySince;
+	}
+}
+
+
+
+
+void StallDetector::report(std::int64_t stalledMs)
+{
+	const auto receiverClass = m_receiverClass.load(std::memory_order_relaxed);
+	if (!receiverClass)
+	{
+		qWarning("The user interface hasn't responded for %lld ms, outside of any event",
+			static_cast<long long>(stalledMs));
+	}
+	else
+	{
+		const auto type = m_eventType.load(std::memory_order_relaxed);
+		const auto typeName = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+		qWarning("The user interface hasn't responded for %lld ms, in a %s event (%d) to a %s",
+			static_cast<long long>(stalledMs), typeName ? typeName : "custom", type, receiverClass);
+	}
+
+#ifdef LMMS_SAMPLE_GUI_STACK
+	s_frameCount.store(-1, std::memory_order_relaxed);
+	pthread_kill(m_guiThread, SIGUSR2);
+	for (int i = 0; i < 100 && s_frameCount.load(std::memory_order_acquire) < 0; ++i) { msleep(1); }
+
+	const auto frameCount = s_frameCount.load(std::memory_order_acquire);
+	if (frameCount > 0)
+	{
+		fprintf(stderr, "Stack of the user interface thread:\n");
+		backtrace_symbols_fd(s_frames, frameCount, STDERR_FILENO);
+	}
+#endif
+}
+
+
+} // namespace lmms::gui
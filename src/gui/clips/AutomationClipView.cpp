@@ -28,6 +28,7 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QMenu>
+#include <algorithm>
 
 #include "AutomationEditor.h"
 #include "embed.h"
@@ -284,6 +285,9 @@ void AutomationClipView::paintEvent( QPaintEvent * )
 	lin2grad.setColorAt( 0.5, col );
 	lin2grad.setColorAt( 0, col.darker( 150 ) );
 
+	// there's no point in more than one value per pixel
+	const int step = std::max( 1, static_cast<int>( 1 / ppTick ) );
+
 	p.setRenderHints( QPainter::Antialiasing, true );
 	for( AutomationClip::timeMap::const_iterator it =
 						m_clip->getTimeMap().begin();
@@ -306,7 +310,7 @@ void AutomationClipView::paintEvent( QPaintEvent * )
 			break;
 		}
 
-		float *values = m_clip->valuesAfter(POS(it));
+		float *values = m_clip->valuesAfter(POS(it), step);
 
 		// We are creating a path to draw a polygon representing the values between two
 		// nodes. When we have two nodes with discrete progression, we will basically have
@@ -329,11 +333,11 @@ void AutomationClipView::paintEvent( QPaintEvent * )
 		path.moveTo( origin );
 		path.moveTo(QPointF(POS(it) * ppTick,values[0]));
 		float x;
-		for (int i = POS(it) + 1; i < POS(it + 1); i++)
+		for (int i = POS(it) + step; i < POS(it + 1); i += step)
 		{
 			x = i * ppTick;
 			if( x > ( width() - BORDER_WIDTH ) ) break;
-			float value = values[i - POS(it)];
+			float value = values[(i - POS(it)) / step];
 			path.lineTo( QPointF( x, value ) );
 
 		}
@@ -444,7 +444,6 @@ void ClipView::dragEnterEvent( QDragEnterEvent * dee )
 void ClipView::dropEvent( QDropEvent * de )
 {
 	QString type = StringPairDrag::decodeKey( de );
-	QString value = StringPairDrag::decodeValue( de );
 
 	// Track must be the same type to paste into
 	if( type != ( "clip_" + QString::number( static_cast<int>(m_clip->getTrack()->type()) ) ) )
@@ -474,7 +473,7 @@ void ClipView::dropEvent( QDropEvent * de )
 	}
 
 	// Copy state into existing clip
-	DataFile dataFile( value.toUtf8() );
+	DataFile dataFile = Clipboard::decodeDataFile( de->mimeData() );
 	TimePos pos = m_clip->startPosition();
 	QDomElement clips = dataFile.content().firstChildElement("clips");
 	m_clip->restoreState( clips.firstChildElement().firstChildElement() );
@@ -819,7 +818,7 @@ void ClipView::mouseMoveEvent( QMouseEvent * me )
 				Qt::SmoothTransformation );
 			new StringPairDrag( QString( "clip_%1" ).arg(
 								static_cast<int>(m_clip->getTrack()->type()) ),
-								dataFile.toString(), thumbnail, this );
+								dataFile, [dataFile] { return dataFile.toString(); }, thumbnail, this );
 		}
 	}
 
@@ -1189,15 +1188,16 @@ void ClipView::remove( QVector<ClipView *> clipvs )
 
 void ClipView::copy( QVector<ClipView *> clipvs )
 {
-	// For copyStringPair()
+	// For copyLocal()
 	using namespace Clipboard;
 
 	// Write the Clips to a DataFile for copying
 	DataFile dataFile = createClipDataFiles( clipvs );
 
-	// Copy the Clip type as a key and the Clip data file to the clipboard
-	copyStringPair( QString( "clip_%1" ).arg( static_cast<int>(m_clip->getTrack()->type()) ),
-		dataFile.toString() );
+	// Copy the Clip type as a key and the Clip data file to the clipboard, it's
+	// only written as XML when another instance pastes it
+	copyLocal( MimeType::StringPair, QString( "clip_%1" ).arg( static_cast<int>(m_clip->getTrack()->type()) ),
+		dataFile, [dataFile] { return dataFile.toString(); } );
 }
 
 void ClipView::cut( QVector<ClipView *> clipvs )
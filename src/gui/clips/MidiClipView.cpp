@@ -27,12 +27,18 @@
 
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
 #include <QApplication>
+#include <QImage>
 #include <QInputDialog>
 #include <QMenu>
 #include <QPainter>
-#include <cmath>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include "AutomationEditor.h"
 #include "ConfigManager.h"
@@ -47,6 +53,177 @@ namespace lmms::gui
 {
 
 
+static int computeNoteRange(int minKey, int maxKey)
+{
+	return (maxKey - minKey) + 1;
+}
+
+
+
+
+struct MidiClipView::NoteLayer
+{
+	//! Everything the image depends on
+	struct Look
+	{
+		QSize size;
+		float distanceToTop = 0;
+		float tickLength = 0;
+		QColor fillColor;
+		QColor borderColor;
+		bool drawAsLines = false;
+		//! The position, length and key of each note
+		std::vector<std::array<int, 3>> notes;
+
+		bool operator==(const Look& other) const
+		{
+			return size == other.size && distanceToTop == other.distanceToTop
+				&& tickLength == other.tickLength && fillColor == other.fillColor
+				&& borderColor == other.borderColor && drawAsLines == other.drawAsLines
+				&& notes == other.notes;
+		}
+	};
+
+	static QImage draw(const Look& look);
+
+	std::mutex mutex;
+	//! Null once the view is gone
+	MidiClipView* view = nullptr;
+	//! What image shows and what the view wants it to show
+	Look look;
+	Look wanted;
+	QImage image;
+	bool drawing = false;
+};
+
+
+
+
+QImage MidiClipView::NoteLayer::draw(const Look& look)
+{
+	auto image = QImage{look.size, QImage::Format_ARGB32_Premultiplied};
+	image.fill(Qt::transparent);
+
+	// Compute the minimum and maximum key in the clip
+	// so that we know how much there is to draw.
+	int maxKey = std::numeric_limits<int>::min();
+	int minKey = std::numeric_limits<int>::max();
+
+	for (const auto& note : look.notes)
+	{
+		maxKey = qMax(maxKey, note[2]);
+		minKey = qMin(minKey, note[2]);
+	}
+
+	// If needed adjust the note range so that we always have paint a certain interval
+	int const minimalNoteRange = 12; // Always paint at least one octave
+	int const actualNoteRange = computeNoteRange(minKey, maxKey);
+
+	if (actualNoteRange < minimalNoteRange)
+	{
+		int missingNumberOfNotes = minimalNoteRange - actualNoteRange;
+		minKey = std::max(0, minKey - missingNumberOfNotes / 2);
+		maxKey = maxKey + missingNumberOfNotes / 2;
+		if (missingNumberOfNotes % 2 == 1)
+		{
+			// Put more range at the top to bias drawing towards the bottom
+			++maxKey;
+		}
+	}
+
+	int const adjustedNoteRange = computeNoteRange(minKey, maxKey);
+
+	int const notesBorder = 4; // Border for the notes towards the top and bottom in pixels
+
+	QPainter p(&image);
+	p.translate(0., look.distanceToTop + notesBorder);
+	p.scale(look.size.width(), look.size.height() - look.distanceToTop - 2 * notesBorder);
+
+	if (look.drawAsLines)
+	{
+		p.setPen(look.fillColor);
+	}
+	else
+	{
+		p.setPen(look.borderColor);
+		p.setRenderHint(QPainter::Antialiasing);
+	}
+
+	// Needed for Qt5 although the documentation for QPainter::setPen(QColor) as it's used above
+	// states that it should already set a width of 0.
+	QPen pen = p.pen();
+	pen.setWidth(0);
+	p.setPen(pen);
+
+	float const noteHeight = 1. / adjustedNoteRange;
+
+	// scan through all the notes and draw them on the clip
+	for (const auto& note : look.notes)
+	{
+		// Map to 0, 1, 2, ...
+		int mappedNoteKey = note[2] - minKey;
+		int invertedMappedNoteKey = adjustedNoteRange - mappedNoteKey - 1;
+
+		float const noteStartX = note[0] * look.tickLength;
+		float const noteLength = note[1] * look.tickLength;
+
+		float const noteStartY = invertedMappedNoteKey * noteHeight;
+
+		QRectF noteRectF( noteStartX, noteStartY, noteLength, noteHeight);
+		if (look.drawAsLines)
+		{
+			p.drawLine(QPointF(noteStartX, noteStartY + 0.5 * noteHeight),
+				   QPointF(noteStartX + noteLength, noteStartY + 0.5 * noteHeight));
+		}
+		else
+		{
+			p.fillRect( noteRectF, look.fillColor );
+			p.drawRect( noteRectF );
+		}
+	}
+
+	return image;
+}
+
+
+
+
+class MidiClipView::NoteLayerTask : public QRunnable
+{
+public:
+	NoteLayerTask(std::shared_ptr<NoteLayer> layer) :
+		m_layer(std::move(layer))
+	{
+	}
+
+	void run() override
+	{
+		auto lock = std::unique_lock{m_layer->mutex};
+		while (true)
+		{
+			const auto look = m_layer->wanted;
+			lock.unlock();
+			auto image = NoteLayer::draw(look);
+			lock.lock();
+
+			m_layer->image = std::move(image);
+			m_layer->look = look;
+			// the notes may have changed again in the meantime
+			if (m_layer->wanted == look) { break; }
+		}
+		m_layer->drawing = false;
+
+		// the view can't be destroyed while we hold the lock
+		if (m_layer->view) { QMetaObject::invokeMethod(m_layer->view, "update", Qt::QueuedConnection); }
+	}
+
+private:
+	std::shared_ptr<NoteLayer> m_layer;
+};
+
+
+
+
 MidiClipView::MidiClipView( MidiClip* clip, TrackView* parent ) :
 	ClipView( clip, parent ),
 	m_clip( clip ),
@@ -56,8 +233,11 @@ MidiClipView::MidiClipView( MidiClip* clip, TrackView* parent ) :
 	m_mutedNoteFillColor(100, 100, 100, 220),
 	m_mutedNoteBorderColor(100, 100, 100, 220),
 	// TODO if this option is ever added to the GUI, rename it to legacysepattern
-	m_legacySEPattern(ConfigManager::inst()->value("ui", "legacysebb", "0").toInt())
+	m_legacySEPattern(ConfigManager::inst()->value("ui", "legacysebb", "0").toInt()),
+	m_noteLayer(std::make_shared<NoteLayer>())
 {
+	m_noteLayer->view = this;
+
 	connect( getGUI()->pianoRoll(), SIGNAL(currentMidiClipChanged()),
 			this, SLOT(update()));
 	update();
@@ -68,6 +248,16 @@ MidiClipView::MidiClipView( MidiClip* clip, TrackView* parent ) :
 
 
 
+MidiClipView::~MidiClipView()
+{
+	// a task still drawing holds on to the layer, but mustn't call us back
+	const auto lock = std::lock_guard{m_noteLayer->mutex};
+	m_noteLayer->view = nullptr;
+}
+
+
+
+
 MidiClip* MidiClipView::getMidiClip()
 {
 	return m_clip;
@@ -365,10 +555,6 @@ void MidiClipView::wheelEvent(QWheelEvent * we)
 }
 
 
-static int computeNoteRange(int minKey, int maxKey)
-{
-	return (maxKey - minKey) + 1;
-}
 
 void MidiClipView::paintEvent( QPaintEvent * )
 {
@@ -515,36 +701,6 @@ void MidiClipView::paintEvent( QPaintEvent * )
 			m_clip->m_clipType == MidiClip::Type::BeatClip)
 	)
 	{
-		// Compute the minimum and maximum key in the clip
-		// so that we know how much there is to draw.
-		int maxKey = std::numeric_limits<int>::min();
-		int minKey = std::numeric_limits<int>::max();
-
-		for (Note const * note : noteCollection)
-		{
-			int const key = note->key();
-			maxKey = qMax( maxKey, key );
-			minKey = qMin( minKey, key );
-		}
-
-		// If needed adjust the note range so that we always have paint a certain interval
-		int const minimalNoteRange = 12; // Always paint at least one octave
-		int const actualNoteRange = computeNoteRange(minKey, maxKey);
-
-		if (actualNoteRange < minimalNoteRange)
-		{
-			int missingNumberOfNotes = minimalNoteRange - actualNoteRange;
-			minKey = std::max(0, minKey - missingNumberOfNotes / 2);
-			maxKey = maxKey + missingNumberOfNotes / 2;
-			if (missingNumberOfNotes % 2 == 1)
-			{
-				// Put more range at the top to bias drawing towards the bottom
-				++maxKey;
-			}
-		}
-
-		int const adjustedNoteRange = computeNoteRange(minKey, maxKey);
-
 		// Transform such that [0, 1] x [0, 1] paints in the correct area
 		float distanceToTop = textBoxHeight;
 
@@ -567,65 +723,38 @@ void MidiClipView::paintEvent( QPaintEvent * )
 			}
 		}
 
-		int const notesBorder = 4; // Border for the notes towards the top and bottom in pixels
-
-		// The relavant painting code starts here
-		p.save();
-
-		p.translate(0., distanceToTop + notesBorder);
-		p.scale(width(), height() - distanceToTop - 2 * notesBorder);
-
 		// set colour based on mute status
-		QColor noteFillColor = muted ? getMutedNoteFillColor().lighter(200)
-									 : (c.lightness() > 175 ? getNoteFillColor().darker(400) : getNoteFillColor());
-		QColor noteBorderColor = muted ? getMutedNoteBorderColor()
-									   : (hasCustomColor() ? c.lighter(200) : getNoteBorderColor());
-
-		bool const drawAsLines = height() < 64;
-		if (drawAsLines)
-		{
-			p.setPen(noteFillColor);
-		}
-		else
+		auto look = NoteLayer::Look{};
+		look.size = size();
+		look.distanceToTop = distanceToTop;
+		look.tickLength = tickLength;
+		look.fillColor = muted ? getMutedNoteFillColor().lighter(200)
+			: (c.lightness() > 175 ? getNoteFillColor().darker(400) : getNoteFillColor());
+		look.borderColor = muted ? getMutedNoteBorderColor()
+			: (hasCustomColor() ? c.lighter(200) : getNoteBorderColor());
+		look.drawAsLines = height() < 64;
+		look.notes.reserve(noteCollection.size());
+		for (Note const * note : noteCollection)
 		{
-			p.setPen(noteBorderColor);
-			p.setRenderHint(QPainter::Antialiasing);
+			look.notes.push_back({note->pos(), note->length(), note->key()});
 		}
 
-		// Needed for Qt5 although the documentation for QPainter::setPen(QColor) as it's used above
-		// states that it should already set a width of 0.
-		QPen pen = p.pen();
-		pen.setWidth(0);
-		p.setPen(pen);
-
-		float const noteHeight = 1. / adjustedNoteRange;
-
-		// scan through all the notes and draw them on the clip
-		for (Note const * currentNote : noteCollection)
+		// the notes are drawn on a background thread, until that's done
+		// the last image is stretched over the clip
+		const auto lock = std::lock_guard{m_noteLayer->mutex};
+		if (!(m_noteLayer->look == look) && !(m_noteLayer->wanted == look && m_noteLayer->drawing))
 		{
-			// Map to 0, 1, 2, ...
-			int mappedNoteKey = currentNote->key() - minKey;
-			int invertedMappedNoteKey = adjustedNoteRange - mappedNoteKey - 1;
-
-			float const noteStartX = currentNote->pos() * tickLength;
-			float const noteLength = currentNote->length() * tickLength;
-
-			float const noteStartY = invertedMappedNoteKey * noteHeight;
-
-			QRectF noteRectF( noteStartX, noteStartY, noteLength, noteHeight);
-			if (drawAsLines)
-			{
-				p.drawLine(QPointF(noteStartX, noteStartY + 0.5 * noteHeight),
-					   QPointF(noteStartX + noteLength, noteStartY + 0.5 * noteHeight));
-			}
-			else
+			m_noteLayer->wanted = std::move(look);
+			if (!m_noteLayer->drawing)
 			{
-				p.fillRect( noteRectF, noteFillColor );
-				p.drawRect( noteRectF );
+				m_noteLayer->drawing = true;
+				QThreadPool::globalInstance()->start(new NoteLayerTask(m_noteLayer));
 			}
 		}
-
-		p.restore();
+		if (!m_noteLayer->image.isNull())
+		{
+			p.drawImage(rect(), m_noteLayer->image);
+		}
 	}
 
 	// bar lines
@@ -203,13 +203,16 @@ void SampleClipView::paintEvent( QPaintEvent * pe )
 {
 	QPainter painter( this );
 
-	if( !needsUpdate() )
+	// the waveform is only drawn where the clip shows, a long one reaches far out of the song editor
+	const auto visible = visibleRegion().boundingRect();
+	if( !needsUpdate() && m_paintedRect.contains( visible ) )
 	{
 		painter.drawPixmap( 0, 0, m_paintPixmap );
 		return;
 	}
 
 	setNeedsUpdate( false );
+	m_paintedRect = visible;
 
 	if (m_paintPixmap.isNull() || m_paintPixmap.size() != size())
 	{
@@ -271,8 +274,10 @@ void SampleClipView::paintEvent( QPaintEvent * pe )
 			qMax( static_cast<int>( m_clip->sampleLength() * ppb / ticksPerBar ), 1 ), rect().bottom() - 2 * spacing );
 
 	const auto& sample = m_clip->m_sample;
-	const auto waveform = SampleWaveform::Parameters{sample.data(), sample.sampleSize(), sample.amplification(), sample.reversed()};
+	const auto waveform = SampleWaveform::Parameters{sample.waveform().data(), sample.waveform().size(), sample.amplification(), sample.reversed(), &sample.waveform()};
+	p.setClipRect(visible);
 	SampleWaveform::visualize(waveform, p, r);
+	p.setClipping(false);
 
 	QString name = PathUtil::cleanName(m_clip->m_sample.sampleFile());
 	paintTextLabel(name, p);
@@ -36,6 +36,7 @@
 #include <QScrollBar>
 #include <QStyleOption>
 #include <QToolTip>
+#include <algorithm>
 #include <cmath>
 
 #include "SampleClip.h"
@@ -1251,7 +1252,8 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 			
 			const auto& sample = m_ghostSample->sample();
 			const auto waveform = SampleWaveform::Parameters{
-				sample.data(), sample.sampleSize(), sample.amplification(), sample.reversed()};
+				sample.waveform().data(), sample.waveform().size(), sample.amplification(), sample.reversed(),
+				&sample.waveform()};
 			const auto rect = QRect(startPos, yOffset, sampleWidth, sampleHeight);
 			SampleWaveform::visualize(waveform, p, rect);
 		}
@@ -1339,6 +1341,9 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 		//Don't bother doing/rendering anything if there is no automation points
 		if( time_map.size() > 0 )
 		{
+			// there's no point in more than one value per pixel
+			const int step = std::max(1, TimePos::ticksPerBar() / m_ppb);
+
 			timeMap::iterator it = time_map.begin();
 			while( it+1 != time_map.end() )
 			{
@@ -1357,7 +1362,7 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 					break;
 				}
 
-				float *values = m_clip->valuesAfter(POS(it));
+				float *values = m_clip->valuesAfter(POS(it), step);
 
 				// We are creating a path to draw a polygon representing the values between two
 				// nodes. When we have two nodes with discrete progression, we will basically have
@@ -1378,9 +1383,9 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 				p.setRenderHints( QPainter::Antialiasing, true );
 				QPainterPath path;
 				path.moveTo(QPointF(xCoordOfTick(POS(it)), yCoordOfLevel(0)));
-				for (int i = 0; i < POS(it + 1) - POS(it); i++)
+				for (int i = 0; i < POS(it + 1) - POS(it); i += step)
 				{
-					path.lineTo(QPointF(xCoordOfTick(POS(it) + i), yCoordOfLevel(values[i])));
+					path.lineTo(QPointF(xCoordOfTick(POS(it) + i), yCoordOfLevel(values[i / step])));
 				}
 				path.lineTo(QPointF(xCoordOfTick(POS(it + 1)), yCoordOfLevel(nextValue)));
 				path.lineTo(QPointF(xCoordOfTick(POS(it + 1)), yCoordOfLevel(0)));
@@ -1400,15 +1405,12 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 				++it;
 			}
 
-			for (
-				int i = POS(it), x = xCoordOfTick(i);
-				x <= width();
-				i++, x = xCoordOfTick(i)
-			)
+			// Draws the rectangle representing the value after the last node (for
+			// that reason we use outValue), up to the right edge.
+			const int lastVisibleTick = m_currentPosition + (width() - VALUES_WIDTH) * TimePos::ticksPerBar() / m_ppb;
+			if (POS(it) <= lastVisibleTick)
 			{
-				// Draws the rectangle representing the value after the last node (for
-				// that reason we use outValue).
-				drawLevelTick(p, i, OUTVAL(it));
+				drawLevelTick(p, POS(it), OUTVAL(it), lastVisibleTick - POS(it) + 1);
 			}
 			// Draw circle(the last one)
 			drawAutomationPoint(p, it);
@@ -1512,11 +1514,11 @@ float AutomationEditor::yCoordOfLevel(float level )
 
 
 
-void AutomationEditor::drawLevelTick(QPainter & p, int tick, float value)
+void AutomationEditor::drawLevelTick(QPainter & p, int tick, float value, int ticks)
 {
 	int grid_bottom = height() - SCROLLBAR_SIZE - 1;
 	const int x = xCoordOfTick( tick );
-	int rect_width = xCoordOfTick( tick+1 ) - x;
+	int rect_width = xCoordOfTick( tick + ticks ) - x;
 
 	// is the level in visible area?
 	if( ( value >= m_bottomLevel && value <= m_topLevel )
@@ -45,8 +45,11 @@
 #define __USE_XOPEN
 #endif
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "AutomationEditor.h"
 #include "ActionGroup.h"
@@ -876,7 +879,7 @@ void PianoRoll::setCurrentMidiClip( MidiClip* newMidiClip )
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOn( const lmms::Note& ) ), this, SLOT( startRecordNote( const lmms::Note& ) ) );
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOff( const lmms::Note& ) ), this, SLOT( finishRecordNote( const lmms::Note& ) ) );
 	connect( m_midiClip, SIGNAL(dataChanged()), this, SLOT(update()));
-	connect( m_midiClip->instrumentTrack()->pianoModel(), SIGNAL(dataChanged()), this, SLOT(update()));
+	connect(m_midiClip->instrumentTrack()->pianoModel(), SIGNAL(dataChanged()), this, SLOT(updateKeys()));
 
 	connect(m_midiClip->instrumentTrack()->firstKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
 	connect(m_midiClip->instrumentTrack()->lastKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
@@ -3391,6 +3394,16 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			return (topKey - key) * m_keyLineHeight + keyAreaTop() - 1;
 		};
 
+		// only the notes in the part to repaint are drawn - moving the
+		// position line repaints a few pixels, which mustn't draw every note
+		// again. The edit handles are a bit wider than their line.
+		const int dirtyLeft = pe->rect().left() - m_whiteKeyWidth - NOTE_EDIT_LINE_WIDTH - 2;
+		const int dirtyRight = pe->rect().right() - m_whiteKeyWidth + NOTE_EDIT_LINE_WIDTH + 2;
+		auto isInDirtyArea = [&](const int x, const int noteWidth)
+		{
+			return x + noteWidth >= qMax(0, dirtyLeft) && x <= qMin(width() - m_whiteKeyWidth, dirtyRight);
+		};
+
 		// -- Begin ghost MIDI clip
 		if( !m_ghostNotes.empty() )
 		{
@@ -3413,7 +3426,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				const int x = ( pos_ticks - m_currentPosition ) *
 						m_ppb / TimePos::ticksPerBar();
 				// skip this note if not in visible area at all
-				if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
+				if (!isInDirtyArea(x, note_width))
 				{
 					continue;
 				}
@@ -3433,8 +3446,21 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		}
 		// -- End ghost MIDI clip
 
-		for( const Note *note : m_midiClip->notes() )
+		// the notes are sorted by their position, except while they're
+		// dragged, so none after the last one starting in the dirty area
+		// has to be looked at
+		const NoteVector& notes = m_midiClip->notes();
+		auto notesEnd = notes.end();
+		if (m_action != Action::MoveNote && m_action != Action::ResizeNote)
 		{
+			const int lastTick = m_currentPosition + (dirtyRight + 1) * TimePos::ticksPerBar() / m_ppb;
+			notesEnd = std::upper_bound(notes.begin(), notes.end(), lastTick,
+				[](const int tick, const Note* note) { return tick < note->pos(); });
+		}
+
+		for (auto it = notes.begin(); it != notesEnd; ++it)
+		{
+			const Note* note = *it;
 			int len_ticks = note->length();
 
 			if( len_ticks == 0 )
@@ -3452,7 +3478,7 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			const int x = ( pos_ticks - m_currentPosition ) *
 					m_ppb / TimePos::ticksPerBar();
 			// skip this note if not in visible area at all
-			if (!(x + note_width >= 0 && x <= width() - m_whiteKeyWidth))
+			if (!isInDirtyArea(x, note_width))
 			{
 				continue;
 			}
@@ -4308,22 +4334,32 @@ void PianoRoll::updateYScroll()
 
 void PianoRoll::copyToClipboard( const NoteVector & notes ) const
 {
-	// For copyString() and MimeType enum class
+	// For copyLocal() and MimeType enum class
 	using namespace Clipboard;
 
-	DataFile dataFile( DataFile::Type::ClipboardData );
-	QDomElement note_list = dataFile.createElement( "note-list" );
-	dataFile.content().appendChild( note_list );
-
+	// the notes are kept as they are for pasting them in here, and only
+	// written as XML when another instance pastes them
+	auto clipNotes = std::make_shared<std::vector<Note>>();
+	clipNotes->reserve( notes.size() );
 	TimePos start_pos( notes.front()->pos().getBar(), 0 );
 	for( const Note *note : notes )
 	{
-		Note clip_note( *note );
-		clip_note.setPos( clip_note.pos( start_pos ) );
-		clip_note.saveState( dataFile, note_list );
+		clipNotes->push_back( *note );
+		clipNotes->back().setPos( note->pos( start_pos ) );
 	}
 
-	copyString( dataFile.toString(), MimeType::Default );
+	const auto shared = std::shared_ptr<const std::vector<Note>>( std::move( clipNotes ) );
+	copyLocal( MimeType::Default, QString(), shared, [shared]
+	{
+		DataFile dataFile( DataFile::Type::ClipboardData );
+		QDomElement note_list = dataFile.createElement( "note-list" );
+		dataFile.content().appendChild( note_list );
+		for( Note note : *shared )
+		{
+			note.saveState( dataFile, note_list );
+		}
+		return dataFile.toString();
+	} );
 }
 
 
@@ -4384,6 +4420,31 @@ void PianoRoll::pasteNotes()
 		return;
 	}
 
+	// notes copied in here don't need to be parsed
+	if( const auto notes = localValue<std::shared_ptr<const std::vector<Note>>>( getMimeData() ) )
+	{
+		clearSelectedNotes();
+		if( ( *notes )->empty() )
+		{
+			return;
+		}
+		m_midiClip->addJournalCheckPoint();
+
+		const TimePos offset = Note::quantized( m_timeLine->pos(), quantization() );
+		for( const Note & note : **notes )
+		{
+			Note cur_note( note );
+			cur_note.setPos( cur_note.pos() + offset );
+			cur_note.setSelected( true );
+			m_midiClip->addNote( cur_note, false );
+		}
+
+		Engine::getSong()->setModified();
+		update();
+		getGUI()->songEditor()->update();
+		return;
+	}
+
 	QString value = getString( MimeType::Default );
 
 	if( ! value.isEmpty() )
@@ -4492,6 +4553,15 @@ void PianoRoll::updatePosition( const TimePos & t )
 }
 
 
+void PianoRoll::updateKeys()
+{
+	// pressing a key changes nothing but its color
+	update(0, keyAreaTop(), m_whiteKeyWidth, keyAreaBottom() - keyAreaTop());
+}
+
+
+
+
 void PianoRoll::updatePositionLineHeight()
 {
 	m_positionLine->setFixedHeight(keyAreaBottom() - keyAreaTop());
@@ -396,6 +396,9 @@ void InstrumentTrackWindow::modelChanged()
 	m_tuningView->scaleCombo()->setModel(m_track->m_microtuner.scaleModel());
 	m_tuningView->keymapCombo()->setModel(m_track->m_microtuner.keymapModel());
 	m_tuningView->rangeImportCheckbox()->setModel(m_track->m_microtuner.keyRangeImportModel());
+	m_tuningView->polyphonyGroupBox()->setModel(&m_track->m_polyphonyEnabledModel);
+	m_tuningView->polyphonySpinBox()->setModel(&m_track->m_polyphonyModel);
+	m_tuningView->voiceStealingCombo()->setModel(&m_track->m_voiceStealingModel);
 	updateName();
 }
 
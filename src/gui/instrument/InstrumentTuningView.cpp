@@ -35,6 +35,7 @@
 #include "GuiApplication.h"
 #include "gui_templates.h"
 #include "InstrumentTrack.h"
+#include "LcdSpinBox.h"
 #include "LedCheckBox.h"
 #include "MainWindow.h"
 #include "PixmapButton.h"
@@ -110,6 +111,32 @@ InstrumentTuningView::InstrumentTuningView(InstrumentTrack *it, QWidget *parent)
 	m_rangeImportCheckbox->setCheckable(true);
 	microtunerLayout->addWidget(m_rangeImportCheckbox);
 
+	// Polyphony limit
+	m_polyphonyGroupBox = new GroupBox(tr("POLYPHONY"));
+	m_polyphonyGroupBox->setModel(&it->m_polyphonyEnabledModel);
+	layout->addWidget(m_polyphonyGroupBox);
+
+	auto polyphonyLayout = new QVBoxLayout(m_polyphonyGroupBox);
+	polyphonyLayout->setContentsMargins(8, 18, 8, 8);
+
+	auto polyphonyLabel = new QLabel(tr("Notes playing at once at most. For another one, a playing note is faded out:"));
+	polyphonyLabel->setWordWrap(true);
+	polyphonyLabel->setFont(pointSize<8>(polyphonyLabel->font()));
+	polyphonyLayout->addWidget(polyphonyLabel);
+
+	auto polyphonyEditLayout = new QHBoxLayout();
+	polyphonyLayout->addLayout(polyphonyEditLayout);
+
+	m_polyphonySpinBox = new LcdSpinBox(3, m_polyphonyGroupBox, tr("Polyphony"));
+	m_polyphonySpinBox->setModel(&it->m_polyphonyModel);
+	m_polyphonySpinBox->setToolTip(tr("Most notes playing at once, chords and arpeggios count every note"));
+	polyphonyEditLayout->addWidget(m_polyphonySpinBox);
+
+	m_voiceStealingCombo = new ComboBox();
+	m_voiceStealingCombo->setModel(&it->m_voiceStealingModel);
+	m_voiceStealingCombo->setToolTip(tr("Which note to fade out"));
+	polyphonyEditLayout->addWidget(m_voiceStealingCombo, 1);
+
 	// Fill remaining space
 	layout->addStretch();
 }
@@ -231,7 +231,8 @@ void ExportProjectDialog::onFileFormatChanged(int index)
 
 	bool bitDepthControlEnabled =
 			(exportFormat == ProjectRenderer::ExportFileFormat::Wave ||
-			 exportFormat == ProjectRenderer::ExportFileFormat::Flac);
+			 exportFormat == ProjectRenderer::ExportFileFormat::Flac ||
+			 exportFormat == ProjectRenderer::ExportFileFormat::Raw);
 
 	bool variableBitrateVisible = !(exportFormat == ProjectRenderer::ExportFileFormat::MP3 || exportFormat == ProjectRenderer::ExportFileFormat::Flac);
 
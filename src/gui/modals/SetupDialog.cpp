@@ -31,8 +31,10 @@
 #include <QLayout>
 #include <QLineEdit>
 #include <QScrollArea>
+#include <QSpinBox>
 
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "debug.h"
 #include "embed.h"
 #include "Engine.h"
@@ -40,6 +42,7 @@
 #include "gui_templates.h"
 #include "MainWindow.h"
 #include "MidiSetupWidget.h"
+#include "NotePlayHandle.h"
 #include "ProjectJournal.h"
 #include "SetupDialog.h"
 #include "TabBar.h"
@@ -52,6 +55,7 @@
 #include "AudioDummy.h"
 #include "AudioJack.h"
 #include "AudioOss.h"
+#include "AudioPipeWire.h"
 #include "AudioPortAudio.h"
 #include "AudioPulseAudio.h"
 #include "AudioSdl.h"
@@ -141,12 +145,36 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 			"ui", "vstalwaysontop").toInt()),
 	m_disableAutoQuit(ConfigManager::inst()->value(
 			"ui", "disableautoquit", "1").toInt()),
+	m_pipelinedRemotePlugins(ConfigManager::inst()->value(
+			"audioengine", "pipelinedremoteplugins").toInt()),
+	m_sharedVstProcess(ConfigManager::inst()->value(
+			"audioengine", "sharedvstprocess").toInt()),
 	m_NaNHandler(ConfigManager::inst()->value(
 			"app", "nanhandler", "1").toInt()),
 	m_hqAudioDev(ConfigManager::inst()->value(
 			"audioengine", "hqaudio").toInt()),
 	m_bufferSize(ConfigManager::inst()->value(
 			"audioengine", "framesperaudiobuffer").toInt()),
+	m_workerWaitPolicy(ConfigManager::inst()->value(
+			"audioengine", "workerwaitpolicy", "hybrid")),
+	m_taskGraph(ConfigManager::inst()->value(
+			"audioengine", "taskgraph", "1").toInt()),
+	m_workerThreads(ConfigManager::inst()->value(
+			"audioengine", "workerthreads").toInt()),
+	m_workerCores(ConfigManager::inst()->value(
+			"audioengine", "workercores")),
+	m_workerRtPriority(ConfigManager::inst()->value(
+			"audioengine", "workerrtpriority").toInt()),
+	m_xrunLog(ConfigManager::inst()->value(
+			"audioengine", "xrunlog").toInt()),
+	m_maxVoices(ConfigManager::inst()->value(
+			"audioengine", "maxvoices").toInt()),
+	m_qualityGovernor(ConfigManager::inst()->value(
+			"audioengine", "qualitygovernor").toInt()),
+	m_hugePages(ConfigManager::inst()->value(
+			"audioengine", "hugepages").toInt()),
+	m_lockMemory(ConfigManager::inst()->value(
+			"audioengine", "lockmemory").toInt()),
 	m_workingDir(QDir::toNativeSeparators(ConfigManager::inst()->workingDir())),
 	m_vstDir(QDir::toNativeSeparators(ConfigManager::inst()->vstDir())),
 	m_ladspaDir(QDir::toNativeSeparators(ConfigManager::inst()->ladspaDir())),
@@ -450,6 +478,14 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 	addCheckBox(tr("Keep effects running even without input"), pluginsBox, pluginsLayout,
 		m_disableAutoQuit, SLOT(toggleDisableAutoQuit(bool)), false);
 
+	addCheckBox(tr("Run VST and ZynAddSubFX plugins alongside LMMS (adds a period of latency)"), pluginsBox,
+		pluginsLayout, m_pipelinedRemotePlugins, SLOT(togglePipelinedRemotePlugins(bool)), true);
+
+#ifndef LMMS_BUILD_WIN32
+	addCheckBox(tr("Run all VST plugins in one process (a crashing plugin takes the others with it)"), pluginsBox,
+		pluginsLayout, m_sharedVstProcess, SLOT(toggleSharedVstProcess(bool)), true);
+#endif
+
 
 	// Performance layout ordering.
 	performance_layout->addWidget(autoSaveBox);
@@ -496,6 +532,11 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 			new AudioPulseAudio::setupWidget(as_w);
 #endif
 
+#ifdef LMMS_HAVE_PIPEWIRE
+	m_audioIfaceSetupWidgets[AudioPipeWire::name()] =
+			new AudioPipeWire::setupWidget(as_w);
+#endif
+
 #ifdef LMMS_HAVE_PORTAUDIO
 	m_audioIfaceSetupWidgets[AudioPortAudio::name()] =
 			new AudioPortAudio::setupWidget(as_w);
@@ -570,7 +611,7 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 	QHBoxLayout * bufferSizeSubLayout = new QHBoxLayout();
 
 	m_bufferSizeSlider = new QSlider(Qt::Horizontal, bufferSizeBox);
-	m_bufferSizeSlider->setRange(1, 128);
+	m_bufferSizeSlider->setRange(1, MAXIMUM_BUFFER_SIZE / BUFFERSIZE_RESOLUTION);
 	m_bufferSizeSlider->setTickInterval(8);
 	m_bufferSizeSlider->setPageStep(8);
 	m_bufferSizeSlider->setValue(m_bufferSize / BUFFERSIZE_RESOLUTION);
@@ -578,8 +619,6 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 
 	connect(m_bufferSizeSlider, SIGNAL(valueChanged(int)),
 			this, SLOT(setBufferSize(int)));
-	connect(m_bufferSizeSlider, SIGNAL(valueChanged(int)),
-			this, SLOT(showRestartWarning()));
 	bufferSizeSubLayout->addWidget(m_bufferSizeSlider, 1);
 
 	auto bufferSize_reset_btn = new QPushButton(embed::getIconPixmap("reload"), "", bufferSizeBox);
@@ -601,12 +640,114 @@ SetupDialog::SetupDialog(ConfigTab tab_to_open) :
 
 	setBufferSize(m_bufferSizeSlider->value());
 
+	// Polyphony group
+	QGroupBox * polyphonyBox = new QGroupBox(tr("Polyphony"), audio_w);
+	QVBoxLayout * polyphonyLayout = new QVBoxLayout(polyphonyBox);
+
+	auto maxVoicesLbl = new QLabel(tr("Most notes of all tracks playing at once, "
+		"the oldest ones are released to make room for more:"), polyphonyBox);
+	maxVoicesLbl->setWordWrap(true);
+	polyphonyLayout->addWidget(maxVoicesLbl);
+
+	auto maxVoicesSpinBox = new QSpinBox(polyphonyBox);
+	maxVoicesSpinBox->setRange(0, 4096);
+	maxVoicesSpinBox->setSpecialValueText(tr("Unlimited"));
+	maxVoicesSpinBox->setValue(m_maxVoices);
+	connect(maxVoicesSpinBox, SIGNAL(valueChanged(int)),
+			this, SLOT(setMaxVoices(int)));
+	polyphonyLayout->addWidget(maxVoicesSpinBox);
+
+	// Worker threads group
+	QGroupBox * workerThreadsBox = new QGroupBox(tr("Worker threads"), audio_w);
+	QVBoxLayout * workerThreadsLayout = new QVBoxLayout(workerThreadsBox);
+
+	auto workerWaitPolicyLbl = new QLabel(tr("Waiting for audio jobs:"), workerThreadsBox);
+	workerThreadsLayout->addWidget(workerWaitPolicyLbl);
+
+	m_workerWaitPolicyComboBox = new QComboBox(workerThreadsBox);
+	m_workerWaitPolicyComboBox->addItem(tr("Busy-wait (lowest latency, highest CPU usage)"), "spin");
+	m_workerWaitPolicyComboBox->addItem(tr("Busy-wait briefly, then sleep"), "hybrid");
+	m_workerWaitPolicyComboBox->addItem(tr("Sleep (lowest CPU usage)"), "park");
+	m_workerWaitPolicyComboBox->setCurrentIndex(
+		std::max(0, m_workerWaitPolicyComboBox->findData(m_workerWaitPolicy)));
+	connect(m_workerWaitPolicyComboBox, SIGNAL(currentIndexChanged(int)),
+			this, SLOT(workerWaitPolicyChanged()));
+	workerThreadsLayout->addWidget(m_workerWaitPolicyComboBox);
+
+	addCheckBox(tr("Process instruments, effects and mixer channels as one task graph"),
+		workerThreadsBox, workerThreadsLayout, m_taskGraph, SLOT(toggleTaskGraph(bool)), true);
+
+	auto workerThreadsLbl = new QLabel(tr("Number of threads processing audio:"), workerThreadsBox);
+	workerThreadsLayout->addWidget(workerThreadsLbl);
+
+	auto workerThreadsSpinBox = new QSpinBox(workerThreadsBox);
+	workerThreadsSpinBox->setRange(0, 64);
+	workerThreadsSpinBox->setSpecialValueText(tr("Automatic"));
+	workerThreadsSpinBox->setValue(m_workerThreads);
+	connect(workerThreadsSpinBox, SIGNAL(valueChanged(int)),
+			this, SLOT(setWorkerThreads(int)));
+	connect(workerThreadsSpinBox, SIGNAL(valueChanged(int)),
+			this, SLOT(showRestartWarning()));
+	workerThreadsLayout->addWidget(workerThreadsSpinBox);
+
+#ifdef LMMS_BUILD_LINUX
+	auto workerCoresLbl = new QLabel(tr("CPU cores to run audio threads on (e.g. 2-5,7):"), workerThreadsBox);
+	workerThreadsLayout->addWidget(workerCoresLbl);
+
+	auto workerCoresLineEdit = new QLineEdit(m_workerCores, workerThreadsBox);
+	workerCoresLineEdit->setPlaceholderText(tr("All cores"));
+	connect(workerCoresLineEdit, SIGNAL(textChanged(const QString&)),
+			this, SLOT(setWorkerCores(const QString&)));
+	connect(workerCoresLineEdit, SIGNAL(textChanged(const QString&)),
+			this, SLOT(showRestartWarning()));
+	workerThreadsLayout->addWidget(workerCoresLineEdit);
+#endif
+
+#if defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)
+	auto workerRtPriorityLbl = new QLabel(tr("Realtime priority of audio threads:"), workerThreadsBox);
+	workerThreadsLayout->addWidget(workerRtPriorityLbl);
+
+	auto workerRtPrioritySpinBox = new QSpinBox(workerThreadsBox);
+	workerRtPrioritySpinBox->setRange(0, 99);
+	workerRtPrioritySpinBox->setSpecialValueText(tr("Default"));
+	workerRtPrioritySpinBox->setValue(m_workerRtPriority);
+	connect(workerRtPrioritySpinBox, SIGNAL(valueChanged(int)),
+			this, SLOT(setWorkerRtPriority(int)));
+	connect(workerRtPrioritySpinBox, SIGNAL(valueChanged(int)),
+			this, SLOT(showRestartWarning()));
+	workerThreadsLayout->addWidget(workerRtPrioritySpinBox);
+#endif
+
+	addCheckBox(tr("Log the periods around missed deadlines to xruns.log in the working directory"),
+		workerThreadsBox, workerThreadsLayout, m_xrunLog, SLOT(toggleXrunLog(bool)), true);
+
+	addCheckBox(tr("Lower the quality step by step while the CPU can't keep up, and log every step"),
+		workerThreadsBox, workerThreadsLayout, m_qualityGovernor, SLOT(toggleQualityGovernor(bool)), false);
+
+#ifndef LMMS_BUILD_WIN32
+	// Memory group
+	QGroupBox * memoryBox = new QGroupBox(tr("Memory"), audio_w);
+	QVBoxLayout * memoryLayout = new QVBoxLayout(memoryBox);
+
+#ifdef LMMS_BUILD_LINUX
+	addCheckBox(tr("Keep samples and plugin audio buffers in huge pages"),
+		memoryBox, memoryLayout, m_hugePages, SLOT(toggleHugePages(bool)), true);
+#endif
+	addCheckBox(tr("Lock samples and plugin audio buffers in memory, so they aren't swapped out "
+		"(limited by the locked memory limit of the system)"),
+		memoryBox, memoryLayout, m_lockMemory, SLOT(toggleLockMemory(bool)), true);
+#endif
 
 	// Audio layout ordering.
 	audio_layout->addWidget(audioInterfaceBox);
 	audio_layout->addWidget(as_w);
 	audio_layout->addWidget(hqaudio);
 	audio_layout->addWidget(bufferSizeBox);
+	audio_layout->addWidget(polyphonyBox);
+	audio_layout->addWidget(workerThreadsBox);
+#ifndef LMMS_BUILD_WIN32
+	audio_layout->addWidget(memoryBox);
+#endif
 	audio_layout->addStretch();
 
 
@@ -954,6 +1095,10 @@ void SetupDialog::accept()
 					QString::number(m_vstAlwaysOnTop));
 	ConfigManager::inst()->setValue("ui", "disableautoquit",
 					QString::number(m_disableAutoQuit));
+	ConfigManager::inst()->setValue("audioengine", "pipelinedremoteplugins",
+					QString::number(m_pipelinedRemotePlugins));
+	ConfigManager::inst()->setValue("audioengine", "sharedvstprocess",
+					QString::number(m_sharedVstProcess));
 	ConfigManager::inst()->setValue("audioengine", "audiodev",
 					m_audioIfaceNames[m_audioInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("app", "nanhandler",
@@ -962,6 +1107,33 @@ void SetupDialog::accept()
 					QString::number(m_hqAudioDev));
 	ConfigManager::inst()->setValue("audioengine", "framesperaudiobuffer",
 					QString::number(m_bufferSize));
+	ConfigManager::inst()->setValue("audioengine", "workerwaitpolicy",
+					m_workerWaitPolicy);
+	ConfigManager::inst()->setValue("audioengine", "taskgraph",
+					QString::number(m_taskGraph));
+	ConfigManager::inst()->setValue("audioengine", "workerthreads",
+					QString::number(m_workerThreads));
+	ConfigManager::inst()->setValue("audioengine", "workercores",
+					m_workerCores.trimmed());
+	ConfigManager::inst()->setValue("audioengine", "workerrtpriority",
+					QString::number(m_workerRtPriority));
+	ConfigManager::inst()->setValue("audioengine", "xrunlog",
+					QString::number(m_xrunLog));
+	ConfigManager::inst()->setValue("audioengine", "maxvoices",
+					QString::number(m_maxVoices));
+	ConfigManager::inst()->setValue("audioengine", "qualitygovernor",
+					QString::number(m_qualityGovernor));
+	ConfigManager::inst()->setValue("audioengine", "hugepages",
+					QString::number(m_hugePages));
+	ConfigManager::inst()->setValue("audioengine", "lockmemory",
+					QString::number(m_lockMemory));
+	// the wait policy, the voice limit, the quality governor and the
+	// buffering in the FIFO can be changed while the engine is running
+	AudioEngineWorkerThread::setWaitPolicy(
+		AudioEngineWorkerThread::waitPolicyFromName(m_workerWaitPolicy));
+	NotePlayHandleManager::setVoiceLimit(m_maxVoices);
+	Engine::audioEngine()->qualityGovernor().setEnabled(m_qualityGovernor);
+	Engine::audioEngine()->setFramesPerAudioBuffer(m_bufferSize);
 	ConfigManager::inst()->setValue("audioengine", "mididev",
 					m_midiIfaceNames[m_midiInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("midi", "midiautoassign",
@@ -1162,6 +1334,18 @@ void SetupDialog::toggleDisableAutoQuit(bool enabled)
 }
 
 
+void SetupDialog::togglePipelinedRemotePlugins(bool enabled)
+{
+	m_pipelinedRemotePlugins = enabled;
+}
+
+
+void SetupDialog::toggleSharedVstProcess(bool enabled)
+{
+	m_sharedVstProcess = enabled;
+}
+
+
 
 
 // Audio settings slots.
@@ -1232,6 +1416,13 @@ void SetupDialog::setBufferSize(int value)
 	m_bufferSizeLbl->setText(tr("Frames: %1\nLatency: %2 ms").arg(m_bufferSize).arg(
 		1000.0f * m_bufferSize / Engine::audioEngine()->processingSampleRate(), 0, 'f', 1));
 	updateBufferSizeWarning(m_bufferSize);
+
+	// more or less buffering in the FIFO is applied right away, only another
+	// period takes a restart
+	if (AudioEngine::splitBufferSize(m_bufferSize).first != Engine::audioEngine()->framesPerPeriod())
+	{
+		showRestartWarning();
+	}
 }
 
 
@@ -1241,6 +1432,66 @@ void SetupDialog::resetBufferSize()
 }
 
 
+void SetupDialog::workerWaitPolicyChanged()
+{
+	m_workerWaitPolicy = m_workerWaitPolicyComboBox->currentData().toString();
+}
+
+
+void SetupDialog::toggleTaskGraph(bool enabled)
+{
+	m_taskGraph = enabled;
+}
+
+
+void SetupDialog::setWorkerThreads(int value)
+{
+	m_workerThreads = value;
+}
+
+
+void SetupDialog::setWorkerCores(const QString & cores)
+{
+	m_workerCores = cores;
+}
+
+
+void SetupDialog::setWorkerRtPriority(int value)
+{
+	m_workerRtPriority = value;
+}
+
+
+void SetupDialog::toggleXrunLog(bool enabled)
+{
+	m_xrunLog = enabled;
+}
+
+
+void SetupDialog::setMaxVoices(int value)
+{
+	m_maxVoices = value;
+}
+
+
+void SetupDialog::toggleQualityGovernor(bool enabled)
+{
+	m_qualityGovernor = enabled;
+}
+
+
+void SetupDialog::toggleHugePages(bool enabled)
+{
+	m_hugePages = enabled;
+}
+
+
+void SetupDialog::toggleLockMemory(bool enabled)
+{
+	m_lockMemory = enabled;
+}
+
+
 // MIDI settings slots.
 
 void SetupDialog::midiInterfaceChanged(const QString & iface)
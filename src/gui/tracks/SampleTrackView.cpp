@@ -98,9 +98,6 @@ SampleTrackView::SampleTrackView( SampleTrack * _t, TrackContainerView* tcv ) :
 	connect(_t, SIGNAL(playingChanged()), this, SLOT(updateIndicator()));
 
 	setModel( _t );
-
-	m_window = new SampleTrackWindow(this);
-	m_window->toggleVisibility(false);
 }
 
 
@@ -165,9 +162,23 @@ QMenu * SampleTrackView::createMixerMenu(QString title, QString newMixerLabel)
 
 
 
+SampleTrackWindow * SampleTrackView::getSampleTrackWindow()
+{
+	if (!m_window)
+	{
+		m_window = new SampleTrackWindow(this);
+	}
+
+	return m_window;
+}
+
+
+
+
 void SampleTrackView::showEffects()
 {
-	m_window->toggleVisibility(m_window->parentWidget()->isHidden());
+	SampleTrackWindow * window = getSampleTrackWindow();
+	window->toggleVisibility(window->parentWidget()->isHidden());
 }
 
 
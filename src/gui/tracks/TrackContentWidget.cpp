@@ -136,13 +136,9 @@ void TrackContentWidget::updateBackground()
  */
 void TrackContentWidget::addClipView( ClipView * clipv )
 {
-	Clip * clip = clipv->getClip();
-
 	m_clipViews.push_back( clipv );
 
-	clip->saveJournallingState( false );
 	changePosition();
-	clip->restoreJournallingState();
 }
 
 
@@ -233,8 +229,6 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 	{
 		Clip* clip = clipView->getClip();
 
-		clip->changeLength( clip->length() );
-
 		const int ts = clip->startPosition();
 		const int te = clip->endPosition()-3;
 		if( ( ts >= begin && ts <= end ) ||
@@ -247,10 +241,17 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 				clipView->show();
 			}
 		}
-		else
+		else if (clipView == mouseGrabber())
 		{
+			// hiding the clip being dragged would end the drag
 			clipView->move(-clipView->width() - 10, clipView->y());
 		}
+		else if (clipView->isVisible())
+		{
+			// hidden views aren't painted, and a long arrangement has
+			// a lot more clips outside the view than in it
+			clipView->hide();
+		}
 	}
 	setUpdatesEnabled( true );
 
@@ -317,12 +318,11 @@ bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QDropEvent* d
 // Overloaded method to make it possible to call this method without a Drag&Drop event
 bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QMimeData* md , bool allowSameBar )
 {
-	// For decodeKey() and decodeValue()
+	// For decodeKey() and decodeDataFile()
 	using namespace Clipboard;
 
 	Track * t = getTrack();
 	QString type = decodeKey( md );
-	QString value = decodeValue( md );
 
 	// We can only paste into tracks of the same type
 	if (type != ("clip_" + QString::number(static_cast<int>(t->type()))))
@@ -330,8 +330,8 @@ bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QMimeData* md
 		return false;
 	}
 
-	// value contains XML needed to reconstruct Clips and place them
-	DataFile dataFile( value.toUtf8() );
+	// the value has what's needed to reconstruct Clips and place them
+	DataFile dataFile = decodeDataFile( md );
 
 	// Extract the metadata and which Clip was grabbed
 	QDomElement metadata = dataFile.content().firstChildElement( "copyMetadata" );
@@ -414,7 +414,7 @@ bool TrackContentWidget::pasteSelection( TimePos clipPos, QDropEvent * de )
 // Overloaded method so we can call it without a Drag&Drop event
 bool TrackContentWidget::pasteSelection( TimePos clipPos, const QMimeData * md, bool skipSafetyCheck )
 {
-	// For decodeKey() and decodeValue()
+	// For decodeDataFile()
 	using namespace Clipboard;
 
 	// When canPasteSelection was already called before, skipSafetyCheck will skip this
@@ -423,13 +423,10 @@ bool TrackContentWidget::pasteSelection( TimePos clipPos, const QMimeData * md,
 		return false;
 	}
 
-	QString type = decodeKey( md );
-	QString value = decodeValue( md );
-
 	getTrack()->addJournalCheckPoint();
 
-	// value contains XML needed to reconstruct Clips and place them
-	DataFile dataFile( value.toUtf8() );
+	// the value has what's needed to reconstruct Clips and place them
+	DataFile dataFile = decodeDataFile( md );
 
 	// Extract the clip data
 	QDomElement clipParent = dataFile.content().firstChildElement("clips");
@@ -28,9 +28,12 @@
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QCheckBox>
 
+#include "AudioDevice.h"
+#include "AudioEngine.h"
 #include "AutomationClip.h"
 #include "AutomationTrackView.h"
 #include "ColorChooser.h"
@@ -41,10 +44,12 @@
 #include "gui_templates.h"
 #include "InstrumentTrackView.h"
 #include "PixmapButton.h"
+#include "SampleTrack.h"
 #include "Song.h"
 #include "StringPairDrag.h"
 #include "Track.h"
 #include "TrackContainerView.h"
+#include "TrackFreezer.h"
 #include "TrackView.h"
 
 namespace lmms::gui
@@ -333,11 +338,28 @@ void TrackOperationsWidget::updateMenu()
 		toMenu->addMenu(mixerMenu);
 	}
 
+	// only tracks in the song editor can be frozen, as that's what gets rendered
+	const TrackFreezer* freezer = m_trackView->getTrack()->freezer();
+	if (freezer && m_trackView->getTrack()->trackContainer() == Engine::getSong())
+	{
+		toMenu->addAction(freezer->isFrozen() ? tr("Unfreeze this track") : tr("Freeze this track"),
+						this, SLOT(toggleFreeze()));
+	}
+
 	if (auto trackView = dynamic_cast<InstrumentTrackView*>(m_trackView))
 	{
 		toMenu->addSeparator();
 		toMenu->addMenu(trackView->midiMenu());
 	}
+	if (auto sampleTrack = dynamic_cast<SampleTrack*>(m_trackView->getTrack()))
+	{
+		BoolModel* monitor = sampleTrack->monitorModel();
+		QAction* monitorAction = toMenu->addAction(tr("Monitor input"));
+		monitorAction->setCheckable(true);
+		monitorAction->setChecked(monitor->value());
+		monitorAction->setEnabled(monitor->value() || Engine::audioEngine()->audioDev()->supportsCapture());
+		connect(monitorAction, &QAction::toggled, [monitor](bool on) { monitor->setValue(on); });
+	}
 	if( dynamic_cast<AutomationTrackView *>( m_trackView ) )
 	{
 		toMenu->addAction( tr( "Turn all recording on" ), this, SLOT(recordingOn()));
@@ -356,6 +378,32 @@ void TrackOperationsWidget::updateMenu()
 }
 
 
+void TrackOperationsWidget::toggleFreeze()
+{
+	TrackFreezer* freezer = m_trackView->getTrack()->freezer();
+	if (freezer->isFrozen())
+	{
+		freezer->unfreeze();
+		return;
+	}
+
+	auto progress = new QProgressDialog(tr("Freezing track \"%1\"...").arg(m_trackView->getTrack()->name()),
+						tr("Cancel"), 0, 100, this);
+	progress->setWindowModality(Qt::WindowModal);
+	connect(freezer, SIGNAL(progressChanged(int)), progress, SLOT(setValue(int)));
+	connect(freezer, SIGNAL(frozenChanged()), progress, SLOT(deleteLater()));
+	connect(progress, SIGNAL(canceled()), freezer, SLOT(abortFreezing()));
+	connect(progress, SIGNAL(canceled()), progress, SLOT(deleteLater()));
+	progress->show();
+
+	freezer->freeze();
+	if (!freezer->isFreezing())
+	{
+		delete progress;
+	}
+}
+
+
 void TrackOperationsWidget::toggleRecording( bool on )
 {
 	auto atv = dynamic_cast<AutomationTrackView*>(m_trackView);
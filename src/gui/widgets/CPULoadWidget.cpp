@@ -99,11 +99,15 @@ void CPULoadWidget::updateCpuLoad()
 	if (new_load != m_currentLoad)
 	{
 		auto engine = Engine::audioEngine();
+		const QString processing = engine->usesTaskGraph()
+			? tr(" - Instruments, effects and mixer: %1%").arg(
+				engine->detailLoad(AudioEngineProfiler::DetailType::TaskGraph)) + "\n"
+			: tr(" - Instruments: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Instruments)) + "\n"
+				+ tr(" - Effects: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Effects)) + "\n";
 		setToolTip(
 			tr("DSP total: %1%").arg(new_load) + "\n"
 			+ tr(" - Notes and setup: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::NoteSetup)) + "\n"
-			+ tr(" - Instruments: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Instruments)) + "\n"
-			+ tr(" - Effects: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Effects)) + "\n"
+			+ processing
 			+ tr(" - Mixing: %1%").arg(engine->detailLoad(AudioEngineProfiler::DetailType::Mixing))
 		);
 		m_currentLoad = new_load;
@@ -453,7 +453,7 @@ void FloatModelEditorBase::doConnections()
 {
 	if (model() != nullptr)
 	{
-		QObject::connect(model(), SIGNAL(dataChanged()),
+		QObject::connect(model(), SIGNAL(displayChanged()),
 					this, SLOT(friendlyUpdate()));
 
 		QObject::connect(model(), SIGNAL(propertiesChanged()),
@@ -25,6 +25,7 @@
 
 #include <QMouseEvent>
 #include <QPainter>
+#include <algorithm>
 
 #include "Oscilloscope.h"
 #include "GuiApplication.h"
@@ -35,6 +36,7 @@
 #include "Song.h"
 #include "embed.h"
 #include "BufferManager.h"
+#include "LocklessRingBuffer.h"
 
 namespace lmms::gui
 {
@@ -73,12 +75,22 @@ Oscilloscope::~Oscilloscope()
 
 
 
-void Oscilloscope::updateAudioBuffer( const surroundSampleFrame * buffer )
+void Oscilloscope::readAudioBuffer()
 {
-	if( !Engine::getSong()->isExporting() )
+	if (!m_reader) { return; }
+
+	const auto fpp = static_cast<std::size_t>(Engine::audioEngine()->framesPerPeriod());
+	while (!m_reader->empty())
 	{
-		const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
-		memcpy( m_buffer, buffer, sizeof( surroundSampleFrame ) * fpp );
+		const auto frames = m_reader->read_max(m_reader->read_space());
+		const auto count = std::min(frames.size(), fpp);
+		// shift the frames we have to make room for the newer ones
+		std::copy(m_buffer + count, m_buffer + fpp, m_buffer);
+		for (std::size_t frame = 0; frame < count; ++frame)
+		{
+			const auto& newFrame = frames[frames.size() - count + frame];
+			m_buffer[fpp - count + frame] = {newFrame[0], newFrame[1]};
+		}
 	}
 }
 
@@ -93,18 +105,17 @@ void Oscilloscope::setActive( bool _active )
 		connect( getGUI()->mainWindow(),
 					SIGNAL(periodicUpdate()),
 					this, SLOT(update()));
-		connect( Engine::audioEngine(),
-			SIGNAL(nextAudioBuffer(const lmms::surroundSampleFrame*)),
-			this, SLOT(updateAudioBuffer(const lmms::surroundSampleFrame*)) );
+		if (auto tap = Engine::audioEngine()->outputTap())
+		{
+			m_reader = std::make_unique<LocklessRingBufferReader<surroundSampleFrame>>(*tap);
+		}
 	}
 	else
 	{
 		disconnect( getGUI()->mainWindow(),
 					SIGNAL(periodicUpdate()),
 					this, SLOT(update()));
-		disconnect( Engine::audioEngine(),
-			SIGNAL( nextAudioBuffer( const lmms::surroundSampleFrame* ) ),
-			this, SLOT( updateAudioBuffer( const lmms::surroundSampleFrame* ) ) );
+		m_reader.reset();
 		// we have to update (remove last waves),
 		// because timer doesn't do that anymore
 		update();
@@ -141,6 +152,8 @@ void Oscilloscope::paintEvent( QPaintEvent * )
 
 	if( m_active && !Engine::getSong()->isExporting() )
 	{
+		readAudioBuffer();
+
 		AudioEngine const * audioEngine = Engine::audioEngine();
 
 		float master_output = audioEngine->masterGain();
@@ -23,6 +23,8 @@
  */
 #include "InstrumentTrack.h"
 
+#include <algorithm>
+
 #include "AudioEngine.h"
 #include "AutomationClip.h"
 #include "ConfigManager.h"
@@ -32,6 +34,7 @@
 #include "Mixer.h"
 #include "InstrumentTrackView.h"
 #include "Instrument.h"
+#include "InstrumentPlayHandle.h"
 #include "Keymap.h"
 #include "MidiClient.h"
 #include "MidiClip.h"
@@ -41,6 +44,7 @@
 #include "PianoRoll.h"
 #include "Pitch.h"
 #include "Song.h"
+#include "TrackFreezer.h"
 
 namespace lmms
 {
@@ -55,6 +59,7 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_sustainPedalPressed( false ),
 	m_silentBuffersProcessed( false ),
 	m_previewMode( false ),
+	m_instrumentPlaysItself( false ),
 	m_baseNoteModel(0, 0, NumKeys - 1, this, tr("Base note")),
 	m_firstKeyModel(0, 0, NumKeys - 1, this, tr("First note")),
 	m_lastKeyModel(0, 0, NumKeys - 1, this, tr("Last note")),
@@ -62,10 +67,15 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_volumeModel( DefaultVolume, MinVolume, MaxVolume, 0.1f, this, tr( "Volume" ) ),
 	m_panningModel( DefaultPanning, PanningLeft, PanningRight, 0.1f, this, tr( "Panning" ) ),
 	m_audioPort( tr( "unnamed_track" ), true, &m_volumeModel, &m_panningModel, &m_mutedModel ),
+	m_freezer( std::make_unique<TrackFreezer>( this, &m_audioPort ) ),
 	m_pitchModel( 0, MinPitchDefault, MaxPitchDefault, 1, this, tr( "Pitch" ) ),
 	m_pitchRangeModel( 1, 1, 60, this, tr( "Pitch range" ) ),
 	m_mixerChannelModel( 0, 0, 0, this, tr( "Mixer channel" ) ),
 	m_useMasterPitchModel( true, this, tr( "Master pitch") ),
+	m_polyphonyEnabledModel( false, this, tr( "Limit polyphony" ) ),
+	m_polyphonyModel( 32, 1, 256, this, tr( "Polyphony" ) ),
+	m_voiceStealingModel( this, tr( "Voice stealing" ) ),
+	m_voices( 0 ),
 	m_instrument( nullptr ),
 	m_soundShaping( this ),
 	m_arpeggio( this ),
@@ -80,6 +90,10 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_firstKeyModel.setInitValue(0);
 	m_lastKeyModel.setInitValue(NumKeys - 1);
 
+	m_voiceStealingModel.addItem( tr( "Oldest note" ) );
+	m_voiceStealingModel.addItem( tr( "Quietest note" ) );
+	m_voiceStealingModel.addItem( tr( "Same key" ) );
+
 	m_mixerChannelModel.setRange( 0, Engine::mixer()->numChannels()-1, 1);
 
 	for( int i = 0; i < NumKeys; ++i )
@@ -203,6 +217,8 @@ float InstrumentTrack::baseFreq() const
 
 InstrumentTrack::~InstrumentTrack()
 {
+	m_freezer.reset();
+
 	// De-assign midi device
 	if (m_hasAutoMidiDev)
 	{
@@ -215,6 +231,7 @@ InstrumentTrack::~InstrumentTrack()
 
 	// now we're save deleting the instrument
 	if( m_instrument ) delete m_instrument;
+	for (const auto& warm : m_warmInstruments) { delete warm.instrument; }
 }
 
 
@@ -267,6 +284,7 @@ void InstrumentTrack::processAudioBuffer( sampleFrame* buf, const fpp_t frames,
 	{
 		const f_cnt_t offset = n->noteOffset();
 		m_soundShaping.processAudioBuffer( buf + offset, frames - offset, n );
+		n->applyStealFade( buf + offset, frames - offset );
 		const float vol = ( (float) n->getVolume() * DefaultVolumeRatio );
 		const panning_t pan = std::clamp(n->getPanning(), PanningLeft, PanningRight);
 		StereoVolumeVector vv = panningToVolumeVector( pan, vol );
@@ -277,6 +295,21 @@ void InstrumentTrack::processAudioBuffer( sampleFrame* buf, const fpp_t frames,
 				buf[f][c] *= vv.vol[c];
 			}
 		}
+
+		// a release that faded out doesn't need to be played to its end.
+		// When the envelope and the volume alone make it inaudible, the buffer
+		// doesn't have to be looked at.
+		if( n->isReleaseStarted() )
+		{
+			float peak = 0.0f;
+			if( n->envelopeGain() * std::max( vv.vol[0], vv.vol[1] ) >= NotePlayHandle::InaudibleLevel )
+			{
+				MixHelpers::Measurement measurement;
+				MixHelpers::measure( buf + offset, frames - offset, measurement );
+				peak = std::max( measurement.peaks[0], measurement.peaks[1] );
+			}
+			n->checkAudibility( peak, frames - offset );
+		}
 	}
 }
 
@@ -545,6 +578,15 @@ void InstrumentTrack::silenceAllNotes( bool removeIPH )
 	{
 		flags |= PlayHandle::Type::InstrumentPlayHandle;
 	}
+	if (removeIPH && m_previewMode)
+	{
+		// the instrument may be kept warm, see replaceInstrument()
+		const PlayHandleList& playHandles = Engine::audioEngine()->playHandles();
+		m_instrumentPlaysItself = std::any_of(playHandles.begin(), playHandles.end(), [this](const PlayHandle* ph)
+		{
+			return ph->type() == PlayHandle::Type::InstrumentPlayHandle && ph->isFromTrack(this);
+		});
+	}
 	Engine::audioEngine()->removePlayHandlesOfTypes( this, flags );
 	Engine::audioEngine()->doneChangeInModel();
 }
@@ -598,6 +640,29 @@ void InstrumentTrack::playNote( NotePlayHandle* n, sampleFrame* workingBuffer )
 
 
 
+void InstrumentTrack::playNotes( NotePlayHandle * const * notes, std::size_t count, sampleFrame * workingBuffer )
+{
+	auto playing = PeriodAllocator<NotePlayHandle*>::vector();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		m_noteStacking.processNote( notes[i] );
+		m_arpeggio.processNote( notes[i] );
+
+		if (notes[i]->isMasterNote() == false)
+		{
+			playing.push_back(notes[i]);
+		}
+	}
+
+	if (m_instrument != nullptr && !playing.empty())
+	{
+		m_instrument->playNotes(playing.data(), playing.size(), workingBuffer);
+	}
+}
+
+
+
+
 QString InstrumentTrack::instrumentName() const
 {
 	if( m_instrument != nullptr )
@@ -701,13 +766,19 @@ void InstrumentTrack::removeMidiPortNode( DataFile & _dataFile )
 bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 							const f_cnt_t _offset, int _clip_num )
 {
+	// frozen tracks play their cache instead of notes in the song editor
+	if( m_freezer->isFrozen() && _clip_num < 0 )
+	{
+		return m_freezer->play( _start, _offset );
+	}
+
 	if( ! m_instrument || ! tryLock() )
 	{
 		return false;
 	}
 	const float frames_per_tick = Engine::framesPerTick();
 
-	clipVector clips;
+	periodClipVector clips;
 	class PatternTrack * pattern_track = nullptr;
 	if( _clip_num >= 0 )
 	{
@@ -727,8 +798,8 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 	// Handle automation: detuning
 	for (const auto& processHandle : m_processHandles)
 	{
-		processHandle->processTimePos(
-			_start, m_pitchModel.value(), gui::getGUI() && gui::getGUI()->pianoRoll()->isRecording());
+		processHandle->processTimePos(_start, _offset, m_pitchModel.value(),
+			gui::getGUI() && gui::getGUI()->pianoRoll()->isRecording());
 	}
 
 	if ( clips.size() == 0 )
@@ -756,21 +827,14 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 
 		// get all notes from the given clip...
 		const NoteVector & notes = c->notes();
-		// ...and set our index to zero
-		auto nit = notes.begin();
 
-		// very effective algorithm for playing notes that are
-		// posated within the current sample-frame
-
-
-		if( cur_start > 0 )
-		{
-			// skip notes which are posated before start-bar
-			while( nit != notes.end() && ( *nit )->pos() < cur_start )
-			{
-				++nit;
-			}
-		}
+		// ...and skip those before the current tick. They are sorted by
+		// position, so this takes a binary search rather than a look at
+		// every note before, which adds up in long clips
+		auto nit = cur_start > 0
+			? std::lower_bound(notes.begin(), notes.end(), cur_start,
+				[](const Note* note, const TimePos& pos) { return note->pos() < pos; })
+			: notes.begin();
 
 		Note * cur_note;
 		while( nit != notes.end() &&
@@ -804,6 +868,39 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 
 
 
+int InstrumentTrack::prefetch( const TimePos & start, const TimePos & end )
+{
+	if( m_freezer->isFrozen() || isMuted() )
+	{
+		return 0;
+	}
+
+	periodClipVector clips;
+	getClipsInRange( clips, start, end );
+
+	int notes = 0;
+	for( const auto clip : clips )
+	{
+		const auto c = dynamic_cast<MidiClip*>( clip );
+		if( c == nullptr || c->isMuted() )
+		{
+			continue;
+		}
+
+		const NoteVector & clipNotes = c->notes();
+		const auto byPos = []( const Note* note, const TimePos& pos ) { return note->pos() < pos; };
+		const auto first = std::lower_bound( clipNotes.begin(), clipNotes.end(),
+							TimePos( start - c->startPosition() ), byPos );
+		const auto last = std::lower_bound( first, clipNotes.end(),
+							TimePos( end - c->startPosition() ), byPos );
+		notes += static_cast<int>( last - first );
+	}
+	return notes;
+}
+
+
+
+
 Clip* InstrumentTrack::createClip(const TimePos & pos)
 {
 	auto p = new MidiClip(this);
@@ -834,6 +931,9 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 	m_firstKeyModel.saveSettings(doc, thisElement, "firstkey");
 	m_lastKeyModel.saveSettings(doc, thisElement, "lastkey");
 	m_useMasterPitchModel.saveSettings( doc, thisElement, "usemasterpitch");
+	m_polyphonyEnabledModel.saveSettings( doc, thisElement, "limitpolyphony" );
+	m_polyphonyModel.saveSettings( doc, thisElement, "polyphony" );
+	m_voiceStealingModel.saveSettings( doc, thisElement, "voicestealing" );
 	m_microtuner.saveSettings(doc, thisElement);
 
 	// Save MIDI CC stuff
@@ -901,6 +1001,9 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	m_firstKeyModel.loadSettings(thisElement, "firstkey");
 	m_lastKeyModel.loadSettings(thisElement, "lastkey");
 	m_useMasterPitchModel.loadSettings( thisElement, "usemasterpitch");
+	m_polyphonyEnabledModel.loadSettings( thisElement, "limitpolyphony" );
+	m_polyphonyModel.loadSettings( thisElement, "polyphony" );
+	m_voiceStealingModel.loadSettings( thisElement, "voicestealing" );
 	m_microtuner.loadSettings(thisElement);
 
 	// clear effect-chain just in case we load an old preset without FX-data
@@ -946,10 +1049,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				}
 				else
 				{
-					delete m_instrument;
-					m_instrument = nullptr;
-					m_instrument = Instrument::instantiate(
-						node.toElement().attribute("name"), this, &key);
+					replaceInstrument(node.toElement().attribute("name"), &key);
 					m_instrument->restoreState(node.firstChildElement());
 					emit instrumentChanged();
 				}
@@ -968,10 +1068,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 					ControllerConnection::classNodeName() != node.nodeName() &&
 					!node.toElement().hasAttribute( "id" ))
 			{
-				delete m_instrument;
-				m_instrument = nullptr;
-				m_instrument = Instrument::instantiate(
-					node.nodeName(), this, nullptr, true);
+				replaceInstrument(node.nodeName(), nullptr, true);
 				if (m_instrument->nodeName() == node.nodeName())
 				{
 					m_instrument->restoreState(node.toElement());
@@ -1048,9 +1145,7 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 	silenceAllNotes( true );
 
 	lock();
-	delete m_instrument;
-	m_instrument = Instrument::instantiate(_plugin_name, this,
-					key, keyFromDnd);
+	replaceInstrument(_plugin_name, key, keyFromDnd);
 	unlock();
 	setName(m_instrument->displayName());
 
@@ -1061,6 +1156,54 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 
 
 
+
+Instrument* InstrumentTrack::replaceInstrument(const QString& pluginName,
+	const Plugin::Descriptor::SubPluginFeatures::Key* key, bool keyFromDnd)
+{
+	// browsing presets switches between a few plugins, which may take long to
+	// load, or start a process of their own
+	if (m_previewMode && m_instrument)
+	{
+		m_warmInstruments.push_back({m_instrument, m_instrumentPlaysItself});
+		if (m_warmInstruments.size() > MaxWarmInstruments)
+		{
+			delete m_warmInstruments.front().instrument;
+			m_warmInstruments.erase(m_warmInstruments.begin());
+		}
+	}
+	else
+	{
+		delete m_instrument;
+	}
+	m_instrument = nullptr;
+
+	if (m_previewMode && !keyFromDnd)
+	{
+		const auto attributes = key ? key->attributes : Plugin::Descriptor::SubPluginFeatures::Key::AttributeMap{};
+		const auto warm = std::find_if(m_warmInstruments.rbegin(), m_warmInstruments.rend(),
+			[&](const WarmInstrument& w)
+		{
+			return w.instrument->nodeName() == pluginName && w.instrument->key().attributes == attributes;
+		});
+		if (warm != m_warmInstruments.rend())
+		{
+			m_instrument = warm->instrument;
+			const bool playsItself = warm->playsItself;
+			m_warmInstruments.erase(std::next(warm).base());
+			if (playsItself)
+			{
+				Engine::audioEngine()->addPlayHandle(new InstrumentPlayHandle(m_instrument, this));
+			}
+			return m_instrument;
+		}
+	}
+
+	m_instrument = Instrument::instantiate(pluginName, this, key, keyFromDnd);
+	return m_instrument;
+}
+
+
+
 InstrumentTrack *InstrumentTrack::s_autoAssignedTrack = nullptr;
 
 /*! \brief Automatically assign a midi controller to this track, based on the midiautoassign setting
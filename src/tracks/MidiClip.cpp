@@ -208,6 +208,36 @@ Note * MidiClip::addNote( const Note & _new_note, const bool _quant_pos )
 
 
 
+void MidiClip::addNotes( const std::vector<Note> & notes )
+{
+	if( notes.empty() )
+	{
+		return;
+	}
+
+	NoteVector added;
+	added.reserve( notes.size() );
+	for( const Note & note : notes )
+	{
+		added.push_back( new Note( note ) );
+	}
+	std::stable_sort( added.begin(), added.end(), Note::lessThan );
+
+	instrumentTrack()->lock();
+	const auto oldSize = m_notes.size();
+	m_notes.insert( m_notes.end(), added.begin(), added.end() );
+	std::inplace_merge( m_notes.begin(), m_notes.begin() + oldSize, m_notes.end(), Note::lessThan );
+	instrumentTrack()->unlock();
+
+	checkType();
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
 void MidiClip::removeNote( Note * _note_to_del )
 {
 	instrumentTrack()->lock();
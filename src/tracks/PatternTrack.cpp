@@ -38,6 +38,7 @@ namespace lmms
 
 
 PatternTrack::infoMap PatternTrack::s_infoMap;
+std::vector<PatternTrack*> PatternTrack::s_patternTracks;
 
 
 PatternTrack::PatternTrack(TrackContainer* tc) :
@@ -45,6 +46,7 @@ PatternTrack::PatternTrack(TrackContainer* tc) :
 {
 	int patternNum = s_infoMap.size();
 	s_infoMap[this] = patternNum;
+	s_patternTracks.push_back(this);
 
 	setName(tr("Pattern %1").arg(patternNum));
 	Engine::patternStore()->createClipsForPattern(patternNum);
@@ -76,6 +78,7 @@ PatternTrack::~PatternTrack()
 		}
 	}
 	s_infoMap.remove( this );
+	s_patternTracks.erase(s_patternTracks.begin() + pattern);
 
 	// remove us from the Song and update the pattern selection combobox to reflect the change
 	trackContainer()->removeTrack( this );
@@ -99,7 +102,7 @@ bool PatternTrack::play( const TimePos & _start, const fpp_t _frames,
 		return Engine::patternStore()->play(_start, _frames, _offset, s_infoMap[this]);
 	}
 
-	clipVector clips;
+	periodClipVector clips;
 	getClipsInRange( clips, _start, _start + static_cast<int>( _frames / Engine::framesPerTick() ) );
 
 	if( clips.size() == 0 )
@@ -221,15 +224,7 @@ void PatternTrack::loadTrackSpecificSettings(const QDomElement& _this)
 // return pointer to PatternTrack specified by pattern_num
 PatternTrack* PatternTrack::findPatternTrack(int pattern_num)
 {
-	for( infoMap::iterator it = s_infoMap.begin(); it != s_infoMap.end();
-									++it )
-	{
-		if (it.value() == pattern_num)
-		{
-			return it.key();
-		}
-	}
-	return nullptr;
+	return pattern_num >= 0 && pattern_num < numOfPatternTracks() ? s_patternTracks[pattern_num] : nullptr;
 }
 
 
@@ -242,6 +237,7 @@ void PatternTrack::swapPatternTracks(Track* track1, Track* track2)
 	if( t1 != nullptr && t2 != nullptr )
 	{
 		qSwap( s_infoMap[t1], s_infoMap[t2] );
+		std::swap(s_patternTracks[s_infoMap[t1]], s_patternTracks[s_infoMap[t2]]);
 		Engine::patternStore()->swapPattern(s_infoMap[t1], s_infoMap[t2]);
 		Engine::patternStore()->setCurrentPattern(s_infoMap[t1]);
 	}
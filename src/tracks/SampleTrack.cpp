@@ -37,6 +37,7 @@
 #include "SampleRecordHandle.h"
 #include "SampleTrackView.h"
 #include "Song.h"
+#include "TrackFreezer.h"
 #include "volume.h"
 
 
@@ -49,7 +50,9 @@ SampleTrack::SampleTrack(TrackContainer* tc) :
 	m_volumeModel(DefaultVolume, MinVolume, MaxVolume, 0.1f, this, tr("Volume")),
 	m_panningModel(DefaultPanning, PanningLeft, PanningRight, 0.1f, this, tr("Panning")),
 	m_mixerChannelModel(0, 0, 0, this, tr("Mixer channel")),
+	m_monitorModel(false, this, tr("Monitor input")),
 	m_audioPort(tr("Sample track"), true, &m_volumeModel, &m_panningModel, &m_mutedModel),
+	m_freezer(std::make_unique<TrackFreezer>(this, &m_audioPort)),
 	m_isPlaying(false)
 {
 	setName(tr("Sample track"));
@@ -57,6 +60,12 @@ SampleTrack::SampleTrack(TrackContainer* tc) :
 	m_mixerChannelModel.setRange(0, Engine::mixer()->numChannels()-1, 1);
 
 	connect(&m_mixerChannelModel, SIGNAL(dataChanged()), this, SLOT(updateMixerChannel()));
+	connect(&m_monitorModel, &BoolModel::dataChanged, this,
+		[this]{ m_audioPort.setMonitorInput(m_monitorModel.value()); }, Qt::DirectConnection);
+
+	// once for all clips of the track instead of once by each of them
+	connect(Engine::getSong(), &Song::playbackStateChanged, this, &SampleTrack::updateClips, Qt::DirectConnection);
+	connect(Engine::getSong(), &Song::updateSampleTracks, this, &SampleTrack::updateClips, Qt::DirectConnection);
 }
 
 
@@ -64,6 +73,7 @@ SampleTrack::SampleTrack(TrackContainer* tc) :
 
 SampleTrack::~SampleTrack()
 {
+	m_freezer.reset();
 	Engine::audioEngine()->removePlayHandlesOfTypes( this, PlayHandle::Type::SamplePlayHandle );
 }
 
@@ -73,6 +83,12 @@ SampleTrack::~SampleTrack()
 bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 					const f_cnt_t _offset, int _clip_num )
 {
+	// frozen tracks play their cache instead of the clips in the song editor
+	if( m_freezer->isFrozen() && _clip_num < 0 )
+	{
+		return m_freezer->play( _start, _offset );
+	}
+
 	m_audioPort.effects()->startRunning();
 	bool played_a_note = false; // will be return variable
 
@@ -133,6 +149,7 @@ bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 			nowPlaying = nowPlaying || sClip->isPlaying();
 		}
 		setPlaying(nowPlaying);
+		armLoopStart(_start);
 	}
 
 	for (const auto& clip : clips)
@@ -152,7 +169,8 @@ bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 			}
 			else
 			{
-				auto smpHandle = new SamplePlayHandle(st);
+				auto smpHandle = st->takeArmedPlayHandle();
+				if (!smpHandle) { smpHandle = new SamplePlayHandle(st); }
 				smpHandle->setVolumeModel( &m_volumeModel );
 				smpHandle->setPatternTrack(pattern_track);
 				handle = smpHandle;
@@ -170,6 +188,33 @@ bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 
 
 
+int SampleTrack::prefetch( const TimePos & start, const TimePos & end )
+{
+	if( isMuted() )
+	{
+		return 0;
+	}
+
+	periodClipVector clips;
+	getClipsInRange( clips, start, end );
+	for( const auto clip : clips )
+	{
+		auto sClip = static_cast<SampleClip*>( clip );
+
+		// a streamed sample may start beyond what it keeps in memory, so
+		// it's read from where the clip starts playing it
+		if( sClip->startPosition() >= start && !sClip->isPlaying() && !sClip->isMuted() )
+		{
+			auto bufferFramesPerTick = Engine::framesPerTick(sClip->sample().sampleRate());
+			sClip->sample().prefetch( bufferFramesPerTick * std::max( -static_cast<int>( sClip->startTimeOffset() ), 0 ) );
+		}
+	}
+	return 0;
+}
+
+
+
+
 gui::TrackView * SampleTrack::createView( gui::TrackContainerView* tcv )
 {
 	return new gui::SampleTrackView( this, tcv );
@@ -227,6 +272,29 @@ void SampleTrack::loadTrackSpecificSettings( const QDomElement & _this )
 
 
 
+void SampleTrack::armLoopStart(const TimePos& start)
+{
+	const Song* song = Engine::getSong();
+	const auto& timeline = song->getTimeline(Song::PlayMode::Song);
+	if (!timeline.loopEnabled() || song->isExporting() || start != timeline.loopEnd() - 1) { return; }
+
+	// the clips playing at the loop start get their handle a tick before the
+	// loop wraps, so restarting them there only takes adding it
+	const auto loopBegin = timeline.loopBegin();
+	for (int i = 0; i < numOfClips(); ++i)
+	{
+		auto sClip = static_cast<SampleClip*>(getClip(i));
+		if (!sClip->isMuted() && !sClip->isRecord() && !sClip->hasArmedPlayHandle()
+			&& loopBegin >= sClip->startPosition() + sClip->startTimeOffset() && loopBegin < sClip->endPosition())
+		{
+			sClip->armPlayHandle(new SamplePlayHandle(sClip));
+		}
+	}
+}
+
+
+
+
 void SampleTrack::updateClips()
 {
 	Engine::audioEngine()->removePlayHandlesOfTypes( this, PlayHandle::Type::SamplePlayHandle );
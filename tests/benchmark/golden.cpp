@@ -0,0 +1,227 @@
+/*
+ * golden.cpp - render the stems of a song and compare them with reference renders
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "golden.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QRegExp>
+
+#include "AudioEngine.h"
+#include "AudioFileWave.h"
+#include "AudioPort.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "PatternStore.h"
+#include "SampleDecoder.h"
+#include "SampleTrack.h"
+#include "Song.h"
+#include "TrackFreezer.h"
+#include "lmms_math.h"
+
+namespace lmms::bench
+{
+
+namespace
+{
+
+auto createWaveFile(const QString& path) -> std::unique_ptr<AudioFileDevice>
+{
+	AudioEngine* audioEngine = Engine::audioEngine();
+	const auto settings = OutputSettings{audioEngine->processingSampleRate(),
+		OutputSettings::BitRateSettings{160, false}, OutputSettings::BitDepth::Depth32Bit};
+
+	bool successful = false;
+	auto file = std::unique_ptr<AudioFileDevice>(
+		AudioFileWave::getInst(path, settings, DEFAULT_CHANNELS, audioEngine, successful));
+	if (!successful)
+	{
+		fprintf(stderr, "Could not write %s\n", qPrintable(path));
+		exit(EXIT_FAILURE);
+	}
+	return file;
+}
+
+
+struct StemDifference
+{
+	QString stem;
+	f_cnt_t firstFrame;
+	float peak;
+	int sampleRate;
+};
+
+
+//! The first frame where @p rendered differs from @p reference by more than
+//! @p tolerance and by how much at most, -1 if nowhere
+auto compareStem(const QString& reference, const QString& rendered, float tolerance) -> StemDifference
+{
+	const auto stem = QFileInfo(reference).fileName();
+	const auto expected = SampleDecoder::decode(reference);
+	const auto actual = QFileInfo::exists(rendered) ? SampleDecoder::decode(rendered) : std::nullopt;
+	if (!expected || !actual)
+	{
+		// a stem that's missing on either side differs from the start
+		return {stem, 0, 1.0f, expected ? expected->sampleRate : 0};
+	}
+
+	const auto& a = expected->data;
+	const auto& b = actual->data;
+	const auto length = std::min(a.size(), b.size());
+	auto result = StemDifference{stem, -1, 0.0f, expected->sampleRate};
+	for (std::size_t frame = 0; frame < length; ++frame)
+	{
+		for (int channel = 0; channel < DEFAULT_CHANNELS; ++channel)
+		{
+			const float difference = std::abs(a[frame][channel] - b[frame][channel]);
+			// written so that NaNs differ as well
+			if (!(difference <= tolerance))
+			{
+				if (result.firstFrame < 0) { result.firstFrame = static_cast<f_cnt_t>(frame); }
+				result.peak = std::isfinite(difference) ? std::max(result.peak, difference) : 1.0f;
+			}
+		}
+	}
+	if (a.size() != b.size() && result.firstFrame < 0)
+	{
+		result.firstFrame = static_cast<f_cnt_t>(length);
+		result.peak = 1.0f;
+	}
+	return result;
+}
+
+} // namespace
+
+
+StemWriter::StemWriter(const QString& directory)
+{
+	QDir().mkpath(directory);
+	const auto dir = QDir{directory};
+	for (const auto& old : dir.entryList({"*.wav"}, QDir::Files)) { QFile::remove(dir.filePath(old)); }
+
+	std::vector<Track*> tracks;
+	const auto addUnmuted = [&tracks](const TrackContainer::TrackList& list)
+	{
+		for (const auto& track : list)
+		{
+			const auto type = track->type();
+			if (!track->isMuted() && (type == Track::Type::Instrument || type == Track::Type::Sample))
+			{
+				tracks.push_back(track);
+			}
+		}
+	};
+	addUnmuted(Engine::getSong()->tracks());
+	addUnmuted(Engine::patternStore()->tracks());
+
+	for (std::size_t i = 0; i < tracks.size(); ++i)
+	{
+		Track* track = tracks[i];
+		AudioPort* port = track->type() == Track::Type::Instrument
+			? static_cast<InstrumentTrack*>(track)->audioPort()
+			: static_cast<SampleTrack*>(track)->audioPort();
+		if (track->freezer() && track->freezer()->audioPort()) { port = track->freezer()->audioPort(); }
+
+		auto name = track->name();
+		name = QString{"%1_%2.wav"}.arg(i + 1).arg(name.remove(QRegExp(FILENAME_FILTER)));
+		auto file = createWaveFile(dir.filePath(name));
+		port->setStemFile(file.get());
+		m_stems.push_back(Stem{port, std::move(file)});
+	}
+
+	m_master = createWaveFile(dir.filePath("0_master.wav"));
+}
+
+
+
+
+StemWriter::~StemWriter()
+{
+	for (const auto& stem : m_stems) { stem.port->setStemFile(nullptr); }
+}
+
+
+
+
+void StemWriter::writeMaster(const surroundSampleFrame* frames, fpp_t count)
+{
+	m_master->writeFrames(frames, count);
+}
+
+
+
+
+auto compareStems(const QString& reference, const QString& rendered, float tolerance) -> QJsonObject
+{
+	const auto referenceDir = QDir{reference};
+	const auto renderedDir = QDir{rendered};
+
+	auto stems = referenceDir.entryList({"*.wav"}, QDir::Files);
+	if (stems.isEmpty())
+	{
+		fprintf(stderr, "No reference renders in %s, record them with --record first\n", qPrintable(reference));
+	}
+	// stems that weren't there when the references were recorded differ too
+	for (const auto& stem : renderedDir.entryList({"*.wav"}, QDir::Files))
+	{
+		if (!stems.contains(stem)) { stems << stem; }
+	}
+
+	std::vector<StemDifference> differences;
+	for (const auto& stem : stems)
+	{
+		auto difference = compareStem(referenceDir.filePath(stem), renderedDir.filePath(stem), tolerance);
+		if (difference.firstFrame >= 0) { differences.push_back(difference); }
+	}
+	std::sort(differences.begin(), differences.end(),
+		[](const StemDifference& a, const StemDifference& b) { return a.firstFrame < b.firstFrame; });
+
+	QJsonArray differing;
+	for (const auto& difference : differences)
+	{
+		QJsonObject stem;
+		stem["stem"] = difference.stem;
+		stem["firstFrame"] = static_cast<double>(difference.firstFrame);
+		if (difference.sampleRate > 0)
+		{
+			stem["firstSecond"] = static_cast<double>(difference.firstFrame) / difference.sampleRate;
+		}
+		stem["peakDifferenceDb"] = ampToDbfs(difference.peak);
+		differing.append(stem);
+	}
+
+	QJsonObject result;
+	result["stems"] = stems.size();
+	result["matches"] = !stems.isEmpty() && differences.empty();
+	result["differing"] = differing;
+	if (!differing.isEmpty()) { result["firstDivergence"] = differing.first(); }
+	return result;
+}
+
+} // namespace lmms::bench
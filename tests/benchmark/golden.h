@@ -0,0 +1,83 @@
+/*
+ * golden.h - render the stems of a song and compare them with reference renders
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LMMS_BENCH_GOLDEN_H
+#define LMMS_BENCH_GOLDEN_H
+
+#include <memory>
+#include <vector>
+
+#include <QJsonObject>
+#include <QString>
+
+#include "lmms_basics.h"
+
+namespace lmms
+{
+
+class AudioFileDevice;
+class AudioPort;
+
+namespace bench
+{
+
+/**
+ * Writes what the master and every unmuted instrument and sample track render
+ * to a WAV file each, like RenderManager::renderTracks() does, but as 32-bit
+ * float so the comparison sees every bit. The files are named after the track
+ * and its position, the master is 0_master.wav.
+ */
+class StemWriter
+{
+public:
+	//! Creates @p directory and the files of the song loaded right now in it
+	explicit StemWriter(const QString& directory);
+	//! Detaches the files from the tracks and closes them
+	~StemWriter();
+
+	void writeMaster(const surroundSampleFrame* frames, fpp_t count);
+
+private:
+	struct Stem
+	{
+		AudioPort* port;
+		std::unique_ptr<AudioFileDevice> file;
+	};
+
+	std::unique_ptr<AudioFileDevice> m_master;
+	std::vector<Stem> m_stems;
+};
+
+
+//! Compares every stem in @p reference with the one of the same name in
+//! @p rendered. They match if no sample differs by more than @p tolerance,
+//! which is bit-exact for 0. Reports the stems that don't, ordered by the
+//! first frame that differs, and the earliest of them as "firstDivergence".
+auto compareStems(const QString& reference, const QString& rendered, float tolerance) -> QJsonObject;
+
+} // namespace bench
+
+} // namespace lmms
+
+#endif // LMMS_BENCH_GOLDEN_H
@@ -0,0 +1,418 @@
+/*
+ * kernels.cpp - time the inner DSP loops at different buffer sizes
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Usage: lmms-microbench [--json] [--filter <text>] [--min-time <seconds>]
+//
+// Every kernel is run for each buffer size until at least --min-time has
+// passed, the result is the time per frame.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+#include "AudioEngine.h"
+#include "AudioResampler.h"
+#include "BasicFilters.h"
+#include "Engine.h"
+#include "MixHelpers.h"
+#include "Oscillator.h"
+#include "Sample.h"
+#include "ValueBuffer.h"
+
+using namespace lmms;
+
+namespace
+{
+
+constexpr int BufferSizes[] = {32, 64, 128, 256, 512, 1024, 2048};
+constexpr int MaxBufferSize = 2048;
+
+double s_minTime = 0.1;
+QString s_filter;
+bool s_json = false;
+QJsonArray s_results;
+
+
+//! Run @p kernel, which processes @p frames frames per call, until enough
+//! time has passed
+void benchmark(const QString& name, int frames, const std::function<void()>& kernel)
+{
+	const QString fullName = QString("%1/%2").arg(name).arg(frames);
+	if (!s_filter.isEmpty() && !fullName.contains(s_filter)) { return; }
+
+	using clock = std::chrono::steady_clock;
+	kernel(); // warm up caches and lazily initialised state
+
+	std::size_t iterations = 0;
+	double elapsed = 0;
+	const auto start = clock::now();
+	for (std::size_t batch = 1; elapsed < s_minTime; batch *= 2)
+	{
+		for (std::size_t i = 0; i < batch; ++i) { kernel(); }
+		iterations += batch;
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	}
+
+	const double nsPerFrame = elapsed * 1e9 / (static_cast<double>(iterations) * frames);
+	if (s_json)
+	{
+		QJsonObject result;
+		result["name"] = name;
+		result["frames"] = frames;
+		result["iterations"] = static_cast<double>(iterations);
+		result["nsPerFrame"] = nsPerFrame;
+		s_results.append(result);
+	}
+	else
+	{
+		printf("%-60s %12zu %10.3f ns/frame\n", qPrintable(fullName), iterations, nsPerFrame);
+	}
+}
+
+
+//! Audio-like, not silent input
+void fillBuffer(sampleFrame* buf, int frames)
+{
+	for (int f = 0; f < frames; ++f)
+	{
+		buf[f][0] = 0.5f * std::sin(f * 0.05f);
+		buf[f][1] = 0.5f * std::cos(f * 0.03f);
+	}
+}
+
+
+void benchmarkMixHelpers()
+{
+	std::vector<sampleFrame> dst(MaxBufferSize);
+	std::vector<sampleFrame> src(MaxBufferSize);
+	std::vector<sample_t> srcLeft(MaxBufferSize);
+	std::vector<sample_t> srcRight(MaxBufferSize);
+	fillBuffer(src.data(), MaxBufferSize);
+	for (int f = 0; f < MaxBufferSize; ++f)
+	{
+		srcLeft[f] = src[f][0];
+		srcRight[f] = src[f][1];
+	}
+	ValueBuffer coeffs1(MaxBufferSize);
+	ValueBuffer coeffs2(MaxBufferSize);
+	coeffs1.interpolate(0.f, 1.f);
+	coeffs2.interpolate(1.f, 0.f);
+	// in percent, like the volume and panning models
+	ValueBuffer volume(MaxBufferSize);
+	ValueBuffer panning(MaxBufferSize);
+	volume.fill(90.f);
+	panning.interpolate(-50.f, 50.f);
+
+	// keep the destination from growing out of the normal range
+	const auto reset = [&] { fillBuffer(dst.data(), MaxBufferSize); };
+
+	for (const int frames : BufferSizes)
+	{
+		reset();
+		benchmark("MixHelpers::isSilent", frames, [&] { MixHelpers::isSilent(dst.data(), frames); });
+		benchmark("MixHelpers::sanitize", frames, [&] { MixHelpers::sanitize(dst.data(), frames); });
+		benchmark("MixHelpers::add", frames, [&] { MixHelpers::add(dst.data(), src.data(), frames); });
+		reset();
+		benchmark("MixHelpers::addMultiplied", frames, [&] {
+			MixHelpers::addMultiplied(dst.data(), src.data(), 0.5f, frames); });
+		reset();
+		benchmark("MixHelpers::addSwappedMultiplied", frames, [&] {
+			MixHelpers::addSwappedMultiplied(dst.data(), src.data(), 0.5f, frames); });
+		reset();
+		benchmark("MixHelpers::addMultipliedByBuffer", frames, [&] {
+			MixHelpers::addMultipliedByBuffer(dst.data(), src.data(), 0.5f, &coeffs1, frames); });
+		reset();
+		benchmark("MixHelpers::addMultipliedByBuffers", frames, [&] {
+			MixHelpers::addMultipliedByBuffers(dst.data(), src.data(), &coeffs1, &coeffs2, frames); });
+		reset();
+		benchmark("MixHelpers::addSanitizedMultiplied", frames, [&] {
+			MixHelpers::addSanitizedMultiplied(dst.data(), src.data(), 0.5f, frames); });
+		reset();
+		benchmark("MixHelpers::addSanitizedMultipliedByBuffer", frames, [&] {
+			MixHelpers::addSanitizedMultipliedByBuffer(dst.data(), src.data(), 0.5f, &coeffs1, frames); });
+		reset();
+		benchmark("MixHelpers::addSanitizedMultipliedByBuffers", frames, [&] {
+			MixHelpers::addSanitizedMultipliedByBuffers(dst.data(), src.data(), &coeffs1, &coeffs2, frames); });
+		reset();
+		benchmark("MixHelpers::addMultipliedStereo", frames, [&] {
+			MixHelpers::addMultipliedStereo(dst.data(), src.data(), 0.5f, 0.25f, frames); });
+		reset();
+		benchmark("MixHelpers::multiplyAndAddMultiplied", frames, [&] {
+			MixHelpers::multiplyAndAddMultiplied(dst.data(), src.data(), 0.5f, 0.5f, frames); });
+		reset();
+		benchmark("MixHelpers::multiplyAndAddMultipliedJoined", frames, [&] {
+			MixHelpers::multiplyAndAddMultipliedJoined(dst.data(), srcLeft.data(), srcRight.data(), 0.5f, 0.5f, frames); });
+		reset();
+		benchmark("MixHelpers::copyWithGain", frames, [&] {
+			MixHelpers::copyWithGain(dst.data(), src.data(), {nullptr, 80.f, nullptr, -20.f}, frames); });
+		// volume and panning automated, as on a track
+		reset();
+		benchmark("MixHelpers::addWithGain", frames, [&] {
+			MixHelpers::addWithGain(dst.data(), src.data(), {&volume, 100.f, &panning, 0.f}, frames); });
+	}
+}
+
+
+const char* waveShapeName(Oscillator::WaveShape shape)
+{
+	switch (shape)
+	{
+		case Oscillator::WaveShape::Sine: return "Sine";
+		case Oscillator::WaveShape::Triangle: return "Triangle";
+		case Oscillator::WaveShape::Saw: return "Saw";
+		case Oscillator::WaveShape::Square: return "Square";
+		case Oscillator::WaveShape::MoogSaw: return "MoogSaw";
+		case Oscillator::WaveShape::Exponential: return "Exponential";
+		case Oscillator::WaveShape::WhiteNoise: return "WhiteNoise";
+		default: return "UserDefined";
+	}
+}
+
+
+const char* modulationAlgoName(Oscillator::ModulationAlgo algo)
+{
+	switch (algo)
+	{
+		case Oscillator::ModulationAlgo::PhaseModulation: return "PhaseModulation";
+		case Oscillator::ModulationAlgo::AmplitudeModulation: return "AmplitudeModulation";
+		case Oscillator::ModulationAlgo::SignalMix: return "SignalMix";
+		case Oscillator::ModulationAlgo::SynchronizedBySubOsc: return "SynchronizedBySubOsc";
+		default: return "FrequencyModulation";
+	}
+}
+
+
+void benchmarkOscillator()
+{
+	std::vector<sampleFrame> buf(MaxBufferSize);
+	const float freq = 440.f;
+	const float detuning = 0.f;
+	const float phaseOffset = 0.f;
+	const float volume = 1.f;
+
+	// user defined waves need a sample, which isn't worth it here
+	for (std::size_t shapeIndex = 0; shapeIndex < Oscillator::NumWaveShapes; ++shapeIndex)
+	{
+		const auto shape = static_cast<Oscillator::WaveShape>(shapeIndex);
+		if (shape == Oscillator::WaveShape::UserDefined) { continue; }
+
+		for (const bool useWaveTable : {false, true})
+		{
+			IntModel shapeModel(static_cast<int>(shape), 0, static_cast<int>(Oscillator::NumWaveShapes) - 1);
+			IntModel algoModel(0, 0, static_cast<int>(Oscillator::NumModulationAlgos) - 1);
+			Oscillator osc(&shapeModel, &algoModel, freq, detuning, phaseOffset, volume);
+			osc.setUseWaveTable(useWaveTable);
+
+			const QString name = QString("Oscillator::update/%1%2")
+				.arg(waveShapeName(shape)).arg(useWaveTable ? "/WaveTable" : "");
+			for (const int frames : BufferSizes)
+			{
+				benchmark(name, frames, [&] {
+					osc.update(buf.data(), frames, 0);
+					osc.update(buf.data(), frames, 1);
+				});
+			}
+		}
+	}
+
+	// modulation of a saw by a sine sub oscillator
+	for (std::size_t algoIndex = 0; algoIndex < Oscillator::NumModulationAlgos; ++algoIndex)
+	{
+		const auto algo = static_cast<Oscillator::ModulationAlgo>(algoIndex);
+		IntModel shapeModel(static_cast<int>(Oscillator::WaveShape::Saw), 0, static_cast<int>(Oscillator::NumWaveShapes) - 1);
+		IntModel subShapeModel(static_cast<int>(Oscillator::WaveShape::Sine), 0, static_cast<int>(Oscillator::NumWaveShapes) - 1);
+		IntModel algoModel(static_cast<int>(algo), 0, static_cast<int>(Oscillator::NumModulationAlgos) - 1);
+		IntModel subAlgoModel(0, 0, static_cast<int>(Oscillator::NumModulationAlgos) - 1);
+		const float subFreq = freq * 1.5f;
+		auto subOsc = new Oscillator(&subShapeModel, &subAlgoModel, subFreq, detuning, phaseOffset, volume);
+		Oscillator osc(&shapeModel, &algoModel, freq, detuning, phaseOffset, volume, subOsc);
+
+		const QString name = QString("Oscillator::update/Saw/%1").arg(modulationAlgoName(algo));
+		for (const int frames : BufferSizes)
+		{
+			benchmark(name, frames, [&] {
+				osc.update(buf.data(), frames, 0);
+				osc.update(buf.data(), frames, 1);
+			});
+		}
+	}
+}
+
+
+void benchmarkFilters()
+{
+	using Filter = BasicFilters<2>;
+	const char* filterNames[] = {
+		"LowPass", "HiPass", "BandPass_CSG", "BandPass_CZPG", "Notch", "AllPass", "Moog", "DoubleLowPass",
+		"Lowpass_RC12", "Bandpass_RC12", "Highpass_RC12", "Lowpass_RC24", "Bandpass_RC24", "Highpass_RC24",
+		"Formantfilter", "DoubleMoog", "Lowpass_SV", "Bandpass_SV", "Highpass_SV", "Notch_SV", "FastFormant",
+		"Tripole"
+	};
+
+	std::vector<sampleFrame> buf(MaxBufferSize);
+	fillBuffer(buf.data(), MaxBufferSize);
+	const auto sampleRate = Engine::audioEngine()->processingSampleRate();
+
+	for (std::size_t type = 0; type < std::size(filterNames); ++type)
+	{
+		Filter filter(sampleRate);
+		filter.setFilterType(static_cast<Filter::FilterType>(type));
+		filter.calcFilterCoeffs(1000.f, 0.5f);
+
+		const QString name = QString("BasicFilters::update/%1").arg(filterNames[type]);
+		for (const int frames : BufferSizes)
+		{
+			benchmark(name, frames, [&] {
+				for (int f = 0; f < frames; ++f)
+				{
+					buf[f][0] = filter.update(buf[f][0], 0);
+					buf[f][1] = filter.update(buf[f][1], 1);
+				}
+			});
+			fillBuffer(buf.data(), MaxBufferSize);
+		}
+	}
+
+	// the coefficients are recalculated every frame when the cutoff is automated
+	for (const int frames : BufferSizes)
+	{
+		Filter filter(sampleRate);
+		filter.setFilterType(Filter::FilterType::LowPass);
+		benchmark("BasicFilters::calcFilterCoeffs", frames, [&] {
+			for (int f = 0; f < frames; ++f)
+			{
+				filter.calcFilterCoeffs(200.f + f, 0.5f);
+			}
+		});
+	}
+}
+
+
+struct InterpolationMode
+{
+	int mode;
+	const char* name;
+};
+
+constexpr InterpolationMode InterpolationModes[] = {
+	{SRC_ZERO_ORDER_HOLD, "ZeroOrderHold"},
+	{SRC_LINEAR, "Linear"},
+	{SRC_SINC_FASTEST, "SincFastest"},
+	{SRC_SINC_MEDIUM_QUALITY, "SincMedium"},
+	{SRC_SINC_BEST_QUALITY, "SincBest"}
+};
+
+
+void benchmarkSample()
+{
+	// a few seconds, looped, played a fifth higher so it has to be resampled
+	std::vector<sampleFrame> data(5 * 44100);
+	fillBuffer(data.data(), static_cast<int>(data.size()));
+	Sample sample(data.data(), static_cast<int>(data.size()), 44100);
+	std::vector<sampleFrame> buf(MaxBufferSize);
+
+	for (const auto& [mode, modeName] : InterpolationModes)
+	{
+		for (const int frames : BufferSizes)
+		{
+			Sample::PlaybackState state(false, mode);
+			benchmark(QString("Sample::play/%1").arg(modeName), frames, [&] {
+				sample.play(buf.data(), &state, frames, DefaultBaseFreq * 1.5f, Sample::Loop::On);
+			});
+		}
+	}
+}
+
+
+void benchmarkResampler()
+{
+	constexpr double ratio = 44100.0 / 48000.0;
+	std::vector<sampleFrame> in(MaxBufferSize * 2);
+	std::vector<sampleFrame> out(MaxBufferSize);
+	fillBuffer(in.data(), static_cast<int>(in.size()));
+
+	for (const auto& [mode, modeName] : InterpolationModes)
+	{
+		for (const int frames : BufferSizes)
+		{
+			AudioResampler resampler(mode, DEFAULT_CHANNELS);
+			const long inputFrames = static_cast<long>(std::ceil(frames / ratio)) + 1;
+			benchmark(QString("AudioResampler::resample/%1").arg(modeName), frames, [&] {
+				resampler.resample(&in[0][0], inputFrames, &out[0][0], frames, ratio);
+			});
+		}
+	}
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	new QCoreApplication(argc, argv);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const QString arg = argv[i];
+		if (arg == "--json") { s_json = true; }
+		else if (arg == "--filter" && i + 1 < argc) { s_filter = argv[++i]; }
+		else if (arg == "--min-time" && i + 1 < argc) { s_minTime = QString(argv[++i]).toDouble(); }
+		else
+		{
+			fprintf(stderr, "Usage: %s [--json] [--filter <text>] [--min-time <seconds>]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	Engine::init(true);
+
+	if (!s_json) { printf("MixHelpers use %s\n", MixHelpers::instructionSet()); }
+	benchmarkMixHelpers();
+	benchmarkOscillator();
+	benchmarkFilters();
+	benchmarkSample();
+	benchmarkResampler();
+
+	if (s_json)
+	{
+		QJsonObject report;
+		report["sampleRate"] = static_cast<int>(Engine::audioEngine()->processingSampleRate());
+		report["mixInstructionSet"] = MixHelpers::instructionSet();
+		report["benchmarks"] = s_results;
+		printf("%s\n", QJsonDocument(report).toJson().constData());
+	}
+
+	Engine::destroy();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,390 @@
+/*
+ * main.cpp - render stress projects offline and report how fast that was
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+// Usage: lmms-bench [--repeat <n>] [--record <dir> | --compare <dir> [--tolerance <dB>]]
+//                   [project files...]
+//
+// Without project files, a set of built-in stress projects is generated and
+// rendered. The results are printed to stdout as JSON.
+//
+// With --record, every project is rendered once more before it's timed, and
+// the master and the stem of every track are written to <dir>/<project>. A
+// later --compare renders them again and checks them against those, so a
+// change that should only make rendering faster can be shown to not change
+// the output: bit-exactly, or with --tolerance, as long as no sample differs
+// by more than that many dBFS. It reports the first frame and stem that
+// differ, and exits with a failure if any do. The references only hold for
+// the settings they were recorded with, e.g. the number of worker threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
+#include "AutomationClip.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "MidiClip.h"
+#include "MixHelpers.h"
+#include "Mixer.h"
+#include "NotePlayHandle.h"
+#include "SampleBuffer.h"
+#include "SampleClip.h"
+#include "SampleTrack.h"
+#include "Song.h"
+#include "golden.h"
+#include "lmms_math.h"
+
+using namespace lmms;
+
+namespace
+{
+
+constexpr int SongBars = 16;
+
+
+InstrumentTrack* createTripleOscillatorTrack()
+{
+	auto track = dynamic_cast<InstrumentTrack*>(Track::create(Track::Type::Instrument, Engine::getSong()));
+	track->loadInstrument("tripleoscillator");
+	if (track->instrumentName() != "tripleoscillator")
+	{
+		fprintf(stderr, "Could not load TripleOscillator, is LMMS_PLUGIN_DIR set?\n");
+		exit(EXIT_FAILURE);
+	}
+	return track;
+}
+
+
+//! Chords of @p voices notes on every 16th note of the whole song
+void addChords(InstrumentTrack* track, int voices)
+{
+	auto clip = dynamic_cast<MidiClip*>(track->createClip(TimePos(0)));
+	const tick_t step = TimePos::ticksPerBar() / 16;
+	for (tick_t pos = 0; pos < SongBars * TimePos::ticksPerBar(); pos += step)
+	{
+		for (int voice = 0; voice < voices; ++voice)
+		{
+			clip->addNote(Note(TimePos(step * 2), TimePos(pos), 48 + voice * 4 + (pos / step) % 12), false);
+		}
+	}
+}
+
+
+void createNotesProject()
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		addChords(createTripleOscillatorTrack(), 8);
+	}
+}
+
+
+void createRoutingProject()
+{
+	// a chain of channels each sending to the previous one, and a track
+	// sending to every one of them
+	Mixer* mixer = Engine::mixer();
+	for (int i = 1; i <= 32; ++i)
+	{
+		const int channel = mixer->createChannel();
+		if (channel > 1)
+		{
+			mixer->deleteChannelSend(channel, 0);
+			mixer->createChannelSend(channel, channel - 1);
+		}
+
+		InstrumentTrack* track = createTripleOscillatorTrack();
+		track->mixerChannelModel()->setValue(channel);
+		addChords(track, 1);
+	}
+}
+
+
+void createAutomationProject()
+{
+	Song* song = Engine::getSong();
+	for (int i = 0; i < 8; ++i)
+	{
+		InstrumentTrack* track = createTripleOscillatorTrack();
+		addChords(track, 2);
+
+		// volume and panning change on every tick
+		for (FloatModel* model : {track->volumeModel(), track->panningModel()})
+		{
+			auto automationTrack = Track::create(Track::Type::Automation, song);
+			auto clip = dynamic_cast<AutomationClip*>(automationTrack->createClip(TimePos(0)));
+			clip->setProgressionType(AutomationClip::ProgressionType::CubicHermite);
+			clip->addObject(model);
+			for (tick_t tick = 0; tick < SongBars * TimePos::ticksPerBar(); tick += 4)
+			{
+				const float phase = (tick + i * 16) / 96.f;
+				clip->putValue(TimePos(tick), model->minValue() + model->range() * (0.5f + 0.5f * std::sin(phase)), false);
+			}
+		}
+	}
+}
+
+
+void createSamplesProject()
+{
+	// long samples at a different rate than the engine, so they get resampled
+	const auto sampleRate = 48000;
+	const auto seconds = 60;
+	for (int i = 0; i < 8; ++i)
+	{
+		std::vector<sampleFrame> data(sampleRate * seconds);
+		for (std::size_t frame = 0; frame < data.size(); ++frame)
+		{
+			const float value = 0.25f * std::sin(frame * (i + 1) * 0.01f);
+			data[frame] = {value, value};
+		}
+
+		auto track = Track::create(Track::Type::Sample, Engine::getSong());
+		auto clip = dynamic_cast<SampleClip*>(track->createClip(TimePos(0)));
+		clip->setSampleBuffer(std::make_shared<SampleBuffer>(std::move(data), sampleRate));
+	}
+}
+
+
+QJsonObject render(const QString& name)
+{
+	Song* song = Engine::getSong();
+	AudioEngine* audioEngine = Engine::audioEngine();
+	AudioEngineProfiler& profiler = audioEngine->profiler();
+
+	song->startExport();
+	profiler.resetDetailTotals();
+
+	// like ProjectRenderer, but without writing to a file
+	std::size_t frames = 0;
+	const auto start = std::chrono::steady_clock::now();
+	while (!song->isExportDone())
+	{
+		audioEngine->nextBuffer();
+		frames += audioEngine->framesPerPeriod();
+	}
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	song->stopExport();
+
+	QJsonObject stages;
+	for (std::size_t i = 0; i < AudioEngineProfiler::DetailCount; ++i)
+	{
+		const auto type = static_cast<AudioEngineProfiler::DetailType>(i);
+		stages[AudioEngineProfiler::detailName(type)] = profiler.detailTotal(type) / 1e6;
+	}
+
+	const double audioSeconds = static_cast<double>(frames) / audioEngine->processingSampleRate();
+	QJsonObject result;
+	result["name"] = name;
+	result["frames"] = static_cast<double>(frames);
+	result["seconds"] = elapsed;
+	result["framesPerSecond"] = frames / elapsed;
+	result["realtimeFactor"] = audioSeconds / elapsed;
+	result["stageSeconds"] = stages;
+	return result;
+}
+
+
+//! Renders the song like render(), but not timed, and writes its stems to
+//! @p directory
+void renderStems(const QString& directory)
+{
+	Song* song = Engine::getSong();
+	AudioEngine* audioEngine = Engine::audioEngine();
+
+	auto stems = bench::StemWriter{directory};
+	song->startExport();
+	while (!song->isExportDone())
+	{
+		stems.writeMaster(audioEngine->nextBuffer(), audioEngine->framesPerPeriod());
+	}
+	song->stopExport();
+}
+
+
+//! The settings that change how a render sounds; references recorded with
+//! other ones aren't expected to match bit-exactly
+QJsonObject renderSettings()
+{
+	QJsonObject settings;
+	settings["sampleRate"] = static_cast<int>(Engine::audioEngine()->processingSampleRate());
+	settings["framesPerPeriod"] = Engine::audioEngine()->framesPerPeriod();
+	settings["workerThreads"] = static_cast<int>(AudioEngineWorkerThread::workerCount());
+	settings["mixInstructionSet"] = MixHelpers::instructionSet();
+	return settings;
+}
+
+
+void checkRenderSettings(const QString& directory)
+{
+	auto file = QFile{QDir(directory).filePath("settings.json")};
+	if (!file.open(QFile::ReadOnly)) { return; }
+
+	const auto recorded = QJsonDocument::fromJson(file.readAll()).object();
+	const auto current = renderSettings();
+	for (auto it = current.begin(); it != current.end(); ++it)
+	{
+		if (recorded.value(it.key()) != it.value())
+		{
+			fprintf(stderr, "The references were recorded with another %s, they may not match\n",
+				qPrintable(it.key()));
+		}
+	}
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+	new QCoreApplication(argc, argv);
+
+	int repeat = 1;
+	QString recordDir;
+	QString compareDir;
+	float tolerance = 0.0f;
+	QStringList projects;
+	for (int i = 1; i < argc; ++i)
+	{
+		const QString arg = argv[i];
+		if (arg == "--repeat" && i + 1 < argc)
+		{
+			repeat = std::max(1, QString(argv[++i]).toInt());
+		}
+		else if (arg == "--record" && i + 1 < argc)
+		{
+			recordDir = QString::fromLocal8Bit(argv[++i]);
+		}
+		else if (arg == "--compare" && i + 1 < argc)
+		{
+			compareDir = QString::fromLocal8Bit(argv[++i]);
+		}
+		else if (arg == "--tolerance" && i + 1 < argc)
+		{
+			tolerance = dbfsToAmp(QString(argv[++i]).toFloat());
+		}
+		else
+		{
+			projects << QString::fromLocal8Bit(argv[i]);
+		}
+	}
+
+	NotePlayHandleManager::init();
+	Engine::init(true);
+	Song* song = Engine::getSong();
+
+	std::vector<std::pair<QString, std::function<void()>>> benchmarks;
+	if (projects.isEmpty())
+	{
+		benchmarks = {
+			{"notes", createNotesProject},
+			{"routing", createRoutingProject},
+			{"automation", createAutomationProject},
+			{"samples", createSamplesProject}
+		};
+	}
+	for (const QString& project : projects)
+	{
+		benchmarks.emplace_back(QFileInfo(project).fileName(), [project, song] { song->loadProject(project); });
+	}
+
+	// the renders to compare are written to a directory of their own
+	QTemporaryDir renderedDir;
+	if (!compareDir.isEmpty()) { checkRenderSettings(compareDir); }
+
+	QJsonArray results;
+	QJsonArray golden;
+	bool matches = true;
+	for (const auto& [name, create] : benchmarks)
+	{
+		song->clearProject();
+		create();
+
+		// before the timed renders, so it starts from the same state as the
+		// reference did, however often those are repeated
+		if (!recordDir.isEmpty())
+		{
+			renderStems(QDir(recordDir).filePath(name));
+		}
+		else if (!compareDir.isEmpty())
+		{
+			renderStems(renderedDir.filePath(name));
+			auto comparison = bench::compareStems(QDir(compareDir).filePath(name), renderedDir.filePath(name), tolerance);
+			comparison["name"] = name;
+			if (!comparison["matches"].toBool())
+			{
+				matches = false;
+				const auto first = comparison["firstDivergence"].toObject();
+				fprintf(stderr, "%s differs from the reference, first in %s at frame %d\n", qPrintable(name),
+					qPrintable(first["stem"].toString()), first["firstFrame"].toInt());
+			}
+			golden.append(comparison);
+		}
+
+		for (int run = 0; run < repeat; ++run)
+		{
+			results.append(render(name));
+		}
+	}
+	song->clearProject();
+
+	QJsonObject report = renderSettings();
+	report["benchmarks"] = results;
+	if (!compareDir.isEmpty()) { report["golden"] = golden; }
+
+	const auto notes = NotePlayHandleManager::statistics();
+	QJsonObject notePool;
+	notePool["size"] = notes.size;
+	notePool["peakInUse"] = notes.peakInUse;
+	notePool["audioThreadGrowths"] = notes.audioThreadGrowths;
+	report["notePlayHandles"] = notePool;
+	printf("%s\n", QJsonDocument(report).toJson().constData());
+
+	if (!recordDir.isEmpty())
+	{
+		auto file = QFile{QDir(recordDir).filePath("settings.json")};
+		if (file.open(QFile::WriteOnly | QFile::Truncate)) { file.write(QJsonDocument(renderSettings()).toJson()); }
+	}
+
+	Engine::destroy();
+	NotePlayHandleManager::free();
+	return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -100,6 +100,29 @@ private slots: // tests
 		QVERIFY(m2.value());
 		QVERIFY(!m3.value());
 	}
+
+	void LinkedValueTests()
+	{
+		using namespace lmms;
+
+		FloatModel m1(0, 0, 10, 1), m2(0, 0, 10, 1), m3(0, 0, 10, 1);
+		AutomatableModel::linkModels(&m1, &m2);
+		AutomatableModel::linkModels(&m2, &m3); // m3 is linked with m1 through m2
+
+		int m3Changes = 0;
+		QObject::connect(&m3, &Model::dataChanged, [&m3Changes] { ++m3Changes; });
+		m1.setValue(5.f);
+		QCOMPARE(m3.value(), 5.f);
+		QCOMPARE(m3Changes, 1); // told once, not again by every model in between
+
+		m3.setValue(2.f);
+		QCOMPARE(m1.value(), 2.f);
+
+		AutomatableModel::unlinkModels(&m2, &m3);
+		m1.setValue(7.f);
+		QCOMPARE(m2.value(), 7.f);
+		QCOMPARE(m3.value(), 2.f);
+	}
 } AutomatableModelTests;
 
 #include "AutomatableModelTest.moc"
@@ -0,0 +1,85 @@
+/*
+ * CompensationDelayTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <vector>
+
+#include "CompensationDelay.h"
+
+class CompensationDelayTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void DelayTest()
+	{
+		using namespace lmms;
+		// longer than a period, so it takes more than one to come out
+		constexpr int Frames = 16;
+		constexpr int Delay = 21;
+		CompensationDelay delay;
+		delay.setDelay(Delay);
+		QCOMPARE(delay.delay(), Delay);
+
+		std::vector<sampleFrame> buffer(Frames);
+		for (int f = 0; f < Frames; ++f) { buffer[f] = {f + 1.f, -f - 1.f}; }
+		delay.process(buffer.data(), Frames, true);
+		for (int f = 0; f < Frames; ++f) { QCOMPARE(buffer[f][0], 0.f); }
+		QVERIFY(delay.hasTail());
+
+		// silence without anything left to come out isn't touched
+		auto output = std::vector<sampleFrame>{};
+		while (delay.hasTail())
+		{
+			buffer.assign(Frames, sampleFrame{5.f, 5.f});
+			delay.process(buffer.data(), Frames, false);
+			output.insert(output.end(), buffer.begin(), buffer.end());
+		}
+		QCOMPARE(static_cast<int>(output.size()), 2 * Frames);
+		for (int f = 0; f < Frames; ++f)
+		{
+			QCOMPARE(output[Delay - Frames + f][0], f + 1.f);
+			QCOMPARE(output[Delay - Frames + f][1], -f - 1.f);
+		}
+		QCOMPARE(output[Delay - Frames - 1][0], 0.f);
+		QCOMPARE(output[Delay][0], 0.f);
+
+		buffer.assign(Frames, sampleFrame{5.f, 5.f});
+		delay.process(buffer.data(), Frames, false);
+		QCOMPARE(buffer[0][0], 5.f);
+
+		// changing the delay drops what was delayed
+		buffer.assign(Frames, sampleFrame{1.f, 1.f});
+		delay.process(buffer.data(), Frames, true);
+		delay.setDelay(4);
+		QVERIFY(!delay.hasTail());
+		buffer.assign(Frames, sampleFrame{1.f, 1.f});
+		delay.process(buffer.data(), Frames, true);
+		QCOMPARE(buffer[3][0], 0.f);
+		QCOMPARE(buffer[4][0], 1.f);
+	}
+} CompensationDelayTests;
+
+#include "CompensationDelayTest.moc"
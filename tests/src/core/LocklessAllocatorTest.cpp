@@ -0,0 +1,103 @@
+/*
+ * LocklessAllocatorTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "LocklessAllocator.h"
+
+class LocklessAllocatorTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void GrowthTest()
+	{
+		using namespace lmms;
+		constexpr int Capacity = 16;
+		LocklessAllocatorT<int> allocator(Capacity);
+		QCOMPARE(static_cast<int>(allocator.statistics().capacity), Capacity);
+
+		// grows before it runs dry, and never hands out an element twice
+		std::vector<int*> elements;
+		std::set<int*> distinct;
+		for (int i = 0; i < 3 * Capacity; ++i)
+		{
+			int* element = allocator.alloc();
+			QVERIFY(element != nullptr);
+			elements.push_back(element);
+			distinct.insert(element);
+		}
+		QCOMPARE(static_cast<int>(distinct.size()), 3 * Capacity);
+
+		const auto stats = allocator.statistics();
+		QVERIFY(static_cast<int>(stats.capacity) > 3 * Capacity);
+		QCOMPARE(static_cast<int>(stats.inUse), 3 * Capacity);
+		QVERIFY(stats.growths >= 2);
+		QCOMPARE(stats.failures, 0);
+
+		for (int* element : elements) { allocator.free(element); }
+		QCOMPARE(static_cast<int>(allocator.statistics().inUse), 0);
+		QCOMPARE(static_cast<int>(allocator.statistics().peakInUse), 3 * Capacity);
+	}
+
+	void ConcurrencyTest()
+	{
+		using namespace lmms;
+		LocklessAllocatorT<int> allocator(64);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < 4; ++t)
+		{
+			threads.emplace_back([&allocator, t]
+			{
+				std::vector<int*> elements;
+				for (int round = 0; round < 1000; ++round)
+				{
+					for (int i = 0; i < 32; ++i)
+					{
+						int* element = allocator.alloc();
+						if (element) { *element = t; elements.push_back(element); }
+					}
+					// nobody else wrote to them meanwhile
+					for (int* element : elements)
+					{
+						if (*element != t) { return; }
+						allocator.free(element);
+					}
+					elements.clear();
+				}
+			});
+		}
+		for (auto& thread : threads) { thread.join(); }
+
+		const auto stats = allocator.statistics();
+		QCOMPARE(static_cast<int>(stats.inUse), 0);
+		QCOMPARE(stats.failures, 0);
+	}
+} LocklessAllocatorTests;
+
+#include "LocklessAllocatorTest.moc"
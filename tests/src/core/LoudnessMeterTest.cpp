@@ -0,0 +1,94 @@
+/*
+ * LoudnessMeterTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "LoudnessMeter.h"
+
+class LoudnessMeterTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	static std::vector<lmms::sampleFrame> sine(int sampleRate, double frequency, double amplitude,
+		double seconds, double phase = 0)
+	{
+		std::vector<lmms::sampleFrame> frames(static_cast<std::size_t>(sampleRate * seconds));
+		for (std::size_t f = 0; f < frames.size(); ++f)
+		{
+			const auto value = static_cast<float>(amplitude * std::sin(2 * M_PI * frequency * f / sampleRate + phase));
+			frames[f] = {value, value};
+		}
+		return frames;
+	}
+
+private slots:
+	void LoudnessTest()
+	{
+		using namespace lmms;
+		// EBU Tech 3341: a 1 kHz stereo sine at -23 dBFS measures -23 LUFS
+		for (const int sampleRate : {44100, 48000, 96000})
+		{
+			LoudnessMeter meter(sampleRate);
+			const auto frames = sine(sampleRate, 1000, std::pow(10.0, -23.0 / 20), 20);
+			meter.process(frames.data(), frames.size());
+
+			const auto report = meter.report();
+			QVERIFY(std::abs(report.integrated + 23) < 0.1);
+			QVERIFY(std::abs(report.maxShortTerm + 23) < 0.1);
+			QVERIFY(report.range < 0.1);
+			QCOMPARE(report.clippedSamples, 0);
+		}
+
+		LoudnessMeter silence(44100);
+		const auto frames = std::vector<sampleFrame>(44100 * 5);
+		silence.process(frames.data(), frames.size());
+		QVERIFY(std::isinf(silence.report().integrated));
+	}
+
+	void PeakTest()
+	{
+		using namespace lmms;
+		// at a quarter of the sample rate the samples miss the peaks by 3 dB
+		LoudnessMeter meter(48000);
+		const auto frames = sine(48000, 12000, 1.0, 1, M_PI / 4);
+		meter.process(frames.data(), frames.size());
+
+		auto report = meter.report();
+		QVERIFY(std::abs(report.samplePeak + 3.01) < 0.05);
+		QVERIFY(std::abs(report.truePeak) < 0.2);
+		QCOMPARE(report.clippedSamples, 0);
+
+		// the gain applies before measuring
+		meter.process(frames.data(), 100, 2.0f);
+		report = meter.report();
+		QVERIFY(report.clippedSamples > 0);
+		QVERIFY(std::abs(report.firstClip - 1.0) < 0.001);
+	}
+} LoudnessMeterTests;
+
+#include "LoudnessMeterTest.moc"
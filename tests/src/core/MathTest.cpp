@@ -27,6 +27,7 @@
 #include "lmms_math.h"
 
 #include <QDir>
+#include <cmath>
 
 class MathTest : QTestSuite
 {
@@ -48,6 +49,18 @@ private slots:
 		QCOMPARE(numDigitsAsInt(900000000), 9);
 		QCOMPARE(numDigitsAsInt(-900000000), 10);
 	}
+
+	void FastExp2Test()
+	{
+		using namespace lmms;
+		QCOMPARE(fastExp2f(0.f), 1.f);
+		QCOMPARE(fastExp2f(3.f), 8.f);
+		QCOMPARE(fastExp2f(-2.f), 0.25f);
+		for (float x = -20.f; x < 20.f; x += 0.01f)
+		{
+			QVERIFY(std::abs(fastExp2f(x) / std::exp2(x) - 1.f) < 1e-6f);
+		}
+	}
 } MathTests;
 
 #include "MathTest.moc"
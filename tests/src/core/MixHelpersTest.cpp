@@ -0,0 +1,300 @@
+/*
+ * MixHelpersTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "MixHelpers.h"
+#include "ValueBuffer.h"
+
+class MixHelpersTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	// odd, so whatever the vector width, the scalar code has to do the rest,
+	// and starting at frame 1 of the buffers so they aren't aligned
+	static constexpr int Frames = 37;
+
+	std::vector<lmms::sampleFrame> buffer(float offset)
+	{
+		std::vector<lmms::sampleFrame> frames(Frames + 1);
+		for (int f = 0; f < Frames + 1; ++f)
+		{
+			frames[f] = {std::sin(f + offset) * 2.f, std::cos(f * 0.7f + offset) * 2.f};
+		}
+		return frames;
+	}
+
+	void compareFrames(const std::vector<lmms::sampleFrame>& actual, const std::vector<lmms::sampleFrame>& expected)
+	{
+		for (int f = 0; f < Frames + 1; ++f)
+		{
+			QCOMPARE(actual[f][0], expected[f][0]);
+			QCOMPARE(actual[f][1], expected[f][1]);
+		}
+	}
+
+private slots:
+	void MixTest()
+	{
+		using namespace lmms;
+		const auto src = buffer(0.f);
+		const auto dst = buffer(1.f);
+		ValueBuffer coeffs(Frames + 1);
+		for (int f = 0; f < Frames + 1; ++f) { coeffs[f] = f / float(Frames); }
+
+		auto actual = dst;
+		auto expected = dst;
+		MixHelpers::add(actual.data() + 1, src.data() + 1, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] += src[f][0];
+			expected[f][1] += src[f][1];
+		}
+		compareFrames(actual, expected);
+
+		actual = expected = dst;
+		MixHelpers::addSwappedMultiplied(actual.data() + 1, src.data() + 1, 0.5f, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] += src[f][1] * 0.5f;
+			expected[f][1] += src[f][0] * 0.5f;
+		}
+		compareFrames(actual, expected);
+
+		// coeffSrcBuf doesn't get offset, like MixHelpers where it always
+		// belongs to the whole period
+		actual = expected = dst;
+		MixHelpers::addMultipliedByBuffer(actual.data() + 1, src.data() + 1, 0.5f, &coeffs, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] += src[f][0] * 0.5f * coeffs[f - 1];
+			expected[f][1] += src[f][1] * 0.5f * coeffs[f - 1];
+		}
+		compareFrames(actual, expected);
+
+		actual = expected = dst;
+		MixHelpers::addMultipliedStereo(actual.data() + 1, src.data() + 1, 0.25f, 0.75f, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] += src[f][0] * 0.25f;
+			expected[f][1] += src[f][1] * 0.75f;
+		}
+		compareFrames(actual, expected);
+
+		std::vector<sample_t> left(Frames + 1);
+		std::vector<sample_t> right(Frames + 1);
+		for (int f = 0; f < Frames + 1; ++f)
+		{
+			left[f] = src[f][0];
+			right[f] = -src[f][1];
+		}
+		actual = expected = dst;
+		MixHelpers::multiplyAndAddMultipliedJoined(actual.data() + 1, left.data() + 1, right.data() + 1, 0.5f, 2.f, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] = expected[f][0] * 0.5f + left[f] * 2.f;
+			expected[f][1] = expected[f][1] * 0.5f + right[f] * 2.f;
+		}
+		compareFrames(actual, expected);
+
+		std::vector<sample_t> actualLeft(Frames + 1);
+		std::vector<sample_t> actualRight(Frames + 1);
+		MixHelpers::deinterleaveMultiplied(src.data() + 1, actualLeft.data() + 1, actualRight.data() + 1, 0.5f, Frames);
+		QCOMPARE(actualLeft[0], 0.f);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			QCOMPARE(actualLeft[f], src[f][0] * 0.5f);
+			QCOMPARE(actualRight[f], src[f][1] * 0.5f);
+		}
+	}
+
+	void GainTest()
+	{
+		using namespace lmms;
+		const auto src = buffer(0.f);
+		const auto dst = buffer(1.f);
+		ValueBuffer volume(Frames);
+		ValueBuffer panning(Frames);
+		for (int f = 0; f < Frames; ++f)
+		{
+			volume[f] = f * 5.f;
+			panning[f] = f * 5.f - 100.f;
+		}
+
+		// like AudioPort used to apply them
+		auto gains = [](float vol, float pan) {
+			const float v = vol * 0.01f;
+			const float p = pan * 0.01f;
+			return std::make_pair((p <= 0 ? 1.0f : 1.0f - p) * v, (p >= 0 ? 1.0f : 1.0f + p) * v);
+		};
+
+		auto actual = dst;
+		auto expected = dst;
+		MixHelpers::addWithGain(actual.data() + 1, src.data() + 1, {&volume, 100.f, &panning, 0.f}, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			const auto [left, right] = gains(volume[f - 1], panning[f - 1]);
+			expected[f][0] = (expected[f][0] + src[f][0]) * left;
+			expected[f][1] = (expected[f][1] + src[f][1]) * right;
+		}
+		compareFrames(actual, expected);
+
+		actual = expected = dst;
+		MixHelpers::copyWithGain(actual.data() + 1, src.data() + 1, {nullptr, 80.f, &panning, 0.f}, Frames);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			const auto [left, right] = gains(80.f, panning[f - 1]);
+			expected[f][0] = src[f][0] * left;
+			expected[f][1] = src[f][1] * right;
+		}
+		compareFrames(actual, expected);
+
+		actual = expected = dst;
+		MixHelpers::addWithGain(actual.data() + 1, src.data() + 1, {nullptr, 50.f, nullptr, 30.f}, Frames);
+		const auto [left, right] = gains(50.f, 30.f);
+		for (int f = 1; f <= Frames; ++f)
+		{
+			expected[f][0] = (expected[f][0] + src[f][0]) * left;
+			expected[f][1] = (expected[f][1] + src[f][1]) * right;
+		}
+		compareFrames(actual, expected);
+	}
+
+	void SanitizeTest()
+	{
+		using namespace lmms;
+		const bool useNaNHandler = MixHelpers::useNaNHandler();
+		MixHelpers::setNaNHandler(true);
+
+		auto src = buffer(0.f);
+		src[5][1] = std::numeric_limits<float>::infinity();
+		src[Frames][0] = std::numeric_limits<float>::quiet_NaN();
+		const auto dst = buffer(1.f);
+
+		// in the vectorised part and in the rest, and not in the frame before
+		QVERIFY(MixHelpers::hasNonFinite(src.data() + 1, Frames));
+		QVERIFY(MixHelpers::hasNonFinite(src.data() + 1, 5));
+		QVERIFY(MixHelpers::hasNonFinite(src.data() + Frames, 1));
+		QVERIFY(!MixHelpers::hasNonFinite(src.data() + 6, Frames - 6));
+
+		auto actual = dst;
+		auto expected = dst;
+		QVERIFY(MixHelpers::addSanitizedMultiplied(actual.data() + 1, src.data() + 1, 0.5f, Frames));
+		for (int f = 1; f <= Frames; ++f)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				expected[f][c] += std::isfinite(src[f][c]) ? src[f][c] * 0.5f : 0.f;
+			}
+		}
+		compareFrames(actual, expected);
+
+		actual = dst;
+		QVERIFY(!MixHelpers::addSanitizedMultiplied(actual.data() + 1, dst.data() + 1, 0.5f, Frames));
+
+		// too loud is clamped, infs and nans anywhere clear everything
+		auto loud = dst;
+		loud[Frames][1] = 5000.f;
+		QVERIFY(!MixHelpers::sanitize(loud.data() + 1, Frames));
+		QCOMPARE(loud[Frames][1], 1000.f);
+		QCOMPARE(loud[0][0], dst[0][0]);
+
+		actual = src;
+		QVERIFY(MixHelpers::sanitize(actual.data() + 1, Frames));
+		for (int f = 1; f <= Frames; ++f)
+		{
+			QCOMPARE(actual[f][0], 0.f);
+			QCOMPARE(actual[f][1], 0.f);
+		}
+
+		MixHelpers::setNaNHandler(useNaNHandler);
+	}
+
+	void MeasureTest()
+	{
+		using namespace lmms;
+		const bool useNaNHandler = MixHelpers::useNaNHandler();
+		MixHelpers::setNaNHandler(true);
+
+		auto src = buffer(0.f);
+		src[5][1] = std::numeric_limits<float>::infinity();
+		src[Frames][0] = std::numeric_limits<float>::quiet_NaN();
+		const auto dst = buffer(1.f);
+
+		auto actual = dst;
+		auto expected = dst;
+		auto measurement = MixHelpers::Measurement{};
+		MixHelpers::addSanitizedMultipliedMeasured(actual.data() + 1, src.data() + 1, 0.5f, Frames, measurement);
+		MixHelpers::addSanitizedMultiplied(expected.data() + 1, src.data() + 1, 0.5f, Frames);
+		compareFrames(actual, expected);
+
+		float peaks[2] = {0.f, 0.f};
+		float squares[2] = {0.f, 0.f};
+		for (int f = 1; f <= Frames; ++f)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				const float value = std::isfinite(src[f][c]) ? src[f][c] : 0.f;
+				peaks[c] = std::max(peaks[c], std::abs(value));
+				squares[c] += value * value;
+			}
+		}
+		// the vectorised code sums the squares in another order
+		for (int c = 0; c < 2; ++c)
+		{
+			QCOMPARE(measurement.peaks[c], peaks[c]);
+			QVERIFY(std::abs(measurement.squares[c] - squares[c]) < 1e-4f * squares[c]);
+		}
+
+		auto measured = MixHelpers::Measurement{};
+		MixHelpers::measure(src.data() + 1, Frames, measured);
+		QCOMPARE(measured.peaks[0], measurement.peaks[0]);
+		QCOMPARE(measured.squares[1], measurement.squares[1]);
+
+		MixHelpers::setNaNHandler(useNaNHandler);
+	}
+
+	void IsSilentTest()
+	{
+		using namespace lmms;
+		std::vector<sampleFrame> frames(Frames + 1);
+		QVERIFY(MixHelpers::isSilent(frames.data() + 1, Frames));
+
+		// in the part left to the scalar code, and in the vectorised one
+		frames[Frames][1] = 0.001f;
+		QVERIFY(!MixHelpers::isSilent(frames.data() + 1, Frames));
+		frames[Frames][1] = 0.f;
+		frames[2][0] = -0.001f;
+		QVERIFY(!MixHelpers::isSilent(frames.data() + 1, Frames));
+	}
+} MixHelpersTests;
+
+#include "MixHelpersTest.moc"
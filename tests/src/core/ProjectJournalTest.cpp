@@ -0,0 +1,67 @@
+/*
+ * ProjectJournalTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include "ProjectJournal.h"
+
+class ProjectJournalTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void IDTest()
+	{
+		using namespace lmms;
+		// the journal only keeps the pointers, they are never used here
+		int objects[3];
+		const auto object = [&objects](int i) { return reinterpret_cast<JournallingObject*>(&objects[i]); };
+
+		ProjectJournal journal;
+		const auto first = journal.allocID(object(0));
+		const auto second = journal.allocID(object(1));
+		QVERIFY(first != second);
+		QCOMPARE(journal.journallingObject(first), object(0));
+		QCOMPARE(journal.journallingObject(second), object(1));
+
+		// loaded IDs, in the dense table and beyond it
+		journal.reallocID(ProjectJournal::idToSave(first), object(2));
+		QCOMPARE(journal.journallingObject(ProjectJournal::idToSave(first)), object(2));
+		QCOMPARE(journal.journallingObject(first), object(0));
+		journal.reallocID(5000000, object(2));
+		QCOMPARE(journal.journallingObject(5000000), object(2));
+		QVERIFY(journal.journallingObject(5000001) == nullptr);
+
+		// freed IDs aren't handed out again, not even after clearing the journal
+		journal.freeID(second);
+		QVERIFY(journal.journallingObject(second) == nullptr);
+		journal.clearJournal();
+		QCOMPARE(journal.journallingObject(first), object(0));
+		QCOMPARE(journal.journallingObject(5000000), object(2));
+		const auto third = journal.allocID(object(1));
+		QVERIFY(third != first && third != second);
+	}
+} ProjectJournalTests;
+
+#include "ProjectJournalTest.moc"
@@ -79,6 +79,38 @@ private slots:
 		QCOMPARE(c.valueAt(150), 1.0f);
 	}
 
+	void testClipValues()
+	{
+		using namespace lmms;
+
+		AutomationClip c(nullptr);
+		c.setProgressionType(AutomationClip::ProgressionType::Linear);
+		c.putValue(0, 0.0, false);
+		c.putValue(100, 1.0, false);
+
+		float values[4];
+		QVERIFY(c.valuesAt(25, 0.5f, values, 4));
+		QCOMPARE(values[0], 0.25f);
+		QCOMPARE(values[1], 0.255f);
+		QCOMPARE(values[3], 0.265f);
+
+		// across the last node
+		QVERIFY(c.valuesAt(99, 0.5f, values, 4));
+		QCOMPARE(values[0], 0.99f);
+		QCOMPARE(values[1], 0.995f);
+		QCOMPARE(values[2], 1.0f);
+		QCOMPARE(values[3], 1.0f);
+
+		// nothing changes after the last node
+		QVERIFY(!c.valuesAt(150, 0.5f, values, 4));
+
+		c.setProgressionType(AutomationClip::ProgressionType::Discrete);
+		QVERIFY(!c.valuesAt(25, 0.5f, values, 4));
+		QVERIFY(c.valuesAt(99, 0.5f, values, 4));
+		QCOMPARE(values[1], 0.0f);
+		QCOMPARE(values[2], 1.0f);
+	}
+
 	void testClips()
 	{
 		using namespace lmms;